@@ -8,11 +8,15 @@
 /*
  * This commandlet is used to extract and dump animation compression statistics.
  *
- * It supports the following arguments: -acl=<path> -stats=<path> -MasterTolerance=<tolerance>
+ * It supports the following arguments: -acl=<path> -stats=<path> -MasterTolerance=<tolerance> -jobs=<count> -processes=<count>
  *
  *   acl: This is the path to the input directory that contains the ACL SJSON animation clips.
  *   stats: This is the path to the output directory that will contain the extracted SJSON statistics.
  *   MasterTolerance: This is the master tolerance used by the UE4 Automatic compression algorithm. Defaults to 0.1cm.
+ *   jobs: Prefetch only. The number of input clips loaded ahead on worker threads, this bounds how many are in memory at once.
+ *         Compression and timing still happen one clip at a time. Defaults to 1.
+ *   processes: The number of child processes the clips are split between, each writes its own stats shard. Defaults to 1.
+ *         Concurrent processes skew the timings, the summary reports them as unreliable (timings_reliable) when this is above 1.
  */
 UCLASS()
 class UACLStatsDumpCommandlet : public UCommandlet
@@ -36,6 +40,15 @@ public:
 	bool ResumeTask;
 	bool SkipAdditiveClips;
 
+	int32 NumLoadingJobs;
+	int32 NumChildProcesses;
+	int32 ShardIndex;
+	int32 NumShards;
+
+	/** Clips already present in the stats shards, they are skipped when resuming. */
+	TSet<FString> CompletedClips;
+	class FStatsShardWriter* ShardWriter;
+
 	class UAnimBoneCompressionSettings* AutoCompressionSettings;
 	class UAnimBoneCompressionSettings* ACLCompressionSettings;
 	class UAnimBoneCompressionSettings* KeyReductionCompressionSettings;
@@ -39,4 +39,7 @@ class UAnimBoneCompressionCodec_ACL : public UAnimBoneCompressionCodec_ACLBase
 	virtual UAnimBoneCompressionCodec* GetCodec(const FString& DDCHandle);
 	virtual void DecompressPose(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms) const override;
 	virtual void DecompressBone(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom) const override;
+
+	// UAnimBoneCompressionCodec_ACLBase implementation
+	virtual void DecompressBones(FAnimSequenceDecompressionContext& DecompContext, TArrayView<const int32> TrackIndices, TArrayView<FTransform> OutAtoms) const override;
 };
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "UObject/ObjectMacros.h"
 #include "Animation/AnimBoneCompressionCodec.h"
+#include "Serialization/BulkData.h"
 #include "AnimBoneCompressionCodec_ACLBase.generated.h"
 
 namespace acl
@@ -15,6 +16,8 @@ namespace acl
 	class IAllocator;
 }
 
+class FACLSegmentStreamer;
+
 /** An enum for ACL rotation formats. */
 UENUM()
 enum ACLRotationFormat
@@ -53,12 +56,29 @@ enum class ACLSafetyFallbackResult
 
 struct FACLCompressedAnimData final : public ICompressedAnimData
 {
+	/** The compressed clip, or only the part that stays resident when its segments are streamed. */
 	TArrayView<uint8> CompressedByteStream;
 
+	/** The data of streamed segments, everything past the first segment of the clip. Empty when nothing is streamed. */
+	FByteBulkData SegmentBulkData;
+
+	FACLCompressedAnimData();
+	virtual ~FACLCompressedAnimData();
+
+	/** The streamer that pages segments in when the clip has streamed segments, nullptr otherwise. */
+	FACLSegmentStreamer* GetSegmentStreamer() const { return SegmentStreamer.Get(); }
+
+	/** Serializes the compressed data of a sequence. Streamed segments are stored in the bulk data of DataOwner, which must be the owning UAnimSequence when the archive is persistent. */
+	void SerializeCompressedData(FArchive& Ar, UObject* DataOwner);
+
 	// ICompressedAnimData implementation
-	virtual void Bind(const TArrayView<uint8> BulkData) override { CompressedByteStream = BulkData; }
-	virtual int64 GetApproxCompressedSize() const override { return CompressedByteStream.Num(); }
+	virtual void SerializeCompressedData(FArchive& Ar) override;
+	virtual void Bind(const TArrayView<uint8> BulkData) override;
+	virtual int64 GetApproxCompressedSize() const override { return CompressedByteStream.Num() + SegmentBulkData.GetBulkDataSize(); }
 	virtual bool IsValid() const override;
+
+private:
+	TUniquePtr<FACLSegmentStreamer> SegmentStreamer;
 };
 
 /** The base codec implementation for ACL support. */
@@ -84,6 +104,10 @@ class UAnimBoneCompressionCodec_ACLBase : public UAnimBoneCompressionCodec
 	UPROPERTY(EditAnywhere, Category = "ACL Options", meta = (ClampMin = "0"))
 	float ErrorThreshold;
 
+	/** Whether to stream segments in on demand at runtime. Only the clip headers, range data and first segment stay resident. */
+	UPROPERTY(EditAnywhere, Category = "ACL Options")
+	bool bStreamSegments;
+
 	// UAnimBoneCompressionCodec implementation
 	virtual bool Compress(const FCompressibleAnimData& CompressibleAnimData, FCompressibleAnimDataResult& OutResult) override;
 	virtual void PopulateDDCKey(FArchive& Ar) override;
@@ -97,4 +121,7 @@ class UAnimBoneCompressionCodec_ACLBase : public UAnimBoneCompressionCodec
 	virtual TUniquePtr<ICompressedAnimData> AllocateAnimData() const override;
 	virtual void ByteSwapIn(ICompressedAnimData& AnimData, TArrayView<uint8> CompressedData, FMemoryReader& MemoryStream) const override;
 	virtual void ByteSwapOut(ICompressedAnimData& AnimData, TArrayView<uint8> CompressedData, FMemoryWriter& MemoryStream) const override;
+
+	/** Decompresses several bones at once against a single seeked context. OutAtoms[i] receives the bone for TrackIndices[i]. */
+	virtual void DecompressBones(FAnimSequenceDecompressionContext& DecompContext, TArrayView<const int32> TrackIndices, TArrayView<FTransform> OutAtoms) const PURE_VIRTUAL(UAnimBoneCompressionCodec_ACLBase::DecompressBones, );
 };
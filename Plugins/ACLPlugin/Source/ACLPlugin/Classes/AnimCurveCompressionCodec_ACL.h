@@ -35,4 +35,7 @@ class UAnimCurveCompressionCodec_ACL : public UAnimCurveCompressionCodec
 	// UAnimCurveCompressionCodec implementation
 	virtual void DecompressCurves(const FCompressedAnimSequence& AnimSeq, FBlendedCurve& Curves, float CurrentTime) const override;
 	virtual float DecompressCurve(const FCompressedAnimSequence& AnimSeq, SmartName::UID_Type CurveUID, float CurrentTime) const override;
+
+	/** Identifies the curves a blended curve uses, cached curve remaps are rebuilt when it changes. */
+	static uint32 GetCurveRemapKey(const FBlendedCurve& Curves);
 };
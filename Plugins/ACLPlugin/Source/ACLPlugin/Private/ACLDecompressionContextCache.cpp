@@ -0,0 +1,67 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "ACLDecompressionContextCache.h"
+
+static thread_local FACLInstanceDecompressionCache* GCurrentDecompressionCache = nullptr;
+
+void FACLInstanceDecompressionCache::Reset()
+{
+	Contexts.Reset();
+	UseCounter = 0;
+}
+
+FACLCachedDecompressionContext* FACLInstanceDecompressionCache::Find(const void* Clip, const void* SettingsTypeId)
+{
+	for (const TUniquePtr<FACLCachedDecompressionContext>& Context : Contexts)
+	{
+		if (Context->Clip == Clip && Context->SettingsTypeId == SettingsTypeId)
+		{
+			Context->LastUse = ++UseCounter;
+			return Context.Get();
+		}
+	}
+
+	return nullptr;
+}
+
+FACLCachedDecompressionContext* FACLInstanceDecompressionCache::Add(TUniquePtr<FACLCachedDecompressionContext> Context, const void* Clip, const void* SettingsTypeId)
+{
+	check(Context.IsValid());
+
+	Context->Clip = Clip;
+	Context->SettingsTypeId = SettingsTypeId;
+	Context->LastUse = ++UseCounter;
+
+	if (Contexts.Num() < MaxContexts)
+	{
+		return Contexts.Add_GetRef(MoveTemp(Context)).Get();
+	}
+
+	int32 OldestIndex = 0;
+	for (int32 Index = 1; Index < Contexts.Num(); ++Index)
+	{
+		if (Contexts[Index]->LastUse < Contexts[OldestIndex]->LastUse)
+		{
+			OldestIndex = Index;
+		}
+	}
+
+	Contexts[OldestIndex] = MoveTemp(Context);
+	return Contexts[OldestIndex].Get();
+}
+
+FACLInstanceDecompressionCache* FACLInstanceDecompressionCache::GetCurrent()
+{
+	return GCurrentDecompressionCache;
+}
+
+FACLDecompressionCacheScope::FACLDecompressionCacheScope(FACLInstanceDecompressionCache& Cache)
+	: PreviousCache(GCurrentDecompressionCache)
+{
+	GCurrentDecompressionCache = &Cache;
+}
+
+FACLDecompressionCacheScope::~FACLDecompressionCacheScope()
+{
+	GCurrentDecompressionCache = PreviousCache;
+}
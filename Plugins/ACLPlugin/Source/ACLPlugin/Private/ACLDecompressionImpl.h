@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "ACLImpl.h"
+#include "ACLDecompressionContextCache.h"
+#include "ACLSegmentStreamer.h"
 
 #include <acl/algorithm/uniformly_sampled/decoder.h>
 
@@ -43,12 +45,18 @@ struct FACLTransform final : public FTransform
 	}
 };
 
-/** These 3 indices map into the output Atom array. */
-struct FAtomIndices
+/*
+ * Maps an ACL track to the output Atom array. The rotation, translation and scale pairs of a track always target
+ * the same atom, so a single index is stored along with the channels the caller asked for.
+ */
+struct FPackedAtomIndex
 {
-	uint16 Rotation;
-	uint16 Translation;
-	uint16 Scale;
+	static constexpr uint16 RotationFlag = 1 << 0;
+	static constexpr uint16 TranslationFlag = 1 << 1;
+	static constexpr uint16 ScaleFlag = 1 << 2;
+
+	uint16 AtomIndex;
+	uint16 ChannelFlags;
 };
 
 /*
@@ -58,26 +66,24 @@ struct FUE4OutputWriter final : public acl::OutputWriter
 {
 	// Raw pointer for performance reasons, caller is responsible for ensuring data is valid
 	FACLTransform* Atoms;
-	const FAtomIndices* TrackToAtomsMap;
+	const FPackedAtomIndex* TrackToAtomsMap;
 
-	FUE4OutputWriter(TArrayView<FTransform>& Atoms_, const FAtomIndices* TrackToAtomsMap_)
+	FUE4OutputWriter(TArrayView<FTransform>& Atoms_, const FPackedAtomIndex* TrackToAtomsMap_)
 		: Atoms(static_cast<FACLTransform*>(Atoms_.GetData()))
 		, TrackToAtomsMap(TrackToAtomsMap_)
 	{}
 
 	//////////////////////////////////////////////////////////////////////////
 	// Override the OutputWriter behavior
-	bool skip_bone_rotation(uint16_t BoneIndex) const { return TrackToAtomsMap[BoneIndex].Rotation == 0xFFFF; }
-	bool skip_bone_translation(uint16_t BoneIndex) const { return TrackToAtomsMap[BoneIndex].Translation == 0xFFFF; }
-	bool skip_bone_scale(uint16_t BoneIndex) const { return TrackToAtomsMap[BoneIndex].Scale == 0xFFFF; }
+	bool skip_bone_rotation(uint16_t BoneIndex) const { return (TrackToAtomsMap[BoneIndex].ChannelFlags & FPackedAtomIndex::RotationFlag) == 0; }
+	bool skip_bone_translation(uint16_t BoneIndex) const { return (TrackToAtomsMap[BoneIndex].ChannelFlags & FPackedAtomIndex::TranslationFlag) == 0; }
+	bool skip_bone_scale(uint16_t BoneIndex) const { return (TrackToAtomsMap[BoneIndex].ChannelFlags & FPackedAtomIndex::ScaleFlag) == 0; }
 
 	//////////////////////////////////////////////////////////////////////////
 	// Called by the decoder to write out a quaternion rotation value for a specified bone index
 	void write_bone_rotation(uint16_t BoneIndex, const acl::Quat_32& Rotation)
 	{
-		const uint16 AtomIndex = TrackToAtomsMap[BoneIndex].Rotation;
-
-		FACLTransform& BoneAtom = Atoms[AtomIndex];
+		FACLTransform& BoneAtom = Atoms[TrackToAtomsMap[BoneIndex].AtomIndex];
 		BoneAtom.SetRotationRaw(Rotation);
 	}
 
@@ -85,9 +91,7 @@ struct FUE4OutputWriter final : public acl::OutputWriter
 	// Called by the decoder to write out a translation value for a specified bone index
 	void write_bone_translation(uint16_t BoneIndex, const acl::Vector4_32& Translation)
 	{
-		const uint16 AtomIndex = TrackToAtomsMap[BoneIndex].Translation;
-
-		FACLTransform& BoneAtom = Atoms[AtomIndex];
+		FACLTransform& BoneAtom = Atoms[TrackToAtomsMap[BoneIndex].AtomIndex];
 		BoneAtom.SetTranslationRaw(Translation);
 	}
 
@@ -95,13 +99,61 @@ struct FUE4OutputWriter final : public acl::OutputWriter
 	// Called by the decoder to write out a scale value for a specified bone index
 	void write_bone_scale(uint16_t BoneIndex, const acl::Vector4_32& Scale)
 	{
-		const uint16 AtomIndex = TrackToAtomsMap[BoneIndex].Scale;
-
-		FACLTransform& BoneAtom = Atoms[AtomIndex];
+		FACLTransform& BoneAtom = Atoms[TrackToAtomsMap[BoneIndex].AtomIndex];
 		BoneAtom.SetScale3DRaw(Scale);
 	}
 };
 
+/*
+ * Fills the track to atom map for a pose request. Tracks without a pair are left with no channel flags and are skipped.
+ * Scale pairs are ignored when the clip has no scale.
+ */
+inline void BuildPackedAtomIndices(const acl::ClipHeader& ClipHeader, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, const TArrayView<FTransform>& OutAtoms, FPackedAtomIndex* TrackToAtomsMap)
+{
+	const int32 ACLBoneCount = ClipHeader.num_bones;
+	FMemory::Memzero(TrackToAtomsMap, sizeof(FPackedAtomIndex) * ACLBoneCount);
+
+#if DO_CHECK
+	int32 MinAtomIndex = OutAtoms.Num();
+	int32 MaxAtomIndex = -1;
+	int32 MinTrackIndex = INT_MAX;
+	int32 MaxTrackIndex = -1;
+#endif
+
+	auto AddPairs = [&](const BoneTrackArray& Pairs, uint16 ChannelFlag)
+	{
+		for (const BoneTrackPair& Pair : Pairs)
+		{
+			FPackedAtomIndex& Entry = TrackToAtomsMap[Pair.TrackIndex];
+			checkSlow(Entry.ChannelFlags == 0 || Entry.AtomIndex == (uint16)Pair.AtomIndex);
+			Entry.AtomIndex = (uint16)Pair.AtomIndex;
+			Entry.ChannelFlags |= ChannelFlag;
+
+#if DO_CHECK
+			MinAtomIndex = FMath::Min(MinAtomIndex, Pair.AtomIndex);
+			MaxAtomIndex = FMath::Max(MaxAtomIndex, Pair.AtomIndex);
+			MinTrackIndex = FMath::Min(MinTrackIndex, Pair.TrackIndex);
+			MaxTrackIndex = FMath::Max(MaxTrackIndex, Pair.TrackIndex);
+#endif
+		}
+	};
+
+	AddPairs(RotationPairs, FPackedAtomIndex::RotationFlag);
+	AddPairs(TranslationPairs, FPackedAtomIndex::TranslationFlag);
+	if (ClipHeader.has_scale)
+	{
+		AddPairs(ScalePairs, FPackedAtomIndex::ScaleFlag);
+	}
+
+#if DO_CHECK
+	// Only assert once for performance reasons, when we write the pose, we won't perform the checks
+	checkf(OutAtoms.IsValidIndex(MinAtomIndex), TEXT("Invalid atom index: %d"), MinAtomIndex);
+	checkf(OutAtoms.IsValidIndex(MaxAtomIndex), TEXT("Invalid atom index: %d"), MaxAtomIndex);
+	checkf(MinTrackIndex >= 0, TEXT("Invalid track index: %d"), MinTrackIndex);
+	checkf(MaxTrackIndex < ACLBoneCount, TEXT("Invalid track index: %d"), MaxTrackIndex);
+#endif
+}
+
 using UE4DefaultDecompressionSettings = acl::uniformly_sampled::DefaultDecompressionSettings;
 using UE4CustomDecompressionSettings = acl::uniformly_sampled::DebugDecompressionSettings;
 
@@ -116,18 +168,10 @@ struct UE4SafeDecompressionSettings final : public UE4DefaultDecompressionSettin
 };
 
 template<typename DecompressionSettingsType>
-FORCEINLINE_DEBUGGABLE void DecompressBone(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom)
+FORCEINLINE void WriteBoneAtom(acl::uniformly_sampled::DecompressionContext<DecompressionSettingsType>& Context, int32 TrackIndex, FTransform& OutAtom)
 {
 	using namespace acl;
 
-	const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(DecompContext.CompressedAnimData);
-	const CompressedClip* CompressedClipData = reinterpret_cast<const CompressedClip*>(AnimData.CompressedByteStream.GetData());
-	check(CompressedClipData->is_valid(false).empty());
-
-	uniformly_sampled::DecompressionContext<DecompressionSettingsType> Context;
-	Context.initialize(*CompressedClipData);
-	Context.seek(DecompContext.Time, get_rounding_policy(DecompContext.Interpolation));
-
 	Quat_32 Rotation;
 	Vector4_32 Translation;
 	Vector4_32 Scale;
@@ -139,8 +183,158 @@ FORCEINLINE_DEBUGGABLE void DecompressBone(FAnimSequenceDecompressionContext& De
 	BoneAtom.SetScale3DRaw(Scale);
 }
 
+/*
+ * A small per-thread cache of initialized and seeked decompression contexts.
+ * Engine paths that sample a handful of bones one at a time (root motion, IK targets, sockets) query the same clip at
+ * the same time repeatedly; reusing the context skips the clip setup, and the seek when the time matches too.
+ * Entries are validated with is_dirty() so a clip that moved or was rebuilt is never decoded through a stale context.
+ */
 template<typename DecompressionSettingsType>
-FORCEINLINE_DEBUGGABLE void DecompressPose(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms)
+struct FACLDecompressionContextCache
+{
+	static constexpr int32 NumEntries = 4;
+
+	struct FEntry
+	{
+		acl::uniformly_sampled::DecompressionContext<DecompressionSettingsType> Context;
+		acl::ISegmentStreamer* SegmentStreamer = nullptr;
+		float Time = -1.0f;
+		acl::SampleRoundingPolicy RoundingPolicy = acl::SampleRoundingPolicy::None;
+		uint32 LastUse = 0;
+		bool bInitialized = false;
+	};
+
+	FEntry Entries[NumEntries];
+	uint32 UseCounter = 0;
+
+	static FACLDecompressionContextCache& Get()
+	{
+		static thread_local FACLDecompressionContextCache Cache;
+		return Cache;
+	}
+
+	acl::uniformly_sampled::DecompressionContext<DecompressionSettingsType>& FindOrSeek(const acl::CompressedClip& Clip, acl::ISegmentStreamer* SegmentStreamer, float Time, acl::SampleRoundingPolicy RoundingPolicy)
+	{
+		FEntry* SameClip = nullptr;
+		FEntry* Oldest = &Entries[0];
+		for (FEntry& Entry : Entries)
+		{
+			if (Entry.bInitialized && !Entry.Context.is_dirty(Clip) && Entry.SegmentStreamer == SegmentStreamer && Entry.RoundingPolicy == RoundingPolicy)
+			{
+				// Streamed segments may have been evicted since, those contexts always seek again
+				if (Entry.Time == Time && SegmentStreamer == nullptr)
+				{
+					Entry.LastUse = ++UseCounter;
+					return Entry.Context;
+				}
+				SameClip = SameClip != nullptr ? SameClip : &Entry;
+			}
+			Oldest = !Entry.bInitialized || Entry.LastUse < Oldest->LastUse ? &Entry : Oldest;
+		}
+
+		// Prefer re-seeking a context already set up for this clip over evicting another clip's.
+		FEntry& Entry = SameClip != nullptr ? *SameClip : *Oldest;
+		if (SameClip == nullptr)
+		{
+			Entry.Context.initialize(Clip, SegmentStreamer);
+			Entry.SegmentStreamer = SegmentStreamer;
+			Entry.RoundingPolicy = RoundingPolicy;
+			Entry.bInitialized = true;
+		}
+		Entry.Context.seek(Time, RoundingPolicy);
+		Entry.Time = Time;
+		Entry.LastUse = ++UseCounter;
+		return Entry.Context;
+	}
+};
+
+/** A context persisted in an FACLInstanceDecompressionCache. Allocated with the alignment the ACL context requires. */
+template<typename DecompressionSettingsType>
+struct TACLCachedDecompressionContext final : public FACLCachedDecompressionContext
+{
+	acl::uniformly_sampled::DecompressionContext<DecompressionSettingsType> Context;
+	acl::ISegmentStreamer* SegmentStreamer = nullptr;
+
+	// Track to atom map of the last pose request, reused while the owner's required bones stay the same
+	TArray<FPackedAtomIndex> TrackToAtomsMap;
+	uint32 TrackToAtomsMapBonesKey = 0;
+	int32 TrackToAtomsMapNumPairs[3] = { -1, -1, -1 };
+
+	static const void* GetSettingsTypeId()
+	{
+		static const uint8 TypeId = 0;
+		return &TypeId;
+	}
+
+	/*
+	 * Returns the track to atom map for a pose request, rebuilding it only when the owner's required bones changed
+	 * since it was built. The pair counts are compared as well to catch requests that don't come from the owner's bone container.
+	 */
+	const FPackedAtomIndex* FindOrBuildTrackToAtomsMap(uint32 RequiredBonesKey, const acl::ClipHeader& ClipHeader, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, const TArrayView<FTransform>& OutAtoms)
+	{
+		const bool bUpToDate = TrackToAtomsMap.Num() == (int32)ClipHeader.num_bones
+			&& TrackToAtomsMapBonesKey == RequiredBonesKey
+			&& TrackToAtomsMapNumPairs[0] == RotationPairs.Num()
+			&& TrackToAtomsMapNumPairs[1] == TranslationPairs.Num()
+			&& TrackToAtomsMapNumPairs[2] == ScalePairs.Num();
+		if (!bUpToDate)
+		{
+			TrackToAtomsMap.SetNumUninitialized(ClipHeader.num_bones);
+			BuildPackedAtomIndices(ClipHeader, RotationPairs, TranslationPairs, ScalePairs, OutAtoms, TrackToAtomsMap.GetData());
+			TrackToAtomsMapBonesKey = RequiredBonesKey;
+			TrackToAtomsMapNumPairs[0] = RotationPairs.Num();
+			TrackToAtomsMapNumPairs[1] = TranslationPairs.Num();
+			TrackToAtomsMapNumPairs[2] = ScalePairs.Num();
+		}
+		return TrackToAtomsMap.GetData();
+	}
+
+	void* operator new(size_t Size) { return FMemory::Malloc(Size, alignof(TACLCachedDecompressionContext)); }
+	void operator delete(void* Ptr) { FMemory::Free(Ptr); }
+};
+
+/*
+ * Returns the context the instance cache holds for this clip, creating it when missing.
+ * It is only re-initialized when is_dirty() reports the clip changed or its segment streamer was replaced, the caller still has to seek it.
+ */
+template<typename DecompressionSettingsType>
+FORCEINLINE_DEBUGGABLE TACLCachedDecompressionContext<DecompressionSettingsType>& FindOrInitializeInstanceContext(FACLInstanceDecompressionCache& Cache, const acl::CompressedClip& Clip, acl::ISegmentStreamer* SegmentStreamer)
+{
+	using CachedContextType = TACLCachedDecompressionContext<DecompressionSettingsType>;
+
+	FACLCachedDecompressionContext* Entry = Cache.Find(&Clip, CachedContextType::GetSettingsTypeId());
+	if (Entry == nullptr)
+	{
+		Entry = Cache.Add(TUniquePtr<FACLCachedDecompressionContext>(new CachedContextType()), &Clip, CachedContextType::GetSettingsTypeId());
+	}
+
+	CachedContextType& CachedContext = *static_cast<CachedContextType*>(Entry);
+	if (CachedContext.Context.is_dirty(Clip) || CachedContext.SegmentStreamer != SegmentStreamer)
+	{
+		CachedContext.Context.initialize(Clip, SegmentStreamer);
+		CachedContext.SegmentStreamer = SegmentStreamer;
+		CachedContext.TrackToAtomsMap.Reset();
+	}
+	return CachedContext;
+}
+
+/*
+ * Returns the streamer of a clip with streamed segments, nullptr otherwise. The segments played from the decompression
+ * time onwards are requested first, the seek that follows holds the nearest resident sample while they are in flight.
+ */
+FORCEINLINE acl::ISegmentStreamer* PrefetchSegmentsForPlayback(const FACLCompressedAnimData& AnimData, float Time)
+{
+	FACLSegmentStreamer* SegmentStreamer = AnimData.GetSegmentStreamer();
+	if (SegmentStreamer != nullptr)
+	{
+		SegmentStreamer->PrefetchForPlayback(Time);
+	}
+	return SegmentStreamer;
+}
+
+/** Decompresses a single bone through a freshly initialized context. Kept as the reference path for benchmarks. */
+template<typename DecompressionSettingsType>
+FORCEINLINE_DEBUGGABLE void DecompressBoneUncached(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom)
 {
 	using namespace acl;
 
@@ -148,78 +342,92 @@ FORCEINLINE_DEBUGGABLE void DecompressPose(FAnimSequenceDecompressionContext& De
 	const CompressedClip* CompressedClipData = reinterpret_cast<const CompressedClip*>(AnimData.CompressedByteStream.GetData());
 	check(CompressedClipData->is_valid(false).empty());
 
+	ISegmentStreamer* SegmentStreamer = PrefetchSegmentsForPlayback(AnimData, DecompContext.Time);
+
 	uniformly_sampled::DecompressionContext<DecompressionSettingsType> Context;
-	Context.initialize(*CompressedClipData);
+	Context.initialize(*CompressedClipData, SegmentStreamer);
 	Context.seek(DecompContext.Time, get_rounding_policy(DecompContext.Interpolation));
 
-	const ClipHeader& ClipHeader = get_clip_header(*CompressedClipData);
-	const int32 ACLBoneCount = ClipHeader.num_bones;
+	WriteBoneAtom(Context, TrackIndex, OutAtom);
+}
 
-	// TODO: Allocate this with padding and use SIMD to set everything to 0xFF
-	FAtomIndices* TrackToAtomsMap = new(FMemStack::Get()) FAtomIndices[ACLBoneCount];
-	FMemory::Memset(TrackToAtomsMap, 0xFF, sizeof(FAtomIndices) * ACLBoneCount);
+template<typename DecompressionSettingsType>
+FORCEINLINE_DEBUGGABLE void DecompressBone(FAnimSequenceDecompressionContext& DecompContext, int32 TrackIndex, FTransform& OutAtom)
+{
+	using namespace acl;
 
-	// TODO: We should only need 1x uint16 atom index for each track/bone index
-	// and we need 3 bits to tell whether we care about the rot/trans/scale
-	// The rot and scale pairs are often the same array, skip the scale iteration and set both flags while
-	// iterating on the rotation pairs. This will reduce the mapping size by 2 bytes if we use 4 bytes.
-	// All reads will be aligned, can we pack further with 1x uint16 and 1x uint8 and do unaligned loads?
-	// Need to double check what the ASM looks like on x64 and ARM first to make sure it's good
-	// Maybe having two arrays side by side is better with uint16/uint8? Or having 1 bitset array?
+	const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(DecompContext.CompressedAnimData);
+	const CompressedClip* CompressedClipData = reinterpret_cast<const CompressedClip*>(AnimData.CompressedByteStream.GetData());
+	check(CompressedClipData->is_valid(false).empty());
 
-#if DO_CHECK
-	int32 MinAtomIndex = OutAtoms.Num();
-	int32 MaxAtomIndex = -1;
-	int32 MinTrackIndex = INT_MAX;
-	int32 MaxTrackIndex = -1;
-#endif
+	ISegmentStreamer* SegmentStreamer = PrefetchSegmentsForPlayback(AnimData, DecompContext.Time);
+	uniformly_sampled::DecompressionContext<DecompressionSettingsType>& Context = FACLDecompressionContextCache<DecompressionSettingsType>::Get().FindOrSeek(*CompressedClipData, SegmentStreamer, DecompContext.Time, get_rounding_policy(DecompContext.Interpolation));
+	WriteBoneAtom(Context, TrackIndex, OutAtom);
+}
 
-	for (const BoneTrackPair& Pair : RotationPairs)
-	{
-		TrackToAtomsMap[Pair.TrackIndex].Rotation = (uint16)Pair.AtomIndex;
+/*
+ * Decompresses several bones at the same time against one initialized and seeked context.
+ * OutAtoms[i] receives the bone for TrackIndices[i].
+ */
+template<typename DecompressionSettingsType>
+FORCEINLINE_DEBUGGABLE void DecompressBones(FAnimSequenceDecompressionContext& DecompContext, TArrayView<const int32> TrackIndices, TArrayView<FTransform> OutAtoms)
+{
+	using namespace acl;
 
-#if DO_CHECK
-		MinAtomIndex = FMath::Min(MinAtomIndex, Pair.AtomIndex);
-		MaxAtomIndex = FMath::Max(MaxAtomIndex, Pair.AtomIndex);
-		MinTrackIndex = FMath::Min(MinTrackIndex, Pair.TrackIndex);
-		MaxTrackIndex = FMath::Max(MaxTrackIndex, Pair.TrackIndex);
-#endif
-	}
+	check(TrackIndices.Num() == OutAtoms.Num());
 
-	for (const BoneTrackPair& Pair : TranslationPairs)
-	{
-		TrackToAtomsMap[Pair.TrackIndex].Translation = (uint16)Pair.AtomIndex;
+	const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(DecompContext.CompressedAnimData);
+	const CompressedClip* CompressedClipData = reinterpret_cast<const CompressedClip*>(AnimData.CompressedByteStream.GetData());
+	check(CompressedClipData->is_valid(false).empty());
 
-#if DO_CHECK
-		MinAtomIndex = FMath::Min(MinAtomIndex, Pair.AtomIndex);
-		MaxAtomIndex = FMath::Max(MaxAtomIndex, Pair.AtomIndex);
-		MinTrackIndex = FMath::Min(MinTrackIndex, Pair.TrackIndex);
-		MaxTrackIndex = FMath::Max(MaxTrackIndex, Pair.TrackIndex);
-#endif
-	}
+	ISegmentStreamer* SegmentStreamer = PrefetchSegmentsForPlayback(AnimData, DecompContext.Time);
 
-	if (ClipHeader.has_scale)
+	uniformly_sampled::DecompressionContext<DecompressionSettingsType> Context;
+	Context.initialize(*CompressedClipData, SegmentStreamer);
+	Context.seek(DecompContext.Time, get_rounding_policy(DecompContext.Interpolation));
+
+	for (int32 Index = 0; Index < TrackIndices.Num(); ++Index)
 	{
-		for (const BoneTrackPair& Pair : ScalePairs)
-		{
-			TrackToAtomsMap[Pair.TrackIndex].Scale = (uint16)Pair.AtomIndex;
+		WriteBoneAtom(Context, TrackIndices[Index], OutAtoms[Index]);
+	}
+}
 
-#if DO_CHECK
-			MinAtomIndex = FMath::Min(MinAtomIndex, Pair.AtomIndex);
-			MaxAtomIndex = FMath::Max(MaxAtomIndex, Pair.AtomIndex);
-			MinTrackIndex = FMath::Min(MinTrackIndex, Pair.TrackIndex);
-			MaxTrackIndex = FMath::Max(MaxTrackIndex, Pair.TrackIndex);
-#endif
-		}
+template<typename DecompressionSettingsType>
+FORCEINLINE_DEBUGGABLE void DecompressPose(FAnimSequenceDecompressionContext& DecompContext, const BoneTrackArray& RotationPairs, const BoneTrackArray& TranslationPairs, const BoneTrackArray& ScalePairs, TArrayView<FTransform>& OutAtoms)
+{
+	using namespace acl;
+
+	const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(DecompContext.CompressedAnimData);
+	const CompressedClip* CompressedClipData = reinterpret_cast<const CompressedClip*>(AnimData.CompressedByteStream.GetData());
+	check(CompressedClipData->is_valid(false).empty());
+
+	// Use the evaluating instance's persistent context and track map when it provides them. Seeking the context
+	// again is cheap when the time stays in the same segment, and the map survives until the required bones change.
+	ISegmentStreamer* SegmentStreamer = PrefetchSegmentsForPlayback(AnimData, DecompContext.Time);
+
+	FACLInstanceDecompressionCache* InstanceCache = FACLInstanceDecompressionCache::GetCurrent();
+	TACLCachedDecompressionContext<DecompressionSettingsType>* CachedContext = InstanceCache != nullptr ? &FindOrInitializeInstanceContext<DecompressionSettingsType>(*InstanceCache, *CompressedClipData, SegmentStreamer) : nullptr;
+
+	uniformly_sampled::DecompressionContext<DecompressionSettingsType> TransientContext;
+	uniformly_sampled::DecompressionContext<DecompressionSettingsType>& Context = CachedContext != nullptr ? CachedContext->Context : TransientContext;
+	if (CachedContext == nullptr)
+	{
+		TransientContext.initialize(*CompressedClipData, SegmentStreamer);
 	}
+	Context.seek(DecompContext.Time, get_rounding_policy(DecompContext.Interpolation));
 
-#if DO_CHECK
-	// Only assert once for performance reasons, when we write the pose, we won't perform the checks
-	checkf(OutAtoms.IsValidIndex(MinAtomIndex), TEXT("Invalid atom index: %d"), MinAtomIndex);
-	checkf(OutAtoms.IsValidIndex(MaxAtomIndex), TEXT("Invalid atom index: %d"), MaxAtomIndex);
-	checkf(MinTrackIndex >= 0, TEXT("Invalid track index: %d"), MinTrackIndex);
-	checkf(MaxTrackIndex < ACLBoneCount, TEXT("Invalid track index: %d"), MaxTrackIndex);
-#endif
+	const ClipHeader& ClipHeader = get_clip_header(*CompressedClipData);
+	const FPackedAtomIndex* TrackToAtomsMap;
+	if (CachedContext != nullptr)
+	{
+		TrackToAtomsMap = CachedContext->FindOrBuildTrackToAtomsMap(InstanceCache->GetRequiredBonesKey(), ClipHeader, RotationPairs, TranslationPairs, ScalePairs, OutAtoms);
+	}
+	else
+	{
+		FPackedAtomIndex* TransientTrackToAtomsMap = new(FMemStack::Get()) FPackedAtomIndex[ClipHeader.num_bones];
+		BuildPackedAtomIndices(ClipHeader, RotationPairs, TranslationPairs, ScalePairs, OutAtoms, TransientTrackToAtomsMap);
+		TrackToAtomsMap = TransientTrackToAtomsMap;
+	}
 
 	// We will decompress the whole pose even if we only care about a smaller subset of bone tracks.
 	// This ensures we read the compressed pose data once, linearly.
@@ -6,6 +6,15 @@
 #include "AnimationCompression.h"
 #include "AnimationUtils.h"
 #include "Animation/AnimCompressionTypes.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+
+static TAutoConsoleVariable<int32> CVarACLParallelCompression(
+	TEXT("a.ACL.ParallelCompression"),
+	1,
+	TEXT("When non-zero, ACL optimizes the segments of a clip concurrently on the task graph. The compressed data is identical either way."));
 
 acl::RotationFormat8 GetRotationFormat(ACLRotationFormat Format)
 {
@@ -185,4 +194,30 @@ TUniquePtr<acl::AnimationClip> BuildACLClip(ACLAllocator& AllocatorImpl, const F
 
 	return ACLClip;
 }
+
+uint32_t ACLTaskScheduler::get_max_concurrency() const
+{
+	// ParallelFor also runs jobs on the calling thread
+	return FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+}
+
+void ACLTaskScheduler::run_jobs(uint32_t num_jobs, job_function function, void* user_data)
+{
+	ParallelFor(static_cast<int32>(num_jobs), [function, user_data](int32 JobIndex)
+	{
+		function(user_data, static_cast<uint32_t>(JobIndex));
+	});
+}
+
+acl::ITaskScheduler* GetCompressionTaskScheduler()
+{
+	static ACLTaskScheduler TaskScheduler;
+
+	if (CVarACLParallelCompression.GetValueOnAnyThread() == 0 || !FApp::ShouldUseThreadingForPerformance())
+	{
+		return nullptr;
+	}
+
+	return &TaskScheduler;
+}
 #endif	// WITH_EDITOR
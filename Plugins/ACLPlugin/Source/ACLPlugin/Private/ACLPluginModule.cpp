@@ -2,6 +2,8 @@
 
 #include "CoreMinimal.h"
 #include "IACLPluginModule.h"
+#include "ACLSegmentStreamer.h"
+#include "Misc/CoreDelegates.h"
 #include "Modules/ModuleManager.h"
 
 // Enable console commands only in development builds when logging is enabled
@@ -14,7 +16,17 @@
 #include "Animation/AnimCurveCompressionCodec.h"
 #include "Animation/AnimCurveCompressionSettings.h"
 #include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/MemStack.h"
 #include "UObject/UObjectIterator.h"
+
+#include "ACLDecompressionImpl.h"
+#include "AnimBoneCompressionCodec_ACL.h"
+#include "AnimBoneCompressionCodec_ACLCustom.h"
+#include "AnimBoneCompressionCodec_ACLSafe.h"
+#include "AnimCurveCompressionCodec_ACL.h"
+
+#include <acl/decompression/decompress.h>
 #endif
 
 class FACLPlugin final : public IACLPlugin
@@ -24,10 +36,15 @@ private:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 
+	FDelegateHandle TrimSegmentsHandle;
+
 #if WITH_ACL_CONSOLE_COMMANDS
 	// Console commands
 	void ListCodecs(const TArray<FString>& Args);
 	void ListAnimSequences(const TArray<FString>& Args);
+	void BenchmarkDecompressBone(const TArray<FString>& Args);
+	void BenchmarkDecompressPose(const TArray<FString>& Args);
+	void BenchmarkDecompressCurves(const TArray<FString>& Args);
 
 	TArray<IConsoleObject*> ConsoleCommands;
 #endif
@@ -259,10 +276,336 @@ void FACLPlugin::ListAnimSequences(const TArray<FString>& Args)
 
 	LogAnimationCompression.SetVerbosity(OldVerbosity);
 }
+
+/** Times per-bone decompression of one sequence through the uncached, cached and batched paths. */
+template<typename DecompressionSettingsType>
+static void BenchmarkSequenceDecompressBone(const UAnimSequence& AnimSeq, int32 NumBones, int32 NumIterations)
+{
+	const ICompressedAnimData& AnimData = *AnimSeq.CompressedData.CompressedDataStructure;
+	const FACLCompressedAnimData& ACLData = static_cast<const FACLCompressedAnimData&>(AnimData);
+	const acl::CompressedClip* CompressedClipData = reinterpret_cast<const acl::CompressedClip*>(ACLData.CompressedByteStream.GetData());
+	const int32 NumTracks = acl::get_clip_header(*CompressedClipData).num_bones;
+	NumBones = FMath::Min(NumBones, NumTracks);
+	if (NumBones <= 0)
+	{
+		return;
+	}
+
+	// Spread the sampled bones over the clip the way sockets and IK targets usually are.
+	TArray<int32> TrackIndices;
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		TrackIndices.Add((BoneIndex * NumTracks) / NumBones);
+	}
+
+	FRandomStream Random(0xAC1);
+	TArray<float> Times;
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		Times.Add(Random.FRand() * AnimSeq.SequenceLength);
+	}
+
+	TArray<FTransform> Atoms;
+	Atoms.SetNum(NumBones);
+	FAnimSequenceDecompressionContext DecompContext(AnimSeq.SequenceLength, AnimSeq.Interpolation, AnimSeq.GetFName(), AnimData);
+
+	double StartTime = FPlatformTime::Seconds();
+	for (const float Time : Times)
+	{
+		DecompContext.Seek(Time);
+		for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+		{
+			DecompressBoneUncached<DecompressionSettingsType>(DecompContext, TrackIndices[BoneIndex], Atoms[BoneIndex]);
+		}
+	}
+	const double UncachedSeconds = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	for (const float Time : Times)
+	{
+		DecompContext.Seek(Time);
+		for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+		{
+			DecompressBone<DecompressionSettingsType>(DecompContext, TrackIndices[BoneIndex], Atoms[BoneIndex]);
+		}
+	}
+	const double CachedSeconds = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	for (const float Time : Times)
+	{
+		DecompContext.Seek(Time);
+		DecompressBones<DecompressionSettingsType>(DecompContext, TrackIndices, Atoms);
+	}
+	const double BatchedSeconds = FPlatformTime::Seconds() - StartTime;
+
+	const double NumSamples = (double)NumIterations * NumBones;
+	UE_LOG(LogAnimationCompression, Log, TEXT("%s: %d/%d bones, uncached %.1f ns/bone, cached %.1f ns/bone, batched %.1f ns/bone"),
+		*AnimSeq.GetPathName(), NumBones, NumTracks, UncachedSeconds * 1.0e9 / NumSamples, CachedSeconds * 1.0e9 / NumSamples, BatchedSeconds * 1.0e9 / NumSamples);
+}
+
+/*
+ * Times full pose decompression of one sequence played forward at 30 FPS, with a transient context and track map
+ * built on every call, then through an instance cache the way an evaluating anim instance uses it.
+ */
+template<typename DecompressionSettingsType>
+static void BenchmarkSequenceDecompressPose(const UAnimSequence& AnimSeq, int32 NumIterations)
+{
+	const ICompressedAnimData& AnimData = *AnimSeq.CompressedData.CompressedDataStructure;
+	const FACLCompressedAnimData& ACLData = static_cast<const FACLCompressedAnimData&>(AnimData);
+	const acl::CompressedClip* CompressedClipData = reinterpret_cast<const acl::CompressedClip*>(ACLData.CompressedByteStream.GetData());
+	const int32 NumTracks = acl::get_clip_header(*CompressedClipData).num_bones;
+	if (NumTracks <= 0)
+	{
+		return;
+	}
+
+	// Every track is requested, mapped to the atom of the same index.
+	BoneTrackArray Pairs;
+	for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
+	{
+		Pairs.Add(BoneTrackPair(TrackIndex, TrackIndex));
+	}
+
+	TArray<FTransform> Atoms;
+	Atoms.SetNum(NumTracks);
+	TArrayView<FTransform> AtomsView(Atoms);
+	FAnimSequenceDecompressionContext DecompContext(AnimSeq.SequenceLength, AnimSeq.Interpolation, AnimSeq.GetFName(), AnimData);
+
+	const float DeltaTime = 1.0f / 30.0f;
+	auto RunPlayback = [&]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		float Time = 0.0f;
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			FMemMark Mark(FMemStack::Get());
+			DecompContext.Seek(Time);
+			DecompressPose<DecompressionSettingsType>(DecompContext, Pairs, Pairs, Pairs, AtomsView);
+			Time = FMath::Fmod(Time + DeltaTime, FMath::Max(AnimSeq.SequenceLength, DeltaTime));
+		}
+		return FPlatformTime::Seconds() - StartTime;
+	};
+
+	const double TransientSeconds = RunPlayback();
+
+	FACLInstanceDecompressionCache Cache;
+	double CachedSeconds;
+	{
+		FACLDecompressionCacheScope CacheScope(Cache);
+		CachedSeconds = RunPlayback();
+	}
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("%s: %d bones, transient %.2f us/pose, cached %.2f us/pose"),
+		*AnimSeq.GetPathName(), NumTracks, TransientSeconds * 1.0e6 / NumIterations, CachedSeconds * 1.0e6 / NumIterations);
+}
+
+struct FBenchmarkCurveDecompressionSettings final : public acl::decompression_settings
+{
+	constexpr bool is_track_type_supported(acl::track_type8 type) const { return type == acl::track_type8::float1f; }
+};
+
+/** Writes one curve at a time through the blended curve's UID lookup, the way curves were decompressed before the batched path. */
+struct FBenchmarkCurveWriter final : public acl::track_writer
+{
+	const TArray<FSmartName>& CompressedCurveNames;
+	FBlendedCurve& Curves;
+
+	FBenchmarkCurveWriter(const TArray<FSmartName>& CompressedCurveNames_, FBlendedCurve& Curves_)
+		: CompressedCurveNames(CompressedCurveNames_)
+		, Curves(Curves_)
+	{
+	}
+
+	void write_float1(uint32_t TrackIndex, rtm::scalarf_arg0 Value)
+	{
+		const FSmartName& CurveName = CompressedCurveNames[TrackIndex];
+		if (Curves.IsEnabled(CurveName.UID))
+		{
+			Curves.Set(CurveName.UID, rtm::scalar_cast(Value));
+		}
+	}
+};
+
+/*
+ * Times curve decompression of one sequence played forward at 30 FPS through a per-curve writer, then through the codec's
+ * batched path with a transient and with a cached curve remap. One curve in UsedCurveStride is marked in use,
+ * face rigs at a lower LOD typically only use part of their curves.
+ */
+static void BenchmarkSequenceDecompressCurves(const UAnimSequence& AnimSeq, int32 UsedCurveStride, int32 NumIterations)
+{
+	const FCompressedAnimSequence& CompressedData = AnimSeq.CompressedData;
+	const TArray<FSmartName>& CompressedCurveNames = CompressedData.CompressedCurveNames;
+	const int32 NumCurves = CompressedCurveNames.Num();
+	if (NumCurves == 0)
+	{
+		return;
+	}
+
+	int32 MaxUID = 0;
+	for (const FSmartName& CurveName : CompressedCurveNames)
+	{
+		MaxUID = FMath::Max<int32>(MaxUID, CurveName.UID);
+	}
+
+	TArray<uint16> UIDToArrayIndexLUT;
+	UIDToArrayIndexLUT.Init(MAX_uint16, MaxUID + 1);
+	int32 NumUsedCurves = 0;
+	for (int32 CurveIndex = 0; CurveIndex < NumCurves; CurveIndex += UsedCurveStride)
+	{
+		UIDToArrayIndexLUT[CompressedCurveNames[CurveIndex].UID] = (uint16)NumUsedCurves++;
+	}
+
+	FBlendedCurve Curves;
+	Curves.InitFrom(&UIDToArrayIndexLUT);
+
+	const acl::compressed_tracks* CompressedTracks = reinterpret_cast<const acl::compressed_tracks*>(CompressedData.CompressedCurveByteStream.GetData());
+	const UAnimCurveCompressionCodec* Codec = CompressedData.CurveCompressionCodec;
+
+	const float DeltaTime = 1.0f / 30.0f;
+	const float Duration = FMath::Max(AnimSeq.SequenceLength, DeltaTime);
+	double StartTime = FPlatformTime::Seconds();
+	{
+		acl::decompression_context<FBenchmarkCurveDecompressionSettings> Context;
+		float Time = 0.0f;
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Context.initialize(*CompressedTracks);
+			Context.seek(Time, acl::SampleRoundingPolicy::None);
+			FBenchmarkCurveWriter TrackWriter(CompressedCurveNames, Curves);
+			Context.decompress_tracks(TrackWriter);
+			Time = FMath::Fmod(Time + DeltaTime, Duration);
+		}
+	}
+	const double WriterSeconds = FPlatformTime::Seconds() - StartTime;
+
+	auto RunPlayback = [&]()
+	{
+		const double PlaybackStartTime = FPlatformTime::Seconds();
+		float Time = 0.0f;
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Codec->DecompressCurves(CompressedData, Curves, Time);
+			Time = FMath::Fmod(Time + DeltaTime, Duration);
+		}
+		return FPlatformTime::Seconds() - PlaybackStartTime;
+	};
+
+	const double TransientSeconds = RunPlayback();
+
+	FACLInstanceDecompressionCache Cache;
+	double CachedSeconds;
+	{
+		FACLDecompressionCacheScope CacheScope(Cache);
+		CachedSeconds = RunPlayback();
+	}
+
+	UE_LOG(LogAnimationCompression, Log, TEXT("%s: %d/%d curves, per-curve writer %.2f us/pose, batched %.2f us/pose, batched cached %.2f us/pose"),
+		*AnimSeq.GetPathName(), NumUsedCurves, NumCurves, WriterSeconds * 1.0e6 / NumIterations, TransientSeconds * 1.0e6 / NumIterations, CachedSeconds * 1.0e6 / NumIterations);
+}
+
+void FACLPlugin::BenchmarkDecompressBone(const TArray<FString>& Args)
+{
+	// Usage: ACL.BenchmarkDecompressBone [NameFilter] [NumBones=4] [NumIterations=10000]
+	const FString NameFilter = Args.Num() > 0 ? Args[0] : FString();
+	const int32 NumBones = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 4;
+	const int32 NumIterations = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 10000;
+
+	TGuardValue<ELogTimes::Type> DisableLogTimes(GPrintLogTimes, ELogTimes::None);
+	const ELogVerbosity::Type OldVerbosity = LogAnimationCompression.GetVerbosity();
+	LogAnimationCompression.SetVerbosity(ELogVerbosity::All);
+
+	for (const UAnimSequence* AnimSeq : GetObjectInstancesSorted<UAnimSequence>())
+	{
+		const UAnimBoneCompressionCodec* Codec = AnimSeq->CompressedData.BoneCompressionCodec;
+		if (!AnimSeq->CompressedData.CompressedDataStructure || (!NameFilter.IsEmpty() && !AnimSeq->GetName().Contains(NameFilter)))
+		{
+			continue;
+		}
+
+		if (Codec->IsA<UAnimBoneCompressionCodec_ACL>())
+		{
+			BenchmarkSequenceDecompressBone<UE4DefaultDecompressionSettings>(*AnimSeq, NumBones, NumIterations);
+		}
+		else if (Codec->IsA<UAnimBoneCompressionCodec_ACLSafe>())
+		{
+			BenchmarkSequenceDecompressBone<UE4SafeDecompressionSettings>(*AnimSeq, NumBones, NumIterations);
+		}
+		else if (Codec->IsA<UAnimBoneCompressionCodec_ACLCustom>())
+		{
+			BenchmarkSequenceDecompressBone<UE4CustomDecompressionSettings>(*AnimSeq, NumBones, NumIterations);
+		}
+	}
+
+	LogAnimationCompression.SetVerbosity(OldVerbosity);
+}
+
+void FACLPlugin::BenchmarkDecompressPose(const TArray<FString>& Args)
+{
+	// Usage: ACL.BenchmarkDecompressPose [NameFilter] [NumIterations=1000]
+	const FString NameFilter = Args.Num() > 0 ? Args[0] : FString();
+	const int32 NumIterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1000;
+
+	TGuardValue<ELogTimes::Type> DisableLogTimes(GPrintLogTimes, ELogTimes::None);
+	const ELogVerbosity::Type OldVerbosity = LogAnimationCompression.GetVerbosity();
+	LogAnimationCompression.SetVerbosity(ELogVerbosity::All);
+
+	for (const UAnimSequence* AnimSeq : GetObjectInstancesSorted<UAnimSequence>())
+	{
+		const UAnimBoneCompressionCodec* Codec = AnimSeq->CompressedData.BoneCompressionCodec;
+		if (!AnimSeq->CompressedData.CompressedDataStructure || (!NameFilter.IsEmpty() && !AnimSeq->GetName().Contains(NameFilter)))
+		{
+			continue;
+		}
+
+		if (Codec->IsA<UAnimBoneCompressionCodec_ACL>())
+		{
+			BenchmarkSequenceDecompressPose<UE4DefaultDecompressionSettings>(*AnimSeq, NumIterations);
+		}
+		else if (Codec->IsA<UAnimBoneCompressionCodec_ACLSafe>())
+		{
+			BenchmarkSequenceDecompressPose<UE4SafeDecompressionSettings>(*AnimSeq, NumIterations);
+		}
+		else if (Codec->IsA<UAnimBoneCompressionCodec_ACLCustom>())
+		{
+			BenchmarkSequenceDecompressPose<UE4CustomDecompressionSettings>(*AnimSeq, NumIterations);
+		}
+	}
+
+	LogAnimationCompression.SetVerbosity(OldVerbosity);
+}
+
+void FACLPlugin::BenchmarkDecompressCurves(const TArray<FString>& Args)
+{
+	// Usage: ACL.BenchmarkDecompressCurves [NameFilter] [UsedCurveStride=1] [NumIterations=1000]
+	const FString NameFilter = Args.Num() > 0 ? Args[0] : FString();
+	const int32 UsedCurveStride = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1;
+	const int32 NumIterations = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 1000;
+
+	TGuardValue<ELogTimes::Type> DisableLogTimes(GPrintLogTimes, ELogTimes::None);
+	const ELogVerbosity::Type OldVerbosity = LogAnimationCompression.GetVerbosity();
+	LogAnimationCompression.SetVerbosity(ELogVerbosity::All);
+
+	for (const UAnimSequence* AnimSeq : GetObjectInstancesSorted<UAnimSequence>())
+	{
+		const UAnimCurveCompressionCodec* Codec = AnimSeq->CompressedData.CurveCompressionCodec;
+		if (Codec == nullptr || !Codec->IsA<UAnimCurveCompressionCodec_ACL>() || (!NameFilter.IsEmpty() && !AnimSeq->GetName().Contains(NameFilter)))
+		{
+			continue;
+		}
+
+		BenchmarkSequenceDecompressCurves(*AnimSeq, UsedCurveStride, NumIterations);
+	}
+
+	LogAnimationCompression.SetVerbosity(OldVerbosity);
+}
 #endif
 
 void FACLPlugin::StartupModule()
 {
+	// Streamed segments are evicted once animation evaluation for the frame is over
+	TrimSegmentsHandle = FCoreDelegates::OnEndFrame.AddStatic(&FACLSegmentStreamer::TrimAll);
+
 #if WITH_ACL_CONSOLE_COMMANDS
 	if (!IsRunningCommandlet())
 	{
@@ -279,12 +622,35 @@ void FACLPlugin::StartupModule()
 			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::ListAnimSequences),
 			ECVF_Default
 		));
+
+		ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("ACL.BenchmarkDecompressBone"),
+			TEXT("Compares ns per bone of single-bone decompression with and without the context cache, and of batched decompression. Usage: ACL.BenchmarkDecompressBone [NameFilter] [NumBones] [NumIterations]"),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::BenchmarkDecompressBone),
+			ECVF_Default
+		));
+
+		ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("ACL.BenchmarkDecompressPose"),
+			TEXT("Compares us per pose of full pose decompression with transient contexts and track maps against an instance cache. Usage: ACL.BenchmarkDecompressPose [NameFilter] [NumIterations]"),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::BenchmarkDecompressPose),
+			ECVF_Default
+		));
+
+		ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("ACL.BenchmarkDecompressCurves"),
+			TEXT("Compares us per pose of curve decompression through a per-curve writer against the batched path, with and without an instance cache. Usage: ACL.BenchmarkDecompressCurves [NameFilter] [UsedCurveStride] [NumIterations]"),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FACLPlugin::BenchmarkDecompressCurves),
+			ECVF_Default
+		));
 	}
 #endif
 }
 
 void FACLPlugin::ShutdownModule()
 {
+	FCoreDelegates::OnEndFrame.Remove(TrimSegmentsHandle);
+
 #if WITH_ACL_CONSOLE_COMMANDS
 	for (IConsoleObject* Cmd : ConsoleCommands)
 	{
@@ -0,0 +1,313 @@
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "ACLSegmentStreamer.h"
+#include "AnimBoneCompressionCodec_ACLBase.h"
+#include "Animation/AnimSequence.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+#include <acl/core/utils.h>
+
+static TAutoConsoleVariable<float> CVarACLStreamingLookaheadTime(
+	TEXT("a.ACL.Streaming.LookaheadTime"),
+	0.5f,
+	TEXT("How many seconds of playback ahead of the current time have their ACL segments streamed in."));
+
+static TAutoConsoleVariable<int32> CVarACLStreamingMaxUnusedFrames(
+	TEXT("a.ACL.Streaming.MaxUnusedFrames"),
+	300,
+	TEXT("Streamed ACL segments unused for this many frames are evicted. Segments used during the last two frames are always kept."));
+
+static TAutoConsoleVariable<int32> CVarACLStreamingBudgetKB(
+	TEXT("a.ACL.Streaming.BudgetKB"),
+	0,
+	TEXT("When non-zero, the least recently used streamed ACL segments are evicted whenever those of every clip use more memory than this."));
+
+// The data of segments that have none of their own, nothing is ever read past the padding
+static const uint8 EmptySegmentData[FACLSegmentStreamer::PaddingSize] = { 0 };
+
+// Every live streamer, trimmed at the end of the frame
+static TArray<FACLSegmentStreamer*> GSegmentStreamers;
+static FCriticalSection GSegmentStreamersLock;
+
+uint32 FACLSegmentStreamer::GetResidentSize(const acl::CompressedClip& Clip)
+{
+	const acl::ClipHeader& ClipHeader = acl::get_clip_header(Clip);
+	if (ClipHeader.num_segments < 2)
+	{
+		return Clip.get_size();
+	}
+
+	// Everything up to the end of the first segment, segments are stored back to back
+	for (uint32 SegmentIndex = 1; SegmentIndex < ClipHeader.num_segments; ++SegmentIndex)
+	{
+		const acl::SegmentDataRange Range = acl::get_segment_data_range(Clip, SegmentIndex);
+		if (Range.size != 0)
+		{
+			return Range.offset;
+		}
+	}
+
+	return Clip.get_size();
+}
+
+FACLSegmentStreamer::FACLSegmentStreamer(const TArrayView<uint8> ResidentByteStream, FByteBulkData& SegmentBulkData_)
+	: Clip(*reinterpret_cast<const acl::CompressedClip*>(ResidentByteStream.GetData()))
+	, SegmentBulkData(SegmentBulkData_)
+	, NumMisses(0)
+{
+	const uint32 ResidentSize = GetResidentSize(Clip);
+	checkf(ResidentSize + PaddingSize <= (uint32)ResidentByteStream.Num(), TEXT("The resident ACL byte stream is missing its padding"));
+
+	// Without a file to stream from, e.g. in the editor, the segment data is loaded already and kept as is
+	if (SegmentBulkData.IsBulkDataLoaded())
+	{
+		const int32 BulkDataSize = SegmentBulkData.GetBulkDataSize();
+		LoadedSegmentData.SetNumZeroed(BulkDataSize + PaddingSize);
+		FMemory::Memcpy(LoadedSegmentData.GetData(), SegmentBulkData.LockReadOnly(), BulkDataSize);
+		SegmentBulkData.Unlock();
+	}
+
+	const uint32 NumSegments = acl::get_clip_header(Clip).num_segments;
+	Pages.SetNum(NumSegments);
+
+	for (uint32 SegmentIndex = 0; SegmentIndex < NumSegments; ++SegmentIndex)
+	{
+		const acl::SegmentDataRange Range = acl::get_segment_data_range(Clip, SegmentIndex);
+
+		FPage& Page = Pages[SegmentIndex];
+		Page.State = Resident;
+		Page.LastUseFrame = 0;
+		Page.Size = Range.size;
+		Page.bPinned = true;
+
+		if (Range.size == 0)
+		{
+			Page.Data = const_cast<uint8*>(&EmptySegmentData[0]);
+		}
+		else if (Range.offset < ResidentSize)
+		{
+			Page.Data = ResidentByteStream.GetData() + Range.offset;
+		}
+		else
+		{
+			Page.BulkDataOffset = Range.offset - ResidentSize;
+			checkf(Page.BulkDataOffset + Page.Size <= (uint32)SegmentBulkData.GetBulkDataSize(), TEXT("ACL segment %u is outside of the streamed data"), SegmentIndex);
+
+			if (LoadedSegmentData.Num() != 0)
+			{
+				Page.Data = LoadedSegmentData.GetData() + Page.BulkDataOffset;
+			}
+			else
+			{
+				Page.State = Unloaded;
+				Page.bPinned = false;
+			}
+		}
+	}
+
+	FScopeLock Lock(&GSegmentStreamersLock);
+	GSegmentStreamers.Add(this);
+}
+
+FACLSegmentStreamer::~FACLSegmentStreamer()
+{
+	{
+		FScopeLock Lock(&GSegmentStreamersLock);
+		GSegmentStreamers.RemoveSingleSwap(this);
+	}
+
+	for (FPage& Page : Pages)
+	{
+		ReleasePage(Page);
+	}
+}
+
+void FACLSegmentStreamer::PrefetchForPlayback(float Time)
+{
+	Prefetch(Time, CVarACLStreamingLookaheadTime.GetValueOnAnyThread());
+}
+
+void FACLSegmentStreamer::Prefetch(float StartTime, float Duration)
+{
+	const acl::ClipHeader& ClipHeader = acl::get_clip_header(Clip);
+	const float ClipDuration = acl::calculate_duration(ClipHeader.num_samples, ClipHeader.sample_rate);
+
+	// The range is extended by one sample to include the key frame interpolated towards at its end
+	StartTime = FMath::Clamp(StartTime, 0.0f, ClipDuration);
+	const float EndTime = StartTime + FMath::Max(Duration, 0.0f) + (ClipHeader.sample_rate > 0.0f ? 1.0f / ClipHeader.sample_rate : 0.0f);
+
+	const int32 FirstSegmentIndex = acl::get_segment_index_at_time(Clip, StartTime);
+	const int32 LastSegmentIndex = acl::get_segment_index_at_time(Clip, FMath::Min(EndTime, ClipDuration));
+	for (int32 SegmentIndex = FirstSegmentIndex; SegmentIndex <= LastSegmentIndex; ++SegmentIndex)
+	{
+		RequestPage(SegmentIndex);
+	}
+
+	// Looping playback continues from the start of the clip
+	if (EndTime > ClipDuration && FirstSegmentIndex > 0)
+	{
+		const int32 WrappedSegmentIndex = acl::get_segment_index_at_time(Clip, FMath::Min(EndTime - ClipDuration, ClipDuration));
+		for (int32 SegmentIndex = 0; SegmentIndex <= FMath::Min(WrappedSegmentIndex, FirstSegmentIndex - 1); ++SegmentIndex)
+		{
+			RequestPage(SegmentIndex);
+		}
+	}
+}
+
+int32 FACLSegmentStreamer::GetNumResidentSegments() const
+{
+	int32 NumResidentSegments = 0;
+	for (const FPage& Page : Pages)
+	{
+		NumResidentSegments += Page.State.Load(EMemoryOrder::Relaxed) == Resident ? 1 : 0;
+	}
+	return NumResidentSegments;
+}
+
+const uint8_t* FACLSegmentStreamer::get_segment_data(uint32_t SegmentIndex)
+{
+	FPage& Page = Pages[SegmentIndex];
+	if (Page.State.Load() != Resident)
+	{
+		NumMisses.IncrementExchange();
+		return nullptr;
+	}
+
+	Page.LastUseFrame.Store((uint32)GFrameCounter, EMemoryOrder::Relaxed);
+	return Page.Data;
+}
+
+void FACLSegmentStreamer::RequestPage(int32 SegmentIndex)
+{
+	FPage& Page = Pages[SegmentIndex];
+
+	uint8 ExpectedState = Unloaded;
+	if (Page.State.Load(EMemoryOrder::Relaxed) != Unloaded || !Page.State.CompareExchange(ExpectedState, Loading))
+	{
+		return;
+	}
+
+	// Freshly requested pages count as used so they survive until playback reaches them
+	Page.LastUseFrame.Store((uint32)GFrameCounter, EMemoryOrder::Relaxed);
+
+	Page.Data = (uint8*)FMemory::Malloc(Page.Size + PaddingSize, 16);
+	FMemory::Memzero(Page.Data + Page.Size, PaddingSize);
+
+	FBulkDataIORequestCallBack Callback = [this, SegmentIndex](bool bWasCancelled, IBulkDataIORequest*)
+	{
+		Pages[SegmentIndex].State = bWasCancelled ? Failed : Resident;
+	};
+
+	// The request can complete before CreateStreamingRequest returns, releasing the page waits on this lock until Request is set
+	FScopeLock Lock(&Page.RequestLock);
+	Page.Request = SegmentBulkData.CreateStreamingRequest(Page.BulkDataOffset, Page.Size, AIOP_High, &Callback, Page.Data);
+	if (Page.Request == nullptr)
+	{
+		Page.State = Failed;
+	}
+}
+
+void FACLSegmentStreamer::DeleteRequest(FPage& Page)
+{
+	FScopeLock Lock(&Page.RequestLock);
+	if (Page.Request != nullptr)
+	{
+		Page.Request->WaitCompletion();
+		delete Page.Request;
+		Page.Request = nullptr;
+	}
+}
+
+void FACLSegmentStreamer::ReleasePage(FPage& Page)
+{
+	if (Page.bPinned)
+	{
+		return;
+	}
+
+	DeleteRequest(Page);
+
+	FMemory::Free(Page.Data);
+	Page.Data = nullptr;
+	Page.State = Unloaded;
+}
+
+void FACLSegmentStreamer::TrimAll()
+{
+	struct FEvictionCandidate
+	{
+		FACLSegmentStreamer* Streamer;
+		FPage* Page;
+		uint32 LastUseFrame;
+	};
+
+	const uint32 CurrentFrame = (uint32)GFrameCounter;
+
+	// Contexts only keep segment data until their next seek, pages used during the last two frames are never evicted
+	const uint32 MaxUnusedFrames = (uint32)FMath::Max(CVarACLStreamingMaxUnusedFrames.GetValueOnGameThread(), 2);
+	const uint64 BudgetSize = (uint64)FMath::Max(CVarACLStreamingBudgetKB.GetValueOnGameThread(), 0) * 1024;
+
+	FScopeLock Lock(&GSegmentStreamersLock);
+
+	TArray<FEvictionCandidate> Candidates;
+	uint64 ResidentSize = 0;
+
+	for (FACLSegmentStreamer* Streamer : GSegmentStreamers)
+	{
+		for (FPage& Page : Streamer->Pages)
+		{
+			const uint8 State = Page.State.Load();
+			if (Page.bPinned || (State != Resident && State != Failed))
+			{
+				continue;
+			}
+
+			Streamer->DeleteRequest(Page);
+
+			const uint32 LastUseFrame = Page.LastUseFrame.Load(EMemoryOrder::Relaxed);
+			if (State == Failed || CurrentFrame - LastUseFrame > MaxUnusedFrames)
+			{
+				Streamer->ReleasePage(Page);
+				continue;
+			}
+
+			ResidentSize += Page.Size;
+			if (CurrentFrame - LastUseFrame >= 2)
+			{
+				Candidates.Add({ Streamer, &Page, LastUseFrame });
+			}
+		}
+	}
+
+	if (BudgetSize != 0 && ResidentSize > BudgetSize)
+	{
+		Candidates.Sort([CurrentFrame](const FEvictionCandidate& Lhs, const FEvictionCandidate& Rhs) { return CurrentFrame - Lhs.LastUseFrame > CurrentFrame - Rhs.LastUseFrame; });
+
+		for (const FEvictionCandidate& Candidate : Candidates)
+		{
+			if (ResidentSize <= BudgetSize)
+			{
+				break;
+			}
+
+			ResidentSize -= Candidate.Page->Size;
+			Candidate.Streamer->ReleasePage(*Candidate.Page);
+		}
+	}
+}
+
+void PrefetchACLSegments(const UAnimSequence& AnimSeq, float StartTime, float Duration)
+{
+	const UAnimBoneCompressionCodec* Codec = AnimSeq.CompressedData.BoneCompressionCodec;
+	if (!AnimSeq.CompressedData.CompressedDataStructure || Codec == nullptr || !Codec->IsA<UAnimBoneCompressionCodec_ACLBase>())
+	{
+		return;
+	}
+
+	const FACLCompressedAnimData& AnimData = static_cast<const FACLCompressedAnimData&>(*AnimSeq.CompressedData.CompressedDataStructure);
+	if (FACLSegmentStreamer* SegmentStreamer = AnimData.GetSegmentStreamer())
+	{
+		SegmentStreamer->Prefetch(StartTime, Duration);
+	}
+}
@@ -3,8 +3,14 @@
 #include "ACLStatsDumpCommandlet.h"
 
 #if WITH_EDITOR
+#include "Runtime/Core/Public/Async/Async.h"
 #include "Runtime/Core/Public/HAL/FileManagerGeneric.h"
+#include "Runtime/Core/Public/HAL/PlatformProcess.h"
 #include "Runtime/Core/Public/HAL/PlatformTime.h"
+#include "Runtime/Core/Public/Misc/CommandLine.h"
+#include "Runtime/Core/Public/Misc/FileHelper.h"
+#include "Runtime/Core/Public/Misc/MemStack.h"
+#include "Runtime/Core/Public/Serialization/MemoryWriter.h"
 #include "Runtime/CoreUObject/Public/UObject/UObjectIterator.h"
 #include "Runtime/Engine/Classes/Animation/AnimBoneCompressionSettings.h"
 #include "Runtime/Engine/Classes/Animation/AnimCompress.h"
@@ -42,6 +48,14 @@
 //		-noacl: Disables ACL compression
 //		-MasterTolerance=<tolerance>: The error threshold used by automatic compression
 //		-resume: If present, clip extraction or compression will continue where it left off
+//		-jobs=<count>: Prefetch only: number of input clips read and parsed ahead on worker threads (bounds the memory used),
+//			clips are still compressed and timed one at a time, defaults to 1
+//		-processes=<count>: Splits the clips between this many child processes, defaults to 1. The processes compete for
+//			the CPU, so their compression and decompression timings are flagged as unreliable in the stats
+//
+// Compression writes a detailed <clip>_stats.sjson file per clip as well as a summary record per clip appended
+// to stats_shard_<index>.shard.sjson, one shard per process. Resuming skips the clips found in any shard and
+// once every clip is done, the shards are merged into summary.sjson with the aggregated stats of each codec.
 //////////////////////////////////////////////////////////////////////////
 
 class UE4SJSONStreamWriter final : public sjson::StreamWriter
@@ -424,6 +438,355 @@ static void DumpClipDetailedError(const acl::AnimationClip& ACLClip, const acl::
 	};
 }
 
+/** The summary of a clip compressed with one codec, as written to the stats shards. */
+struct FCodecStats
+{
+	FString CodecName;
+	double CompressionTimeMs = 0.0;
+	double DecompressionTimeNsPerPose = 0.0;
+	int32 CompressedSize = 0;
+	float MaxError = 0.0f;
+};
+
+struct FClipStats
+{
+	FString ClipName;
+	uint32 ACLRawSize = 0;
+	// Processes compressing clips concurrently when this clip was timed, timings are only reliable with one
+	int32 NumProcesses = 1;
+	TArray<FCodecStats> Codecs;
+};
+
+// Number of times every sample is decompressed when measuring the decompression time
+static const int32 NumDecompressionPasses = 10;
+
+static double MeasureDecompressionTimeNsPerPose(const UAnimSequence* UE4Clip)
+{
+	const UAnimBoneCompressionCodec* Codec = UE4Clip->CompressedData.BoneCompressionCodec;
+	const int32 NumTracks = UE4Clip->CompressedData.CompressedTrackToSkeletonMapTable.Num();
+	if (Codec == nullptr || !UE4Clip->CompressedData.CompressedDataStructure || NumTracks == 0)
+	{
+		return 0.0;
+	}
+
+	// Every track is requested, mapped to the atom of the same index
+	BoneTrackArray RotationPairs;
+	BoneTrackArray TranslationPairs;
+	BoneTrackArray ScalePairs;
+	for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex)
+	{
+		RotationPairs.Add(BoneTrackPair(TrackIndex, TrackIndex));
+		TranslationPairs.Add(BoneTrackPair(TrackIndex, TrackIndex));
+	}
+
+	if (UE4ClipHasScale(UE4Clip))
+	{
+		ScalePairs = RotationPairs;
+	}
+
+	TArray<FTransform> Atoms;
+	Atoms.SetNum(NumTracks);
+	TArrayView<FTransform> AtomsView(Atoms);
+
+	const ICompressedAnimData& AnimData = *UE4Clip->CompressedData.CompressedDataStructure;
+	FAnimSequenceDecompressionContext DecompContext(UE4Clip->SequenceLength, UE4Clip->Interpolation, UE4Clip->GetFName(), AnimData);
+
+	const int32 NumSamples = FMath::Max(UE4Clip->GetRawNumberOfFrames(), 1);
+	const float SampleInterval = NumSamples > 1 ? (UE4Clip->SequenceLength / float(NumSamples - 1)) : 0.0f;
+
+	auto DecompressAllSamples = [&]()
+	{
+		for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+		{
+			FMemMark Mark(FMemStack::Get());
+			DecompContext.Seek(FMath::Min(SampleIndex * SampleInterval, UE4Clip->SequenceLength));
+			Codec->DecompressPose(DecompContext, RotationPairs, TranslationPairs, ScalePairs, AtomsView);
+		}
+	};
+
+	// Warm up the caches once, we measure playback of a resident clip
+	DecompressAllSamples();
+
+	const uint64 StartTimeCycles = FPlatformTime::Cycles64();
+	for (int32 PassIndex = 0; PassIndex < NumDecompressionPasses; ++PassIndex)
+	{
+		DecompressAllSamples();
+	}
+	const uint64 ElapsedCycles = FPlatformTime::Cycles64() - StartTimeCycles;
+
+	return FPlatformTime::ToSeconds64(ElapsedCycles) * 1.0e9 / double(NumSamples * NumDecompressionPasses);
+}
+
+static void WriteClipStats(const FClipStats& Stats, sjson::Writer& Writer)
+{
+	Writer["clip"] = [&](sjson::ObjectWriter& Writer)
+	{
+		Writer["name"] = TCHAR_TO_ANSI(*Stats.ClipName);
+		Writer["acl_raw_size"] = Stats.ACLRawSize;
+		Writer["num_processes"] = Stats.NumProcesses;
+		Writer["codecs"] = [&](sjson::ArrayWriter& Writer)
+		{
+			for (const FCodecStats& CodecStats : Stats.Codecs)
+			{
+				Writer.push([&](sjson::ObjectWriter& Writer)
+				{
+					Writer["codec"] = TCHAR_TO_ANSI(*CodecStats.CodecName);
+					Writer["compression_ms"] = CodecStats.CompressionTimeMs;
+					Writer["decompression_ns_per_pose"] = CodecStats.DecompressionTimeNsPerPose;
+					Writer["compressed_size"] = CodecStats.CompressedSize;
+					Writer["max_error"] = CodecStats.MaxError;
+				});
+			}
+		};
+	};
+}
+
+static bool ReadClipStats(sjson::Parser& Parser, FClipStats& OutStats)
+{
+	sjson::StringView ClipName;
+	if (!Parser.object_begins("clip")
+		|| !Parser.read("name", ClipName)
+		|| !Parser.read("acl_raw_size", OutStats.ACLRawSize)
+		|| !Parser.try_read("num_processes", OutStats.NumProcesses, 1)
+		|| !Parser.array_begins("codecs"))
+	{
+		return false;
+	}
+
+	OutStats.ClipName = FString(int32(ClipName.size()), ClipName.c_str());
+
+	while (!Parser.try_array_ends())
+	{
+		sjson::StringView CodecName;
+		FCodecStats& CodecStats = OutStats.Codecs.AddDefaulted_GetRef();
+		if (!Parser.object_begins()
+			|| !Parser.read("codec", CodecName)
+			|| !Parser.read("compression_ms", CodecStats.CompressionTimeMs)
+			|| !Parser.read("decompression_ns_per_pose", CodecStats.DecompressionTimeNsPerPose)
+			|| !Parser.read("compressed_size", CodecStats.CompressedSize)
+			|| !Parser.read("max_error", CodecStats.MaxError)
+			|| !Parser.object_ends())
+		{
+			return false;
+		}
+
+		CodecStats.CodecName = FString(int32(CodecName.size()), CodecName.c_str());
+	}
+
+	return Parser.object_ends();
+}
+
+/*
+ * Appends clip summaries to the stats shard of this process.
+ * Records are serialized in memory and written at once so an interrupted run can only leave a partial last record behind,
+ * ReadStatsShards drops it before the shard is appended to again.
+ */
+class FStatsShardWriter
+{
+public:
+	explicit FStatsShardWriter(const FString& ShardPath)
+		: File(IFileManager::Get().CreateFileWriter(*ShardPath, FILEWRITE_Append))
+	{}
+
+	~FStatsShardWriter()
+	{
+		delete File;
+	}
+
+	bool IsValid() const { return File != nullptr; }
+
+	void Write(const FClipStats& Stats)
+	{
+		TArray<uint8> Buffer;
+		FMemoryWriter MemoryWriter(Buffer);
+		UE4SJSONStreamWriter StreamWriter(&MemoryWriter);
+		sjson::Writer Writer(StreamWriter);
+		WriteClipStats(Stats, Writer);
+
+		File->Serialize(Buffer.GetData(), Buffer.Num());
+		File->Flush();
+	}
+
+private:
+	FArchive* File;
+};
+
+static const TCHAR* StatsShardExtension = TEXT(".shard.sjson");
+
+// Number of input clips compressed between garbage collections of the temporary clips and skeletons
+static const int32 GarbageCollectionInterval = 32;
+
+static FString GetStatsShardPath(const FString& OutputDir, int32 ShardIndex)
+{
+	return FPaths::Combine(*OutputDir, *FString::Printf(TEXT("stats_shard_%d%s"), ShardIndex, StatsShardExtension));
+}
+
+/*
+ * Reads every clip summary from the shards in the output directory.
+ * Partial records left by an interrupted run are ignored and when requested, truncated so the shard can be appended to again.
+ * Only the parent process repairs shards, child processes may be reading shards while siblings write to them.
+ */
+static void ReadStatsShards(const FString& OutputDir, bool bRepairPartialRecords, TArray<FClipStats>& OutClipStats)
+{
+	FFileManagerGeneric FileManager;
+	TArray<FString> Files;
+	FileManager.FindFiles(Files, *OutputDir, StatsShardExtension);
+	Files.Sort();
+
+	TSet<FString> ClipNames;
+	for (const FString& Filename : Files)
+	{
+		const FString ShardPath = FPaths::Combine(*OutputDir, *Filename);
+
+		TArray<uint8> ShardData;
+		if (!FFileHelper::LoadFileToArray(ShardData, *ShardPath))
+		{
+			continue;
+		}
+
+		sjson::Parser Parser(reinterpret_cast<const char*>(ShardData.GetData()), ShardData.Num());
+		size_t ValidSize = 0;
+
+		while (!Parser.remainder_is_comments_and_whitespace())
+		{
+			FClipStats Stats;
+			if (!ReadClipStats(Parser, Stats))
+			{
+				break;
+			}
+
+			ValidSize = Parser.save_state().offset;
+
+			// A clip can be in several shards if the number of processes changed between runs, the first one wins
+			bool bIsAlreadyInSet = false;
+			ClipNames.Add(Stats.ClipName, &bIsAlreadyInSet);
+			if (!bIsAlreadyInSet)
+			{
+				OutClipStats.Add(MoveTemp(Stats));
+			}
+		}
+
+		if (bRepairPartialRecords && !Parser.remainder_is_comments_and_whitespace())
+		{
+			UE_LOG(LogAnimationCompression, Warning, TEXT("Dropping a partial record at the end of stats shard: %s"), *ShardPath);
+			FFileHelper::SaveArrayToFile(TArrayView<const uint8>(ShardData.GetData(), int32(ValidSize)), *ShardPath);
+		}
+	}
+}
+
+/** Merges the stats shards and writes the aggregated throughput and quality of every codec. */
+static void WriteStatsSummary(const FString& OutputDir)
+{
+	TArray<FClipStats> AllClipStats;
+	ReadStatsShards(OutputDir, true, AllClipStats);
+
+	struct FCodecSummary
+	{
+		int32 NumClips = 0;
+		double TotalCompressionTimeMs = 0.0;
+		double TotalDecompressionTimeNsPerPose = 0.0;
+		double MaxDecompressionTimeNsPerPose = 0.0;
+		uint64 TotalRawSize = 0;
+		uint64 TotalCompressedSize = 0;
+		float MaxError = 0.0f;
+		FString WorstClipName;
+	};
+
+	TMap<FString, FCodecSummary> CodecSummaries;
+	int32 NumClipsTimedConcurrently = 0;
+	for (const FClipStats& ClipStats : AllClipStats)
+	{
+		NumClipsTimedConcurrently += ClipStats.NumProcesses > 1 ? 1 : 0;
+		for (const FCodecStats& CodecStats : ClipStats.Codecs)
+		{
+			FCodecSummary& Summary = CodecSummaries.FindOrAdd(CodecStats.CodecName);
+			Summary.NumClips++;
+			Summary.TotalCompressionTimeMs += CodecStats.CompressionTimeMs;
+			Summary.TotalDecompressionTimeNsPerPose += CodecStats.DecompressionTimeNsPerPose;
+			Summary.MaxDecompressionTimeNsPerPose = FMath::Max(Summary.MaxDecompressionTimeNsPerPose, CodecStats.DecompressionTimeNsPerPose);
+			Summary.TotalRawSize += ClipStats.ACLRawSize;
+			Summary.TotalCompressedSize += CodecStats.CompressedSize;
+
+			if (CodecStats.MaxError >= Summary.MaxError)
+			{
+				Summary.MaxError = CodecStats.MaxError;
+				Summary.WorstClipName = ClipStats.ClipName;
+			}
+		}
+	}
+
+	CodecSummaries.KeySort(TLess<FString>());
+
+	const FString SummaryPath = FPaths::Combine(*OutputDir, TEXT("summary.sjson"));
+	FArchive* SummaryWriter = IFileManager::Get().CreateFileWriter(*SummaryPath);
+	if (SummaryWriter == nullptr)
+	{
+		UE_LOG(LogAnimationCompression, Error, TEXT("Failed to create the stats summary: %s"), *SummaryPath);
+		return;
+	}
+
+	UE4SJSONStreamWriter StreamWriter(SummaryWriter);
+	sjson::Writer Writer(StreamWriter);
+
+	// Timings measured while several processes compressed at once are skewed by the contention
+	const bool bTimingsReliable = NumClipsTimedConcurrently == 0;
+	if (!bTimingsReliable)
+	{
+		UE_LOG(LogAnimationCompression, Warning, TEXT("%d of %d clips were timed with several processes running, compression and decompression timings are unreliable, run with -processes=1 to measure them"),
+			NumClipsTimedConcurrently, AllClipStats.Num());
+	}
+
+	Writer["num_clips"] = AllClipStats.Num();
+	Writer["timings_reliable"] = bTimingsReliable;
+	Writer["num_clips_timed_concurrently"] = NumClipsTimedConcurrently;
+	Writer["codecs"] = [&](sjson::ArrayWriter& Writer)
+	{
+		for (const TPair<FString, FCodecSummary>& Pair : CodecSummaries)
+		{
+			const FCodecSummary& Summary = Pair.Value;
+			const double CompressionSeconds = Summary.TotalCompressionTimeMs * 1.0e-3;
+			const double CompressionThroughputMBPerSec = CompressionSeconds > 0.0 ? (double(Summary.TotalRawSize) / (1024.0 * 1024.0) / CompressionSeconds) : 0.0;
+			const double AvgDecompressionTimeNsPerPose = Summary.TotalDecompressionTimeNsPerPose / Summary.NumClips;
+			const double CompressionRatio = Summary.TotalCompressedSize != 0 ? (double(Summary.TotalRawSize) / double(Summary.TotalCompressedSize)) : 0.0;
+
+			Writer.push([&](sjson::ObjectWriter& Writer)
+			{
+				Writer["codec"] = TCHAR_TO_ANSI(*Pair.Key);
+				Writer["num_clips"] = Summary.NumClips;
+				Writer["total_compression_ms"] = Summary.TotalCompressionTimeMs;
+				Writer["avg_compression_ms"] = Summary.TotalCompressionTimeMs / Summary.NumClips;
+				Writer["compression_throughput_mb_per_sec"] = CompressionThroughputMBPerSec;
+				Writer["avg_decompression_ns_per_pose"] = AvgDecompressionTimeNsPerPose;
+				Writer["max_decompression_ns_per_pose"] = Summary.MaxDecompressionTimeNsPerPose;
+				Writer["total_raw_size"] = static_cast<uint64_t>(Summary.TotalRawSize);
+				Writer["total_compressed_size"] = static_cast<uint64_t>(Summary.TotalCompressedSize);
+				Writer["compression_ratio"] = CompressionRatio;
+				Writer["max_error"] = Summary.MaxError;
+				Writer["worst_clip"] = TCHAR_TO_ANSI(*Summary.WorstClipName);
+			});
+
+			UE_LOG(LogAnimationCompression, Display, TEXT("%s: %d clips, %.2f ms/clip (%.2f MB/s), %.1f ns/pose, %llu -> %llu bytes (%.2fx), max error %.4f cm (%s)"),
+				*Pair.Key, Summary.NumClips, Summary.TotalCompressionTimeMs / Summary.NumClips, CompressionThroughputMBPerSec, AvgDecompressionTimeNsPerPose,
+				Summary.TotalRawSize, Summary.TotalCompressedSize, CompressionRatio, Summary.MaxError, *Summary.WorstClipName);
+		}
+	};
+
+	SummaryWriter->Close();
+	delete SummaryWriter;
+}
+
+/** Records the result of a successful compression and measures how fast the clip decompresses. */
+static const FCodecStats& AddCodecStats(FClipStats& ClipStats, const TCHAR* CodecName, const UAnimSequence* UE4Clip, double CompressionTimeSec, int32 CompressedSize, float MaxError)
+{
+	FCodecStats& CodecStats = ClipStats.Codecs.AddDefaulted_GetRef();
+	CodecStats.CodecName = CodecName;
+	CodecStats.CompressionTimeMs = CompressionTimeSec * 1.0e3;
+	CodecStats.DecompressionTimeNsPerPose = MeasureDecompressionTimeNsPerPose(UE4Clip);
+	CodecStats.CompressedSize = CompressedSize;
+	CodecStats.MaxError = MaxError;
+	return CodecStats;
+}
+
 struct FCompressionContext
 {
 	UAnimBoneCompressionSettings* AutoCompressor;
@@ -438,6 +801,8 @@ struct FCompressionContext
 
 	uint32 ACLRawSize;
 	int32 UE4RawSize;
+
+	FClipStats Stats;
 };
 
 static FString GetCodecName(UAnimBoneCompressionCodec* Codec)
@@ -483,6 +848,8 @@ static void CompressWithUE4Auto(FCompressionContext& Context, bool PerformExhaus
 		const double UE4CompressionRatio = double(Context.UE4RawSize) / double(CompressedSize);
 		const double ACLCompressionRatio = double(Context.ACLRawSize) / double(CompressedSize);
 
+		const FCodecStats& CodecStats = AddCodecStats(Context.Stats, TEXT("ue4_auto"), Context.UE4Clip, UE4ElapsedTimeSec, CompressedSize, MaxError);
+
 		Writer["ue4_auto"] = [&](sjson::ObjectWriter& Writer)
 		{
 			Writer["algorithm_name"] = TCHAR_TO_ANSI(*Context.UE4Clip->BoneCompressionSettings->GetClass()->GetName());
@@ -491,6 +858,7 @@ static void CompressWithUE4Auto(FCompressionContext& Context, bool PerformExhaus
 			Writer["ue4_compression_ratio"] = UE4CompressionRatio;
 			Writer["acl_compression_ratio"] = ACLCompressionRatio;
 			Writer["compression_time"] = UE4ElapsedTimeSec;
+			Writer["decompression_ns_per_pose"] = CodecStats.DecompressionTimeNsPerPose;
 			Writer["ue4_max_error"] = UE4ErrorStats.MaxError;
 			Writer["ue4_avg_error"] = UE4ErrorStats.AverageError;
 			Writer["ue4_worst_bone"] = UE4ErrorStats.MaxErrorBone;
@@ -547,6 +915,8 @@ static void CompressWithACL(FCompressionContext& Context, bool PerformExhaustive
 		const double UE4CompressionRatio = double(Context.UE4RawSize) / double(CompressedSize);
 		const double ACLCompressionRatio = double(Context.ACLRawSize) / double(CompressedSize);
 
+		const FCodecStats& CodecStats = AddCodecStats(Context.Stats, TEXT("ue4_acl"), Context.UE4Clip, ACLElapsedTimeSec, CompressedSize, MaxError);
+
 		Writer["ue4_acl"] = [&](sjson::ObjectWriter& Writer)
 		{
 			Writer["algorithm_name"] = TCHAR_TO_ANSI(*Context.UE4Clip->BoneCompressionSettings->GetClass()->GetName());
@@ -555,6 +925,7 @@ static void CompressWithACL(FCompressionContext& Context, bool PerformExhaustive
 			Writer["ue4_compression_ratio"] = UE4CompressionRatio;
 			Writer["acl_compression_ratio"] = ACLCompressionRatio;
 			Writer["compression_time"] = ACLElapsedTimeSec;
+			Writer["decompression_ns_per_pose"] = CodecStats.DecompressionTimeNsPerPose;
 			Writer["ue4_max_error"] = UE4ErrorStats.MaxError;
 			Writer["ue4_avg_error"] = UE4ErrorStats.AverageError;
 			Writer["ue4_worst_bone"] = UE4ErrorStats.MaxErrorBone;
@@ -636,6 +1007,8 @@ static void CompressWithUE4KeyReduction(FCompressionContext& Context, bool Perfo
 		const double UE4CompressionRatio = double(Context.UE4RawSize) / double(CompressedSize);
 		const double ACLCompressionRatio = double(Context.ACLRawSize) / double(CompressedSize);
 
+		const FCodecStats& CodecStats = AddCodecStats(Context.Stats, TEXT("ue4_keyreduction"), Context.UE4Clip, UE4ElapsedTimeSec, CompressedSize, MaxError);
+
 		Writer["ue4_keyreduction"] = [&](sjson::ObjectWriter& Writer)
 		{
 			Writer["algorithm_name"] = TCHAR_TO_ANSI(*Context.UE4Clip->BoneCompressionSettings->GetClass()->GetName());
@@ -644,6 +1017,7 @@ static void CompressWithUE4KeyReduction(FCompressionContext& Context, bool Perfo
 			Writer["ue4_compression_ratio"] = UE4CompressionRatio;
 			Writer["acl_compression_ratio"] = ACLCompressionRatio;
 			Writer["compression_time"] = UE4ElapsedTimeSec;
+			Writer["decompression_ns_per_pose"] = CodecStats.DecompressionTimeNsPerPose;
 			Writer["ue4_max_error"] = UE4ErrorStats.MaxError;
 			Writer["ue4_avg_error"] = UE4ErrorStats.AverageError;
 			Writer["ue4_worst_bone"] = UE4ErrorStats.MaxErrorBone;
@@ -872,6 +1246,49 @@ static void CompressWithUE4KeyReduction(FCompressionContext& Context, bool Perfo
 	}
 }
 
+static bool IsClipInShard(const FString& ClipName, int32 ShardIndex, int32 NumShards)
+{
+	return NumShards <= 1 || int32(GetTypeHash(ClipName) % uint32(NumShards)) == ShardIndex;
+}
+
+/** Runs this commandlet again in child processes, each one handling a shard of the clips, and waits for them. */
+static bool RunChildProcesses(int32 NumChildProcesses, const FString& OutputDir)
+{
+	const FString ExecutablePath = FPlatformProcess::ExecutablePath();
+
+	TArray<FProcHandle> ChildProcesses;
+	for (int32 ShardIndex = 0; ShardIndex < NumChildProcesses; ++ShardIndex)
+	{
+		const FString LogPath = FPaths::Combine(*OutputDir, *FString::Printf(TEXT("stats_shard_%d.log"), ShardIndex));
+		const FString ChildParams = FString::Printf(TEXT("%s -shard=%d -numshards=%d \"-abslog=%s\""), FCommandLine::Get(), ShardIndex, NumChildProcesses, *LogPath);
+
+		FProcHandle ChildProcess = FPlatformProcess::CreateProc(*ExecutablePath, *ChildParams, false, true, true, nullptr, 0, nullptr, nullptr);
+		if (!ChildProcess.IsValid())
+		{
+			UE_LOG(LogAnimationCompression, Error, TEXT("Failed to start the child process for stats shard %d"), ShardIndex);
+			continue;
+		}
+
+		ChildProcesses.Add(ChildProcess);
+	}
+
+	bool bSucceeded = ChildProcesses.Num() == NumChildProcesses;
+	for (FProcHandle& ChildProcess : ChildProcesses)
+	{
+		FPlatformProcess::WaitForProc(ChildProcess);
+
+		int32 ReturnCode = 0;
+		if (!FPlatformProcess::GetProcReturnCode(ChildProcess, &ReturnCode) || ReturnCode != 0)
+		{
+			bSucceeded = false;
+		}
+
+		FPlatformProcess::CloseProc(ChildProcess);
+	}
+
+	return bSucceeded;
+}
+
 struct CompressAnimationsFunctor
 {
 	template<typename ObjectType>
@@ -911,7 +1328,13 @@ struct CompressAnimationsFunctor
 				continue;
 			}
 
-			FString Filename = UE4Clip->GetPathName();
+			const FString ClipName = UE4Clip->GetPathName();
+			if (!IsClipInShard(ClipName, StatsCommandlet->ShardIndex, StatsCommandlet->NumShards))
+			{
+				continue;
+			}
+
+			FString Filename = ClipName;
 			if (StatsCommandlet->PerformCompression)
 			{
 				Filename = FString::Printf(TEXT("%X_stats.sjson"), GetTypeHash(Filename));
@@ -923,7 +1346,7 @@ struct CompressAnimationsFunctor
 
 			FString UE4OutputPath = FPaths::Combine(*StatsCommandlet->OutputDir, *Filename).Replace(TEXT("/"), TEXT("\\"));
 
-			if (StatsCommandlet->ResumeTask && FileManager.FileExists(*UE4OutputPath))
+			if (StatsCommandlet->PerformCompression ? StatsCommandlet->CompletedClips.Contains(ClipName) : (StatsCommandlet->ResumeTask && FileManager.FileExists(*UE4OutputPath)))
 			{
 				continue;
 			}
@@ -937,6 +1360,7 @@ struct CompressAnimationsFunctor
 			FCompressionContext Context;
 			Context.AutoCompressor = StatsCommandlet->AutoCompressionSettings;
 			Context.ACLCompressor = StatsCommandlet->ACLCompressionSettings;
+			Context.KeyReductionCompressor = StatsCommandlet->KeyReductionCompressionSettings;
 			Context.UE4Clip = UE4Clip;
 			Context.UE4Skeleton = UE4Skeleton;
 
@@ -957,6 +1381,9 @@ struct CompressAnimationsFunctor
 			Context.ACLSkeleton = MoveTemp(ACLSkeleton);
 			Context.ACLRawSize = Context.ACLClip->get_raw_size();
 			Context.UE4RawSize = UE4Clip->GetApproxRawSize();
+			Context.Stats.ClipName = ClipName;
+			Context.Stats.ACLRawSize = Context.ACLRawSize;
+			Context.Stats.NumProcesses = StatsCommandlet->NumShards;
 
 			if (StatsCommandlet->PerformCompression)
 			{
@@ -998,6 +1425,8 @@ struct CompressAnimationsFunctor
 				}
 
 				OutputWriter->Close();
+
+				StatsCommandlet->ShardWriter->Write(Context.Stats);
 			}
 			else if (StatsCommandlet->PerformClipExtraction)
 			{
@@ -1027,6 +1456,14 @@ UACLStatsDumpCommandlet::UACLStatsDumpCommandlet(const FObjectInitializer& Objec
 	IsEditor = true;
 	LogToConsole = true;
 	ShowErrorCount = true;
+
+#if WITH_EDITOR
+	NumLoadingJobs = 1;
+	NumChildProcesses = 1;
+	ShardIndex = 0;
+	NumShards = 1;
+	ShardWriter = nullptr;
+#endif
 }
 
 int32 UACLStatsDumpCommandlet::Main(const FString& Params)
@@ -1056,6 +1493,14 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 	SkipAdditiveClips = Switches.Contains(TEXT("noadditive")) || true;	// Disabled for now, TODO add support for it
 	const bool HasInput = ParamsMap.Contains(TEXT("input"));
 
+	NumLoadingJobs = ParamsMap.Contains(TEXT("jobs")) ? FMath::Max(FCString::Atoi(*ParamsMap[TEXT("jobs")]), 1) : 1;
+	NumChildProcesses = ParamsMap.Contains(TEXT("processes")) ? FMath::Max(FCString::Atoi(*ParamsMap[TEXT("processes")]), 1) : 1;
+
+	// Child processes are given their shard by the parent
+	const bool bIsChildProcess = ParamsMap.Contains(TEXT("shard"));
+	ShardIndex = bIsChildProcess ? FCString::Atoi(*ParamsMap[TEXT("shard")]) : 0;
+	NumShards = bIsChildProcess && ParamsMap.Contains(TEXT("numshards")) ? FMath::Max(FCString::Atoi(*ParamsMap[TEXT("numshards")]), 1) : 1;
+
 	if (PerformClipExtraction)
 	{
 		// We don't support extracting additive clips
@@ -1087,6 +1532,7 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 	{
 		AutoCompressionSettings = FAnimationUtils::GetDefaultAnimationBoneCompressionSettings();
 		AutoCompressionSettings->bForceBelowThreshold = true;
+		AutoCompressionSettings->AddToRoot();
 
 		if (ParamsMap.Contains(TEXT("MasterTolerance")))
 		{
@@ -1118,13 +1564,68 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 	FFileManagerGeneric FileManager;
 	FileManager.MakeDirectory(*OutputDir, true);
 
+	if (PerformCompression && !bIsChildProcess)
+	{
+		if (ResumeTask)
+		{
+			// Drop what an interrupted run might have left half written before anything appends to the shards again
+			TArray<FClipStats> CompletedClipStats;
+			ReadStatsShards(OutputDir, true, CompletedClipStats);
+		}
+		else
+		{
+			TArray<FString> ShardFiles;
+			FileManager.FindFiles(ShardFiles, *OutputDir, StatsShardExtension);
+			for (const FString& ShardFilename : ShardFiles)
+			{
+				FileManager.Delete(*FPaths::Combine(*OutputDir, *ShardFilename));
+			}
+		}
+	}
+
+	if (NumChildProcesses > 1 && !bIsChildProcess)
+	{
+		const bool bSucceeded = RunChildProcesses(NumChildProcesses, OutputDir);
+		if (!bSucceeded)
+		{
+			UE_LOG(LogAnimationCompression, Warning, TEXT("Some child processes failed, run again with -resume to finish the remaining clips"));
+		}
+
+		if (PerformCompression)
+		{
+			WriteStatsSummary(OutputDir);
+		}
+
+		return bSucceeded ? 0 : 1;
+	}
+
+	TUniquePtr<FStatsShardWriter> ShardWriterImpl;
+	if (PerformCompression)
+	{
+		// Shards from the previous runs are only appended to, the parent cleared them when not resuming
+		TArray<FClipStats> CompletedClipStats;
+		ReadStatsShards(OutputDir, false, CompletedClipStats);
+		for (const FClipStats& ClipStats : CompletedClipStats)
+		{
+			CompletedClips.Add(ClipStats.ClipName);
+		}
+
+		ShardWriterImpl = MakeUnique<FStatsShardWriter>(GetStatsShardPath(OutputDir, ShardIndex));
+		if (!ShardWriterImpl->IsValid())
+		{
+			UE_LOG(LogAnimationCompression, Error, TEXT("Failed to open the stats shard: %s"), *GetStatsShardPath(OutputDir, ShardIndex));
+			return 1;
+		}
+
+		ShardWriter = ShardWriterImpl.Get();
+	}
+
 	if (!HasInput)
 	{
 		// No source directory, use the current project instead
 		ACLRawDir = TEXT("");
 
 		DoActionToAllPackages<UAnimSequence, CompressAnimationsFunctor>(this, Params.ToUpper());
-		return 0;
 	}
 	else
 	{
@@ -1139,22 +1640,63 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 		UPackage* TempPackage = CreatePackage(nullptr, TEXT("/Temp/ACL"));
 #endif
 
+		// Clips are created in the temporary package and collected regularly
+		TempPackage->AddToRoot();
+
 		ACLAllocator Allocator;
 
 		TArray<FString> Files;
 		FileManager.FindFiles(Files, *ACLRawDir, TEXT(".acl.sjson"));
 
+		TArray<FString> PendingFiles;
 		for (const FString& Filename : Files)
+		{
+			if (IsClipInShard(Filename, ShardIndex, NumShards) && !CompletedClips.Contains(Filename))
+			{
+				PendingFiles.Add(Filename);
+			}
+		}
+
+		struct FLoadedACLClip
+		{
+			std::unique_ptr<acl::AnimationClip, acl::Deleter<acl::AnimationClip>> Clip;
+			std::unique_ptr<acl::RigidSkeleton, acl::Deleter<acl::RigidSkeleton>> Skeleton;
+			const TCHAR* ErrorMsg = nullptr;
+		};
+
+		// Reading and parsing the raw clips doesn't touch any UObject, up to NumLoadingJobs clips are loaded ahead on worker threads
+		// while this thread compresses. Only the clips in that window are in memory at once.
+		auto LoadClipAsync = [this, &Allocator](const FString& Filename)
 		{
 			const FString ACLClipPath = FPaths::Combine(*ACLRawDir, *Filename);
-			const FString UE4StatPath = FPaths::Combine(*OutputDir, *Filename.Replace(TEXT(".acl.sjson"), TEXT("_stats.sjson"), ESearchCase::CaseSensitive));
+			return Async(EAsyncExecution::ThreadPool, [&Allocator, ACLClipPath]()
+			{
+				TUniquePtr<FLoadedACLClip> LoadedClip = MakeUnique<FLoadedACLClip>();
+				FFileManagerGeneric LoaderFileManager;
+				LoadedClip->ErrorMsg = ReadACLClip(LoaderFileManager, ACLClipPath, Allocator, LoadedClip->Clip, LoadedClip->Skeleton);
+				return LoadedClip;
+			});
+		};
 
-			if (ResumeTask && FileManager.FileExists(*UE4StatPath))
+		TArray<TFuture<TUniquePtr<FLoadedACLClip>>> PendingLoads;
+		int32 NextLoadIndex = 0;
+
+		for (int32 FileIndex = 0; FileIndex < PendingFiles.Num(); ++FileIndex)
+		{
+			while (NextLoadIndex < PendingFiles.Num() && NextLoadIndex < FileIndex + NumLoadingJobs)
 			{
-				continue;
+				PendingLoads.Add(LoadClipAsync(PendingFiles[NextLoadIndex++]));
 			}
 
-			UE_LOG(LogAnimationCompression, Verbose, TEXT("Compressing: %s"), *Filename);
+			TFuture<TUniquePtr<FLoadedACLClip>> LoadedClipFuture = MoveTemp(PendingLoads[0]);
+			PendingLoads.RemoveAt(0);
+
+			const TUniquePtr<FLoadedACLClip>& LoadedClip = LoadedClipFuture.Get();
+
+			const FString& Filename = PendingFiles[FileIndex];
+			const FString UE4StatPath = FPaths::Combine(*OutputDir, *Filename.Replace(TEXT(".acl.sjson"), TEXT("_stats.sjson"), ESearchCase::CaseSensitive));
+
+			UE_LOG(LogAnimationCompression, Verbose, TEXT("Compressing: %s (%d / %d)"), *Filename, FileIndex, PendingFiles.Num());
 
 			FArchive* StatWriter = FileManager.CreateFileWriter(*UE4StatPath);
 			if (StatWriter == nullptr)
@@ -1167,10 +1709,14 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 			UE4SJSONStreamWriter StreamWriter(StatWriter);
 			sjson::Writer Writer(StreamWriter);
 
-			std::unique_ptr<acl::AnimationClip, acl::Deleter<acl::AnimationClip>> ACLClipRaw;
-			std::unique_ptr<acl::RigidSkeleton, acl::Deleter<acl::RigidSkeleton>> ACLSkeletonRaw;
+			const std::unique_ptr<acl::AnimationClip, acl::Deleter<acl::AnimationClip>>& ACLClipRaw = LoadedClip->Clip;
+			const std::unique_ptr<acl::RigidSkeleton, acl::Deleter<acl::RigidSkeleton>>& ACLSkeletonRaw = LoadedClip->Skeleton;
 
-			const TCHAR* ErrorMsg = ReadACLClip(FileManager, ACLClipPath, Allocator, ACLClipRaw, ACLSkeletonRaw);
+			FCompressionContext Context;
+			Context.Stats.ClipName = Filename;
+			Context.Stats.NumProcesses = NumShards;
+
+			const TCHAR* ErrorMsg = LoadedClip->ErrorMsg;
 			if (ErrorMsg == nullptr)
 			{
 				USkeleton* UE4Skeleton = NewObject<USkeleton>(TempPackage, USkeleton::StaticClass());
@@ -1201,7 +1747,6 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 				// Make sure any pending async compression that might have started during load or construction is done
 				UE4Clip->WaitOnExistingCompression();
 
-				FCompressionContext Context;
 				Context.AutoCompressor = AutoCompressionSettings;
 				Context.ACLCompressor = ACLCompressionSettings;
 				Context.KeyReductionCompressor = KeyReductionCompressionSettings;
@@ -1212,6 +1757,7 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 
 				Context.ACLRawSize = Context.ACLClip->get_raw_size();
 				Context.UE4RawSize = UE4Clip->GetApproxRawSize();
+				Context.Stats.ACLRawSize = Context.ACLRawSize;
 
 				Writer["duration"] = UE4Clip->SequenceLength;
 				Writer["num_samples"] = CompressibleData.NumFrames;
@@ -1253,8 +1799,23 @@ int32 UACLStatsDumpCommandlet::Main(const FString& Params)
 			}
 
 			StatWriter->Close();
+
+			// Clips that failed to load are recorded as well, with no codec stats, resuming would only fail again
+			ShardWriter->Write(Context.Stats);
+
+			if ((FileIndex + 1) % GarbageCollectionInterval == 0)
+			{
+				CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			}
 		}
 	}
+
+	ShardWriter = nullptr;
+
+	if (PerformCompression && !bIsChildProcess)
+	{
+		WriteStatsSummary(OutputDir);
+	}
 #endif	// WITH_EDITOR
 
 	return 0;
@@ -129,3 +129,8 @@ void UAnimBoneCompressionCodec_ACL::DecompressBone(FAnimSequenceDecompressionCon
 {
 	::DecompressBone<UE4DefaultDecompressionSettings>(DecompContext, TrackIndex, OutAtom);
 }
+
+void UAnimBoneCompressionCodec_ACL::DecompressBones(FAnimSequenceDecompressionContext& DecompContext, TArrayView<const int32> TrackIndices, TArrayView<FTransform> OutAtoms) const
+{
+	::DecompressBones<UE4DefaultDecompressionSettings>(DecompContext, TrackIndices, OutAtoms);
+}
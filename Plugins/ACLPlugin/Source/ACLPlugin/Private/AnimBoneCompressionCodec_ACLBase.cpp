@@ -1,6 +1,9 @@
 // Copyright 2018 Nicholas Frechette. All Rights Reserved.
 
 #include "AnimBoneCompressionCodec_ACLBase.h"
+#include "ACLSegmentStreamer.h"
+#include "Animation/AnimSequence.h"
+#include "UObject/UObjectSerializeContext.h"
 #include "Serialization/MemoryWriter.h"
 #include "Serialization/MemoryReader.h"
 
@@ -18,6 +21,64 @@
 
 #include <acl/core/compressed_clip.h>
 
+FACLCompressedAnimData::FACLCompressedAnimData()
+{
+}
+
+FACLCompressedAnimData::~FACLCompressedAnimData()
+{
+	// Pages still in flight reference the bulk data, the streamer goes first
+	SegmentStreamer.Reset();
+}
+
+void FACLCompressedAnimData::SerializeCompressedData(FArchive& Ar)
+{
+	// The sequence serializes its compressed data from its own Serialize, it is the object being serialized
+	const FUObjectSerializeContext* SerializeContext = Ar.GetSerializeContext();
+	UObject* DataOwner = SerializeContext != nullptr ? Cast<UAnimSequence>(SerializeContext->SerializedObject) : nullptr;
+
+	SerializeCompressedData(Ar, DataOwner);
+}
+
+void FACLCompressedAnimData::SerializeCompressedData(FArchive& Ar, UObject* DataOwner)
+{
+	ICompressedAnimData::SerializeCompressedData(Ar);
+
+	bool bHasStreamedSegments = SegmentBulkData.GetBulkDataSize() != 0;
+	Ar << bHasStreamedSegments;
+
+	if (bHasStreamedSegments)
+	{
+		// Stored outside of the package so segments can be paged in on demand. That needs the owner to find the payload
+		// again, anything else, e.g. the DDC, keeps the segments inline and loads them whole.
+		if (Ar.IsPersistent() && DataOwner != nullptr)
+		{
+			SegmentBulkData.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
+		}
+		else
+		{
+			checkf(!Ar.IsPersistent() || !Ar.IsCooking(), TEXT("Cooking streamed ACL segments without the owning sequence"));
+			SegmentBulkData.ClearBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
+		}
+		SegmentBulkData.Serialize(Ar, DataOwner);
+	}
+	else if (Ar.IsLoading())
+	{
+		SegmentBulkData.RemoveBulkData();
+	}
+}
+
+void FACLCompressedAnimData::Bind(const TArrayView<uint8> BulkData)
+{
+	CompressedByteStream = BulkData;
+
+	SegmentStreamer.Reset();
+	if (BulkData.Num() != 0 && SegmentBulkData.GetBulkDataSize() != 0)
+	{
+		SegmentStreamer = MakeUnique<FACLSegmentStreamer>(CompressedByteStream, SegmentBulkData);
+	}
+}
+
 bool FACLCompressedAnimData::IsValid() const
 {
 	if (CompressedByteStream.Num() == 0)
@@ -42,6 +103,8 @@ UAnimBoneCompressionCodec_ACLBase::UAnimBoneCompressionCodec_ACLBase(const FObje
 	SafeVirtualVertexDistance = 100.0f;		// 100cm
 
 	ErrorThreshold = 0.01f;					// 0.01cm, conservative enough for cinematographic quality
+
+	bStreamSegments = false;
 #endif	// WITH_EDITORONLY_DATA
 }
 
@@ -68,6 +131,9 @@ bool UAnimBoneCompressionCodec_ACLBase::Compress(const FCompressibleAnimData& Co
 	CompressionSettings Settings;
 	GetCompressionSettings(Settings);
 
+	// Segments are optimized concurrently, the compressed data doesn't depend on the scheduler
+	Settings.task_scheduler = GetCompressionTaskScheduler();
+
 	TransformErrorMetric DefaultErrorMetric;
 	AdditiveTransformErrorMetric<AdditiveClipFormat8::Additive1> AdditiveErrorMetric;
 	if (ACLBaseClip != nullptr)
@@ -107,14 +173,28 @@ bool UAnimBoneCompressionCodec_ACLBase::Compress(const FCompressibleAnimData& Co
 
 	const uint32 CompressedClipDataSize = CompressedClipData->get_size();
 
-	OutResult.CompressedByteStream.Empty(CompressedClipDataSize);
-	OutResult.CompressedByteStream.AddUninitialized(CompressedClipDataSize);
-	FMemory::Memcpy(OutResult.CompressedByteStream.GetData(), CompressedClipData, CompressedClipDataSize);
+	// Streamed clips keep everything up to the end of their first segment resident, the other segments go to bulk data
+	const uint32 ResidentSize = bStreamSegments ? FACLSegmentStreamer::GetResidentSize(*CompressedClipData) : CompressedClipDataSize;
+	const uint32 StreamedSize = CompressedClipDataSize - ResidentSize;
+	const uint32 ResidentByteStreamSize = StreamedSize != 0 ? (ResidentSize + FACLSegmentStreamer::PaddingSize) : CompressedClipDataSize;
+
+	OutResult.CompressedByteStream.Empty(ResidentByteStreamSize);
+	OutResult.CompressedByteStream.AddZeroed(ResidentByteStreamSize);
+	FMemory::Memcpy(OutResult.CompressedByteStream.GetData(), CompressedClipData, ResidentSize);
 
 	OutResult.Codec = this;
 
 	OutResult.AnimData = AllocateAnimData();
 	OutResult.AnimData->CompressedNumberOfFrames = CompressibleAnimData.NumFrames;
+
+	if (StreamedSize != 0)
+	{
+		FACLCompressedAnimData& ACLAnimData = static_cast<FACLCompressedAnimData&>(*OutResult.AnimData);
+		ACLAnimData.SegmentBulkData.Lock(LOCK_READ_WRITE);
+		FMemory::Memcpy(ACLAnimData.SegmentBulkData.Realloc(StreamedSize), reinterpret_cast<const uint8*>(CompressedClipData) + ResidentSize, StreamedSize);
+		ACLAnimData.SegmentBulkData.Unlock();
+	}
+
 	OutResult.AnimData->Bind(OutResult.CompressedByteStream);
 
 #if !NO_LOGGING
@@ -124,6 +204,10 @@ bool UAnimBoneCompressionCodec_ACLBase::Compress(const FCompressibleAnimData& Co
 		const BoneError bone_error = calculate_compressed_clip_error(AllocatorImpl, *ACLClip, *Settings.error_metric, Context);
 
 		UE_LOG(LogAnimationCompression, Verbose, TEXT("ACL Animation compressed size: %u bytes"), CompressedClipDataSize);
+		if (StreamedSize != 0)
+		{
+			UE_LOG(LogAnimationCompression, Verbose, TEXT("ACL Animation streamed size: %u bytes in %u segments"), StreamedSize, get_clip_header(*CompressedClipData).num_segments - 1);
+		}
 		UE_LOG(LogAnimationCompression, Verbose, TEXT("ACL Animation error: %.4f cm (bone %u @ %.3f)"), bone_error.error, bone_error.index, bone_error.sample_time);
 	}
 #endif
@@ -136,10 +220,12 @@ void UAnimBoneCompressionCodec_ACLBase::PopulateDDCKey(FArchive& Ar)
 {
 	Super::PopulateDDCKey(Ar);
 
-	uint32 ForceRebuildVersion = 0;
+	// Version 1: the compressed data serializes its streamed segments
+	uint32 ForceRebuildVersion = 1;
 
 	Ar << ForceRebuildVersion << DefaultVirtualVertexDistance << SafeVirtualVertexDistance << ErrorThreshold;
 	Ar << CompressionLevel;
+	Ar << bStreamSegments;
 
 	// Add the end effector match name list since if it changes, we need to re-compress
 	const TArray<FString>& KeyEndEffectorsMatchNameArray = UAnimationSettings::Get()->KeyEndEffectorsMatchNameArray;
@@ -85,3 +85,8 @@ void UAnimBoneCompressionCodec_ACLCustom::DecompressBone(FAnimSequenceDecompress
 {
 	::DecompressBone<UE4CustomDecompressionSettings>(DecompContext, TrackIndex, OutAtom);
 }
+
+void UAnimBoneCompressionCodec_ACLCustom::DecompressBones(FAnimSequenceDecompressionContext& DecompContext, TArrayView<const int32> TrackIndices, TArrayView<FTransform> OutAtoms) const
+{
+	::DecompressBones<UE4CustomDecompressionSettings>(DecompContext, TrackIndices, OutAtoms);
+}
@@ -58,3 +58,8 @@ void UAnimBoneCompressionCodec_ACLSafe::DecompressBone(FAnimSequenceDecompressio
 {
 	::DecompressBone<UE4SafeDecompressionSettings>(DecompContext, TrackIndex, OutAtom);
 }
+
+void UAnimBoneCompressionCodec_ACLSafe::DecompressBones(FAnimSequenceDecompressionContext& DecompContext, TArrayView<const int32> TrackIndices, TArrayView<FTransform> OutAtoms) const
+{
+	::DecompressBones<UE4SafeDecompressionSettings>(DecompContext, TrackIndices, OutAtoms);
+}
@@ -14,6 +14,9 @@
 #include "ACLImpl.h"
 #endif	// WITH_EDITOR
 
+#include "ACLDecompressionContextCache.h"
+#include "Misc/MemStack.h"
+
 #include <acl/decompression/decompress.h>
 
 UAnimCurveCompressionCodec_ACL::UAnimCurveCompressionCodec_ACL(const FObjectInitializer& ObjectInitializer)
@@ -202,26 +205,69 @@ struct UE4CurveDecompressionSettings final : public acl::decompression_settings
 	constexpr bool is_track_type_supported(acl::track_type8 type) const { return type == acl::track_type8::float1f; }
 };
 
-struct UE4CurveWriter final : public acl::track_writer
+/*
+ * Curve decompression context owned by an FACLInstanceDecompressionCache, along with the remap of the last curve request.
+ * OutputIndices holds, for every compressed track, its slot in the batch of curves in use or k_invalid_track_index when
+ * the owner doesn't use it. ElementIndices holds the FBlendedCurve element each slot is written to.
+ */
+struct FACLCachedCurveDecompressionContext final : public FACLCachedDecompressionContext
 {
-	const TArray<FSmartName>& CompressedCurveNames;
-	FBlendedCurve& Curves;
+	acl::decompression_context<UE4CurveDecompressionSettings> Context;
 
-	UE4CurveWriter(const TArray<FSmartName>& CompressedCurveNames_, FBlendedCurve& Curves_)
-		: CompressedCurveNames(CompressedCurveNames_)
-		, Curves(Curves_)
+	TArray<uint32> OutputIndices;
+	TArray<int32> ElementIndices;
+	uint32 RemapCurvesKey = 0;
+	uint32 RemapBonesKey = 0;
+
+	static const void* GetSettingsTypeId()
 	{
+		static const uint8 TypeId = 0;
+		return &TypeId;
 	}
 
-	void write_float1(uint32_t TrackIndex, rtm::scalarf_arg0 Value)
+	void* operator new(size_t Size) { return FMemory::Malloc(Size, alignof(FACLCachedCurveDecompressionContext)); }
+	void operator delete(void* Ptr) { FMemory::Free(Ptr); }
+};
+
+/*
+ * Identifies which curves a blended curve uses and where they go. The lookup table is usually refilled in place when the
+ * curve filter or LOD changes, its contents are hashed rather than its address.
+ */
+uint32 UAnimCurveCompressionCodec_ACL::GetCurveRemapKey(const FBlendedCurve& Curves)
+{
+	const uint32 NumElements = Curves.Elements.Num();
+	if (Curves.UIDToArrayIndexLUT == nullptr)
 	{
-		const FSmartName& CurveName = CompressedCurveNames[TrackIndex];
-		if (Curves.IsEnabled(CurveName.UID))
+		return NumElements;
+	}
+
+	const TArray<uint16>& LUT = *Curves.UIDToArrayIndexLUT;
+	return FCrc::MemCrc32(LUT.GetData(), LUT.Num() * LUT.GetTypeSize(), NumElements);
+}
+
+/** Maps every compressed curve to the element it writes in the blended curve, returns how many curves are in use. */
+static int32 BuildCurveRemap(const TArray<FSmartName>& CompressedCurveNames, const FBlendedCurve& Curves, uint32* OutputIndices, int32* ElementIndices)
+{
+	const int32 NumCurves = CompressedCurveNames.Num();
+
+	int32 NumUsedCurves = 0;
+	for (int32 CurveIndex = 0; CurveIndex < NumCurves; ++CurveIndex)
+	{
+		const int32 ElementIndex = Curves.GetArrayIndexByUID(CompressedCurveNames[CurveIndex].UID);
+		if (ElementIndex != INDEX_NONE)
+		{
+			OutputIndices[CurveIndex] = NumUsedCurves;
+			ElementIndices[NumUsedCurves] = ElementIndex;
+			NumUsedCurves++;
+		}
+		else
 		{
-			Curves.Set(CurveName.UID, rtm::scalar_cast(Value));
+			OutputIndices[CurveIndex] = acl::k_invalid_track_index;
 		}
 	}
-};
+
+	return NumUsedCurves;
+}
 
 void UAnimCurveCompressionCodec_ACL::DecompressCurves(const FCompressedAnimSequence& AnimSeq, FBlendedCurve& Curves, float CurrentTime) const
 {
@@ -236,12 +282,84 @@ void UAnimCurveCompressionCodec_ACL::DecompressCurves(const FCompressedAnimSeque
 	const acl::compressed_tracks* CompressedTracks = reinterpret_cast<const acl::compressed_tracks*>(AnimSeq.CompressedCurveByteStream.GetData());
 	check(CompressedTracks->is_valid(false).empty());
 
-	acl::decompression_context<UE4CurveDecompressionSettings> Context;
-	Context.initialize(*CompressedTracks);
+	FMemMark Mark(FMemStack::Get());
+
+	// The remap only depends on which curves the owner uses, it is cached with the context and rebuilt when the
+	// contents of the curve lookup table or the owner's required bones change.
+	FACLInstanceDecompressionCache* InstanceCache = FACLInstanceDecompressionCache::GetCurrent();
+	FACLCachedCurveDecompressionContext* CachedContext = nullptr;
+	if (InstanceCache != nullptr)
+	{
+		FACLCachedDecompressionContext* Entry = InstanceCache->Find(CompressedTracks, FACLCachedCurveDecompressionContext::GetSettingsTypeId());
+		if (Entry == nullptr)
+		{
+			Entry = InstanceCache->Add(TUniquePtr<FACLCachedDecompressionContext>(new FACLCachedCurveDecompressionContext()), CompressedTracks, FACLCachedCurveDecompressionContext::GetSettingsTypeId());
+		}
+
+		CachedContext = static_cast<FACLCachedCurveDecompressionContext*>(Entry);
+		if (CachedContext->Context.is_dirty(*CompressedTracks))
+		{
+			CachedContext->Context.initialize(*CompressedTracks);
+			CachedContext->OutputIndices.Reset();
+		}
+	}
+
+	acl::decompression_context<UE4CurveDecompressionSettings> TransientContext;
+	acl::decompression_context<UE4CurveDecompressionSettings>& Context = CachedContext != nullptr ? CachedContext->Context : TransientContext;
+	if (CachedContext == nullptr)
+	{
+		TransientContext.initialize(*CompressedTracks);
+	}
+
+	const uint32* OutputIndices;
+	const int32* ElementIndices;
+	int32 NumUsedCurves;
+	if (CachedContext != nullptr)
+	{
+		const uint32 CurvesKey = GetCurveRemapKey(Curves);
+		const bool bUpToDate = CachedContext->OutputIndices.Num() == NumCurves
+			&& CachedContext->RemapCurvesKey == CurvesKey
+			&& CachedContext->RemapBonesKey == InstanceCache->GetRequiredBonesKey();
+		if (!bUpToDate)
+		{
+			CachedContext->OutputIndices.SetNumUninitialized(NumCurves);
+			CachedContext->ElementIndices.SetNumUninitialized(NumCurves);
+			const int32 NumRemapped = BuildCurveRemap(CompressedCurveNames, Curves, CachedContext->OutputIndices.GetData(), CachedContext->ElementIndices.GetData());
+			CachedContext->ElementIndices.SetNum(NumRemapped, false);
+			CachedContext->RemapCurvesKey = CurvesKey;
+			CachedContext->RemapBonesKey = InstanceCache->GetRequiredBonesKey();
+		}
+
+		OutputIndices = CachedContext->OutputIndices.GetData();
+		ElementIndices = CachedContext->ElementIndices.GetData();
+		NumUsedCurves = CachedContext->ElementIndices.Num();
+	}
+	else
+	{
+		uint32* TransientOutputIndices = new(FMemStack::Get()) uint32[NumCurves];
+		int32* TransientElementIndices = new(FMemStack::Get()) int32[NumCurves];
+		NumUsedCurves = BuildCurveRemap(CompressedCurveNames, Curves, TransientOutputIndices, TransientElementIndices);
+		OutputIndices = TransientOutputIndices;
+		ElementIndices = TransientElementIndices;
+	}
+
+	if (NumUsedCurves == 0)
+	{
+		return;
+	}
+
 	Context.seek(CurrentTime, acl::SampleRoundingPolicy::None);
 
-	UE4CurveWriter TrackWriter(CompressedCurveNames, Curves);
-	Context.decompress_tracks(TrackWriter);
+	// Every curve is sampled in one SIMD pass into a packed array of the curves in use, unused curves are skipped without reading their data
+	float* Values = new(FMemStack::Get()) float[NumUsedCurves];
+	Context.decompress_float1_tracks(OutputIndices, Values);
+
+	for (int32 UsedCurveIndex = 0; UsedCurveIndex < NumUsedCurves; ++UsedCurveIndex)
+	{
+		FCurveElement& Element = Curves.Elements[ElementIndices[UsedCurveIndex]];
+		Element.Value = Values[UsedCurveIndex];
+		Element.bValid = true;
+	}
 }
 
 struct UE4ScalarCurveWriter final : public acl::track_writer
@@ -0,0 +1,99 @@
+// Copyright 2020 Nicholas Frechette. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "ACLDecompressionContextCache.h"
+#include "AnimCurveCompressionCodec_ACL.h"
+#include "Animation/AnimCompressionTypes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITORONLY_DATA
+#include "ACLImpl.h"
+
+#include <acl/compression/compress.h>
+#include <acl/compression/track_array.h>
+
+namespace ACLCurveRemapTest
+{
+	static const int32 NumCurves = 3;
+
+	/** Compresses one constant curve per UID, curve N holds N + 1. */
+	static bool BuildCompressedCurves(FCompressedAnimSequence& OutAnimSeq)
+	{
+		ACLAllocator AllocatorImpl;
+		acl::track_array_float1f Tracks(AllocatorImpl, NumCurves);
+
+		for (int32 CurveIndex = 0; CurveIndex < NumCurves; ++CurveIndex)
+		{
+			acl::track_desc_scalarf Desc;
+			Desc.output_index = CurveIndex;
+			Desc.precision = 0.001f;
+			Desc.constant_threshold = 0.001f;
+
+			acl::track_float1f Track = acl::track_float1f::make_reserve(Desc, AllocatorImpl, 2, 30.0f);
+			Track[0] = float(CurveIndex + 1);
+			Track[1] = float(CurveIndex + 1);
+			Tracks[CurveIndex] = MoveTemp(Track);
+
+			OutAnimSeq.CompressedCurveNames.Add(FSmartName(*FString::Printf(TEXT("Curve%d"), CurveIndex), SmartName::UID_Type(CurveIndex)));
+		}
+
+		acl::compression_settings Settings;
+		acl::compressed_tracks* CompressedTracks = nullptr;
+		acl::OutputStats Stats;
+		if (acl::compress_track_list(AllocatorImpl, Tracks, Settings, CompressedTracks, Stats).any())
+		{
+			return false;
+		}
+
+		const uint32 CompressedDataSize = CompressedTracks->get_size();
+		OutAnimSeq.CompressedCurveByteStream.AddUninitialized(CompressedDataSize);
+		FMemory::Memcpy(OutAnimSeq.CompressedCurveByteStream.GetData(), CompressedTracks, CompressedDataSize);
+		AllocatorImpl.deallocate(CompressedTracks, CompressedDataSize);
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FACLCurveRemapFilterChangeTest, "ACL.Curves.RemapFollowsCurveFilter",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FACLCurveRemapFilterChangeTest::RunTest(const FString& Parameters)
+{
+	using namespace ACLCurveRemapTest;
+
+	FCompressedAnimSequence AnimSeq;
+	if (!BuildCompressedCurves(AnimSeq))
+	{
+		AddError(TEXT("ACL failed to compress the test curves"));
+		return false;
+	}
+
+	const UAnimCurveCompressionCodec_ACL* Codec = GetDefault<UAnimCurveCompressionCodec_ACL>();
+
+	// The same lookup table is refilled in place and the required bones are unchanged, as when only the curve filter changes
+	TArray<uint16> UIDToArrayIndexLUT = { 0, 1, MAX_uint16 };
+
+	FACLInstanceDecompressionCache Cache;
+	Cache.SetRequiredBonesKey(1);
+	FACLDecompressionCacheScope CacheScope(Cache);
+
+	FBlendedCurve Curves;
+	Curves.InitFrom(&UIDToArrayIndexLUT);
+	const uint32 FirstKey = UAnimCurveCompressionCodec_ACL::GetCurveRemapKey(Curves);
+	Codec->DecompressCurves(AnimSeq, Curves, 0.0f);
+	TestEqual(TEXT("First filter, element 0"), Curves.Elements[0].Value, 1.0f);
+	TestEqual(TEXT("First filter, element 1"), Curves.Elements[1].Value, 2.0f);
+
+	UIDToArrayIndexLUT[0] = MAX_uint16;
+	UIDToArrayIndexLUT[1] = 0;
+	UIDToArrayIndexLUT[2] = 1;
+
+	Curves.InitFrom(&UIDToArrayIndexLUT);
+	TestNotEqual(TEXT("Remap key after the filter change"), UAnimCurveCompressionCodec_ACL::GetCurveRemapKey(Curves), FirstKey);
+	Codec->DecompressCurves(AnimSeq, Curves, 0.0f);
+	TestEqual(TEXT("Second filter, element 0"), Curves.Elements[0].Value, 2.0f);
+	TestEqual(TEXT("Second filter, element 1"), Curves.Elements[1].Value, 3.0f);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS && WITH_EDITORONLY_DATA
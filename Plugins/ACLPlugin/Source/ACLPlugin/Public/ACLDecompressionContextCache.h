@@ -0,0 +1,76 @@
+#pragma once
+
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+/** A decompression context owned by an FACLInstanceDecompressionCache, the concrete type depends on the codec's decompression settings. */
+struct FACLCachedDecompressionContext
+{
+	virtual ~FACLCachedDecompressionContext() {}
+
+	const void* Clip = nullptr;
+	const void* SettingsTypeId = nullptr;
+	uint32 LastUse = 0;
+};
+
+/*
+ * Decompression contexts persisted between evaluations of one animation instance, keyed by compressed clip.
+ * A context found here is only re-initialized when is_dirty() reports its clip changed, and seeking it again within
+ * the same segment keeps the segment data it already resolved, which is the common case for a clip playing forward.
+ * Each context also keeps the track to atom map of its last pose request until the required bones key changes.
+ *
+ * The cache is not thread safe: it must only be used by the thread currently evaluating its owner, see FACLDecompressionCacheScope.
+ * Copies start empty since contexts must never be shared between owners.
+ */
+class ACLPLUGIN_API FACLInstanceDecompressionCache
+{
+public:
+	static constexpr int32 MaxContexts = 8;
+
+	FACLInstanceDecompressionCache() {}
+	FACLInstanceDecompressionCache(const FACLInstanceDecompressionCache&) {}
+	FACLInstanceDecompressionCache& operator=(const FACLInstanceDecompressionCache&) { Reset(); RequiredBonesKey = 0; return *this; }
+
+	/** Releases every cached context. */
+	void Reset();
+
+	/** Returns the context cached for a clip with the given decompression settings, or nullptr. */
+	FACLCachedDecompressionContext* Find(const void* Clip, const void* SettingsTypeId);
+
+	/** Takes ownership of a new context for a clip, evicting the least recently used one when full. */
+	FACLCachedDecompressionContext* Add(TUniquePtr<FACLCachedDecompressionContext> Context, const void* Clip, const void* SettingsTypeId);
+
+	/*
+	 * Identifies the owner's required bone set. Pose track maps built under another key are rebuilt on their next use,
+	 * owners update it before evaluating whenever their LOD or skeletal mesh may have changed.
+	 */
+	void SetRequiredBonesKey(uint32 Key) { RequiredBonesKey = Key; }
+	uint32 GetRequiredBonesKey() const { return RequiredBonesKey; }
+
+	/** The cache of the animation instance being evaluated on this thread, if any. */
+	static FACLInstanceDecompressionCache* GetCurrent();
+
+private:
+	TArray<TUniquePtr<FACLCachedDecompressionContext>, TInlineAllocator<MaxContexts>> Contexts;
+	uint32 UseCounter = 0;
+	uint32 RequiredBonesKey = 0;
+};
+
+/*
+ * Makes a cache current on this thread for the lifetime of the scope.
+ * The engine decompression context carries no information about who is evaluating, owners wrap their pose
+ * evaluation with this so the ACL codecs can find their cache. Scopes can be nested, e.g. by linked anim instances.
+ */
+struct ACLPLUGIN_API FACLDecompressionCacheScope
+{
+	explicit FACLDecompressionCacheScope(FACLInstanceDecompressionCache& Cache);
+	~FACLDecompressionCacheScope();
+
+	FACLDecompressionCacheScope(const FACLDecompressionCacheScope&) = delete;
+	FACLDecompressionCacheScope& operator=(const FACLDecompressionCacheScope&) = delete;
+
+private:
+	FACLInstanceDecompressionCache* PreviousCache;
+};
@@ -53,6 +53,7 @@ inline FTransform TransformCast(const acl::Transform_32& Input) { return FTransf
 #include <acl/compression/skeleton.h>
 #include <acl/compression/animation_clip.h>
 #include <acl/compression/compression_level.h>
+#include <acl/core/itask_scheduler.h>
 
 acl::RotationFormat8 GetRotationFormat(ACLRotationFormat Format);
 acl::VectorFormat8 GetVectorFormat(ACLVectorFormat Format);
@@ -60,4 +61,15 @@ acl::CompressionLevel8 GetCompressionLevel(ACLCompressionLevel Level);
 
 TUniquePtr<acl::RigidSkeleton> BuildACLSkeleton(ACLAllocator& AllocatorImpl, const FCompressibleAnimData& CompressibleAnimData, float DefaultVirtualVertexDistance, float SafeVirtualVertexDistance);
 TUniquePtr<acl::AnimationClip> BuildACLClip(ACLAllocator& AllocatorImpl, const FCompressibleAnimData& CompressibleAnimData, const acl::RigidSkeleton& ACLSkeleton, bool bBuildAdditiveBase);
+
+/** The ACL task scheduler implementation runs jobs on the task graph worker threads with ParallelFor. */
+class ACLTaskScheduler final : public acl::ITaskScheduler
+{
+public:
+	virtual uint32_t get_max_concurrency() const override;
+	virtual void run_jobs(uint32_t num_jobs, job_function function, void* user_data) override;
+};
+
+/** Returns the task scheduler to compress with, or nullptr when parallel compression is disabled (see a.ACL.ParallelCompression). */
+acl::ITaskScheduler* GetCompressionTaskScheduler();
 #endif // WITH_EDITOR
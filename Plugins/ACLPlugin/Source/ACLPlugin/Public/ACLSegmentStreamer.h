@@ -0,0 +1,101 @@
+#pragma once
+
+// Copyright 2018 Nicholas Frechette. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Serialization/BulkData.h"
+#include "Templates/Atomic.h"
+
+#include <acl/decompression/segment_streamer.h>
+
+class UAnimSequence;
+
+/*
+ * Pages the segments of a streamed ACL clip in from bulk data on demand.
+ *
+ * The resident byte stream of a streamed clip holds the clip header, segment table, constant and range data and the
+ * first segment, which is therefore always available as a fallback. The other segments live in bulk data and are only
+ * loaded once a prefetch hint asks for them, decompression never blocks on IO: a seek into a segment still in flight
+ * holds the nearest resident sample instead.
+ *
+ * Prefetching and segment queries are thread safe. Unused segments are evicted at the end of the frame, when no
+ * decompression is in flight, once they haven't been used for a.ACL.Streaming.MaxUnusedFrames frames or when the
+ * streamed segments of every clip exceed a.ACL.Streaming.BudgetKB.
+ */
+class ACLPLUGIN_API FACLSegmentStreamer final : public acl::ISegmentStreamer
+{
+public:
+	/** ACL performs unaligned 16 byte loads, the resident byte stream and every segment must be followed by this much padding. */
+	static constexpr uint32 PaddingSize = 15;
+
+	/** Returns how many leading bytes of a compressed clip stay resident when it is streamed, its full size when it has a single segment. */
+	static uint32 GetResidentSize(const acl::CompressedClip& Clip);
+
+	FACLSegmentStreamer(const TArrayView<uint8> ResidentByteStream, FByteBulkData& SegmentBulkData);
+	virtual ~FACLSegmentStreamer();
+
+	FACLSegmentStreamer(const FACLSegmentStreamer&) = delete;
+	FACLSegmentStreamer& operator=(const FACLSegmentStreamer&) = delete;
+
+	/** Requests the segments played from a time onwards, for a.ACL.Streaming.LookaheadTime seconds. */
+	void PrefetchForPlayback(float Time);
+
+	/** Requests the segments played over a time range, wrapping around the end of the clip. Cheap for segments already resident or in flight. */
+	void Prefetch(float StartTime, float Duration);
+
+	int32 GetNumSegments() const { return Pages.Num(); }
+	int32 GetNumResidentSegments() const;
+	uint32 GetNumMisses() const { return NumMisses.Load(EMemoryOrder::Relaxed); }
+
+	// acl::ISegmentStreamer implementation
+	virtual const uint8_t* get_segment_data(uint32_t SegmentIndex) override;
+
+	/** Evicts unused segments of every streamed clip. Bound to the end of the frame by the plugin module. */
+	static void TrimAll();
+
+private:
+	enum EPageState : uint8
+	{
+		Unloaded,
+		Loading,
+		Resident,
+		Failed,
+	};
+
+	struct FPage
+	{
+		TAtomic<uint8> State;
+		TAtomic<uint32> LastUseFrame;
+
+		uint32 BulkDataOffset = 0;
+		uint32 Size = 0;
+		bool bPinned = false;
+
+		uint8* Data = nullptr;
+
+		// Held while the request is issued, a page that completes early is only released once Request is set
+		FCriticalSection RequestLock;
+		IBulkDataIORequest* Request = nullptr;
+	};
+
+	void RequestPage(int32 SegmentIndex);
+	void DeleteRequest(FPage& Page);
+	void ReleasePage(FPage& Page);
+
+	const acl::CompressedClip& Clip;
+	FByteBulkData& SegmentBulkData;
+
+	TArray<FPage> Pages;
+
+	// The segment data when the bulk data was already loaded, e.g. in the editor, every page points into it
+	TArray<uint8> LoadedSegmentData;
+
+	TAtomic<uint32> NumMisses;
+};
+
+/*
+ * Requests the segments of a sequence played over a time range ahead of its playback, e.g. before a montage starts.
+ * Does nothing when the sequence isn't compressed with streamed ACL segments.
+ */
+ACLPLUGIN_API void PrefetchACLSegments(const UAnimSequence& AnimSeq, float StartTime, float Duration);
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Realtime Math contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <benchmark/benchmark.h>
+
+#include <rtm/anglef.h>
+#include <rtm/quatf.h>
+#include <rtm/vector4f.h>
+
+using namespace rtm;
+
+// Interpolates 8 rotation pairs at a time, the way a pose decoder interpolates a block of bones.
+// The AoS variant calls quat_lerp for each pair, the SoA variant transposes the pairs into 256 bit
+// lanes and performs the same operations in the same order on all 8 at once.
+
+static void setup_rotations(quatf* starts, quatf* ends)
+{
+	for (int index = 0; index < 8; ++index)
+	{
+		const float angle = float(index) * 0.3F;
+		starts[index] = quat_from_axis_angle(vector_set(0.0F, 0.0F, 1.0F), radians(angle));
+		ends[index] = quat_from_axis_angle(vector_set(0.0F, 1.0F, 0.0F), radians(angle + 0.1F));
+	}
+}
+
+static void bm_quat_lerp_x8_aos(benchmark::State& state)
+{
+	quatf starts[8];
+	quatf ends[8];
+	quatf results[8];
+	setup_rotations(starts, ends);
+
+	float alpha = 0.33F;
+	for (auto _ : state)
+	{
+		for (int index = 0; index < 8; ++index)
+			results[index] = quat_lerp(starts[index], ends[index], alpha);
+
+		benchmark::DoNotOptimize(results);
+		benchmark::ClobberMemory();
+	}
+}
+
+BENCHMARK(bm_quat_lerp_x8_aos);
+
+#if defined(RTM_AVX_INTRINSICS)
+static void quat_lerp_x8_soa(const quatf* starts, const quatf* ends, float alpha, quatf* results)
+{
+	__m128 sx0 = starts[0], sy0 = starts[1], sz0 = starts[2], sw0 = starts[3];
+	__m128 sx1 = starts[4], sy1 = starts[5], sz1 = starts[6], sw1 = starts[7];
+	__m128 ex0 = ends[0], ey0 = ends[1], ez0 = ends[2], ew0 = ends[3];
+	__m128 ex1 = ends[4], ey1 = ends[5], ez1 = ends[6], ew1 = ends[7];
+	_MM_TRANSPOSE4_PS(sx0, sy0, sz0, sw0);
+	_MM_TRANSPOSE4_PS(sx1, sy1, sz1, sw1);
+	_MM_TRANSPOSE4_PS(ex0, ey0, ez0, ew0);
+	_MM_TRANSPOSE4_PS(ex1, ey1, ez1, ew1);
+
+	const __m256 sx = _mm256_insertf128_ps(_mm256_castps128_ps256(sx0), sx1, 1);
+	const __m256 sy = _mm256_insertf128_ps(_mm256_castps128_ps256(sy0), sy1, 1);
+	const __m256 sz = _mm256_insertf128_ps(_mm256_castps128_ps256(sz0), sz1, 1);
+	const __m256 sw = _mm256_insertf128_ps(_mm256_castps128_ps256(sw0), sw1, 1);
+	const __m256 ex = _mm256_insertf128_ps(_mm256_castps128_ps256(ex0), ex1, 1);
+	const __m256 ey = _mm256_insertf128_ps(_mm256_castps128_ps256(ey0), ey1, 1);
+	const __m256 ez = _mm256_insertf128_ps(_mm256_castps128_ps256(ez0), ez1, 1);
+	const __m256 ew = _mm256_insertf128_ps(_mm256_castps128_ps256(ew0), ew1, 1);
+
+	const __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, ex), _mm256_mul_ps(sy, ey)), _mm256_add_ps(_mm256_mul_ps(sz, ez), _mm256_mul_ps(sw, ew)));
+	const __m256 bias = _mm256_and_ps(dot, _mm256_set1_ps(-0.0F));
+	const __m256 alpha_v = _mm256_set1_ps(alpha);
+
+	__m256 x = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_xor_ps(ex, bias), sx), alpha_v), sx);
+	__m256 y = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_xor_ps(ey, bias), sy), alpha_v), sy);
+	__m256 z = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_xor_ps(ez, bias), sz), alpha_v), sz);
+	__m256 w = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_xor_ps(ew, bias), sw), alpha_v), sw);
+
+	const __m256 length_squared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(z, z)), _mm256_add_ps(_mm256_mul_ps(y, y), _mm256_mul_ps(w, w)));
+	const __m256 half = _mm256_set1_ps(0.5F);
+	const __m256 input_half_v = _mm256_mul_ps(length_squared, half);
+	const __m256 x0 = _mm256_rsqrt_ps(length_squared);
+	__m256 x1 = _mm256_add_ps(_mm256_mul_ps(x0, _mm256_sub_ps(half, _mm256_mul_ps(input_half_v, _mm256_mul_ps(x0, x0)))), x0);
+	x1 = _mm256_add_ps(_mm256_mul_ps(x1, _mm256_sub_ps(half, _mm256_mul_ps(input_half_v, _mm256_mul_ps(x1, x1)))), x1);
+
+	x = _mm256_mul_ps(x, x1);
+	y = _mm256_mul_ps(y, x1);
+	z = _mm256_mul_ps(z, x1);
+	w = _mm256_mul_ps(w, x1);
+
+	__m128 rx0 = _mm256_castps256_ps128(x), ry0 = _mm256_castps256_ps128(y), rz0 = _mm256_castps256_ps128(z), rw0 = _mm256_castps256_ps128(w);
+	__m128 rx1 = _mm256_extractf128_ps(x, 1), ry1 = _mm256_extractf128_ps(y, 1), rz1 = _mm256_extractf128_ps(z, 1), rw1 = _mm256_extractf128_ps(w, 1);
+	_MM_TRANSPOSE4_PS(rx0, ry0, rz0, rw0);
+	_MM_TRANSPOSE4_PS(rx1, ry1, rz1, rw1);
+	results[0] = rx0; results[1] = ry0; results[2] = rz0; results[3] = rw0;
+	results[4] = rx1; results[5] = ry1; results[6] = rz1; results[7] = rw1;
+}
+
+static void bm_quat_lerp_x8_soa(benchmark::State& state)
+{
+	quatf starts[8];
+	quatf ends[8];
+	quatf results[8];
+	setup_rotations(starts, ends);
+
+	float alpha = 0.33F;
+	for (auto _ : state)
+	{
+		quat_lerp_x8_soa(starts, ends, alpha, results);
+
+		benchmark::DoNotOptimize(results);
+		benchmark::ClobberMemory();
+	}
+}
+
+BENCHMARK(bm_quat_lerp_x8_soa);
+#endif
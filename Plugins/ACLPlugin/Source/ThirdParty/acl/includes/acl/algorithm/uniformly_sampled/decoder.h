@@ -37,7 +37,9 @@
 #include "acl/math/vector4_32.h"
 #include "acl/math/quat_packing.h"
 #include "acl/decompression/decompress_data.h"
+#include "acl/decompression/impl/wide_interpolation.h"
 #include "acl/decompression/output_writer.h"
+#include "acl/decompression/segment_streamer.h"
 
 #include <cstdint>
 
@@ -105,7 +107,11 @@ namespace acl
 				float interpolation_alpha;						//  76 | 120
 				float sample_time;								//  80 | 124
 
-				uint8_t padding1[sizeof(void*) == 4 ? 44 : 64];	//  84 | 128	// 64 bit has a full cache line of padding, can't have 0 length array
+				uint32_t segment_indices[2];					//  84 | 128	// Segments the seeking data points into, 0xFFFFFFFF when unset
+
+				ISegmentStreamer* segment_streamer;				//  92 | 136	// Optional, provides the segment data of streamed clips
+
+				uint8_t padding1[sizeof(void*) == 4 ? 32 : 48];	//  96 | 144
 
 				//									Total size:	   128 | 192
 			};
@@ -308,8 +314,10 @@ namespace acl
 			~DecompressionContext();
 
 			//////////////////////////////////////////////////////////////////////////
-			// Initializes the context instance to a particular compressed clip
-			void initialize(const CompressedClip& clip);
+			// Initializes the context instance to a particular compressed clip.
+			// Streamed clips provide a segment streamer, their segment data is then queried
+			// from it on every seek instead of being read from the clip, see ISegmentStreamer.
+			void initialize(const CompressedClip& clip, ISegmentStreamer* segment_streamer = nullptr);
 
 			bool is_dirty(const CompressedClip& clip);
 
@@ -389,7 +397,7 @@ namespace acl
 		}
 
 		template<class DecompressionSettingsType>
-		inline void DecompressionContext<DecompressionSettingsType>::initialize(const CompressedClip& clip)
+		inline void DecompressionContext<DecompressionSettingsType>::initialize(const CompressedClip& clip, ISegmentStreamer* segment_streamer)
 		{
 			ACL_ASSERT(clip.is_valid(false).empty(), "CompressedClip is not valid");
 			ACL_ASSERT(clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Invalid algorithm type [%s], expected [%s]", get_algorithm_name(clip.get_algorithm_type()), get_algorithm_name(AlgorithmType8::UniformlySampled));
@@ -425,12 +433,14 @@ namespace acl
 			m_context.constant_tracks_bitset = header.get_constant_tracks_bitset();
 			m_context.constant_track_data = header.get_constant_track_data();
 			m_context.clip_range_data = header.get_clip_range_data();
+			m_context.segment_streamer = segment_streamer;
 
 			for (uint8_t key_frame_index = 0; key_frame_index < 2; ++key_frame_index)
 			{
 				m_context.format_per_track_data[key_frame_index] = nullptr;
 				m_context.segment_range_data[key_frame_index] = nullptr;
 				m_context.animated_track_data[key_frame_index] = nullptr;
+				m_context.segment_indices[key_frame_index] = 0xFFFFFFFFU;
 			}
 
 			const uint32_t num_tracks_per_bone = header.has_scale ? 3 : 2;
@@ -465,7 +475,9 @@ namespace acl
 			// TODO: Make it optional via DecompressionSettingsType?
 			sample_time = clamp(sample_time, 0.0F, m_context.clip_duration);
 
-			if (m_context.sample_time == sample_time)
+			// Streamed segments can be paged in or out between seeks, we always query them again
+			ISegmentStreamer* segment_streamer = m_context.segment_streamer;
+			if (m_context.sample_time == sample_time && segment_streamer == nullptr)
 				return;
 
 			m_context.sample_time = sample_time;
@@ -476,68 +488,125 @@ namespace acl
 			uint32_t key_frame1;
 			find_linear_interpolation_samples_with_sample_rate(header.num_samples, header.sample_rate, sample_time, rounding_policy, key_frame0, key_frame1, m_context.interpolation_alpha);
 
-			uint32_t segment_key_frame0;
-			uint32_t segment_key_frame1;
-
-			const SegmentHeader* segment_header0;
-			const SegmentHeader* segment_header1;
+			uint32_t segment_index0 = 0;
+			uint32_t segment_index1 = 0;
+			uint32_t segment_key_frame0 = key_frame0;
+			uint32_t segment_key_frame1 = key_frame1;
 
 			const SegmentHeader* segment_headers = header.get_segment_headers();
 			const uint32_t num_segments = header.num_segments;
 
-			if (num_segments == 1)
+			if (num_segments != 1)
 			{
-				// Key frame 0 and 1 are in the only segment present
+				// Key frame 0 and 1 are in the only segment present when there is a single one
 				// This is a really common case and when it happens, we don't store the segment start index (zero)
-				segment_header0 = segment_headers;
-				segment_key_frame0 = key_frame0;
-
-				segment_header1 = segment_headers;
-				segment_key_frame1 = key_frame1;
-			}
-			else
-			{
 				const uint32_t* segment_start_indices = header.get_segment_start_indices();
 
-				// See segment_streams(..) for implementation details. This implementation is directly tied to it.
-				const uint32_t approx_num_samples_per_segment = header.num_samples / num_segments;	// TODO: Store in header?
-				const uint32_t approx_segment_index = key_frame0 / approx_num_samples_per_segment;
-
-				uint32_t segment_index0 = 0;
-				uint32_t segment_index1 = 0;
-
-				// Our approximate segment guess is just that, a guess. The actual segments we need could be just before or after.
-				// We start looking one segment earlier and up to 2 after. If we have too few segments after, we will hit the
-				// sentinel value of 0xFFFFFFFF and exit the loop.
-				// TODO: Can we do this with SIMD? Load all 4 values, set key_frame0, compare, move mask, count leading zeroes
-				const uint32_t start_segment_index = approx_segment_index > 0 ? (approx_segment_index - 1) : 0;
-				const uint32_t end_segment_index = start_segment_index + 4;
-
-				for (uint32_t segment_index = start_segment_index; segment_index < end_segment_index; ++segment_index)
+				// Playback usually advances within the segment the previous seek landed in, check it before searching.
+				// The start indices are terminated by a 0xFFFFFFFF sentinel so reading one past the last segment is safe.
+				const uint32_t previous_segment_index = m_context.segment_indices[0];
+				if (previous_segment_index < num_segments && key_frame0 >= segment_start_indices[previous_segment_index] && key_frame0 < segment_start_indices[previous_segment_index + 1])
+				{
+					segment_index0 = previous_segment_index;
+				}
+				else
 				{
-					if (key_frame0 < segment_start_indices[segment_index])
+					// See segment_streams(..) for implementation details. This implementation is directly tied to it.
+					const uint32_t approx_num_samples_per_segment = header.num_samples / num_segments;	// TODO: Store in header?
+					const uint32_t approx_segment_index = key_frame0 / approx_num_samples_per_segment;
+
+					// Our approximate segment guess is just that, a guess. The actual segments we need could be just before or after.
+					// We start looking one segment earlier and up to 2 after. If we have too few segments after, we will hit the
+					// sentinel value of 0xFFFFFFFF and exit the loop.
+					// TODO: Can we do this with SIMD? Load all 4 values, set key_frame0, compare, move mask, count leading zeroes
+					const uint32_t start_segment_index = approx_segment_index > 0 ? (approx_segment_index - 1) : 0;
+					const uint32_t end_segment_index = start_segment_index + 4;
+
+					for (uint32_t segment_index = start_segment_index; segment_index < end_segment_index; ++segment_index)
 					{
-						// We went too far, use previous segment
-						ACL_ASSERT(segment_index > 0, "Invalid segment index: %u", segment_index);
-						segment_index0 = segment_index - 1;
-						segment_index1 = key_frame1 < segment_start_indices[segment_index] ? segment_index0 : segment_index;
-						break;
+						if (key_frame0 < segment_start_indices[segment_index])
+						{
+							// We went too far, use previous segment
+							ACL_ASSERT(segment_index > 0, "Invalid segment index: %u", segment_index);
+							segment_index0 = segment_index - 1;
+							break;
+						}
 					}
 				}
 
-				segment_header0 = segment_headers + segment_index0;
-				segment_header1 = segment_headers + segment_index1;
+				segment_index1 = key_frame1 < segment_start_indices[segment_index0 + 1] ? segment_index0 : (segment_index0 + 1);
 
 				segment_key_frame0 = key_frame0 - segment_start_indices[segment_index0];
 				segment_key_frame1 = key_frame1 - segment_start_indices[segment_index1];
 			}
 
-			m_context.format_per_track_data[0] = header.get_format_per_track_data(*segment_header0);
-			m_context.format_per_track_data[1] = header.get_format_per_track_data(*segment_header1);
-			m_context.segment_range_data[0] = header.get_segment_range_data(*segment_header0);
-			m_context.segment_range_data[1] = header.get_segment_range_data(*segment_header1);
-			m_context.animated_track_data[0] = header.get_track_data(*segment_header0);
-			m_context.animated_track_data[1] = header.get_track_data(*segment_header1);
+			const uint8_t* segment_data0 = nullptr;
+			const uint8_t* segment_data1 = nullptr;
+			if (segment_streamer != nullptr)
+			{
+				segment_data0 = segment_streamer->get_segment_data(segment_index0);
+				if (segment_data0 == nullptr)
+				{
+					// Hold the sample closest to the missing segment until it streams in
+					const uint32_t* segment_start_indices = header.get_segment_start_indices();
+					const uint32_t resident_segment_index = acl::impl::find_nearest_resident_segment(*segment_streamer, num_segments, segment_index0, segment_data0);
+					const uint32_t resident_segment_start = segment_start_indices[resident_segment_index];
+					const uint32_t resident_segment_end = segment_start_indices[resident_segment_index + 1];
+
+					segment_index0 = resident_segment_index;
+					segment_index1 = resident_segment_index;
+					segment_key_frame0 = key_frame0 < resident_segment_start ? 0 : (resident_segment_end - resident_segment_start - 1);
+					segment_key_frame1 = segment_key_frame0;
+					segment_data1 = segment_data0;
+					m_context.interpolation_alpha = 0.0F;
+				}
+				else if (segment_index1 != segment_index0)
+				{
+					segment_data1 = segment_streamer->get_segment_data(segment_index1);
+					if (segment_data1 == nullptr)
+					{
+						// Hold the last sample of the first segment until the next one streams in
+						segment_index1 = segment_index0;
+						segment_key_frame1 = segment_key_frame0;
+						segment_data1 = segment_data0;
+						m_context.interpolation_alpha = 0.0F;
+					}
+				}
+				else
+				{
+					segment_data1 = segment_data0;
+				}
+			}
+
+			const SegmentHeader* segment_header0 = segment_headers + segment_index0;
+			const SegmentHeader* segment_header1 = segment_headers + segment_index1;
+
+			if (segment_streamer != nullptr)
+			{
+				// Streamed segment data can live anywhere, offsets are relative to where each segment starts
+				const uint32_t segment_data_start0 = acl::impl::get_segment_data_start(*segment_header0);
+				const uint32_t segment_data_start1 = acl::impl::get_segment_data_start(*segment_header1);
+				m_context.format_per_track_data[0] = acl::impl::get_streamed_segment_data(segment_data0, segment_data_start0, segment_header0->format_per_track_data_offset);
+				m_context.format_per_track_data[1] = acl::impl::get_streamed_segment_data(segment_data1, segment_data_start1, segment_header1->format_per_track_data_offset);
+				m_context.segment_range_data[0] = acl::impl::get_streamed_segment_data(segment_data0, segment_data_start0, segment_header0->range_data_offset);
+				m_context.segment_range_data[1] = acl::impl::get_streamed_segment_data(segment_data1, segment_data_start1, segment_header1->range_data_offset);
+				m_context.animated_track_data[0] = acl::impl::get_streamed_segment_data(segment_data0, segment_data_start0, segment_header0->track_data_offset);
+				m_context.animated_track_data[1] = acl::impl::get_streamed_segment_data(segment_data1, segment_data_start1, segment_header1->track_data_offset);
+				m_context.segment_indices[0] = segment_index0;
+				m_context.segment_indices[1] = segment_index1;
+			}
+			else if (segment_index0 != m_context.segment_indices[0] || segment_index1 != m_context.segment_indices[1])
+			{
+				// Staying in the same segments keeps every per-segment pointer, only the key frame offsets move
+				m_context.format_per_track_data[0] = header.get_format_per_track_data(*segment_header0);
+				m_context.format_per_track_data[1] = header.get_format_per_track_data(*segment_header1);
+				m_context.segment_range_data[0] = header.get_segment_range_data(*segment_header0);
+				m_context.segment_range_data[1] = header.get_segment_range_data(*segment_header1);
+				m_context.animated_track_data[0] = header.get_track_data(*segment_header0);
+				m_context.animated_track_data[1] = header.get_track_data(*segment_header1);
+				m_context.segment_indices[0] = segment_index0;
+				m_context.segment_indices[1] = segment_index1;
+			}
 
 			m_context.key_frame_byte_offsets[0] = (segment_key_frame0 * segment_header0->animated_pose_bit_size) / 8;
 			m_context.key_frame_byte_offsets[1] = (segment_key_frame1 * segment_header1->animated_pose_bit_size) / 8;
@@ -577,6 +646,130 @@ namespace acl
 			sampling_context.key_frame_bit_offsets[1] = m_context.key_frame_bit_offsets[1];
 
 			const uint16_t num_bones = header.num_bones;
+
+#if defined(ACL_IMPL_WIDE_INTERPOLATION)
+			// Unpack the key frames of a block of bones, then interpolate the whole block at once
+			constexpr uint16_t k_block_size = uint16_t(acl_impl::k_wide_interpolation_width);
+
+			Quat_32 rotation_key_frames[2][k_block_size];
+			Vector4_32 translation_key_frames[2][k_block_size];
+			Vector4_32 scale_key_frames[2][k_block_size];
+			Quat_32 rotations[k_block_size];
+			Vector4_32 translations[k_block_size];
+			Vector4_32 scales[k_block_size];
+
+			const Quat_32 identity_rotation = quat_identity_32();
+			const Vector4_32 zero_vector = vector_zero_32();
+			const float interpolation_alpha = m_context.interpolation_alpha;
+
+			for (uint16_t block_start_index = 0; block_start_index < num_bones; block_start_index += k_block_size)
+			{
+				const uint16_t block_end_index = (num_bones - block_start_index) > k_block_size ? uint16_t(block_start_index + k_block_size) : num_bones;
+
+				// Each bit is a bone in the block
+				uint32_t written_rotations = 0;
+				uint32_t written_translations = 0;
+				uint32_t written_scales = 0;
+				uint32_t animated_rotations = 0;
+				uint32_t animated_translations = 0;
+				uint32_t animated_scales = 0;
+
+				for (uint16_t bone_index = block_start_index; bone_index < block_end_index; ++bone_index)
+				{
+					const uint32_t block_index = bone_index - block_start_index;
+					const uint32_t block_bit = 1U << block_index;
+
+					// Lanes without key frames still get interpolated, keep their inputs well formed
+					Quat_32 rotation_samples[impl::SamplingContext::k_num_samples_to_interpolate] = { identity_rotation, identity_rotation };
+					if (writer.skip_all_bone_rotations() || writer.skip_bone_rotation(bone_index))
+						skip_over_rotation(m_settings, header, m_context, sampling_context);
+					else
+					{
+						written_rotations |= block_bit;
+						if (decompress_rotation_key_frames(m_settings, header, m_context, sampling_context, &rotation_samples[0]))
+							animated_rotations |= block_bit;
+						else
+							rotations[block_index] = rotation_samples[0];
+					}
+					rotation_key_frames[0][block_index] = rotation_samples[0];
+					rotation_key_frames[1][block_index] = (animated_rotations & block_bit) != 0 ? rotation_samples[1] : rotation_samples[0];
+
+					Vector4_32 translation_samples[impl::SamplingContext::k_num_samples_to_interpolate] = { zero_vector, zero_vector };
+					if (writer.skip_all_bone_translations() || writer.skip_bone_translation(bone_index))
+						skip_over_vector(translation_adapter, header, m_context, sampling_context);
+					else
+					{
+						written_translations |= block_bit;
+						if (decompress_vector_key_frames(translation_adapter, header, m_context, sampling_context, &translation_samples[0]))
+							animated_translations |= block_bit;
+						else
+							translations[block_index] = translation_samples[0];
+					}
+					translation_key_frames[0][block_index] = translation_samples[0];
+					translation_key_frames[1][block_index] = (animated_translations & block_bit) != 0 ? translation_samples[1] : translation_samples[0];
+
+					Vector4_32 scale_samples[impl::SamplingContext::k_num_samples_to_interpolate] = { zero_vector, zero_vector };
+					if (writer.skip_all_bone_scales() || writer.skip_bone_scale(bone_index))
+					{
+						if (header.has_scale)
+							skip_over_vector(scale_adapter, header, m_context, sampling_context);
+					}
+					else
+					{
+						written_scales |= block_bit;
+						if (!header.has_scale)
+							scales[block_index] = scale_adapter.get_default_value();
+						else if (decompress_vector_key_frames(scale_adapter, header, m_context, sampling_context, &scale_samples[0]))
+							animated_scales |= block_bit;
+						else
+							scales[block_index] = scale_samples[0];
+					}
+					scale_key_frames[0][block_index] = scale_samples[0];
+					scale_key_frames[1][block_index] = (animated_scales & block_bit) != 0 ? scale_samples[1] : scale_samples[0];
+				}
+
+				// Fill the lanes past the last bone of a partial block
+				for (uint32_t block_index = block_end_index - block_start_index; block_index < k_block_size; ++block_index)
+				{
+					rotation_key_frames[0][block_index] = rotation_key_frames[1][block_index] = identity_rotation;
+					translation_key_frames[0][block_index] = translation_key_frames[1][block_index] = zero_vector;
+					scale_key_frames[0][block_index] = scale_key_frames[1][block_index] = zero_vector;
+				}
+
+				Quat_32 interpolated_rotations[k_block_size];
+				Vector4_32 interpolated_translations[k_block_size];
+				Vector4_32 interpolated_scales[k_block_size];
+
+				if (animated_rotations != 0)
+					acl_impl::quat_lerp_wide(&rotation_key_frames[0][0], &rotation_key_frames[1][0], interpolation_alpha, &interpolated_rotations[0]);
+
+				if (animated_translations != 0)
+					acl_impl::vector_lerp_wide(&translation_key_frames[0][0], &translation_key_frames[1][0], interpolation_alpha, &interpolated_translations[0]);
+
+				if (animated_scales != 0)
+					acl_impl::vector_lerp_wide(&scale_key_frames[0][0], &scale_key_frames[1][0], interpolation_alpha, &interpolated_scales[0]);
+
+				for (uint16_t bone_index = block_start_index; bone_index < block_end_index; ++bone_index)
+				{
+					const uint32_t block_index = bone_index - block_start_index;
+					const uint32_t block_bit = 1U << block_index;
+
+					if ((written_rotations & block_bit) != 0)
+					{
+						const Quat_32 rotation = (animated_rotations & block_bit) != 0 ? interpolated_rotations[block_index] : rotations[block_index];
+						ACL_ASSERT(quat_is_finite(rotation), "Rotation is not valid!");
+						ACL_ASSERT(quat_is_normalized(rotation), "Rotation is not normalized!");
+						writer.write_bone_rotation(bone_index, rotation);
+					}
+
+					if ((written_translations & block_bit) != 0)
+						writer.write_bone_translation(bone_index, (animated_translations & block_bit) != 0 ? interpolated_translations[block_index] : translations[block_index]);
+
+					if ((written_scales & block_bit) != 0)
+						writer.write_bone_scale(bone_index, (animated_scales & block_bit) != 0 ? interpolated_scales[block_index] : scales[block_index]);
+				}
+			}
+#else
 			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
 			{
 				if (writer.skip_all_bone_rotations() || writer.skip_bone_rotation(bone_index))
@@ -606,6 +799,7 @@ namespace acl
 					writer.write_bone_scale(bone_index, scale);
 				}
 			}
+#endif
 
 			if (m_settings.disable_fp_exeptions())
 				restore_fp_exceptions(fp_env);
@@ -27,6 +27,7 @@
 #include "acl/core/compiler_utils.h"
 #include "acl/core/error_result.h"
 #include "acl/core/hash.h"
+#include "acl/core/itask_scheduler.h"
 #include "acl/core/track_types.h"
 #include "acl/core/range_reduction_types.h"
 #include "acl/compression/compression_level.h"
@@ -131,6 +132,12 @@ namespace acl
 		// Defaults to 'null', this value must be set manually!
 		ISkeletalErrorMetric* error_metric;
 
+		//////////////////////////////////////////////////////////////////////////
+		// The task scheduler used to optimize segments concurrently, if any.
+		// It has no impact on the compressed output and as such isn't part of the hash.
+		// Defaults to 'null', segments are processed serially on the calling thread.
+		ITaskScheduler* task_scheduler;
+
 		//////////////////////////////////////////////////////////////////////////
 		// Threshold angle when detecting if rotation tracks are constant or default.
 		// See the Quat_32 quat_near_identity for details about how the default threshold
@@ -168,6 +175,7 @@ namespace acl
 			, range_reduction(RangeReductionFlags8::None)
 			, segmenting()
 			, error_metric(nullptr)
+			, task_scheduler(nullptr)
 			, constant_rotation_threshold_angle(0.00284714461F)
 			, constant_translation_threshold(0.001F)
 			, constant_scale_threshold(0.00001F)
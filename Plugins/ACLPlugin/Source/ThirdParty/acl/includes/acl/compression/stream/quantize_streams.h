@@ -27,6 +27,7 @@
 #include "acl/core/iallocator.h"
 #include "acl/core/compiler_utils.h"
 #include "acl/core/error.h"
+#include "acl/core/itask_scheduler.h"
 #include "acl/core/utils.h"
 #include "acl/math/quat_32.h"
 #include "acl/math/quat_packing.h"
@@ -41,6 +42,8 @@
 #include "acl/compression/skeleton_error_metric.h"
 #include "acl/compression/compression_settings.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 
@@ -1273,6 +1276,54 @@ namespace acl
 			deallocate_type_array(context.allocator, best_permutation_bit_rates, context.num_bones);
 			deallocate_type_array(context.allocator, best_bit_rates, context.num_bones);
 		}
+
+		inline void quantize_segment(QuantizationContext& context, SegmentContext& segment, bool is_any_variable)
+		{
+#if ACL_IMPL_DEBUG_VARIABLE_QUANTIZATION
+			printf("Quantizing segment %u...\n", segment.segment_index);
+#endif
+
+			context.set_segment(segment);
+
+			if (is_any_variable)
+				find_optimal_bit_rates(context);
+
+			// Quantize our streams now that we found the optimal bit rates
+			quantize_all_streams(context);
+		}
+
+		struct ParallelQuantizationJobs
+		{
+			IAllocator& allocator;
+			ClipContext& clip;
+			const ClipContext& raw_clip;
+			const ClipContext& additive_base_clip;
+			const CompressionSettings& settings;
+			const RigidSkeleton& skeleton;
+			bool is_any_variable;
+
+			std::atomic<uint32_t> next_segment_index;
+		};
+
+		inline void quantize_segments_job(void* user_data, uint32_t job_index)
+		{
+			(void)job_index;
+
+			ParallelQuantizationJobs& jobs = *static_cast<ParallelQuantizationJobs*>(user_data);
+
+			// Every job owns its scratch memory and database, segments only ever read the shared clip
+			// data and write their own streams which makes the result independent of the job that ran them
+			QuantizationContext context(jobs.allocator, jobs.clip, jobs.raw_clip, jobs.additive_base_clip, jobs.settings, jobs.skeleton);
+
+			while (true)
+			{
+				const uint32_t segment_index = jobs.next_segment_index.fetch_add(1, std::memory_order_relaxed);
+				if (segment_index >= jobs.clip.num_segments)
+					break;
+
+				quantize_segment(context, jobs.clip.segments[segment_index], jobs.is_any_variable);
+			}
+		}
 	}
 
 	inline void quantize_streams(IAllocator& allocator, ClipContext& clip_context, const CompressionSettings& settings, const RigidSkeleton& skeleton, const ClipContext& raw_clip_context, const ClipContext& additive_base_clip_context)
@@ -1282,22 +1333,23 @@ namespace acl
 		const bool is_scale_variable = is_vector_format_variable(settings.scale_format);
 		const bool is_any_variable = is_rotation_variable || is_translation_variable || is_scale_variable;
 
-		impl::QuantizationContext context(allocator, clip_context, raw_clip_context, additive_base_clip_context, settings, skeleton);
+		// Searching for the optimal bit rates dominates, fixed formats aren't worth dispatching
+		ITaskScheduler* task_scheduler = settings.task_scheduler;
+		const uint32_t max_concurrency = task_scheduler != nullptr && is_any_variable ? task_scheduler->get_max_concurrency() : 1;
+		const uint32_t num_jobs = std::min<uint32_t>(max_concurrency, clip_context.num_segments);
 
-		for (SegmentContext& segment : clip_context.segment_iterator())
+		if (num_jobs > 1)
 		{
-#if ACL_IMPL_DEBUG_VARIABLE_QUANTIZATION
-			printf("Quantizing segment %u...\n", segment.segment_index);
-#endif
-
-			context.set_segment(segment);
+			// The allocator is used concurrently by every job and must be thread safe
+			impl::ParallelQuantizationJobs jobs{ allocator, clip_context, raw_clip_context, additive_base_clip_context, settings, skeleton, is_any_variable, {0} };
+			task_scheduler->run_jobs(num_jobs, impl::quantize_segments_job, &jobs);
+			return;
+		}
 
-			if (is_any_variable)
-				impl::find_optimal_bit_rates(context);
+		impl::QuantizationContext context(allocator, clip_context, raw_clip_context, additive_base_clip_context, settings, skeleton);
 
-			// Quantize our streams now that we found the optimal bit rates
-			impl::quantize_all_streams(context);
-		}
+		for (SegmentContext& segment : clip_context.segment_iterator())
+			impl::quantize_segment(context, segment, is_any_variable);
 	}
 }
 
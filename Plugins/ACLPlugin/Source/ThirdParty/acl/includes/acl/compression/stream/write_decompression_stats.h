@@ -31,6 +31,7 @@
 #include "acl/core/scope_profiler.h"
 #include "acl/core/utils.h"
 #include "acl/algorithm/uniformly_sampled/decoder.h"
+#include "acl/compression/compression_settings.h"
 #include "acl/compression/output_stats.h"
 #include "acl/decompression/default_output_writer.h"
 
@@ -294,6 +295,35 @@ namespace acl
 		deallocate_type(allocator, cache_flusher);
 	}
 
+	//////////////////////////////////////////////////////////////////////////
+	// Measures the decompression performance of a uniformly sampled clip with the provided decompression settings.
+	// The settings must support the formats the clip was compressed with.
+	template<class DecompressionSettingsType>
+	inline void write_decompression_performance_stats(IAllocator& allocator, const CompressedClip& compressed_clip, StatLogging logging, sjson::ObjectWriter& writer)
+	{
+		ACL_ASSERT(compressed_clip.get_algorithm_type() == AlgorithmType8::UniformlySampled, "Only uniformly sampled clips are supported");
+
+		CompressedClip* compressed_clips[k_num_decompression_evaluations];
+		for (uint32_t clip_index = 0; clip_index < k_num_decompression_evaluations; ++clip_index)
+		{
+			void* clip = allocator.allocate(compressed_clip.get_size(), alignof(CompressedClip));
+			std::memcpy(clip, &compressed_clip, compressed_clip.get_size());
+			compressed_clips[clip_index] = reinterpret_cast<CompressedClip*>(clip);
+		}
+
+		uniformly_sampled::DecompressionContext<DecompressionSettingsType>* contexts[k_num_decompression_evaluations];
+		for (uint32_t clip_index = 0; clip_index < k_num_decompression_evaluations; ++clip_index)
+			contexts[clip_index] = uniformly_sampled::make_decompression_context<DecompressionSettingsType>(allocator);
+
+		write_decompression_performance_stats(allocator, compressed_clips, contexts, logging, writer);
+
+		for (uint32_t pass_index = 0; pass_index < k_num_decompression_evaluations; ++pass_index)
+			contexts[pass_index]->release();
+
+		for (uint32_t clip_index = 0; clip_index < k_num_decompression_evaluations; ++clip_index)
+			allocator.deallocate(compressed_clips[clip_index], compressed_clip.get_size());
+	}
+
 	inline void write_decompression_performance_stats(IAllocator& allocator, const CompressionSettings& settings, const CompressedClip& compressed_clip, StatLogging logging, sjson::ObjectWriter& writer)
 	{
 		(void)settings;
@@ -315,25 +345,7 @@ namespace acl
 			ACL_ASSERT(use_uniform_fast_path, "We do not support profiling the debug code path");
 #endif
 
-			CompressedClip* compressed_clips[k_num_decompression_evaluations];
-			for (uint32_t clip_index = 0; clip_index < k_num_decompression_evaluations; ++clip_index)
-			{
-				void* clip = allocator.allocate(compressed_clip.get_size(), alignof(CompressedClip));
-				std::memcpy(clip, &compressed_clip, compressed_clip.get_size());
-				compressed_clips[clip_index] = reinterpret_cast<CompressedClip*>(clip);
-			}
-
-			uniformly_sampled::DecompressionContext<uniformly_sampled::DefaultDecompressionSettings>* contexts[k_num_decompression_evaluations];
-			for (uint32_t clip_index = 0; clip_index < k_num_decompression_evaluations; ++clip_index)
-				contexts[clip_index] = uniformly_sampled::make_decompression_context<uniformly_sampled::DefaultDecompressionSettings>(allocator);
-
-			write_decompression_performance_stats(allocator, compressed_clips, contexts, logging, writer);
-
-			for (uint32_t pass_index = 0; pass_index < k_num_decompression_evaluations; ++pass_index)
-				contexts[pass_index]->release();
-
-			for (uint32_t clip_index = 0; clip_index < k_num_decompression_evaluations; ++clip_index)
-				allocator.deallocate(compressed_clips[clip_index], compressed_clip.get_size());
+			write_decompression_performance_stats<uniformly_sampled::DefaultDecompressionSettings>(allocator, compressed_clip, logging, writer);
 			break;
 		}
 		}
@@ -0,0 +1,72 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/compiler_utils.h"
+
+#include <cstdint>
+
+ACL_IMPL_FILE_PRAGMA_PUSH
+
+namespace acl
+{
+	////////////////////////////////////////////////////////////////////////////////
+	// A simple task scheduler interface.
+	//
+	// Some compression passes work on independent pieces of data (e.g. segments) and
+	// can run them concurrently when a scheduler is provided in the compression settings.
+	// To use your own job system, derive from this interface and forward the jobs to it.
+	//
+	// Results never depend on the scheduler used or on how many jobs run concurrently,
+	// the compressed output is identical to the one produced without a scheduler.
+	////////////////////////////////////////////////////////////////////////////////
+	class ITaskScheduler
+	{
+	public:
+		using job_function = void(*)(void* user_data, uint32_t job_index);
+
+		ITaskScheduler() {}
+		virtual ~ITaskScheduler() {}
+
+		ITaskScheduler(const ITaskScheduler&) = delete;
+		ITaskScheduler& operator=(const ITaskScheduler&) = delete;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// Returns the maximum number of jobs that can usefully run at the same time.
+		// Each job allocates its own scratch memory, this bounds how much is used at once.
+		virtual uint32_t get_max_concurrency() const = 0;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// Executes 'function' once for every job index in [0, num_jobs) and returns once they have all completed.
+		// Jobs can run in any order and on any thread, including the calling thread.
+		//
+		// num_jobs: The number of jobs to run, never larger than get_max_concurrency().
+		// function: The job entry point.
+		// user_data: An opaque pointer forwarded to every job.
+		virtual void run_jobs(uint32_t num_jobs, job_function function, void* user_data) = 0;
+	};
+}
+
+ACL_IMPL_FILE_PRAGMA_POP
@@ -41,6 +41,7 @@
 #include <rtm/scalarf.h>
 #include <rtm/vector4f.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <type_traits>
 
@@ -146,6 +147,14 @@ namespace acl
 		template<class track_writer_type>
 		void decompress_track(uint32_t track_index, track_writer_type& writer);
 
+		//////////////////////////////////////////////////////////////////////////
+		// Decompress every float1f track at the current sample time in a single pass,
+		// interpolating four tracks at a time with SIMD.
+		// The value of track i is written to out_values[output_indices[i]]. Tracks with an
+		// output index of k_invalid_track_index are skipped and none of their data is read.
+		// Only supported when the compressed tracks are float1f.
+		void decompress_float1_tracks(const uint32_t* output_indices, float* out_values);
+
 		//////////////////////////////////////////////////////////////////////////
 		// Releases the context instance if it contains an allocator reference.
 		void release();
@@ -681,6 +690,135 @@ namespace acl
 			restore_fp_exceptions(fp_env);
 	}
 
+	template<class decompression_settings_type>
+	inline void decompression_context<decompression_settings_type>::decompress_float1_tracks(const uint32_t* output_indices, float* out_values)
+	{
+		ACL_ASSERT(m_context.is_initialized(), "Context is not initialized");
+		ACL_ASSERT(output_indices != nullptr && out_values != nullptr, "Output indices and values are required");
+
+		const acl_impl::tracks_header& header = acl_impl::get_tracks_header(*m_context.tracks);
+		ACL_ASSERT(header.track_type == track_type8::float1f, "Only float1f tracks are supported");
+
+		if (!m_settings.is_track_type_supported(track_type8::float1f))
+			return;
+
+		// Due to the SIMD operations, we sometimes overflow in the SIMD lanes not used.
+		// Disable floating point exceptions to avoid issues.
+		fp_environment fp_env;
+		if (m_settings.disable_fp_exeptions())
+			disable_fp_exceptions(fp_env);
+
+		const acl_impl::track_metadata* per_track_metadata = header.get_track_metadata();
+		const float* constant_values = header.get_track_constant_values();
+		const float* range_values = header.get_track_range_values();
+		const uint8_t* animated_values = header.get_track_animated_values();
+
+		uint32_t track_bit_offset0 = m_context.key_frame_bit_offsets[0];
+		uint32_t track_bit_offset1 = m_context.key_frame_bit_offsets[1];
+
+		// Every track kind is reconstructed as ((sample * scale) * extent) + min before interpolation:
+		//    - quantized samples are normalized by their bit rate and range reduced
+		//    - raw samples are left as is with a scale and extent of 1.0 and a min of -0.0
+		//    - constant values end up in min with a sample, scale and extent of 0.0, both key frames are then equal
+		// This lets us interpolate any mix of tracks with the same instructions and yields the same values as decompress_tracks(..).
+		alignas(16) float samples0[4];
+		alignas(16) float samples1[4];
+		alignas(16) float scales[4];
+		alignas(16) float range_extents[4];
+		alignas(16) float range_mins[4];
+		alignas(16) float results[4];
+		uint32_t lane_output_indices[4];
+
+		const uint32_t num_tracks = header.num_tracks;
+		for (uint32_t track_index = 0; track_index < num_tracks; track_index += 4)
+		{
+			const uint32_t num_lanes = std::min<uint32_t>(num_tracks - track_index, 4);
+			bool has_output = false;
+
+			for (uint32_t lane_index = 0; lane_index < 4; ++lane_index)
+			{
+				samples0[lane_index] = 0.0F;
+				samples1[lane_index] = 0.0F;
+				scales[lane_index] = 0.0F;
+				range_extents[lane_index] = 0.0F;
+				range_mins[lane_index] = 0.0F;
+				lane_output_indices[lane_index] = k_invalid_track_index;
+
+				if (lane_index >= num_lanes)
+					continue;
+
+				const uint8_t bit_rate = per_track_metadata[track_index + lane_index].bit_rate;
+				const uint32_t output_index = output_indices[track_index + lane_index];
+				const bool is_used = output_index != k_invalid_track_index;
+
+				lane_output_indices[lane_index] = output_index;
+				has_output |= is_used;
+
+				if (is_constant_bit_rate(bit_rate))
+				{
+					if (is_used)
+						range_mins[lane_index] = *constant_values;
+
+					constant_values += 1;
+					continue;
+				}
+
+				const uint32_t num_bits_per_component = get_num_bits_at_bit_rate(bit_rate);
+
+				if (is_raw_bit_rate(bit_rate))
+				{
+					if (is_used)
+					{
+						samples0[lane_index] = acl_impl::unpack_raw_float_unsafe(animated_values, track_bit_offset0);
+						samples1[lane_index] = acl_impl::unpack_raw_float_unsafe(animated_values, track_bit_offset1);
+						scales[lane_index] = 1.0F;
+						range_extents[lane_index] = 1.0F;
+						range_mins[lane_index] = -0.0F;
+					}
+				}
+				else
+				{
+					if (is_used)
+					{
+						samples0[lane_index] = float(acl_impl::unpack_uXX_unsafe(uint8_t(num_bits_per_component), animated_values, track_bit_offset0));
+						samples1[lane_index] = float(acl_impl::unpack_uXX_unsafe(uint8_t(num_bits_per_component), animated_values, track_bit_offset1));
+						scales[lane_index] = 1.0F / float((1 << num_bits_per_component) - 1);
+						range_mins[lane_index] = range_values[0];
+						range_extents[lane_index] = range_values[1];
+					}
+
+					range_values += 2;
+				}
+
+				track_bit_offset0 += num_bits_per_component;
+				track_bit_offset1 += num_bits_per_component;
+			}
+
+			if (!has_output)
+				continue;
+
+			const rtm::vector4f scale = rtm::vector_load(&scales[0]);
+			const rtm::vector4f range_extent = rtm::vector_load(&range_extents[0]);
+			const rtm::vector4f range_min = rtm::vector_load(&range_mins[0]);
+
+			rtm::vector4f value0 = rtm::vector_mul(rtm::vector_load(&samples0[0]), scale);
+			rtm::vector4f value1 = rtm::vector_mul(rtm::vector_load(&samples1[0]), scale);
+			value0 = rtm::vector_mul_add(value0, range_extent, range_min);
+			value1 = rtm::vector_mul_add(value1, range_extent, range_min);
+
+			rtm::vector_store(rtm::vector_lerp(value0, value1, m_context.interpolation_alpha), &results[0]);
+
+			for (uint32_t lane_index = 0; lane_index < num_lanes; ++lane_index)
+			{
+				if (lane_output_indices[lane_index] != k_invalid_track_index)
+					out_values[lane_output_indices[lane_index]] = results[lane_index];
+			}
+		}
+
+		if (m_settings.disable_fp_exeptions())
+			restore_fp_exceptions(fp_env);
+	}
+
 	template<class decompression_settings_type>
 	inline void decompression_context<decompression_settings_type>::release()
 	{
@@ -710,12 +710,16 @@ namespace acl
 		return decompress_vectors<4>(settings, header, decomp_context, sampling_context, out_vectors);
 	}
 
+	// Decompresses the key frames of the next rotation track, leaving their interpolation to the caller.
+	// Returns true when the track is animated and out_rotations holds one sample per key frame to interpolate.
+	// Returns false when the track is default or constant, out_rotations[0] then holds the final rotation.
 	template <class SettingsType, class DecompressionContextType, class SamplingContextType>
-	inline Quat_32 ACL_SIMD_CALL decompress_and_interpolate_rotation(const SettingsType& settings, const ClipHeader& header, const DecompressionContextType& decomp_context, SamplingContextType& sampling_context)
+	inline bool decompress_rotation_key_frames(const SettingsType& settings, const ClipHeader& header, const DecompressionContextType& decomp_context, SamplingContextType& sampling_context, Quat_32* out_rotations)
 	{
 		static_assert(SamplingContextType::k_num_samples_to_interpolate == 2 || SamplingContextType::k_num_samples_to_interpolate == 4, "Unsupported number of samples");
 
 		Quat_32 interpolated_rotation;
+		bool is_animated = false;
 
 		const BitSetIndexRef track_index_bit_ref(decomp_context.bitset_desc, sampling_context.track_index);
 		const bool is_sample_default = bitset_test(decomp_context.default_tracks_bitset, track_index_bit_ref);
@@ -837,6 +841,12 @@ namespace acl
 						for (size_t i = 0; i < num_key_frames; ++i)
 							rotations_as_vec[i] = unpack_vector3_32(11, 11, 10, are_clip_rotations_normalized, decomp_context.animated_track_data[i] + sampling_context.key_frame_byte_offsets[i]);
 					}
+					else
+					{
+						ACL_ASSERT(false, "Unrecognized rotation format");
+						for (size_t i = 0; i < num_key_frames; ++i)
+							rotations_as_vec[i] = vector_zero_32();
+					}
 
 					const uint32_t rotation_size = get_packed_rotation_size(rotation_format);
 
@@ -1030,26 +1040,53 @@ namespace acl
 					}
 				}
 
+				out_rotations[1] = rotation1;
+
 				if (static_condition<num_key_frames == 4>::test())
-					interpolated_rotation = SamplingContextType::interpolate_rotation(rotation0, rotation1, rotation2, rotation3, decomp_context.interpolation_alpha);
-				else
-					interpolated_rotation = SamplingContextType::interpolate_rotation(rotation0, rotation1, decomp_context.interpolation_alpha);
+				{
+					out_rotations[2] = rotation2;
+					out_rotations[3] = rotation3;
+				}
 
-				ACL_ASSERT(quat_is_finite(interpolated_rotation), "Rotation is not valid!");
-				ACL_ASSERT(quat_is_normalized(interpolated_rotation), "Rotation is not normalized!");
+				interpolated_rotation = rotation0;
+				is_animated = true;
 			}
 		}
 
+		out_rotations[0] = interpolated_rotation;
+
 		sampling_context.track_index++;
+		return is_animated;
+	}
+
+	template <class SettingsType, class DecompressionContextType, class SamplingContextType>
+	inline Quat_32 ACL_SIMD_CALL decompress_and_interpolate_rotation(const SettingsType& settings, const ClipHeader& header, const DecompressionContextType& decomp_context, SamplingContextType& sampling_context)
+	{
+		Quat_32 rotations[SamplingContextType::k_num_samples_to_interpolate];
+		if (!decompress_rotation_key_frames(settings, header, decomp_context, sampling_context, &rotations[0]))
+			return rotations[0];
+
+		Quat_32 interpolated_rotation;
+		if (static_condition<SamplingContextType::k_num_samples_to_interpolate == 4>::test())
+			interpolated_rotation = SamplingContextType::interpolate_rotation(rotations[0], rotations[1], rotations[2 % SamplingContextType::k_num_samples_to_interpolate], rotations[3 % SamplingContextType::k_num_samples_to_interpolate], decomp_context.interpolation_alpha);
+		else
+			interpolated_rotation = SamplingContextType::interpolate_rotation(rotations[0], rotations[1], decomp_context.interpolation_alpha);
+
+		ACL_ASSERT(quat_is_finite(interpolated_rotation), "Rotation is not valid!");
+		ACL_ASSERT(quat_is_normalized(interpolated_rotation), "Rotation is not normalized!");
 		return interpolated_rotation;
 	}
 
+	// Decompresses the key frames of the next vector track, leaving their interpolation to the caller.
+	// Returns true when the track is animated and out_vectors holds one sample per key frame to interpolate.
+	// Returns false when the track is default or constant, out_vectors[0] then holds the final value.
 	template<class SettingsAdapterType, class DecompressionContextType, class SamplingContextType>
-	inline Vector4_32 ACL_SIMD_CALL decompress_and_interpolate_vector(const SettingsAdapterType& settings, const ClipHeader& header, const DecompressionContextType& decomp_context, SamplingContextType& sampling_context)
+	inline bool decompress_vector_key_frames(const SettingsAdapterType& settings, const ClipHeader& header, const DecompressionContextType& decomp_context, SamplingContextType& sampling_context, Vector4_32* out_vectors)
 	{
 		static_assert(SamplingContextType::k_num_samples_to_interpolate == 2 || SamplingContextType::k_num_samples_to_interpolate == 4, "Unsupported number of samples");
 
 		Vector4_32 interpolated_vector;
+		bool is_animated = false;
 
 		const BitSetIndexRef track_index_bit_ref(decomp_context.bitset_desc, sampling_context.track_index);
 		const bool is_sample_default = bitset_test(decomp_context.default_tracks_bitset, track_index_bit_ref);
@@ -1239,16 +1276,39 @@ namespace acl
 					sampling_context.clip_range_data_offset += k_clip_range_reduction_vector3_range_size;
 				}
 
+				out_vectors[1] = vector1;
+
 				if (static_condition<num_key_frames == 4>::test())
-					interpolated_vector = SamplingContextType::interpolate_vector4(vector0, vector1, vector2, vector3, decomp_context.interpolation_alpha);
-				else
-					interpolated_vector = SamplingContextType::interpolate_vector4(vector0, vector1, decomp_context.interpolation_alpha);
+				{
+					out_vectors[2] = vector2;
+					out_vectors[3] = vector3;
+				}
 
-				ACL_ASSERT(vector_is_finite3(interpolated_vector), "Vector is not valid!");
+				interpolated_vector = vector0;
+				is_animated = true;
 			}
 		}
 
+		out_vectors[0] = interpolated_vector;
+
 		sampling_context.track_index++;
+		return is_animated;
+	}
+
+	template<class SettingsAdapterType, class DecompressionContextType, class SamplingContextType>
+	inline Vector4_32 ACL_SIMD_CALL decompress_and_interpolate_vector(const SettingsAdapterType& settings, const ClipHeader& header, const DecompressionContextType& decomp_context, SamplingContextType& sampling_context)
+	{
+		Vector4_32 vectors[SamplingContextType::k_num_samples_to_interpolate];
+		if (!decompress_vector_key_frames(settings, header, decomp_context, sampling_context, &vectors[0]))
+			return vectors[0];
+
+		Vector4_32 interpolated_vector;
+		if (static_condition<SamplingContextType::k_num_samples_to_interpolate == 4>::test())
+			interpolated_vector = SamplingContextType::interpolate_vector4(vectors[0], vectors[1], vectors[2 % SamplingContextType::k_num_samples_to_interpolate], vectors[3 % SamplingContextType::k_num_samples_to_interpolate], decomp_context.interpolation_alpha);
+		else
+			interpolated_vector = SamplingContextType::interpolate_vector4(vectors[0], vectors[1], decomp_context.interpolation_alpha);
+
+		ACL_ASSERT(vector_is_finite3(interpolated_vector), "Vector is not valid!");
 		return interpolated_vector;
 	}
 }
@@ -102,6 +102,35 @@ namespace acl
 #endif
 		}
 
+		// Assumes the 'vector_data' is in big-endian order and is padded in order to load up to 16 bytes from it
+		inline float unpack_raw_float_unsafe(const uint8_t* vector_data, uint32_t bit_offset)
+		{
+			const uint32_t byte_offset = bit_offset / 8;
+			const uint32_t shift_offset = bit_offset % 8;
+			uint64_t vector_u64 = unaligned_load<uint64_t>(vector_data + byte_offset + 0);
+			vector_u64 = byte_swap(vector_u64);
+			vector_u64 <<= shift_offset;
+			vector_u64 >>= 32;
+
+			const uint32_t x32 = uint32_t(vector_u64);
+			return aligned_load<float>(&x32);
+		}
+
+		// Returns the quantized integer value of a sample, to be normalized by the caller.
+		// Assumes the 'vector_data' is in big-endian order and padded in order to load up to 16 bytes from it
+		inline uint32_t unpack_uXX_unsafe(uint8_t num_bits, const uint8_t* vector_data, uint32_t bit_offset)
+		{
+			ACL_ASSERT(num_bits <= 19, "This function does not support reading more than 19 bits per component");
+
+			const uint32_t bit_shift = 32 - num_bits;
+			const uint32_t mask = (1 << num_bits) - 1;
+
+			const uint32_t byte_offset = bit_offset / 8;
+			uint32_t vector_u32 = unaligned_load<uint32_t>(vector_data + byte_offset);
+			vector_u32 = byte_swap(vector_u32);
+			return (vector_u32 >> (bit_shift - (bit_offset % 8))) & mask;
+		}
+
 		// Assumes the 'vector_data' is in big-endian order and padded in order to load up to 16 bytes from it
 		inline rtm::scalarf ACL_SIMD_CALL unpack_scalarf_uXX_unsafe(uint8_t num_bits, const uint8_t* vector_data, uint32_t bit_offset)
 		{
@@ -0,0 +1,177 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/compiler_utils.h"
+#include "acl/math/math.h"
+#include "acl/math/quat_32.h"
+#include "acl/math/vector4_32.h"
+
+#include <cstdint>
+
+// Wide interpolation kernels used by the uniformly sampled decoder to interpolate eight tracks at a time.
+// Only the interpolation and normalization are wide: samples are still unpacked and range reduced one
+// track at a time since every track has its own bit rate and range data, and only then transposed into
+// SoA form and interpolated in 256 bit lanes.
+// Every operation mirrors the order of the 128 bit quat_lerp/vector_lerp so the results are bit exact.
+//
+// Measured over the whole decompress_pose with acl_decompressor_benchmark, the staging and transposes cost
+// more than the wide interpolation saves, so this is opt-in: define ACL_WIDE_INTERPOLATION with AVX and
+// compare against the 128 bit path on your own clips before enabling it.
+#if defined(ACL_AVX_INTRINSICS) && defined(ACL_WIDE_INTERPOLATION)
+	#define ACL_IMPL_WIDE_INTERPOLATION
+#endif
+
+#if defined(ACL_IMPL_WIDE_INTERPOLATION)
+
+ACL_IMPL_FILE_PRAGMA_PUSH
+
+namespace acl
+{
+	namespace acl_impl
+	{
+		constexpr uint32_t k_wide_interpolation_width = 8;
+
+		struct alignas(32) WideVector4_32
+		{
+			__m256 x;
+			__m256 y;
+			__m256 z;
+			__m256 w;
+		};
+
+		// Transposes 8 AoS values into SoA lanes
+		inline WideVector4_32 wide_load(const Vector4_32* inputs)
+		{
+			__m128 x0 = inputs[0];
+			__m128 y0 = inputs[1];
+			__m128 z0 = inputs[2];
+			__m128 w0 = inputs[3];
+			_MM_TRANSPOSE4_PS(x0, y0, z0, w0);
+
+			__m128 x1 = inputs[4];
+			__m128 y1 = inputs[5];
+			__m128 z1 = inputs[6];
+			__m128 w1 = inputs[7];
+			_MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+
+			WideVector4_32 result;
+			result.x = _mm256_insertf128_ps(_mm256_castps128_ps256(x0), x1, 1);
+			result.y = _mm256_insertf128_ps(_mm256_castps128_ps256(y0), y1, 1);
+			result.z = _mm256_insertf128_ps(_mm256_castps128_ps256(z0), z1, 1);
+			result.w = _mm256_insertf128_ps(_mm256_castps128_ps256(w0), w1, 1);
+			return result;
+		}
+
+		// Transposes SoA lanes back into 8 AoS values
+		inline void wide_store(const WideVector4_32& input, Vector4_32* outputs)
+		{
+			__m128 x0 = _mm256_castps256_ps128(input.x);
+			__m128 y0 = _mm256_castps256_ps128(input.y);
+			__m128 z0 = _mm256_castps256_ps128(input.z);
+			__m128 w0 = _mm256_castps256_ps128(input.w);
+			_MM_TRANSPOSE4_PS(x0, y0, z0, w0);
+			outputs[0] = x0;
+			outputs[1] = y0;
+			outputs[2] = z0;
+			outputs[3] = w0;
+
+			__m128 x1 = _mm256_extractf128_ps(input.x, 1);
+			__m128 y1 = _mm256_extractf128_ps(input.y, 1);
+			__m128 z1 = _mm256_extractf128_ps(input.z, 1);
+			__m128 w1 = _mm256_extractf128_ps(input.w, 1);
+			_MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+			outputs[4] = x1;
+			outputs[5] = y1;
+			outputs[6] = z1;
+			outputs[7] = w1;
+		}
+
+		// Same result as 8x quat_lerp(starts[i], ends[i], alpha)
+		inline void quat_lerp_wide(const Quat_32* starts, const Quat_32* ends, float alpha, Quat_32* outputs)
+		{
+			const WideVector4_32 start = wide_load(starts);
+			const WideVector4_32 end = wide_load(ends);
+
+			// Only the sign of dot(start, end) matters, it is summed like the dpps instruction the 128 bit path uses
+			const __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(start.x, end.x), _mm256_mul_ps(start.y, end.y)), _mm256_add_ps(_mm256_mul_ps(start.z, end.z), _mm256_mul_ps(start.w, end.w)));
+
+			// If the dot product is negative, flip the 'end' rotation XYZW components
+			const __m256 bias = _mm256_and_ps(dot, _mm256_set1_ps(-0.0F));
+			const __m256 alpha_v = _mm256_set1_ps(alpha);
+
+			WideVector4_32 interpolated;
+			interpolated.x = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_xor_ps(end.x, bias), start.x), alpha_v), start.x);
+			interpolated.y = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_xor_ps(end.y, bias), start.y), alpha_v), start.y);
+			interpolated.z = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_xor_ps(end.z, bias), start.z), alpha_v), start.z);
+			interpolated.w = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_xor_ps(end.w, bias), start.w), alpha_v), start.w);
+
+			// Length squared as (x2 + z2) + (y2 + w2) like the 128 bit horizontal sum
+			const __m256 x2z2 = _mm256_add_ps(_mm256_mul_ps(interpolated.x, interpolated.x), _mm256_mul_ps(interpolated.z, interpolated.z));
+			const __m256 y2w2 = _mm256_add_ps(_mm256_mul_ps(interpolated.y, interpolated.y), _mm256_mul_ps(interpolated.w, interpolated.w));
+			const __m256 length_squared = _mm256_add_ps(x2z2, y2w2);
+
+			// Two passes of Newton-Raphson iteration on the hardware reciprocal square root estimate
+			const __m256 half = _mm256_set1_ps(0.5F);
+			const __m256 input_half_v = _mm256_mul_ps(length_squared, half);
+			const __m256 x0 = _mm256_rsqrt_ps(length_squared);
+
+			__m256 x1 = _mm256_mul_ps(x0, x0);
+			x1 = _mm256_sub_ps(half, _mm256_mul_ps(input_half_v, x1));
+			x1 = _mm256_add_ps(_mm256_mul_ps(x0, x1), x0);
+
+			__m256 x2 = _mm256_mul_ps(x1, x1);
+			x2 = _mm256_sub_ps(half, _mm256_mul_ps(input_half_v, x2));
+			x2 = _mm256_add_ps(_mm256_mul_ps(x1, x2), x1);
+
+			interpolated.x = _mm256_mul_ps(interpolated.x, x2);
+			interpolated.y = _mm256_mul_ps(interpolated.y, x2);
+			interpolated.z = _mm256_mul_ps(interpolated.z, x2);
+			interpolated.w = _mm256_mul_ps(interpolated.w, x2);
+
+			wide_store(interpolated, outputs);
+		}
+
+		// Same result as 8x vector_lerp(starts[i], ends[i], alpha), all four components are interpolated
+		inline void vector_lerp_wide(const Vector4_32* starts, const Vector4_32* ends, float alpha, Vector4_32* outputs)
+		{
+			const WideVector4_32 start = wide_load(starts);
+			const WideVector4_32 end = wide_load(ends);
+			const __m256 alpha_v = _mm256_set1_ps(alpha);
+
+			WideVector4_32 interpolated;
+			interpolated.x = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(end.x, start.x), alpha_v), start.x);
+			interpolated.y = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(end.y, start.y), alpha_v), start.y);
+			interpolated.z = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(end.z, start.z), alpha_v), start.z);
+			interpolated.w = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(end.w, start.w), alpha_v), start.w);
+
+			wide_store(interpolated, outputs);
+		}
+	}
+}
+
+ACL_IMPL_FILE_PRAGMA_POP
+
+#endif
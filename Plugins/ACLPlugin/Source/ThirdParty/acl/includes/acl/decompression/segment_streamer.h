@@ -0,0 +1,198 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/compiler_utils.h"
+#include "acl/core/compressed_clip.h"
+#include "acl/core/error.h"
+#include "acl/core/interpolation_utils.h"
+#include "acl/core/ptr_offset.h"
+#include "acl/core/utils.h"
+#include "acl/math/scalar_32.h"
+
+#include <cstdint>
+
+ACL_IMPL_FILE_PRAGMA_PUSH
+
+namespace acl
+{
+	////////////////////////////////////////////////////////////////////////////////
+	// The location of the data owned by a single segment within its compressed clip.
+	////////////////////////////////////////////////////////////////////////////////
+	struct SegmentDataRange
+	{
+		// Offset in bytes from the start of the compressed clip.
+		uint32_t offset;
+
+		// Size in bytes, zero when the segment has no data of its own.
+		uint32_t size;
+	};
+
+	namespace impl
+	{
+		// Returns the offset relative to the clip header where the data of a segment starts, 0xFFFFFFFF if it has none.
+		inline uint32_t get_segment_data_start(const SegmentHeader& segment_header)
+		{
+			if (segment_header.format_per_track_data_offset.is_valid())
+				return segment_header.format_per_track_data_offset;
+
+			if (segment_header.range_data_offset.is_valid())
+				return segment_header.range_data_offset;
+
+			if (segment_header.track_data_offset.is_valid())
+				return segment_header.track_data_offset;
+
+			return 0xFFFFFFFFU;
+		}
+
+		// Returns a pointer within segment data provided by a streamer from an offset relative to the clip header.
+		inline const uint8_t* get_streamed_segment_data(const uint8_t* segment_data, uint32_t segment_data_start, const PtrOffset32<uint8_t>& offset)
+		{
+			return offset.is_valid() ? (segment_data + (uint32_t(offset) - segment_data_start)) : nullptr;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Returns where the data of a segment lives within its compressed clip.
+	//
+	// The data of every segment follows the clip range data, back to back and in order.
+	// Everything before the data of the first segment (headers, segment table, constant and
+	// clip range data) is needed to decompress any sample, segments are only needed for the
+	// samples they contain. The last segment includes the padding at the end of the clip.
+	////////////////////////////////////////////////////////////////////////////////
+	inline SegmentDataRange get_segment_data_range(const CompressedClip& clip, uint32_t segment_index)
+	{
+		const ClipHeader& header = get_clip_header(clip);
+		ACL_ASSERT(segment_index < header.num_segments, "Invalid segment index: %u", segment_index);
+
+		const SegmentHeader* segment_headers = header.get_segment_headers();
+		const uint32_t data_start = impl::get_segment_data_start(segment_headers[segment_index]);
+		if (data_start == 0xFFFFFFFFU)
+			return SegmentDataRange{ 0, 0 };
+
+		uint32_t data_end = clip.get_size() - uint32_t(sizeof(CompressedClip));
+		for (uint32_t next_segment_index = segment_index + 1; next_segment_index < header.num_segments; ++next_segment_index)
+		{
+			const uint32_t next_data_start = impl::get_segment_data_start(segment_headers[next_segment_index]);
+			if (next_data_start != 0xFFFFFFFFU)
+			{
+				data_end = next_data_start;
+				break;
+			}
+		}
+
+		return SegmentDataRange{ data_start + uint32_t(sizeof(CompressedClip)), data_end - data_start };
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Returns the segment that contains the first key frame interpolated at the specified time.
+	// Useful to decide which segments to stream in ahead of playback.
+	////////////////////////////////////////////////////////////////////////////////
+	inline uint32_t get_segment_index_at_time(const CompressedClip& clip, float sample_time)
+	{
+		const ClipHeader& header = get_clip_header(clip);
+		if (header.num_segments == 1)
+			return 0;
+
+		uint32_t key_frame0;
+		uint32_t key_frame1;
+		float interpolation_alpha;
+		sample_time = clamp(sample_time, 0.0F, calculate_duration(header.num_samples, header.sample_rate));
+		find_linear_interpolation_samples_with_sample_rate(header.num_samples, header.sample_rate, sample_time, SampleRoundingPolicy::None, key_frame0, key_frame1, interpolation_alpha);
+
+		// The start indices are terminated by a 0xFFFFFFFF sentinel
+		const uint32_t* segment_start_indices = header.get_segment_start_indices();
+		uint32_t segment_index = 0;
+		while (key_frame0 >= segment_start_indices[segment_index + 1])
+			segment_index++;
+
+		return segment_index;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Provides the segment data of a streamed clip.
+	//
+	// A streamed clip only keeps the data preceding its segments resident, the data of each
+	// segment (see get_segment_data_range) can be paged in and out independently. When a
+	// decompression context is initialized with a streamer, every seek asks it for the segments
+	// it interpolates. If one isn't resident, the context holds the closest sample of the
+	// nearest resident segment instead until it is.
+	//
+	// The resident part of the clip must be followed by at least 15 readable bytes, like segments.
+	// Streaming decisions belong to the implementation: the context never requests anything,
+	// it only queries what is resident.
+	////////////////////////////////////////////////////////////////////////////////
+	class ISegmentStreamer
+	{
+	public:
+		ISegmentStreamer() {}
+		virtual ~ISegmentStreamer() {}
+
+		ISegmentStreamer(const ISegmentStreamer&) = delete;
+		ISegmentStreamer& operator=(const ISegmentStreamer&) = delete;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// Returns the data of a segment or nullptr if it isn't resident.
+		//
+		// The data must match the bytes described by get_segment_data_range and be followed by
+		// at least 15 readable bytes for unaligned loads. It must remain valid until the context
+		// that queried it seeks again or is released. Segments without data can return any non-null pointer.
+		//
+		// At least one segment must be resident at all times.
+		// Called from the thread seeking the context, possibly concurrently for different contexts.
+		virtual const uint8_t* get_segment_data(uint32_t segment_index) = 0;
+	};
+
+	namespace impl
+	{
+		// Finds the resident segment closest to a missing one, earlier segments win ties since playback
+		// usually comes from there. Returns the segment index and its data.
+		inline uint32_t find_nearest_resident_segment(ISegmentStreamer& streamer, uint32_t num_segments, uint32_t segment_index, const uint8_t*& out_segment_data)
+		{
+			for (uint32_t distance = 1; distance < num_segments; ++distance)
+			{
+				if (segment_index >= distance)
+				{
+					out_segment_data = streamer.get_segment_data(segment_index - distance);
+					if (out_segment_data != nullptr)
+						return segment_index - distance;
+				}
+
+				if (segment_index + distance < num_segments)
+				{
+					out_segment_data = streamer.get_segment_data(segment_index + distance);
+					if (out_segment_data != nullptr)
+						return segment_index + distance;
+				}
+			}
+
+			ACL_ASSERT(false, "At least one segment must be resident");
+			out_segment_data = nullptr;
+			return segment_index;
+		}
+	}
+}
+
+ACL_IMPL_FILE_PRAGMA_POP
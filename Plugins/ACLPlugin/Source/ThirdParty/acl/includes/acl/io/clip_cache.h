@@ -0,0 +1,459 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/compression/animation_clip.h"
+#include "acl/compression/compression_settings.h"
+#include "acl/compression/skeleton.h"
+#include "acl/compression/track_array.h"
+#include "acl/core/algorithm_types.h"
+#include "acl/core/compiler_utils.h"
+#include "acl/core/error.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+ACL_IMPL_FILE_PRAGMA_PUSH
+
+//////////////////////////////////////////////////////////////////////////
+// A clip cache is a binary sidecar of an SJSON ACL file (*.acl.sjson -> *.acl.cache).
+// It holds the exact same raw data in native layout so that loading it is a copy of every sample array
+// instead of parsing text. ClipReader detects it from its leading tag and loads it directly.
+// The size and modification time of the SJSON file it was built from are recorded in its header,
+// a cache that no longer matches its source must be rebuilt, see is_clip_cache_up_to_date(..).
+// The layout is not portable and it is meant to be rebuilt locally, never distributed.
+//////////////////////////////////////////////////////////////////////////
+
+namespace acl
+{
+	//////////////////////////////////////////////////////////////////////////
+	// The raw content of a clip cache.
+	enum class clip_cache_type8 : uint8_t
+	{
+		raw_clip = 1,
+		raw_track_list = 2,
+	};
+
+	namespace acl_impl
+	{
+		constexpr uint32_t k_clip_cache_tag = 0xAC1CAC4E;
+		constexpr uint16_t k_clip_cache_version = 1;
+
+		struct clip_cache_header
+		{
+			uint32_t tag;
+			uint16_t version;
+			clip_cache_type8 type;
+			uint8_t padding;
+			uint64_t source_size;
+			uint64_t source_timestamp;
+		};
+
+		static_assert(sizeof(clip_cache_header) == 24, "Unexpected clip cache header size");
+
+		//////////////////////////////////////////////////////////////////////////
+		// Returns the header of a clip cache, or nullptr if the buffer doesn't contain one.
+		inline const clip_cache_header* get_clip_cache_header(const void* buffer, size_t buffer_size)
+		{
+			if (buffer == nullptr || buffer_size < sizeof(clip_cache_header))
+				return nullptr;
+
+			const clip_cache_header* header = static_cast<const clip_cache_header*>(buffer);
+			if (header->tag != k_clip_cache_tag || header->version != k_clip_cache_version)
+				return nullptr;
+
+			return header;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Sequential writer of clip cache values.
+		class clip_cache_writer
+		{
+		public:
+			explicit clip_cache_writer(std::FILE* file) : m_file(file), m_failed(false) {}
+
+			template<typename value_type>
+			void write(const value_type& value) { write_bytes(&value, sizeof(value_type)); }
+
+			void write_bytes(const void* data, size_t size)
+			{
+				if (!m_failed && size != 0)
+					m_failed = std::fwrite(data, 1, size, m_file) != size;
+			}
+
+			void write_string(const String& value)
+			{
+				const uint32_t length = uint32_t(value.size());
+				write(length);
+				write_bytes(value.c_str(), length);
+			}
+
+			bool has_failed() const { return m_failed; }
+
+		private:
+			std::FILE* m_file;
+			bool m_failed;
+		};
+
+		//////////////////////////////////////////////////////////////////////////
+		// Sequential reader of clip cache values with bounds checking, every read past the end fails.
+		class clip_cache_reader
+		{
+		public:
+			clip_cache_reader(const void* buffer, size_t buffer_size)
+				: m_cursor(static_cast<const uint8_t*>(buffer) + sizeof(clip_cache_header))
+				, m_end(static_cast<const uint8_t*>(buffer) + buffer_size)
+				, m_failed(buffer_size < sizeof(clip_cache_header))
+			{
+			}
+
+			template<typename value_type>
+			value_type read()
+			{
+				value_type value;
+				if (!read_bytes(&value, sizeof(value_type)))
+					std::memset(&value, 0, sizeof(value_type));
+				return value;
+			}
+
+			bool read_bytes(void* data, size_t size)
+			{
+				const uint8_t* bytes = read_view(size);
+				if (bytes == nullptr)
+					return false;
+
+				std::memcpy(data, bytes, size);
+				return true;
+			}
+
+			// Returns a pointer to the next bytes in the buffer and skips them, nullptr if they are out of bounds
+			const uint8_t* read_view(size_t size)
+			{
+				if (m_failed || size > size_t(m_end - m_cursor))
+				{
+					m_failed = true;
+					return nullptr;
+				}
+
+				const uint8_t* bytes = m_cursor;
+				m_cursor += size;
+				return bytes;
+			}
+
+			String read_string(IAllocator& allocator)
+			{
+				const uint32_t length = read<uint32_t>();
+				const uint8_t* chars = read_view(length);
+				return chars != nullptr ? String(allocator, reinterpret_cast<const char*>(chars), length) : String();
+			}
+
+			bool has_failed() const { return m_failed; }
+			bool is_at_end() const { return m_cursor == m_end; }
+
+		private:
+			const uint8_t* m_cursor;
+			const uint8_t* m_end;
+			bool m_failed;
+		};
+
+		inline bool is_clip_cache_filename(const char* filename)
+		{
+			const size_t filename_len = filename != nullptr ? std::strlen(filename) : 0;
+			return filename_len >= 10 && std::strncmp(filename + filename_len - 10, ".acl.cache", 10) == 0;
+		}
+
+		inline std::FILE* open_clip_cache_file(const char* cache_filename)
+		{
+			std::FILE* file = nullptr;
+
+#ifdef _WIN32
+			char path[64 * 1024] = { 0 };
+			snprintf(path, get_array_size(path), "\\\\?\\%s", cache_filename);
+			fopen_s(&file, path, "wb");
+#else
+			file = fopen(cache_filename, "wb");
+#endif
+
+			return file;
+		}
+
+		inline void write_clip_cache_header(clip_cache_type8 type, uint64_t source_size, uint64_t source_timestamp, clip_cache_writer& writer)
+		{
+			clip_cache_header header;
+			header.tag = k_clip_cache_tag;
+			header.version = k_clip_cache_version;
+			header.type = type;
+			header.padding = 0;
+			header.source_size = source_size;
+			header.source_timestamp = source_timestamp;
+			writer.write(header);
+		}
+
+		inline void write_clip_cache_settings(AlgorithmType8 algorithm, const CompressionSettings& settings, clip_cache_writer& writer)
+		{
+			writer.write(algorithm);
+			writer.write(settings.level);
+			writer.write(settings.rotation_format);
+			writer.write(settings.translation_format);
+			writer.write(settings.scale_format);
+			writer.write(settings.range_reduction);
+			writer.write(settings.segmenting.enabled);
+			writer.write(settings.segmenting.ideal_num_samples);
+			writer.write(settings.segmenting.max_num_samples);
+			writer.write(settings.segmenting.range_reduction);
+			writer.write(settings.constant_rotation_threshold_angle);
+			writer.write(settings.constant_translation_threshold);
+			writer.write(settings.constant_scale_threshold);
+			writer.write(settings.error_threshold);
+		}
+
+		inline void read_clip_cache_settings(clip_cache_reader& reader, AlgorithmType8& out_algorithm, CompressionSettings& out_settings)
+		{
+			out_algorithm = reader.read<AlgorithmType8>();
+			out_settings.level = reader.read<CompressionLevel8>();
+			out_settings.rotation_format = reader.read<RotationFormat8>();
+			out_settings.translation_format = reader.read<VectorFormat8>();
+			out_settings.scale_format = reader.read<VectorFormat8>();
+			out_settings.range_reduction = reader.read<RangeReductionFlags8>();
+			out_settings.segmenting.enabled = reader.read<bool>();
+			out_settings.segmenting.ideal_num_samples = reader.read<uint16_t>();
+			out_settings.segmenting.max_num_samples = reader.read<uint16_t>();
+			out_settings.segmenting.range_reduction = reader.read<RangeReductionFlags8>();
+			out_settings.constant_rotation_threshold_angle = reader.read<float>();
+			out_settings.constant_translation_threshold = reader.read<float>();
+			out_settings.constant_scale_threshold = reader.read<float>();
+			out_settings.error_threshold = reader.read<float>();
+		}
+
+		inline void write_clip_cache_tracks(const AnimationClip& clip, clip_cache_writer& writer)
+		{
+			const uint16_t num_bones = clip.get_num_bones();
+			const uint32_t num_samples = clip.get_num_samples();
+
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				const AnimatedBone& bone = clip.get_animated_bone(bone_index);
+
+				for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+				{
+					double rotation[4];
+					quat_unaligned_write(bone.rotation_track.get_sample(sample_index), &rotation[0]);
+					writer.write(rotation);
+				}
+
+				for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+				{
+					double translation[3];
+					vector_unaligned_write3(bone.translation_track.get_sample(sample_index), &translation[0]);
+					writer.write(translation);
+				}
+
+				for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+				{
+					double scale[3];
+					vector_unaligned_write3(bone.scale_track.get_sample(sample_index), &scale[0]);
+					writer.write(scale);
+				}
+			}
+		}
+
+		inline bool read_clip_cache_tracks(clip_cache_reader& reader, AnimationClip& clip)
+		{
+			const uint16_t num_bones = clip.get_num_bones();
+			const uint32_t num_samples = clip.get_num_samples();
+
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				AnimatedBone& bone = clip.get_animated_bone(bone_index);
+
+				const uint8_t* rotations = reader.read_view(sizeof(double) * 4 * num_samples);
+				const uint8_t* translations = reader.read_view(sizeof(double) * 3 * num_samples);
+				const uint8_t* scales = reader.read_view(sizeof(double) * 3 * num_samples);
+				if (reader.has_failed())
+					return false;
+
+				// Samples follow variable length strings and are not even aligned to a double, copy them out first
+				for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+				{
+					double rotation[4];
+					std::memcpy(&rotation[0], rotations + (sample_index * sizeof(rotation)), sizeof(rotation));
+					bone.rotation_track.set_sample(sample_index, quat_unaligned_load(&rotation[0]));
+
+					double translation[3];
+					std::memcpy(&translation[0], translations + (sample_index * sizeof(translation)), sizeof(translation));
+					bone.translation_track.set_sample(sample_index, vector_unaligned_load3(&translation[0]));
+
+					double scale[3];
+					std::memcpy(&scale[0], scales + (sample_index * sizeof(scale)), sizeof(scale));
+					bone.scale_track.set_sample(sample_index, vector_unaligned_load3(&scale[0]));
+				}
+			}
+
+			return true;
+		}
+
+		inline const char* write_acl_clip_cache(const RigidSkeleton& skeleton, const AnimationClip& clip, AlgorithmType8 algorithm, const CompressionSettings* settings, uint64_t source_size, uint64_t source_timestamp, const char* cache_filename)
+		{
+			if (cache_filename == nullptr)
+				return "'cache_filename' cannot be NULL!";
+
+			if (!is_clip_cache_filename(cache_filename))
+				return "'cache_filename' file must be an ACL clip cache file of the form: *.acl.cache";
+
+			std::FILE* file = open_clip_cache_file(cache_filename);
+			if (file == nullptr)
+				return "Failed to open ACL clip cache file for writing";
+
+			clip_cache_writer writer(file);
+			write_clip_cache_header(clip_cache_type8::raw_clip, source_size, source_timestamp, writer);
+
+			writer.write_string(clip.get_name());
+			writer.write(clip.get_num_samples());
+			writer.write(clip.get_sample_rate());
+			writer.write(clip.get_additive_format());
+
+			const AnimationClip* base_clip = clip.get_additive_base();
+			writer.write(base_clip != nullptr);
+			if (base_clip != nullptr)
+			{
+				writer.write_string(base_clip->get_name());
+				writer.write(base_clip->get_num_samples());
+				writer.write(base_clip->get_sample_rate());
+			}
+
+			writer.write(settings != nullptr);
+			if (settings != nullptr)
+				write_clip_cache_settings(algorithm, *settings, writer);
+
+			const uint16_t num_bones = skeleton.get_num_bones();
+			writer.write(num_bones);
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				const RigidBone& bone = skeleton.get_bone(bone_index);
+
+				double bind_transform[10];
+				quat_unaligned_write(bone.bind_transform.rotation, &bind_transform[0]);
+				vector_unaligned_write3(bone.bind_transform.translation, &bind_transform[4]);
+				vector_unaligned_write3(bone.bind_transform.scale, &bind_transform[7]);
+
+				writer.write_string(bone.name);
+				writer.write(bone.parent_index);
+				writer.write(bone.vertex_distance);
+				writer.write(bind_transform);
+			}
+
+			if (base_clip != nullptr)
+				write_clip_cache_tracks(*base_clip, writer);
+
+			write_clip_cache_tracks(clip, writer);
+
+			const bool failed = writer.has_failed();
+			std::fclose(file);
+
+			return failed ? "Failed to write ACL clip cache file" : nullptr;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Write out an ACL clip cache file from a skeleton, a clip, and no specific compression settings,
+	// along with the size and modification time of the SJSON file they were read from.
+	// Returns an error string on failure, null on success.
+	//////////////////////////////////////////////////////////////////////////
+	inline const char* write_acl_clip_cache(const RigidSkeleton& skeleton, const AnimationClip& clip, uint64_t source_size, uint64_t source_timestamp, const char* cache_filename)
+	{
+		return acl_impl::write_acl_clip_cache(skeleton, clip, AlgorithmType8::UniformlySampled, nullptr, source_size, source_timestamp, cache_filename);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Write out an ACL clip cache file from a skeleton, a clip, and compression settings,
+	// along with the size and modification time of the SJSON file they were read from.
+	// Returns an error string on failure, null on success.
+	//////////////////////////////////////////////////////////////////////////
+	inline const char* write_acl_clip_cache(const RigidSkeleton& skeleton, const AnimationClip& clip, AlgorithmType8 algorithm, const CompressionSettings& settings, uint64_t source_size, uint64_t source_timestamp, const char* cache_filename)
+	{
+		return acl_impl::write_acl_clip_cache(skeleton, clip, algorithm, &settings, source_size, source_timestamp, cache_filename);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Write out an ACL clip cache file from a track list, along with the size and
+	// modification time of the SJSON file it was read from.
+	// Returns an error string on failure, null on success.
+	//////////////////////////////////////////////////////////////////////////
+	inline const char* write_track_list_cache(const track_array& track_list, uint64_t source_size, uint64_t source_timestamp, const char* cache_filename)
+	{
+		using namespace acl_impl;
+
+		if (cache_filename == nullptr)
+			return "'cache_filename' cannot be NULL!";
+
+		if (!is_clip_cache_filename(cache_filename))
+			return "'cache_filename' file must be an ACL clip cache file of the form: *.acl.cache";
+
+		std::FILE* file = open_clip_cache_file(cache_filename);
+		if (file == nullptr)
+			return "Failed to open ACL clip cache file for writing";
+
+		clip_cache_writer writer(file);
+		write_clip_cache_header(clip_cache_type8::raw_track_list, source_size, source_timestamp, writer);
+
+		const uint32_t num_tracks = track_list.get_num_tracks();
+		writer.write(num_tracks);
+		writer.write(track_list.get_track_type());
+
+		for (const track& track_ : track_list)
+		{
+			const track_desc_scalarf& desc = track_.get_description<track_desc_scalarf>();
+			const uint32_t num_samples = track_.get_num_samples();
+			const uint32_t sample_size = track_.get_sample_size();
+
+			writer.write(desc.output_index);
+			writer.write(desc.precision);
+			writer.write(desc.constant_threshold);
+			writer.write(num_samples);
+			writer.write(track_.get_sample_rate());
+
+			// Samples are written packed even when the track has a custom stride
+			for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+				writer.write_bytes(track_[sample_index], sample_size);
+		}
+
+		const bool failed = writer.has_failed();
+		std::fclose(file);
+
+		return failed ? "Failed to write ACL clip cache file" : nullptr;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Returns whether a buffer holds a clip cache built from an SJSON file with the provided size and modification time.
+	//////////////////////////////////////////////////////////////////////////
+	inline bool is_clip_cache_up_to_date(const void* buffer, size_t buffer_size, uint64_t source_size, uint64_t source_timestamp)
+	{
+		const acl_impl::clip_cache_header* header = acl_impl::get_clip_cache_header(buffer, buffer_size);
+		return header != nullptr && header->source_size == source_size && header->source_timestamp == source_timestamp;
+	}
+}
+
+ACL_IMPL_FILE_PRAGMA_POP
@@ -26,7 +26,9 @@
 
 #if defined(SJSON_CPP_PARSER)
 
+#include "acl/io/clip_cache.h"
 #include "acl/io/clip_reader_error.h"
+#include "acl/io/impl/hex_parsing.h"
 #include "acl/compression/animation_clip.h"
 #include "acl/compression/compression_settings.h"
 #include "acl/compression/track_array.h"
@@ -73,12 +75,17 @@ namespace acl
 
 	//////////////////////////////////////////////////////////////////////////
 	// An SJSON ACL file reader.
+	// The input can also be an ACL clip cache (see clip_cache.h), it is detected from its header and loaded directly.
 	class ClipReader
 	{
 	public:
 		ClipReader(IAllocator& allocator, const char* sjson_input, size_t input_length)
 			: m_allocator(allocator)
 			, m_parser(sjson_input, input_length)
+			, m_input(sjson_input)
+			, m_input_length(input_length)
+			, m_cache(acl_impl::get_clip_cache_header(sjson_input, input_length))
+			, m_cache_size(input_length)
 			, m_error()
 			, m_version(0)
 			, m_num_samples(0)
@@ -115,6 +122,16 @@ namespace acl
 		{
 			reset_state();
 
+			if (m_cache != nullptr)
+			{
+				switch (m_cache->type)
+				{
+				case clip_cache_type8::raw_clip:		return sjson_file_type::raw_clip;
+				case clip_cache_type8::raw_track_list:	return sjson_file_type::raw_track_list;
+				default:								return sjson_file_type::unknown;
+				}
+			}
+
 			if (!read_version())
 				return sjson_file_type::unknown;
 
@@ -131,6 +148,9 @@ namespace acl
 		{
 			reset_state();
 
+			if (m_cache != nullptr)
+				return read_cached_raw_clip(out_data);
+
 			if (!read_version())
 				return false;
 
@@ -156,6 +176,9 @@ namespace acl
 		{
 			reset_state();
 
+			if (m_cache != nullptr)
+				return read_cached_raw_track_list(out_data);
+
 			if (!read_version())
 				return false;
 
@@ -179,6 +202,10 @@ namespace acl
 	private:
 		IAllocator& m_allocator;
 		sjson::Parser m_parser;
+		const char* m_input;
+		size_t m_input_length;
+		const acl_impl::clip_cache_header* m_cache;
+		size_t m_cache_size;
 		ClipReaderError m_error;
 
 		uint32_t m_version;
@@ -490,7 +517,7 @@ namespace acl
 			return process_each_bone(nullptr, num_bones);
 		}
 
-		static double hex_to_double(const sjson::StringView& value)
+		static double bits_to_double(uint64_t value_u64)
 		{
 			union UInt64ToDouble
 			{
@@ -500,12 +527,10 @@ namespace acl
 				constexpr explicit UInt64ToDouble(uint64_t u64_value) : u64(u64_value) {}
 			};
 
-			ACL_ASSERT(value.size() <= 16, "Invalid binary exact double value");
-			uint64_t value_u64 = acl_impl::strtoull(value.c_str(), nullptr, 16);
 			return UInt64ToDouble(value_u64).dbl;
 		}
 
-		static float hex_to_float(const sjson::StringView& value)
+		static float bits_to_float(uint64_t value_u64)
 		{
 			union UInt32ToFloat
 			{
@@ -515,9 +540,13 @@ namespace acl
 				constexpr explicit UInt32ToFloat(uint32_t u32_value) : u32(u32_value) {}
 			};
 
-			ACL_ASSERT(value.size() <= 8, "Invalid binary exact float value");
-			uint32_t value_u32 = safe_static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 16));
-			return UInt32ToFloat(value_u32).flt;
+			return UInt32ToFloat(safe_static_cast<uint32_t>(value_u64)).flt;
+		}
+
+		static double hex_to_double(const sjson::StringView& value)
+		{
+			ACL_ASSERT(value.size() <= 16, "Invalid binary exact double value");
+			return bits_to_double(acl_impl::hex_to_uint64(value.c_str(), value.size()));
 		}
 
 		static Quat_64 hex_to_quat(const sjson::StringView values[4])
@@ -530,7 +559,7 @@ namespace acl
 			return vector_set(hex_to_double(values[0]), hex_to_double(values[1]), hex_to_double(values[2]));
 		}
 
-		static rtm::float4f hex_to_float4f(const sjson::StringView values[4], uint32_t num_components)
+		static rtm::float4f bits_to_float4f(const uint64_t values[4], uint32_t num_components)
 		{
 			ACL_ASSERT(num_components <= 4, "Invalid number of components");
 
@@ -538,11 +567,42 @@ namespace acl
 			float* result_ptr = &result.x;
 
 			for (uint32_t component_index = 0; component_index < num_components; ++component_index)
-				result_ptr[component_index] = hex_to_float(values[component_index]);
+				result_ptr[component_index] = bits_to_float(values[component_index]);
 
 			return result;
 		}
 
+		// Reads the binary exact values of a sample. The values are parsed straight from the input when they
+		// have the form clip_writer writes, the SJSON parser is only used for anything else.
+		bool read_hex_values(uint64_t* values, uint32_t num_values)
+		{
+			ACL_ASSERT(num_values <= 4, "Invalid number of values");
+
+			sjson::ParserState state = m_parser.save_state();
+			const size_t num_consumed = acl_impl::parse_hex_run(m_input + state.offset, m_input_length - state.offset, num_values, values);
+			if (num_consumed != 0)
+			{
+				// A run never spans lines, only the column moves
+				state.offset += num_consumed;
+				state.column += safe_static_cast<uint32_t>(num_consumed);
+				state.symbol = m_input[state.offset];
+				m_parser.restore_state(state);
+				return true;
+			}
+
+			sjson::StringView strings[4];
+			if (!m_parser.read(strings, num_values))
+				return false;
+
+			for (uint32_t value_index = 0; value_index < num_values; ++value_index)
+			{
+				ACL_ASSERT(strings[value_index].size() <= 16, "Invalid binary exact value");
+				values[value_index] = acl_impl::hex_to_uint64(strings[value_index].c_str(), strings[value_index].size());
+			}
+
+			return true;
+		}
+
 		bool process_each_bone(RigidBone* bones, uint16_t& num_bones)
 		{
 			bool counting = bones == nullptr;
@@ -756,8 +816,8 @@ namespace acl
 
 					if (m_is_binary_exact)
 					{
-						sjson::StringView values[4];
-						if (m_parser.read(values, num_components))
+						uint64_t values[4];
+						if (read_hex_values(values, num_components))
 						{
 							switch (track_type)
 							{
@@ -767,7 +827,7 @@ namespace acl
 							case track_type8::float4f:
 							case track_type8::vector4f:
 							{
-								const rtm::float4f value = hex_to_float4f(values, num_components);
+								const rtm::float4f value = bits_to_float4f(values, num_components);
 								std::memcpy(track_samples_typed.float1f + (sample_index * num_components), &value, sizeof(float) * num_components);
 								break;
 							}
@@ -1051,11 +1111,11 @@ namespace acl
 
 				if (m_is_binary_exact)
 				{
-					sjson::StringView values[4];
-					if (!m_parser.read(values, 4))
+					uint64_t values[4];
+					if (!read_hex_values(values, 4))
 						return false;
 
-					rotation = hex_to_quat(values);
+					rotation = quat_set(bits_to_double(values[0]), bits_to_double(values[1]), bits_to_double(values[2]), bits_to_double(values[3]));
 				}
 				else
 				{
@@ -1086,11 +1146,11 @@ namespace acl
 
 				if (m_is_binary_exact)
 				{
-					sjson::StringView values[3];
-					if (!m_parser.read(values, 3))
+					uint64_t values[3];
+					if (!read_hex_values(values, 3))
 						return false;
 
-					translation = hex_to_vector3(values);
+					translation = vector_set(bits_to_double(values[0]), bits_to_double(values[1]), bits_to_double(values[2]));
 				}
 				else
 				{
@@ -1121,11 +1181,11 @@ namespace acl
 
 				if (m_is_binary_exact)
 				{
-					sjson::StringView values[3];
-					if (!m_parser.read(values, 3))
+					uint64_t values[3];
+					if (!read_hex_values(values, 3))
 						return false;
 
-					scale = hex_to_vector3(values);
+					scale = vector_set(bits_to_double(values[0]), bits_to_double(values[1]), bits_to_double(values[2]));
 				}
 				else
 				{
@@ -1145,6 +1205,165 @@ namespace acl
 			return true;
 		}
 
+		bool read_cached_raw_clip(sjson_raw_clip& out_data)
+		{
+			if (m_cache->type != clip_cache_type8::raw_clip)
+				return set_cache_error();
+
+			acl_impl::clip_cache_reader reader(m_cache, m_cache_size);
+
+			const String clip_name = reader.read_string(m_allocator);
+			const uint32_t num_samples = reader.read<uint32_t>();
+			const float sample_rate = reader.read<float>();
+			const AdditiveClipFormat8 additive_format = reader.read<AdditiveClipFormat8>();
+
+			const bool has_base_clip = reader.read<bool>();
+			String base_clip_name;
+			uint32_t base_clip_num_samples = 0;
+			float base_clip_sample_rate = 0.0F;
+			if (has_base_clip)
+			{
+				base_clip_name = reader.read_string(m_allocator);
+				base_clip_num_samples = reader.read<uint32_t>();
+				base_clip_sample_rate = reader.read<float>();
+			}
+
+			out_data.has_settings = reader.read<bool>();
+			out_data.algorithm_type = AlgorithmType8::UniformlySampled;
+			if (out_data.has_settings)
+				acl_impl::read_clip_cache_settings(reader, out_data.algorithm_type, out_data.settings);
+
+			const uint16_t num_bones = reader.read<uint16_t>();
+			if (reader.has_failed())
+				return set_cache_error();
+
+			RigidBone* bones = allocate_type_array<RigidBone>(m_allocator, num_bones);
+			for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+			{
+				RigidBone& bone = bones[bone_index];
+				bone.name = reader.read_string(m_allocator);
+				bone.parent_index = reader.read<uint16_t>();
+				bone.vertex_distance = reader.read<float>();
+
+				double bind_transform[10];
+				if (!reader.read_bytes(&bind_transform[0], sizeof(bind_transform)))
+					break;
+
+				bone.bind_transform = transform_set(quat_unaligned_load(&bind_transform[0]), vector_unaligned_load3(&bind_transform[4]), vector_unaligned_load3(&bind_transform[7]));
+
+				// Parents always come before their children
+				if (bone.parent_index != k_invalid_bone_index && bone.parent_index >= bone_index)
+				{
+					deallocate_type_array(m_allocator, bones, num_bones);
+					set_error(ClipReaderError::NoParentBoneWithThatName);
+					return false;
+				}
+			}
+
+			if (reader.has_failed())
+			{
+				deallocate_type_array(m_allocator, bones, num_bones);
+				return set_cache_error();
+			}
+
+			out_data.skeleton = make_unique<RigidSkeleton>(m_allocator, m_allocator, bones, num_bones);
+			deallocate_type_array(m_allocator, bones, num_bones);
+
+			std::unique_ptr<AnimationClip, Deleter<AnimationClip>> base_clip;
+			if (has_base_clip)
+			{
+				base_clip = make_unique<AnimationClip>(m_allocator, m_allocator, *out_data.skeleton, base_clip_num_samples, base_clip_sample_rate, base_clip_name);
+				if (!acl_impl::read_clip_cache_tracks(reader, *base_clip))
+					return set_cache_error();
+			}
+
+			out_data.clip = make_unique<AnimationClip>(m_allocator, m_allocator, *out_data.skeleton, num_samples, sample_rate, clip_name);
+			if (!acl_impl::read_clip_cache_tracks(reader, *out_data.clip))
+				return set_cache_error();
+
+			out_data.clip->set_additive_base(base_clip.release(), additive_format);
+
+			if (!reader.is_at_end())
+				return set_cache_error();
+
+			return true;
+		}
+
+		template<class track_type>
+		bool read_cached_track(acl_impl::clip_cache_reader& reader, const track_desc_scalarf& desc, uint32_t num_samples, float sample_rate, track& out_track)
+		{
+			using sample_type = typename track_type::sample_type;
+
+			const uint8_t* samples = reader.read_view(sizeof(sample_type) * num_samples);
+			if (samples == nullptr)
+				return false;
+
+			// The buffer might not be aligned, copy the samples into memory the track will own
+			sample_type* track_samples = allocate_type_array<sample_type>(m_allocator, num_samples);
+			std::memcpy(track_samples, samples, sizeof(sample_type) * num_samples);
+			out_track = track_type::make_owner(desc, m_allocator, track_samples, num_samples, sample_rate);
+			return true;
+		}
+
+		bool read_cached_raw_track_list(sjson_raw_track_list& out_data)
+		{
+			if (m_cache->type != clip_cache_type8::raw_track_list)
+				return set_cache_error();
+
+			acl_impl::clip_cache_reader reader(m_cache, m_cache_size);
+
+			const uint32_t num_tracks = reader.read<uint32_t>();
+			const track_type8 track_type = reader.read<track_type8>();
+			if (reader.has_failed())
+				return set_cache_error();
+
+			out_data.track_list = track_array(m_allocator, num_tracks);
+
+			for (uint32_t track_index = 0; track_index < num_tracks; ++track_index)
+			{
+				track_desc_scalarf desc;
+				desc.output_index = reader.read<uint32_t>();
+				desc.precision = reader.read<float>();
+				desc.constant_threshold = reader.read<float>();
+
+				const uint32_t num_samples = reader.read<uint32_t>();
+				const float sample_rate = reader.read<float>();
+				if (reader.has_failed())
+					return set_cache_error();
+
+				track& track_ = out_data.track_list[track_index];
+
+				bool success;
+				switch (track_type)
+				{
+				case track_type8::float1f:	success = read_cached_track<track_float1f>(reader, desc, num_samples, sample_rate, track_); break;
+				case track_type8::float2f:	success = read_cached_track<track_float2f>(reader, desc, num_samples, sample_rate, track_); break;
+				case track_type8::float3f:	success = read_cached_track<track_float3f>(reader, desc, num_samples, sample_rate, track_); break;
+				case track_type8::float4f:	success = read_cached_track<track_float4f>(reader, desc, num_samples, sample_rate, track_); break;
+				case track_type8::vector4f:	success = read_cached_track<track_vector4f>(reader, desc, num_samples, sample_rate, track_); break;
+				default:
+					set_error(ClipReaderError::InvalidTrackType);
+					return false;
+				}
+
+				if (!success)
+					return set_cache_error();
+			}
+
+			if (!reader.is_at_end())
+				return set_cache_error();
+
+			return true;
+		}
+
+		bool set_cache_error()
+		{
+			m_error.line = 0;
+			m_error.column = 0;
+			m_error.error = ClipReaderError::InvalidClipCache;
+			return false;
+		}
+
 		bool nothing_follows()
 		{
 			if (!m_parser.remainder_is_comments_and_whitespace())
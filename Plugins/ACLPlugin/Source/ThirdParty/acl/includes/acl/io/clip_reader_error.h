@@ -46,6 +46,7 @@ namespace acl
 			InvalidAdditiveClipFormat,
 			PositiveValueExpected,
 			InvalidTrackType,
+			InvalidClipCache,
 		};
 
 		ClipReaderError()
@@ -79,6 +80,8 @@ namespace acl
 				return "A positive value is expected here";
 			case InvalidTrackType:
 				return "Invalid raw track type";
+			case InvalidClipCache:
+				return "The clip cache is truncated or corrupted";
 			default:
 				return sjson::ParserError::get_description();
 			}
@@ -0,0 +1,133 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "acl/core/compiler_utils.h"
+#include "acl/core/bit_manip_utils.h"
+#include "acl/core/error.h"
+#include "acl/core/memory_utils.h"
+#include "acl/math/math.h"
+
+#include <cstdint>
+#include <cstring>
+
+ACL_IMPL_FILE_PRAGMA_PUSH
+
+namespace acl
+{
+	namespace acl_impl
+	{
+		//////////////////////////////////////////////////////////////////////////
+		// Converts the hexadecimal digits of a binary exact value, as written by format_hex_double(..)
+		// and format_hex_float(..), into its bits. Up to 16 digits without leading zeros are supported.
+		inline uint64_t hex_to_uint64(const char* digits, size_t num_digits)
+		{
+			ACL_ASSERT(num_digits <= 16, "Invalid number of hexadecimal digits: %u", uint32_t(num_digits));
+
+			uint64_t value = 0;
+			for (size_t digit_index = 0; digit_index < num_digits; ++digit_index)
+			{
+				const uint8_t digit = uint8_t(digits[digit_index]);
+				value = (value << 4) | ((digit & 0x0F) + ((digit >> 6) & 0x01) * 9);
+			}
+
+			return value;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Parses a run of comma separated, quoted hexadecimal values as written by clip_writer, e.g. ` "3FF0000000000000", "0"`,
+		// and stops after the closing quote of the last value. Spaces and tabs may separate the values but the run must fit on a line.
+		// With SSE2, each value is located and decoded 16 characters at a time instead of character by character.
+		// Returns the number of characters consumed, or 0 if the input has any other form (or is too close to its end to be
+		// read 16 characters at a time): the caller then falls back to the SJSON parser and hex_to_uint64(..).
+		inline size_t parse_hex_run(const char* input, size_t input_length, uint32_t num_values, uint64_t* out_values)
+		{
+#if defined(ACL_SSE2_INTRINSICS)
+			const __m128i quotes = _mm_set1_epi8('"');
+			const __m128i low_nibble_mask = _mm_set1_epi8(0x0F);
+			const __m128i one = _mm_set1_epi8(0x01);
+			const __m128i byte_mask = _mm_set1_epi16(0x00FF);
+
+			size_t offset = 0;
+			for (uint32_t value_index = 0; value_index < num_values; ++value_index)
+			{
+				while (offset < input_length && (input[offset] == ' ' || input[offset] == '\t'))
+					offset++;
+
+				if (value_index != 0)
+				{
+					if (offset >= input_length || input[offset] != ',')
+						return 0;
+
+					offset++;
+					while (offset < input_length && (input[offset] == ' ' || input[offset] == '\t'))
+						offset++;
+				}
+
+				// The opening quote, 16 digits and the closing quote must all be readable
+				if (input_length - offset < 18 || input[offset] != '"')
+					return 0;
+
+				const char* digits = input + offset + 1;
+				const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits));
+
+				// A closing quote in the 17th character, or none at all, reads as 16 digits and is validated below
+				const uint32_t quote_mask = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, quotes))) | 0x10000;
+				const uint32_t num_digits = count_set_bits((quote_mask - 1) & ~quote_mask);
+				if (num_digits == 0 || digits[num_digits] != '"')
+					return 0;
+
+				// '0'-'9' are 0x30-0x39, 'A'-'F' are 0x41-0x46 and 'a'-'f' are 0x61-0x66
+				// The low nibble is the digit value, letters have bit 6 set and need 9 more
+				const __m128i low_nibbles = _mm_and_si128(chars, low_nibble_mask);
+				const __m128i is_letter = _mm_and_si128(_mm_srli_epi16(chars, 6), one);
+				const __m128i nibbles = _mm_add_epi8(low_nibbles, _mm_add_epi8(_mm_slli_epi16(is_letter, 3), is_letter));
+
+				// Merge each pair of nibbles into a byte, the first digits end up in the first byte
+				const __m128i pairs = _mm_or_si128(_mm_slli_epi16(nibbles, 4), _mm_srli_epi16(nibbles, 8));
+				const __m128i bytes = _mm_packus_epi16(_mm_and_si128(pairs, byte_mask), _mm_setzero_si128());
+
+				uint64_t left_aligned_value;
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(&left_aligned_value), bytes);
+
+				// The characters that follow the closing quote decode into the low nibbles, shift them out
+				out_values[value_index] = byte_swap(left_aligned_value) >> ((16 - num_digits) * 4);
+
+				offset += num_digits + 2;
+			}
+
+			return offset;
+#else
+			(void)input;
+			(void)input_length;
+			(void)num_values;
+			(void)out_values;
+			return 0;
+#endif
+		}
+	}
+}
+
+ACL_IMPL_FILE_PRAGMA_POP
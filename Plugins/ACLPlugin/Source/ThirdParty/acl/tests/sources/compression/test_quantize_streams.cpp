@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <catch.hpp>
+
+#include <acl/algorithm/uniformly_sampled/encoder.h>
+#include <acl/compression/animation_clip.h>
+#include <acl/compression/skeleton.h>
+#include <acl/compression/skeleton_error_metric.h>
+#include <acl/core/ansi_allocator.h>
+#include <acl/core/itask_scheduler.h>
+
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace acl;
+
+namespace
+{
+	constexpr uint16_t k_num_bones = 12;
+	constexpr uint32_t k_num_samples = 150;		// Around ten segments with the default settings
+	constexpr float k_sample_rate = 30.0F;
+
+	// Runs every job on its own thread
+	class ThreadTaskScheduler final : public ITaskScheduler
+	{
+	public:
+		explicit ThreadTaskScheduler(uint32_t max_concurrency) : m_max_concurrency(max_concurrency), m_num_jobs_run(0) {}
+
+		virtual uint32_t get_max_concurrency() const override { return m_max_concurrency; }
+
+		virtual void run_jobs(uint32_t num_jobs, job_function function, void* user_data) override
+		{
+			REQUIRE(num_jobs <= m_max_concurrency);
+
+			std::vector<std::thread> threads;
+			for (uint32_t job_index = 0; job_index < num_jobs; ++job_index)
+				threads.emplace_back(function, user_data, job_index);
+
+			for (std::thread& thread : threads)
+				thread.join();
+
+			m_num_jobs_run += num_jobs;
+		}
+
+		uint32_t get_num_jobs_run() const { return m_num_jobs_run; }
+
+	private:
+		uint32_t m_max_concurrency;
+		uint32_t m_num_jobs_run;
+	};
+
+	CompressedClip* compress(IAllocator& allocator, const AnimationClip& clip, ITaskScheduler* task_scheduler)
+	{
+		TransformErrorMetric error_metric;
+		CompressionSettings settings = get_default_compression_settings();
+		settings.error_metric = &error_metric;
+		settings.task_scheduler = task_scheduler;
+
+		CompressedClip* compressed_clip = nullptr;
+		OutputStats stats;
+		const ErrorResult result = uniformly_sampled::compress_clip(allocator, clip, settings, compressed_clip, stats);
+		REQUIRE(result.empty());
+		REQUIRE(compressed_clip != nullptr);
+		return compressed_clip;
+	}
+
+	bool are_bitwise_equal(const CompressedClip& lhs, const CompressedClip& rhs)
+	{
+		return lhs.get_size() == rhs.get_size() && std::memcmp(&lhs, &rhs, lhs.get_size()) == 0;
+	}
+}
+
+TEST_CASE("parallel segment quantization matches the serial output", "[compression][uniformly_sampled]")
+{
+	ANSIAllocator allocator;
+
+	RigidBone bones[k_num_bones];
+	for (uint16_t bone_index = 0; bone_index < k_num_bones; ++bone_index)
+	{
+		bones[bone_index].vertex_distance = 3.0F;
+		bones[bone_index].parent_index = bone_index == 0 ? k_invalid_bone_index : uint16_t((bone_index - 1) / 2);
+	}
+
+	RigidSkeleton skeleton(allocator, bones, k_num_bones);
+	AnimationClip clip(allocator, skeleton, k_num_samples, k_sample_rate, String(allocator, "parallel quantization"));
+
+	for (uint16_t bone_index = 0; bone_index < k_num_bones; ++bone_index)
+	{
+		AnimatedBone& bone = clip.get_animated_bone(bone_index);
+		const double speed = 0.3 + bone_index * 0.45;
+
+		for (uint32_t sample_index = 0; sample_index < k_num_samples; ++sample_index)
+		{
+			const double phase = sample_index * speed / k_sample_rate;
+			const Vector4_64 axis = vector_normalize3(vector_set(1.0, std::sin(phase), 0.25 * bone_index));
+			bone.rotation_track.set_sample(sample_index, quat_from_axis_angle(axis, std::sin(phase) * 2.0));
+			bone.translation_track.set_sample(sample_index, vector_set(std::cos(phase) * 15.0, bone_index * 3.0, std::sin(phase * 2.1) * 5.0));
+
+			const double scale = bone_index % 4 == 0 ? (1.0 + std::sin(phase) * 0.1) : 1.0;
+			bone.scale_track.set_sample(sample_index, vector_set(scale));
+		}
+	}
+
+	CompressedClip* serial_clip = compress(allocator, clip, nullptr);
+	REQUIRE(get_clip_header(*serial_clip).num_segments > 4);
+
+	for (uint32_t max_concurrency = 1; max_concurrency <= 4; ++max_concurrency)
+	{
+		INFO("Max concurrency: " << max_concurrency);
+
+		ThreadTaskScheduler task_scheduler(max_concurrency);
+		CompressedClip* parallel_clip = compress(allocator, clip, &task_scheduler);
+
+		// A single job is never dispatched
+		CHECK((task_scheduler.get_num_jobs_run() == 0) == (max_concurrency == 1));
+		CHECK(are_bitwise_equal(*serial_clip, *parallel_clip));
+
+		allocator.deallocate(parallel_clip, parallel_clip->get_size());
+	}
+
+	allocator.deallocate(serial_clip, serial_clip->get_size());
+}
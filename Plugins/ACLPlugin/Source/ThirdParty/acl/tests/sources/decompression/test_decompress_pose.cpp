@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <catch.hpp>
+
+#include <acl/algorithm/uniformly_sampled/decoder.h>
+#include <acl/algorithm/uniformly_sampled/encoder.h>
+#include <acl/compression/animation_clip.h>
+#include <acl/compression/skeleton.h>
+#include <acl/compression/skeleton_error_metric.h>
+#include <acl/core/ansi_allocator.h>
+#include <acl/decompression/default_output_writer.h>
+#include <acl/decompression/output_writer.h>
+
+#include <cmath>
+#include <cstring>
+
+using namespace acl;
+
+namespace
+{
+	constexpr uint16_t k_num_bones = 21;		// Not a multiple of the wide block size
+	constexpr uint32_t k_num_samples = 91;		// Enough for several segments
+	constexpr float k_sample_rate = 30.0F;
+
+	// Bone 0 is left at identity (default tracks), bone 1 is constant and the others are animated
+	// at various speeds, every third one with scale.
+	void fill_clip(AnimationClip& clip)
+	{
+		for (uint16_t bone_index = 0; bone_index < k_num_bones; ++bone_index)
+		{
+			AnimatedBone& bone = clip.get_animated_bone(bone_index);
+			const double speed = bone_index <= 1 ? 0.0 : (0.5 + bone_index * 0.37);
+
+			for (uint32_t sample_index = 0; sample_index < k_num_samples; ++sample_index)
+			{
+				const double phase = sample_index * speed / k_sample_rate;
+				if (bone_index == 0)
+				{
+					bone.rotation_track.set_sample(sample_index, quat_identity_64());
+					bone.translation_track.set_sample(sample_index, vector_zero_64());
+					bone.scale_track.set_sample(sample_index, vector_set(1.0));
+					continue;
+				}
+
+				const Vector4_64 axis = vector_normalize3(vector_set(1.0 + bone_index, std::sin(phase), 0.5 * bone_index));
+				const double angle = bone_index == 1 ? 0.75 : (std::sin(phase) * 2.5 + bone_index * 0.1);
+				bone.rotation_track.set_sample(sample_index, quat_from_axis_angle(axis, angle));
+				bone.translation_track.set_sample(sample_index, vector_set(std::cos(phase) * 10.0 + bone_index, std::sin(phase * 1.3) * 4.0, bone_index * 2.0 - phase));
+
+				const double scale = bone_index % 3 == 0 ? (1.0 + std::sin(phase * 0.7) * 0.25) : 1.0;
+				bone.scale_track.set_sample(sample_index, vector_set(scale, scale, bone_index == 1 ? 2.0 : scale));
+			}
+		}
+	}
+
+	CompressedClip* make_compressed_clip(IAllocator& allocator)
+	{
+		RigidBone bones[k_num_bones];
+		for (uint16_t bone_index = 0; bone_index < k_num_bones; ++bone_index)
+		{
+			bones[bone_index].vertex_distance = 3.0F;
+			bones[bone_index].parent_index = bone_index == 0 ? k_invalid_bone_index : uint16_t(bone_index - 1);
+		}
+
+		RigidSkeleton skeleton(allocator, bones, k_num_bones);
+		AnimationClip clip(allocator, skeleton, k_num_samples, k_sample_rate, String(allocator, "wide decoding"));
+		fill_clip(clip);
+
+		TransformErrorMetric error_metric;
+		CompressionSettings settings = get_default_compression_settings();
+		settings.error_metric = &error_metric;
+
+		CompressedClip* compressed_clip = nullptr;
+		OutputStats stats;
+		const ErrorResult result = uniformly_sampled::compress_clip(allocator, clip, settings, compressed_clip, stats);
+		REQUIRE(result.empty());
+		REQUIRE(compressed_clip != nullptr);
+		return compressed_clip;
+	}
+
+	// Quat_32 and Vector4_32 can be the same SIMD type, compare them as raw bits
+	template<typename Type>
+	bool are_bitwise_equal(const Type& lhs, const Type& rhs) { return std::memcmp(&lhs, &rhs, sizeof(Type)) == 0; }
+
+	// Skips every other translation and every third bone entirely
+	struct SparseOutputWriter final : public OutputWriter
+	{
+		explicit SparseOutputWriter(Transform_32* transforms_) : transforms(transforms_) {}
+
+		bool skip_bone_rotation(uint16_t bone_index) const { return bone_index % 3 == 2; }
+		bool skip_bone_translation(uint16_t bone_index) const { return bone_index % 3 == 2 || bone_index % 2 == 1; }
+		bool skip_bone_scale(uint16_t bone_index) const { return bone_index % 3 == 2; }
+
+		void write_bone_rotation(uint16_t bone_index, const Quat_32& rotation) { transforms[bone_index].rotation = rotation; }
+		void write_bone_translation(uint16_t bone_index, const Vector4_32& translation) { transforms[bone_index].translation = translation; }
+		void write_bone_scale(uint16_t bone_index, const Vector4_32& scale) { transforms[bone_index].scale = scale; }
+
+		Transform_32* transforms;
+	};
+}
+
+TEST_CASE("decompress_pose matches decompress_bone bit for bit", "[decompression][uniformly_sampled]")
+{
+	// decompress_pose interpolates blocks of bones at once when wide SIMD is available while
+	// decompress_bone always interpolates a single bone, both must produce identical bits.
+	ANSIAllocator allocator;
+	CompressedClip* compressed_clip = make_compressed_clip(allocator);
+
+	uniformly_sampled::DecompressionContext<uniformly_sampled::DefaultDecompressionSettings> context;
+	context.initialize(*compressed_clip);
+
+	Transform_32 pose[k_num_bones];
+	Transform_32 sparse_pose[k_num_bones];
+	const Transform_32 untouched = transform_set(quat_set(2.0F, 2.0F, 2.0F, 2.0F), vector_set(3.0F), vector_set(4.0F));
+
+	const float duration = float(k_num_samples - 1) / k_sample_rate;
+	for (uint32_t step = 0; step <= 200; ++step)
+	{
+		const float sample_time = std::fmin(duration, step * (duration / 197.0F));	// Lands between and on key frames, and on the end
+		context.seek(sample_time, SampleRoundingPolicy::None);
+
+		DefaultOutputWriter pose_writer(&pose[0], k_num_bones);
+		context.decompress_pose(pose_writer);
+
+		for (uint16_t bone_index = 0; bone_index < k_num_bones; ++bone_index)
+			sparse_pose[bone_index] = untouched;
+
+		SparseOutputWriter sparse_writer(&sparse_pose[0]);
+		context.decompress_pose(sparse_writer);
+
+		for (uint16_t bone_index = 0; bone_index < k_num_bones; ++bone_index)
+		{
+			Quat_32 rotation;
+			Vector4_32 translation;
+			Vector4_32 scale;
+			context.decompress_bone(bone_index, &rotation, &translation, &scale);
+
+			INFO("time " << sample_time << " bone " << bone_index);
+			CHECK(are_bitwise_equal(pose[bone_index].rotation, rotation));
+			CHECK(are_bitwise_equal(pose[bone_index].translation, translation));
+			CHECK(are_bitwise_equal(pose[bone_index].scale, scale));
+
+			CHECK(are_bitwise_equal(sparse_pose[bone_index].rotation, sparse_writer.skip_bone_rotation(bone_index) ? untouched.rotation : rotation));
+			CHECK(are_bitwise_equal(sparse_pose[bone_index].translation, sparse_writer.skip_bone_translation(bone_index) ? untouched.translation : translation));
+			CHECK(are_bitwise_equal(sparse_pose[bone_index].scale, sparse_writer.skip_bone_scale(bone_index) ? untouched.scale : scale));
+		}
+	}
+
+	allocator.deallocate(compressed_clip, compressed_clip->get_size());
+}
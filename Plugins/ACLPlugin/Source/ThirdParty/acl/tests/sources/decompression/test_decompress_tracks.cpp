@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <catch.hpp>
+
+#include <acl/compression/compress.h>
+#include <acl/compression/track.h>
+#include <acl/compression/track_array.h>
+#include <acl/core/ansi_allocator.h>
+#include <acl/decompression/decompress.h>
+
+#include <cmath>
+
+using namespace acl;
+
+namespace
+{
+	constexpr uint32_t k_num_tracks = 23;		// Not a multiple of the SIMD width
+	constexpr uint32_t k_num_samples = 61;
+	constexpr float k_sample_rate = 30.0F;
+
+	// Every fourth track is constant, every seventh track needs raw samples and the others are quantized.
+	compressed_tracks* make_compressed_tracks(IAllocator& allocator)
+	{
+		track_array_float1f tracks(allocator, k_num_tracks);
+
+		for (uint32_t track_index = 0; track_index < k_num_tracks; ++track_index)
+		{
+			const bool is_constant = track_index % 4 == 1;
+			const bool is_raw = track_index % 7 == 3;
+
+			track_desc_scalarf desc;
+			desc.output_index = track_index;
+			desc.precision = is_raw ? 0.0F : 0.001F;
+			desc.constant_threshold = 0.001F;
+
+			track_float1f track = track_float1f::make_reserve(desc, allocator, k_num_samples, k_sample_rate);
+			for (uint32_t sample_index = 0; sample_index < k_num_samples; ++sample_index)
+			{
+				const float phase = float(sample_index) * (0.3F + float(track_index) * 0.11F);
+				track[sample_index] = is_constant ? (float(track_index) * 0.25F - 2.0F) : (std::sin(phase) * float(track_index + 1) + std::cos(phase * 1.7F));
+			}
+
+			tracks[track_index] = std::move(track);
+		}
+
+		compression_settings settings;
+		compressed_tracks* compressed_tracks_ = nullptr;
+		OutputStats stats;
+		const ErrorResult result = compress_track_list(allocator, tracks, settings, compressed_tracks_, stats);
+		REQUIRE(result.empty());
+		REQUIRE(compressed_tracks_ != nullptr);
+		return compressed_tracks_;
+	}
+
+	struct scalar_track_writer final : public track_writer
+	{
+		explicit scalar_track_writer(float* values_) : values(values_) {}
+
+		void write_float1(uint32_t track_index, rtm::scalarf_arg0 value) { values[track_index] = rtm::scalar_cast(value); }
+
+		float* values;
+	};
+}
+
+TEST_CASE("decompress_float1_tracks matches decompress_tracks", "[decompression][tracks]")
+{
+	ANSIAllocator allocator;
+	compressed_tracks* compressed_tracks_ = make_compressed_tracks(allocator);
+
+	decompression_context<default_decompression_settings> context;
+	context.initialize(*compressed_tracks_);
+
+	// Reversed outputs, every third track skipped
+	uint32_t output_indices[k_num_tracks];
+	for (uint32_t track_index = 0; track_index < k_num_tracks; ++track_index)
+		output_indices[track_index] = track_index % 3 == 2 ? k_invalid_track_index : (k_num_tracks - 1 - track_index);
+
+	const float untouched = 1234.0F;
+	const float duration = float(k_num_samples - 1) / k_sample_rate;
+
+	for (uint32_t step = 0; step <= 150; ++step)
+	{
+		const float sample_time = std::fmin(duration, float(step) * (duration / 147.0F));	// Lands between and on key frames, and on the end
+		context.seek(sample_time, SampleRoundingPolicy::None);
+
+		float reference[k_num_tracks];
+		scalar_track_writer writer(&reference[0]);
+		context.decompress_tracks(writer);
+
+		float values[k_num_tracks];
+		for (float& value : values)
+			value = untouched;
+
+		context.decompress_float1_tracks(&output_indices[0], &values[0]);
+
+		for (uint32_t track_index = 0; track_index < k_num_tracks; ++track_index)
+		{
+			INFO("time " << sample_time << " track " << track_index);
+
+			const uint32_t output_index = output_indices[track_index];
+			if (output_index == k_invalid_track_index)
+				CHECK(values[k_num_tracks - 1 - track_index] == untouched);
+			else
+				CHECK(values[output_index] == reference[track_index]);
+		}
+	}
+
+	allocator.deallocate(compressed_tracks_, compressed_tracks_->get_size());
+}
@@ -0,0 +1,256 @@
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <catch.hpp>
+
+#include <acl/algorithm/uniformly_sampled/decoder.h>
+#include <acl/algorithm/uniformly_sampled/encoder.h>
+#include <acl/compression/animation_clip.h>
+#include <acl/compression/skeleton.h>
+#include <acl/compression/skeleton_error_metric.h>
+#include <acl/core/ansi_allocator.h>
+#include <acl/decompression/default_output_writer.h>
+#include <acl/decompression/segment_streamer.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace acl;
+
+namespace
+{
+	constexpr uint16_t k_num_bones = 8;
+	constexpr uint32_t k_num_samples = 91;		// Enough for several segments
+	constexpr float k_sample_rate = 30.0F;
+
+	CompressedClip* make_compressed_clip(IAllocator& allocator)
+	{
+		RigidBone bones[k_num_bones];
+		for (uint16_t bone_index = 0; bone_index < k_num_bones; ++bone_index)
+		{
+			bones[bone_index].vertex_distance = 3.0F;
+			bones[bone_index].parent_index = bone_index == 0 ? k_invalid_bone_index : uint16_t(bone_index - 1);
+		}
+
+		RigidSkeleton skeleton(allocator, bones, k_num_bones);
+		AnimationClip clip(allocator, skeleton, k_num_samples, k_sample_rate, String(allocator, "streamed segments"));
+
+		for (uint16_t bone_index = 0; bone_index < k_num_bones; ++bone_index)
+		{
+			AnimatedBone& bone = clip.get_animated_bone(bone_index);
+			for (uint32_t sample_index = 0; sample_index < k_num_samples; ++sample_index)
+			{
+				const double phase = sample_index * (0.5 + bone_index * 0.41) / k_sample_rate;
+				const Vector4_64 axis = vector_normalize3(vector_set(1.0 + bone_index, std::sin(phase), 0.5 * bone_index));
+				bone.rotation_track.set_sample(sample_index, quat_from_axis_angle(axis, std::sin(phase) * 2.5 + bone_index * 0.1));
+				bone.translation_track.set_sample(sample_index, vector_set(std::cos(phase) * 10.0 + bone_index, std::sin(phase * 1.3) * 4.0, bone_index * 2.0 - phase));
+				bone.scale_track.set_sample(sample_index, vector_set(1.0));
+			}
+		}
+
+		TransformErrorMetric error_metric;
+		CompressionSettings settings = get_default_compression_settings();
+		settings.error_metric = &error_metric;
+
+		CompressedClip* compressed_clip = nullptr;
+		OutputStats stats;
+		const ErrorResult result = uniformly_sampled::compress_clip(allocator, clip, settings, compressed_clip, stats);
+		REQUIRE(result.empty());
+		REQUIRE(compressed_clip != nullptr);
+		return compressed_clip;
+	}
+
+	// Keeps a copy of every segment in its own buffer, each one can be made resident or not
+	struct TestSegmentStreamer final : public ISegmentStreamer
+	{
+		explicit TestSegmentStreamer(const CompressedClip& clip)
+		{
+			const uint32_t num_segments = get_clip_header(clip).num_segments;
+			for (uint32_t segment_index = 0; segment_index < num_segments; ++segment_index)
+			{
+				const SegmentDataRange range = get_segment_data_range(clip, segment_index);
+				const uint8_t* segment_data = reinterpret_cast<const uint8_t*>(&clip) + range.offset;
+
+				std::vector<uint8_t> page(range.size + 15, 0);
+				std::memcpy(page.data(), segment_data, range.size);
+				pages.push_back(page);
+				is_resident.push_back(true);
+			}
+		}
+
+		virtual const uint8_t* get_segment_data(uint32_t segment_index) override
+		{
+			return is_resident[segment_index] ? pages[segment_index].data() : nullptr;
+		}
+
+		std::vector<std::vector<uint8_t>> pages;
+		std::vector<bool> is_resident;
+	};
+
+	// Quat_32 and Vector4_32 can be the same SIMD type, compare them as raw bits.
+	// The W component of vectors comes from whatever follows the data read, it is ignored.
+	bool are_bitwise_equal(const Quat_32& lhs, const Quat_32& rhs) { return std::memcmp(&lhs, &rhs, sizeof(Quat_32)) == 0; }
+	bool are_bitwise_equal3(const Vector4_32& lhs, const Vector4_32& rhs) { return std::memcmp(&lhs, &rhs, sizeof(float) * 3) == 0; }
+
+	template<class ContextType>
+	void decompress(ContextType& context, float sample_time, SampleRoundingPolicy rounding_policy, Transform_32* out_pose)
+	{
+		context.seek(sample_time, rounding_policy);
+
+		DefaultOutputWriter writer(out_pose, k_num_bones);
+		context.decompress_pose(writer);
+	}
+
+	bool are_poses_equal(const Transform_32* lhs, const Transform_32* rhs)
+	{
+		for (uint16_t bone_index = 0; bone_index < k_num_bones; ++bone_index)
+		{
+			if (!are_bitwise_equal(lhs[bone_index].rotation, rhs[bone_index].rotation))
+				return false;
+			if (!are_bitwise_equal3(lhs[bone_index].translation, rhs[bone_index].translation))
+				return false;
+			if (!are_bitwise_equal3(lhs[bone_index].scale, rhs[bone_index].scale))
+				return false;
+		}
+		return true;
+	}
+
+	// Time at which a floored seek lands exactly on a key frame
+	float get_key_frame_time(uint32_t key_frame) { return (float(key_frame) + 0.5F) / k_sample_rate; }
+}
+
+TEST_CASE("segment data ranges", "[decompression][uniformly_sampled]")
+{
+	ANSIAllocator allocator;
+	CompressedClip* compressed_clip = make_compressed_clip(allocator);
+
+	const ClipHeader& header = get_clip_header(*compressed_clip);
+	REQUIRE(header.num_segments > 2);
+
+	// Segments are back to back and end with the clip
+	for (uint32_t segment_index = 0; segment_index < header.num_segments; ++segment_index)
+	{
+		const SegmentDataRange range = get_segment_data_range(*compressed_clip, segment_index);
+		CHECK(range.size != 0);
+
+		if (segment_index + 1 < header.num_segments)
+			CHECK(range.offset + range.size == get_segment_data_range(*compressed_clip, segment_index + 1).offset);
+		else
+			CHECK(range.offset + range.size == compressed_clip->get_size());
+	}
+
+	const uint32_t* segment_start_indices = header.get_segment_start_indices();
+	for (uint32_t segment_index = 0; segment_index < header.num_segments; ++segment_index)
+	{
+		CHECK(get_segment_index_at_time(*compressed_clip, get_key_frame_time(segment_start_indices[segment_index])) == segment_index);
+		CHECK(get_segment_index_at_time(*compressed_clip, get_key_frame_time(segment_start_indices[segment_index + 1] - 1)) == segment_index);
+	}
+
+	allocator.deallocate(compressed_clip, compressed_clip->get_size());
+}
+
+TEST_CASE("streamed segments decompress like the clip", "[decompression][uniformly_sampled]")
+{
+	ANSIAllocator allocator;
+	CompressedClip* compressed_clip = make_compressed_clip(allocator);
+
+	const ClipHeader& header = get_clip_header(*compressed_clip);
+	REQUIRE(header.num_segments > 2);
+
+	// Only the data preceding the segments is kept with the clip header, followed by padding for unaligned loads
+	const uint32_t resident_size = get_segment_data_range(*compressed_clip, 0).offset;
+	const uint32_t resident_buffer_size = resident_size + 15;
+	uint8_t* resident_buffer = allocate_type_array_aligned<uint8_t>(allocator, resident_buffer_size, 16);
+	std::memset(resident_buffer, 0, resident_buffer_size);
+	std::memcpy(resident_buffer, compressed_clip, resident_size);
+	const CompressedClip& resident_clip = *reinterpret_cast<const CompressedClip*>(resident_buffer);
+
+	TestSegmentStreamer streamer(*compressed_clip);
+
+	uniformly_sampled::DecompressionContext<uniformly_sampled::DefaultDecompressionSettings> reference_context;
+	reference_context.initialize(*compressed_clip);
+
+	uniformly_sampled::DecompressionContext<uniformly_sampled::DefaultDecompressionSettings> streamed_context;
+	streamed_context.initialize(resident_clip, &streamer);
+
+	Transform_32 reference_pose[k_num_bones];
+	Transform_32 streamed_pose[k_num_bones];
+
+	const float duration = float(k_num_samples - 1) / k_sample_rate;
+
+	SECTION("every segment resident")
+	{
+		for (uint32_t step = 0; step <= 200; ++step)
+		{
+			const float sample_time = std::fmin(duration, step * (duration / 197.0F));
+			decompress(reference_context, sample_time, SampleRoundingPolicy::None, reference_pose);
+			decompress(streamed_context, sample_time, SampleRoundingPolicy::None, streamed_pose);
+
+			INFO("time " << sample_time);
+			CHECK(are_poses_equal(reference_pose, streamed_pose));
+		}
+	}
+
+	SECTION("missing segments fall back to the nearest resident one")
+	{
+		const uint32_t* segment_start_indices = header.get_segment_start_indices();
+		const uint32_t missing_segment_index = 1;
+		const uint32_t missing_start = segment_start_indices[missing_segment_index];
+		const uint32_t missing_end = segment_start_indices[missing_segment_index + 1];
+		streamer.is_resident[missing_segment_index] = false;
+
+		// Inside the missing segment, we hold the last sample of the previous segment
+		for (uint32_t key_frame = missing_start; key_frame < missing_end; ++key_frame)
+		{
+			decompress(reference_context, get_key_frame_time(missing_start - 1), SampleRoundingPolicy::Floor, reference_pose);
+			decompress(streamed_context, (float(key_frame) + 0.3F) / k_sample_rate, SampleRoundingPolicy::None, streamed_pose);
+
+			INFO("key frame " << key_frame);
+			CHECK(are_poses_equal(reference_pose, streamed_pose));
+		}
+
+		// Interpolating into the missing segment holds the first key frame
+		decompress(reference_context, get_key_frame_time(missing_start - 1), SampleRoundingPolicy::Floor, reference_pose);
+		decompress(streamed_context, (float(missing_start - 1) + 0.7F) / k_sample_rate, SampleRoundingPolicy::None, streamed_pose);
+		CHECK(are_poses_equal(reference_pose, streamed_pose));
+
+		// Without the previous segment either, the next one is the nearest
+		streamer.is_resident[missing_segment_index - 1] = false;
+		decompress(reference_context, get_key_frame_time(missing_end), SampleRoundingPolicy::Floor, reference_pose);
+		decompress(streamed_context, (float(missing_start) + 0.3F) / k_sample_rate, SampleRoundingPolicy::None, streamed_pose);
+		CHECK(are_poses_equal(reference_pose, streamed_pose));
+
+		// Once streamed in, seeking the same time again picks up the segment
+		streamer.is_resident[missing_segment_index - 1] = true;
+		streamer.is_resident[missing_segment_index] = true;
+		decompress(reference_context, (float(missing_start) + 0.3F) / k_sample_rate, SampleRoundingPolicy::None, reference_pose);
+		decompress(streamed_context, (float(missing_start) + 0.3F) / k_sample_rate, SampleRoundingPolicy::None, streamed_pose);
+		CHECK(are_poses_equal(reference_pose, streamed_pose));
+	}
+
+	deallocate_type_array(allocator, resident_buffer, resident_buffer_size);
+	allocator.deallocate(compressed_clip, compressed_clip->get_size());
+}
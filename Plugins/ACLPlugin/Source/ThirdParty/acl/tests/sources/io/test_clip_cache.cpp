@@ -0,0 +1,361 @@
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <catch.hpp>
+
+#if defined(ACL_USE_SJSON)
+	#include <sjson/parser.h>
+	#include <sjson/writer.h>
+#endif
+
+#include <acl/core/ansi_allocator.h>
+#include <acl/io/clip_cache.h>
+#include <acl/io/clip_reader.h>
+#include <acl/io/clip_writer.h>
+#include <acl/io/impl/hex_parsing.h>
+#include <acl/math/math.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#endif
+
+using namespace acl;
+
+#if defined(ACL_SSE2_INTRINSICS) && defined(ACL_USE_SJSON)
+static void get_temporary_filename(char* filename, size_t filename_size, const char* prefix, const char* extension)
+{
+	char directory[1024] = { 0 };
+#ifdef _WIN32
+	GetTempPathA(DWORD(sizeof(directory)), directory);
+#else
+	std::strcpy(directory, "/tmp/");
+#endif
+
+	snprintf(filename, filename_size, "%s%s%u%s", directory, prefix, std::rand(), extension);
+}
+
+static std::vector<char> read_file(const char* filename)
+{
+	std::vector<char> buffer;
+
+	std::FILE* file = nullptr;
+#ifdef _WIN32
+	fopen_s(&file, filename, "rb");
+#else
+	file = fopen(filename, "rb");
+#endif
+	REQUIRE(file != nullptr);
+
+	char chunk[16 * 1024];
+	size_t chunk_size;
+	while ((chunk_size = fread(chunk, 1, sizeof(chunk), file)) != 0)
+		buffer.insert(buffer.end(), chunk, chunk + chunk_size);
+
+	fclose(file);
+	std::remove(filename);
+	return buffer;
+}
+
+static bool are_bit_equal(const AnimationClip& lhs, const AnimationClip& rhs)
+{
+	if (lhs.get_num_bones() != rhs.get_num_bones() || lhs.get_num_samples() != rhs.get_num_samples() || lhs.get_sample_rate() != rhs.get_sample_rate() || lhs.get_name() != rhs.get_name())
+		return false;
+
+	for (uint16_t bone_index = 0; bone_index < lhs.get_num_bones(); ++bone_index)
+	{
+		const AnimatedBone& lhs_bone = lhs.get_animated_bone(bone_index);
+		const AnimatedBone& rhs_bone = rhs.get_animated_bone(bone_index);
+
+		for (uint32_t sample_index = 0; sample_index < lhs.get_num_samples(); ++sample_index)
+		{
+			double lhs_values[10];
+			double rhs_values[10];
+			quat_unaligned_write(lhs_bone.rotation_track.get_sample(sample_index), &lhs_values[0]);
+			vector_unaligned_write3(lhs_bone.translation_track.get_sample(sample_index), &lhs_values[4]);
+			vector_unaligned_write3(lhs_bone.scale_track.get_sample(sample_index), &lhs_values[7]);
+			quat_unaligned_write(rhs_bone.rotation_track.get_sample(sample_index), &rhs_values[0]);
+			vector_unaligned_write3(rhs_bone.translation_track.get_sample(sample_index), &rhs_values[4]);
+			vector_unaligned_write3(rhs_bone.scale_track.get_sample(sample_index), &rhs_values[7]);
+
+			if (std::memcmp(&lhs_values[0], &rhs_values[0], sizeof(lhs_values)) != 0)
+				return false;
+		}
+	}
+
+	return true;
+}
+#endif
+
+TEST_CASE("hex_to_uint64", "[io]")
+{
+	const char* values[] =
+	{
+		"0", "1", "F", "a", "10", "7FF", "3F800000", "BF800000", "deadBEEF",
+		"3FF0000000000000", "C00921FB54442D18", "FFFFFFFFFFFFFFFF", "123456789ABCDEF", "8000000000000001",
+	};
+
+	for (const char* value : values)
+	{
+		INFO(value);
+		CHECK(acl_impl::hex_to_uint64(value, std::strlen(value)) == acl_impl::strtoull(value, nullptr, 16));
+	}
+}
+
+TEST_CASE("parse_hex_run", "[io]")
+{
+	uint64_t values[4] = { 0, 0, 0, 0 };
+
+#if defined(ACL_SSE2_INTRINSICS)
+	// Trailing padding keeps the last value far enough from the end of the input to be read 16 characters at a time
+	const char run[] = " \"3FF0000000000000\", \"0\",\t\"deadBEEF\" ,  \"C00921FB54442D18\" ]                    ";
+	const size_t run_length = std::strlen(run);
+
+	CHECK(acl_impl::parse_hex_run(run, run_length, 4, values) == size_t(std::strchr(run, ']') - run - 1));
+	CHECK(values[0] == 0x3FF0000000000000ULL);
+	CHECK(values[1] == 0x0ULL);
+	CHECK(values[2] == 0xDEADBEEFULL);
+	CHECK(values[3] == 0xC00921FB54442D18ULL);
+
+	// A shorter run stops after its last value
+	CHECK(acl_impl::parse_hex_run(run, run_length, 2, values) == size_t(std::strstr(run, ",\t") - run));
+#endif
+
+	// Anything else is left to the SJSON parser
+	const char* other_runs[] =
+	{
+		" \"3FF0000000000000\",\n\t\"0\" ]                    ",		// The run spans lines
+		" \"13FF0000000000000\", \"0\" ]                    ",		// More than 16 digits
+		" \"\", \"0\" ]                                   ",		// No digits
+		" \"3FF0000000000000\" \"0\" ]                    ",		// Missing comma
+		" 1.0, 0.5 ]                                  ",		// Not binary exact
+		" \"3FF0000000000000\", \"0\" ]",						// Too close to the end of the input
+	};
+
+	for (const char* other_run : other_runs)
+	{
+		INFO(other_run);
+		CHECK(acl_impl::parse_hex_run(other_run, std::strlen(other_run), 2, values) == 0);
+	}
+}
+
+TEST_CASE("clip_cache_reader_writer", "[io]")
+{
+	// Only test the reader/writer on non-mobile platforms
+#if defined(ACL_SSE2_INTRINSICS) && defined(ACL_USE_SJSON)
+	ANSIAllocator allocator;
+
+	const uint16_t num_bones = 3;
+	RigidBone bones[num_bones];
+	bones[0].name = String(allocator, "root");
+	bones[0].vertex_distance = 4.0F;
+	bones[0].parent_index = k_invalid_bone_index;
+	bones[0].bind_transform = transform_identity_64();
+
+	bones[1].name = String(allocator, "bone1");
+	bones[1].vertex_distance = 3.0F;
+	bones[1].parent_index = 0;
+	bones[1].bind_transform = transform_set(quat_from_axis_angle(vector_set(0.0, 1.0, 0.0), k_pi_64 * 0.5), vector_set(3.2, 8.2, 5.1), vector_set(1.0));
+
+	bones[2].name = String(allocator, "bone2");
+	bones[2].vertex_distance = 2.0F;
+	bones[2].parent_index = 0;
+	bones[2].bind_transform = transform_set(quat_from_axis_angle(vector_set(0.0, 0.0, 1.0), k_pi_64 * 0.25), vector_set(6.3, 9.4, 1.5), vector_set(1.0));
+
+	RigidSkeleton skeleton(allocator, bones, num_bones);
+
+	const uint32_t num_samples = 7;
+	AnimationClip clip(allocator, skeleton, num_samples, 30.0F, String(allocator, "test_clip"));
+	AnimationClip base_clip(allocator, skeleton, 1, 30.0F, String(allocator, "test_base_clip"));
+
+	for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+	{
+		AnimatedBone& bone = clip.get_animated_bone(bone_index);
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			// Values that aren't exactly representable in decimal, the round trip must be binary exact
+			const double value = double(bone_index * num_samples + sample_index + 1) / 3.0;
+			bone.rotation_track.set_sample(sample_index, quat_from_axis_angle(vector_normalize3(vector_set(value, 1.0, -value)), value));
+			bone.translation_track.set_sample(sample_index, vector_set(value, -value * 7.0, value * 1.0E-5));
+			bone.scale_track.set_sample(sample_index, vector_set(1.0 + value, 1.0 / value, -value));
+		}
+
+		AnimatedBone& base_bone = base_clip.get_animated_bone(bone_index);
+		base_bone.rotation_track.set_sample(0, quat_from_axis_angle(vector_set(1.0, 0.0, 0.0), double(bone_index) * 0.1));
+		base_bone.translation_track.set_sample(0, vector_set(double(bone_index) / 7.0));
+		base_bone.scale_track.set_sample(0, vector_set(1.0));
+	}
+
+	clip.set_additive_base(&base_clip, AdditiveClipFormat8::Additive1);
+
+	CompressionSettings settings;
+	settings.level = CompressionLevel8::High;
+	settings.range_reduction = RangeReductionFlags8::Rotations | RangeReductionFlags8::Scales;
+	settings.rotation_format = RotationFormat8::QuatDropW_48;
+	settings.translation_format = VectorFormat8::Vector3_32;
+	settings.segmenting.enabled = true;
+	settings.segmenting.ideal_num_samples = 23;
+	settings.segmenting.max_num_samples = 123;
+	settings.error_threshold = 0.23F;
+
+	// Write the clip to SJSON and read it back
+	char sjson_filename[1024];
+	get_temporary_filename(sjson_filename, sizeof(sjson_filename), "clip_", ".acl.sjson");
+	REQUIRE(write_acl_clip(skeleton, clip, AlgorithmType8::UniformlySampled, settings, sjson_filename) == nullptr);
+
+	const std::vector<char> sjson_buffer = read_file(sjson_filename);
+	ClipReader sjson_reader(allocator, sjson_buffer.data(), sjson_buffer.size() - 1);
+	REQUIRE(sjson_reader.get_file_type() == sjson_file_type::raw_clip);
+
+	sjson_raw_clip sjson_clip;
+	REQUIRE(sjson_reader.read_raw_clip(sjson_clip));
+	REQUIRE(sjson_clip.clip->get_additive_base() != nullptr);
+
+	CHECK(are_bit_equal(*sjson_clip.clip, clip));
+	CHECK(are_bit_equal(*sjson_clip.clip->get_additive_base(), base_clip));
+
+	// Write what we read to a cache and read it back
+	const uint64_t source_size = sjson_buffer.size();
+	const uint64_t source_timestamp = 0x0123456789ABCDEFULL;
+
+	char cache_filename[1024];
+	get_temporary_filename(cache_filename, sizeof(cache_filename), "clip_", ".acl.cache");
+	REQUIRE(write_acl_clip_cache(*sjson_clip.skeleton, *sjson_clip.clip, sjson_clip.algorithm_type, sjson_clip.settings, source_size, source_timestamp, cache_filename) == nullptr);
+
+	std::vector<char> cache_buffer = read_file(cache_filename);
+	CHECK(is_clip_cache_up_to_date(cache_buffer.data(), cache_buffer.size(), source_size, source_timestamp));
+	CHECK(!is_clip_cache_up_to_date(cache_buffer.data(), cache_buffer.size(), source_size + 1, source_timestamp));
+	CHECK(!is_clip_cache_up_to_date(sjson_buffer.data(), sjson_buffer.size(), source_size, source_timestamp));
+
+	ClipReader cache_reader(allocator, cache_buffer.data(), cache_buffer.size());
+	REQUIRE(cache_reader.get_file_type() == sjson_file_type::raw_clip);
+
+	sjson_raw_clip cache_clip;
+	REQUIRE(cache_reader.read_raw_clip(cache_clip));
+
+	CHECK(cache_clip.has_settings);
+	CHECK(cache_clip.algorithm_type == AlgorithmType8::UniformlySampled);
+	CHECK(cache_clip.settings.get_hash() == sjson_clip.settings.get_hash());
+	CHECK(cache_clip.clip->get_additive_format() == AdditiveClipFormat8::Additive1);
+	REQUIRE(cache_clip.clip->get_additive_base() != nullptr);
+	CHECK(are_bit_equal(*cache_clip.clip, clip));
+	CHECK(are_bit_equal(*cache_clip.clip->get_additive_base(), base_clip));
+
+	REQUIRE(cache_clip.skeleton->get_num_bones() == num_bones);
+	for (uint16_t bone_index = 0; bone_index < num_bones; ++bone_index)
+	{
+		const RigidBone& src_bone = skeleton.get_bone(bone_index);
+		const RigidBone& cache_bone = cache_clip.skeleton->get_bone(bone_index);
+		CHECK(src_bone.name == cache_bone.name);
+		CHECK(src_bone.vertex_distance == cache_bone.vertex_distance);
+		CHECK(src_bone.parent_index == cache_bone.parent_index);
+		CHECK(quat_near_equal(src_bone.bind_transform.rotation, cache_bone.bind_transform.rotation, 0.0));
+		CHECK(vector_all_near_equal3(src_bone.bind_transform.translation, cache_bone.bind_transform.translation, 0.0));
+	}
+
+	// A truncated cache is rejected
+	ClipReader truncated_reader(allocator, cache_buffer.data(), cache_buffer.size() - 8);
+	sjson_raw_clip truncated_clip;
+	CHECK(!truncated_reader.read_raw_clip(truncated_clip));
+	CHECK(truncated_reader.get_error().error == ClipReaderError::InvalidClipCache);
+
+	// The clips we read own their additive base
+	deallocate_type(allocator, const_cast<AnimationClip*>(sjson_clip.clip->get_additive_base()));
+	deallocate_type(allocator, const_cast<AnimationClip*>(cache_clip.clip->get_additive_base()));
+#endif
+}
+
+TEST_CASE("track_list_cache_reader_writer", "[io]")
+{
+	// Only test the reader/writer on non-mobile platforms
+#if defined(ACL_SSE2_INTRINSICS) && defined(ACL_USE_SJSON)
+	ANSIAllocator allocator;
+
+	const uint32_t num_tracks = 5;
+	const uint32_t num_samples = 9;
+	track_array_float3f track_list(allocator, num_tracks);
+
+	for (uint32_t track_index = 0; track_index < num_tracks; ++track_index)
+	{
+		track_desc_scalarf desc;
+		desc.output_index = num_tracks - 1 - track_index;
+		desc.precision = 0.001F * float(track_index + 1);
+		desc.constant_threshold = 0.0001F;
+
+		track_float3f track_ = track_float3f::make_reserve(desc, allocator, num_samples, 24.0F);
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+		{
+			const float value = float(track_index * num_samples + sample_index + 1) / 3.0F;
+			track_[sample_index] = rtm::float3f{ value, -value * 11.0F, 1.0F / value };
+		}
+
+		track_list[track_index] = std::move(track_);
+	}
+
+	char sjson_filename[1024];
+	get_temporary_filename(sjson_filename, sizeof(sjson_filename), "list_float3f_", ".acl.sjson");
+	REQUIRE(write_track_list(track_list, sjson_filename) == nullptr);
+
+	const std::vector<char> sjson_buffer = read_file(sjson_filename);
+	ClipReader sjson_reader(allocator, sjson_buffer.data(), sjson_buffer.size() - 1);
+
+	sjson_raw_track_list sjson_track_list;
+	REQUIRE(sjson_reader.read_raw_track_list(sjson_track_list));
+
+	char cache_filename[1024];
+	get_temporary_filename(cache_filename, sizeof(cache_filename), "list_float3f_", ".acl.cache");
+	REQUIRE(write_track_list_cache(sjson_track_list.track_list, sjson_buffer.size(), 1, cache_filename) == nullptr);
+
+	const std::vector<char> cache_buffer = read_file(cache_filename);
+	ClipReader cache_reader(allocator, cache_buffer.data(), cache_buffer.size());
+	REQUIRE(cache_reader.get_file_type() == sjson_file_type::raw_track_list);
+
+	sjson_raw_track_list cache_track_list;
+	REQUIRE(cache_reader.read_raw_track_list(cache_track_list));
+
+	REQUIRE(cache_track_list.track_list.get_num_tracks() == num_tracks);
+	CHECK(cache_track_list.track_list.get_track_type() == track_type8::float3f);
+
+	for (uint32_t track_index = 0; track_index < num_tracks; ++track_index)
+	{
+		const track_float3f& ref_track = track_cast<track_float3f>(track_list[track_index]);
+		const track_float3f& cache_track = track_cast<track_float3f>(cache_track_list.track_list[track_index]);
+
+		CHECK(cache_track.get_description().output_index == ref_track.get_description().output_index);
+		CHECK(cache_track.get_description().precision == ref_track.get_description().precision);
+		CHECK(cache_track.get_description().constant_threshold == ref_track.get_description().constant_threshold);
+		CHECK(cache_track.get_sample_rate() == ref_track.get_sample_rate());
+		REQUIRE(cache_track.get_num_samples() == num_samples);
+
+		for (uint32_t sample_index = 0; sample_index < num_samples; ++sample_index)
+			CHECK(std::memcmp(&cache_track[sample_index], &ref_track[sample_index], sizeof(rtm::float3f)) == 0);
+	}
+#endif
+}
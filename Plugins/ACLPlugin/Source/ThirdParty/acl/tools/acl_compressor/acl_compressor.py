@@ -29,6 +29,7 @@ def parse_argv():
 	options['has_progress_bar'] = True
 	options['stat_detailed'] = False
 	options['stat_exhaustive'] = False
+	options['cache'] = False
 	options['level'] = 'Medium'
 	options['print_help'] = False
 
@@ -72,6 +73,9 @@ def parse_argv():
 		if value == '-stat_exhaustive':
 			options['stat_exhaustive'] = True
 
+		if value == '-cache':
+			options['cache'] = True
+
 		if value.startswith('-parallel='):
 			options['num_threads'] = int(value[len('-parallel='):].replace('"', ''))
 
@@ -116,7 +120,7 @@ def parse_argv():
 	return options
 
 def print_usage():
-	print('Usage: python acl_compressor.py -acl=<path to directory containing ACL files> -stats=<path to output directory for stats> [-csv_summary] [-csv_bit_rate] [-csv_animated_size] [-csv_error] [-refresh] [-parallel={Num Threads}] [-help]')
+	print('Usage: python acl_compressor.py -acl=<path to directory containing ACL files> -stats=<path to output directory for stats> [-csv_summary] [-csv_bit_rate] [-csv_animated_size] [-csv_error] [-refresh] [-parallel={Num Threads}] [-cache] [-help]')
 
 def print_help():
 	print('Usage: python acl_compressor.py [arguments]')
@@ -135,6 +139,7 @@ def print_help():
 	print('  -no_progress_bar: Suppresses the progress bar output')
 	print('  -stat_detailed: Enables detailed stat logging')
 	print('  -stat_exhaustive: Enables exhaustive stat logging')
+	print('  -cache: Reads clips from a binary cache next to each clip instead of parsing the SJSON, and writes it when it is missing or stale')
 	print('  -help: Prints this help message.')
 
 def print_stat(stat):
@@ -344,6 +349,9 @@ def compress_clips(options):
 			if options['stat_exhaustive']:
 				cmd = '{} -stat_exhaustive'.format(cmd)
 
+			if options['cache']:
+				cmd = '{} -cache'.format(cmd)
+
 			if platform.system() == 'Windows':
 				cmd = cmd.replace('/', '\\')
 
@@ -53,6 +53,7 @@
 #include "acl/compression/track_error.h"
 #include "acl/compression/utils.h"
 #include "acl/decompression/decompress.h"
+#include "acl/io/clip_cache.h"
 #include "acl/io/clip_reader.h"
 
 #include "acl/algorithm/uniformly_sampled/encoder.h"
@@ -116,6 +117,11 @@
 	#include <windows.h>
 	#include <conio.h>
 
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
 #endif    // _WIN32
 
 using namespace acl;
@@ -153,6 +159,8 @@ struct Options
 	bool			stat_detailed_output;
 	bool			stat_exhaustive_output;
 
+	bool			use_clip_cache;
+
 	//////////////////////////////////////////////////////////////////////////
 
 	Options()
@@ -180,6 +188,7 @@ struct Options
 		, is_bind_pose_additive1(false)
 		, stat_detailed_output(false)
 		, stat_exhaustive_output(false)
+		, use_clip_cache(false)
 	{}
 
 	~Options()
@@ -225,6 +234,7 @@ static constexpr const char* k_bind_pose_additive0_option = "-bind_add0";
 static constexpr const char* k_bind_pose_additive1_option = "-bind_add1";
 static constexpr const char* k_stat_detailed_output_option = "-stat_detailed";
 static constexpr const char* k_stat_exhaustive_output_option = "-stat_exhaustive";
+static constexpr const char* k_clip_cache_option = "-cache";
 
 bool is_acl_sjson_file(const char* filename)
 {
@@ -386,6 +396,13 @@ static bool parse_options(int argc, char** argv, Options& options)
 			continue;
 		}
 
+		option_length = std::strlen(k_clip_cache_option);
+		if (std::strncmp(argument, k_clip_cache_option, option_length) == 0)
+		{
+			options.use_clip_cache = true;
+			continue;
+		}
+
 		printf("Unrecognized option %s\n", argument);
 		return false;
 	}
@@ -832,68 +849,153 @@ static void try_algorithm(const Options& options, IAllocator& allocator, const t
 		try_algorithm_impl(nullptr);
 }
 
-static bool read_acl_sjson_file(IAllocator& allocator, const Options& options,
-	sjson_file_type& out_file_type,
-	sjson_raw_clip& out_raw_clip,
-	sjson_raw_track_list& out_raw_track_list)
+#if !defined(__ANDROID__)
+// A read-only mapping of a whole file, the clip reader parses it in place instead of a copy
+struct MappedFile
 {
-	char* sjson_file_buffer = nullptr;
-	size_t file_size = 0;
-
-#if defined(__ANDROID__)
-	ClipReader reader(allocator, options.input_buffer, options.input_buffer_size - 1);
-#else
-	// Use the raw C API with a large buffer to ensure this is as fast as possible
-	std::FILE* file = nullptr;
+	const char* data;
+	size_t size;
+	uint64_t timestamp;
 
 #ifdef _WIN32
-	char path[64 * 1024] = { 0 };
-	snprintf(path, get_array_size(path), "\\\\?\\%s", options.input_filename);
-	fopen_s(&file, path, "rb");
-#else
-	file = fopen(options.input_filename, "rb");
+	HANDLE file_handle;
+	HANDLE mapping_handle;
 #endif
 
-	if (file == nullptr)
-		return false;
-
-	// Make sure to enable buffering with a large buffer
-	const int setvbuf_result = setvbuf(file, NULL, _IOFBF, 1 * 1024 * 1024);
-	if (setvbuf_result != 0)
-		return false;
+	MappedFile()
+		: data(nullptr)
+		, size(0)
+		, timestamp(0)
+#ifdef _WIN32
+		, file_handle(INVALID_HANDLE_VALUE)
+		, mapping_handle(nullptr)
+#endif
+	{}
 
-	const int fseek_result = fseek(file, 0, SEEK_END);
-	if (fseek_result != 0)
+	~MappedFile()
 	{
-		fclose(file);
-		return false;
+#ifdef _WIN32
+		if (data != nullptr)
+			UnmapViewOfFile(data);
+		if (mapping_handle != nullptr)
+			CloseHandle(mapping_handle);
+		if (file_handle != INVALID_HANDLE_VALUE)
+			CloseHandle(file_handle);
+#else
+		if (data != nullptr)
+			munmap(const_cast<char*>(data), size);
+#endif
 	}
 
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const char* filename)
+	{
 #ifdef _WIN32
-	file_size = static_cast<size_t>(_ftelli64(file));
+		char path[64 * 1024] = { 0 };
+		snprintf(path, get_array_size(path), "\\\\?\\%s", filename);
+
+		file_handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file_handle == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER file_size;
+		FILETIME last_write_time;
+		if (!GetFileSizeEx(file_handle, &file_size) || !GetFileTime(file_handle, nullptr, nullptr, &last_write_time) || file_size.QuadPart == 0)
+			return false;
+
+		size = static_cast<size_t>(file_size.QuadPart);
+		timestamp = (uint64_t(last_write_time.dwHighDateTime) << 32) | last_write_time.dwLowDateTime;
+
+		mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping_handle == nullptr)
+			return false;
+
+		data = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+		return data != nullptr;
 #else
-	file_size = static_cast<size_t>(ftello(file));
+		const int file_descriptor = ::open(filename, O_RDONLY);
+		if (file_descriptor < 0)
+			return false;
+
+		struct stat file_stats;
+		if (fstat(file_descriptor, &file_stats) != 0 || file_stats.st_size == 0)
+		{
+			close(file_descriptor);
+			return false;
+		}
+
+		size = static_cast<size_t>(file_stats.st_size);
+		timestamp = static_cast<uint64_t>(file_stats.st_mtime);
+
+		void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+		close(file_descriptor);
+
+		if (mapping == MAP_FAILED)
+			return false;
+
+		// The whole file is parsed front to back
+		madvise(mapping, size, MADV_SEQUENTIAL);
+		data = static_cast<const char*>(mapping);
+		return true;
 #endif
+	}
+};
 
-	if (file_size == static_cast<size_t>(-1L))
+// The clip cache of 'foo.acl.sjson' is 'foo.acl.cache' in the same directory
+static std::string get_clip_cache_filename(const char* sjson_filename)
+{
+	std::string cache_filename(sjson_filename);
+	cache_filename.replace(cache_filename.size() - 6, 6, ".cache");
+	return cache_filename;
+}
+
+static void write_clip_cache(const std::string& cache_filename, const MappedFile& sjson_file, sjson_file_type file_type, const sjson_raw_clip& raw_clip, const sjson_raw_track_list& raw_track_list)
+{
+	const char* error = nullptr;
+	if (file_type == sjson_file_type::raw_clip)
 	{
-		fclose(file);
-		return false;
+		if (raw_clip.has_settings)
+			error = write_acl_clip_cache(*raw_clip.skeleton, *raw_clip.clip, raw_clip.algorithm_type, raw_clip.settings, sjson_file.size, sjson_file.timestamp, cache_filename.c_str());
+		else
+			error = write_acl_clip_cache(*raw_clip.skeleton, *raw_clip.clip, sjson_file.size, sjson_file.timestamp, cache_filename.c_str());
 	}
+	else
+		error = write_track_list_cache(raw_track_list.track_list, sjson_file.size, sjson_file.timestamp, cache_filename.c_str());
 
-	rewind(file);
+	// A missing cache only costs time, keep going
+	if (error != nullptr)
+		printf("\nFailed to write clip cache %s: %s\n", cache_filename.c_str(), error);
+}
+#endif
 
-	sjson_file_buffer = allocate_type_array<char>(allocator, file_size);
-	const size_t result = fread(sjson_file_buffer, 1, file_size, file);
-	fclose(file);
+static bool read_acl_sjson_file(IAllocator& allocator, const Options& options,
+	sjson_file_type& out_file_type,
+	sjson_raw_clip& out_raw_clip,
+	sjson_raw_track_list& out_raw_track_list)
+{
+#if defined(__ANDROID__)
+	ClipReader reader(allocator, options.input_buffer, options.input_buffer_size - 1);
+#else
+	// The input is memory mapped and parsed in place. With -cache, the clip cache next to it is read
+	// instead when it was built from this exact file, and it is written whenever it isn't.
+	MappedFile sjson_file;
+	if (!sjson_file.open(options.input_filename))
+		return false;
 
-	if (result != file_size)
+	std::string cache_filename;
+	MappedFile cache_file;
+	bool is_cache_up_to_date = false;
+	if (options.use_clip_cache)
 	{
-		deallocate_type_array(allocator, sjson_file_buffer, file_size);
-		return false;
+		cache_filename = get_clip_cache_filename(options.input_filename);
+		is_cache_up_to_date = cache_file.open(cache_filename.c_str()) && is_clip_cache_up_to_date(cache_file.data, cache_file.size, sjson_file.size, sjson_file.timestamp);
 	}
 
-	ClipReader reader(allocator, sjson_file_buffer, file_size - 1);
+	const char* input_buffer = is_cache_up_to_date ? cache_file.data : sjson_file.data;
+	const size_t input_buffer_size = is_cache_up_to_date ? cache_file.size : (sjson_file.size - 1);
+	ClipReader reader(allocator, input_buffer, input_buffer_size);
 #endif
 
 	const sjson_file_type ftype = reader.get_file_type();
@@ -921,7 +1023,11 @@ static bool read_acl_sjson_file(IAllocator& allocator, const Options& options,
 			printf("\nError on line %d column %d: %s\n", err.line, err.column, err.get_description());
 	}
 
-	deallocate_type_array(allocator, sjson_file_buffer, file_size);
+#if !defined(__ANDROID__)
+	if (success && options.use_clip_cache && !is_cache_up_to_date)
+		write_clip_cache(cache_filename, sjson_file, ftype, out_raw_clip, out_raw_track_list);
+#endif
+
 	return success;
 }
 
@@ -0,0 +1,111 @@
+import os
+import sys
+
+# This script depends on a SJSON parsing package:
+# https://pypi.python.org/pypi/SJSON/1.1.0
+# https://shelter13.net/projects/SJSON/
+# https://bitbucket.org/Anteru/sjson/src
+import sjson
+
+
+def parse_argv():
+	options = {}
+	options['base'] = ''
+	options['new'] = ''
+	options['stat'] = 'med_time_ms'
+	options['threshold'] = 5.0
+	options['print_help'] = False
+
+	for i in range(1, len(sys.argv)):
+		value = sys.argv[i]
+
+		if value.startswith('-base='):
+			options['base'] = os.path.expanduser(value[len('-base='):].replace('"', ''))
+
+		if value.startswith('-new='):
+			options['new'] = os.path.expanduser(value[len('-new='):].replace('"', ''))
+
+		if value.startswith('-stat='):
+			options['stat'] = value[len('-stat='):].replace('"', '')
+
+		if value.startswith('-threshold='):
+			options['threshold'] = float(value[len('-threshold='):].replace('"', ''))
+
+		if value == '-help':
+			options['print_help'] = True
+
+	if options['print_help']:
+		print_help()
+		sys.exit(1)
+
+	for key in ['base', 'new']:
+		if not os.path.isfile(options[key]):
+			print('Benchmark results not found: {}'.format(options[key]))
+			print_usage()
+			sys.exit(1)
+
+	return options
+
+def print_usage():
+	print('Usage: python compare_benchmarks.py -base=<baseline results> -new=<new results> [-stat=med_time_ms] [-threshold=5.0] [-help]')
+
+def print_help():
+	print('Usage: python compare_benchmarks.py [arguments]')
+	print()
+	print('Arguments:')
+	print('  -base=<path>: The acl_decompressor_benchmark results of the baseline build.')
+	print('  -new=<path>: The acl_decompressor_benchmark results of the build to compare.')
+	print('  -stat=<name>: The statistic to compare: min_time_ms, max_time_ms, avg_time_ms or med_time_ms (default).')
+	print('  -threshold=<percent>: The change above which a measurement is reported as a regression or an improvement. Defaults to 5%.')
+	print('  -help: Prints this help message.')
+
+def read_results(filename, stat):
+	results = {}
+	with open(filename, 'r') as file:
+		file_data = sjson.loads(file.read())
+		for run_stats in file_data['runs']:
+			key_prefix = (run_stats['clip_name'], run_stats['decompression_settings'])
+			for category, decomp_data in run_stats['decompression_time_per_sample'].items():
+				if stat in decomp_data:
+					results[key_prefix + (category,)] = decomp_data[stat]
+	return results
+
+if __name__ == "__main__":
+	options = parse_argv()
+
+	base_results = read_results(options['base'], options['stat'])
+	new_results = read_results(options['new'], options['stat'])
+
+	threshold = options['threshold']
+	num_regressions = 0
+	num_improvements = 0
+	num_compared = 0
+
+	for key in sorted(new_results.keys()):
+		if key not in base_results:
+			print('New measurement: {} {} {}'.format(*key))
+			continue
+
+		base_time = base_results[key]
+		new_time = new_results[key]
+		num_compared += 1
+
+		if base_time <= 0.0:
+			continue
+
+		delta = (new_time - base_time) / base_time * 100.0
+		if delta > threshold:
+			num_regressions += 1
+			print('Regression:  {} {} {}: {:.4f}ms -> {:.4f}ms ({:+.1f}%)'.format(key[0], key[1], key[2], base_time, new_time, delta))
+		elif delta < -threshold:
+			num_improvements += 1
+			print('Improvement: {} {} {}: {:.4f}ms -> {:.4f}ms ({:+.1f}%)'.format(key[0], key[1], key[2], base_time, new_time, delta))
+
+	for key in sorted(base_results.keys()):
+		if key not in new_results:
+			print('Missing measurement: {} {} {}'.format(*key))
+
+	print()
+	print('Compared {} measurements of {}: {} regressions, {} improvements above {}%'.format(num_compared, options['stat'], num_regressions, num_improvements, threshold))
+
+	sys.exit(1 if num_regressions != 0 else 0)
@@ -0,0 +1,449 @@
+////////////////////////////////////////////////////////////////////////////////
+// The MIT License (MIT)
+//
+// Copyright (c) 2020 Nicholas Frechette & Animation Compression Library contributors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+
+// Enable 64 bit file IO
+#define _FILE_OFFSET_BITS 64
+
+#include <sjson/writer.h>
+#include <sjson/parser.h>
+
+#include "acl/core/ansi_allocator.h"
+#include "acl/core/floating_point_exceptions.h"
+#include "acl/core/iallocator.h"
+#include "acl/compression/animation_clip.h"
+#include "acl/compression/skeleton.h"
+#include "acl/compression/skeleton_error_metric.h"
+#include "acl/compression/stream/write_decompression_stats.h"
+#include "acl/io/clip_reader.h"
+
+#include "acl/algorithm/uniformly_sampled/encoder.h"
+#include "acl/algorithm/uniformly_sampled/decoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sched.h>
+#include <sys/stat.h>
+
+using namespace acl;
+
+//////////////////////////////////////////////////////////////////////////
+// Mirrors the decompression settings used by the ACL Unreal Engine 4 codecs
+// so we measure the code the game actually runs.
+//////////////////////////////////////////////////////////////////////////
+
+// The 'Default' codec strips everything but the default formats
+using UE4DefaultDecompressionSettings = uniformly_sampled::DefaultDecompressionSettings;
+
+// The 'Custom' codec can use any format, nothing is stripped
+using UE4CustomDecompressionSettings = uniformly_sampled::DebugDecompressionSettings;
+
+// The 'Safe' codec keeps full precision rotations
+struct UE4SafeDecompressionSettings final : public UE4DefaultDecompressionSettings
+{
+	constexpr bool is_rotation_format_supported(RotationFormat8 format) const { return format == RotationFormat8::Quat_128; }
+	constexpr RotationFormat8 get_rotation_format(RotationFormat8 /*format*/) const { return RotationFormat8::Quat_128; }
+
+	constexpr RangeReductionFlags8 get_clip_range_reduction(RangeReductionFlags8 /*flags*/) const { return RangeReductionFlags8::Translations | RangeReductionFlags8::Scales; }
+
+	constexpr bool supports_mixed_packing() const { return true; }
+};
+
+enum class BenchmarkSettings
+{
+	Default,
+	Custom,
+	Safe,
+};
+
+static constexpr BenchmarkSettings k_benchmark_settings[] = { BenchmarkSettings::Default, BenchmarkSettings::Custom, BenchmarkSettings::Safe };
+
+static const char* get_benchmark_settings_name(BenchmarkSettings settings)
+{
+	switch (settings)
+	{
+	case BenchmarkSettings::Default:	return "default";
+	case BenchmarkSettings::Custom:		return "custom";
+	case BenchmarkSettings::Safe:		return "safe";
+	default:							return "<Invalid>";
+	}
+}
+
+static constexpr const char* k_acl_input_option = "-acl=";
+static constexpr const char* k_stats_output_option = "-stats=";
+static constexpr const char* k_settings_option = "-settings=";
+static constexpr const char* k_cpu_option = "-cpu=";
+static constexpr const char* k_exhaustive_option = "-exhaustive";
+static constexpr const char* k_help_option = "-help";
+
+struct Options
+{
+	const char*		input_path;
+	const char*		output_stats_filename;
+
+	bool			benchmark_settings[get_array_size(k_benchmark_settings)];
+
+	int				cpu_index;
+	bool			exhaustive_output;
+
+	Options()
+		: input_path(nullptr)
+		, output_stats_filename(nullptr)
+		, benchmark_settings{ true, true, true }
+		, cpu_index(2)
+		, exhaustive_output(false)
+	{}
+};
+
+static void print_usage()
+{
+	printf("Usage: acl_decompressor_benchmark -acl=<path> [-stats=<path>] [-settings=default,custom,safe] [-cpu=<index>] [-exhaustive]\n");
+	printf("  -acl=<path>: An ACL SJSON clip or a directory tree that contains some.\n");
+	printf("  -stats=<path>: The SJSON file the results are written to, stdout when omitted.\n");
+	printf("  -settings=<list>: The comma separated decompression settings to measure, all of them by default.\n");
+	printf("  -cpu=<index>: The CPU core the benchmark is pinned to, -1 to disable pinning. Defaults to 2.\n");
+	printf("  -exhaustive: Also outputs the time of every individual sample.\n");
+}
+
+static bool parse_options(int argc, char** argv, Options& options)
+{
+	for (int arg_index = 1; arg_index < argc; ++arg_index)
+	{
+		const char* argument = argv[arg_index];
+
+		size_t option_length = std::strlen(k_acl_input_option);
+		if (std::strncmp(argument, k_acl_input_option, option_length) == 0)
+		{
+			options.input_path = argument + option_length;
+			continue;
+		}
+
+		option_length = std::strlen(k_stats_output_option);
+		if (std::strncmp(argument, k_stats_output_option, option_length) == 0)
+		{
+			options.output_stats_filename = argument + option_length;
+			continue;
+		}
+
+		option_length = std::strlen(k_settings_option);
+		if (std::strncmp(argument, k_settings_option, option_length) == 0)
+		{
+			const std::string settings_list = std::string(",") + (argument + option_length) + ",";
+			for (size_t settings_index = 0; settings_index < get_array_size(k_benchmark_settings); ++settings_index)
+			{
+				const std::string settings_name = std::string(",") + get_benchmark_settings_name(k_benchmark_settings[settings_index]) + ",";
+				options.benchmark_settings[settings_index] = settings_list.find(settings_name) != std::string::npos;
+			}
+			continue;
+		}
+
+		option_length = std::strlen(k_cpu_option);
+		if (std::strncmp(argument, k_cpu_option, option_length) == 0)
+		{
+			options.cpu_index = std::atoi(argument + option_length);
+			continue;
+		}
+
+		if (std::strcmp(argument, k_exhaustive_option) == 0)
+		{
+			options.exhaustive_output = true;
+			continue;
+		}
+
+		if (std::strcmp(argument, k_help_option) == 0)
+		{
+			print_usage();
+			return false;
+		}
+
+		printf("Unrecognized option %s\n", argument);
+		print_usage();
+		return false;
+	}
+
+	if (options.input_path == nullptr || std::strlen(options.input_path) == 0)
+	{
+		printf("An input clip or directory must be provided\n");
+		print_usage();
+		return false;
+	}
+
+	return true;
+}
+
+static bool is_acl_sjson_file(const std::string& filename)
+{
+	const std::string extension = ".acl.sjson";
+	return filename.size() > extension.size() && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+// Sorted so that every run lists the clips in the same order and the outputs can be diffed
+static void find_acl_sjson_files(const std::string& path, std::vector<std::string>& out_filenames)
+{
+	struct stat path_stat;
+	if (stat(path.c_str(), &path_stat) != 0)
+		return;
+
+	if (!S_ISDIR(path_stat.st_mode))
+	{
+		if (is_acl_sjson_file(path))
+			out_filenames.push_back(path);
+		return;
+	}
+
+	DIR* dir = opendir(path.c_str());
+	if (dir == nullptr)
+		return;
+
+	std::vector<std::string> entries;
+	while (const dirent* entry = readdir(dir))
+	{
+		if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0)
+			entries.push_back(path + "/" + entry->d_name);
+	}
+
+	closedir(dir);
+
+	std::sort(entries.begin(), entries.end());
+	for (const std::string& entry : entries)
+		find_acl_sjson_files(entry, out_filenames);
+}
+
+static bool read_acl_sjson_file(IAllocator& allocator, const std::string& filename, sjson_raw_clip& out_raw_clip)
+{
+	std::FILE* file = std::fopen(filename.c_str(), "rb");
+	if (file == nullptr)
+		return false;
+
+	std::fseek(file, 0, SEEK_END);
+	const off_t file_size = ftello(file);
+	std::rewind(file);
+
+	if (file_size <= 0)
+	{
+		std::fclose(file);
+		return false;
+	}
+
+	char* sjson_file_buffer = allocate_type_array<char>(allocator, size_t(file_size));
+	const size_t read_size = std::fread(sjson_file_buffer, 1, size_t(file_size), file);
+	std::fclose(file);
+
+	bool success = false;
+	if (read_size == size_t(file_size))
+	{
+		ClipReader reader(allocator, sjson_file_buffer, size_t(file_size) - 1);
+		success = reader.get_file_type() == sjson_file_type::raw_clip && reader.read_raw_clip(out_raw_clip);
+
+		if (!success)
+		{
+			const ClipReaderError err = reader.get_error();
+			if (err.error != ClipReaderError::None)
+				std::fprintf(stderr, "Error on line %d column %d: %s\n", err.line, err.column, err.get_description());
+		}
+	}
+
+	deallocate_type_array(allocator, sjson_file_buffer, size_t(file_size));
+	return success;
+}
+
+static ISkeletalErrorMetric* create_error_metric(IAllocator& allocator, AdditiveClipFormat8 format)
+{
+	switch (format)
+	{
+	case AdditiveClipFormat8::Relative:
+		return allocate_type<AdditiveTransformErrorMetric<AdditiveClipFormat8::Relative>>(allocator);
+	case AdditiveClipFormat8::Additive0:
+		return allocate_type<AdditiveTransformErrorMetric<AdditiveClipFormat8::Additive0>>(allocator);
+	case AdditiveClipFormat8::Additive1:
+		return allocate_type<AdditiveTransformErrorMetric<AdditiveClipFormat8::Additive1>>(allocator);
+	case AdditiveClipFormat8::None:
+	default:
+		return allocate_type<TransformErrorMetric>(allocator);
+	}
+}
+
+// Compresses the clip the way the matching UE4 codec does so the decompression settings support it
+static CompressionSettings get_compression_settings(BenchmarkSettings benchmark_settings, const sjson_raw_clip& raw_clip)
+{
+	CompressionSettings settings = get_default_compression_settings();
+
+	switch (benchmark_settings)
+	{
+	case BenchmarkSettings::Default:
+	default:
+		break;
+	case BenchmarkSettings::Custom:
+		// The custom codec uses whatever the clip asks for
+		if (raw_clip.has_settings)
+			settings = raw_clip.settings;
+		break;
+	case BenchmarkSettings::Safe:
+		settings.rotation_format = RotationFormat8::Quat_128;
+		settings.range_reduction &= ~RangeReductionFlags8::Rotations;
+		settings.segmenting.range_reduction &= ~RangeReductionFlags8::Rotations;
+		break;
+	}
+
+	return settings;
+}
+
+static void benchmark_clip(IAllocator& allocator, const Options& options, const std::string& filename, const sjson_raw_clip& raw_clip, sjson::ArrayWriter& runs_writer)
+{
+	const AnimationClip& clip = *raw_clip.clip;
+	const std::string clip_name = filename.substr(filename.find_last_of('/') + 1, filename.size() - filename.find_last_of('/') - 1 - std::strlen(".acl.sjson"));
+
+	const StatLogging logging = options.exhaustive_output ? StatLogging::ExhaustiveDecompression : StatLogging::None;
+
+	for (size_t settings_index = 0; settings_index < get_array_size(k_benchmark_settings); ++settings_index)
+	{
+		if (!options.benchmark_settings[settings_index])
+			continue;
+
+		const BenchmarkSettings benchmark_settings = k_benchmark_settings[settings_index];
+
+		CompressionSettings settings = get_compression_settings(benchmark_settings, raw_clip);
+		settings.error_metric = create_error_metric(allocator, clip.get_additive_format());
+
+		CompressedClip* compressed_clip = nullptr;
+		OutputStats stats;
+		const ErrorResult error_result = uniformly_sampled::compress_clip(allocator, clip, settings, compressed_clip, stats);
+
+		if (error_result.any())
+		{
+			std::fprintf(stderr, "Failed to compress %s with the %s settings: %s\n", clip_name.c_str(), get_benchmark_settings_name(benchmark_settings), error_result.c_str());
+		}
+		else
+		{
+			runs_writer.push([&](sjson::ObjectWriter& writer)
+			{
+				writer["clip_name"] = clip_name.c_str();
+				writer["filename"] = filename.c_str();
+				writer["decompression_settings"] = get_benchmark_settings_name(benchmark_settings);
+				writer["rotation_format"] = get_rotation_format_name(settings.rotation_format);
+				writer["translation_format"] = get_vector_format_name(settings.translation_format);
+				writer["scale_format"] = get_vector_format_name(settings.scale_format);
+				writer["num_bones"] = clip.get_num_bones();
+				writer["num_samples"] = clip.get_num_samples();
+				writer["sample_rate"] = clip.get_sample_rate();
+				writer["compressed_size"] = compressed_clip->get_size();
+
+				switch (benchmark_settings)
+				{
+				case BenchmarkSettings::Default:
+				default:
+					write_decompression_performance_stats<UE4DefaultDecompressionSettings>(allocator, *compressed_clip, logging, writer);
+					break;
+				case BenchmarkSettings::Custom:
+					write_decompression_performance_stats<UE4CustomDecompressionSettings>(allocator, *compressed_clip, logging, writer);
+					break;
+				case BenchmarkSettings::Safe:
+					write_decompression_performance_stats<UE4SafeDecompressionSettings>(allocator, *compressed_clip, logging, writer);
+					break;
+				}
+			});
+
+			allocator.deallocate(compressed_clip, compressed_clip->get_size());
+		}
+
+		deallocate_type(allocator, settings.error_metric);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!parse_options(argc, argv, options))
+		return -1;
+
+	// Keep the benchmark on a single core so the cache state and timings are not disturbed by migrations
+	if (options.cpu_index >= 0)
+	{
+		cpu_set_t cpu_set;
+		CPU_ZERO(&cpu_set);
+		CPU_SET(options.cpu_index, &cpu_set);
+		if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+			std::fprintf(stderr, "Failed to pin the benchmark to CPU %d, results might be noisy\n", options.cpu_index);
+	}
+
+	std::vector<std::string> filenames;
+	find_acl_sjson_files(options.input_path, filenames);
+
+	if (filenames.empty())
+	{
+		printf("No ACL SJSON clips found in %s\n", options.input_path);
+		return -1;
+	}
+
+	std::FILE* output_stats_file = stdout;
+	if (options.output_stats_filename != nullptr && std::strlen(options.output_stats_filename) != 0)
+	{
+		output_stats_file = std::fopen(options.output_stats_filename, "w");
+		if (output_stats_file == nullptr)
+		{
+			printf("Failed to open output stats file: %s\n", options.output_stats_filename);
+			return -1;
+		}
+	}
+
+	// Enable floating point exceptions to detect errors
+	scope_enable_fp_exceptions fp_on;
+
+	ANSIAllocator allocator;
+	int result = 0;
+
+	{
+		sjson::FileStreamWriter stream_writer(output_stats_file);
+		sjson::Writer writer(stream_writer);
+
+		writer["runs"] = [&](sjson::ArrayWriter& runs_writer)
+		{
+			for (const std::string& filename : filenames)
+			{
+				sjson_raw_clip raw_clip;
+				if (!read_acl_sjson_file(allocator, filename, raw_clip))
+				{
+					std::fprintf(stderr, "Failed to read %s\n", filename.c_str());
+					result = -1;
+					continue;
+				}
+
+				benchmark_clip(allocator, options, filename, raw_clip, runs_writer);
+
+				// The clip does not own its additive base
+				deallocate_type(allocator, const_cast<AnimationClip*>(raw_clip.clip->get_additive_base()));
+			}
+		};
+	}
+
+	if (output_stats_file != stdout)
+		std::fclose(output_stats_file);
+
+	return result;
+}
@@ -0,0 +1,456 @@
+#include "BonamikBroadphase.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBonamikBroadphase, Log, All);
+
+namespace BonamikBroadphase {
+    static float GetSurfaceArea(const FBox& Box) {
+        const FVector Size = Box.Max - Box.Min;
+        return 2.0f * (Size.X * Size.Y + Size.Y * Size.Z + Size.Z * Size.X);
+    }
+}
+
+FBonamikBroadphase::FBonamikBroadphase(float InMargin) {
+    this->Root = INDEX_NONE;
+    this->FreeList = INDEX_NONE;
+    this->NumProxies = 0;
+    this->Margin = InMargin;
+}
+
+int32 FBonamikBroadphase::CreateProxy(const FBox& Box, uint32 Layer, uint32 PairMask, int32 UserData) {
+    const int32 Proxy = AllocateNode();
+    FNode& Node = Nodes[Proxy];
+    Node.Box = MakeFatBox(Box, FVector::ZeroVector);
+    Node.UserData = UserData;
+    Node.Layer = Layer;
+    Node.PairMask = PairMask;
+
+    InsertLeaf(Proxy);
+    MoveBuffer.Add(Proxy);
+    ++NumProxies;
+    return Proxy;
+}
+
+void FBonamikBroadphase::DestroyProxy(int32 Proxy) {
+    check(Nodes.IsValidIndex(Proxy) && Nodes[Proxy].Height == 0);
+
+    // The node is reused by the next proxy, so its pairs can't wait for UpdatePairs().
+    for (int32 PairIndex = Pairs.Num() - 1; PairIndex >= 0; --PairIndex) {
+        const FPair& Pair = Pairs[PairIndex];
+        if (Pair.ProxyA == Proxy || Pair.ProxyB == Proxy) {
+            PairKeys.Remove(MakePairKey(Pair.ProxyA, Pair.ProxyB));
+            Pairs.RemoveAtSwap(PairIndex, 1, false);
+        }
+    }
+    MoveBuffer.RemoveSwap(Proxy);
+
+    RemoveLeaf(Proxy);
+    FreeNode(Proxy);
+    --NumProxies;
+}
+
+bool FBonamikBroadphase::MoveProxy(int32 Proxy, const FBox& Box, const FVector& Displacement) {
+    check(Nodes.IsValidIndex(Proxy) && Nodes[Proxy].Height == 0);
+
+    const FBox FatBox = MakeFatBox(Box, Displacement);
+    const FBox& TreeBox = Nodes[Proxy].Box;
+    if (TreeBox.IsInside(Box)) {
+        // A fat box left behind by a fast move is shrunk once the proxy slows down.
+        if (FatBox.ExpandBy(4.0f * Margin).IsInside(TreeBox)) {
+            return false;
+        }
+    }
+
+    RemoveLeaf(Proxy);
+    Nodes[Proxy].Box = FatBox;
+    InsertLeaf(Proxy);
+    MoveBuffer.AddUnique(Proxy);
+    return true;
+}
+
+void FBonamikBroadphase::UpdatePairs() {
+    for (int32 PairIndex = Pairs.Num() - 1; PairIndex >= 0; --PairIndex) {
+        const FPair& Pair = Pairs[PairIndex];
+        if (!Nodes[Pair.ProxyA].Box.Intersect(Nodes[Pair.ProxyB].Box)) {
+            PairKeys.Remove(MakePairKey(Pair.ProxyA, Pair.ProxyB));
+            Pairs.RemoveAtSwap(PairIndex, 1, false);
+        }
+    }
+
+    for (int32 Proxy : MoveBuffer) {
+        Query(Nodes[Proxy].Box, [this, Proxy](int32 Other) {
+            if (Other != Proxy && ShouldPair(Proxy, Other)) {
+                bool bAlreadyInSet = false;
+                PairKeys.Add(MakePairKey(Proxy, Other), &bAlreadyInSet);
+                if (!bAlreadyInSet) {
+                    FPair& Pair = Pairs.AddDefaulted_GetRef();
+                    Pair.ProxyA = FMath::Min(Proxy, Other);
+                    Pair.ProxyB = FMath::Max(Proxy, Other);
+                }
+            }
+            return true;
+        });
+    }
+    MoveBuffer.Reset();
+}
+
+int32 FBonamikBroadphase::GetHeight() const {
+    return Root != INDEX_NONE ? Nodes[Root].Height : 0;
+}
+
+int32 FBonamikBroadphase::AllocateNode() {
+    int32 Node;
+    if (FreeList != INDEX_NONE) {
+        Node = FreeList;
+        FreeList = Nodes[Node].Parent;
+    } else {
+        Node = Nodes.AddDefaulted();
+    }
+
+    FNode& NewNode = Nodes[Node];
+    NewNode.Parent = INDEX_NONE;
+    NewNode.Child1 = INDEX_NONE;
+    NewNode.Child2 = INDEX_NONE;
+    NewNode.Height = 0;
+    NewNode.UserData = INDEX_NONE;
+    NewNode.Layer = 0;
+    NewNode.PairMask = 0;
+    return Node;
+}
+
+void FBonamikBroadphase::FreeNode(int32 Node) {
+    Nodes[Node].Parent = FreeList;
+    Nodes[Node].Height = INDEX_NONE;
+    FreeList = Node;
+}
+
+void FBonamikBroadphase::InsertLeaf(int32 Leaf) {
+    using namespace BonamikBroadphase;
+
+    if (Root == INDEX_NONE) {
+        Root = Leaf;
+        Nodes[Leaf].Parent = INDEX_NONE;
+        return;
+    }
+
+    // Descend towards the sibling with the lowest surface area heuristic cost.
+    const FBox LeafBox = Nodes[Leaf].Box;
+    int32 Index = Root;
+    while (!Nodes[Index].IsLeaf()) {
+        const FNode& Node = Nodes[Index];
+        const float Area = GetSurfaceArea(Node.Box);
+        const float CombinedArea = GetSurfaceArea(Node.Box + LeafBox);
+
+        // Cost of a new parent for this node and the leaf, and the minimum cost pushed down to the children.
+        const float Cost = 2.0f * CombinedArea;
+        const float InheritanceCost = 2.0f * (CombinedArea - Area);
+
+        float ChildCosts[2];
+        const int32 Children[2] = { Node.Child1, Node.Child2 };
+        for (int32 ChildIndex = 0; ChildIndex < 2; ++ChildIndex) {
+            const FNode& Child = Nodes[Children[ChildIndex]];
+            const float ChildArea = GetSurfaceArea(LeafBox + Child.Box);
+            ChildCosts[ChildIndex] = (Child.IsLeaf() ? ChildArea : ChildArea - GetSurfaceArea(Child.Box)) + InheritanceCost;
+        }
+
+        if (Cost < ChildCosts[0] && Cost < ChildCosts[1]) {
+            break;
+        }
+        Index = ChildCosts[0] < ChildCosts[1] ? Children[0] : Children[1];
+    }
+
+    const int32 Sibling = Index;
+    const int32 OldParent = Nodes[Sibling].Parent;
+    const int32 NewParent = AllocateNode();
+    Nodes[NewParent].Parent = OldParent;
+    Nodes[NewParent].Box = LeafBox + Nodes[Sibling].Box;
+    Nodes[NewParent].Height = Nodes[Sibling].Height + 1;
+    Nodes[NewParent].Child1 = Sibling;
+    Nodes[NewParent].Child2 = Leaf;
+    Nodes[Sibling].Parent = NewParent;
+    Nodes[Leaf].Parent = NewParent;
+
+    if (OldParent == INDEX_NONE) {
+        Root = NewParent;
+    } else if (Nodes[OldParent].Child1 == Sibling) {
+        Nodes[OldParent].Child1 = NewParent;
+    } else {
+        Nodes[OldParent].Child2 = NewParent;
+    }
+
+    for (Index = Nodes[Leaf].Parent; Index != INDEX_NONE; Index = Nodes[Index].Parent) {
+        Index = Balance(Index);
+        Refit(Index);
+    }
+}
+
+void FBonamikBroadphase::RemoveLeaf(int32 Leaf) {
+    if (Leaf == Root) {
+        Root = INDEX_NONE;
+        return;
+    }
+
+    const int32 Parent = Nodes[Leaf].Parent;
+    const int32 GrandParent = Nodes[Parent].Parent;
+    const int32 Sibling = Nodes[Parent].Child1 == Leaf ? Nodes[Parent].Child2 : Nodes[Parent].Child1;
+    FreeNode(Parent);
+
+    if (GrandParent == INDEX_NONE) {
+        Root = Sibling;
+        Nodes[Sibling].Parent = INDEX_NONE;
+        return;
+    }
+
+    if (Nodes[GrandParent].Child1 == Parent) {
+        Nodes[GrandParent].Child1 = Sibling;
+    } else {
+        Nodes[GrandParent].Child2 = Sibling;
+    }
+    Nodes[Sibling].Parent = GrandParent;
+
+    for (int32 Index = GrandParent; Index != INDEX_NONE; Index = Nodes[Index].Parent) {
+        Index = Balance(Index);
+        Refit(Index);
+    }
+}
+
+int32 FBonamikBroadphase::Balance(int32 IndexA) {
+    // Rotates the taller child of A up when the heights of A's children differ by more than one; returns the node
+    // that took A's place.
+    FNode& A = Nodes[IndexA];
+    if (A.IsLeaf() || A.Height < 2) {
+        return IndexA;
+    }
+
+    const int32 IndexB = A.Child1;
+    const int32 IndexC = A.Child2;
+    FNode& B = Nodes[IndexB];
+    FNode& C = Nodes[IndexC];
+    const int32 Imbalance = C.Height - B.Height;
+
+    if (Imbalance > 1) {
+        const int32 IndexF = C.Child1;
+        const int32 IndexG = C.Child2;
+        FNode& F = Nodes[IndexF];
+        FNode& G = Nodes[IndexG];
+
+        C.Child1 = IndexA;
+        C.Parent = A.Parent;
+        A.Parent = IndexC;
+        if (C.Parent == INDEX_NONE) {
+            Root = IndexC;
+        } else if (Nodes[C.Parent].Child1 == IndexA) {
+            Nodes[C.Parent].Child1 = IndexC;
+        } else {
+            Nodes[C.Parent].Child2 = IndexC;
+        }
+
+        if (F.Height > G.Height) {
+            C.Child2 = IndexF;
+            A.Child2 = IndexG;
+            G.Parent = IndexA;
+            A.Box = B.Box + G.Box;
+            C.Box = A.Box + F.Box;
+            A.Height = 1 + FMath::Max(B.Height, G.Height);
+            C.Height = 1 + FMath::Max(A.Height, F.Height);
+        } else {
+            C.Child2 = IndexG;
+            A.Child2 = IndexF;
+            F.Parent = IndexA;
+            A.Box = B.Box + F.Box;
+            C.Box = A.Box + G.Box;
+            A.Height = 1 + FMath::Max(B.Height, F.Height);
+            C.Height = 1 + FMath::Max(A.Height, G.Height);
+        }
+        return IndexC;
+    }
+
+    if (Imbalance < -1) {
+        const int32 IndexD = B.Child1;
+        const int32 IndexE = B.Child2;
+        FNode& D = Nodes[IndexD];
+        FNode& E = Nodes[IndexE];
+
+        B.Child1 = IndexA;
+        B.Parent = A.Parent;
+        A.Parent = IndexB;
+        if (B.Parent == INDEX_NONE) {
+            Root = IndexB;
+        } else if (Nodes[B.Parent].Child1 == IndexA) {
+            Nodes[B.Parent].Child1 = IndexB;
+        } else {
+            Nodes[B.Parent].Child2 = IndexB;
+        }
+
+        if (D.Height > E.Height) {
+            B.Child2 = IndexD;
+            A.Child1 = IndexE;
+            E.Parent = IndexA;
+            A.Box = C.Box + E.Box;
+            B.Box = A.Box + D.Box;
+            A.Height = 1 + FMath::Max(C.Height, E.Height);
+            B.Height = 1 + FMath::Max(A.Height, D.Height);
+        } else {
+            B.Child2 = IndexE;
+            A.Child1 = IndexD;
+            D.Parent = IndexA;
+            A.Box = C.Box + D.Box;
+            B.Box = A.Box + E.Box;
+            A.Height = 1 + FMath::Max(C.Height, D.Height);
+            B.Height = 1 + FMath::Max(A.Height, E.Height);
+        }
+        return IndexB;
+    }
+
+    return IndexA;
+}
+
+void FBonamikBroadphase::Refit(int32 Node) {
+    FNode& Parent = Nodes[Node];
+    const FNode& Child1 = Nodes[Parent.Child1];
+    const FNode& Child2 = Nodes[Parent.Child2];
+    Parent.Height = 1 + FMath::Max(Child1.Height, Child2.Height);
+    Parent.Box = Child1.Box + Child2.Box;
+}
+
+FBox FBonamikBroadphase::MakeFatBox(const FBox& Box, const FVector& Displacement) const {
+    // Stretched twice the displacement ahead, so a proxy moving steadily is reinserted every few steps only.
+    FBox FatBox = Box.ExpandBy(Margin);
+    const FVector Ahead = Displacement * 2.0f;
+    for (int32 Axis = 0; Axis < 3; ++Axis) {
+        if (Ahead[Axis] < 0.0f) {
+            FatBox.Min[Axis] += Ahead[Axis];
+        } else {
+            FatBox.Max[Axis] += Ahead[Axis];
+        }
+    }
+    return FatBox;
+}
+
+bool FBonamikBroadphase::ShouldPair(int32 ProxyA, int32 ProxyB) const {
+    const FNode& A = Nodes[ProxyA];
+    const FNode& B = Nodes[ProxyB];
+    return (A.Layer & B.PairMask) != 0 && (B.Layer & A.PairMask) != 0;
+}
+
+namespace BonamikBroadphase {
+    // Particle clouds (one proxy each, like a character's receivers) wander through a field of moving shapes; every
+    // frame counts the particle / shape boxes that overlap, once by testing every particle against every shape and
+    // once through the broadphase pairs.
+    static void Benchmark(const TArray<FString>& Args) {
+        const int32 NumShapes = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 256;
+        const int32 NumClouds = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 32;
+        const int32 NumFrames = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 120;
+        const int32 ParticlesPerCloud = 64;
+        const float WorldExtent = 3000.0f;
+        const float ParticleRadius = 3.0f;
+
+        FRandomStream Random(0xB0A41C);
+        auto RandomVector = [&Random](float Extent) {
+            return FVector(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent));
+        };
+
+        TArray<FVector> CloudCenters;
+        TArray<FVector> CloudVelocities;
+        TArray<FVector> ParticleOffsets;
+        for (int32 Cloud = 0; Cloud < NumClouds; ++Cloud) {
+            CloudCenters.Add(RandomVector(WorldExtent));
+            CloudVelocities.Add(RandomVector(20.0f));
+            for (int32 Particle = 0; Particle < ParticlesPerCloud; ++Particle) {
+                ParticleOffsets.Add(RandomVector(60.0f));
+            }
+        }
+
+        TArray<FVector> ShapeCenters;
+        TArray<FVector> ShapeVelocities;
+        TArray<float> ShapeRadii;
+        for (int32 Shape = 0; Shape < NumShapes; ++Shape) {
+            ShapeCenters.Add(RandomVector(WorldExtent));
+            ShapeVelocities.Add(RandomVector(5.0f));
+            ShapeRadii.Add(Random.FRandRange(20.0f, 80.0f));
+        }
+
+        auto GetShapeBox = [&](int32 Shape) {
+            return FBox(ShapeCenters[Shape] - FVector(ShapeRadii[Shape]), ShapeCenters[Shape] + FVector(ShapeRadii[Shape]));
+        };
+        auto GetCloudBox = [&](int32 Cloud) {
+            return FBox(CloudCenters[Cloud] - FVector(60.0f + ParticleRadius), CloudCenters[Cloud] + FVector(60.0f + ParticleRadius));
+        };
+        auto CountContacts = [&](int32 Cloud, int32 Shape) {
+            const FBox ShapeBox = GetShapeBox(Shape).ExpandBy(ParticleRadius);
+            int32 Contacts = 0;
+            for (int32 Particle = 0; Particle < ParticlesPerCloud; ++Particle) {
+                Contacts += ShapeBox.IsInsideOrOn(CloudCenters[Cloud] + ParticleOffsets[Cloud * ParticlesPerCloud + Particle]) ? 1 : 0;
+            }
+            return Contacts;
+        };
+
+        FBonamikBroadphase Broadphase;
+        TArray<int32> CloudProxies;
+        TArray<int32> ShapeProxies;
+        for (int32 Cloud = 0; Cloud < NumClouds; ++Cloud) {
+            CloudProxies.Add(Broadphase.CreateProxy(GetCloudBox(Cloud), 1, 2, Cloud));
+        }
+        for (int32 Shape = 0; Shape < NumShapes; ++Shape) {
+            ShapeProxies.Add(Broadphase.CreateProxy(GetShapeBox(Shape), 2, 1, Shape));
+        }
+
+        double BruteSeconds = 0.0;
+        double BroadphaseSeconds = 0.0;
+        int64 BruteContacts = 0;
+        int64 BroadphaseContacts = 0;
+        int64 NumPairs = 0;
+        int64 NumReinserts = 0;
+        int32 NumMismatches = 0;
+        for (int32 Frame = 0; Frame < NumFrames; ++Frame) {
+            for (int32 Cloud = 0; Cloud < NumClouds; ++Cloud) {
+                CloudCenters[Cloud] += CloudVelocities[Cloud];
+            }
+            for (int32 Shape = 0; Shape < NumShapes; ++Shape) {
+                ShapeCenters[Shape] += ShapeVelocities[Shape];
+            }
+
+            double StartTime = FPlatformTime::Seconds();
+            int32 FrameBruteContacts = 0;
+            for (int32 Cloud = 0; Cloud < NumClouds; ++Cloud) {
+                for (int32 Shape = 0; Shape < NumShapes; ++Shape) {
+                    FrameBruteContacts += CountContacts(Cloud, Shape);
+                }
+            }
+            BruteSeconds += FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            for (int32 Cloud = 0; Cloud < NumClouds; ++Cloud) {
+                NumReinserts += Broadphase.MoveProxy(CloudProxies[Cloud], GetCloudBox(Cloud), CloudVelocities[Cloud]) ? 1 : 0;
+            }
+            for (int32 Shape = 0; Shape < NumShapes; ++Shape) {
+                NumReinserts += Broadphase.MoveProxy(ShapeProxies[Shape], GetShapeBox(Shape), ShapeVelocities[Shape]) ? 1 : 0;
+            }
+            Broadphase.UpdatePairs();
+            int32 FrameBroadphaseContacts = 0;
+            for (const FBonamikBroadphase::FPair& Pair : Broadphase.GetPairs()) {
+                const bool bCloudFirst = Broadphase.GetLayer(Pair.ProxyA) == 1;
+                const int32 Cloud = Broadphase.GetUserData(bCloudFirst ? Pair.ProxyA : Pair.ProxyB);
+                const int32 Shape = Broadphase.GetUserData(bCloudFirst ? Pair.ProxyB : Pair.ProxyA);
+                FrameBroadphaseContacts += CountContacts(Cloud, Shape);
+            }
+            BroadphaseSeconds += FPlatformTime::Seconds() - StartTime;
+
+            BruteContacts += FrameBruteContacts;
+            BroadphaseContacts += FrameBroadphaseContacts;
+            NumPairs += Broadphase.GetPairs().Num();
+            NumMismatches += FrameBruteContacts != FrameBroadphaseContacts ? 1 : 0;
+        }
+
+        UE_LOG(LogBonamikBroadphase, Display, TEXT("%d shapes, %d x %d particles, %d frames: brute force %.3f ms/frame (%lld contacts), broadphase %.3f ms/frame (%lld contacts, %.1f pairs, %.1f reinserts, height %d), %d mismatching frames"),
+            NumShapes, NumClouds, ParticlesPerCloud, NumFrames, BruteSeconds * 1000.0 / NumFrames, BruteContacts, BroadphaseSeconds * 1000.0 / NumFrames, BroadphaseContacts,
+            (double)NumPairs / NumFrames, (double)NumReinserts / NumFrames, Broadphase.GetHeight(), NumMismatches);
+    }
+}
+
+static FAutoConsoleCommand CmdBonamikBroadphaseBenchmark(
+    TEXT("bonamik.Broadphase.Benchmark"),
+    TEXT("Compares brute force and broadphase particle / shape culling on a synthetic scene. Usage: bonamik.Broadphase.Benchmark [NumShapes] [NumClouds] [NumFrames]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BonamikBroadphase::Benchmark));
@@ -0,0 +1,179 @@
+#include "BonamikLodScheduler.h"
+
+// Weight of the newest measurement in MsPerCostUnit.
+static const float CostCalibrationRate = 0.10f;
+
+FBonamikLodScheduler::FView::FView() {
+    this->Location = FVector::ZeroVector;
+    this->TanHalfFov = 0.00f;
+}
+
+FBonamikLodScheduler::FSettings::FSettings() {
+    this->bEnable = true;
+    this->BudgetMs = 2.00f;
+    this->RestoreDelay = 0.50f;
+}
+
+FBonamikLodScheduler::FStats::FStats() {
+    this->BudgetMs = 0.00f;
+    this->PredictedMs = 0.00f;
+    this->MeasuredMs = 0.00f;
+    for (int32& Count : this->NumInstances) {
+        Count = 0;
+    }
+}
+
+FBonamikLodScheduler::FInstanceState::FInstanceState() {
+    this->Importance = 1.00f;
+    this->ScreenSizeOverride = -1.00f;
+    this->TimeSinceChange = 0.00f;
+}
+
+FBonamikLodScheduler::FBonamikLodScheduler() {
+    this->MsPerCostUnit = 0.00f;
+}
+
+void FBonamikLodScheduler::AddInstance(int32 Handle) {
+    if (Handle == INDEX_NONE) {
+        return;
+    }
+    if (States.Num() <= Handle) {
+        States.SetNum(Handle + 1);
+    }
+    States[Handle] = FInstanceState();
+}
+
+void FBonamikLodScheduler::RemoveInstance(int32 Handle) {
+    if (States.IsValidIndex(Handle)) {
+        States[Handle] = FInstanceState();
+    }
+}
+
+void FBonamikLodScheduler::SetInstanceImportance(int32 Handle, float Importance) {
+    if (States.IsValidIndex(Handle)) {
+        States[Handle].Importance = FMath::Max(Importance, 0.00f);
+    }
+}
+
+void FBonamikLodScheduler::SetInstanceScreenSize(int32 Handle, float ScreenSize) {
+    if (States.IsValidIndex(Handle)) {
+        States[Handle].ScreenSizeOverride = ScreenSize;
+    }
+}
+
+void FBonamikLodScheduler::Reset() {
+    States.Reset();
+    Stats = FStats();
+    MsPerCostUnit = 0.00f;
+}
+
+int32 FBonamikLodScheduler::GetStepCost(const FBonamikSceneSolver& Solver, int32 NumHandles) {
+    int32 Cost = 0;
+    for (int32 Handle = 0; Handle < NumHandles; ++Handle) {
+        Cost += Solver.GetInstanceCost(Handle, Solver.GetInstanceLod(Handle));
+    }
+    return Cost;
+}
+
+void FBonamikLodScheduler::Update(FBonamikSceneSolver& Solver, const FView& View, const FSettings& Settings, float DeltaTime, int32 NumSteps) {
+    struct FCandidate {
+        int32 Handle;
+        float Priority;
+        EBonamikSolverLod Target;
+    };
+
+    // Start everything at full quality, except what the asset itself culls.
+    TArray<FCandidate> Candidates;
+    int32 TargetCost = 0;
+    for (int32 Handle = 0; Handle < States.Num(); ++Handle) {
+        if (!Solver.IsValidInstance(Handle)) {
+            continue;
+        }
+
+        FInstanceState& State = States[Handle];
+        State.TimeSinceChange += DeltaTime;
+
+        FVector Center;
+        float Radius;
+        Solver.GetInstanceBounds(Handle, Center, Radius);
+        const float Distance = FVector::Dist(Center, View.Location);
+
+        // Without a camera everything counts as full screen.
+        float ScreenSize = 1.00f;
+        if (State.ScreenSizeOverride >= 0.00f) {
+            ScreenSize = State.ScreenSizeOverride;
+        } else if (View.TanHalfFov > 0.00f) {
+            ScreenSize = Radius / FMath::Max(Distance * View.TanHalfFov, 1.00f);
+        }
+
+        const float LodDistance = Solver.GetInstanceLodDistance(Handle);
+        const bool bCulled = ScreenSize < Solver.GetInstanceMinScreenSize(Handle) || (LodDistance > 0.00f && View.TanHalfFov > 0.00f && Distance > LodDistance);
+
+        FCandidate& Candidate = Candidates.AddDefaulted_GetRef();
+        Candidate.Handle = Handle;
+        Candidate.Priority = ScreenSize * State.Importance;
+        Candidate.Target = bCulled ? EBonamikSolverLod::Frozen : EBonamikSolverLod::Full;
+        TargetCost += Solver.GetInstanceCost(Handle, Candidate.Target);
+    }
+
+    // Degrade one level at a time over the whole scene, least important first, so the important instances are only
+    // touched once everything below them is already degraded. Levels go by fidelity, each one costs less than the last.
+    const float MsPerFrameCostUnit = MsPerCostUnit * (float)FMath::Max(NumSteps, 1);
+    if (Settings.bEnable && MsPerFrameCostUnit > 0.00f) {
+        Candidates.Sort([](const FCandidate& A, const FCandidate& B) {
+            return A.Priority < B.Priority;
+        });
+
+        for (int32 Level = (int32)EBonamikSolverLod::ReducedIterations; Level < (int32)EBonamikSolverLod::Num; ++Level) {
+            for (FCandidate& Candidate : Candidates) {
+                if ((float)TargetCost * MsPerFrameCostUnit <= Settings.BudgetMs) {
+                    break;
+                }
+
+                if ((int32)Candidate.Target < Level) {
+                    TargetCost += Solver.GetInstanceCost(Candidate.Handle, (EBonamikSolverLod)Level) - Solver.GetInstanceCost(Candidate.Handle, Candidate.Target);
+                    Candidate.Target = (EBonamikSolverLod)Level;
+                }
+            }
+        }
+    }
+
+    // Degrading applies at once; improving goes one level at a time and only after the current one has settled.
+    for (const FCandidate& Candidate : Candidates) {
+        FInstanceState& State = States[Candidate.Handle];
+        const EBonamikSolverLod Current = Solver.GetInstanceLod(Candidate.Handle);
+        EBonamikSolverLod Next = Current;
+        if (Candidate.Target > Current) {
+            Next = Candidate.Target;
+        } else if (Candidate.Target < Current && State.TimeSinceChange >= Settings.RestoreDelay) {
+            Next = (EBonamikSolverLod)((int32)Current - 1);
+        }
+
+        if (Next != Current) {
+            Solver.SetInstanceLod(Candidate.Handle, Next);
+            State.TimeSinceChange = 0.00f;
+        }
+    }
+
+    Stats.BudgetMs = Settings.BudgetMs;
+    Stats.PredictedMs = (float)GetStepCost(Solver, States.Num()) * MsPerCostUnit * (float)NumSteps;
+    for (int32& Count : Stats.NumInstances) {
+        Count = 0;
+    }
+    for (const FCandidate& Candidate : Candidates) {
+        ++Stats.NumInstances[(int32)Solver.GetInstanceLod(Candidate.Handle)];
+    }
+}
+
+void FBonamikLodScheduler::Calibrate(const FBonamikSceneSolver& Solver, float MeasuredMs, int32 NumSteps, int32 PreRollCost) {
+    if (NumSteps <= 0) {
+        return;
+    }
+
+    Stats.MeasuredMs = MeasuredMs;
+    const int32 Cost = GetStepCost(Solver, States.Num()) * NumSteps + FMath::Max(PreRollCost, 0);
+    if (Cost > 0) {
+        const float Sample = MeasuredMs / (float)Cost;
+        MsPerCostUnit = MsPerCostUnit > 0.00f ? FMath::Lerp(MsPerCostUnit, Sample, CostCalibrationRate) : Sample;
+    }
+}
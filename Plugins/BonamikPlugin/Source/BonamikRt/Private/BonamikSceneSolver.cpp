@@ -0,0 +1,1320 @@
+#include "BonamikSceneSolver.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "SQEX_BonamikAsset_v2.h"
+
+namespace BonamikSceneSolver {
+    static const float Epsilon = 1.e-8f;
+
+    static FORCEINLINE VectorRegister Gather(const TArray<float>& Source, const int32* Indices) {
+        return MakeVectorRegister(Source[Indices[0]], Source[Indices[1]], Source[Indices[2]], Source[Indices[3]]);
+    }
+
+    static FORCEINLINE void Scatter(TArray<float>& Dest, const int32* Indices, VectorRegister Value) {
+        MS_ALIGN(16) float Lanes[4] GCC_ALIGN(16);
+        VectorStoreAligned(Value, Lanes);
+        Dest[Indices[0]] = Lanes[0];
+        Dest[Indices[1]] = Lanes[1];
+        Dest[Indices[2]] = Lanes[2];
+        Dest[Indices[3]] = Lanes[3];
+    }
+
+    static FORCEINLINE VectorRegister Dot3(VectorRegister AX, VectorRegister AY, VectorRegister AZ, VectorRegister BX, VectorRegister BY, VectorRegister BZ) {
+        return VectorMultiplyAdd(AZ, BZ, VectorMultiplyAdd(AY, BY, VectorMultiply(AX, BX)));
+    }
+
+    // All bits set in the lanes whose constraint still runs at this solver / constraint iteration.
+    static FORCEINLINE VectorRegister IterationMask(const float* SolverIterations, const float* Iterations, VectorRegister SolverIteration, VectorRegister Iteration) {
+        return VectorBitwiseAnd(VectorCompareGT(VectorLoad(SolverIterations), SolverIteration), VectorCompareGT(VectorLoad(Iterations), Iteration));
+    }
+
+    // Greedy coloring: the first batch in which none of the given particles is used yet.
+    static int32 AssignBatch(TArray<TBitArray<>>& UsedParticles, int32 NumParticles, int32 ParticleA, int32 ParticleB) {
+        for (int32 Batch = 0; ; ++Batch) {
+            if (Batch == UsedParticles.Num()) {
+                UsedParticles.Emplace(false, NumParticles);
+            }
+            TBitArray<>& Used = UsedParticles[Batch];
+            if (!Used[ParticleA] && (ParticleB == INDEX_NONE || !Used[ParticleB])) {
+                Used[ParticleA] = true;
+                if (ParticleB != INDEX_NONE) {
+                    Used[ParticleB] = true;
+                }
+                return Batch;
+            }
+        }
+    }
+
+    static void PadToLanes(TArray<int32>& Indices, int32 Scratch) {
+        while (Indices.Num() % 4 != 0) {
+            Indices.Add(Scratch);
+        }
+    }
+
+    static void PadToLanes(TArray<float>& Values) {
+        while (Values.Num() % 4 != 0) {
+            Values.Add(0.0f);
+        }
+    }
+
+    static int32 GetIterations(const FSQEX_BonamikSolverDesc_v2* Solver, uint32 FSQEX_BonamikSolverDesc_v2::*Member) {
+        return Solver != NULL ? FMath::Max(1, (int32)(Solver->*Member)) : 1;
+    }
+
+    static FORCEINLINE float GetReducedIterations(float Iterations) {
+        return (float)(((int32)Iterations + 1) / 2);
+    }
+
+    // Broadphase layers.
+    static const uint32 InstanceLayer = 1 << 0;
+    static const uint32 TemporaryShapeLayer = 1 << 1;
+
+    static FBox GetTemporaryShapeBounds(const FBonamikSceneSolver::FTemporaryShape& Shape) {
+        FVector Extent;
+        switch (Shape.Type) {
+        case EBonamikTemporaryShape::Sphere:
+            Extent = FVector(Shape.Radius);
+            break;
+        case EBonamikTemporaryShape::Capsule:
+            Extent = FVector(Shape.Radius, Shape.Radius, FMath::Max(Shape.HalfHeight, Shape.Radius));
+            break;
+        default:
+            Extent = Shape.BoxExtent;
+            break;
+        }
+        return FBox(-Extent, Extent).TransformBy(Shape.Transform);
+    }
+
+    // Moves a sphere at Local (in shape space) out of the shape; false when they don't touch.
+    static bool PushOut(const FBonamikSceneSolver::FTemporaryShape& Shape, const FVector& Local, float Radius, FVector& OutLocal) {
+        FVector Closest = FVector::ZeroVector;
+        float Distance = Radius;
+        switch (Shape.Type) {
+        case EBonamikTemporaryShape::Capsule: {
+            const float HalfSegment = FMath::Max(Shape.HalfHeight - Shape.Radius, 0.0f);
+            Closest.Z = FMath::Clamp(Local.Z, -HalfSegment, HalfSegment);
+            Distance += Shape.Radius;
+            break;
+        }
+        case EBonamikTemporaryShape::Box: {
+            Closest = FVector(FMath::Clamp(Local.X, -Shape.BoxExtent.X, Shape.BoxExtent.X), FMath::Clamp(Local.Y, -Shape.BoxExtent.Y, Shape.BoxExtent.Y), FMath::Clamp(Local.Z, -Shape.BoxExtent.Z, Shape.BoxExtent.Z));
+            if (Closest == Local) {
+                // Inside: leave through the nearest face.
+                int32 Axis = 0;
+                for (int32 Other = 1; Other < 3; ++Other) {
+                    if (Shape.BoxExtent[Other] - FMath::Abs(Local[Other]) < Shape.BoxExtent[Axis] - FMath::Abs(Local[Axis])) {
+                        Axis = Other;
+                    }
+                }
+                OutLocal = Local;
+                OutLocal[Axis] = (Local[Axis] < 0.0f ? -1.0f : 1.0f) * (Shape.BoxExtent[Axis] + Radius);
+                return true;
+            }
+            break;
+        }
+        default:
+            Distance += Shape.Radius;
+            break;
+        }
+
+        const FVector Delta = Local - Closest;
+        const float DistanceSquared = Delta.SizeSquared();
+        if (DistanceSquared >= Distance * Distance) {
+            return false;
+        }
+        OutLocal = Closest + (DistanceSquared > Epsilon ? Delta * (Distance / FMath::Sqrt(DistanceSquared)) : FVector(0.0f, 0.0f, Distance));
+        return true;
+    }
+}
+
+FBonamikSceneSolver::FTemporaryShape::FTemporaryShape() {
+    this->Type = EBonamikTemporaryShape::Sphere;
+    this->Transform = FTransform::Identity;
+    this->BoxExtent = FVector::ZeroVector;
+    this->Radius = 0.0f;
+    this->HalfHeight = 0.0f;
+    this->OwnerHandle = INDEX_NONE;
+}
+
+FBonamikSceneSolver::FSettings::FSettings() {
+    this->TimeStep = 1.0f / 30.0f;
+    this->SubSteps = 1;
+    this->Gravity = FVector(0.0f, 0.0f, -980.0f);
+    this->OverrideLinkIteration = 0;
+    this->OverrideCollisionIteration = 0;
+    this->OverrideSolverIteration = 0;
+    this->MinParticlesPerIsland = 256;
+    this->bMultiThread = true;
+}
+
+FBonamikSceneSolver::FBonamikSceneSolver() {
+    this->NumLiveShapes = 0;
+    this->NumLiveInstances = 0;
+    this->BuiltIslandTarget = 0;
+    this->NumPreRollPasses = 0;
+    this->PreRollCost = 0;
+    this->StepCounter = 0;
+    this->bIslandsDirty = false;
+}
+
+int32 FBonamikSceneSolver::AddInstance(const USQEX_BonamikAsset_v2& Asset, const TArray<FVector>& ReferencePose) {
+    const TArray<FSQEX_BonamikBodyDesc_v2>& Bodies = Asset.m_Bodies;
+    const int32 NumBodies = Bodies.Num();
+    if (NumBodies == 0 || ReferencePose.Num() != NumBodies) {
+        return INDEX_NONE;
+    }
+
+    TMap<uint32, const FSQEX_BonamikSolverDesc_v2*> SolversByGroup;
+    for (const FSQEX_BonamikSolverDesc_v2& Solver : Asset.m_Solvers) {
+        SolversByGroup.Add(Solver.m_GroupId, &Solver);
+    }
+
+    FInstance Instance;
+    Instance.InvMass.SetNumUninitialized(NumBodies);
+    Instance.Decay.SetNumUninitialized(NumBodies);
+    Instance.WindDrag.SetNumUninitialized(NumBodies);
+    Instance.Wind.SetNumZeroed(NumBodies);
+    Instance.bAffectedByWind = false;
+
+    // Bodies of disabled groups are driven by animation like kinematic ones.
+    TArray<const FSQEX_BonamikSolverDesc_v2*> BodySolvers;
+    BodySolvers.SetNumUninitialized(NumBodies);
+    int32 NumDynamic = 0;
+    for (int32 BodyIndex = 0; BodyIndex < NumBodies; ++BodyIndex) {
+        const FSQEX_BonamikBodyDesc_v2& Body = Bodies[BodyIndex];
+        const FSQEX_BonamikSolverDesc_v2* const* Solver = SolversByGroup.Find(Body.m_GroupId);
+        BodySolvers[BodyIndex] = Solver != NULL ? *Solver : NULL;
+
+        const bool bDynamic = !Body.m_IsKinematic && BodySolvers[BodyIndex] != NULL && BodySolvers[BodyIndex]->m_IsEnable;
+        Instance.InvMass[BodyIndex] = bDynamic ? (Body.m_Mass > 0.0f ? 1.0f / Body.m_Mass : 1.0f) : 0.0f;
+        Instance.Decay[BodyIndex] = 1.0f - FMath::Clamp(Body.m_Damping, 0.0f, 1.0f);
+        Instance.WindDrag[BodyIndex] = bDynamic ? FMath::Max(Body.m_WindDrag, 0.0f) : 0.0f;
+        Instance.bAffectedByWind |= Instance.WindDrag[BodyIndex] > 0.0f;
+        NumDynamic += bDynamic ? 1 : 0;
+    }
+
+    if (NumDynamic == 0) {
+        return INDEX_NONE;
+    }
+
+    TArray<TBitArray<>> UsedLinkParticles;
+    TArray<TBitArray<>> UsedConeParticles;
+    TArray<bool> IsReceiver;
+    IsReceiver.SetNumZeroed(NumBodies);
+
+    // Constraints are colored in the order of the asset's own batch numbers so its batching survives where it can.
+    TArray<const FSQEX_BonamikLinkDesc_v2*> Links;
+    for (const FSQEX_BonamikLinkDesc_v2& Link : Asset.m_Links) {
+        Links.Add(&Link);
+    }
+    Links.StableSort([](const FSQEX_BonamikLinkDesc_v2& A, const FSQEX_BonamikLinkDesc_v2& B) {
+        return A.m_LinkBatchNo < B.m_LinkBatchNo;
+    });
+
+    for (const FSQEX_BonamikLinkDesc_v2* Link : Links) {
+        // The ids are unsigned; compare them before the cast so ids past MAX_int32 don't wrap to negative indices.
+        if (Link->m_ParentId >= (uint32)NumBodies || Link->m_ChildId >= (uint32)NumBodies || Link->m_ParentId == Link->m_ChildId) {
+            continue;
+        }
+        const int32 Parent = (int32)Link->m_ParentId;
+        const int32 Child = (int32)Link->m_ChildId;
+
+        const float InvMassSum = Instance.InvMass[Parent] + Instance.InvMass[Child];
+        if (InvMassSum <= 0.0f) {
+            continue;
+        }
+
+        const FSQEX_BonamikSolverDesc_v2* Solver = BodySolvers[Child];
+        const bool bDistance = Link->m_LinkType == ESQEX_Bonamik_LinkType_v2_Lateral || Link->m_LinkType == ESQEX_Bonamik_LinkType_v2_ParentChild || Link->m_LinkType == ESQEX_Bonamik_LinkType_v2_Bending;
+        if (bDistance && Link->m_LinkStr > 0.0f) {
+            const float Strength = FMath::Min(Link->m_LinkStr, 1.0f);
+            FLink& Constraint = Instance.Links.AddDefaulted_GetRef();
+            Constraint.A = Parent;
+            Constraint.B = Child;
+            Constraint.RestLength = FVector::Dist(ReferencePose[Parent], ReferencePose[Child]);
+            Constraint.WeightA = Strength * Instance.InvMass[Parent] / InvMassSum;
+            Constraint.WeightB = Strength * Instance.InvMass[Child] / InvMassSum;
+            Constraint.SolverIterations = (float)BonamikSceneSolver::GetIterations(Solver, &FSQEX_BonamikSolverDesc_v2::m_SolverIter);
+            Constraint.Iterations = (float)BonamikSceneSolver::GetIterations(Solver, &FSQEX_BonamikSolverDesc_v2::m_LinkIter);
+            Constraint.Batch = BonamikSceneSolver::AssignBatch(UsedLinkParticles, NumBodies, Parent, Child);
+        }
+
+        // Cones keep the child inside a circular cone around the animated bone direction; the wider of the two limits
+        // is used for both axes.
+        if (Link->m_EnableCone && Link->m_LinkType == ESQEX_Bonamik_LinkType_v2_ParentChild && Instance.InvMass[Child] > 0.0f && Link->m_ConeOuterStr > 0.0f) {
+            const float Limit = FMath::DegreesToRadians(FMath::Clamp(FMath::Max(Link->m_LimitY, Link->m_LimitZ), 0.0f, 180.0f));
+            FCone& Constraint = Instance.Cones.AddDefaulted_GetRef();
+            Constraint.Child = Child;
+            Constraint.Parent = Parent;
+            FMath::SinCos(&Constraint.SinLimit, &Constraint.CosLimit, Limit);
+            Constraint.Strength = FMath::Min(Link->m_ConeOuterStr, 1.0f);
+            Constraint.SolverIterations = (float)BonamikSceneSolver::GetIterations(Solver, &FSQEX_BonamikSolverDesc_v2::m_SolverIter);
+            Constraint.Iterations = (float)BonamikSceneSolver::GetIterations(Solver, &FSQEX_BonamikSolverDesc_v2::m_ConeIter);
+            Constraint.Batch = BonamikSceneSolver::AssignBatch(UsedConeParticles, NumBodies, Child, Parent);
+        }
+
+        if (Link->m_IsCollisionReceiver && Instance.InvMass[Child] > 0.0f && Bodies[Child].m_Radius > 0.0f) {
+            IsReceiver[Child] = true;
+        }
+    }
+
+    // Receivers collide with the sphere and capsule bodies of their own character, except the ones of their own
+    // chain and the dynamic ones of their own group.
+    TArray<int32> CollisionSlots;
+    CollisionSlots.SetNumZeroed(NumBodies);
+    for (int32 ShapeIndex = 0; ShapeIndex < NumBodies; ++ShapeIndex) {
+        const FSQEX_BonamikBodyDesc_v2& Shape = Bodies[ShapeIndex];
+        const bool bSphere = Shape.m_ColShape == ESQEX_Bonamik_CollisionShape_v2_Sphere;
+        const bool bCapsule = Shape.m_ColShape == ESQEX_Bonamik_CollisionShape_v2_Capsule && Shape.m_ChildId >= 0 && Shape.m_ChildId < NumBodies;
+        if (!Shape.m_IsCollision || !(bSphere || bCapsule)) {
+            continue;
+        }
+
+        for (int32 ParticleIndex = 0; ParticleIndex < NumBodies; ++ParticleIndex) {
+            const FSQEX_BonamikBodyDesc_v2& Particle = Bodies[ParticleIndex];
+            if (!IsReceiver[ParticleIndex] || ParticleIndex == ShapeIndex || Particle.m_ParentId == ShapeIndex || Particle.m_ChildId == ShapeIndex || (bCapsule && Shape.m_ChildId == ParticleIndex)) {
+                continue;
+            }
+            if (Instance.InvMass[ShapeIndex] > 0.0f && Shape.m_GroupId == Particle.m_GroupId) {
+                continue;
+            }
+
+            const FSQEX_BonamikSolverDesc_v2* Solver = BodySolvers[ParticleIndex];
+            FCollision& Constraint = Instance.Collisions.AddDefaulted_GetRef();
+            Constraint.Particle = ParticleIndex;
+            Constraint.ShapeA = ShapeIndex;
+            Constraint.ShapeB = bCapsule ? Shape.m_ChildId : ShapeIndex;
+            Constraint.Radius = Particle.m_Radius + Shape.m_Radius;
+            Constraint.SolverIterations = (float)BonamikSceneSolver::GetIterations(Solver, &FSQEX_BonamikSolverDesc_v2::m_SolverIter);
+            Constraint.Iterations = (float)BonamikSceneSolver::GetIterations(Solver, &FSQEX_BonamikSolverDesc_v2::m_ColIter);
+            // A collision only moves its particle, so the n-th shape of every particle can share a batch.
+            Constraint.Batch = CollisionSlots[ParticleIndex]++;
+        }
+    }
+
+    Instance.MaxReceiverRadius = 0.0f;
+    for (int32 BodyIndex = 0; BodyIndex < NumBodies; ++BodyIndex) {
+        if (IsReceiver[BodyIndex]) {
+            Instance.Receivers.Add(BodyIndex);
+            Instance.ReceiverRadii.Add(Bodies[BodyIndex].m_Radius);
+            Instance.MaxReceiverRadius = FMath::Max(Instance.MaxReceiverRadius, Bodies[BodyIndex].m_Radius);
+        }
+    }
+
+    Instance.NumLinkBatches = UsedLinkParticles.Num();
+    Instance.NumConeBatches = UsedConeParticles.Num();
+    Instance.NumCollisionBatches = 0;
+    for (int32 Slots : CollisionSlots) {
+        Instance.NumCollisionBatches = FMath::Max(Instance.NumCollisionBatches, Slots);
+    }
+
+    // Cones cost about two links.
+    Instance.Cost = NumBodies;
+    Instance.ReducedCost = NumBodies;
+    auto AddCost = [&Instance](const FConstraint& Constraint, int32 Weight) {
+        Instance.Cost += (int32)(Constraint.SolverIterations * Constraint.Iterations) * Weight;
+        Instance.ReducedCost += (int32)(BonamikSceneSolver::GetReducedIterations(Constraint.SolverIterations) * BonamikSceneSolver::GetReducedIterations(Constraint.Iterations)) * Weight;
+    };
+    for (const FLink& Link : Instance.Links) {
+        AddCost(Link, 1);
+    }
+    for (const FCone& Cone : Instance.Cones) {
+        AddCost(Cone, 2);
+    }
+    for (const FCollision& Collision : Instance.Collisions) {
+        AddCost(Collision, 1);
+    }
+
+    // An instance is one LOD unit: it freezes once it is smaller than every group LOD and blends / pre-rolls like the
+    // slowest of them.
+    Instance.MinScreenSize = 0.0f;
+    Instance.BlendTime = 0.0f;
+    Instance.PreRollTime = 0.0f;
+    for (int32 GroupLodIndex = 0; GroupLodIndex < Asset.m_BonamikGroupLODs.Num(); ++GroupLodIndex) {
+        const FSQEX_BonamikGroupLOD_v2& GroupLod = Asset.m_BonamikGroupLODs[GroupLodIndex];
+        Instance.MinScreenSize = GroupLodIndex == 0 ? GroupLod.MinSize : FMath::Min(Instance.MinScreenSize, GroupLod.MinSize);
+        Instance.BlendTime = FMath::Max(Instance.BlendTime, GroupLod.BlendTime);
+        Instance.PreRollTime = FMath::Max(Instance.PreRollTime, GroupLod.PreRollTime);
+    }
+    Instance.LodDistance = 0.0f;
+    for (const FSQEX_BonamikSolverDesc_v2& Solver : Asset.m_Solvers) {
+        Instance.LodDistance = FMath::Max(Instance.LodDistance, Solver.m_LODdistance);
+    }
+
+    Instance.Positions = ReferencePose;
+    Instance.PrevPositions = ReferencePose;
+    Instance.AnimPositions = ReferencePose;
+    Instance.IslandIndex = INDEX_NONE;
+    Instance.ParticleOffset = 0;
+    Instance.BlendWeight = 1.0f;
+    Instance.LastStepScale = 1.0f;
+    Instance.PreRollSteps = 0;
+    Instance.Lod = EBonamikSolverLod::Full;
+    Instance.LaneState = ELaneState::Off;
+    Instance.StepState = EStepState::Simulate;
+    Instance.bAlive = true;
+    Instance.bReset = false;
+    Instance.bPinned = false;
+
+    int32 Handle;
+    if (FreeHandles.Num() > 0) {
+        Handle = FreeHandles.Pop(false);
+        Instances[Handle] = MoveTemp(Instance);
+    } else {
+        Handle = Instances.Add(MoveTemp(Instance));
+    }
+
+    FInstance& Added = Instances[Handle];
+    Added.Proxy = INDEX_NONE;
+    Added.ProxyCenter = FVector::ZeroVector;
+    if (Added.Receivers.Num() > 0) {
+        FBox Box(ForceInit);
+        for (int32 Receiver : Added.Receivers) {
+            Box += ReferencePose[Receiver];
+        }
+        Box = Box.ExpandBy(Added.MaxReceiverRadius);
+        Added.Proxy = Broadphase.CreateProxy(Box, BonamikSceneSolver::InstanceLayer, BonamikSceneSolver::TemporaryShapeLayer, Handle);
+        Added.ProxyCenter = Box.GetCenter();
+    }
+
+    ++NumLiveInstances;
+    bIslandsDirty = true;
+    return Handle;
+}
+
+void FBonamikSceneSolver::RemoveInstance(int32 Handle) {
+    if (!IsValidInstance(Handle)) {
+        return;
+    }
+
+    FInstance& Instance = Instances[Handle];
+    if (Instance.Proxy != INDEX_NONE) {
+        Broadphase.DestroyProxy(Instance.Proxy);
+    }
+    Instance = FInstance();
+    Instance.Proxy = INDEX_NONE;
+    Instance.IslandIndex = INDEX_NONE;
+    Instance.bAlive = false;
+    FreeHandles.Add(Handle);
+    --NumLiveInstances;
+    bIslandsDirty = true;
+}
+
+bool FBonamikSceneSolver::IsValidInstance(int32 Handle) const {
+    return Instances.IsValidIndex(Handle) && Instances[Handle].bAlive;
+}
+
+void FBonamikSceneSolver::SetAnimatedPose(int32 Handle, const TArray<FVector>& BodyPositions) {
+    if (IsValidInstance(Handle) && Instances[Handle].AnimPositions.Num() == BodyPositions.Num()) {
+        Instances[Handle].AnimPositions = BodyPositions;
+    }
+}
+
+void FBonamikSceneSolver::SetInstanceWind(int32 Handle, const TArray<FVector>& BodyWind) {
+    if (IsValidInstance(Handle) && Instances[Handle].Wind.Num() == BodyWind.Num()) {
+        Instances[Handle].Wind = BodyWind;
+    }
+}
+
+bool FBonamikSceneSolver::IsAffectedByWind(int32 Handle) const {
+    return IsValidInstance(Handle) && Instances[Handle].bAffectedByWind;
+}
+
+void FBonamikSceneSolver::ResetInstance(int32 Handle) {
+    if (IsValidInstance(Handle)) {
+        Instances[Handle].bReset = true;
+    }
+}
+
+void FBonamikSceneSolver::GetSimulatedPose(int32 Handle, TArray<FVector>& OutBodyPositions) const {
+    OutBodyPositions.Reset();
+    if (!IsValidInstance(Handle)) {
+        return;
+    }
+
+    const FInstance& Instance = Instances[Handle];
+    OutBodyPositions.SetNumUninitialized(Instance.Positions.Num());
+    for (int32 BodyIndex = 0; BodyIndex < OutBodyPositions.Num(); ++BodyIndex) {
+        FVector Simulated = Instance.Positions[BodyIndex];
+        if (Instance.IslandIndex != INDEX_NONE) {
+            const FIsland& Island = Islands[Instance.IslandIndex];
+            const int32 Particle = Instance.ParticleOffset + BodyIndex;
+            Simulated = FVector(Island.PosX[Particle], Island.PosY[Particle], Island.PosZ[Particle]);
+
+            // A half rate step lands one step ahead, show the point it passes now.
+            if (Instance.StepState == EStepState::SimulateDouble) {
+                Simulated = (Simulated + FVector(Island.PrevX[Particle], Island.PrevY[Particle], Island.PrevZ[Particle])) * 0.5f;
+            }
+        }
+        OutBodyPositions[BodyIndex] = FMath::Lerp(Instance.AnimPositions[BodyIndex], Simulated, Instance.BlendWeight);
+    }
+}
+
+void FBonamikSceneSolver::SetInstanceLod(int32 Handle, EBonamikSolverLod Lod) {
+    if (!IsValidInstance(Handle)) {
+        return;
+    }
+
+    FInstance& Instance = Instances[Handle];
+    Instance.Lod = Lod;
+    if (Lod != EBonamikSolverLod::Frozen && Instance.bPinned) {
+        // The pre-roll length depends on the time step, Simulate() resolves it.
+        Instance.bPinned = false;
+        Instance.bReset = true;
+        Instance.PreRollSteps = INDEX_NONE;
+    }
+}
+
+EBonamikSolverLod FBonamikSceneSolver::GetInstanceLod(int32 Handle) const {
+    return IsValidInstance(Handle) ? Instances[Handle].Lod : EBonamikSolverLod::Full;
+}
+
+int32 FBonamikSceneSolver::GetInstanceCost(int32 Handle, EBonamikSolverLod Lod) const {
+    if (!IsValidInstance(Handle)) {
+        return 0;
+    }
+
+    const FInstance& Instance = Instances[Handle];
+    switch (Lod) {
+    case EBonamikSolverLod::Full:
+        return Instance.Cost;
+    case EBonamikSolverLod::ReducedIterations:
+        return Instance.ReducedCost;
+    case EBonamikSolverLod::HalfRate:
+        return (Instance.ReducedCost + 1) / 2;
+    default:
+        return Instance.Positions.Num() / 4;
+    }
+}
+
+bool FBonamikSceneSolver::GetInstanceBounds(int32 Handle, FVector& OutCenter, float& OutRadius) const {
+    if (!IsValidInstance(Handle)) {
+        return false;
+    }
+
+    const FBox Box(Instances[Handle].AnimPositions);
+    OutCenter = Box.GetCenter();
+    OutRadius = Box.GetExtent().Size();
+    return true;
+}
+
+float FBonamikSceneSolver::GetInstanceMinScreenSize(int32 Handle) const {
+    return IsValidInstance(Handle) ? Instances[Handle].MinScreenSize : 0.0f;
+}
+
+float FBonamikSceneSolver::GetInstanceLodDistance(int32 Handle) const {
+    return IsValidInstance(Handle) ? Instances[Handle].LodDistance : 0.0f;
+}
+
+float FBonamikSceneSolver::GetInstanceBlendWeight(int32 Handle) const {
+    return IsValidInstance(Handle) ? Instances[Handle].BlendWeight : 0.0f;
+}
+
+int32 FBonamikSceneSolver::AddTemporaryShape(const FTemporaryShape& Shape) {
+    FTemporaryShapeState State;
+    State.Shape = Shape;
+    State.Bounds = BonamikSceneSolver::GetTemporaryShapeBounds(Shape);
+    State.bAlive = true;
+
+    int32 ShapeHandle;
+    if (FreeShapeHandles.Num() > 0) {
+        ShapeHandle = FreeShapeHandles.Pop(false);
+        TemporaryShapes[ShapeHandle] = State;
+    } else {
+        ShapeHandle = TemporaryShapes.Add(State);
+    }
+    TemporaryShapes[ShapeHandle].Proxy = Broadphase.CreateProxy(State.Bounds, BonamikSceneSolver::TemporaryShapeLayer, BonamikSceneSolver::InstanceLayer, ShapeHandle);
+
+    ++NumLiveShapes;
+    return ShapeHandle;
+}
+
+void FBonamikSceneSolver::SetTemporaryShapeTransform(int32 ShapeHandle, const FTransform& Transform) {
+    if (!IsValidTemporaryShape(ShapeHandle)) {
+        return;
+    }
+
+    FTemporaryShapeState& State = TemporaryShapes[ShapeHandle];
+    const FVector OldCenter = State.Bounds.GetCenter();
+    State.Shape.Transform = Transform;
+    State.Bounds = BonamikSceneSolver::GetTemporaryShapeBounds(State.Shape);
+    Broadphase.MoveProxy(State.Proxy, State.Bounds, State.Bounds.GetCenter() - OldCenter);
+}
+
+void FBonamikSceneSolver::RemoveTemporaryShape(int32 ShapeHandle) {
+    if (!IsValidTemporaryShape(ShapeHandle)) {
+        return;
+    }
+
+    Broadphase.DestroyProxy(TemporaryShapes[ShapeHandle].Proxy);
+    TemporaryShapes[ShapeHandle].Proxy = INDEX_NONE;
+    TemporaryShapes[ShapeHandle].bAlive = false;
+    FreeShapeHandles.Add(ShapeHandle);
+    --NumLiveShapes;
+}
+
+bool FBonamikSceneSolver::IsValidTemporaryShape(int32 ShapeHandle) const {
+    return TemporaryShapes.IsValidIndex(ShapeHandle) && TemporaryShapes[ShapeHandle].bAlive;
+}
+
+int32 FBonamikSceneSolver::GetNumTemporaryContacts() const {
+    int32 NumContacts = 0;
+    for (const FIsland& Island : Islands) {
+        NumContacts += Island.TemporaryContacts.Num();
+    }
+    return NumContacts;
+}
+
+int32 FBonamikSceneSolver::GetNumParticles() const {
+    int32 NumParticles = 0;
+    for (const FIsland& Island : Islands) {
+        NumParticles += Island.NumParticles;
+    }
+    return NumParticles;
+}
+
+int32 FBonamikSceneSolver::GetIslandTarget(const FSettings& Settings) const {
+    if (!Settings.bMultiThread) {
+        return 1;
+    }
+
+    // Twice the thread count leaves room to balance uneven islands.
+    int32 TotalParticles = 0;
+    for (const FInstance& Instance : Instances) {
+        TotalParticles += Instance.bAlive ? Instance.Positions.Num() : 0;
+    }
+    const int32 NumThreads = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+    return FMath::Clamp(TotalParticles / FMath::Max(1, Settings.MinParticlesPerIsland), 1, NumThreads * 2);
+}
+
+void FBonamikSceneSolver::GatherIslandState() {
+    for (const FIsland& Island : Islands) {
+        for (int32 Handle : Island.Instances) {
+            FInstance& Instance = Instances[Handle];
+            if (!Instance.bAlive || Instance.IslandIndex == INDEX_NONE) {
+                continue;
+            }
+            for (int32 BodyIndex = 0; BodyIndex < Instance.Positions.Num(); ++BodyIndex) {
+                const int32 Particle = Instance.ParticleOffset + BodyIndex;
+                Instance.Positions[BodyIndex] = FVector(Island.PosX[Particle], Island.PosY[Particle], Island.PosZ[Particle]);
+                Instance.PrevPositions[BodyIndex] = FVector(Island.PrevX[Particle], Island.PrevY[Particle], Island.PrevZ[Particle]);
+            }
+        }
+    }
+}
+
+void FBonamikSceneSolver::RebuildIslands(const FSettings& Settings) {
+    GatherIslandState();
+    Islands.Reset();
+
+    TArray<int32> LiveHandles;
+    for (int32 Handle = 0; Handle < Instances.Num(); ++Handle) {
+        Instances[Handle].IslandIndex = INDEX_NONE;
+        if (Instances[Handle].bAlive) {
+            LiveHandles.Add(Handle);
+        }
+    }
+
+    BuiltIslandTarget = GetIslandTarget(Settings);
+    bIslandsDirty = false;
+
+    if (LiveHandles.Num() == 0) {
+        return;
+    }
+
+    // Longest processing time first: the most expensive instance goes to the cheapest island.
+    LiveHandles.Sort([this](int32 A, int32 B) {
+        return Instances[A].Cost > Instances[B].Cost;
+    });
+
+    Islands.SetNum(FMath::Min(BuiltIslandTarget, LiveHandles.Num()));
+    for (FIsland& Island : Islands) {
+        Island.Cost = 0;
+        Island.NumParticles = 0;
+    }
+    for (int32 Handle : LiveHandles) {
+        int32 Cheapest = 0;
+        for (int32 IslandIndex = 1; IslandIndex < Islands.Num(); ++IslandIndex) {
+            if (Islands[IslandIndex].Cost < Islands[Cheapest].Cost) {
+                Cheapest = IslandIndex;
+            }
+        }
+
+        FInstance& Instance = Instances[Handle];
+        FIsland& Island = Islands[Cheapest];
+        Instance.IslandIndex = Cheapest;
+        Instance.ParticleOffset = Island.NumParticles;
+        Island.Instances.Add(Handle);
+        Island.NumParticles += Instance.Positions.Num();
+        Island.Cost += Instance.Cost;
+    }
+
+    for (int32 IslandIndex = 0; IslandIndex < Islands.Num(); ++IslandIndex) {
+        FIsland& Island = Islands[IslandIndex];
+        // The extra particle is the scratch target of padding lanes.
+        const int32 Scratch = Island.NumParticles;
+        const int32 NumSlots = Island.NumParticles + 1;
+        for (TArray<float>* Stream : { &Island.PosX, &Island.PosY, &Island.PosZ, &Island.PrevX, &Island.PrevY, &Island.PrevZ, &Island.AnimX, &Island.AnimY, &Island.AnimZ, &Island.InvMass, &Island.Decay, &Island.WindX, &Island.WindY, &Island.WindZ, &Island.StepDecay, &Island.StepVelocityScale, &Island.StepGravity }) {
+            Stream->SetNumZeroed(NumSlots);
+        }
+        Island.StepStates.Init(EStepState::Pin, NumSlots);
+
+        for (int32 Handle : Island.Instances) {
+            FInstance& Instance = Instances[Handle];
+            const int32 Offset = Instance.ParticleOffset;
+            for (int32 BodyIndex = 0; BodyIndex < Instance.Positions.Num(); ++BodyIndex) {
+                const int32 Particle = Offset + BodyIndex;
+                Island.PosX[Particle] = Instance.Positions[BodyIndex].X;
+                Island.PosY[Particle] = Instance.Positions[BodyIndex].Y;
+                Island.PosZ[Particle] = Instance.Positions[BodyIndex].Z;
+                Island.PrevX[Particle] = Instance.PrevPositions[BodyIndex].X;
+                Island.PrevY[Particle] = Instance.PrevPositions[BodyIndex].Y;
+                Island.PrevZ[Particle] = Instance.PrevPositions[BodyIndex].Z;
+                Island.InvMass[Particle] = Instance.InvMass[BodyIndex];
+                Island.Decay[Particle] = Instance.Decay[BodyIndex];
+            }
+
+            // The constraints of one instance are contiguous in every batch; the spans let LOD changes patch them.
+            Instance.Spans.Reset();
+            // Lanes are rewritten by the next ApplyStepStates().
+            Instance.LaneState = ELaneState::Off;
+            TArray<int32> Begins;
+
+            if (Island.LinkBatches.Num() < Instance.NumLinkBatches) {
+                Island.LinkBatches.SetNum(Instance.NumLinkBatches);
+            }
+            Begins.Reset();
+            for (const FLinkBatch& Batch : Island.LinkBatches) {
+                Begins.Add(Batch.A.Num());
+            }
+            for (const FLink& Link : Instance.Links) {
+                FLinkBatch& Batch = Island.LinkBatches[Link.Batch];
+                Batch.A.Add(Offset + Link.A);
+                Batch.B.Add(Offset + Link.B);
+                Batch.RestLength.Add(Link.RestLength);
+                Batch.WeightA.Add(Link.WeightA);
+                Batch.WeightB.Add(Link.WeightB);
+                AddToBatch(Batch, Link);
+            }
+            AddSpans(Island, Handle, EBatchKind::Link, Begins);
+
+            if (Island.ConeBatches.Num() < Instance.NumConeBatches) {
+                Island.ConeBatches.SetNum(Instance.NumConeBatches);
+            }
+            Begins.Reset();
+            for (const FConeBatch& Batch : Island.ConeBatches) {
+                Begins.Add(Batch.Child.Num());
+            }
+            for (const FCone& Cone : Instance.Cones) {
+                FConeBatch& Batch = Island.ConeBatches[Cone.Batch];
+                Batch.Child.Add(Offset + Cone.Child);
+                Batch.Parent.Add(Offset + Cone.Parent);
+                Batch.CosLimit.Add(Cone.CosLimit);
+                Batch.SinLimit.Add(Cone.SinLimit);
+                Batch.Strength.Add(Cone.Strength);
+                AddToBatch(Batch, Cone);
+            }
+            AddSpans(Island, Handle, EBatchKind::Cone, Begins);
+
+            if (Island.CollisionBatches.Num() < Instance.NumCollisionBatches) {
+                Island.CollisionBatches.SetNum(Instance.NumCollisionBatches);
+            }
+            Begins.Reset();
+            for (const FCollisionBatch& Batch : Island.CollisionBatches) {
+                Begins.Add(Batch.Particle.Num());
+            }
+            for (const FCollision& Collision : Instance.Collisions) {
+                FCollisionBatch& Batch = Island.CollisionBatches[Collision.Batch];
+                Batch.Particle.Add(Offset + Collision.Particle);
+                Batch.ShapeA.Add(Offset + Collision.ShapeA);
+                Batch.ShapeB.Add(Offset + Collision.ShapeB);
+                Batch.Radius.Add(Collision.Radius);
+                AddToBatch(Batch, Collision);
+            }
+            AddSpans(Island, Handle, EBatchKind::Collision, Begins);
+        }
+
+        for (FLinkBatch& Batch : Island.LinkBatches) {
+            PadBatch(Batch);
+            BonamikSceneSolver::PadToLanes(Batch.A, Scratch);
+            BonamikSceneSolver::PadToLanes(Batch.B, Scratch);
+            for (TArray<float>* Values : { &Batch.RestLength, &Batch.WeightA, &Batch.WeightB }) {
+                BonamikSceneSolver::PadToLanes(*Values);
+            }
+        }
+        for (FConeBatch& Batch : Island.ConeBatches) {
+            PadBatch(Batch);
+            BonamikSceneSolver::PadToLanes(Batch.Child, Scratch);
+            BonamikSceneSolver::PadToLanes(Batch.Parent, Scratch);
+            for (TArray<float>* Values : { &Batch.CosLimit, &Batch.SinLimit, &Batch.Strength }) {
+                BonamikSceneSolver::PadToLanes(*Values);
+            }
+        }
+        for (FCollisionBatch& Batch : Island.CollisionBatches) {
+            PadBatch(Batch);
+            BonamikSceneSolver::PadToLanes(Batch.Particle, Scratch);
+            BonamikSceneSolver::PadToLanes(Batch.ShapeA, Scratch);
+            BonamikSceneSolver::PadToLanes(Batch.ShapeB, Scratch);
+            BonamikSceneSolver::PadToLanes(Batch.Radius);
+        }
+        UpdateActiveRanges(Island, Instances);
+    }
+
+    // Most expensive first, so idle workers pick up the cheap islands at the end of the frame.
+    Islands.Sort([](const FIsland& A, const FIsland& B) {
+        return A.Cost > B.Cost;
+    });
+    for (int32 IslandIndex = 0; IslandIndex < Islands.Num(); ++IslandIndex) {
+        for (int32 Handle : Islands[IslandIndex].Instances) {
+            Instances[Handle].IslandIndex = IslandIndex;
+        }
+    }
+}
+
+void FBonamikSceneSolver::AddSpans(FIsland& Island, int32 Handle, EBatchKind Kind, const TArray<int32>& Begins) {
+    for (int32 BatchIndex = 0; BatchIndex < Begins.Num(); ++BatchIndex) {
+        FInstanceSpan Span;
+        Span.Kind = Kind;
+        Span.Batch = BatchIndex;
+        Span.Begin = Begins[BatchIndex];
+        FBatch& Batch = GetBatch(Island, Span);
+        Span.End = Batch.FullIterations.Num();
+        if (Span.End == Span.Begin) {
+            continue;
+        }
+
+        Instances[Handle].Spans.Add(Span);
+        FBatchSpan& BatchSpan = Batch.Spans.AddDefaulted_GetRef();
+        BatchSpan.Handle = Handle;
+        BatchSpan.Begin = Span.Begin;
+        BatchSpan.End = Span.End;
+    }
+}
+
+void FBonamikSceneSolver::AddToBatch(FBatch& Batch, const FConstraint& Constraint) {
+    Batch.FullSolverIterations.Add(Constraint.SolverIterations);
+    Batch.FullIterations.Add(Constraint.Iterations);
+    Batch.ReducedSolverIterations.Add(BonamikSceneSolver::GetReducedIterations(Constraint.SolverIterations));
+    Batch.ReducedIterations.Add(BonamikSceneSolver::GetReducedIterations(Constraint.Iterations));
+    Batch.SolverIterations.Add(0.0f);
+    Batch.Iterations.Add(0.0f);
+}
+
+void FBonamikSceneSolver::PadBatch(FBatch& Batch) {
+    for (TArray<float>* Values : { &Batch.FullSolverIterations, &Batch.FullIterations, &Batch.ReducedSolverIterations, &Batch.ReducedIterations, &Batch.SolverIterations, &Batch.Iterations }) {
+        BonamikSceneSolver::PadToLanes(*Values);
+    }
+}
+
+FBonamikSceneSolver::FBatch& FBonamikSceneSolver::GetBatch(FIsland& Island, const FInstanceSpan& Span) {
+    switch (Span.Kind) {
+    case EBatchKind::Link:
+        return Island.LinkBatches[Span.Batch];
+    case EBatchKind::Cone:
+        return Island.ConeBatches[Span.Batch];
+    default:
+        return Island.CollisionBatches[Span.Batch];
+    }
+}
+
+void FBonamikSceneSolver::UpdateActiveRanges(FIsland& Island, const TArray<FInstance>& Instances) {
+    Island.MaxSolverIterations = 0;
+    Island.MaxLinkIterations = 0;
+    Island.MaxConeIterations = 0;
+    Island.MaxCollisionIterations = 0;
+
+    auto UpdateBatch = [&Island, &Instances](FBatch& Batch, int32& MaxIterations) {
+        // Spans are in lane order. Ranges are widened to whole SIMD groups, the live iterations of lanes that belong
+        // to an instance which is not stepped are zero, so a shared group masks them out.
+        Batch.ActiveRanges.Reset();
+        for (const FBatchSpan& Span : Batch.Spans) {
+            if (Instances[Span.Handle].LaneState == ELaneState::Off) {
+                continue;
+            }
+            const int32 Begin = Span.Begin & ~3;
+            const int32 End = (Span.End + 3) & ~3;
+            if (Batch.ActiveRanges.Num() > 0 && Batch.ActiveRanges.Last().Value >= Begin) {
+                Batch.ActiveRanges.Last().Value = FMath::Max(Batch.ActiveRanges.Last().Value, End);
+            } else {
+                Batch.ActiveRanges.Add(TPair<int32, int32>(Begin, End));
+            }
+            for (int32 Lane = Span.Begin; Lane < Span.End; ++Lane) {
+                Island.MaxSolverIterations = FMath::Max(Island.MaxSolverIterations, (int32)Batch.SolverIterations[Lane]);
+                MaxIterations = FMath::Max(MaxIterations, (int32)Batch.Iterations[Lane]);
+            }
+        }
+    };
+
+    for (FLinkBatch& Batch : Island.LinkBatches) {
+        UpdateBatch(Batch, Island.MaxLinkIterations);
+    }
+    for (FConeBatch& Batch : Island.ConeBatches) {
+        UpdateBatch(Batch, Island.MaxConeIterations);
+    }
+    for (FCollisionBatch& Batch : Island.CollisionBatches) {
+        UpdateBatch(Batch, Island.MaxCollisionIterations);
+    }
+}
+
+void FBonamikSceneSolver::UploadAnimatedPoses() {
+    for (FIsland& Island : Islands) {
+        for (int32 Handle : Island.Instances) {
+            const FInstance& Instance = Instances[Handle];
+            for (int32 BodyIndex = 0; BodyIndex < Instance.AnimPositions.Num(); ++BodyIndex) {
+                const int32 Particle = Instance.ParticleOffset + BodyIndex;
+                const FVector& Anim = Instance.AnimPositions[BodyIndex];
+                Island.AnimX[Particle] = Anim.X;
+                Island.AnimY[Particle] = Anim.Y;
+                Island.AnimZ[Particle] = Anim.Z;
+            }
+            if (Instance.bAffectedByWind) {
+                for (int32 BodyIndex = 0; BodyIndex < Instance.Wind.Num(); ++BodyIndex) {
+                    const int32 Particle = Instance.ParticleOffset + BodyIndex;
+                    const FVector Wind = Instance.Wind[BodyIndex] * Instance.WindDrag[BodyIndex];
+                    Island.WindX[Particle] = Wind.X;
+                    Island.WindY[Particle] = Wind.Y;
+                    Island.WindZ[Particle] = Wind.Z;
+                }
+            }
+        }
+    }
+}
+
+FBonamikSceneSolver::EStepState FBonamikSceneSolver::GetStepState(int32 Handle, int32 PreRollPass) const {
+    const FInstance& Instance = Instances[Handle];
+    if (Instance.bPinned) {
+        return EStepState::Pin;
+    }
+
+    // Pre-roll passes only step the instances that are coming back, the others wait for the regular step.
+    if (PreRollPass != INDEX_NONE) {
+        if (PreRollPass >= Instance.PreRollSteps) {
+            return EStepState::Hold;
+        }
+        return Instance.Lod == EBonamikSolverLod::Full ? EStepState::Simulate : EStepState::SimulateReduced;
+    }
+
+    switch (Instance.Lod) {
+    case EBonamikSolverLod::Full:
+        return EStepState::Simulate;
+    case EBonamikSolverLod::HalfRate:
+        // Instances alternate so half rate ones spread their cost over both frames.
+        return ((StepCounter + (uint32)Handle) & 1) == 0 ? EStepState::SimulateDouble : EStepState::Hold;
+    default:
+        // Reduced, or frozen but still blending out.
+        return EStepState::SimulateReduced;
+    }
+}
+
+void FBonamikSceneSolver::ApplyStepStates(int32 PreRollPass) {
+    for (FIsland& Island : Islands) {
+        bool bRangesDirty = false;
+        for (int32 Handle : Island.Instances) {
+            FInstance& Instance = Instances[Handle];
+            const EStepState State = GetStepState(Handle, PreRollPass);
+
+            ELaneState LaneState = ELaneState::Off;
+            if (State == EStepState::Simulate) {
+                LaneState = ELaneState::Full;
+            } else if (State == EStepState::SimulateReduced || State == EStepState::SimulateDouble) {
+                LaneState = ELaneState::Reduced;
+            }
+
+            if (LaneState != Instance.LaneState) {
+                for (const FInstanceSpan& Span : Instance.Spans) {
+                    FBatch& Batch = GetBatch(Island, Span);
+                    const TArray<float>& SolverIterations = LaneState == ELaneState::Full ? Batch.FullSolverIterations : Batch.ReducedSolverIterations;
+                    const TArray<float>& Iterations = LaneState == ELaneState::Full ? Batch.FullIterations : Batch.ReducedIterations;
+                    for (int32 Lane = Span.Begin; Lane < Span.End; ++Lane) {
+                        Batch.SolverIterations[Lane] = LaneState == ELaneState::Off ? 0.0f : SolverIterations[Lane];
+                        Batch.Iterations[Lane] = LaneState == ELaneState::Off ? 0.0f : Iterations[Lane];
+                    }
+                }
+                Instance.LaneState = LaneState;
+                bRangesDirty = true;
+            }
+
+            if (Instance.bReset) {
+                for (int32 BodyIndex = 0; BodyIndex < Instance.Positions.Num(); ++BodyIndex) {
+                    const int32 Particle = Instance.ParticleOffset + BodyIndex;
+                    Island.PosX[Particle] = Island.PrevX[Particle] = Island.AnimX[Particle];
+                    Island.PosY[Particle] = Island.PrevY[Particle] = Island.AnimY[Particle];
+                    Island.PosZ[Particle] = Island.PrevZ[Particle] = Island.AnimZ[Particle];
+                }
+                Instance.LastStepScale = 1.0f;
+                Instance.bReset = false;
+            }
+
+            // Verlet keeps positions, not velocities: the last displacement is rescaled to the new step length.
+            const float StepScale = State == EStepState::SimulateDouble ? 2.0f : 1.0f;
+            const float VelocityScale = StepScale / Instance.LastStepScale;
+            for (int32 BodyIndex = 0; BodyIndex < Instance.Positions.Num(); ++BodyIndex) {
+                const int32 Particle = Instance.ParticleOffset + BodyIndex;
+                Island.StepStates[Particle] = State;
+                Island.StepDecay[Particle] = StepScale > 1.0f ? Island.Decay[Particle] * Island.Decay[Particle] : Island.Decay[Particle];
+                Island.StepVelocityScale[Particle] = VelocityScale;
+                Island.StepGravity[Particle] = StepScale * StepScale;
+            }
+
+            if (State != EStepState::Hold) {
+                Instance.LastStepScale = StepScale;
+            }
+            if (PreRollPass == INDEX_NONE) {
+                Instance.StepState = State;
+            }
+        }
+
+        if (bRangesDirty) {
+            UpdateActiveRanges(Island, Instances);
+        }
+    }
+}
+
+void FBonamikSceneSolver::UpdateBlendWeights(const FSettings& Settings) {
+    for (FInstance& Instance : Instances) {
+        if (!Instance.bAlive) {
+            continue;
+        }
+
+        const float Target = Instance.Lod == EBonamikSolverLod::Frozen ? 0.0f : 1.0f;
+        const float Delta = Instance.BlendTime > 0.0f ? Settings.TimeStep / Instance.BlendTime : 1.0f;
+        Instance.BlendWeight = Target > Instance.BlendWeight ? FMath::Min(Target, Instance.BlendWeight + Delta) : FMath::Max(Target, Instance.BlendWeight - Delta);
+        if (Instance.Lod == EBonamikSolverLod::Frozen && Instance.BlendWeight == 0.0f) {
+            Instance.bPinned = true;
+        }
+    }
+}
+
+void FBonamikSceneSolver::UpdateTemporaryContacts() {
+    for (FIsland& Island : Islands) {
+        Island.TemporaryContacts.Reset();
+    }
+    if (NumLiveShapes == 0) {
+        return;
+    }
+
+    for (FInstance& Instance : Instances) {
+        if (!Instance.bAlive || Instance.Proxy == INDEX_NONE || Instance.IslandIndex == INDEX_NONE) {
+            continue;
+        }
+
+        const FIsland& Island = Islands[Instance.IslandIndex];
+        FBox Box(ForceInit);
+        for (int32 Receiver : Instance.Receivers) {
+            const int32 Particle = Instance.ParticleOffset + Receiver;
+            Box += FVector(Island.PosX[Particle], Island.PosY[Particle], Island.PosZ[Particle]);
+        }
+        Box = Box.ExpandBy(Instance.MaxReceiverRadius);
+        const FVector Center = Box.GetCenter();
+        Broadphase.MoveProxy(Instance.Proxy, Box, Center - Instance.ProxyCenter);
+        Instance.ProxyCenter = Center;
+    }
+    Broadphase.UpdatePairs();
+
+    // Narrow the instance / shape pairs down to receivers. A particle can travel about its last displacement during
+    // the step, so that much is added to the test.
+    for (const FBonamikBroadphase::FPair& Pair : Broadphase.GetPairs()) {
+        const bool bInstanceFirst = Broadphase.GetLayer(Pair.ProxyA) == BonamikSceneSolver::InstanceLayer;
+        const int32 Handle = Broadphase.GetUserData(bInstanceFirst ? Pair.ProxyA : Pair.ProxyB);
+        const int32 ShapeHandle = Broadphase.GetUserData(bInstanceFirst ? Pair.ProxyB : Pair.ProxyA);
+        const FTemporaryShapeState& Shape = TemporaryShapes[ShapeHandle];
+        const FInstance& Instance = Instances[Handle];
+        if ((Shape.Shape.OwnerHandle != INDEX_NONE && Shape.Shape.OwnerHandle != Handle) || Instance.IslandIndex == INDEX_NONE) {
+            continue;
+        }
+
+        FIsland& Island = Islands[Instance.IslandIndex];
+        for (int32 ReceiverIndex = 0; ReceiverIndex < Instance.Receivers.Num(); ++ReceiverIndex) {
+            const int32 Particle = Instance.ParticleOffset + Instance.Receivers[ReceiverIndex];
+            const FVector Position(Island.PosX[Particle], Island.PosY[Particle], Island.PosZ[Particle]);
+            const FVector Previous(Island.PrevX[Particle], Island.PrevY[Particle], Island.PrevZ[Particle]);
+            const float Reach = Instance.ReceiverRadii[ReceiverIndex] + FVector::Dist(Position, Previous);
+            if (Shape.Bounds.ExpandBy(Reach).IsInsideOrOn(Position)) {
+                FTemporaryContact& Contact = Island.TemporaryContacts.AddDefaulted_GetRef();
+                Contact.Particle = Particle;
+                Contact.Shape = ShapeHandle;
+                Contact.Radius = Instance.ReceiverRadii[ReceiverIndex];
+            }
+        }
+    }
+}
+
+void FBonamikSceneSolver::RunIslands(const FSettings& Settings) {
+    ParallelFor(Islands.Num(), [this, &Settings](int32 IslandIndex) {
+        SimulateIsland(Islands[IslandIndex], Settings, TemporaryShapes);
+    }, !Settings.bMultiThread || Islands.Num() == 1);
+}
+
+void FBonamikSceneSolver::Simulate(const FSettings& Settings) {
+    NumPreRollPasses = 0;
+    PreRollCost = 0;
+    if (NumLiveInstances == 0) {
+        return;
+    }
+
+    if (bIslandsDirty || GetIslandTarget(Settings) != BuiltIslandTarget) {
+        RebuildIslands(Settings);
+    }
+
+    UploadAnimatedPoses();
+    UpdateTemporaryContacts();
+
+    // Instances that left Frozen restart from the animated pose and catch up on their motion before blending in.
+    int32 PreRollPasses = 0;
+    for (int32 Handle = 0; Handle < Instances.Num(); ++Handle) {
+        FInstance& Instance = Instances[Handle];
+        if (!Instance.bAlive) {
+            continue;
+        }
+        if (Instance.PreRollSteps == INDEX_NONE) {
+            Instance.PreRollSteps = Settings.TimeStep > 0.0f ? FMath::CeilToInt(Instance.PreRollTime / Settings.TimeStep) : 0;
+        }
+        PreRollPasses = FMath::Max(PreRollPasses, Instance.PreRollSteps);
+        // Pre-roll steps run at full rate, see GetStepState().
+        PreRollCost += Instance.PreRollSteps * GetInstanceCost(Handle, Instance.Lod == EBonamikSolverLod::Full ? EBonamikSolverLod::Full : EBonamikSolverLod::ReducedIterations);
+    }
+    for (int32 PreRollPass = 0; PreRollPass < PreRollPasses; ++PreRollPass) {
+        ApplyStepStates(PreRollPass);
+        RunIslands(Settings);
+    }
+    NumPreRollPasses = PreRollPasses;
+    for (FInstance& Instance : Instances) {
+        Instance.PreRollSteps = 0;
+    }
+
+    ApplyStepStates(INDEX_NONE);
+    RunIslands(Settings);
+    UpdateBlendWeights(Settings);
+    ++StepCounter;
+}
+
+void FBonamikSceneSolver::SimulateIsland(FIsland& Island, const FSettings& Settings, const TArray<FTemporaryShapeState>& Shapes) {
+    const int32 SubSteps = FMath::Max(1, Settings.SubSteps);
+    const float StepTime = Settings.TimeStep / SubSteps;
+    const float StepTimeSquared = StepTime * StepTime;
+    const FVector GravityStep = Settings.Gravity * StepTimeSquared;
+
+    // With an override every constraint runs the overridden count, which iteration index 0 always passes.
+    const int32 SolverIterations = Settings.OverrideSolverIteration > 0 ? Settings.OverrideSolverIteration : Island.MaxSolverIterations;
+    const int32 LinkIterations = Settings.OverrideLinkIteration > 0 ? Settings.OverrideLinkIteration : Island.MaxLinkIterations;
+    const int32 CollisionIterations = Settings.OverrideCollisionIteration > 0 ? Settings.OverrideCollisionIteration : Island.MaxCollisionIterations;
+
+    for (int32 SubStep = 0; SubStep < SubSteps; ++SubStep) {
+        IntegrateIsland(Island, GravityStep, StepTimeSquared, SubStep == 0);
+
+        for (int32 SolverIteration = 0; SolverIteration < SolverIterations; ++SolverIteration) {
+            const int32 SolverIndex = Settings.OverrideSolverIteration > 0 ? 0 : SolverIteration;
+            for (int32 Iteration = 0; Iteration < LinkIterations; ++Iteration) {
+                for (const FLinkBatch& Batch : Island.LinkBatches) {
+                    SolveLinkBatch(Island, Batch, SolverIndex, Settings.OverrideLinkIteration > 0 ? 0 : Iteration);
+                }
+            }
+            for (int32 Iteration = 0; Iteration < Island.MaxConeIterations; ++Iteration) {
+                for (const FConeBatch& Batch : Island.ConeBatches) {
+                    SolveConeBatch(Island, Batch, SolverIndex, Iteration);
+                }
+            }
+            for (int32 Iteration = 0; Iteration < CollisionIterations; ++Iteration) {
+                for (const FCollisionBatch& Batch : Island.CollisionBatches) {
+                    SolveCollisionBatch(Island, Batch, SolverIndex, Settings.OverrideCollisionIteration > 0 ? 0 : Iteration);
+                }
+            }
+            SolveTemporaryContacts(Island, Shapes);
+        }
+    }
+}
+
+void FBonamikSceneSolver::IntegrateIsland(FIsland& Island, const FVector& GravityStep, float StepTimeSquared, bool bFirstSubStep) {
+    // Verlet; kinematic particles, pinned instances and the scratch particle follow the animated pose.
+    for (int32 Particle = 0; Particle <= Island.NumParticles; ++Particle) {
+        const EStepState State = Island.StepStates[Particle];
+        if (State == EStepState::Hold) {
+            continue;
+        }
+        if (Island.InvMass[Particle] == 0.0f || State == EStepState::Pin) {
+            Island.PosX[Particle] = Island.PrevX[Particle] = Island.AnimX[Particle];
+            Island.PosY[Particle] = Island.PrevY[Particle] = Island.AnimY[Particle];
+            Island.PosZ[Particle] = Island.PrevZ[Particle] = Island.AnimZ[Particle];
+            continue;
+        }
+
+        const float Decay = Island.StepDecay[Particle] * (bFirstSubStep ? Island.StepVelocityScale[Particle] : 1.0f);
+        const FVector Wind(Island.WindX[Particle], Island.WindY[Particle], Island.WindZ[Particle]);
+        const FVector Gravity = (GravityStep + Wind * StepTimeSquared) * Island.StepGravity[Particle];
+        const float X = Island.PosX[Particle];
+        const float Y = Island.PosY[Particle];
+        const float Z = Island.PosZ[Particle];
+        Island.PosX[Particle] = X + (X - Island.PrevX[Particle]) * Decay + Gravity.X;
+        Island.PosY[Particle] = Y + (Y - Island.PrevY[Particle]) * Decay + Gravity.Y;
+        Island.PosZ[Particle] = Z + (Z - Island.PrevZ[Particle]) * Decay + Gravity.Z;
+        Island.PrevX[Particle] = X;
+        Island.PrevY[Particle] = Y;
+        Island.PrevZ[Particle] = Z;
+    }
+}
+
+void FBonamikSceneSolver::SolveLinkBatch(FIsland& Island, const FLinkBatch& Batch, int32 SolverIteration, int32 Iteration) {
+    using namespace BonamikSceneSolver;
+
+    const VectorRegister SolverIterationVec = VectorSetFloat1((float)SolverIteration);
+    const VectorRegister IterationVec = VectorSetFloat1((float)Iteration);
+    const VectorRegister EpsilonVec = VectorSetFloat1(Epsilon);
+
+    for (const TPair<int32, int32>& Range : Batch.ActiveRanges) {
+        for (int32 Lane = Range.Key; Lane < Range.Value; Lane += 4) {
+            const int32* A = &Batch.A[Lane];
+            const int32* B = &Batch.B[Lane];
+            const VectorRegister AX = Gather(Island.PosX, A);
+            const VectorRegister AY = Gather(Island.PosY, A);
+            const VectorRegister AZ = Gather(Island.PosZ, A);
+            const VectorRegister BX = Gather(Island.PosX, B);
+            const VectorRegister BY = Gather(Island.PosY, B);
+            const VectorRegister BZ = Gather(Island.PosZ, B);
+
+            const VectorRegister DX = VectorSubtract(BX, AX);
+            const VectorRegister DY = VectorSubtract(BY, AY);
+            const VectorRegister DZ = VectorSubtract(BZ, AZ);
+            const VectorRegister LengthSquared = VectorMax(Dot3(DX, DY, DZ, DX, DY, DZ), EpsilonVec);
+            const VectorRegister InvLength = VectorReciprocalSqrtAccurate(LengthSquared);
+            const VectorRegister Length = VectorMultiply(LengthSquared, InvLength);
+
+            // (Length - Rest) / Length along D, split by the precomputed mass and strength weights.
+            const VectorRegister Mask = IterationMask(&Batch.SolverIterations[Lane], &Batch.Iterations[Lane], SolverIterationVec, IterationVec);
+            const VectorRegister Error = VectorBitwiseAnd(VectorMultiply(VectorSubtract(Length, VectorLoad(&Batch.RestLength[Lane])), InvLength), Mask);
+            const VectorRegister ScaleA = VectorMultiply(Error, VectorLoad(&Batch.WeightA[Lane]));
+            const VectorRegister ScaleB = VectorMultiply(Error, VectorLoad(&Batch.WeightB[Lane]));
+
+            Scatter(Island.PosX, A, VectorMultiplyAdd(DX, ScaleA, AX));
+            Scatter(Island.PosY, A, VectorMultiplyAdd(DY, ScaleA, AY));
+            Scatter(Island.PosZ, A, VectorMultiplyAdd(DZ, ScaleA, AZ));
+            Scatter(Island.PosX, B, VectorSubtract(BX, VectorMultiply(DX, ScaleB)));
+            Scatter(Island.PosY, B, VectorSubtract(BY, VectorMultiply(DY, ScaleB)));
+            Scatter(Island.PosZ, B, VectorSubtract(BZ, VectorMultiply(DZ, ScaleB)));
+        }
+    }
+}
+
+void FBonamikSceneSolver::SolveConeBatch(FIsland& Island, const FConeBatch& Batch, int32 SolverIteration, int32 Iteration) {
+    using namespace BonamikSceneSolver;
+
+    const VectorRegister SolverIterationVec = VectorSetFloat1((float)SolverIteration);
+    const VectorRegister IterationVec = VectorSetFloat1((float)Iteration);
+    const VectorRegister EpsilonVec = VectorSetFloat1(Epsilon);
+
+    for (const TPair<int32, int32>& Range : Batch.ActiveRanges) {
+        for (int32 Lane = Range.Key; Lane < Range.Value; Lane += 4) {
+            const int32* Child = &Batch.Child[Lane];
+            const int32* Parent = &Batch.Parent[Lane];
+            const VectorRegister CX = Gather(Island.PosX, Child);
+            const VectorRegister CY = Gather(Island.PosY, Child);
+            const VectorRegister CZ = Gather(Island.PosZ, Child);
+            const VectorRegister PX = Gather(Island.PosX, Parent);
+            const VectorRegister PY = Gather(Island.PosY, Parent);
+            const VectorRegister PZ = Gather(Island.PosZ, Parent);
+
+            // Cone axis: the animated parent to child direction.
+            VectorRegister AxisX = VectorSubtract(Gather(Island.AnimX, Child), Gather(Island.AnimX, Parent));
+            VectorRegister AxisY = VectorSubtract(Gather(Island.AnimY, Child), Gather(Island.AnimY, Parent));
+            VectorRegister AxisZ = VectorSubtract(Gather(Island.AnimZ, Child), Gather(Island.AnimZ, Parent));
+            const VectorRegister InvAxisLength = VectorReciprocalSqrtAccurate(VectorMax(Dot3(AxisX, AxisY, AxisZ, AxisX, AxisY, AxisZ), EpsilonVec));
+            AxisX = VectorMultiply(AxisX, InvAxisLength);
+            AxisY = VectorMultiply(AxisY, InvAxisLength);
+            AxisZ = VectorMultiply(AxisZ, InvAxisLength);
+
+            const VectorRegister VX = VectorSubtract(CX, PX);
+            const VectorRegister VY = VectorSubtract(CY, PY);
+            const VectorRegister VZ = VectorSubtract(CZ, PZ);
+            const VectorRegister LengthSquared = VectorMax(Dot3(VX, VY, VZ, VX, VY, VZ), EpsilonVec);
+            const VectorRegister InvLength = VectorReciprocalSqrtAccurate(LengthSquared);
+            const VectorRegister Length = VectorMultiply(LengthSquared, InvLength);
+            const VectorRegister AlongAxis = Dot3(VX, VY, VZ, AxisX, AxisY, AxisZ);
+
+            const VectorRegister CosLimit = VectorLoad(&Batch.CosLimit[Lane]);
+            const VectorRegister Outside = VectorCompareGT(CosLimit, VectorMultiply(AlongAxis, InvLength));
+
+            // Rotate V onto the cone surface in the plane spanned by V and the axis, keeping its length.
+            const VectorRegister PerpX = VectorSubtract(VX, VectorMultiply(AxisX, AlongAxis));
+            const VectorRegister PerpY = VectorSubtract(VY, VectorMultiply(AxisY, AlongAxis));
+            const VectorRegister PerpZ = VectorSubtract(VZ, VectorMultiply(AxisZ, AlongAxis));
+            const VectorRegister InvPerpLength = VectorReciprocalSqrtAccurate(VectorMax(Dot3(PerpX, PerpY, PerpZ, PerpX, PerpY, PerpZ), EpsilonVec));
+            const VectorRegister AxisScale = VectorMultiply(Length, CosLimit);
+            const VectorRegister PerpScale = VectorMultiply(VectorMultiply(Length, VectorLoad(&Batch.SinLimit[Lane])), InvPerpLength);
+            const VectorRegister TargetX = VectorAdd(PX, VectorMultiplyAdd(AxisX, AxisScale, VectorMultiply(PerpX, PerpScale)));
+            const VectorRegister TargetY = VectorAdd(PY, VectorMultiplyAdd(AxisY, AxisScale, VectorMultiply(PerpY, PerpScale)));
+            const VectorRegister TargetZ = VectorAdd(PZ, VectorMultiplyAdd(AxisZ, AxisScale, VectorMultiply(PerpZ, PerpScale)));
+
+            const VectorRegister Mask = VectorBitwiseAnd(Outside, IterationMask(&Batch.SolverIterations[Lane], &Batch.Iterations[Lane], SolverIterationVec, IterationVec));
+            const VectorRegister Strength = VectorBitwiseAnd(VectorLoad(&Batch.Strength[Lane]), Mask);
+
+            Scatter(Island.PosX, Child, VectorMultiplyAdd(VectorSubtract(TargetX, CX), Strength, CX));
+            Scatter(Island.PosY, Child, VectorMultiplyAdd(VectorSubtract(TargetY, CY), Strength, CY));
+            Scatter(Island.PosZ, Child, VectorMultiplyAdd(VectorSubtract(TargetZ, CZ), Strength, CZ));
+        }
+    }
+}
+
+void FBonamikSceneSolver::SolveCollisionBatch(FIsland& Island, const FCollisionBatch& Batch, int32 SolverIteration, int32 Iteration) {
+    using namespace BonamikSceneSolver;
+
+    const VectorRegister SolverIterationVec = VectorSetFloat1((float)SolverIteration);
+    const VectorRegister IterationVec = VectorSetFloat1((float)Iteration);
+    const VectorRegister EpsilonVec = VectorSetFloat1(Epsilon);
+    const VectorRegister Zero = VectorZero();
+    const VectorRegister One = VectorOne();
+
+    for (const TPair<int32, int32>& Range : Batch.ActiveRanges) {
+        for (int32 Lane = Range.Key; Lane < Range.Value; Lane += 4) {
+            const int32* Particle = &Batch.Particle[Lane];
+            const int32* ShapeA = &Batch.ShapeA[Lane];
+            const int32* ShapeB = &Batch.ShapeB[Lane];
+            const VectorRegister X = Gather(Island.PosX, Particle);
+            const VectorRegister Y = Gather(Island.PosY, Particle);
+            const VectorRegister Z = Gather(Island.PosZ, Particle);
+            const VectorRegister AX = Gather(Island.PosX, ShapeA);
+            const VectorRegister AY = Gather(Island.PosY, ShapeA);
+            const VectorRegister AZ = Gather(Island.PosZ, ShapeA);
+
+            // Closest point on the capsule segment; spheres have a zero length segment and land on ShapeA.
+            const VectorRegister SegX = VectorSubtract(Gather(Island.PosX, ShapeB), AX);
+            const VectorRegister SegY = VectorSubtract(Gather(Island.PosY, ShapeB), AY);
+            const VectorRegister SegZ = VectorSubtract(Gather(Island.PosZ, ShapeB), AZ);
+            const VectorRegister Projection = Dot3(VectorSubtract(X, AX), VectorSubtract(Y, AY), VectorSubtract(Z, AZ), SegX, SegY, SegZ);
+            const VectorRegister SegLengthSquared = VectorMax(Dot3(SegX, SegY, SegZ, SegX, SegY, SegZ), EpsilonVec);
+            const VectorRegister T = VectorMin(VectorMax(VectorMultiply(Projection, VectorReciprocalAccurate(SegLengthSquared)), Zero), One);
+
+            const VectorRegister DX = VectorSubtract(X, VectorMultiplyAdd(SegX, T, AX));
+            const VectorRegister DY = VectorSubtract(Y, VectorMultiplyAdd(SegY, T, AY));
+            const VectorRegister DZ = VectorSubtract(Z, VectorMultiplyAdd(SegZ, T, AZ));
+            const VectorRegister DistanceSquared = VectorMax(Dot3(DX, DY, DZ, DX, DY, DZ), EpsilonVec);
+            const VectorRegister InvDistance = VectorReciprocalSqrtAccurate(DistanceSquared);
+            const VectorRegister Penetration = VectorMax(VectorSubtract(VectorLoad(&Batch.Radius[Lane]), VectorMultiply(DistanceSquared, InvDistance)), Zero);
+
+            const VectorRegister Mask = IterationMask(&Batch.SolverIterations[Lane], &Batch.Iterations[Lane], SolverIterationVec, IterationVec);
+            const VectorRegister Push = VectorBitwiseAnd(VectorMultiply(Penetration, InvDistance), Mask);
+
+            Scatter(Island.PosX, Particle, VectorMultiplyAdd(DX, Push, X));
+            Scatter(Island.PosY, Particle, VectorMultiplyAdd(DY, Push, Y));
+            Scatter(Island.PosZ, Particle, VectorMultiplyAdd(DZ, Push, Z));
+        }
+    }
+}
+
+void FBonamikSceneSolver::SolveTemporaryContacts(FIsland& Island, const TArray<FTemporaryShapeState>& Shapes) {
+    for (const FTemporaryContact& Contact : Island.TemporaryContacts) {
+        const int32 Particle = Contact.Particle;
+        const EStepState State = Island.StepStates[Particle];
+        if (State == EStepState::Hold || State == EStepState::Pin || Island.InvMass[Particle] == 0.0f) {
+            continue;
+        }
+
+        const FTemporaryShape& Shape = Shapes[Contact.Shape].Shape;
+        const FVector Local = Shape.Transform.InverseTransformPositionNoScale(FVector(Island.PosX[Particle], Island.PosY[Particle], Island.PosZ[Particle]));
+        FVector Pushed;
+        if (BonamikSceneSolver::PushOut(Shape, Local, Contact.Radius, Pushed)) {
+            const FVector World = Shape.Transform.TransformPositionNoScale(Pushed);
+            Island.PosX[Particle] = World.X;
+            Island.PosY[Particle] = World.Y;
+            Island.PosZ[Particle] = World.Z;
+        }
+    }
+}
@@ -0,0 +1,588 @@
+#include "BonamikWindField.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "CustomWindSettings.h"
+#include "SQEX_BonamikWindDesc_v2.h"
+#include "SQEX_BonamikWind_Desc.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBonamikWindField, Log, All);
+
+namespace BonamikWindField {
+    // Rasterizations a brick survives without being requested, so characters that skip a frame keep their bricks.
+    static const uint32 BrickKeepAlive = 30;
+
+    // Larger regions are not worth caching and sample the sources directly.
+    static const int32 MaxBricksPerRequest = 512;
+
+    // Repeatable value in [-1, 1] for one random draw of one axis.
+    static float GetRandom(uint32 Seed, int32 Key) {
+        uint32 Hash = Seed * 0x9E3779B9u ^ (uint32)Key * 0x85EBCA6Bu;
+        Hash ^= Hash >> 16;
+        Hash *= 0x7FEB352Du;
+        Hash ^= Hash >> 15;
+        Hash *= 0x846CA68Bu;
+        Hash ^= Hash >> 16;
+        return (float)(Hash & 0xFFFFFF) / (float)0xFFFFFF * 2.0f - 1.0f;
+    }
+
+    static FVector GetRandomOffset(const FBonamikWindSource& Source, float Time) {
+        if (Source.RandomTime <= 0.0f || Source.RandomRange.IsZero()) {
+            return FVector::ZeroVector;
+        }
+
+        const float Phase = Time / Source.RandomTime;
+        const int32 Key = FMath::FloorToInt(Phase);
+        float Alpha = Phase - (float)Key;
+        Alpha = Alpha * Alpha * (3.0f - 2.0f * Alpha);
+
+        FVector Offset;
+        for (int32 Axis = 0; Axis < 3; ++Axis) {
+            const uint32 Seed = Source.Seed * 3 + Axis;
+            Offset[Axis] = FMath::Lerp(GetRandom(Seed, Key), GetRandom(Seed, Key + 1), Alpha) * Source.RandomRange[Axis];
+        }
+        return Offset;
+    }
+
+    static FVector GetWaveOffset(const FBonamikWindSource& Source, float Time) {
+        FVector Offset;
+        for (int32 Axis = 0; Axis < 3; ++Axis) {
+            const float Angle = 2.0f * PI * (Source.WaveFrequency[Axis] * Time + Source.WaveFreqOffset[Axis]);
+            Offset[Axis] = Source.WaveMagOffset[Axis] + Source.WaveMagnitude[Axis] * FMath::Sin(Angle);
+        }
+        return Offset;
+    }
+
+    static FVector GetCustomWaveOffset(const FBonamikWindSource& Source, float Time) {
+        const int32 NumKeys = Source.CustomWave.Num();
+        if (NumKeys == 0) {
+            return FVector::ZeroVector;
+        }
+        if (NumKeys == 1 || Source.CustomWaveTime <= 0.0f) {
+            return Source.CustomWave[0];
+        }
+
+        const float Phase = FMath::Fractional(Time / Source.CustomWaveTime);
+        const float Key = (Phase < 0.0f ? Phase + 1.0f : Phase) * (float)NumKeys;
+        const int32 Index = FMath::Min(FMath::FloorToInt(Key), NumKeys - 1);
+        return FMath::Lerp(Source.CustomWave[Index], Source.CustomWave[(Index + 1) % NumKeys], Key - (float)Index);
+    }
+
+    static bool IsInsideArea(const FBonamikWindSource& Source, const FVector& Position) {
+        switch (Source.Area) {
+        case EBonamikWindArea::Box: {
+            const FVector Local = Source.Transform.InverseTransformPosition(Position);
+            return FMath::Abs(Local.X) <= Source.Extent.X && FMath::Abs(Local.Y) <= Source.Extent.Y && FMath::Abs(Local.Z) <= Source.Extent.Z;
+        }
+        case EBonamikWindArea::Sphere:
+            return FVector::DistSquared(Position, Source.Transform.GetLocation()) <= FMath::Square(Source.Radius);
+        default:
+            return true;
+        }
+    }
+}
+
+FBonamikWindSource::FBonamikWindSource() {
+    this->Type = EBonamikWindSourceType::Directional;
+    this->Area = EBonamikWindArea::Global;
+    this->Transform = FTransform::Identity;
+    this->Extent = FVector::ZeroVector;
+    this->Radius = 0.0f;
+    this->Force = FVector::ZeroVector;
+    this->RandomRange = FVector::ZeroVector;
+    this->RandomTime = 0.0f;
+    this->WaveMagnitude = FVector::ZeroVector;
+    this->WaveFrequency = FVector::ZeroVector;
+    this->WaveMagOffset = FVector::ZeroVector;
+    this->WaveFreqOffset = FVector::ZeroVector;
+    this->CustomWaveTime = 0.0f;
+    this->PointStrength = 0.0f;
+    this->PointRadius = 0.0f;
+    this->BlastRange = 0.0f;
+    this->BlastSpeed = 0.0f;
+    this->StartTime = 0.0f;
+    this->Scale = 1.0f;
+    this->Seed = 0;
+}
+
+FBonamikWindSource FBonamikWindSource::FromWindDesc(const USQEX_BonamikWindDesc_v2& Desc) {
+    FBonamikWindSource Source;
+    switch (Desc.m_WindType) {
+    case ESQEX_Bonamik_WindType_Wave:
+        Source.Type = EBonamikWindSourceType::Wave;
+        break;
+    case ESQEX_Bonamik_WindType_CustomWave:
+        Source.Type = EBonamikWindSourceType::CustomWave;
+        break;
+    case ESQEX_Bonamik_WindType_PointBlast:
+        Source.Type = EBonamikWindSourceType::Point;
+        break;
+    default:
+        break;
+    }
+
+    Source.Force = Desc.m_WindForce;
+    Source.RandomRange = Desc.m_RandomRange;
+    Source.RandomTime = Desc.m_RandomTime;
+    Source.WaveMagnitude = Desc.m_WaveMagnitude;
+    Source.WaveFrequency = Desc.m_WaveFrequency;
+    Source.WaveMagOffset = Desc.m_WaveMagOffset;
+    Source.WaveFreqOffset = Desc.m_WaveFreqOffset;
+    Source.PointStrength = Desc.m_PointStrength;
+    Source.PointRadius = Desc.m_PointRadius;
+    Source.BlastRange = Desc.m_BlastRange;
+    Source.BlastSpeed = Desc.m_BlastSpeed;
+
+    const int32 NumKeys = FMath::Max3(Desc.m_DataX.Num(), Desc.m_DataY.Num(), Desc.m_DataZ.Num());
+    Source.CustomWaveTime = Desc.m_CustomWaveTime;
+    Source.CustomWave.SetNum(NumKeys);
+    for (int32 Key = 0; Key < NumKeys; ++Key) {
+        const FVector Value(Desc.m_DataX.IsValidIndex(Key) ? Desc.m_DataX[Key] : 0.0f,
+                            Desc.m_DataY.IsValidIndex(Key) ? Desc.m_DataY[Key] : 0.0f,
+                            Desc.m_DataZ.IsValidIndex(Key) ? Desc.m_DataZ[Key] : 0.0f);
+        Source.CustomWave[Key] = Value * Desc.m_CustomWaveScale + Desc.m_CustomWaveOffset;
+    }
+    return Source;
+}
+
+FBonamikWindSource FBonamikWindSource::FromCustomWindSettings(const FCustomWindSettings& Settings) {
+    FBonamikWindSource Source;
+    switch (Settings.m_WindType) {
+    case ESQEX_Bonamik_CustomWindType_Wave:
+        Source.Type = EBonamikWindSourceType::Wave;
+        break;
+    case ESQEX_Bonamik_CustomWindType_PointBlast:
+        Source.Type = EBonamikWindSourceType::Point;
+        break;
+    default:
+        break;
+    }
+
+    Source.Force = Settings.m_WindForce;
+    Source.RandomRange = Settings.m_RandomRange;
+    Source.RandomTime = Settings.m_RandomTime;
+    Source.WaveMagnitude = Settings.m_WaveMagnitude;
+    Source.WaveFrequency = Settings.m_WaveFrequency;
+    Source.WaveMagOffset = Settings.m_WaveMagOffset;
+    Source.WaveFreqOffset = Settings.m_WaveFreqOffset;
+    Source.PointStrength = Settings.m_PointStrength;
+    Source.PointRadius = Settings.m_PointRadius;
+    Source.BlastRange = Settings.m_BlastRange;
+    Source.BlastSpeed = Settings.m_BlastSpeed;
+    return Source;
+}
+
+FBonamikWindSource FBonamikWindSource::FromLocalWindDesc(const FSQEX_BonamikWind_Desc& Desc) {
+    FBonamikWindSource Source;
+    Source.Transform = FTransform(Desc.mLocalRotate, Desc.mLocalTranslate);
+    Source.Scale = Desc.mEnable ? 1.0f : 0.0f;
+    Source.Seed = Desc.mNoiseSeed;
+    if (Desc.mType == ESQEX_BonamikWind_PointSource) {
+        Source.Type = EBonamikWindSourceType::Point;
+        Source.PointStrength = Desc.mWindSpeed + Desc.mWindConstantSpeed;
+        Source.PointRadius = Desc.mDistanceModulationFar;
+    } else {
+        Source.Force = Desc.mForward.GetSafeNormal() * (Desc.mWindSpeed + Desc.mWindConstantSpeed);
+        if (Desc.mDistanceModulationFar > 0.0f) {
+            Source.Area = EBonamikWindArea::Sphere;
+            Source.Radius = Desc.mDistanceModulationFar;
+        }
+    }
+    return Source;
+}
+
+bool FBonamikWindSource::GetBounds(FBox& OutBounds) const {
+    bool bBounded = false;
+    if (Area == EBonamikWindArea::Box) {
+        OutBounds = FBox(-Extent, Extent).TransformBy(Transform);
+        bBounded = true;
+    } else if (Area == EBonamikWindArea::Sphere) {
+        OutBounds = FBox(Transform.GetLocation() - FVector(Radius), Transform.GetLocation() + FVector(Radius));
+        bBounded = true;
+    }
+
+    if (Type == EBonamikWindSourceType::Point) {
+        float Reach = BlastRange > 0.0f ? BlastRange : BIG_NUMBER;
+        if (PointRadius > 0.0f) {
+            Reach = FMath::Min(Reach, PointRadius);
+        }
+        if (Reach < BIG_NUMBER) {
+            const FBox ReachBounds(Transform.GetLocation() - FVector(Reach), Transform.GetLocation() + FVector(Reach));
+            OutBounds = bBounded ? OutBounds.Overlap(ReachBounds) : ReachBounds;
+            bBounded = true;
+        }
+    }
+    return bBounded;
+}
+
+bool FBonamikWindSource::IsUniform() const {
+    return Area == EBonamikWindArea::Global && Type != EBonamikWindSourceType::Point;
+}
+
+FVector FBonamikWindSource::Evaluate(const FVector& Position, float Time) const {
+    using namespace BonamikWindField;
+
+    if (Scale == 0.0f || !IsInsideArea(*this, Position)) {
+        return FVector::ZeroVector;
+    }
+
+    FVector Wind = Force;
+    switch (Type) {
+    case EBonamikWindSourceType::Wave:
+        Wind += GetWaveOffset(*this, Time);
+        break;
+    case EBonamikWindSourceType::CustomWave:
+        Wind += GetCustomWaveOffset(*this, Time);
+        break;
+    case EBonamikWindSourceType::Point: {
+        // The blast front travels out from the source; nothing blows past it or at the source itself.
+        const FVector Offset = Position - Transform.GetLocation();
+        const float Distance = Offset.Size();
+        float Front = BlastRange > 0.0f ? BlastRange : BIG_NUMBER;
+        if (BlastSpeed > 0.0f) {
+            Front = FMath::Min(Front, BlastSpeed * FMath::Max(Time - StartTime, 0.0f));
+        }
+        if (Distance > Front || Distance < KINDA_SMALL_NUMBER) {
+            return FVector::ZeroVector;
+        }
+
+        const float Falloff = PointRadius > 0.0f ? FMath::Clamp(1.0f - Distance / PointRadius, 0.0f, 1.0f) : 1.0f;
+        Wind = Offset * (PointStrength * Falloff / Distance);
+        break;
+    }
+    default:
+        break;
+    }
+
+    return (Wind + GetRandomOffset(*this, Time)) * Scale;
+}
+
+FBonamikWindField::FBonamikWindField() {
+    this->NumLiveSources = 0;
+    this->GlobalWind = FVector::ZeroVector;
+    this->UniformWind = FVector::ZeroVector;
+    this->CellSize = 100.0f;
+    this->Time = 0.0f;
+    this->Generation = 0;
+}
+
+int32 FBonamikWindField::AddSource(const FBonamikWindSource& Source) {
+    const int32 Handle = FreeSources.Num() > 0 ? FreeSources.Pop(false) : Sources.AddDefaulted();
+    FSourceSlot& Slot = Sources[Handle];
+    Slot.bAlive = true;
+    ++NumLiveSources;
+
+    SetSource(Handle, Source);
+    return Handle;
+}
+
+void FBonamikWindField::SetSource(int32 Handle, const FBonamikWindSource& Source) {
+    if (!IsValidSource(Handle)) {
+        return;
+    }
+
+    FSourceSlot& Slot = Sources[Handle];
+    Slot.Source = Source;
+    Slot.bBounded = Source.GetBounds(Slot.Bounds);
+}
+
+void FBonamikWindField::RemoveSource(int32 Handle) {
+    if (!IsValidSource(Handle)) {
+        return;
+    }
+
+    Sources[Handle] = FSourceSlot();
+    Sources[Handle].bAlive = false;
+    FreeSources.Add(Handle);
+    --NumLiveSources;
+}
+
+bool FBonamikWindField::IsValidSource(int32 Handle) const {
+    return Sources.IsValidIndex(Handle) && Sources[Handle].bAlive;
+}
+
+void FBonamikWindField::SetGlobalWind(const FVector& Wind) {
+    GlobalWind = Wind;
+}
+
+FIntVector FBonamikWindField::GetBrickKey(const FVector& Position) const {
+    const float BrickSize = CellSize * (float)BrickCells;
+    return FIntVector(FMath::FloorToInt(Position.X / BrickSize), FMath::FloorToInt(Position.Y / BrickSize), FMath::FloorToInt(Position.Z / BrickSize));
+}
+
+void FBonamikWindField::RequestRegion(const FBox& Box) {
+    if (Box.IsValid) {
+        RequestedRegions.Add(Box);
+    }
+}
+
+void FBonamikWindField::Rasterize(const FVector& Center, bool bUseCenter, float Range, float InCellSize, float InTime, bool bMultiThread) {
+    using namespace BonamikWindField;
+
+    InCellSize = FMath::Max(InCellSize, 1.0f);
+    if (InCellSize != CellSize) {
+        CellSize = InCellSize;
+        Bricks.Reset();
+        BrickMap.Reset();
+    }
+
+    Time = InTime;
+    ++Generation;
+    NumFallbackSamples.Reset();
+
+    UniformWind = GlobalWind;
+    LocalSources.Reset();
+    for (int32 Handle = 0; Handle < Sources.Num(); ++Handle) {
+        const FSourceSlot& Slot = Sources[Handle];
+        if (!Slot.bAlive) {
+            continue;
+        }
+        if (Slot.Source.IsUniform()) {
+            UniformWind += Slot.Source.Evaluate(FVector::ZeroVector, Time);
+        } else {
+            LocalSources.Add(Handle);
+        }
+    }
+
+    for (const FBox& Region : RequestedRegions) {
+        const FIntVector Min = GetBrickKey(Region.Min);
+        const FIntVector Max = GetBrickKey(Region.Max);
+        const int64 NumRegionBricks = (int64)(Max.X - Min.X + 1) * (int64)(Max.Y - Min.Y + 1) * (int64)(Max.Z - Min.Z + 1);
+        if (NumRegionBricks > MaxBricksPerRequest) {
+            continue;
+        }
+
+        for (int32 Z = Min.Z; Z <= Max.Z; ++Z) {
+            for (int32 Y = Min.Y; Y <= Max.Y; ++Y) {
+                for (int32 X = Min.X; X <= Max.X; ++X) {
+                    const FIntVector Key(X, Y, Z);
+                    const int32* Found = BrickMap.Find(Key);
+                    int32 Brick;
+                    if (Found != NULL) {
+                        Brick = *Found;
+                    } else {
+                        Brick = Bricks.AddUninitialized();
+                        Bricks[Brick].Key = Key;
+                        BrickMap.Add(Key, Brick);
+                    }
+                    Bricks[Brick].LastRequest = Generation;
+                }
+            }
+        }
+    }
+    RequestedRegions.Reset();
+
+    const float BrickSize = CellSize * (float)BrickCells;
+    const float MaxDistance = Range + BrickSize * 0.87f;
+    bool bRemoved = false;
+    for (int32 Brick = Bricks.Num() - 1; Brick >= 0; --Brick) {
+        const FVector BrickCenter = (FVector(Bricks[Brick].Key) + FVector(0.5f)) * BrickSize;
+        const bool bStale = Generation - Bricks[Brick].LastRequest > BrickKeepAlive;
+        if (bStale || (bUseCenter && FVector::DistSquared(BrickCenter, Center) > FMath::Square(MaxDistance))) {
+            Bricks.RemoveAtSwap(Brick, 1, false);
+            bRemoved = true;
+        }
+    }
+    if (bRemoved) {
+        BrickMap.Reset();
+        for (int32 Brick = 0; Brick < Bricks.Num(); ++Brick) {
+            BrickMap.Add(Bricks[Brick].Key, Brick);
+        }
+    }
+
+    ParallelFor(Bricks.Num(), [this](int32 Brick) {
+        RasterizeBrick(Bricks[Brick]);
+    }, !bMultiThread);
+}
+
+void FBonamikWindField::RasterizeBrick(FBrick& Brick) const {
+    const float BrickSize = CellSize * (float)BrickCells;
+    const FVector Origin = FVector(Brick.Key) * BrickSize;
+    const FBox BrickBox(Origin, Origin + FVector(BrickSize));
+
+    TArray<const FBonamikWindSource*, TInlineAllocator<16>> Overlapping;
+    for (int32 Handle : LocalSources) {
+        const FSourceSlot& Slot = Sources[Handle];
+        if (!Slot.bBounded || Slot.Bounds.Intersect(BrickBox)) {
+            Overlapping.Add(&Slot.Source);
+        }
+    }
+
+    FVector* Node = Brick.Nodes;
+    for (int32 Z = 0; Z < BrickNodes; ++Z) {
+        for (int32 Y = 0; Y < BrickNodes; ++Y) {
+            for (int32 X = 0; X < BrickNodes; ++X) {
+                const FVector Position = Origin + FVector((float)X, (float)Y, (float)Z) * CellSize;
+                FVector Wind = UniformWind;
+                for (const FBonamikWindSource* Source : Overlapping) {
+                    Wind += Source->Evaluate(Position, Time);
+                }
+                *Node++ = Wind;
+            }
+        }
+    }
+}
+
+FVector FBonamikWindField::Sample(const FVector& Position) const {
+    const FIntVector Key = GetBrickKey(Position);
+    const int32* Brick = BrickMap.Find(Key);
+    if (Brick == NULL) {
+        NumFallbackSamples.Increment();
+        return Evaluate(Position);
+    }
+
+    const FVector Local = Position / CellSize - FVector(Key) * (float)BrickCells;
+    const int32 X = FMath::Clamp(FMath::FloorToInt(Local.X), 0, BrickCells - 1);
+    const int32 Y = FMath::Clamp(FMath::FloorToInt(Local.Y), 0, BrickCells - 1);
+    const int32 Z = FMath::Clamp(FMath::FloorToInt(Local.Z), 0, BrickCells - 1);
+    const float AlphaX = Local.X - (float)X;
+    const float AlphaY = Local.Y - (float)Y;
+    const float AlphaZ = Local.Z - (float)Z;
+
+    const FVector* Node = Bricks[*Brick].Nodes + X + (Y + Z * BrickNodes) * BrickNodes;
+    const int32 StrideY = BrickNodes;
+    const int32 StrideZ = BrickNodes * BrickNodes;
+    const FVector Y0 = FMath::Lerp(FMath::Lerp(Node[0], Node[1], AlphaX), FMath::Lerp(Node[StrideY], Node[StrideY + 1], AlphaX), AlphaY);
+    const FVector Y1 = FMath::Lerp(FMath::Lerp(Node[StrideZ], Node[StrideZ + 1], AlphaX), FMath::Lerp(Node[StrideZ + StrideY], Node[StrideZ + StrideY + 1], AlphaX), AlphaY);
+    return FMath::Lerp(Y0, Y1, AlphaZ);
+}
+
+void FBonamikWindField::SampleBatch(const TArray<FVector>& Positions, TArray<FVector>& OutWind) const {
+    OutWind.SetNumUninitialized(Positions.Num());
+    for (int32 Index = 0; Index < Positions.Num(); ++Index) {
+        OutWind[Index] = Sample(Positions[Index]);
+    }
+}
+
+FVector FBonamikWindField::Evaluate(const FVector& Position) const {
+    FVector Wind = GlobalWind;
+    for (const FSourceSlot& Slot : Sources) {
+        if (Slot.bAlive) {
+            Wind += Slot.Source.Evaluate(Position, Time);
+        }
+    }
+    return Wind;
+}
+
+FBox FBonamikWindField::GetBrickBounds(int32 Brick) const {
+    const float BrickSize = CellSize * (float)BrickCells;
+    const FVector Origin = FVector(Bricks[Brick].Key) * BrickSize;
+    return FBox(Origin, Origin + FVector(BrickSize));
+}
+
+namespace BonamikWindField {
+    static void Benchmark(const TArray<FString>& Args) {
+        const int32 NumSources = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 64;
+        const int32 NumClouds = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 32;
+        const int32 NumFrames = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 120;
+        const float CellSize = Args.Num() > 3 ? FMath::Max(FCString::Atof(*Args[3]), 1.0f) : 100.0f;
+        const int32 ParticlesPerCloud = 256;
+        const float WorldExtent = 3000.0f;
+        const float CloudExtent = 60.0f;
+        const float FrameTime = 1.0f / 30.0f;
+
+        FRandomStream Random(0xB0A41D);
+        auto RandomVector = [&Random](float Extent) {
+            return FVector(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent));
+        };
+
+        // A uniform breeze plus local gusts and blasts spread over the world.
+        FBonamikWindField Field;
+        Field.SetGlobalWind(FVector(50.0f, 0.0f, 0.0f));
+        FBonamikWindSource Breeze;
+        Breeze.Type = EBonamikWindSourceType::Wave;
+        Breeze.WaveMagnitude = FVector(100.0f, 50.0f, 0.0f);
+        Breeze.WaveFrequency = FVector(0.3f, 0.5f, 0.0f);
+        Breeze.RandomRange = FVector(30.0f);
+        Breeze.RandomTime = 0.7f;
+        Field.AddSource(Breeze);
+        for (int32 Index = 0; Index < NumSources; ++Index) {
+            FBonamikWindSource Source;
+            Source.Transform.SetLocation(RandomVector(WorldExtent));
+            Source.Seed = Index + 1;
+            if (Index % 2 == 0) {
+                Source.Type = EBonamikWindSourceType::Point;
+                Source.PointStrength = Random.FRandRange(200.0f, 800.0f);
+                Source.PointRadius = Random.FRandRange(300.0f, 1200.0f);
+                Source.BlastSpeed = 1000.0f;
+            } else {
+                Source.Area = EBonamikWindArea::Sphere;
+                Source.Radius = Random.FRandRange(300.0f, 1200.0f);
+                Source.Force = RandomVector(300.0f);
+                Source.RandomRange = FVector(50.0f);
+                Source.RandomTime = 0.5f;
+            }
+            Field.AddSource(Source);
+        }
+
+        TArray<FVector> CloudCenters;
+        TArray<FVector> CloudVelocities;
+        TArray<FVector> Offsets;
+        for (int32 Cloud = 0; Cloud < NumClouds; ++Cloud) {
+            CloudCenters.Add(RandomVector(WorldExtent));
+            CloudVelocities.Add(RandomVector(20.0f));
+            for (int32 Particle = 0; Particle < ParticlesPerCloud; ++Particle) {
+                Offsets.Add(RandomVector(CloudExtent));
+            }
+        }
+
+        TArray<FVector> Positions;
+        TArray<FVector> DirectWind;
+        TArray<FVector> GridWind;
+        Positions.SetNumUninitialized(Offsets.Num());
+        DirectWind.SetNumUninitialized(Offsets.Num());
+
+        double DirectSeconds = 0.0;
+        double RasterizeSeconds = 0.0;
+        double SampleSeconds = 0.0;
+        double ErrorSum = 0.0;
+        double WindSum = 0.0;
+        int64 NumBricks = 0;
+        int64 NumFallbacks = 0;
+        for (int32 Frame = 0; Frame < NumFrames; ++Frame) {
+            const float Time = (float)Frame * FrameTime;
+            for (int32 Cloud = 0; Cloud < NumClouds; ++Cloud) {
+                CloudCenters[Cloud] += CloudVelocities[Cloud];
+                for (int32 Particle = 0; Particle < ParticlesPerCloud; ++Particle) {
+                    const int32 Index = Cloud * ParticlesPerCloud + Particle;
+                    Positions[Index] = CloudCenters[Cloud] + Offsets[Index];
+                }
+            }
+
+            for (int32 Cloud = 0; Cloud < NumClouds; ++Cloud) {
+                Field.RequestRegion(FBox(CloudCenters[Cloud] - FVector(CloudExtent), CloudCenters[Cloud] + FVector(CloudExtent)));
+            }
+            double StartTime = FPlatformTime::Seconds();
+            Field.Rasterize(FVector::ZeroVector, false, 0.0f, CellSize, Time, false);
+            RasterizeSeconds += FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            for (int32 Index = 0; Index < Positions.Num(); ++Index) {
+                DirectWind[Index] = Field.Evaluate(Positions[Index]);
+            }
+            DirectSeconds += FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            Field.SampleBatch(Positions, GridWind);
+            SampleSeconds += FPlatformTime::Seconds() - StartTime;
+
+            for (int32 Index = 0; Index < Positions.Num(); ++Index) {
+                ErrorSum += FVector::Dist(DirectWind[Index], GridWind[Index]);
+                WindSum += DirectWind[Index].Size();
+            }
+            NumBricks += Field.GetNumBricks();
+            NumFallbacks += Field.GetNumFallbackSamples();
+        }
+
+        UE_LOG(LogBonamikWindField, Display, TEXT("%d sources, %d x %d particles, %d frames, %.0f cm cells: direct %.3f ms/frame, grid %.3f ms/frame (rasterize %.3f, sample %.3f, %.1f bricks, %.1f fallback samples), mean error %.2f%%"),
+            NumSources + 1, NumClouds, ParticlesPerCloud, NumFrames, CellSize, DirectSeconds * 1000.0 / NumFrames, (RasterizeSeconds + SampleSeconds) * 1000.0 / NumFrames,
+            RasterizeSeconds * 1000.0 / NumFrames, SampleSeconds * 1000.0 / NumFrames, (double)NumBricks / NumFrames, (double)NumFallbacks / NumFrames,
+            WindSum > 0.0 ? ErrorSum * 100.0 / WindSum : 0.0);
+    }
+}
+
+static FAutoConsoleCommand CmdBonamikWindFieldBenchmark(
+    TEXT("bonamik.WindField.Benchmark"),
+    TEXT("Compares evaluating every wind source per particle with the sparse wind grid on a synthetic scene. Usage: bonamik.WindField.Benchmark [NumSources] [NumClouds] [NumFrames] [CellSize]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BonamikWindField::Benchmark));
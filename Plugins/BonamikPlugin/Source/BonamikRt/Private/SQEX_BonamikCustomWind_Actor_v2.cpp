@@ -1,6 +1,11 @@
 #include "SQEX_BonamikCustomWind_Actor_v2.h"
+#include "BonamikWindField.h"
 
 ADEPRECATED_SQEX_BonamikCustomWind_Actor_v2::ADEPRECATED_SQEX_BonamikCustomWind_Actor_v2(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
 }
 
+bool ADEPRECATED_SQEX_BonamikCustomWind_Actor_v2::GetWindSettings(FBonamikWindSource& OutSource) const {
+    OutSource = FBonamikWindSource::FromCustomWindSettings(m_WindSetting);
+    return true;
+}
 
@@ -28,6 +28,8 @@ USQEX_BonamikGlobalConfig_v2::USQEX_BonamikGlobalConfig_v2() {
     this->OverrideCollisionIteration = 0;
     this->OverrideLinkIteration = 0;
     this->OverrideSolverIteration = 0;
+    this->bBatchedSceneSolver = false;
+    this->BatchedSolverMinParticlesPerIsland = 256;
 }
 
 
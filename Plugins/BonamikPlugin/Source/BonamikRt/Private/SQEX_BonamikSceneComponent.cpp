@@ -0,0 +1,132 @@
+#include "SQEX_BonamikSceneComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "GameFramework/Actor.h"
+#include "SQEX_BonamikAssetUserData_v2.h"
+#include "SQEX_BonamikAsset_v2.h"
+#include "SQEX_BonamikGlobalConfig_v2.h"
+#include "SQEX_BonamikSceneSubsystem.h"
+
+USQEX_BonamikSceneComponent::USQEX_BonamikSceneComponent(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
+    this->SkeletalMeshComponent = NULL;
+    this->PrimaryComponentTick.bCanEverTick = true;
+    this->PrimaryComponentTick.bStartWithTickEnabled = false;
+    // The animated pose of the frame is final once physics ran.
+    this->PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void USQEX_BonamikSceneComponent::BeginPlay() {
+    Super::BeginPlay();
+
+    USQEX_BonamikSceneSubsystem* Subsystem = USQEX_BonamikSceneSubsystem::Get(this);
+    if (Subsystem == NULL || !GetDefault<USQEX_BonamikGlobalConfig_v2>()->bBatchedSceneSolver) {
+        return;
+    }
+
+    if (SkeletalMeshComponent == NULL && GetOwner() != NULL) {
+        SkeletalMeshComponent = GetOwner()->FindComponentByClass<USkeletalMeshComponent>();
+    }
+    if (SkeletalMeshComponent == NULL) {
+        return;
+    }
+
+    TArray<USQEX_BonamikAsset_v2*> Assets = BonamikAssets;
+    const USQEX_BonamikAssetUserData_v2* UserData = SkeletalMeshComponent->SkeletalMesh != NULL ? SkeletalMeshComponent->SkeletalMesh->GetAssetUserData<USQEX_BonamikAssetUserData_v2>() : NULL;
+    if (Assets.Num() == 0 && UserData != NULL) {
+        Assets = UserData->BonamikAssets;
+    }
+
+    for (const USQEX_BonamikAsset_v2* Asset : Assets) {
+        if (Asset == NULL) {
+            continue;
+        }
+
+        // Assets authored for another skeleton, or for joints this mesh doesn't have, are skipped as a whole.
+        FInstance Instance;
+        for (const FSQEX_BonamikBodyDesc_v2& Body : Asset->m_Bodies) {
+            const int32 BoneIndex = SkeletalMeshComponent->GetBoneIndex(FName(*Body.m_JointName));
+            if (BoneIndex == INDEX_NONE) {
+                break;
+            }
+            Instance.BoneIndices.Add(BoneIndex);
+        }
+        if (Instance.BoneIndices.Num() != Asset->m_Bodies.Num()) {
+            continue;
+        }
+
+        GetBonePositions(Instance.BoneIndices, Instance.Positions);
+        Instance.Handle = Subsystem->RegisterInstance(Asset, Instance.Positions);
+        if (Instance.Handle == INDEX_NONE) {
+            continue;
+        }
+
+        for (int32 BodyIndex = 0; BodyIndex < Asset->m_Bodies.Num(); ++BodyIndex) {
+            SimulatedBones.Add(FName(*Asset->m_Bodies[BodyIndex].m_JointName), TPair<int32, int32>(Instances.Num(), BodyIndex));
+        }
+        Instances.Add(MoveTemp(Instance));
+    }
+
+    if (Instances.Num() > 0) {
+        AddTickPrerequisiteComponent(SkeletalMeshComponent);
+        SetComponentTickEnabled(true);
+    }
+}
+
+void USQEX_BonamikSceneComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+    UnregisterInstances();
+    Super::EndPlay(EndPlayReason);
+}
+
+void USQEX_BonamikSceneComponent::UnregisterInstances() {
+    USQEX_BonamikSceneSubsystem* Subsystem = USQEX_BonamikSceneSubsystem::Get(this);
+    if (Subsystem != NULL) {
+        for (const FInstance& Instance : Instances) {
+            Subsystem->UnregisterInstance(Instance.Handle);
+        }
+    }
+    Instances.Reset();
+    SimulatedBones.Reset();
+    SetComponentTickEnabled(false);
+}
+
+void USQEX_BonamikSceneComponent::GetBonePositions(const TArray<int32>& BoneIndices, TArray<FVector>& OutPositions) const {
+    OutPositions.SetNumUninitialized(BoneIndices.Num());
+    for (int32 Index = 0; Index < BoneIndices.Num(); ++Index) {
+        OutPositions[Index] = SkeletalMeshComponent->GetBoneTransform(BoneIndices[Index]).GetLocation();
+    }
+}
+
+void USQEX_BonamikSceneComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    USQEX_BonamikSceneSubsystem* Subsystem = USQEX_BonamikSceneSubsystem::Get(this);
+    if (Subsystem == NULL || SkeletalMeshComponent == NULL) {
+        return;
+    }
+
+    // The subsystem solves after every actor ticked, so the positions read here are those of the previous solve.
+    TArray<FVector> AnimatedPositions;
+    for (FInstance& Instance : Instances) {
+        GetBonePositions(Instance.BoneIndices, AnimatedPositions);
+        Subsystem->SetAnimatedPose(Instance.Handle, AnimatedPositions);
+        Subsystem->GetSimulatedPose(Instance.Handle, Instance.Positions);
+    }
+}
+
+bool USQEX_BonamikSceneComponent::GetSimulatedBoneLocation(FName BoneName, FVector& OutLocation) const {
+    const TPair<int32, int32>* Body = SimulatedBones.Find(BoneName);
+    if (Body == NULL || !Instances[Body->Key].Positions.IsValidIndex(Body->Value)) {
+        return false;
+    }
+    OutLocation = Instances[Body->Key].Positions[Body->Value];
+    return true;
+}
+
+void USQEX_BonamikSceneComponent::ResetSimulation() {
+    USQEX_BonamikSceneSubsystem* Subsystem = USQEX_BonamikSceneSubsystem::Get(this);
+    if (Subsystem != NULL) {
+        for (const FInstance& Instance : Instances) {
+            Subsystem->ResetInstance(Instance.Handle);
+        }
+    }
+}
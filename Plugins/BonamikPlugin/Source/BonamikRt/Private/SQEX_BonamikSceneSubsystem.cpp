@@ -0,0 +1,237 @@
+#include "SQEX_BonamikSceneSubsystem.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "SQEX_BonamikAsset_v2.h"
+#include "SQEX_BonamikGlobalConfig_v2.h"
+#include "SQEX_BonamikWindFieldSubsystem.h"
+
+DECLARE_STATS_GROUP(TEXT("BonamikScene"), STATGROUP_BonamikScene, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Scene Solver"), STAT_BonamikSceneSolve, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Instances"), STAT_BonamikSceneInstances, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Islands"), STAT_BonamikSceneIslands, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Particles"), STAT_BonamikSceneParticles, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Steps"), STAT_BonamikSceneSteps, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pre-roll Passes"), STAT_BonamikScenePreRollPasses, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Temporary Shapes"), STAT_BonamikSceneTemporaryShapes, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Broadphase Pairs"), STAT_BonamikSceneBroadphasePairs, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Temporary Contacts"), STAT_BonamikSceneTemporaryContacts, STATGROUP_BonamikScene);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("LOD Budget (ms)"), STAT_BonamikSceneLodBudget, STATGROUP_BonamikScene);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("LOD Predicted (ms)"), STAT_BonamikSceneLodPredicted, STATGROUP_BonamikScene);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("LOD Measured (ms)"), STAT_BonamikSceneLodMeasured, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOD Full"), STAT_BonamikSceneLodFull, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOD Reduced Iterations"), STAT_BonamikSceneLodReduced, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOD Half Rate"), STAT_BonamikSceneLodHalfRate, STATGROUP_BonamikScene);
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOD Frozen"), STAT_BonamikSceneLodFrozen, STATGROUP_BonamikScene);
+
+static TAutoConsoleVariable<int32> CVarBonamikLodEnable(
+    TEXT("bonamik.Lod.Enable"),
+    1,
+    TEXT("Lets the scene solver degrade instances to stay within bonamik.Lod.BudgetMs. Screen size and distance culling stay active."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBonamikLodBudgetMs(
+    TEXT("bonamik.Lod.BudgetMs"),
+    2.0f,
+    TEXT("Time the scene solver may spend per frame, summed over all of its steps and worker threads."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBonamikLodRestoreDelay(
+    TEXT("bonamik.Lod.RestoreDelay"),
+    0.5f,
+    TEXT("Seconds an instance stays at a LOD before it may improve by one level, so budget edges don't flicker."),
+    ECVF_Default);
+
+// Frame hitches don't turn into a spiral of catch-up steps; the remaining time is dropped.
+static const int32 MaxStepsPerFrame = 4;
+
+USQEX_BonamikSceneSubsystem::USQEX_BonamikSceneSubsystem() {
+    this->TimeAccumulator = 0.00f;
+}
+
+USQEX_BonamikSceneSubsystem* USQEX_BonamikSceneSubsystem::Get(const UObject* WorldContextObject) {
+    UWorld* World = GEngine != NULL ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : NULL;
+    return World != NULL ? World->GetSubsystem<USQEX_BonamikSceneSubsystem>() : NULL;
+}
+
+void USQEX_BonamikSceneSubsystem::Deinitialize() {
+    Solver = FBonamikSceneSolver();
+    LodScheduler.Reset();
+    WindPositions.Reset();
+    WindSamples.Reset();
+    TimeAccumulator = 0.00f;
+
+    Super::Deinitialize();
+}
+
+ETickableTickType USQEX_BonamikSceneSubsystem::GetTickableTickType() const {
+    return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool USQEX_BonamikSceneSubsystem::IsTickable() const {
+    return Solver.GetNumInstances() > 0 && GetDefault<USQEX_BonamikGlobalConfig_v2>()->bBatchedSceneSolver;
+}
+
+UWorld* USQEX_BonamikSceneSubsystem::GetTickableGameObjectWorld() const {
+    return GetWorld();
+}
+
+TStatId USQEX_BonamikSceneSubsystem::GetStatId() const {
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USQEX_BonamikSceneSubsystem, STATGROUP_Tickables);
+}
+
+int32 USQEX_BonamikSceneSubsystem::RegisterInstance(const USQEX_BonamikAsset_v2* Asset, const TArray<FVector>& ReferencePose) {
+    const int32 Handle = Asset != NULL ? Solver.AddInstance(*Asset, ReferencePose) : INDEX_NONE;
+    LodScheduler.AddInstance(Handle);
+
+    // Every instance of the world is one scene, so the scene wind of the latest asset blows everywhere.
+    USQEX_BonamikWindFieldSubsystem* WindField = Handle != INDEX_NONE ? GetWorld()->GetSubsystem<USQEX_BonamikWindFieldSubsystem>() : NULL;
+    if (WindField != NULL) {
+        WindField->SetGlobalWind(Asset->m_SceneManager.m_WindForce);
+    }
+    return Handle;
+}
+
+void USQEX_BonamikSceneSubsystem::UnregisterInstance(int32 Handle) {
+    Solver.RemoveInstance(Handle);
+    LodScheduler.RemoveInstance(Handle);
+}
+
+void USQEX_BonamikSceneSubsystem::SetAnimatedPose(int32 Handle, const TArray<FVector>& BodyPositions) {
+    Solver.SetAnimatedPose(Handle, BodyPositions);
+}
+
+void USQEX_BonamikSceneSubsystem::ResetInstance(int32 Handle) {
+    Solver.ResetInstance(Handle);
+}
+
+void USQEX_BonamikSceneSubsystem::GetSimulatedPose(int32 Handle, TArray<FVector>& OutBodyPositions) const {
+    Solver.GetSimulatedPose(Handle, OutBodyPositions);
+}
+
+int32 USQEX_BonamikSceneSubsystem::AddTemporaryShape(const FBonamikSceneSolver::FTemporaryShape& Shape) {
+    return Solver.AddTemporaryShape(Shape);
+}
+
+void USQEX_BonamikSceneSubsystem::SetTemporaryShapeTransform(int32 ShapeHandle, const FTransform& Transform) {
+    Solver.SetTemporaryShapeTransform(ShapeHandle, Transform);
+}
+
+void USQEX_BonamikSceneSubsystem::RemoveTemporaryShape(int32 ShapeHandle) {
+    Solver.RemoveTemporaryShape(ShapeHandle);
+}
+
+void USQEX_BonamikSceneSubsystem::SetInstanceImportance(int32 Handle, float Importance) {
+    if (Solver.IsValidInstance(Handle)) {
+        LodScheduler.SetInstanceImportance(Handle, Importance);
+    }
+}
+
+void USQEX_BonamikSceneSubsystem::SetInstanceScreenSize(int32 Handle, float ScreenSize) {
+    if (Solver.IsValidInstance(Handle)) {
+        LodScheduler.SetInstanceScreenSize(Handle, ScreenSize);
+    }
+}
+
+FBonamikLodScheduler::FView USQEX_BonamikSceneSubsystem::GetLodView() const {
+    FBonamikLodScheduler::FView View;
+    const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+    if (PlayerController != NULL && PlayerController->PlayerCameraManager != NULL) {
+        View.Location = PlayerController->PlayerCameraManager->GetCameraLocation();
+        View.TanHalfFov = FMath::Tan(FMath::DegreesToRadians(PlayerController->PlayerCameraManager->GetFOVAngle() * 0.50f));
+    }
+    return View;
+}
+
+void USQEX_BonamikSceneSubsystem::UpdateWind() {
+    USQEX_BonamikWindFieldSubsystem* WindField = GetWorld()->GetSubsystem<USQEX_BonamikWindFieldSubsystem>();
+    if (WindField == NULL) {
+        return;
+    }
+
+    // Frozen instances follow the animation and keep their bricks only until they expire.
+    for (int32 Handle = 0; Handle < Solver.GetNumHandles(); ++Handle) {
+        if (!Solver.IsAffectedByWind(Handle) || Solver.GetInstanceLod(Handle) == EBonamikSolverLod::Frozen) {
+            continue;
+        }
+
+        Solver.GetSimulatedPose(Handle, WindPositions);
+        WindField->RequestRegion(FBox(WindPositions));
+        WindField->SampleBatch(WindPositions, WindSamples);
+        Solver.SetInstanceWind(Handle, WindSamples);
+    }
+}
+
+FBonamikSceneSolver::FSettings USQEX_BonamikSceneSubsystem::MakeSettings() const {
+    const USQEX_BonamikGlobalConfig_v2* Config = GetDefault<USQEX_BonamikGlobalConfig_v2>();
+
+    FBonamikSceneSolver::FSettings Settings;
+    Settings.TimeStep = Config->TimeStep;
+    Settings.Gravity = Config->Gravity;
+    Settings.OverrideLinkIteration = Config->OverrideLinkIteration;
+    Settings.OverrideCollisionIteration = Config->OverrideCollisionIteration;
+    Settings.OverrideSolverIteration = Config->OverrideSolverIteration;
+    Settings.MinParticlesPerIsland = Config->BatchedSolverMinParticlesPerIsland;
+    Settings.bMultiThread = Config->bMultiThreadUpdate;
+    return Settings;
+}
+
+void USQEX_BonamikSceneSubsystem::Tick(float DeltaTime) {
+    SCOPE_CYCLE_COUNTER(STAT_BonamikSceneSolve);
+
+    const USQEX_BonamikGlobalConfig_v2* Config = GetDefault<USQEX_BonamikGlobalConfig_v2>();
+    if (!Config->bBatchedSceneSolver || !Config->bEnableUpdate || !Config->bEnableSimulation || Config->TimeStep <= 0.00f) {
+        TimeAccumulator = 0.00f;
+        return;
+    }
+
+    const FBonamikSceneSolver::FSettings Settings = MakeSettings();
+    TimeAccumulator += DeltaTime;
+
+    const int32 NumSteps = FMath::Min(FMath::FloorToInt(TimeAccumulator / Settings.TimeStep), MaxStepsPerFrame);
+
+    FBonamikLodScheduler::FSettings LodSettings;
+    LodSettings.bEnable = CVarBonamikLodEnable.GetValueOnGameThread() != 0;
+    LodSettings.BudgetMs = CVarBonamikLodBudgetMs.GetValueOnGameThread();
+    LodSettings.RestoreDelay = CVarBonamikLodRestoreDelay.GetValueOnGameThread();
+    LodScheduler.Update(Solver, GetLodView(), LodSettings, DeltaTime, NumSteps);
+    if (NumSteps > 0) {
+        UpdateWind();
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+    int32 NumPreRollPasses = 0;
+    int32 PreRollCost = 0;
+    for (int32 Step = 0; Step < NumSteps; ++Step) {
+        Solver.Simulate(Settings);
+        NumPreRollPasses += Solver.GetNumPreRollPasses();
+        PreRollCost += Solver.GetPreRollCost();
+        TimeAccumulator -= Settings.TimeStep;
+    }
+    if (NumSteps == MaxStepsPerFrame) {
+        TimeAccumulator = FMath::Min(TimeAccumulator, Settings.TimeStep);
+    }
+
+    // The cost model is calibrated against what the solve really took, pre-rolls included.
+    LodScheduler.Calibrate(Solver, (float)((FPlatformTime::Seconds() - StartTime) * 1000.0), NumSteps, PreRollCost);
+
+    SET_DWORD_STAT(STAT_BonamikSceneInstances, Solver.GetNumInstances());
+    SET_DWORD_STAT(STAT_BonamikSceneIslands, Solver.GetNumIslands());
+    SET_DWORD_STAT(STAT_BonamikSceneParticles, Solver.GetNumParticles());
+    SET_DWORD_STAT(STAT_BonamikSceneSteps, NumSteps);
+    SET_DWORD_STAT(STAT_BonamikScenePreRollPasses, NumPreRollPasses);
+    SET_DWORD_STAT(STAT_BonamikSceneTemporaryShapes, Solver.GetNumTemporaryShapes());
+    SET_DWORD_STAT(STAT_BonamikSceneBroadphasePairs, Solver.GetNumBroadphasePairs());
+    SET_DWORD_STAT(STAT_BonamikSceneTemporaryContacts, Solver.GetNumTemporaryContacts());
+    const FBonamikLodScheduler::FStats& LodStats = LodScheduler.GetStats();
+    SET_FLOAT_STAT(STAT_BonamikSceneLodBudget, LodStats.BudgetMs);
+    SET_FLOAT_STAT(STAT_BonamikSceneLodPredicted, LodStats.PredictedMs);
+    SET_FLOAT_STAT(STAT_BonamikSceneLodMeasured, LodStats.MeasuredMs);
+    SET_DWORD_STAT(STAT_BonamikSceneLodFull, LodStats.NumInstances[(int32)EBonamikSolverLod::Full]);
+    SET_DWORD_STAT(STAT_BonamikSceneLodReduced, LodStats.NumInstances[(int32)EBonamikSolverLod::ReducedIterations]);
+    SET_DWORD_STAT(STAT_BonamikSceneLodHalfRate, LodStats.NumInstances[(int32)EBonamikSolverLod::HalfRate]);
+    SET_DWORD_STAT(STAT_BonamikSceneLodFrozen, LodStats.NumInstances[(int32)EBonamikSolverLod::Frozen]);
+}
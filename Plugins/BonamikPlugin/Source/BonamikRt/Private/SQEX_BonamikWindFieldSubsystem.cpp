@@ -0,0 +1,158 @@
+#include "SQEX_BonamikWindFieldSubsystem.h"
+#include "Camera/PlayerCameraManager.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "SQEX_BonamikGlobalConfig_v2.h"
+
+DECLARE_STATS_GROUP(TEXT("BonamikWind"), STATGROUP_BonamikWind, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Rasterize Wind Field"), STAT_BonamikWindRasterize, STATGROUP_BonamikWind);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sources"), STAT_BonamikWindSources, STATGROUP_BonamikWind);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bricks"), STAT_BonamikWindBricks, STATGROUP_BonamikWind);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rasterized Nodes"), STAT_BonamikWindNodes, STATGROUP_BonamikWind);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fallback Samples"), STAT_BonamikWindFallbackSamples, STATGROUP_BonamikWind);
+
+static TAutoConsoleVariable<int32> CVarBonamikWindFieldEnable(
+    TEXT("bonamik.WindField.Enable"),
+    1,
+    TEXT("Samples Bonamik wind from the cached grid. 0 evaluates every wind source for every sample."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBonamikWindFieldCellSize(
+    TEXT("bonamik.WindField.CellSize"),
+    100.0f,
+    TEXT("Spacing of the wind grid nodes in cm. Smaller cells follow local sources closer and cost more to rasterize."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBonamikWindFieldRange(
+    TEXT("bonamik.WindField.Range"),
+    5000.0f,
+    TEXT("Bricks farther than this from the camera are dropped; samples there evaluate the sources directly."),
+    ECVF_Default);
+
+// Debug arrows are this long per unit of wind, up to one cell.
+static const float DebugArrowScale = 0.10f;
+
+USQEX_BonamikWindFieldSubsystem* USQEX_BonamikWindFieldSubsystem::Get(const UObject* WorldContextObject) {
+    UWorld* World = GEngine != NULL ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : NULL;
+    return World != NULL ? World->GetSubsystem<USQEX_BonamikWindFieldSubsystem>() : NULL;
+}
+
+void USQEX_BonamikWindFieldSubsystem::Deinitialize() {
+    Field = FBonamikWindField();
+
+    Super::Deinitialize();
+}
+
+ETickableTickType USQEX_BonamikWindFieldSubsystem::GetTickableTickType() const {
+    return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool USQEX_BonamikWindFieldSubsystem::IsTickable() const {
+    return Field.GetNumSources() > 0 || Field.GetNumBricks() > 0 || Field.HasRequests();
+}
+
+UWorld* USQEX_BonamikWindFieldSubsystem::GetTickableGameObjectWorld() const {
+    return GetWorld();
+}
+
+TStatId USQEX_BonamikWindFieldSubsystem::GetStatId() const {
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USQEX_BonamikWindFieldSubsystem, STATGROUP_Tickables);
+}
+
+int32 USQEX_BonamikWindFieldSubsystem::AddSource(const FBonamikWindSource& Source) {
+    return Field.AddSource(Source);
+}
+
+void USQEX_BonamikWindFieldSubsystem::SetSource(int32 Handle, const FBonamikWindSource& Source) {
+    Field.SetSource(Handle, Source);
+}
+
+void USQEX_BonamikWindFieldSubsystem::RemoveSource(int32 Handle) {
+    Field.RemoveSource(Handle);
+}
+
+void USQEX_BonamikWindFieldSubsystem::SetGlobalWind(const FVector& Wind) {
+    Field.SetGlobalWind(Wind);
+}
+
+void USQEX_BonamikWindFieldSubsystem::RequestRegion(const FBox& Box) {
+    if (CVarBonamikWindFieldEnable.GetValueOnGameThread() != 0) {
+        Field.RequestRegion(Box);
+    }
+}
+
+FVector USQEX_BonamikWindFieldSubsystem::Sample(const FVector& Position) const {
+    return CVarBonamikWindFieldEnable.GetValueOnGameThread() != 0 ? Field.Sample(Position) : Field.Evaluate(Position);
+}
+
+void USQEX_BonamikWindFieldSubsystem::SampleBatch(const TArray<FVector>& Positions, TArray<FVector>& OutWind) const {
+    if (CVarBonamikWindFieldEnable.GetValueOnGameThread() != 0) {
+        Field.SampleBatch(Positions, OutWind);
+        return;
+    }
+
+    OutWind.SetNumUninitialized(Positions.Num());
+    for (int32 Index = 0; Index < Positions.Num(); ++Index) {
+        OutWind[Index] = Field.Evaluate(Positions[Index]);
+    }
+}
+
+void USQEX_BonamikWindFieldSubsystem::Tick(float DeltaTime) {
+    const float Time = GetWorld()->GetTimeSeconds();
+    if (CVarBonamikWindFieldEnable.GetValueOnGameThread() == 0) {
+        Field.SetTime(Time);
+        return;
+    }
+
+    // Without a camera every requested brick is kept.
+    FVector CameraLocation = FVector::ZeroVector;
+    bool bHasCamera = false;
+    const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+    if (PlayerController != NULL && PlayerController->PlayerCameraManager != NULL) {
+        CameraLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+        bHasCamera = true;
+    }
+
+    SET_DWORD_STAT(STAT_BonamikWindFallbackSamples, Field.GetNumFallbackSamples());
+    {
+        SCOPE_CYCLE_COUNTER(STAT_BonamikWindRasterize);
+        const float CellSize = CVarBonamikWindFieldCellSize.GetValueOnGameThread();
+        const float Range = CVarBonamikWindFieldRange.GetValueOnGameThread();
+        Field.Rasterize(CameraLocation, bHasCamera, Range, CellSize, Time, GetDefault<USQEX_BonamikGlobalConfig_v2>()->bMultiThreadUpdate);
+    }
+
+    const int32 NodesPerBrick = FBonamikWindField::BrickNodes * FBonamikWindField::BrickNodes * FBonamikWindField::BrickNodes;
+    SET_DWORD_STAT(STAT_BonamikWindSources, Field.GetNumSources());
+    SET_DWORD_STAT(STAT_BonamikWindBricks, Field.GetNumBricks());
+    SET_DWORD_STAT(STAT_BonamikWindNodes, Field.GetNumBricks() * NodesPerBrick);
+
+    if (GetDefault<USQEX_BonamikGlobalConfig_v2>()->bDebugDrawWind) {
+        DrawDebug();
+    }
+}
+
+void USQEX_BonamikWindFieldSubsystem::DrawDebug() const {
+#if ENABLE_DRAW_DEBUG
+    UWorld* World = GetWorld();
+    const float CellSize = Field.GetCellSize();
+    for (int32 Brick = 0; Brick < Field.GetNumBricks(); ++Brick) {
+        const FBox Bounds = Field.GetBrickBounds(Brick);
+        DrawDebugBox(World, Bounds.GetCenter(), Bounds.GetExtent(), FColor::Cyan, false, -1.0f, SDPG_World, 0.0f);
+
+        // Every other node keeps the arrows readable.
+        for (int32 Z = 0; Z < FBonamikWindField::BrickNodes; Z += 2) {
+            for (int32 Y = 0; Y < FBonamikWindField::BrickNodes; Y += 2) {
+                for (int32 X = 0; X < FBonamikWindField::BrickNodes; X += 2) {
+                    const FVector Wind = Field.GetNodeWind(Brick, X, Y, Z);
+                    const FVector Start = Bounds.Min + FVector((float)X, (float)Y, (float)Z) * CellSize;
+                    const FVector Arrow = (Wind * DebugArrowScale).GetClampedToMaxSize(CellSize);
+                    DrawDebugDirectionalArrow(World, Start, Start + Arrow, CellSize * 0.20f, FColor::Green, false, -1.0f, SDPG_World, 0.0f);
+                }
+            }
+        }
+    }
+#endif
+}
@@ -1,19 +1,109 @@
 #include "SQEX_BonamikWind_Actor_v2.h"
+#include "BonamikWindField.h"
+#include "Engine/World.h"
+#include "SQEX_BonamikWindDesc_v2.h"
+#include "SQEX_BonamikWindFieldSubsystem.h"
 #include "SQEX_BonamikWind_Component_v2.h"
 
 ADEPRECATED_SQEX_BonamikWind_Actor_v2::ADEPRECATED_SQEX_BonamikWind_Actor_v2(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
     this->RootComponent = CreateDefaultSubobject<UDEPRECATED_SQEX_BonamikWind_Component_v2>(TEXT("SQEX_BonamikWind_Component"));
     this->m_BonamikWind_Component = (UDEPRECATED_SQEX_BonamikWind_Component_v2*)RootComponent;
+    this->WindSourceHandle = INDEX_NONE;
+    this->WindScale = 1.00f;
+    this->bWindEnabled = true;
+    this->WindStartTime = 0.00f;
+}
+
+void ADEPRECATED_SQEX_BonamikWind_Actor_v2::BeginPlay() {
+    Super::BeginPlay();
+
+    WindStartTime = GetWorld()->GetTimeSeconds();
+
+    USQEX_BonamikWindFieldSubsystem* WindField = USQEX_BonamikWindFieldSubsystem::Get(this);
+    FBonamikWindSource Source;
+    if (WindField != NULL && MakeWindSource(Source)) {
+        WindSourceHandle = WindField->AddSource(Source);
+    }
+}
+
+void ADEPRECATED_SQEX_BonamikWind_Actor_v2::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+    USQEX_BonamikWindFieldSubsystem* WindField = WindSourceHandle != INDEX_NONE ? USQEX_BonamikWindFieldSubsystem::Get(this) : NULL;
+    if (WindField != NULL) {
+        WindField->RemoveSource(WindSourceHandle);
+    }
+    WindSourceHandle = INDEX_NONE;
+
+    Super::EndPlay(EndPlayReason);
 }
 
 void ADEPRECATED_SQEX_BonamikWind_Actor_v2::SetWindScale(float Value) {
+    WindScale = Value;
+    UpdateWindSource();
 }
 
 float ADEPRECATED_SQEX_BonamikWind_Actor_v2::GetWindScale() const {
-    return 0.0f;
+    return WindScale;
 }
 
 void ADEPRECATED_SQEX_BonamikWind_Actor_v2::Enable(bool Value) {
+    bWindEnabled = Value;
+    UpdateWindSource();
+}
+
+bool ADEPRECATED_SQEX_BonamikWind_Actor_v2::GetWindSettings(FBonamikWindSource& OutSource) const {
+    if (m_BonamikWind_Component == NULL || m_BonamikWind_Component->m_BonamikWindDesc == NULL) {
+        return false;
+    }
+    OutSource = FBonamikWindSource::FromWindDesc(*m_BonamikWind_Component->m_BonamikWindDesc);
+    return true;
+}
+
+bool ADEPRECATED_SQEX_BonamikWind_Actor_v2::MakeWindSource(FBonamikWindSource& OutSource) const {
+    if (!GetWindSettings(OutSource)) {
+        return false;
+    }
+
+    OutSource.StartTime = WindStartTime;
+    OutSource.Scale = bWindEnabled ? WindScale : 0.00f;
+
+    const UDEPRECATED_SQEX_BonamikWind_Component_v2* Component = m_BonamikWind_Component;
+    if (Component == NULL) {
+        return true;
+    }
+
+    // Areas ignore the component scale; their size is set on the component.
+    OutSource.Transform = FTransform(Component->GetComponentQuat(), Component->GetComponentLocation());
+    switch (Component->m_BonamikWindAreaType) {
+    case ESQEX_Bonamik_WindAreaType_Box:
+        OutSource.Area = EBonamikWindArea::Box;
+        OutSource.Extent = Component->m_BonamikWindBoxAreaSize * 0.50f + FVector(Component->m_BonamikWindAreaMargin);
+        break;
+    case ESQEX_Bonamik_WindAreaType_Sphere:
+        OutSource.Area = EBonamikWindArea::Sphere;
+        OutSource.Radius = Component->m_BonamikWindSphereAreaRadius + Component->m_BonamikWindAreaMargin;
+        break;
+    default:
+        OutSource.Area = EBonamikWindArea::Global;
+        break;
+    }
+
+    // The wind settings blow along +X; the component turns them, or the absolute yaw and pitch when set.
+    const FQuat Direction = Component->m_BonamikWindAbsoluteDirection
+        ? FRotator(Component->m_BonamikWindDirectionPitch, Component->m_BonamikWindDirectionYaw, 0.00f).Quaternion()
+        : Component->GetComponentQuat();
+    OutSource.Force = Direction.RotateVector(OutSource.Force);
+    OutSource.WaveMagnitude = Direction.RotateVector(OutSource.WaveMagnitude);
+    for (FVector& Key : OutSource.CustomWave) {
+        Key = Direction.RotateVector(Key);
+    }
+    return true;
 }
 
+void ADEPRECATED_SQEX_BonamikWind_Actor_v2::UpdateWindSource() {
+    USQEX_BonamikWindFieldSubsystem* WindField = WindSourceHandle != INDEX_NONE ? USQEX_BonamikWindFieldSubsystem::Get(this) : NULL;
+    FBonamikWindSource Source;
+    if (WindField != NULL && MakeWindSource(Source)) {
+        WindField->SetSource(WindSourceHandle, Source);
+    }
+}
 
@@ -0,0 +1,244 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "BonamikLodScheduler.h"
+#include "BonamikSceneSolver.h"
+#include "SQEX_BonamikAsset_v2.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BonamikLodSchedulerTest {
+    static const int32 NumBodies = 10;
+
+    // A hanging chain with the usual four solver and four link iterations: reduced iterations run two of each, so full,
+    // reduced iterations, half rate and frozen cost 154, 46, 23 and 2.
+    static USQEX_BonamikAsset_v2* MakeChainAsset(float LodDistance, const FSQEX_BonamikGroupLOD_v2& GroupLod, uint32 SolverIterations = 4, uint32 LinkIterations = 4) {
+        USQEX_BonamikAsset_v2* Asset = NewObject<USQEX_BonamikAsset_v2>();
+
+        FSQEX_BonamikSolverDesc_v2& Solver = Asset->m_Solvers.AddDefaulted_GetRef();
+        Solver.m_GroupId = 0;
+        Solver.m_IsEnable = true;
+        Solver.m_SolverIter = SolverIterations;
+        Solver.m_LinkIter = LinkIterations;
+        Solver.m_ConeIter = 1;
+        Solver.m_ColIter = 1;
+        Solver.m_LODdistance = LodDistance;
+
+        for (int32 BodyIndex = 0; BodyIndex < NumBodies; ++BodyIndex) {
+            FSQEX_BonamikBodyDesc_v2& Body = Asset->m_Bodies.AddDefaulted_GetRef();
+            Body.m_GroupId = 0;
+            Body.m_IsKinematic = BodyIndex == 0;
+            Body.m_Mass = 1.00f;
+            Body.m_ParentId = BodyIndex - 1;
+            Body.m_ChildId = BodyIndex + 1 < NumBodies ? BodyIndex + 1 : -1;
+
+            if (BodyIndex > 0) {
+                FSQEX_BonamikLinkDesc_v2& Link = Asset->m_Links.AddDefaulted_GetRef();
+                Link.m_ParentId = BodyIndex - 1;
+                Link.m_ChildId = BodyIndex;
+                Link.m_LinkType = ESQEX_Bonamik_LinkType_v2_ParentChild;
+                Link.m_LinkStr = 1.00f;
+            }
+        }
+
+        Asset->m_BonamikGroupLODs.Add(GroupLod);
+        return Asset;
+    }
+
+    // Laid out along X from Origin, so the bounding radius is 45.
+    static TArray<FVector> MakePose(const FVector& Origin) {
+        TArray<FVector> Pose;
+        for (int32 BodyIndex = 0; BodyIndex < NumBodies; ++BodyIndex) {
+            Pose.Add(Origin + FVector(10.00f * BodyIndex, 0.00f, 0.00f));
+        }
+        return Pose;
+    }
+
+    static FBonamikLodScheduler::FView MakeView() {
+        FBonamikLodScheduler::FView View;
+        View.Location = FVector::ZeroVector;
+        View.TanHalfFov = 1.00f;
+        return View;
+    }
+
+    static FBonamikLodScheduler::FSettings MakeSettings(float BudgetMs) {
+        FBonamikLodScheduler::FSettings Settings;
+        Settings.bEnable = true;
+        Settings.BudgetMs = BudgetMs;
+        Settings.RestoreDelay = 0.50f;
+        return Settings;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBonamikLodSchedulerBudgetTest, "Bonamik.SceneSolver.LodScheduler.Budget",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBonamikLodSchedulerBudgetTest::RunTest(const FString& Parameters) {
+    using namespace BonamikLodSchedulerTest;
+
+    FSQEX_BonamikGroupLOD_v2 GroupLod;
+    GroupLod.MinSize = 0.01f;
+    GroupLod.BlendTime = 0.10f;
+    GroupLod.PreRollTime = 0.10f;
+    const USQEX_BonamikAsset_v2* Asset = MakeChainAsset(0.00f, GroupLod);
+
+    FBonamikSceneSolver Solver;
+    FBonamikLodScheduler Scheduler;
+    const int32 Near = Solver.AddInstance(*Asset, MakePose(FVector(500.00f, 0.00f, 0.00f)));
+    const int32 Mid = Solver.AddInstance(*Asset, MakePose(FVector(1000.00f, 0.00f, 0.00f)));
+    const int32 Far = Solver.AddInstance(*Asset, MakePose(FVector(2000.00f, 0.00f, 0.00f)));
+    Scheduler.AddInstance(Near);
+    Scheduler.AddInstance(Mid);
+    Scheduler.AddInstance(Far);
+
+    TestEqual(TEXT("Full cost"), Solver.GetInstanceCost(Near, EBonamikSolverLod::Full), 154);
+    TestEqual(TEXT("Reduced iterations cost"), Solver.GetInstanceCost(Near, EBonamikSolverLod::ReducedIterations), 46);
+    TestEqual(TEXT("Half rate cost"), Solver.GetInstanceCost(Near, EBonamikSolverLod::HalfRate), 23);
+    TestEqual(TEXT("Frozen cost"), Solver.GetInstanceCost(Near, EBonamikSolverLod::Frozen), 2);
+
+    // Nothing is degraded for the budget before the cost model has a measurement.
+    Scheduler.Update(Solver, MakeView(), MakeSettings(1.00f), 0.00f, 1);
+    TestEqual(TEXT("Uncalibrated"), (int32)Solver.GetInstanceLod(Far), (int32)EBonamikSolverLod::Full);
+
+    // 462 cost units measured as 462ms: one unit per millisecond from here on.
+    Scheduler.Calibrate(Solver, 462.00f, 1, 0);
+
+    // The smallest on screen loses iterations first, the others keep full quality.
+    Scheduler.Update(Solver, MakeView(), MakeSettings(400.00f), 0.00f, 1);
+    TestEqual(TEXT("400ms, far"), (int32)Solver.GetInstanceLod(Far), (int32)EBonamikSolverLod::ReducedIterations);
+    TestEqual(TEXT("400ms, mid"), (int32)Solver.GetInstanceLod(Mid), (int32)EBonamikSolverLod::Full);
+    TestEqual(TEXT("400ms, near"), (int32)Solver.GetInstanceLod(Near), (int32)EBonamikSolverLod::Full);
+
+    // Every instance loses iterations before the farthest goes to half rate.
+    Scheduler.Update(Solver, MakeView(), MakeSettings(120.00f), 0.00f, 1);
+    TestEqual(TEXT("120ms, far"), (int32)Solver.GetInstanceLod(Far), (int32)EBonamikSolverLod::HalfRate);
+    TestEqual(TEXT("120ms, mid"), (int32)Solver.GetInstanceLod(Mid), (int32)EBonamikSolverLod::ReducedIterations);
+    TestEqual(TEXT("120ms, near"), (int32)Solver.GetInstanceLod(Near), (int32)EBonamikSolverLod::ReducedIterations);
+
+    // Every instance goes to half rate before the farthest freezes.
+    Scheduler.Update(Solver, MakeView(), MakeSettings(40.00f), 0.00f, 1);
+    TestEqual(TEXT("40ms, far"), (int32)Solver.GetInstanceLod(Far), (int32)EBonamikSolverLod::Frozen);
+    TestEqual(TEXT("40ms, mid"), (int32)Solver.GetInstanceLod(Mid), (int32)EBonamikSolverLod::Frozen);
+    TestEqual(TEXT("40ms, near"), (int32)Solver.GetInstanceLod(Near), (int32)EBonamikSolverLod::HalfRate);
+    TestEqual(TEXT("40ms, frozen count"), Scheduler.GetStats().NumInstances[(int32)EBonamikSolverLod::Frozen], 2);
+    TestEqual(TEXT("40ms, prediction"), Scheduler.GetStats().PredictedMs, 27.00f);
+
+    // Frozen instances blend out over BlendTime, then follow the animation.
+    FBonamikSceneSolver::FSettings SolverSettings;
+    SolverSettings.TimeStep = 0.05f;
+    SolverSettings.bMultiThread = false;
+    for (int32 Step = 0; Step < 4; ++Step) {
+        Solver.Simulate(SolverSettings);
+    }
+    TestEqual(TEXT("Blended out"), Solver.GetInstanceBlendWeight(Far), 0.00f);
+
+    // With room again, nothing improves before RestoreDelay, then one level at a time.
+    Scheduler.Update(Solver, MakeView(), MakeSettings(1000.00f), 0.10f, 1);
+    TestEqual(TEXT("Restore delay, far"), (int32)Solver.GetInstanceLod(Far), (int32)EBonamikSolverLod::Frozen);
+    TestEqual(TEXT("Restore delay, near"), (int32)Solver.GetInstanceLod(Near), (int32)EBonamikSolverLod::HalfRate);
+
+    Scheduler.Update(Solver, MakeView(), MakeSettings(1000.00f), 0.50f, 1);
+    TestEqual(TEXT("Restored, far"), (int32)Solver.GetInstanceLod(Far), (int32)EBonamikSolverLod::HalfRate);
+    TestEqual(TEXT("Restored, mid"), (int32)Solver.GetInstanceLod(Mid), (int32)EBonamikSolverLod::HalfRate);
+    TestEqual(TEXT("Restored, near"), (int32)Solver.GetInstanceLod(Near), (int32)EBonamikSolverLod::ReducedIterations);
+
+    // Leaving Frozen resets to the animated pose, pre-rolls PreRollTime and blends back in over BlendTime. Half rate
+    // instances pre-roll every step with reduced iterations.
+    Solver.Simulate(SolverSettings);
+    TestEqual(TEXT("Pre-roll passes"), Solver.GetNumPreRollPasses(), 2);
+    TestEqual(TEXT("Pre-roll cost"), Solver.GetPreRollCost(), 2 * 2 * 46);
+    TestEqual(TEXT("Blending in"), Solver.GetInstanceBlendWeight(Far), 0.50f);
+
+    // The step cost 92 units and the pre-roll 184 more: at one unit per millisecond the cost model does not move.
+    Scheduler.Calibrate(Solver, 276.00f, 1, Solver.GetPreRollCost());
+    Scheduler.Update(Solver, MakeView(), MakeSettings(1000.00f), 0.00f, 1);
+    TestEqual(TEXT("Calibrated with pre-roll"), Scheduler.GetStats().PredictedMs, 92.00f);
+    Solver.Simulate(SolverSettings);
+    TestEqual(TEXT("Pre-rolled once"), Solver.GetNumPreRollPasses(), 0);
+    TestEqual(TEXT("Blended in"), Solver.GetInstanceBlendWeight(Far), 1.00f);
+
+    Scheduler.Update(Solver, MakeView(), MakeSettings(1000.00f), 0.50f, 1);
+    Scheduler.Update(Solver, MakeView(), MakeSettings(1000.00f), 0.50f, 1);
+    Scheduler.Update(Solver, MakeView(), MakeSettings(1000.00f), 0.50f, 1);
+    TestEqual(TEXT("Fully restored"), Scheduler.GetStats().NumInstances[(int32)EBonamikSolverLod::Full], 3);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBonamikLodSchedulerCullingTest, "Bonamik.SceneSolver.LodScheduler.Culling",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBonamikLodSchedulerCullingTest::RunTest(const FString& Parameters) {
+    using namespace BonamikLodSchedulerTest;
+
+    FSQEX_BonamikGroupLOD_v2 GroupLod;
+    const USQEX_BonamikAsset_v2* DistanceAsset = MakeChainAsset(1500.00f, GroupLod);
+    GroupLod.MinSize = 0.05f;
+    const USQEX_BonamikAsset_v2* MinSizeAsset = MakeChainAsset(0.00f, GroupLod);
+
+    FBonamikSceneSolver Solver;
+    FBonamikLodScheduler Scheduler;
+    const int32 InsideDistance = Solver.AddInstance(*DistanceAsset, MakePose(FVector(1000.00f, 0.00f, 0.00f)));
+    const int32 BeyondDistance = Solver.AddInstance(*DistanceAsset, MakePose(FVector(2000.00f, 0.00f, 0.00f)));
+    const int32 AboveMinSize = Solver.AddInstance(*MinSizeAsset, MakePose(FVector(500.00f, 0.00f, 0.00f)));
+    const int32 BelowMinSize = Solver.AddInstance(*MinSizeAsset, MakePose(FVector(2000.00f, 0.00f, 0.00f)));
+    Scheduler.AddInstance(InsideDistance);
+    Scheduler.AddInstance(BeyondDistance);
+    Scheduler.AddInstance(AboveMinSize);
+    Scheduler.AddInstance(BelowMinSize);
+
+    // Culling ignores the budget, calibrated or not.
+    Scheduler.Update(Solver, MakeView(), MakeSettings(1000.00f), 0.00f, 1);
+    TestEqual(TEXT("Inside m_LODdistance"), (int32)Solver.GetInstanceLod(InsideDistance), (int32)EBonamikSolverLod::Full);
+    TestEqual(TEXT("Beyond m_LODdistance"), (int32)Solver.GetInstanceLod(BeyondDistance), (int32)EBonamikSolverLod::Frozen);
+    TestEqual(TEXT("Above MinSize"), (int32)Solver.GetInstanceLod(AboveMinSize), (int32)EBonamikSolverLod::Full);
+    TestEqual(TEXT("Below MinSize"), (int32)Solver.GetInstanceLod(BelowMinSize), (int32)EBonamikSolverLod::Frozen);
+
+    // A screen size override ranks and culls in place of the estimate.
+    Scheduler.SetInstanceScreenSize(BelowMinSize, 0.50f);
+    Scheduler.Update(Solver, MakeView(), MakeSettings(1000.00f), 1.00f, 1);
+    TestEqual(TEXT("Screen size override"), (int32)Solver.GetInstanceLod(BelowMinSize), (int32)EBonamikSolverLod::HalfRate);
+
+    // Without a camera only MinSize against a full screen applies.
+    Scheduler.Update(Solver, FBonamikLodScheduler::FView(), MakeSettings(1000.00f), 1.00f, 1);
+    TestEqual(TEXT("No camera"), (int32)Solver.GetInstanceLod(BeyondDistance), (int32)EBonamikSolverLod::HalfRate);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBonamikLodSchedulerLevelOrderTest, "Bonamik.SceneSolver.LodScheduler.LevelOrder",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FBonamikLodSchedulerLevelOrderTest::RunTest(const FString& Parameters) {
+    using namespace BonamikLodSchedulerTest;
+
+    // Solver and link iteration counts found in shipped assets.
+    const uint32 IterationCounts[][2] = { { 1, 1 }, { 2, 2 }, { 4, 4 }, { 4, 8 }, { 8, 2 }, { 16, 16 } };
+
+    FSQEX_BonamikGroupLOD_v2 GroupLod;
+    for (const uint32* Iterations : IterationCounts) {
+        const USQEX_BonamikAsset_v2* Asset = MakeChainAsset(0.00f, GroupLod, Iterations[0], Iterations[1]);
+        const FString Context = FString::Printf(TEXT("%u solver, %u link iterations"), Iterations[0], Iterations[1]);
+
+        FBonamikSceneSolver Solver;
+        FBonamikLodScheduler Scheduler;
+        const int32 Handle = Solver.AddInstance(*Asset, MakePose(FVector(500.00f, 0.00f, 0.00f)));
+        Scheduler.AddInstance(Handle);
+
+        const int32 FullCost = Solver.GetInstanceCost(Handle, EBonamikSolverLod::Full);
+        const int32 ReducedCost = Solver.GetInstanceCost(Handle, EBonamikSolverLod::ReducedIterations);
+        const int32 HalfRateCost = Solver.GetInstanceCost(Handle, EBonamikSolverLod::HalfRate);
+        const int32 FrozenCost = Solver.GetInstanceCost(Handle, EBonamikSolverLod::Frozen);
+        TestTrue(Context + TEXT(", reduced iterations cost no more than full"), ReducedCost <= FullCost);
+        TestTrue(Context + TEXT(", half rate cheaper than reduced iterations"), HalfRateCost < ReducedCost);
+        TestTrue(Context + TEXT(", frozen cheapest"), FrozenCost < HalfRateCost);
+
+        // A budget between the half rate and reduced iterations costs stops at half rate on the way to frozen.
+        Scheduler.Calibrate(Solver, (float)FullCost, 1, 0);
+        Scheduler.Update(Solver, MakeView(), MakeSettings((float)(HalfRateCost + ReducedCost) * 0.50f), 0.00f, 1);
+        TestEqual(Context + TEXT(", budgeted LOD"), (int32)Solver.GetInstanceLod(Handle), (int32)EBonamikSolverLod::HalfRate);
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// Dynamic AABB tree broadphase. Every proxy is stored with a box fattened by a margin and its last displacement, so
+// small moves don't touch the tree; the tree is kept balanced with rotations on insert and remove. Pairs are kept
+// between updates: UpdatePairs() only queries the proxies that were created or reinserted since the last call and drops
+// the pairs whose fat boxes stopped overlapping, so the pair set is maintained incrementally as proxies move.
+//
+// Two proxies pair when each one's Layer is in the other one's PairMask.
+class BONAMIKRT_API FBonamikBroadphase {
+public:
+    struct FPair {
+        int32 ProxyA;
+        int32 ProxyB;
+    };
+
+    explicit FBonamikBroadphase(float InMargin = 5.0f);
+
+    int32 CreateProxy(const FBox& Box, uint32 Layer, uint32 PairMask, int32 UserData);
+    void DestroyProxy(int32 Proxy);
+    // Returns true when the box left the fat box and the proxy was reinserted.
+    bool MoveProxy(int32 Proxy, const FBox& Box, const FVector& Displacement);
+
+    int32 GetUserData(int32 Proxy) const { return Nodes[Proxy].UserData; }
+    uint32 GetLayer(int32 Proxy) const { return Nodes[Proxy].Layer; }
+    const FBox& GetFatBox(int32 Proxy) const { return Nodes[Proxy].Box; }
+
+    // Calls Visitor(Proxy) for every proxy whose fat box overlaps Box; a false return stops the query.
+    template <typename VisitorType>
+    void Query(const FBox& Box, VisitorType Visitor) const;
+
+    void UpdatePairs();
+    // In no particular order, ProxyA < ProxyB.
+    const TArray<FPair>& GetPairs() const { return Pairs; }
+
+    int32 GetNumProxies() const { return NumProxies; }
+    int32 GetHeight() const;
+
+private:
+    struct FNode {
+        FBox Box;
+        // Next free node while the node is on the free list.
+        int32 Parent;
+        int32 Child1;
+        int32 Child2;
+        // 0 for leaves, INDEX_NONE for free nodes.
+        int32 Height;
+        int32 UserData;
+        uint32 Layer;
+        uint32 PairMask;
+
+        bool IsLeaf() const { return Child1 == INDEX_NONE; }
+    };
+
+    int32 AllocateNode();
+    void FreeNode(int32 Node);
+    void InsertLeaf(int32 Leaf);
+    void RemoveLeaf(int32 Leaf);
+    int32 Balance(int32 Node);
+    void Refit(int32 Node);
+    FBox MakeFatBox(const FBox& Box, const FVector& Displacement) const;
+    bool ShouldPair(int32 ProxyA, int32 ProxyB) const;
+
+    static uint64 MakePairKey(int32 ProxyA, int32 ProxyB) {
+        return ((uint64)(uint32)FMath::Min(ProxyA, ProxyB) << 32) | (uint64)(uint32)FMath::Max(ProxyA, ProxyB);
+    }
+
+    TArray<FNode> Nodes;
+    int32 Root;
+    int32 FreeList;
+    int32 NumProxies;
+    float Margin;
+    TArray<int32> MoveBuffer;
+    TSet<uint64> PairKeys;
+    TArray<FPair> Pairs;
+};
+
+template <typename VisitorType>
+void FBonamikBroadphase::Query(const FBox& Box, VisitorType Visitor) const {
+    if (Root == INDEX_NONE) {
+        return;
+    }
+
+    TArray<int32, TInlineAllocator<64>> Stack;
+    Stack.Add(Root);
+    while (Stack.Num() > 0) {
+        const FNode& Node = Nodes[Stack.Pop(false)];
+        if (!Node.Box.Intersect(Box)) {
+            continue;
+        }
+        if (Node.IsLeaf()) {
+            if (!Visitor((int32)(&Node - Nodes.GetData()))) {
+                return;
+            }
+        } else {
+            Stack.Add(Node.Child1);
+            Stack.Add(Node.Child2);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "BonamikSceneSolver.h"
+
+// Picks the EBonamikSolverLod of every FBonamikSceneSolver instance. Instances are ranked by screen size times
+// importance, and the lowest ranked ones are degraded (reduced iterations, then half rate, then frozen) until the
+// predicted solve time fits the budget. Instances below their asset's MinSize or beyond its m_LODdistance are frozen
+// regardless of the budget. Degrading applies at once, improving goes one level per RestoreDelay.
+//
+// The prediction is FBonamikSceneSolver::GetInstanceCost() times a time per cost unit calibrated against the measured
+// solve time, so nothing is degraded for budget reasons before the first Calibrate().
+class BONAMIKRT_API FBonamikLodScheduler {
+public:
+    struct FView {
+        FVector Location;
+        // 0 without a camera: every instance then counts as full screen and distance culling is off.
+        float TanHalfFov;
+
+        FView();
+    };
+
+    struct FSettings {
+        // Lets the budget degrade instances; screen size and distance culling stay active.
+        bool bEnable;
+        float BudgetMs;
+        float RestoreDelay;
+
+        FSettings();
+    };
+
+    struct FStats {
+        float BudgetMs;
+        float PredictedMs;
+        float MeasuredMs;
+        int32 NumInstances[(int32)EBonamikSolverLod::Num];
+
+        FStats();
+    };
+
+    FBonamikLodScheduler();
+
+    // Starts scheduling a newly added solver instance at full quality, importance 1 and the estimated screen size.
+    void AddInstance(int32 Handle);
+    // Drops the importance and screen size override of a removed instance, so a handle the solver reuses starts over.
+    void RemoveInstance(int32 Handle);
+
+    // Scales the LOD priority of the instance, 1 by default.
+    void SetInstanceImportance(int32 Handle, float Importance);
+    // Screen size to rank the instance with instead of the estimate from its bounds. Negative values go back to the
+    // estimate.
+    void SetInstanceScreenSize(int32 Handle, float ScreenSize);
+
+    // Ranks the solver's instances and applies their LODs for a frame of NumSteps steps.
+    void Update(FBonamikSceneSolver& Solver, const FView& View, const FSettings& Settings, float DeltaTime, int32 NumSteps);
+    // Feeds the time NumSteps steps took at the current LODs into the cost model. PreRollCost is the sum of
+    // FBonamikSceneSolver::GetPreRollCost() over those steps, since their pre-roll passes are part of MeasuredMs.
+    void Calibrate(const FBonamikSceneSolver& Solver, float MeasuredMs, int32 NumSteps, int32 PreRollCost);
+
+    void Reset();
+
+    const FStats& GetStats() const { return Stats; }
+
+private:
+    struct FInstanceState {
+        float Importance;
+        float ScreenSizeOverride;
+        float TimeSinceChange;
+
+        FInstanceState();
+    };
+
+    // Sum of FBonamikSceneSolver::GetInstanceCost() at the current LODs.
+    static int32 GetStepCost(const FBonamikSceneSolver& Solver, int32 NumHandles);
+
+    TArray<FInstanceState> States;
+    FStats Stats;
+    // Measured solve time per unit of FBonamikSceneSolver::GetInstanceCost(), smoothed over frames. 0 until the first
+    // measurement.
+    float MsPerCostUnit;
+};
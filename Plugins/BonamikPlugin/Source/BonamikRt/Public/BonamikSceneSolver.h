@@ -0,0 +1,336 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "BonamikBroadphase.h"
+
+class USQEX_BonamikAsset_v2;
+
+// Simulation quality of one instance, from the highest fidelity to the lowest. Every level costs less than the one
+// before it whatever the iteration counts of the asset, see FBonamikSceneSolver::GetInstanceCost().
+enum class EBonamikSolverLod : uint8 {
+    Full,
+    // Every group runs half of its iterations, rounded up.
+    ReducedIterations,
+    // Reduced iterations every other step with twice the time step; the pose in between is interpolated.
+    HalfRate,
+    // Blends out, then follows the animated pose. Coming back resets to the animated pose, pre-rolls and blends in.
+    Frozen,
+    Num
+};
+
+enum class EBonamikTemporaryShape : uint8 {
+    Sphere,
+    Capsule,
+    Box,
+};
+
+// Scene-wide Bonamik solver. Every registered instance is flattened into structure-of-arrays particle buffers and its
+// links, cones and collisions are colored into batches whose constraints never share a particle. Instances are packed
+// into islands; batch N of an island holds batch N of all of its instances, so one SIMD pass solves four constraints of
+// possibly different characters at once. Islands have no constraints between them and are solved in parallel on the
+// task graph, largest first.
+//
+// Temporary collision shapes (cutscene volumes, notify shapes) live in a broadphase next to one proxy per instance that
+// bounds its collision receivers; only the receivers of overlapping instance / shape pairs are tested and solved.
+class BONAMIKRT_API FBonamikSceneSolver {
+public:
+    struct FSettings {
+        float TimeStep;
+        int32 SubSteps;
+        FVector Gravity;
+        // Replace the iteration counts of every group when positive (USQEX_BonamikGlobalConfig_v2::Override*Iteration).
+        int32 OverrideLinkIteration;
+        int32 OverrideCollisionIteration;
+        int32 OverrideSolverIteration;
+        // Instances are only spread over more islands once every island gets at least this many particles.
+        int32 MinParticlesPerIsland;
+        bool bMultiThread;
+
+        FSettings();
+    };
+
+    // Shape geometry of ASQEX_Bonamik_TemporaryCollisionActor / SQEX_AnimNotifyState_Bonamik_TemporaryCollision.
+    // Capsules run along the local Z axis and HalfHeight includes the radius; scale is ignored.
+    struct FTemporaryShape {
+        EBonamikTemporaryShape Type;
+        FTransform Transform;
+        FVector BoxExtent;
+        float Radius;
+        float HalfHeight;
+        // Only collides with this instance when set, e.g. the character playing the notify.
+        int32 OwnerHandle;
+
+        FTemporaryShape();
+    };
+
+    FBonamikSceneSolver();
+
+    // ReferencePose holds the world position of every m_Bodies entry; rest lengths are measured on it. Returns a
+    // handle, or INDEX_NONE when the asset has nothing to simulate.
+    int32 AddInstance(const USQEX_BonamikAsset_v2& Asset, const TArray<FVector>& ReferencePose);
+    void RemoveInstance(int32 Handle);
+    bool IsValidInstance(int32 Handle) const;
+
+    // Kinematic bodies follow this pose and cones are measured against it. Applied on the next Simulate().
+    void SetAnimatedPose(int32 Handle, const TArray<FVector>& BodyPositions);
+    // Snaps the instance to its animated pose and drops its velocity.
+    void ResetInstance(int32 Handle);
+    void GetSimulatedPose(int32 Handle, TArray<FVector>& OutBodyPositions) const;
+    // Wind acceleration at every body, e.g. sampled from FBonamikWindField at the simulated pose. Bodies take it scaled
+    // by their m_WindDrag from the next Simulate() on, until it is set again.
+    void SetInstanceWind(int32 Handle, const TArray<FVector>& BodyWind);
+    // False when no simulated body of the instance has any m_WindDrag.
+    bool IsAffectedByWind(int32 Handle) const;
+
+    void SetInstanceLod(int32 Handle, EBonamikSolverLod Lod);
+    EBonamikSolverLod GetInstanceLod(int32 Handle) const;
+    // Relative solve cost of the instance at a LOD, in the same unit for every instance.
+    int32 GetInstanceCost(int32 Handle, EBonamikSolverLod Lod) const;
+    // Bounding sphere of the animated pose.
+    bool GetInstanceBounds(int32 Handle, FVector& OutCenter, float& OutRadius) const;
+    // LOD inputs of the asset: the smallest FSQEX_BonamikGroupLOD_v2::MinSize and the largest
+    // FSQEX_BonamikSolverDesc_v2::m_LODdistance (0 when there is none).
+    float GetInstanceMinScreenSize(int32 Handle) const;
+    float GetInstanceLodDistance(int32 Handle) const;
+    // Weight of the simulated pose over the animated one: blends out while frozen and back in after a restore.
+    float GetInstanceBlendWeight(int32 Handle) const;
+
+    int32 AddTemporaryShape(const FTemporaryShape& Shape);
+    void SetTemporaryShapeTransform(int32 ShapeHandle, const FTransform& Transform);
+    void RemoveTemporaryShape(int32 ShapeHandle);
+    bool IsValidTemporaryShape(int32 ShapeHandle) const;
+
+    // Advances every instance by one Settings.TimeStep.
+    void Simulate(const FSettings& Settings);
+
+    int32 GetNumInstances() const { return NumLiveInstances; }
+    // Handles are below this; some may be free.
+    int32 GetNumHandles() const { return Instances.Num(); }
+    int32 GetNumIslands() const { return Islands.Num(); }
+    int32 GetNumParticles() const;
+    int32 GetNumTemporaryShapes() const { return NumLiveShapes; }
+    int32 GetNumBroadphasePairs() const { return Broadphase.GetPairs().Num(); }
+    int32 GetNumTemporaryContacts() const;
+    // Pre-roll passes the last Simulate() ran for instances coming back from Frozen.
+    int32 GetNumPreRollPasses() const { return NumPreRollPasses; }
+    // What those passes cost, in GetInstanceCost() units.
+    int32 GetPreRollCost() const { return PreRollCost; }
+
+private:
+    struct FConstraint {
+        float SolverIterations;
+        float Iterations;
+        int32 Batch;
+    };
+
+    struct FLink : public FConstraint {
+        int32 A;
+        int32 B;
+        float RestLength;
+        float WeightA;
+        float WeightB;
+    };
+
+    struct FCone : public FConstraint {
+        int32 Child;
+        int32 Parent;
+        float CosLimit;
+        float SinLimit;
+        float Strength;
+    };
+
+    // ShapeA == ShapeB for spheres, capsules run from ShapeA to ShapeB. Radius is particle radius + shape radius.
+    struct FCollision : public FConstraint {
+        int32 Particle;
+        int32 ShapeA;
+        int32 ShapeB;
+        float Radius;
+    };
+
+    enum class EStepState : uint8 {
+        Simulate,
+        SimulateReduced,
+        // Reduced iterations over two time steps.
+        SimulateDouble,
+        Hold,
+        Pin,
+    };
+
+    enum class ELaneState : uint8 {
+        Full,
+        Reduced,
+        Off,
+    };
+
+    enum class EBatchKind : uint8 {
+        Link,
+        Cone,
+        Collision,
+    };
+
+    // Lanes [Begin, End) of one island batch that belong to one instance.
+    struct FInstanceSpan {
+        EBatchKind Kind;
+        int32 Batch;
+        int32 Begin;
+        int32 End;
+    };
+
+    struct FBatchSpan {
+        int32 Handle;
+        int32 Begin;
+        int32 End;
+    };
+
+    struct FTemporaryShapeState {
+        FTemporaryShape Shape;
+        FBox Bounds;
+        int32 Proxy;
+        bool bAlive;
+    };
+
+    // A receiver particle of the island near a temporary shape at the start of the step.
+    struct FTemporaryContact {
+        int32 Particle;
+        int32 Shape;
+        float Radius;
+    };
+
+    struct FInstance {
+        TArray<float> InvMass;
+        TArray<float> Decay;
+        TArray<FLink> Links;
+        TArray<FCone> Cones;
+        TArray<FCollision> Collisions;
+        TArray<FVector> Positions;
+        TArray<FVector> PrevPositions;
+        TArray<FVector> AnimPositions;
+        TArray<float> WindDrag;
+        TArray<FVector> Wind;
+        // Bodies that collide with temporary shapes, and their radius.
+        TArray<int32> Receivers;
+        TArray<float> ReceiverRadii;
+        float MaxReceiverRadius;
+        int32 Proxy;
+        FVector ProxyCenter;
+        int32 NumLinkBatches;
+        int32 NumConeBatches;
+        int32 NumCollisionBatches;
+        int32 Cost;
+        int32 ReducedCost;
+        int32 IslandIndex;
+        int32 ParticleOffset;
+        TArray<FInstanceSpan> Spans;
+        float MinScreenSize;
+        float LodDistance;
+        float BlendTime;
+        float PreRollTime;
+        float BlendWeight;
+        float LastStepScale;
+        int32 PreRollSteps;
+        EBonamikSolverLod Lod;
+        ELaneState LaneState;
+        EStepState StepState;
+        bool bAlive;
+        bool bReset;
+        bool bPinned;
+        bool bAffectedByWind;
+    };
+
+    // Constraint arrays are padded to a multiple of four; padding lanes point at the island's scratch particle and
+    // have zero weights and iterations. SolverIterations / Iterations are the live values, copied from the full or
+    // reduced ones, or zeroed while the instance is not stepped. Only ActiveRanges (four-lane aligned) are solved.
+    struct FBatch {
+        TArray<float> FullSolverIterations;
+        TArray<float> FullIterations;
+        TArray<float> ReducedSolverIterations;
+        TArray<float> ReducedIterations;
+        TArray<float> SolverIterations;
+        TArray<float> Iterations;
+        TArray<FBatchSpan> Spans;
+        TArray<TPair<int32, int32>> ActiveRanges;
+    };
+
+    struct FLinkBatch : public FBatch {
+        TArray<int32> A;
+        TArray<int32> B;
+        TArray<float> RestLength;
+        TArray<float> WeightA;
+        TArray<float> WeightB;
+    };
+
+    struct FConeBatch : public FBatch {
+        TArray<int32> Child;
+        TArray<int32> Parent;
+        TArray<float> CosLimit;
+        TArray<float> SinLimit;
+        TArray<float> Strength;
+    };
+
+    struct FCollisionBatch : public FBatch {
+        TArray<int32> Particle;
+        TArray<int32> ShapeA;
+        TArray<int32> ShapeB;
+        TArray<float> Radius;
+    };
+
+    struct FIsland {
+        TArray<int32> Instances;
+        int32 NumParticles;
+        TArray<float> PosX, PosY, PosZ;
+        TArray<float> PrevX, PrevY, PrevZ;
+        TArray<float> AnimX, AnimY, AnimZ;
+        TArray<float> InvMass;
+        TArray<float> Decay;
+        // Wind acceleration, already scaled by drag.
+        TArray<float> WindX, WindY, WindZ;
+        // Per step: EStepState of the particle's instance, velocity and gravity factors of its step length.
+        TArray<EStepState> StepStates;
+        TArray<float> StepDecay;
+        TArray<float> StepVelocityScale;
+        TArray<float> StepGravity;
+        TArray<FLinkBatch> LinkBatches;
+        TArray<FConeBatch> ConeBatches;
+        TArray<FCollisionBatch> CollisionBatches;
+        TArray<FTemporaryContact> TemporaryContacts;
+        int32 MaxSolverIterations;
+        int32 MaxLinkIterations;
+        int32 MaxConeIterations;
+        int32 MaxCollisionIterations;
+        int32 Cost;
+    };
+
+    int32 GetIslandTarget(const FSettings& Settings) const;
+    void GatherIslandState();
+    void RebuildIslands(const FSettings& Settings);
+    void UploadAnimatedPoses();
+    EStepState GetStepState(int32 Handle, int32 PreRollPass) const;
+    void ApplyStepStates(int32 PreRollPass);
+    void UpdateBlendWeights(const FSettings& Settings);
+    FBatch& GetBatch(FIsland& Island, const FInstanceSpan& Span);
+    void AddSpans(FIsland& Island, int32 Handle, EBatchKind Kind, const TArray<int32>& Begins);
+    static void AddToBatch(FBatch& Batch, const FConstraint& Constraint);
+    static void PadBatch(FBatch& Batch);
+    static void UpdateActiveRanges(FIsland& Island, const TArray<FInstance>& Instances);
+    void UpdateTemporaryContacts();
+    void RunIslands(const FSettings& Settings);
+    static void SimulateIsland(FIsland& Island, const FSettings& Settings, const TArray<FTemporaryShapeState>& Shapes);
+    static void IntegrateIsland(FIsland& Island, const FVector& GravityStep, float StepTimeSquared, bool bFirstSubStep);
+    static void SolveLinkBatch(FIsland& Island, const FLinkBatch& Batch, int32 SolverIteration, int32 Iteration);
+    static void SolveConeBatch(FIsland& Island, const FConeBatch& Batch, int32 SolverIteration, int32 Iteration);
+    static void SolveCollisionBatch(FIsland& Island, const FCollisionBatch& Batch, int32 SolverIteration, int32 Iteration);
+    static void SolveTemporaryContacts(FIsland& Island, const TArray<FTemporaryShapeState>& Shapes);
+
+    TArray<FInstance> Instances;
+    TArray<int32> FreeHandles;
+    TArray<FIsland> Islands;
+    FBonamikBroadphase Broadphase;
+    TArray<FTemporaryShapeState> TemporaryShapes;
+    TArray<int32> FreeShapeHandles;
+    int32 NumLiveShapes;
+    int32 NumLiveInstances;
+    int32 BuiltIslandTarget;
+    int32 NumPreRollPasses;
+    int32 PreRollCost;
+    uint32 StepCounter;
+    bool bIslandsDirty;
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class USQEX_BonamikWindDesc_v2;
+struct FCustomWindSettings;
+struct FSQEX_BonamikWind_Desc;
+
+enum class EBonamikWindSourceType : uint8 {
+    // Force everywhere in the area.
+    Directional,
+    // Force plus a per axis sine.
+    Wave,
+    // Force plus CustomWave, played back over CustomWaveTime seconds and looped.
+    CustomWave,
+    // Blows away from the source location, expanding at BlastSpeed up to BlastRange.
+    Point,
+};
+
+// ESQEX_Bonamik_WindAreaType.
+enum class EBonamikWindArea : uint8 {
+    Global,
+    Box,
+    Sphere,
+};
+
+// One wind contribution, built from the wind assets or set up by hand. Forces are accelerations in cm/s^2 that bodies
+// scale by their m_WindDrag.
+struct BONAMIKRT_API FBonamikWindSource {
+    EBonamikWindSourceType Type;
+    EBonamikWindArea Area;
+    // Places the area; point sources blow from its location.
+    FTransform Transform;
+    // Half size of a box area, radius of a sphere area.
+    FVector Extent;
+    float Radius;
+    FVector Force;
+    // Random offset in [-RandomRange, RandomRange] per axis, redrawn every RandomTime seconds and blended in between.
+    FVector RandomRange;
+    float RandomTime;
+    FVector WaveMagnitude;
+    FVector WaveFrequency;
+    FVector WaveMagOffset;
+    FVector WaveFreqOffset;
+    TArray<FVector> CustomWave;
+    float CustomWaveTime;
+    float PointStrength;
+    float PointRadius;
+    float BlastRange;
+    float BlastSpeed;
+    // World time the blast starts expanding from.
+    float StartTime;
+    float Scale;
+    uint32 Seed;
+
+    FBonamikWindSource();
+
+    static FBonamikWindSource FromWindDesc(const USQEX_BonamikWindDesc_v2& Desc);
+    static FBonamikWindSource FromCustomWindSettings(const FCustomWindSettings& Settings);
+    // Local wind notifies. Distance and time modulation curves, pulses and noise are not evaluated.
+    static FBonamikWindSource FromLocalWindDesc(const FSQEX_BonamikWind_Desc& Desc);
+
+    // Where the source can be non zero; false when it reaches everywhere.
+    bool GetBounds(FBox& OutBounds) const;
+    // Same value at every position inside a global area.
+    bool IsUniform() const;
+    FVector Evaluate(const FVector& Position, float Time) const;
+};
+
+// Sparse wind grid. Space is split into bricks of BrickCells^3 cells; a brick exists while something samples inside it
+// (RequestRegion) and is close enough to the grid center, usually the camera. Once per frame Rasterize() evaluates every
+// source at the nodes of the live bricks, uniform sources only once for the whole grid, so the cost follows the number
+// of cells rather than particles times sources. Sample() is one hash lookup and a trilinear blend; positions outside the
+// live bricks fall back to evaluating the sources.
+class BONAMIKRT_API FBonamikWindField {
+public:
+    static const int32 BrickCells = 4;
+    static const int32 BrickNodes = BrickCells + 1;
+
+    FBonamikWindField();
+
+    int32 AddSource(const FBonamikWindSource& Source);
+    void SetSource(int32 Handle, const FBonamikWindSource& Source);
+    void RemoveSource(int32 Handle);
+    bool IsValidSource(int32 Handle) const;
+    // m_WindForce of the scene, added everywhere.
+    void SetGlobalWind(const FVector& Wind);
+
+    // Keeps the bricks overlapping Box alive; new ones are filled by the next Rasterize().
+    void RequestRegion(const FBox& Box);
+    // Bricks farther than Range from Center are dropped unless bUseCenter is false.
+    void Rasterize(const FVector& Center, bool bUseCenter, float Range, float InCellSize, float InTime, bool bMultiThread);
+    // Moves the time of Evaluate() without touching the bricks.
+    void SetTime(float InTime) { Time = InTime; }
+
+    FVector Sample(const FVector& Position) const;
+    void SampleBatch(const TArray<FVector>& Positions, TArray<FVector>& OutWind) const;
+    // Reference: every source evaluated at Position for the rasterized time.
+    FVector Evaluate(const FVector& Position) const;
+
+    int32 GetNumSources() const { return NumLiveSources; }
+    int32 GetNumBricks() const { return Bricks.Num(); }
+    bool HasRequests() const { return RequestedRegions.Num() > 0; }
+    float GetCellSize() const { return CellSize; }
+    // Samples that missed the grid since the last Rasterize().
+    int32 GetNumFallbackSamples() const { return NumFallbackSamples.GetValue(); }
+    FBox GetBrickBounds(int32 Brick) const;
+    FVector GetNodeWind(int32 Brick, int32 X, int32 Y, int32 Z) const { return Bricks[Brick].Nodes[X + (Y + Z * BrickNodes) * BrickNodes]; }
+
+private:
+    struct FSourceSlot {
+        FBonamikWindSource Source;
+        FBox Bounds;
+        bool bBounded;
+        bool bAlive;
+    };
+
+    struct FBrick {
+        FIntVector Key;
+        uint32 LastRequest;
+        FVector Nodes[BrickNodes * BrickNodes * BrickNodes];
+    };
+
+    FIntVector GetBrickKey(const FVector& Position) const;
+    void RasterizeBrick(FBrick& Brick) const;
+
+    TArray<FSourceSlot> Sources;
+    TArray<int32> FreeSources;
+    int32 NumLiveSources;
+    FVector GlobalWind;
+
+    TArray<FBrick> Bricks;
+    TMap<FIntVector, int32> BrickMap;
+    TArray<FBox> RequestedRegions;
+    // Sources rasterized per brick, and the sum of the uniform ones.
+    TArray<int32> LocalSources;
+    FVector UniformWind;
+    float CellSize;
+    float Time;
+    uint32 Generation;
+    mutable FThreadSafeCounter NumFallbackSamples;
+};
@@ -13,5 +13,8 @@ public:
     
     ADEPRECATED_SQEX_BonamikCustomWind_Actor_v2(const FObjectInitializer& ObjectInitializer);
 
+protected:
+    // m_WindSetting replaces the wind desc of the component; its area and direction still apply.
+    virtual bool GetWindSettings(FBonamikWindSource& OutSource) const override;
 };
 
@@ -93,6 +93,16 @@ public:
     UPROPERTY(BlueprintReadWrite, Config, EditAnywhere, meta=(AllowPrivateAccess=true))
     int32 OverrideSolverIteration;
     
+    // Solve every instance registered with USQEX_BonamikSceneSubsystem together. Off by default: only characters with a
+    // USQEX_BonamikSceneComponent or that register from Blueprint are simulated by it, the per-component solver keeps
+    // handling everything else.
+    UPROPERTY(BlueprintReadWrite, Config, EditAnywhere, meta=(AllowPrivateAccess=true))
+    bool bBatchedSceneSolver;
+    
+    // Particles each parallel island of the batched solver needs before the scene is split further.
+    UPROPERTY(BlueprintReadWrite, Config, EditAnywhere, meta=(AllowPrivateAccess=true))
+    int32 BatchedSolverMinParticlesPerIsland;
+    
     USQEX_BonamikGlobalConfig_v2();
 
 };
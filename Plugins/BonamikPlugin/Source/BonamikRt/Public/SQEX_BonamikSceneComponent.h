@@ -0,0 +1,50 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SQEX_BonamikSceneComponent.generated.h"
+
+class USkeletalMeshComponent;
+class USQEX_BonamikAsset_v2;
+
+// Registers the Bonamik assets of a skeletal mesh with USQEX_BonamikSceneSubsystem while bBatchedSceneSolver is set.
+// Every tick it pushes the animated joint positions and reads back the simulated ones, which the anim graph picks up
+// through GetSimulatedBoneLocation. Without the flag it does nothing and the per-component solver stays in charge.
+UCLASS(Blueprintable, ClassGroup=Custom, meta=(BlueprintSpawnableComponent))
+class BONAMIKRT_API USQEX_BonamikSceneComponent : public UActorComponent {
+    GENERATED_BODY()
+public:
+    // Assets to register; the USQEX_BonamikAssetUserData_v2 of the mesh when empty.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true))
+    TArray<USQEX_BonamikAsset_v2*> BonamikAssets;
+    
+    // Mesh whose joints are simulated; the first skeletal mesh of the owner when not set.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Instanced, Transient, meta=(AllowPrivateAccess=true))
+    USkeletalMeshComponent* SkeletalMeshComponent;
+    
+    USQEX_BonamikSceneComponent(const FObjectInitializer& ObjectInitializer);
+
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    // World position of the joint after the last scene solve; false when no registered asset simulates it.
+    UFUNCTION(BlueprintCallable, BlueprintPure)
+    bool GetSimulatedBoneLocation(FName BoneName, FVector& OutLocation) const;
+
+    UFUNCTION(BlueprintCallable)
+    void ResetSimulation();
+
+private:
+    struct FInstance {
+        int32 Handle;
+        TArray<int32> BoneIndices;
+        TArray<FVector> Positions;
+    };
+
+    void GetBonePositions(const TArray<int32>& BoneIndices, TArray<FVector>& OutPositions) const;
+    void UnregisterInstances();
+
+    TArray<FInstance> Instances;
+    // Bone name to instance and body index.
+    TMap<FName, TPair<int32, int32>> SimulatedBones;
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "BonamikLodScheduler.h"
+#include "BonamikSceneSolver.h"
+#include "SQEX_BonamikSceneSubsystem.generated.h"
+
+class USQEX_BonamikAsset_v2;
+
+// Owns the world's FBonamikSceneSolver and steps it at USQEX_BonamikGlobalConfig_v2::TimeStep while
+// bBatchedSceneSolver is set. Instances push their animated pose during their own tick and read back the result of the
+// previous solve, so every character registered with the world is solved together once per step.
+//
+// USQEX_BonamikSceneComponent registers the Bonamik assets of a skeletal mesh. Anything else can register from
+// Blueprint: register the asset with the body reference pose, then push the animated body positions and apply the
+// simulated ones to the bones every frame.
+//
+// Before stepping, FBonamikLodScheduler ranks the registered instances against the first player's camera and degrades
+// them until the predicted solve time fits bonamik.Lod.BudgetMs. Like the solver, it only runs while bBatchedSceneSolver
+// is set and something is registered.
+//
+// Instances with m_WindDrag sample USQEX_BonamikWindFieldSubsystem at their simulated pose once per frame.
+UCLASS()
+class BONAMIKRT_API USQEX_BonamikSceneSubsystem : public UWorldSubsystem, public FTickableGameObject {
+    GENERATED_BODY()
+public:
+    USQEX_BonamikSceneSubsystem();
+
+    static USQEX_BonamikSceneSubsystem* Get(const UObject* WorldContextObject);
+
+    virtual void Deinitialize() override;
+
+    virtual void Tick(float DeltaTime) override;
+    virtual ETickableTickType GetTickableTickType() const override;
+    virtual bool IsTickable() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override;
+    virtual TStatId GetStatId() const override;
+
+    // See FBonamikSceneSolver; handles stay valid until unregistered or the world goes away.
+    UFUNCTION(BlueprintCallable)
+    int32 RegisterInstance(const USQEX_BonamikAsset_v2* Asset, const TArray<FVector>& ReferencePose);
+    
+    UFUNCTION(BlueprintCallable)
+    void UnregisterInstance(int32 Handle);
+    
+    UFUNCTION(BlueprintCallable)
+    void SetAnimatedPose(int32 Handle, const TArray<FVector>& BodyPositions);
+    
+    UFUNCTION(BlueprintCallable)
+    void ResetInstance(int32 Handle);
+    
+    UFUNCTION(BlueprintCallable, BlueprintPure)
+    void GetSimulatedPose(int32 Handle, TArray<FVector>& OutBodyPositions) const;
+
+    // Temporary collision volumes, e.g. from ASQEX_Bonamik_TemporaryCollisionActor or
+    // SQEX_AnimNotifyState_Bonamik_TemporaryCollision; see FBonamikSceneSolver::FTemporaryShape.
+    int32 AddTemporaryShape(const FBonamikSceneSolver::FTemporaryShape& Shape);
+    void SetTemporaryShapeTransform(int32 ShapeHandle, const FTransform& Transform);
+    void RemoveTemporaryShape(int32 ShapeHandle);
+
+    // Scales the LOD priority of the instance, 1 by default.
+    UFUNCTION(BlueprintCallable)
+    void SetInstanceImportance(int32 Handle, float Importance);
+    
+    // Screen size to rank the instance with instead of its bounds seen from the first player's camera, e.g. the
+    // component's PrevScreenSize. Negative values go back to the estimate.
+    UFUNCTION(BlueprintCallable)
+    void SetInstanceScreenSize(int32 Handle, float ScreenSize);
+
+    const FBonamikLodScheduler::FStats& GetLodStats() const { return LodScheduler.GetStats(); }
+    const FBonamikSceneSolver& GetSolver() const { return Solver; }
+
+private:
+    FBonamikSceneSolver::FSettings MakeSettings() const;
+    FBonamikLodScheduler::FView GetLodView() const;
+    void UpdateWind();
+
+    FBonamikSceneSolver Solver;
+    FBonamikLodScheduler LodScheduler;
+    TArray<FVector> WindPositions;
+    TArray<FVector> WindSamples;
+    float TimeAccumulator;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "BonamikWindField.h"
+#include "SQEX_BonamikWindFieldSubsystem.generated.h"
+
+// Owns the world's FBonamikWindField. Wind actors, presets and notifies add their sources here; users request the
+// regions they will sample, and once per frame the field is rasterized around the first player's camera. Samples read
+// the field of the previous rasterization, so a region requested for the first time is evaluated directly for one frame.
+//
+// bonamik.WindField.Enable 0 evaluates every sample directly, for comparison. USQEX_BonamikGlobalConfig_v2::bDebugDrawWind
+// draws the live bricks and the wind at their nodes.
+UCLASS()
+class BONAMIKRT_API USQEX_BonamikWindFieldSubsystem : public UWorldSubsystem, public FTickableGameObject {
+    GENERATED_BODY()
+public:
+    static USQEX_BonamikWindFieldSubsystem* Get(const UObject* WorldContextObject);
+
+    virtual void Deinitialize() override;
+
+    virtual void Tick(float DeltaTime) override;
+    virtual ETickableTickType GetTickableTickType() const override;
+    virtual bool IsTickable() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override;
+    virtual TStatId GetStatId() const override;
+
+    // See FBonamikWindField. Point blasts expand from their StartTime, usually GetWorld()->GetTimeSeconds().
+    int32 AddSource(const FBonamikWindSource& Source);
+    void SetSource(int32 Handle, const FBonamikWindSource& Source);
+    void RemoveSource(int32 Handle);
+    void SetGlobalWind(const FVector& Wind);
+
+    void RequestRegion(const FBox& Box);
+    FVector Sample(const FVector& Position) const;
+    void SampleBatch(const TArray<FVector>& Positions, TArray<FVector>& OutWind) const;
+
+    const FBonamikWindField& GetField() const { return Field; }
+
+private:
+    void DrawDebug() const;
+
+    FBonamikWindField Field;
+};
@@ -4,7 +4,10 @@
 #include "SQEX_BonamikWind_Actor_v2.generated.h"
 
 class UDEPRECATED_SQEX_BonamikWind_Component_v2;
+struct FBonamikWindSource;
 
+// Adds the wind of m_BonamikWind_Component to USQEX_BonamikWindFieldSubsystem from BeginPlay to EndPlay, in the area and
+// direction the component sets up. The component's global area adds to the wind everywhere.
 UCLASS(Blueprintable, Deprecated, NotPlaceable)
 class BONAMIKRT_API ADEPRECATED_SQEX_BonamikWind_Actor_v2 : public AInfo {
     GENERATED_BODY()
@@ -14,6 +17,9 @@ public:
     
     ADEPRECATED_SQEX_BonamikWind_Actor_v2(const FObjectInitializer& ObjectInitializer);
 
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
     UFUNCTION(BlueprintCallable)
     void SetWindScale(float Value);
     
@@ -23,5 +29,19 @@ public:
     UFUNCTION(BlueprintCallable)
     void Enable(bool Value);
     
+protected:
+    // Force, wave and blast settings of the wind, before the component's area and direction are applied. False when
+    // there is nothing to blow.
+    virtual bool GetWindSettings(FBonamikWindSource& OutSource) const;
+
+private:
+    bool MakeWindSource(FBonamikWindSource& OutSource) const;
+    void UpdateWindSource();
+
+    int32 WindSourceHandle;
+    float WindScale;
+    bool bWindEnabled;
+    // Point blasts expand from BeginPlay.
+    float WindStartTime;
 };
 
@@ -1,8 +1,78 @@
 #include "SQEX_AnimNotifyState_Bonamik_LocalWindDirect.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "SQEX_BonamikWindFieldSubsystem.h"
 
 USQEX_AnimNotifyState_Bonamik_LocalWindDirect::USQEX_AnimNotifyState_Bonamik_LocalWindDirect() {
     this->Scale = 1.00f;
     this->bDisableWorldWind = true;
 }
 
+void USQEX_AnimNotifyState_Bonamik_LocalWindDirect::NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration) {
+    Super::NotifyBegin(MeshComp, Animation, TotalDuration);
+
+    USQEX_BonamikWindFieldSubsystem* WindField = MeshComp != NULL ? USQEX_BonamikWindFieldSubsystem::Get(MeshComp) : NULL;
+    if (WindField == NULL) {
+        return;
+    }
+
+    // A notify restarting before its end (montage jumps, looping sections) replaces the previous sources.
+    TArray<FActiveWind>& Winds = ActiveWinds.FindOrAdd(MeshComp);
+    for (const FActiveWind& Wind : Winds) {
+        WindField->RemoveSource(Wind.SourceHandle);
+    }
+    Winds.Reset();
+
+    const float StartTime = MeshComp->GetWorld()->GetTimeSeconds();
+
+    if (!WindDesc.mEnable) {
+        return;
+    }
+
+    FActiveWind& Wind = Winds.AddDefaulted_GetRef();
+    Wind.LocalSource = FBonamikWindSource::FromLocalWindDesc(WindDesc);
+    Wind.LocalSource.StartTime = StartTime;
+    Wind.SourceHandle = WindField->AddSource(MakeWorldSource(MeshComp, Wind.LocalSource));
+}
+
+void USQEX_AnimNotifyState_Bonamik_LocalWindDirect::NotifyTick(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float FrameDeltaTime) {
+    Super::NotifyTick(MeshComp, Animation, FrameDeltaTime);
+
+    const TArray<FActiveWind>* Winds = MeshComp != NULL ? ActiveWinds.Find(MeshComp) : NULL;
+    USQEX_BonamikWindFieldSubsystem* WindField = Winds != NULL ? USQEX_BonamikWindFieldSubsystem::Get(MeshComp) : NULL;
+    if (WindField == NULL) {
+        return;
+    }
+
+    for (const FActiveWind& Wind : *Winds) {
+        WindField->SetSource(Wind.SourceHandle, MakeWorldSource(MeshComp, Wind.LocalSource));
+    }
+}
+
+void USQEX_AnimNotifyState_Bonamik_LocalWindDirect::NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation) {
+    Super::NotifyEnd(MeshComp, Animation);
+
+    TArray<FActiveWind> Winds;
+    if (MeshComp == NULL || !ActiveWinds.RemoveAndCopyValue(MeshComp, Winds)) {
+        return;
+    }
+
+    USQEX_BonamikWindFieldSubsystem* WindField = USQEX_BonamikWindFieldSubsystem::Get(MeshComp);
+    if (WindField != NULL) {
+        for (const FActiveWind& Wind : Winds) {
+            WindField->RemoveSource(Wind.SourceHandle);
+        }
+    }
+}
+
+FBonamikWindSource USQEX_AnimNotifyState_Bonamik_LocalWindDirect::MakeWorldSource(const USkeletalMeshComponent* MeshComp, const FBonamikWindSource& LocalSource) const {
+    const FTransform MeshTransform(MeshComp->GetComponentQuat(), MeshComp->GetComponentLocation());
+    const FTransform Parent = FTransform(OffsetRotation, OffsetTranslation) * MeshTransform;
+
+    FBonamikWindSource Source = LocalSource;
+    Source.Transform = LocalSource.Transform * Parent;
+    Source.Force = Parent.TransformVectorNoScale(LocalSource.Force);
+    Source.Scale = LocalSource.Scale * Scale;
+    return Source;
+}
 
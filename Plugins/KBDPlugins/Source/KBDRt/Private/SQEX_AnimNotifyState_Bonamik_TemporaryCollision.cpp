@@ -1,4 +1,18 @@
 #include "SQEX_AnimNotifyState_Bonamik_TemporaryCollision.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "DrawDebugHelpers.h"
+#include "SQEX_BonamikSceneSubsystem.h"
+
+static float ConstrainAxis(bool bConstraint, float Value, float BeginValue) {
+    return bConstraint ? BeginValue : Value;
+}
+
+static FVector ConstrainVector(const FSQEX_AnimNotifyState_Bonamik_TemporaryCollision_ConstraintTransformRules_Vec3& Rules, const FVector& Value, const FVector& BeginValue) {
+    return FVector(
+        ConstrainAxis(Rules.bConstraintX, Value.X, BeginValue.X),
+        ConstrainAxis(Rules.bConstraintY, Value.Y, BeginValue.Y),
+        ConstrainAxis(Rules.bConstraintZ, Value.Z, BeginValue.Z));
+}
 
 USQEX_AnimNotifyState_Bonamik_TemporaryCollision::USQEX_AnimNotifyState_Bonamik_TemporaryCollision() {
     this->ShapeType = ESQEX_AnimNotifyState_Bonamik_TemporaryCollision_CollisionType::Box;
@@ -9,4 +23,98 @@ USQEX_AnimNotifyState_Bonamik_TemporaryCollision::USQEX_AnimNotifyState_Bonamik_
     this->DebugLineThickness = 0.50f;
 }
 
+void USQEX_AnimNotifyState_Bonamik_TemporaryCollision::NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration) {
+    Super::NotifyBegin(MeshComp, Animation, TotalDuration);
+
+    USQEX_BonamikSceneSubsystem* Scene = MeshComp != NULL ? USQEX_BonamikSceneSubsystem::Get(MeshComp) : NULL;
+    if (Scene == NULL) {
+        return;
+    }
+
+    // A notify restarting before its end (montage jumps, looping sections) replaces the previous shape.
+    FActiveShape* Previous = ActiveShapes.Find(MeshComp);
+    if (Previous != NULL) {
+        Scene->RemoveTemporaryShape(Previous->ShapeHandle);
+    }
+
+    FBonamikSceneSolver::FTemporaryShape Shape;
+    switch (ShapeType) {
+    case ESQEX_AnimNotifyState_Bonamik_TemporaryCollision_CollisionType::Sphere:
+        Shape.Type = EBonamikTemporaryShape::Sphere;
+        break;
+    case ESQEX_AnimNotifyState_Bonamik_TemporaryCollision_CollisionType::Capsule:
+        Shape.Type = EBonamikTemporaryShape::Capsule;
+        break;
+    default:
+        Shape.Type = EBonamikTemporaryShape::Box;
+        break;
+    }
+    Shape.Transform = GetCollisionTransform(MeshComp);
+    Shape.BoxExtent = BoxSize;
+    Shape.Radius = Radius;
+    Shape.HalfHeight = FMath::Max(CapsuleHalfHeight, Radius);
+
+    FActiveShape& Active = ActiveShapes.Add(MeshComp);
+    Active.ShapeHandle = Scene->AddTemporaryShape(Shape);
+    Active.BeginTransform = Shape.Transform;
+}
+
+void USQEX_AnimNotifyState_Bonamik_TemporaryCollision::NotifyTick(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float FrameDeltaTime) {
+    Super::NotifyTick(MeshComp, Animation, FrameDeltaTime);
+
+    const FActiveShape* Active = MeshComp != NULL ? ActiveShapes.Find(MeshComp) : NULL;
+    USQEX_BonamikSceneSubsystem* Scene = Active != NULL ? USQEX_BonamikSceneSubsystem::Get(MeshComp) : NULL;
+    if (Scene == NULL) {
+        return;
+    }
+
+    const FTransform Transform = ApplyConstraints(GetCollisionTransform(MeshComp), Active->BeginTransform);
+    Scene->SetTemporaryShapeTransform(Active->ShapeHandle, Transform);
+
+#if ENABLE_DRAW_DEBUG
+    if (bDebugVisibility) {
+        UWorld* World = MeshComp->GetWorld();
+        switch (ShapeType) {
+        case ESQEX_AnimNotifyState_Bonamik_TemporaryCollision_CollisionType::Sphere:
+            DrawDebugSphere(World, Transform.GetLocation(), Radius, 16, DebugLineColor, false, -1.00f, 0, DebugLineThickness);
+            break;
+        case ESQEX_AnimNotifyState_Bonamik_TemporaryCollision_CollisionType::Capsule:
+            DrawDebugCapsule(World, Transform.GetLocation(), FMath::Max(CapsuleHalfHeight, Radius), Radius, Transform.GetRotation(), DebugLineColor, false, -1.00f, 0, DebugLineThickness);
+            break;
+        default:
+            DrawDebugBox(World, Transform.GetLocation(), BoxSize, Transform.GetRotation(), DebugLineColor, false, -1.00f, 0, DebugLineThickness);
+            break;
+        }
+    }
+#endif
+}
+
+void USQEX_AnimNotifyState_Bonamik_TemporaryCollision::NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation) {
+    Super::NotifyEnd(MeshComp, Animation);
+
+    FActiveShape Active;
+    if (MeshComp == NULL || !ActiveShapes.RemoveAndCopyValue(MeshComp, Active)) {
+        return;
+    }
 
+    USQEX_BonamikSceneSubsystem* Scene = USQEX_BonamikSceneSubsystem::Get(MeshComp);
+    if (Scene != NULL) {
+        Scene->RemoveTemporaryShape(Active.ShapeHandle);
+    }
+}
+
+FTransform USQEX_AnimNotifyState_Bonamik_TemporaryCollision::GetCollisionTransform(const USkeletalMeshComponent* MeshComp) const {
+    const FTransform Parent = bAttachToSocket ? MeshComp->GetSocketTransform(SocketName) : MeshComp->GetComponentTransform();
+    return CollisionTransform * Parent;
+}
+
+FTransform USQEX_AnimNotifyState_Bonamik_TemporaryCollision::ApplyConstraints(const FTransform& Transform, const FTransform& BeginTransform) const {
+    const FRotator Rotation = Transform.Rotator();
+    const FRotator BeginRotation = BeginTransform.Rotator();
+    const FVector ConstrainedRotation = ConstrainVector(ConstraintTransform.ConstraintRotation, FVector(Rotation.Roll, Rotation.Pitch, Rotation.Yaw), FVector(BeginRotation.Roll, BeginRotation.Pitch, BeginRotation.Yaw));
+
+    return FTransform(
+        FRotator(ConstrainedRotation.Y, ConstrainedRotation.Z, ConstrainedRotation.X),
+        ConstrainVector(ConstraintTransform.ConstraintLocation, Transform.GetLocation(), BeginTransform.GetLocation()),
+        ConstrainVector(ConstraintTransform.ConstraintScale, Transform.GetScale3D(), BeginTransform.GetScale3D()));
+}
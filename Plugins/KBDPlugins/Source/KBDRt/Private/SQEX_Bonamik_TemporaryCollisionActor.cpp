@@ -1,8 +1,73 @@
 #include "SQEX_Bonamik_TemporaryCollisionActor.h"
+#include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
 #include "Components/SceneComponent.h"
+#include "Components/SphereComponent.h"
+#include "SQEX_BonamikSceneSubsystem.h"
 
 ASQEX_Bonamik_TemporaryCollisionActor::ASQEX_Bonamik_TemporaryCollisionActor(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
     this->RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+    this->PrimaryActorTick.bCanEverTick = true;
 }
 
+void ASQEX_Bonamik_TemporaryCollisionActor::BeginPlay() {
+    Super::BeginPlay();
+
+    USQEX_BonamikSceneSubsystem* Scene = USQEX_BonamikSceneSubsystem::Get(this);
+    if (Scene == NULL) {
+        return;
+    }
+
+    TInlineComponentArray<UShapeComponent*> Components(this);
+    for (UShapeComponent* Component : Components) {
+        // Shape extents are scaled here because the solver ignores the transform's scale.
+        FBonamikSceneSolver::FTemporaryShape Shape;
+        if (const UBoxComponent* Box = Cast<UBoxComponent>(Component)) {
+            Shape.Type = EBonamikTemporaryShape::Box;
+            Shape.BoxExtent = Box->GetScaledBoxExtent();
+        } else if (const USphereComponent* Sphere = Cast<USphereComponent>(Component)) {
+            Shape.Type = EBonamikTemporaryShape::Sphere;
+            Shape.Radius = Sphere->GetScaledSphereRadius();
+        } else if (const UCapsuleComponent* Capsule = Cast<UCapsuleComponent>(Component)) {
+            Shape.Type = EBonamikTemporaryShape::Capsule;
+            Shape.Radius = Capsule->GetScaledCapsuleRadius();
+            Shape.HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+        } else {
+            continue;
+        }
+        Shape.Transform = Component->GetComponentTransform();
+
+        FRegisteredShape& Registered = RegisteredShapes.AddDefaulted_GetRef();
+        Registered.Component = Component;
+        Registered.ShapeHandle = Scene->AddTemporaryShape(Shape);
+    }
+}
+
+void ASQEX_Bonamik_TemporaryCollisionActor::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+    USQEX_BonamikSceneSubsystem* Scene = USQEX_BonamikSceneSubsystem::Get(this);
+    if (Scene != NULL) {
+        for (const FRegisteredShape& Registered : RegisteredShapes) {
+            Scene->RemoveTemporaryShape(Registered.ShapeHandle);
+        }
+    }
+    RegisteredShapes.Reset();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void ASQEX_Bonamik_TemporaryCollisionActor::Tick(float DeltaSeconds) {
+    Super::Tick(DeltaSeconds);
+
+    USQEX_BonamikSceneSubsystem* Scene = RegisteredShapes.Num() > 0 ? USQEX_BonamikSceneSubsystem::Get(this) : NULL;
+    if (Scene == NULL) {
+        return;
+    }
+
+    for (const FRegisteredShape& Registered : RegisteredShapes) {
+        const UShapeComponent* Component = Registered.Component.Get();
+        if (Component != NULL) {
+            Scene->SetTemporaryShapeTransform(Registered.ShapeHandle, Component->GetComponentTransform());
+        }
+    }
+}
 
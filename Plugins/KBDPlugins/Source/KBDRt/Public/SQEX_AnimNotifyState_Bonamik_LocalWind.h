@@ -3,8 +3,10 @@
 #include "UObject/NoExportTypes.h"
 #include "UObject/NoExportTypes.h"
 #include "Animation/AnimNotifies/AnimNotifyState.h"
+#include "BonamikWindField.h"
 #include "SQEX_AnimNotifyState_Bonamik_LocalWind.generated.h"
 
+class USkeletalMeshComponent;
 class USQEX_BonamikWind_Asset;
 
 UCLASS(Blueprintable, CollapseCategories, EditInlineNew)
@@ -28,5 +30,22 @@ public:
     
     USQEX_AnimNotifyState_Bonamik_LocalWind();
 
+    // Adds every enabled wind of WindAsset to USQEX_BonamikWindFieldSubsystem from NotifyBegin to NotifyEnd, placed by
+    // the offset relative to the mesh and following it. One notify object serves every mesh playing the animation, so
+    // sources are tracked per mesh.
+    virtual void NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration) override;
+    virtual void NotifyTick(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float FrameDeltaTime) override;
+    virtual void NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation) override;
+
+private:
+    struct FActiveWind {
+        int32 SourceHandle;
+        // Source relative to the offset, as built from the wind desc.
+        FBonamikWindSource LocalSource;
+    };
+
+    FBonamikWindSource MakeWorldSource(const USkeletalMeshComponent* MeshComp, const FBonamikWindSource& LocalSource) const;
+
+    TMap<TWeakObjectPtr<USkeletalMeshComponent>, TArray<FActiveWind>> ActiveWinds;
 };
 
@@ -4,8 +4,11 @@
 #include "UObject/NoExportTypes.h"
 #include "UObject/NoExportTypes.h"
 #include "Animation/AnimNotifies/AnimNotifyState.h"
+#include "BonamikWindField.h"
 #include "SQEX_AnimNotifyState_Bonamik_LocalWindDirect.generated.h"
 
+class USkeletalMeshComponent;
+
 UCLASS(Blueprintable, CollapseCategories, EditInlineNew)
 class KBDRT_API USQEX_AnimNotifyState_Bonamik_LocalWindDirect : public UAnimNotifyState {
     GENERATED_BODY()
@@ -27,5 +30,21 @@ public:
     
     USQEX_AnimNotifyState_Bonamik_LocalWindDirect();
 
+    // Adds WindDesc to USQEX_BonamikWindFieldSubsystem from NotifyBegin to NotifyEnd, placed by the offset relative to
+    // the mesh and following it. Sources are tracked per mesh, like USQEX_AnimNotifyState_Bonamik_LocalWind.
+    virtual void NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration) override;
+    virtual void NotifyTick(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float FrameDeltaTime) override;
+    virtual void NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation) override;
+
+private:
+    struct FActiveWind {
+        int32 SourceHandle;
+        // Source relative to the offset, as built from the wind desc.
+        FBonamikWindSource LocalSource;
+    };
+
+    FBonamikWindSource MakeWorldSource(const USkeletalMeshComponent* MeshComp, const FBonamikWindSource& LocalSource) const;
+
+    TMap<TWeakObjectPtr<USkeletalMeshComponent>, TArray<FActiveWind>> ActiveWinds;
 };
 
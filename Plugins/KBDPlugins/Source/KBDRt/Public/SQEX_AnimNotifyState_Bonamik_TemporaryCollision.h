@@ -8,6 +8,8 @@
 #include "SQEX_AnimNotifyState_Bonamik_TemporaryCollision_ConstraintTransformRules.h"
 #include "SQEX_AnimNotifyState_Bonamik_TemporaryCollision.generated.h"
 
+class USkeletalMeshComponent;
+
 UCLASS(Blueprintable, CollapseCategories, EditInlineNew)
 class KBDRT_API USQEX_AnimNotifyState_Bonamik_TemporaryCollision : public UAnimNotifyState {
     GENERATED_BODY()
@@ -52,5 +54,22 @@ protected:
 public:
     USQEX_AnimNotifyState_Bonamik_TemporaryCollision();
 
+    // The shape lives in USQEX_BonamikSceneSubsystem from NotifyBegin to NotifyEnd and follows the mesh or socket.
+    // One notify object serves every mesh playing the animation, so shapes are tracked per mesh.
+    virtual void NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration) override;
+    virtual void NotifyTick(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float FrameDeltaTime) override;
+    virtual void NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation) override;
+
+private:
+    struct FActiveShape {
+        int32 ShapeHandle;
+        // Collision transform at NotifyBegin; constrained axes keep its values.
+        FTransform BeginTransform;
+    };
+
+    FTransform GetCollisionTransform(const USkeletalMeshComponent* MeshComp) const;
+    FTransform ApplyConstraints(const FTransform& Transform, const FTransform& BeginTransform) const;
+
+    TMap<TWeakObjectPtr<USkeletalMeshComponent>, FActiveShape> ActiveShapes;
 };
 
@@ -3,11 +3,26 @@
 #include "GameFramework/Actor.h"
 #include "SQEX_Bonamik_TemporaryCollisionActor.generated.h"
 
+class UShapeComponent;
+
+// Registers every box, sphere and capsule component of the actor with USQEX_BonamikSceneSubsystem as a temporary
+// collision shape while it plays, and moves the shapes with their components.
 UCLASS(Blueprintable)
 class ASQEX_Bonamik_TemporaryCollisionActor : public AActor {
     GENERATED_BODY()
 public:
     ASQEX_Bonamik_TemporaryCollisionActor(const FObjectInitializer& ObjectInitializer);
 
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void Tick(float DeltaSeconds) override;
+
+private:
+    struct FRegisteredShape {
+        TWeakObjectPtr<UShapeComponent> Component;
+        int32 ShapeHandle;
+    };
+
+    TArray<FRegisteredShape> RegisteredShapes;
 };
 
@@ -0,0 +1,1018 @@
+#include "KineDriverExpr.h"
+#include "SQEX_KineDriverEffectorExpr.h"
+
+namespace KineDriverExpr {
+    static const int32 MaxInputs = 1024;
+    static const int32 MaxOutputs = 64;
+    static const int32 MaxRegisters = 65535;
+
+    static bool IsIdentifierChar(TCHAR Char) {
+        return FChar::IsAlnum(Char) || Char == TEXT('_');
+    }
+
+    // Digits after Prefix, e.g. 12 for "in12". INDEX_NONE when Name is not Prefix followed by digits only.
+    static int32 GetSuffixIndex(const FString& Name, const TCHAR* Prefix) {
+        const int32 PrefixLength = FCString::Strlen(Prefix);
+        if (Name.Len() <= PrefixLength || !Name.StartsWith(Prefix, ESearchCase::CaseSensitive)) {
+            return INDEX_NONE;
+        }
+
+        int32 Index = 0;
+        for (int32 Char = PrefixLength; Char < Name.Len(); ++Char) {
+            if (!FChar::IsDigit(Name[Char]) || Index > MaxInputs) {
+                return INDEX_NONE;
+            }
+            Index = Index * 10 + (Name[Char] - TEXT('0'));
+        }
+        return Index;
+    }
+
+    struct FFunction {
+        const TCHAR* Name;
+        EKineDriverExprOp Op;
+    };
+
+    static const FFunction Functions[] = {
+        { TEXT("sin"), EKineDriverExprOp::Sin },
+        { TEXT("cos"), EKineDriverExprOp::Cos },
+        { TEXT("tan"), EKineDriverExprOp::Tan },
+        { TEXT("asin"), EKineDriverExprOp::Asin },
+        { TEXT("acos"), EKineDriverExprOp::Acos },
+        { TEXT("atan"), EKineDriverExprOp::Atan },
+        { TEXT("atan2"), EKineDriverExprOp::Atan2 },
+        { TEXT("sqrt"), EKineDriverExprOp::Sqrt },
+        { TEXT("abs"), EKineDriverExprOp::Abs },
+        { TEXT("sign"), EKineDriverExprOp::Sign },
+        { TEXT("floor"), EKineDriverExprOp::Floor },
+        { TEXT("ceil"), EKineDriverExprOp::Ceil },
+        { TEXT("exp"), EKineDriverExprOp::Exp },
+        { TEXT("log"), EKineDriverExprOp::Log },
+        { TEXT("pow"), EKineDriverExprOp::Pow },
+        { TEXT("min"), EKineDriverExprOp::Min },
+        { TEXT("max"), EKineDriverExprOp::Max },
+        { TEXT("clamp"), EKineDriverExprOp::Clamp },
+        { TEXT("lerp"), EKineDriverExprOp::Lerp },
+        { TEXT("smoothstep"), EKineDriverExprOp::SmoothStep },
+    };
+}
+
+// Recursive descent over FSQEX_KineDriverEffectorExpr::Code, one precedence level per function.
+class FKineDriverExprParser {
+public:
+    FKineDriverExprParser(const FSQEX_KineDriverEffectorExpr& Expr, FKineDriverExprSyntax& InSyntax)
+        : Start(*Expr.Code), Cursor(*Expr.Code), Vectors(Expr.Inputs), Syntax(InSyntax) {
+    }
+
+    bool Run(FString* OutError) {
+        Syntax.Nodes.Reset();
+        Syntax.Outputs.Reset();
+        Syntax.NumInputs = 0;
+
+        bool bOk = true;
+        for (;;) {
+            SkipWhitespace();
+            if (*Cursor == TEXT('\0')) {
+                break;
+            }
+            if (*Cursor == TEXT(';')) {
+                ++Cursor;
+                continue;
+            }
+            if (!ParseStatement()) {
+                bOk = false;
+                break;
+            }
+
+            SkipWhitespace();
+            if (*Cursor != TEXT('\0') && !Match(TEXT(";"))) {
+                bOk = Fail(TEXT("expected ';'"));
+                break;
+            }
+        }
+
+        if (!bOk) {
+            Syntax.Nodes.Reset();
+            Syntax.Outputs.Reset();
+            Syntax.NumInputs = 0;
+            if (OutError != NULL) {
+                *OutError = Error;
+            }
+        }
+        return bOk;
+    }
+
+private:
+    bool Fail(const TCHAR* Message) {
+        if (Error.IsEmpty()) {
+            Error = FString::Printf(TEXT("column %d: %s"), (int32)(Cursor - Start) + 1, Message);
+        }
+        return false;
+    }
+
+    void SkipWhitespace() {
+        while (FChar::IsWhitespace(*Cursor)) {
+            ++Cursor;
+        }
+    }
+
+    bool Match(const TCHAR* Token) {
+        SkipWhitespace();
+        const int32 Length = FCString::Strlen(Token);
+        if (FCString::Strncmp(Cursor, Token, Length) != 0) {
+            return false;
+        }
+        Cursor += Length;
+        return true;
+    }
+
+    // '=' that is not part of '=='.
+    bool MatchAssign() {
+        SkipWhitespace();
+        if (Cursor[0] != TEXT('=') || Cursor[1] == TEXT('=')) {
+            return false;
+        }
+        ++Cursor;
+        return true;
+    }
+
+    bool ParseIdentifier(FString& OutName) {
+        SkipWhitespace();
+        const TCHAR* Begin = Cursor;
+        if (!FChar::IsAlpha(*Cursor) && *Cursor != TEXT('_')) {
+            return false;
+        }
+        while (KineDriverExpr::IsIdentifierChar(*Cursor)) {
+            ++Cursor;
+        }
+        OutName = FString((int32)(Cursor - Begin), Begin);
+        return true;
+    }
+
+    int32 AddNode(EKineDriverExprOp Op, int32 A = INDEX_NONE, int32 B = INDEX_NONE, int32 C = INDEX_NONE) {
+        FKineDriverExprSyntax::FNode& Node = Syntax.Nodes.AddDefaulted_GetRef();
+        Node.Op = Op;
+        Node.Operands[0] = A;
+        Node.Operands[1] = B;
+        Node.Operands[2] = C;
+        Node.Value = 0.0f;
+        Node.Input = INDEX_NONE;
+        return Syntax.Nodes.Num() - 1;
+    }
+
+    int32 AddConstant(float Value) {
+        const int32 Node = AddNode(EKineDriverExprOp::Constant);
+        Syntax.Nodes[Node].Value = Value;
+        return Node;
+    }
+
+    bool ParseStatement() {
+        const TCHAR* StatementStart = Cursor;
+
+        if (Match(TEXT("$"))) {
+            FString Name;
+            if (!ParseIdentifier(Name)) {
+                return Fail(TEXT("expected a local name after '$'"));
+            }
+            if (MatchAssign()) {
+                const int32 Value = ParseExpression();
+                if (Value == INDEX_NONE) {
+                    return false;
+                }
+                Locals.Add(Name, Value);
+                return true;
+            }
+        } else {
+            FString Name;
+            if (ParseIdentifier(Name)) {
+                const int32 Output = KineDriverExpr::GetSuffixIndex(Name, TEXT("out"));
+                if (Output != INDEX_NONE && MatchAssign()) {
+                    return ParseOutput(Output);
+                }
+            }
+        }
+
+        Cursor = StatementStart;
+        return ParseOutput(0);
+    }
+
+    bool ParseOutput(int32 Output) {
+        if (Output >= KineDriverExpr::MaxOutputs) {
+            return Fail(TEXT("output index out of range"));
+        }
+
+        const int32 Value = ParseExpression();
+        if (Value == INDEX_NONE) {
+            return false;
+        }
+        while (Syntax.Outputs.Num() <= Output) {
+            Syntax.Outputs.Add(INDEX_NONE);
+        }
+        Syntax.Outputs[Output] = Value;
+        return true;
+    }
+
+    int32 ParseExpression() {
+        return ParseTernary();
+    }
+
+    int32 ParseTernary() {
+        const int32 Condition = ParseOr();
+        if (Condition == INDEX_NONE || !Match(TEXT("?"))) {
+            return Condition;
+        }
+
+        const int32 IfTrue = ParseExpression();
+        if (IfTrue == INDEX_NONE) {
+            return INDEX_NONE;
+        }
+        if (!Match(TEXT(":"))) {
+            Fail(TEXT("expected ':'"));
+            return INDEX_NONE;
+        }
+        const int32 IfFalse = ParseTernary();
+        return IfFalse != INDEX_NONE ? AddNode(EKineDriverExprOp::Select, Condition, IfTrue, IfFalse) : INDEX_NONE;
+    }
+
+    int32 ParseOr() {
+        int32 Left = ParseAnd();
+        while (Left != INDEX_NONE && Match(TEXT("||"))) {
+            const int32 Right = ParseAnd();
+            Left = Right != INDEX_NONE ? AddNode(EKineDriverExprOp::Or, Left, Right) : INDEX_NONE;
+        }
+        return Left;
+    }
+
+    int32 ParseAnd() {
+        int32 Left = ParseEquality();
+        while (Left != INDEX_NONE && Match(TEXT("&&"))) {
+            const int32 Right = ParseEquality();
+            Left = Right != INDEX_NONE ? AddNode(EKineDriverExprOp::And, Left, Right) : INDEX_NONE;
+        }
+        return Left;
+    }
+
+    int32 ParseEquality() {
+        int32 Left = ParseRelational();
+        while (Left != INDEX_NONE) {
+            EKineDriverExprOp Op;
+            if (Match(TEXT("=="))) {
+                Op = EKineDriverExprOp::Equal;
+            } else if (Match(TEXT("!="))) {
+                Op = EKineDriverExprOp::NotEqual;
+            } else {
+                break;
+            }
+            const int32 Right = ParseRelational();
+            Left = Right != INDEX_NONE ? AddNode(Op, Left, Right) : INDEX_NONE;
+        }
+        return Left;
+    }
+
+    int32 ParseRelational() {
+        int32 Left = ParseAdditive();
+        while (Left != INDEX_NONE) {
+            EKineDriverExprOp Op;
+            if (Match(TEXT("<="))) {
+                Op = EKineDriverExprOp::LessEqual;
+            } else if (Match(TEXT(">="))) {
+                Op = EKineDriverExprOp::GreaterEqual;
+            } else if (Match(TEXT("<"))) {
+                Op = EKineDriverExprOp::Less;
+            } else if (Match(TEXT(">"))) {
+                Op = EKineDriverExprOp::Greater;
+            } else {
+                break;
+            }
+            const int32 Right = ParseAdditive();
+            Left = Right != INDEX_NONE ? AddNode(Op, Left, Right) : INDEX_NONE;
+        }
+        return Left;
+    }
+
+    int32 ParseAdditive() {
+        int32 Left = ParseTerm();
+        while (Left != INDEX_NONE) {
+            EKineDriverExprOp Op;
+            if (Match(TEXT("+"))) {
+                Op = EKineDriverExprOp::Add;
+            } else if (Match(TEXT("-"))) {
+                Op = EKineDriverExprOp::Sub;
+            } else {
+                break;
+            }
+            const int32 Right = ParseTerm();
+            Left = Right != INDEX_NONE ? AddNode(Op, Left, Right) : INDEX_NONE;
+        }
+        return Left;
+    }
+
+    int32 ParseTerm() {
+        int32 Left = ParseUnary();
+        while (Left != INDEX_NONE) {
+            EKineDriverExprOp Op;
+            if (Match(TEXT("*"))) {
+                Op = EKineDriverExprOp::Mul;
+            } else if (Match(TEXT("/"))) {
+                Op = EKineDriverExprOp::Div;
+            } else if (Match(TEXT("%"))) {
+                Op = EKineDriverExprOp::Mod;
+            } else {
+                break;
+            }
+            const int32 Right = ParseUnary();
+            Left = Right != INDEX_NONE ? AddNode(Op, Left, Right) : INDEX_NONE;
+        }
+        return Left;
+    }
+
+    int32 ParseUnary() {
+        if (Match(TEXT("-"))) {
+            const int32 Operand = ParseUnary();
+            return Operand != INDEX_NONE ? AddNode(EKineDriverExprOp::Neg, Operand) : INDEX_NONE;
+        }
+        if (Match(TEXT("+"))) {
+            return ParseUnary();
+        }
+        // '!' but not '!='.
+        SkipWhitespace();
+        if (Cursor[0] == TEXT('!') && Cursor[1] != TEXT('=')) {
+            ++Cursor;
+            const int32 Operand = ParseUnary();
+            return Operand != INDEX_NONE ? AddNode(EKineDriverExprOp::Not, Operand) : INDEX_NONE;
+        }
+        return ParsePower();
+    }
+
+    int32 ParsePower() {
+        const int32 Base = ParsePrimary();
+        if (Base == INDEX_NONE || !Match(TEXT("^"))) {
+            return Base;
+        }
+        const int32 Exponent = ParseUnary();
+        return Exponent != INDEX_NONE ? AddNode(EKineDriverExprOp::Pow, Base, Exponent) : INDEX_NONE;
+    }
+
+    int32 ParseNumber() {
+        const TCHAR* Begin = Cursor;
+        while (FChar::IsDigit(*Cursor) || *Cursor == TEXT('.')) {
+            ++Cursor;
+        }
+        if ((*Cursor == TEXT('e') || *Cursor == TEXT('E')) && (FChar::IsDigit(Cursor[1]) || ((Cursor[1] == TEXT('+') || Cursor[1] == TEXT('-')) && FChar::IsDigit(Cursor[2])))) {
+            Cursor += 2;
+            while (FChar::IsDigit(*Cursor)) {
+                ++Cursor;
+            }
+        }
+        const float Value = FCString::Atof(*FString((int32)(Cursor - Begin), Begin));
+        // C style float suffix.
+        if (*Cursor == TEXT('f') && !KineDriverExpr::IsIdentifierChar(Cursor[1])) {
+            ++Cursor;
+        }
+        return AddConstant(Value);
+    }
+
+    int32 ParsePrimary() {
+        SkipWhitespace();
+        if (FChar::IsDigit(*Cursor) || (*Cursor == TEXT('.') && FChar::IsDigit(Cursor[1]))) {
+            return ParseNumber();
+        }
+
+        if (Match(TEXT("("))) {
+            const int32 Value = ParseExpression();
+            if (Value != INDEX_NONE && !Match(TEXT(")"))) {
+                Fail(TEXT("expected ')'"));
+                return INDEX_NONE;
+            }
+            return Value;
+        }
+
+        if (Match(TEXT("$"))) {
+            FString Name;
+            if (!ParseIdentifier(Name)) {
+                Fail(TEXT("expected a local name after '$'"));
+                return INDEX_NONE;
+            }
+            const int32* Value = Locals.Find(Name);
+            if (Value == NULL) {
+                Fail(TEXT("local read before it is assigned"));
+                return INDEX_NONE;
+            }
+            return *Value;
+        }
+
+        FString Name;
+        if (!ParseIdentifier(Name)) {
+            Fail(TEXT("expected a value"));
+            return INDEX_NONE;
+        }
+
+        if (Name == TEXT("pi")) {
+            return AddConstant(PI);
+        }
+
+        const int32 Input = KineDriverExpr::GetSuffixIndex(Name, TEXT("in"));
+        if (Input != INDEX_NONE) {
+            if (Input >= KineDriverExpr::MaxInputs) {
+                Fail(TEXT("input index out of range"));
+                return INDEX_NONE;
+            }
+            const int32 Node = AddNode(EKineDriverExprOp::Input);
+            Syntax.Nodes[Node].Input = Input;
+            Syntax.NumInputs = FMath::Max(Syntax.NumInputs, Input + 1);
+            return Node;
+        }
+
+        const int32 Output = KineDriverExpr::GetSuffixIndex(Name, TEXT("out"));
+        if (Output != INDEX_NONE) {
+            if (!Syntax.Outputs.IsValidIndex(Output) || Syntax.Outputs[Output] == INDEX_NONE) {
+                Fail(TEXT("output read before it is assigned"));
+                return INDEX_NONE;
+            }
+            return Syntax.Outputs[Output];
+        }
+
+        const int32 Vector = KineDriverExpr::GetSuffixIndex(Name, TEXT("k"));
+        if (Vector != INDEX_NONE) {
+            if (!Vectors.IsValidIndex(Vector)) {
+                Fail(TEXT("no such entry in Inputs"));
+                return INDEX_NONE;
+            }
+            int32 Component = 0;
+            if (*Cursor == TEXT('.')) {
+                static const TCHAR Components[] = TEXT("xyzw");
+                const TCHAR* Found = FCString::Strchr(Components, Cursor[1]);
+                if (Cursor[1] == TEXT('\0') || Found == NULL || KineDriverExpr::IsIdentifierChar(Cursor[2])) {
+                    Fail(TEXT("expected .x, .y, .z or .w"));
+                    return INDEX_NONE;
+                }
+                Component = (int32)(Found - Components);
+                Cursor += 2;
+            }
+            return AddConstant(Vectors[Vector][Component]);
+        }
+
+        if (!Match(TEXT("("))) {
+            Fail(TEXT("unknown name"));
+            return INDEX_NONE;
+        }
+
+        TArray<int32, TInlineAllocator<3>> Arguments;
+        if (!Match(TEXT(")"))) {
+            do {
+                const int32 Argument = ParseExpression();
+                if (Argument == INDEX_NONE) {
+                    return INDEX_NONE;
+                }
+                Arguments.Add(Argument);
+            } while (Match(TEXT(",")));
+            if (!Match(TEXT(")"))) {
+                Fail(TEXT("expected ')'"));
+                return INDEX_NONE;
+            }
+        }
+
+        // Angle conversions are plain multiplies so they fold into their neighbours.
+        if (Name == TEXT("rad") || Name == TEXT("deg")) {
+            if (Arguments.Num() != 1) {
+                Fail(TEXT("wrong number of arguments"));
+                return INDEX_NONE;
+            }
+            return AddNode(EKineDriverExprOp::Mul, Arguments[0], AddConstant(Name == TEXT("rad") ? PI / 180.0f : 180.0f / PI));
+        }
+
+        for (const KineDriverExpr::FFunction& Function : KineDriverExpr::Functions) {
+            if (Name == Function.Name) {
+                if (Arguments.Num() != FKineDriverExprSyntax::GetNumOperands(Function.Op)) {
+                    Fail(TEXT("wrong number of arguments"));
+                    return INDEX_NONE;
+                }
+                return AddNode(Function.Op, Arguments[0], Arguments.IsValidIndex(1) ? Arguments[1] : INDEX_NONE, Arguments.IsValidIndex(2) ? Arguments[2] : INDEX_NONE);
+            }
+        }
+
+        Fail(TEXT("unknown function"));
+        return INDEX_NONE;
+    }
+
+    const TCHAR* Start;
+    const TCHAR* Cursor;
+    const TArray<FVector4>& Vectors;
+    FKineDriverExprSyntax& Syntax;
+    TMap<FString, int32> Locals;
+    FString Error;
+};
+
+FKineDriverExprSyntax::FKineDriverExprSyntax() {
+    this->NumInputs = 0;
+}
+
+bool FKineDriverExprSyntax::Parse(const FSQEX_KineDriverEffectorExpr& Expr, FString* OutError) {
+    FKineDriverExprParser Parser(Expr, *this);
+    return Parser.Run(OutError);
+}
+
+int32 FKineDriverExprSyntax::GetNumOperands(EKineDriverExprOp Op) {
+    switch (Op) {
+    case EKineDriverExprOp::Constant:
+    case EKineDriverExprOp::Input:
+        return 0;
+    case EKineDriverExprOp::Neg:
+    case EKineDriverExprOp::Abs:
+    case EKineDriverExprOp::Sign:
+    case EKineDriverExprOp::Floor:
+    case EKineDriverExprOp::Ceil:
+    case EKineDriverExprOp::Sqrt:
+    case EKineDriverExprOp::Exp:
+    case EKineDriverExprOp::Log:
+    case EKineDriverExprOp::Sin:
+    case EKineDriverExprOp::Cos:
+    case EKineDriverExprOp::Tan:
+    case EKineDriverExprOp::Asin:
+    case EKineDriverExprOp::Acos:
+    case EKineDriverExprOp::Atan:
+    case EKineDriverExprOp::Not:
+        return 1;
+    case EKineDriverExprOp::Select:
+    case EKineDriverExprOp::Clamp:
+    case EKineDriverExprOp::Lerp:
+    case EKineDriverExprOp::SmoothStep:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+float FKineDriverExprSyntax::Apply(EKineDriverExprOp Op, float A, float B, float C) {
+    switch (Op) {
+    case EKineDriverExprOp::Add:
+        return A + B;
+    case EKineDriverExprOp::Sub:
+        return A - B;
+    case EKineDriverExprOp::Mul:
+        return A * B;
+    case EKineDriverExprOp::Div:
+        return A / B;
+    case EKineDriverExprOp::Mod:
+        // FMath::Fmod reports tiny divisors; expressions just get 0.
+        return FMath::Abs(B) > 1.e-8f ? FMath::Fmod(A, B) : 0.0f;
+    case EKineDriverExprOp::Pow:
+        return FMath::Pow(A, B);
+    case EKineDriverExprOp::Neg:
+        return -A;
+    case EKineDriverExprOp::Min:
+        return FMath::Min(A, B);
+    case EKineDriverExprOp::Max:
+        return FMath::Max(A, B);
+    case EKineDriverExprOp::Abs:
+        return FMath::Abs(A);
+    case EKineDriverExprOp::Sign:
+        return FMath::Sign(A);
+    case EKineDriverExprOp::Floor:
+        return FMath::FloorToFloat(A);
+    case EKineDriverExprOp::Ceil:
+        return FMath::CeilToFloat(A);
+    case EKineDriverExprOp::Sqrt:
+        return FMath::Sqrt(A);
+    case EKineDriverExprOp::Exp:
+        return FMath::Exp(A);
+    case EKineDriverExprOp::Log:
+        return FMath::Loge(A);
+    case EKineDriverExprOp::Sin:
+        return FMath::Sin(A);
+    case EKineDriverExprOp::Cos:
+        return FMath::Cos(A);
+    case EKineDriverExprOp::Tan:
+        return FMath::Tan(A);
+    case EKineDriverExprOp::Asin:
+        return FMath::Asin(A);
+    case EKineDriverExprOp::Acos:
+        return FMath::Acos(A);
+    case EKineDriverExprOp::Atan:
+        return FMath::Atan(A);
+    case EKineDriverExprOp::Atan2:
+        return FMath::Atan2(A, B);
+    case EKineDriverExprOp::Less:
+        return A < B ? 1.0f : 0.0f;
+    case EKineDriverExprOp::LessEqual:
+        return A <= B ? 1.0f : 0.0f;
+    case EKineDriverExprOp::Greater:
+        return A > B ? 1.0f : 0.0f;
+    case EKineDriverExprOp::GreaterEqual:
+        return A >= B ? 1.0f : 0.0f;
+    case EKineDriverExprOp::Equal:
+        return A == B ? 1.0f : 0.0f;
+    case EKineDriverExprOp::NotEqual:
+        return A != B ? 1.0f : 0.0f;
+    case EKineDriverExprOp::And:
+        return A != 0.0f && B != 0.0f ? 1.0f : 0.0f;
+    case EKineDriverExprOp::Or:
+        return A != 0.0f || B != 0.0f ? 1.0f : 0.0f;
+    case EKineDriverExprOp::Not:
+        return A == 0.0f ? 1.0f : 0.0f;
+    case EKineDriverExprOp::Select:
+        return A != 0.0f ? B : C;
+    case EKineDriverExprOp::Clamp:
+        return FMath::Clamp(A, B, C);
+    case EKineDriverExprOp::Lerp:
+        return FMath::Lerp(A, B, C);
+    case EKineDriverExprOp::SmoothStep:
+        return FMath::SmoothStep(A, B, C);
+    default:
+        return A;
+    }
+}
+
+void FKineDriverExprSyntax::Evaluate(const float* Inputs, float* OutValues) const {
+    TArray<float, TInlineAllocator<256>> Values;
+    Values.SetNumUninitialized(Nodes.Num());
+    for (int32 Index = 0; Index < Nodes.Num(); ++Index) {
+        const FNode& Node = Nodes[Index];
+        if (Node.Op == EKineDriverExprOp::Constant) {
+            Values[Index] = Node.Value;
+        } else if (Node.Op == EKineDriverExprOp::Input) {
+            Values[Index] = Inputs[Node.Input];
+        } else {
+            const int32 NumOperands = GetNumOperands(Node.Op);
+            const float A = Values[Node.Operands[0]];
+            const float B = NumOperands > 1 ? Values[Node.Operands[1]] : 0.0f;
+            const float C = NumOperands > 2 ? Values[Node.Operands[2]] : 0.0f;
+            Values[Index] = Apply(Node.Op, A, B, C);
+        }
+    }
+
+    for (int32 Output = 0; Output < Outputs.Num(); ++Output) {
+        OutValues[Output] = Outputs[Output] != INDEX_NONE ? Values[Outputs[Output]] : 0.0f;
+    }
+}
+
+FKineDriverExprProgram::FKineDriverExprProgram() {
+    this->NumInputs = 0;
+    this->NumRegisters = 0;
+    this->bValid = false;
+}
+
+bool FKineDriverExprProgram::Compile(const FSQEX_KineDriverEffectorExpr& Expr, FString* OutError) {
+    FKineDriverExprSyntax Syntax;
+    if (!Syntax.Parse(Expr, OutError)) {
+        *this = FKineDriverExprProgram();
+        return false;
+    }
+    return Compile(Syntax, OutError);
+}
+
+bool FKineDriverExprProgram::Compile(const FKineDriverExprSyntax& Syntax, FString* OutError) {
+    typedef FKineDriverExprSyntax::FNode FNode;
+
+    *this = FKineDriverExprProgram();
+    const TArray<FNode>& Nodes = Syntax.GetNodes();
+    const int32 NumNodes = Nodes.Num();
+
+    // Fold constants and forward identities. Every node ends up either constant, an alias of an earlier node, or an
+    // instruction over the resolved operands.
+    TArray<bool> IsConstant;
+    TArray<float> Values;
+    TArray<int32> Alias;
+    TArray<FNode> Resolved;
+    IsConstant.SetNumZeroed(NumNodes);
+    Values.SetNumZeroed(NumNodes);
+    Alias.SetNumUninitialized(NumNodes);
+    Resolved.SetNumUninitialized(NumNodes);
+    for (int32 Index = 0; Index < NumNodes; ++Index) {
+        FNode Node = Nodes[Index];
+        const int32 NumOperands = FKineDriverExprSyntax::GetNumOperands(Node.Op);
+        bool bAllConstant = true;
+        for (int32 Operand = 0; Operand < NumOperands; ++Operand) {
+            Node.Operands[Operand] = Alias[Node.Operands[Operand]];
+            bAllConstant &= IsConstant[Node.Operands[Operand]];
+        }
+        Alias[Index] = Index;
+        Resolved[Index] = Node;
+
+        auto IsValue = [&](int32 Operand, float Value) {
+            return IsConstant[Operand] && Values[Operand] == Value;
+        };
+
+        if (Node.Op == EKineDriverExprOp::Constant) {
+            IsConstant[Index] = true;
+            Values[Index] = Node.Value;
+        } else if (Node.Op == EKineDriverExprOp::Input) {
+            continue;
+        } else if (bAllConstant) {
+            const float A = Values[Node.Operands[0]];
+            const float B = NumOperands > 1 ? Values[Node.Operands[1]] : 0.0f;
+            const float C = NumOperands > 2 ? Values[Node.Operands[2]] : 0.0f;
+            IsConstant[Index] = true;
+            Values[Index] = FKineDriverExprSyntax::Apply(Node.Op, A, B, C);
+        } else {
+            const int32 A = Node.Operands[0];
+            const int32 B = Node.Operands[1];
+            switch (Node.Op) {
+            case EKineDriverExprOp::Add:
+                Alias[Index] = IsValue(B, 0.0f) ? A : (IsValue(A, 0.0f) ? B : Index);
+                break;
+            case EKineDriverExprOp::Sub:
+                Alias[Index] = IsValue(B, 0.0f) ? A : Index;
+                break;
+            case EKineDriverExprOp::Mul:
+                Alias[Index] = IsValue(B, 1.0f) ? A : (IsValue(A, 1.0f) ? B : Index);
+                break;
+            case EKineDriverExprOp::Div:
+            case EKineDriverExprOp::Pow:
+                Alias[Index] = IsValue(B, 1.0f) ? A : Index;
+                break;
+            case EKineDriverExprOp::Neg:
+                Alias[Index] = Resolved[A].Op == EKineDriverExprOp::Neg && !IsConstant[A] ? Resolved[A].Operands[0] : Index;
+                break;
+            case EKineDriverExprOp::Select:
+                if (IsConstant[A]) {
+                    Alias[Index] = Values[A] != 0.0f ? B : Node.Operands[2];
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // Keep what the outputs need.
+    TArray<bool> IsLive;
+    IsLive.SetNumZeroed(NumNodes);
+    TArray<int32> OutputNodes;
+    for (int32 Output : Syntax.GetOutputs()) {
+        OutputNodes.Add(Output != INDEX_NONE ? Alias[Output] : INDEX_NONE);
+        if (Output != INDEX_NONE) {
+            IsLive[Alias[Output]] = true;
+        }
+    }
+    for (int32 Index = NumNodes - 1; Index >= 0; --Index) {
+        if (!IsLive[Index] || IsConstant[Index] || Alias[Index] != Index) {
+            continue;
+        }
+        for (int32 Operand = 0; Operand < FKineDriverExprSyntax::GetNumOperands(Resolved[Index].Op); ++Operand) {
+            IsLive[Resolved[Index].Operands[Operand]] = true;
+        }
+    }
+
+    // Inputs, then the live constants, then temporaries.
+    NumInputs = Syntax.GetNumInputs();
+    TArray<int32> Registers;
+    Registers.Init(INDEX_NONE, NumNodes);
+    TMap<uint32, int32> ConstantRegisters;
+    auto GetConstantRegister = [&](float Value) {
+        uint32 Bits;
+        FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+        if (const int32* Register = ConstantRegisters.Find(Bits)) {
+            return *Register;
+        }
+        const int32 Register = NumInputs + Constants.Add(Value);
+        ConstantRegisters.Add(Bits, Register);
+        return Register;
+    };
+    for (int32 Index = 0; Index < NumNodes; ++Index) {
+        if (!IsLive[Index]) {
+            continue;
+        }
+        if (IsConstant[Index]) {
+            Registers[Index] = GetConstantRegister(Values[Index]);
+        } else if (Resolved[Index].Op == EKineDriverExprOp::Input) {
+            Registers[Index] = Resolved[Index].Input;
+        }
+    }
+    const bool bHasUnassignedOutput = OutputNodes.Contains(INDEX_NONE);
+    const int32 ZeroRegister = bHasUnassignedOutput ? GetConstantRegister(0.0f) : INDEX_NONE;
+
+    // A temporary is freed after its last reader; outputs stay live to the end.
+    TArray<int32> LastUse;
+    LastUse.Init(INDEX_NONE, NumNodes);
+    for (int32 Index = 0; Index < NumNodes; ++Index) {
+        if (!IsLive[Index] || IsConstant[Index] || Alias[Index] != Index) {
+            continue;
+        }
+        for (int32 Operand = 0; Operand < FKineDriverExprSyntax::GetNumOperands(Resolved[Index].Op); ++Operand) {
+            LastUse[Resolved[Index].Operands[Operand]] = Index;
+        }
+    }
+    for (int32 Node : OutputNodes) {
+        if (Node != INDEX_NONE) {
+            LastUse[Node] = MAX_int32;
+        }
+    }
+
+    TArray<int32> FreeRegisters;
+    int32 NextRegister = NumInputs + Constants.Num();
+    for (int32 Index = 0; Index < NumNodes; ++Index) {
+        const FNode& Node = Resolved[Index];
+        if (!IsLive[Index] || IsConstant[Index] || Alias[Index] != Index || Node.Op == EKineDriverExprOp::Input) {
+            continue;
+        }
+
+        FInstruction& Instruction = Instructions.AddDefaulted_GetRef();
+        Instruction.Op = Node.Op;
+        const int32 NumOperands = FKineDriverExprSyntax::GetNumOperands(Node.Op);
+        for (int32 Operand = 0; Operand < 3; ++Operand) {
+            Instruction.Operands[Operand] = Operand < NumOperands ? (uint16)Registers[Node.Operands[Operand]] : 0;
+        }
+
+        // Operands read for the last time give their register back before the result takes one, so it may be reused
+        // in place.
+        for (int32 Operand = 0; Operand < NumOperands; ++Operand) {
+            const int32 Source = Node.Operands[Operand];
+            const bool bTemporary = !IsConstant[Source] && Resolved[Source].Op != EKineDriverExprOp::Input;
+            if (bTemporary && LastUse[Source] == Index && !FreeRegisters.Contains(Registers[Source])) {
+                FreeRegisters.Add(Registers[Source]);
+            }
+        }
+
+        Registers[Index] = FreeRegisters.Num() > 0 ? FreeRegisters.Pop(false) : NextRegister++;
+        Instruction.Dst = (uint16)FMath::Min(Registers[Index], KineDriverExpr::MaxRegisters);
+    }
+
+    if (NextRegister > KineDriverExpr::MaxRegisters) {
+        if (OutError != NULL) {
+            *OutError = TEXT("expression needs too many registers");
+        }
+        *this = FKineDriverExprProgram();
+        return false;
+    }
+
+    for (int32 Node : OutputNodes) {
+        OutputRegisters.Add((uint16)(Node != INDEX_NONE ? Registers[Node] : ZeroRegister));
+    }
+    NumRegisters = FMath::Max(NextRegister, 1);
+    bValid = true;
+    return true;
+}
+
+void FKineDriverExprProgram::Evaluate(const float* Inputs, float* Outputs) const {
+    if (!bValid) {
+        return;
+    }
+
+    TArray<float, TInlineAllocator<256>> RegisterFile;
+    RegisterFile.SetNumUninitialized(NumRegisters);
+    float* Registers = RegisterFile.GetData();
+    if (NumInputs > 0) {
+        FMemory::Memcpy(Registers, Inputs, NumInputs * sizeof(float));
+    }
+    if (Constants.Num() > 0) {
+        FMemory::Memcpy(Registers + NumInputs, Constants.GetData(), Constants.Num() * sizeof(float));
+    }
+
+    for (const FInstruction& Instruction : Instructions) {
+        const float A = Registers[Instruction.Operands[0]];
+        const float B = Registers[Instruction.Operands[1]];
+        float& Dst = Registers[Instruction.Dst];
+        switch (Instruction.Op) {
+        case EKineDriverExprOp::Add:
+            Dst = A + B;
+            break;
+        case EKineDriverExprOp::Sub:
+            Dst = A - B;
+            break;
+        case EKineDriverExprOp::Mul:
+            Dst = A * B;
+            break;
+        case EKineDriverExprOp::Div:
+            Dst = A / B;
+            break;
+        case EKineDriverExprOp::Select:
+            Dst = A != 0.0f ? B : Registers[Instruction.Operands[2]];
+            break;
+        default:
+            Dst = FKineDriverExprSyntax::Apply(Instruction.Op, A, B, Registers[Instruction.Operands[2]]);
+            break;
+        }
+    }
+
+    for (int32 Output = 0; Output < OutputRegisters.Num(); ++Output) {
+        Outputs[Output] = Registers[OutputRegisters[Output]];
+    }
+}
+
+void FKineDriverExprProgram::EvaluateWide(const float* Inputs, float* Outputs) const {
+    if (!bValid) {
+        return;
+    }
+
+    TArray<VectorRegister, TInlineAllocator<128>> RegisterFile;
+    RegisterFile.SetNumUninitialized(NumRegisters);
+    VectorRegister* Registers = RegisterFile.GetData();
+    for (int32 Input = 0; Input < NumInputs; ++Input) {
+        Registers[Input] = VectorLoad(Inputs + Input * Lanes);
+    }
+    for (int32 Constant = 0; Constant < Constants.Num(); ++Constant) {
+        Registers[NumInputs + Constant] = VectorSetFloat1(Constants[Constant]);
+    }
+
+    const VectorRegister Zero = VectorZero();
+    const VectorRegister One = VectorOne();
+    for (const FInstruction& Instruction : Instructions) {
+        const VectorRegister A = Registers[Instruction.Operands[0]];
+        const VectorRegister B = Registers[Instruction.Operands[1]];
+        VectorRegister& Dst = Registers[Instruction.Dst];
+        switch (Instruction.Op) {
+        case EKineDriverExprOp::Add:
+            Dst = VectorAdd(A, B);
+            break;
+        case EKineDriverExprOp::Sub:
+            Dst = VectorSubtract(A, B);
+            break;
+        case EKineDriverExprOp::Mul:
+            Dst = VectorMultiply(A, B);
+            break;
+        case EKineDriverExprOp::Div:
+            Dst = VectorDivide(A, B);
+            break;
+        case EKineDriverExprOp::Min:
+            Dst = VectorMin(A, B);
+            break;
+        case EKineDriverExprOp::Max:
+            Dst = VectorMax(A, B);
+            break;
+        case EKineDriverExprOp::Abs:
+            Dst = VectorAbs(A);
+            break;
+        case EKineDriverExprOp::Neg:
+            Dst = VectorNegate(A);
+            break;
+        case EKineDriverExprOp::Less:
+            Dst = VectorBitwiseAnd(VectorCompareLT(A, B), One);
+            break;
+        case EKineDriverExprOp::LessEqual:
+            Dst = VectorBitwiseAnd(VectorCompareLE(A, B), One);
+            break;
+        case EKineDriverExprOp::Greater:
+            Dst = VectorBitwiseAnd(VectorCompareGT(A, B), One);
+            break;
+        case EKineDriverExprOp::GreaterEqual:
+            Dst = VectorBitwiseAnd(VectorCompareGE(A, B), One);
+            break;
+        case EKineDriverExprOp::Equal:
+            Dst = VectorBitwiseAnd(VectorCompareEQ(A, B), One);
+            break;
+        case EKineDriverExprOp::NotEqual:
+            Dst = VectorBitwiseAnd(VectorCompareNE(A, B), One);
+            break;
+        case EKineDriverExprOp::And:
+            Dst = VectorBitwiseAnd(VectorBitwiseAnd(VectorCompareNE(A, Zero), VectorCompareNE(B, Zero)), One);
+            break;
+        case EKineDriverExprOp::Or:
+            Dst = VectorBitwiseAnd(VectorBitwiseOr(VectorCompareNE(A, Zero), VectorCompareNE(B, Zero)), One);
+            break;
+        case EKineDriverExprOp::Not:
+            Dst = VectorBitwiseAnd(VectorCompareEQ(A, Zero), One);
+            break;
+        case EKineDriverExprOp::Select:
+            Dst = VectorSelect(VectorCompareNE(A, Zero), B, Registers[Instruction.Operands[2]]);
+            break;
+        default: {
+            // Transcendentals and the rest go through the scalar definition lane by lane.
+            MS_ALIGN(16) float LaneA[Lanes] GCC_ALIGN(16);
+            MS_ALIGN(16) float LaneB[Lanes] GCC_ALIGN(16);
+            MS_ALIGN(16) float LaneC[Lanes] GCC_ALIGN(16);
+            VectorStoreAligned(A, LaneA);
+            VectorStoreAligned(B, LaneB);
+            VectorStoreAligned(Registers[Instruction.Operands[2]], LaneC);
+            for (int32 Lane = 0; Lane < Lanes; ++Lane) {
+                LaneA[Lane] = FKineDriverExprSyntax::Apply(Instruction.Op, LaneA[Lane], LaneB[Lane], LaneC[Lane]);
+            }
+            Dst = VectorLoadAligned(LaneA);
+            break;
+        }
+        }
+    }
+
+    for (int32 Output = 0; Output < OutputRegisters.Num(); ++Output) {
+        VectorStore(Registers[OutputRegisters[Output]], Outputs + Output * Lanes);
+    }
+}
+
+void FKineDriverExprProgram::EvaluateBatch(int32 NumInstances, const float* Inputs, float* Outputs) const {
+    if (!bValid) {
+        return;
+    }
+
+    const int32 NumOutputs = OutputRegisters.Num();
+    TArray<float, TInlineAllocator<256>> WideInputs;
+    TArray<float, TInlineAllocator<64>> WideOutputs;
+    WideInputs.SetNumUninitialized(NumInputs * Lanes);
+    WideOutputs.SetNumUninitialized(NumOutputs * Lanes);
+
+    // The last group repeats its last instance in the unused lanes.
+    for (int32 First = 0; First < NumInstances; First += Lanes) {
+        for (int32 Input = 0; Input < NumInputs; ++Input) {
+            for (int32 Lane = 0; Lane < Lanes; ++Lane) {
+                WideInputs[Input * Lanes + Lane] = Inputs[Input * NumInstances + FMath::Min(First + Lane, NumInstances - 1)];
+            }
+        }
+
+        EvaluateWide(WideInputs.GetData(), WideOutputs.GetData());
+
+        const int32 NumLanes = FMath::Min(Lanes, NumInstances - First);
+        for (int32 Output = 0; Output < NumOutputs; ++Output) {
+            for (int32 Lane = 0; Lane < NumLanes; ++Lane) {
+                Outputs[Output * NumInstances + First + Lane] = WideOutputs[Output * Lanes + Lane];
+            }
+        }
+    }
+}
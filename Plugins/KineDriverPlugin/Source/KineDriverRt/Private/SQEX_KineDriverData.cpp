@@ -1,7 +1,122 @@
 #include "SQEX_KineDriverData.h"
+#include "KineDriverExpr.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogKineDriverExpr, Log, All);
 
 USQEX_KineDriverData::USQEX_KineDriverData() {
     this->WorkNum = 0;
 }
 
+namespace KineDriverExpr {
+    static bool IsSameValue(float A, float B) {
+        return A == B || (FMath::IsNaN(A) && FMath::IsNaN(B));
+    }
+
+    // Compiles the expression effectors of the loaded KineDriver data, warns about Code the grammar of KineDriverExpr.h does
+    // not accept, and checks the compiled programs against the reference evaluation of their syntax with random inputs and
+    // the usual special values, on both the scalar and the batched path. Nothing evaluates effectors with these programs.
+    static void Verify(const TArray<FString>& Args) {
+        const int32 NumSamples = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 256, 1);
+        static const float SpecialValues[] = { 0.0f, 1.0f, -1.0f };
+        static const int32 MaxReportedMismatches = 8;
+
+        FRandomStream Random(0x4B44);
+        int32 NumExpressions = 0;
+        int32 NumInvalid = 0;
+        int32 NumMismatches = 0;
+        int64 NumEvaluations = 0;
+        int32 NumNodes = 0;
+        int32 NumInstructions = 0;
+        double ReferenceSeconds = 0.0;
+        double ProgramSeconds = 0.0;
+        double BatchSeconds = 0.0;
+        for (TObjectIterator<USQEX_KineDriverData> It; It; ++It) {
+            const USQEX_KineDriverData* Data = *It;
+            for (int32 Index = 0; Index < Data->GetNumEffectorExprs(); ++Index) {
+                ++NumExpressions;
+                const FSQEX_KineDriverEffectorExpr& Expr = Data->GetEffectorExpr(Index);
+                FKineDriverExprSyntax Syntax;
+                FKineDriverExprProgram Program;
+                FString Error;
+                if (!Syntax.Parse(Expr, &Error) || !Program.Compile(Syntax, &Error)) {
+                    UE_LOG(LogKineDriverExpr, Warning, TEXT("%s: expression %d does not compile (%s): %s"), *Data->GetPathName(), Index, *Error, *Expr.Code);
+                    ++NumInvalid;
+                    continue;
+                }
+                NumNodes += Syntax.GetNodes().Num();
+                NumInstructions += Program.GetNumInstructions();
+
+                // SoA, Inputs[Input * NumSamples + Sample].
+                const int32 NumInputs = Syntax.GetNumInputs();
+                const int32 NumOutputs = Syntax.GetNumOutputs();
+                TArray<float> Inputs;
+                Inputs.SetNumUninitialized(NumInputs * NumSamples);
+                for (int32 Value = 0; Value < Inputs.Num(); ++Value) {
+                    const int32 Choice = Random.RandHelper(8);
+                    Inputs[Value] = Choice < (int32)UE_ARRAY_COUNT(SpecialValues) ? SpecialValues[Choice] : Random.FRandRange(-10.0f, 10.0f);
+                }
+
+                TArray<float> SampleInputs;
+                TArray<float> Reference;
+                TArray<float> Scalar;
+                TArray<float> Batch;
+                SampleInputs.SetNumUninitialized(FMath::Max(NumInputs, 1));
+                Reference.SetNumUninitialized(NumOutputs * NumSamples);
+                Scalar.SetNumUninitialized(NumOutputs * NumSamples);
+                Batch.SetNumUninitialized(NumOutputs * NumSamples);
+                TArray<float> SampleOutputs;
+                SampleOutputs.SetNumUninitialized(FMath::Max(NumOutputs, 1));
+
+                for (int32 Sample = 0; Sample < NumSamples; ++Sample) {
+                    for (int32 Input = 0; Input < NumInputs; ++Input) {
+                        SampleInputs[Input] = Inputs[Input * NumSamples + Sample];
+                    }
+
+                    double StartTime = FPlatformTime::Seconds();
+                    Syntax.Evaluate(SampleInputs.GetData(), SampleOutputs.GetData());
+                    ReferenceSeconds += FPlatformTime::Seconds() - StartTime;
+                    for (int32 Output = 0; Output < NumOutputs; ++Output) {
+                        Reference[Output * NumSamples + Sample] = SampleOutputs[Output];
+                    }
+
+                    StartTime = FPlatformTime::Seconds();
+                    Program.Evaluate(SampleInputs.GetData(), SampleOutputs.GetData());
+                    ProgramSeconds += FPlatformTime::Seconds() - StartTime;
+                    for (int32 Output = 0; Output < NumOutputs; ++Output) {
+                        Scalar[Output * NumSamples + Sample] = SampleOutputs[Output];
+                    }
+                }
+
+                const double StartTime = FPlatformTime::Seconds();
+                Program.EvaluateBatch(NumSamples, Inputs.GetData(), Batch.GetData());
+                BatchSeconds += FPlatformTime::Seconds() - StartTime;
+                NumEvaluations += NumSamples;
+
+                for (int32 Value = 0; Value < Reference.Num(); ++Value) {
+                    if (IsSameValue(Reference[Value], Scalar[Value]) && IsSameValue(Reference[Value], Batch[Value])) {
+                        continue;
+                    }
+                    if (NumMismatches++ < MaxReportedMismatches) {
+                        UE_LOG(LogKineDriverExpr, Warning, TEXT("%s expression %d, out%d sample %d: reference %g, program %g, batch %g: %s"),
+                            *Data->GetPathName(), Index, Value / NumSamples, Value % NumSamples, Reference[Value], Scalar[Value], Batch[Value],
+                            *Data->GetEffectorExpr(Index).Code);
+                    }
+                }
+            }
+        }
+
+        const double MicrosecondsPerEvaluation = NumEvaluations > 0 ? 1000000.0 / NumEvaluations : 0.0;
+        UE_LOG(LogKineDriverExpr, Display, TEXT("%d expressions (%d invalid), %lld evaluations, %d mismatches. %d nodes compiled to %d instructions. Reference %.3f us, program %.3f us, batch %.3f us per evaluation"),
+            NumExpressions, NumInvalid, NumEvaluations, NumMismatches, NumNodes, NumInstructions,
+            ReferenceSeconds * MicrosecondsPerEvaluation, ProgramSeconds * MicrosecondsPerEvaluation, BatchSeconds * MicrosecondsPerEvaluation);
+    }
+}
 
+static FAutoConsoleCommand CmdKineDriverExprVerify(
+    TEXT("kinedriver.Expr.Verify"),
+    TEXT("Compares the compiled KineDriver expressions of every loaded asset with their reference evaluation. Usage: kinedriver.Expr.Verify [NumSamples]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&KineDriverExpr::Verify));
@@ -0,0 +1,134 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "KineDriverExpr.h"
+#include "SQEX_KineDriverEffectorExpr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace KineDriverExprTest {
+    static FSQEX_KineDriverEffectorExpr MakeExpr(const TCHAR* Code) {
+        FSQEX_KineDriverEffectorExpr Expr;
+        Expr.Inputs.Add(FVector4(0.50f, 0.25f, 2.00f, -1.00f));
+        Expr.Code = Code;
+        return Expr;
+    }
+
+    static bool IsSameValue(float A, float B) {
+        return A == B || (FMath::IsNaN(A) && FMath::IsNaN(B));
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FKineDriverExprGrammarTest, "KineDriver.Expr.Grammar",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FKineDriverExprGrammarTest::RunTest(const FString& Parameters) {
+    using namespace KineDriverExprTest;
+
+    // The example of KineDriverExpr.h: in0 = 1 gives $blend = clamp(0.5 + 0.25) = 0.75, in3 = 90 degrees gives sin = 1.
+    {
+        FKineDriverExprProgram Program;
+        FString Error;
+        TestTrue(TEXT("Header example compiles"), Program.Compile(MakeExpr(
+            TEXT("$blend = clamp(in0 * k0.x + k0.y, 0, 1);\n")
+            TEXT("out0 = lerp(in1, in2, $blend);\n")
+            TEXT("out1 = in3 > 0 ? sin(rad(in3)) : 0")), &Error));
+        TestEqual(TEXT("Header example inputs"), Program.GetNumInputs(), 4);
+        TestEqual(TEXT("Header example outputs"), Program.GetNumOutputs(), 2);
+
+        const float Inputs[] = { 1.00f, 10.00f, 20.00f, 90.00f };
+        float Outputs[2] = { 0.00f, 0.00f };
+        Program.Evaluate(Inputs, Outputs);
+        TestEqual(TEXT("out0 = lerp(10, 20, 0.75)"), Outputs[0], 17.50f);
+        TestTrue(TEXT("out1 = sin(90 degrees)"), FMath::IsNearlyEqual(Outputs[1], 1.00f, KINDA_SMALL_NUMBER));
+    }
+
+    // Precedence and associativity.
+    static const struct {
+        const TCHAR* Code;
+        float Expected;
+    } Values[] = {
+        { TEXT("1 + 2 * 3"), 7.00f },
+        { TEXT("2 ^ 3 ^ 2"), 512.00f },
+        { TEXT("-2 ^ 2"), -4.00f },
+        { TEXT("7 % 4 * 2"), 6.00f },
+        { TEXT("1 < 2 == 1"), 1.00f },
+        { TEXT("0 || 1 && 0"), 0.00f },
+        { TEXT("0 ? 1 : 1 ? 2 : 3"), 2.00f },
+        { TEXT("k0.z * k0.w + k0"), -1.50f },
+        { TEXT("min(1, 2) + max(1, 2) + abs(-3) + sign(-5)"), 5.00f },
+        { TEXT("smoothstep(0, 2, 1) + deg(pi)"), 180.50f },
+    };
+    for (const auto& Value : Values) {
+        FKineDriverExprProgram Program;
+        FString Error;
+        if (!TestTrue(FString::Printf(TEXT("Compiles: %s"), Value.Code), Program.Compile(MakeExpr(Value.Code), &Error))) {
+            AddError(Error);
+            continue;
+        }
+        float Output = 0.00f;
+        Program.Evaluate(NULL, &Output);
+        TestTrue(FString::Printf(TEXT("%s = %g, got %g"), Value.Code, Value.Expected, Output), FMath::IsNearlyEqual(Output, Value.Expected, KINDA_SMALL_NUMBER));
+    }
+
+    // Malformed code reports an error and compiles to a program without outputs.
+    static const TCHAR* Malformed[] = { TEXT("in0 +"), TEXT("foo(1)"), TEXT("k5"), TEXT("$y"), TEXT("sin(1, 2)"), TEXT("(in0"), TEXT("in0 in1") };
+    for (const TCHAR* Code : Malformed) {
+        FKineDriverExprProgram Program;
+        FString Error;
+        TestFalse(FString::Printf(TEXT("Rejects: %s"), Code), Program.Compile(MakeExpr(Code), &Error));
+        TestFalse(FString::Printf(TEXT("Reports an error: %s"), Code), Error.IsEmpty());
+        TestFalse(FString::Printf(TEXT("Invalid: %s"), Code), Program.IsValid());
+    }
+
+    // The compiled program, scalar and batched, matches the node-by-node reference, odd instance counts included.
+    static const TCHAR* Programs[] = {
+        TEXT("out0 = in0 + 0; out1 = 1 * in1 * 1 - 0; out2 = 1 + 2 * 3"),
+        TEXT("in0 == in1 || !in2 && in3 != 0"),
+        TEXT("in0 < in1 ? in0 <= in2 : in0 >= in3"),
+        TEXT("floor(in0) + ceil(in1) + sqrt(in2) + exp(in3) + log(in0) + atan2(in1, in2)"),
+        TEXT("out0 = in0; out1 = out0 * 2; $x = out1 + in1; out3 = $x * $x"),
+    };
+    FRandomStream Random(0x4B44);
+    static const int32 NumInstances = 7;
+    for (const TCHAR* Code : Programs) {
+        const FSQEX_KineDriverEffectorExpr Expr = MakeExpr(Code);
+        FKineDriverExprSyntax Syntax;
+        FKineDriverExprProgram Program;
+        if (!TestTrue(FString::Printf(TEXT("Parses: %s"), Code), Syntax.Parse(Expr) && Program.Compile(Syntax))) {
+            continue;
+        }
+
+        const int32 NumInputs = Syntax.GetNumInputs();
+        const int32 NumOutputs = Syntax.GetNumOutputs();
+        TArray<float> Inputs;
+        TArray<float> Batch;
+        Inputs.SetNumUninitialized(NumInputs * NumInstances);
+        Batch.SetNumUninitialized(NumOutputs * NumInstances);
+        for (float& Input : Inputs) {
+            Input = Random.RandHelper(4) == 0 ? (float)(Random.RandHelper(3) - 1) : Random.FRandRange(-10.00f, 10.00f);
+        }
+        Program.EvaluateBatch(NumInstances, Inputs.GetData(), Batch.GetData());
+
+        TArray<float> InstanceInputs;
+        TArray<float> Reference;
+        TArray<float> Scalar;
+        InstanceInputs.SetNumUninitialized(FMath::Max(NumInputs, 1));
+        Reference.SetNumUninitialized(FMath::Max(NumOutputs, 1));
+        Scalar.SetNumUninitialized(FMath::Max(NumOutputs, 1));
+        for (int32 Instance = 0; Instance < NumInstances; ++Instance) {
+            for (int32 Input = 0; Input < NumInputs; ++Input) {
+                InstanceInputs[Input] = Inputs[Input * NumInstances + Instance];
+            }
+            Syntax.Evaluate(InstanceInputs.GetData(), Reference.GetData());
+            Program.Evaluate(InstanceInputs.GetData(), Scalar.GetData());
+            for (int32 Output = 0; Output < NumOutputs; ++Output) {
+                TestTrue(FString::Printf(TEXT("%s out%d instance %d: program"), Code, Output, Instance), IsSameValue(Reference[Output], Scalar[Output]));
+                TestTrue(FString::Printf(TEXT("%s out%d instance %d: batch"), Code, Output, Instance), IsSameValue(Reference[Output], Batch[Output * NumInstances + Instance]));
+            }
+        }
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
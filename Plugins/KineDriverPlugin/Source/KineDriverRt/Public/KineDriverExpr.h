@@ -0,0 +1,142 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FSQEX_KineDriverEffectorExpr;
+
+// Expression effector language. Code is a list of statements separated by ';':
+//
+//   $blend = clamp(in0 * k0.x + k0.y, 0, 1);
+//   out0 = lerp(in1, in2, $blend);
+//   out1 = in3 > 0 ? sin(rad(in3)) : 0
+//
+// inN reads runtime input N, kN.x / .y / .z / .w reads Inputs[N] of the effector (kN is kN.x), outN = writes output N
+// and $name = binds a local. A statement that is only an expression writes out0. Operators, lowest precedence first:
+// ?:, ||, &&, == !=, < <= > >=, + -, * / %, unary - + !, ^ (power, right associative). Comparisons and logic give 1 or 0
+// and treat any non zero value as true; both sides of ?:, && and || are always evaluated. Functions: sin cos tan asin
+// acos atan atan2 sqrt abs sign floor ceil exp log pow min max clamp lerp smoothstep rad deg; constant: pi.
+//
+// The grammar has not been confirmed against exported Code, so nothing evaluates effectors with it at runtime.
+// kinedriver.Expr.Verify reports the Code of loaded assets that it does not accept.
+enum class EKineDriverExprOp : uint8 {
+    Constant,
+    Input,
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    Pow,
+    Neg,
+    Min,
+    Max,
+    Abs,
+    Sign,
+    Floor,
+    Ceil,
+    Sqrt,
+    Exp,
+    Log,
+    Sin,
+    Cos,
+    Tan,
+    Asin,
+    Acos,
+    Atan,
+    Atan2,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual,
+    And,
+    Or,
+    Not,
+    // Operands[0] != 0 ? Operands[1] : Operands[2]
+    Select,
+    // Operands: value, min, max
+    Clamp,
+    // Operands: a, b, alpha
+    Lerp,
+    // Operands: edge0, edge1, x
+    SmoothStep,
+    Num
+};
+
+// Parsed expression: nodes in dependency order, locals already substituted. Evaluate() runs every node as written and
+// is the reference the compiled program is checked against.
+class KINEDRIVERRT_API FKineDriverExprSyntax {
+public:
+    struct FNode {
+        EKineDriverExprOp Op;
+        int32 Operands[3];
+        // Constant value or input index.
+        float Value;
+        int32 Input;
+    };
+
+    FKineDriverExprSyntax();
+
+    bool Parse(const FSQEX_KineDriverEffectorExpr& Expr, FString* OutError = NULL);
+
+    void Evaluate(const float* Inputs, float* Outputs) const;
+
+    int32 GetNumInputs() const { return NumInputs; }
+    int32 GetNumOutputs() const { return Outputs.Num(); }
+    const TArray<FNode>& GetNodes() const { return Nodes; }
+    // Node of every output; INDEX_NONE outputs are 0.
+    const TArray<int32>& GetOutputs() const { return Outputs; }
+
+    static int32 GetNumOperands(EKineDriverExprOp Op);
+    // The one definition of every operator, shared by the reference, the constant folder and the interpreters.
+    static float Apply(EKineDriverExprOp Op, float A, float B, float C);
+
+private:
+    friend class FKineDriverExprParser;
+
+    TArray<FNode> Nodes;
+    TArray<int32> Outputs;
+    int32 NumInputs;
+};
+
+// Register bytecode compiled from an FKineDriverExprSyntax. Constant subtrees are folded, identities (x + 0, x * 1, ...)
+// removed, dead statements dropped and registers reused once their value is dead. The register file holds the inputs,
+// then the constant pool, then the temporaries.
+class KINEDRIVERRT_API FKineDriverExprProgram {
+public:
+    // Characters evaluated together by EvaluateWide().
+    static const int32 Lanes = 4;
+
+    FKineDriverExprProgram();
+
+    bool Compile(const FSQEX_KineDriverEffectorExpr& Expr, FString* OutError = NULL);
+    bool Compile(const FKineDriverExprSyntax& Syntax, FString* OutError = NULL);
+
+    bool IsValid() const { return bValid; }
+    int32 GetNumInputs() const { return NumInputs; }
+    int32 GetNumOutputs() const { return OutputRegisters.Num(); }
+    int32 GetNumInstructions() const { return Instructions.Num(); }
+    int32 GetNumRegisters() const { return NumRegisters; }
+
+    // Inputs[GetNumInputs()], Outputs[GetNumOutputs()]. An invalid program outputs nothing.
+    void Evaluate(const float* Inputs, float* Outputs) const;
+    // Lanes characters at once, Inputs[Input * Lanes + Lane] and Outputs[Output * Lanes + Lane]. Arithmetic, comparisons
+    // and selects run in SIMD; the other operators per lane, so every lane matches Evaluate() exactly.
+    void EvaluateWide(const float* Inputs, float* Outputs) const;
+    // Any number of characters, Inputs[Input * NumInstances + Instance] and the same for Outputs.
+    void EvaluateBatch(int32 NumInstances, const float* Inputs, float* Outputs) const;
+
+private:
+    struct FInstruction {
+        EKineDriverExprOp Op;
+        uint16 Dst;
+        uint16 Operands[3];
+    };
+
+    TArray<FInstruction> Instructions;
+    TArray<float> Constants;
+    TArray<uint16> OutputRegisters;
+    int32 NumInputs;
+    int32 NumRegisters;
+    bool bValid;
+};
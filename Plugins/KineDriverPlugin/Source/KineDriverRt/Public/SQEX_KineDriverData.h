@@ -115,5 +115,7 @@ private:
 public:
     USQEX_KineDriverData();
 
+    int32 GetNumEffectorExprs() const { return EffectorExprBody.Num(); }
+    const FSQEX_KineDriverEffectorExpr& GetEffectorExpr(int32 Index) const { return EffectorExprBody[Index]; }
 };
 
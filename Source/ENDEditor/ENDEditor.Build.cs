@@ -15,6 +15,8 @@ public class ENDEditor : ModuleRules {
             "InputCore",
             "EndGame",
             "Engine",
+            "LevelSequence",
+            "MovieScene",
             "UnrealEd",
             "Slate",
             "SlateCore"
@@ -0,0 +1,130 @@
+#include "EndFieldGridBakeCommandlet.h"
+
+#include "EndFieldGridActor.h"
+#include "EndFieldGridBaker.h"
+#include "Engine/Engine.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Misc/PackageName.h"
+#include "PackageHelperFunctions.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogEndFieldGridBake, Log, All);
+
+UEndFieldGridBakeCommandlet::UEndFieldGridBakeCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UEndFieldGridBakeCommandlet::Main(const FString& Params)
+{
+	FString MapName;
+	FString ActorName;
+	int32 BrickSize = 16;
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	FParse::Value(*Params, TEXT("Actor="), ActorName);
+	FParse::Value(*Params, TEXT("BrickSize="), BrickSize);
+	const bool bIncremental = FParse::Param(*Params, TEXT("Incremental"));
+
+	if (MapName.IsEmpty() || BrickSize <= 0)
+	{
+		UE_LOG(LogEndFieldGridBake, Error, TEXT("Usage: -run=EndFieldGridBake -Map=<map> [-Actor=<name>] [-BrickSize=16] [-Incremental]"));
+		return 1;
+	}
+
+	UPackage* MapPackage = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = MapPackage != nullptr ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (World == nullptr)
+	{
+		UE_LOG(LogEndFieldGridBake, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	// Collision queries need a physics scene, but nothing has to tick.
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(true)
+			.RequiresHitProxies(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.SetTransactional(false));
+	}
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Editor);
+	WorldContext.SetCurrentWorld(World);
+	for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels())
+	{
+		if (StreamingLevel != nullptr)
+		{
+			StreamingLevel->SetShouldBeLoaded(true);
+			StreamingLevel->SetShouldBeVisible(true);
+		}
+	}
+	World->FlushLevelStreaming(EFlushLevelStreamingType::Full);
+	World->UpdateWorldComponents(true, false);
+
+	int32 Result = 0;
+	int32 NumBaked = 0;
+	TSet<UPackage*> DirtyPackages;
+	for (TActorIterator<AEndFieldGridActor> It(World); It; ++It)
+	{
+		AEndFieldGridActor* FieldGrid = *It;
+		if (!ActorName.IsEmpty() && FieldGrid->GetName() != ActorName && FieldGrid->GetActorLabel() != ActorName)
+		{
+			continue;
+		}
+		if (!FieldGrid->bUsePackedGrid)
+		{
+			UE_LOG(LogEndFieldGridBake, Verbose, TEXT("%s: bUsePackedGrid is off, skipped"), *FieldGrid->GetName());
+			continue;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		FEndFieldGridBaker Baker(FieldGrid, BrickSize);
+		if (!Baker.Bake(bIncremental))
+		{
+			UE_LOG(LogEndFieldGridBake, Error, TEXT("%s: invalid raw grid settings, skipped"), *FieldGrid->GetName());
+			Result = 1;
+			continue;
+		}
+
+		UE_LOG(LogEndFieldGridBake, Display, TEXT("%s: rebaked %d/%d bricks into %dx%dx%d packed cells in %.2fs"),
+			*FieldGrid->GetName(), Baker.GetNumRebakedBricks(), Baker.GetNumBricks(), FieldGrid->PackedGridNum_.X, FieldGrid->PackedGridNum_.Y, FieldGrid->PackedGridNum_.Z, FPlatformTime::Seconds() - StartTime);
+		FieldGrid->MarkPackageDirty();
+		DirtyPackages.Add(FieldGrid->GetOutermost());
+		++NumBaked;
+	}
+
+	// Packages are saved in name order so repeated bakes touch files in the same sequence.
+	TArray<UPackage*> Packages = DirtyPackages.Array();
+	Packages.Sort([](const UPackage& A, const UPackage& B) { return A.GetName() < B.GetName(); });
+	for (UPackage* Package : Packages)
+	{
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetMapPackageExtension());
+		if (!SavePackageHelper(Package, Filename))
+		{
+			UE_LOG(LogEndFieldGridBake, Error, TEXT("Failed to save %s"), *Filename);
+			Result = 1;
+		}
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	CollectGarbage(RF_NoFlags);
+
+	if (NumBaked == 0)
+	{
+		UE_LOG(LogEndFieldGridBake, Warning, TEXT("No field grids baked in %s"), *MapName);
+	}
+	return Result;
+}
@@ -0,0 +1,321 @@
+#include "EndFieldGridBaker.h"
+
+#include "Async/ParallelFor.h"
+#include "CollisionQueryParams.h"
+#include "Components/PrimitiveComponent.h"
+#include "EndFieldGridActor.h"
+#include "EndFieldPackedGrid.h"
+#include "Engine/World.h"
+
+namespace EndFieldGridBaker
+{
+	static const FIntVector NeighborOffsets[6] = {
+		FIntVector(1, 0, 0), FIntVector(-1, 0, 0),
+		FIntVector(0, 1, 0), FIntVector(0, -1, 0),
+		FIntVector(0, 0, 1), FIntVector(0, 0, -1),
+	};
+}
+
+FEndFieldGridBaker::FEndFieldGridBaker(AEndFieldGridActor* InActor, int32 InBrickSize)
+	: Actor(InActor)
+	, World(InActor->GetWorld())
+	, RawSize((int32)InActor->RawGridNumX, (int32)InActor->RawGridNumY, (int32)InActor->RawGridNumZ)
+	, BrickSize(FMath::Max(InBrickSize, 1))
+	, NumRebakedBricks(0)
+{
+	NumBricks = FIntVector(
+		FMath::DivideAndRoundUp(RawSize.X, BrickSize),
+		FMath::DivideAndRoundUp(RawSize.Y, BrickSize),
+		FMath::DivideAndRoundUp(RawSize.Z, BrickSize));
+}
+
+FVector FEndFieldGridBaker::GetRawCellCenter(int32 X, int32 Y, int32 Z) const
+{
+	// Same placement as AEndFieldGridActor::GetGridOrigin, at raw resolution.
+	const float UnitLength = Actor->UnitLength;
+	return Actor->GetActorLocation() - FVector(RawSize) * (UnitLength * 0.5f) + (FVector((float)X, (float)Y, (float)Z) + 0.5f) * UnitLength;
+}
+
+FIntVector FEndFieldGridBaker::GetBrickMin(int32 BrickIndex) const
+{
+	const int32 BrickX = BrickIndex % NumBricks.X;
+	const int32 BrickY = (BrickIndex / NumBricks.X) % NumBricks.Y;
+	const int32 BrickZ = BrickIndex / (NumBricks.X * NumBricks.Y);
+	return FIntVector(BrickX, BrickY, BrickZ) * BrickSize;
+}
+
+FBox FEndFieldGridBaker::GetBrickBounds(int32 BrickIndex) const
+{
+	const FIntVector Min = GetBrickMin(BrickIndex);
+	const FIntVector Max(FMath::Min(Min.X + BrickSize, RawSize.X) - 1, FMath::Min(Min.Y + BrickSize, RawSize.Y) - 1, FMath::Min(Min.Z + BrickSize, RawSize.Z) - 1);
+	const FVector HalfUnit(Actor->UnitLength * 0.5f);
+	return FBox(GetRawCellCenter(Min.X, Min.Y, Min.Z) - HalfUnit, GetRawCellCenter(Max.X, Max.Y, Max.Z) + HalfUnit);
+}
+
+uint32 FEndFieldGridBaker::HashBrickCollision(int32 BrickIndex) const
+{
+	const FBox Bounds = GetBrickBounds(BrickIndex);
+	TArray<FOverlapResult> Overlaps;
+	World->OverlapMultiByChannel(Overlaps, Bounds.GetCenter(), FQuat::Identity, ECC_WorldStatic, FCollisionShape::MakeBox(Bounds.GetExtent()), FCollisionQueryParams(SCENE_QUERY_STAT(EndFieldGridBake), false));
+
+	// Sorted so the hash does not depend on the order the physics scene reports overlaps in.
+	TArray<uint32> ComponentHashes;
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		const UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (Component == nullptr || !Overlap.bBlockingHit)
+		{
+			continue;
+		}
+		const FTransform& Transform = Component->GetComponentTransform();
+		uint32 Hash = GetTypeHash(Component->GetPathName());
+		Hash = HashCombine(Hash, GetTypeHash(Transform.GetLocation()));
+		Hash = HashCombine(Hash, GetTypeHash(Transform.GetRotation().Euler()));
+		Hash = HashCombine(Hash, GetTypeHash(Transform.GetScale3D()));
+		Hash = HashCombine(Hash, GetTypeHash(Component->Bounds.BoxExtent));
+		ComponentHashes.Add(Hash);
+	}
+	ComponentHashes.Sort();
+
+	uint32 BrickHash = 0;
+	for (const uint32 Hash : ComponentHashes)
+	{
+		BrickHash = HashCombine(BrickHash, Hash);
+	}
+	return BrickHash;
+}
+
+void FEndFieldGridBaker::QueryBrickOccupancy(int32 BrickIndex)
+{
+	const FIntVector Min = GetBrickMin(BrickIndex);
+	const FCollisionShape CellShape = FCollisionShape::MakeBox(FVector(Actor->UnitLength * 0.5f - KINDA_SMALL_NUMBER));
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(EndFieldGridBake), false);
+
+	for (int32 Z = Min.Z; Z < FMath::Min(Min.Z + BrickSize, RawSize.Z); ++Z)
+	{
+		for (int32 Y = Min.Y; Y < FMath::Min(Min.Y + BrickSize, RawSize.Y); ++Y)
+		{
+			for (int32 X = Min.X; X < FMath::Min(Min.X + BrickSize, RawSize.X); ++X)
+			{
+				Occupancy[GetRawIndex(X, Y, Z)] = World->OverlapBlockingTestByChannel(GetRawCellCenter(X, Y, Z), FQuat::Identity, ECC_WorldStatic, CellShape, QueryParams) ? 1 : 0;
+			}
+		}
+	}
+}
+
+bool FEndFieldGridBaker::Bake(bool bIncremental)
+{
+	if (World == nullptr || !Actor->bUsePackedGrid || RawSize.X <= 0 || RawSize.Y <= 0 || RawSize.Z <= 0 || Actor->UnitLength <= 0.0f)
+	{
+		return false;
+	}
+
+	const int32 NumRawCells = RawSize.X * RawSize.Y * RawSize.Z;
+	const int32 NumBrickCells = GetNumBricks();
+
+	TArray<uint32> BrickHashes;
+	BrickHashes.SetNumZeroed(NumBrickCells);
+	ParallelFor(NumBrickCells, [this, &BrickHashes](int32 BrickIndex)
+	{
+		BrickHashes[BrickIndex] = HashBrickCollision(BrickIndex);
+	});
+
+	// Stored occupancy is only reusable if it was baked with the same raw grid and brick layout.
+	const bool bCanReuse = bIncremental
+		&& Actor->BakedRawGridNum_ == RawSize
+		&& Actor->BakedBrickSize_ == BrickSize
+		&& Actor->BakedBrickHashes_.Num() == NumBrickCells
+		&& Actor->BakedOccupancy_.Num() == FMath::DivideAndRoundUp(NumRawCells, 32);
+
+	Occupancy.SetNumZeroed(NumRawCells);
+	TArray<int32> DirtyBricks;
+	for (int32 BrickIndex = 0; BrickIndex < NumBrickCells; ++BrickIndex)
+	{
+		if (!bCanReuse || Actor->BakedBrickHashes_[BrickIndex] != BrickHashes[BrickIndex])
+		{
+			DirtyBricks.Add(BrickIndex);
+		}
+	}
+	if (bCanReuse)
+	{
+		for (int32 Index = 0; Index < NumRawCells; ++Index)
+		{
+			Occupancy[Index] = (Actor->BakedOccupancy_[Index >> 5] >> (Index & 31)) & 1;
+		}
+	}
+
+	NumRebakedBricks = DirtyBricks.Num();
+	ParallelFor(DirtyBricks.Num(), [this, &DirtyBricks](int32 DirtyIndex)
+	{
+		QueryBrickOccupancy(DirtyBricks[DirtyIndex]);
+	});
+
+	ComputeSurface();
+	RelaxFlow();
+
+	Actor->Modify();
+	WriteMergedGrid();
+
+	Actor->BakedOccupancy_.SetNumZeroed(FMath::DivideAndRoundUp(NumRawCells, 32));
+	for (int32 Index = 0; Index < NumRawCells; ++Index)
+	{
+		Actor->BakedOccupancy_[Index >> 5] |= (uint32)Occupancy[Index] << (Index & 31);
+	}
+	Actor->BakedBrickHashes_ = MoveTemp(BrickHashes);
+	Actor->BakedRawGridNum_ = RawSize;
+	Actor->BakedBrickSize_ = BrickSize;
+	Actor->RebuildPackedGrid();
+	return true;
+}
+
+void FEndFieldGridBaker::ComputeSurface()
+{
+	const int32 NumRawCells = RawSize.X * RawSize.Y * RawSize.Z;
+	const int32 MaxLevel = FMath::Clamp(FMath::CeilToInt(Actor->SurfaceRange / Actor->UnitLength), 1, 127);
+	SurfaceLevels.SetNumUninitialized(NumRawCells);
+	Normals.SetNumUninitialized(NumRawCells);
+	Flows.SetNumUninitialized(NumRawCells);
+
+	auto IsSolid = [this](int32 X, int32 Y, int32 Z)
+	{
+		return X >= 0 && Y >= 0 && Z >= 0 && X < RawSize.X && Y < RawSize.Y && Z < RawSize.Z && Occupancy[GetRawIndex(X, Y, Z)] != 0;
+	};
+
+	// Columns are independent: each air cell takes its level and normal from the nearest solid cell below it.
+	ParallelFor(RawSize.X * RawSize.Y, [this, MaxLevel, &IsSolid](int32 ColumnIndex)
+	{
+		const int32 X = ColumnIndex % RawSize.X;
+		const int32 Y = ColumnIndex / RawSize.X;
+		int32 SurfaceZ = INDEX_NONE;
+		FVector SurfaceNormal = FVector::UpVector;
+
+		for (int32 Z = 0; Z < RawSize.Z; ++Z)
+		{
+			const int32 Index = GetRawIndex(X, Y, Z);
+			if (Occupancy[Index] != 0)
+			{
+				SurfaceZ = Z;
+				SurfaceLevels[Index] = 0;
+				Normals[Index] = FVector::UpVector;
+				Flows[Index] = FVector::ZeroVector;
+				continue;
+			}
+
+			if (SurfaceZ == Z - 1)
+			{
+				// First air cell above a surface: the occupancy gradient around it points away from the solid.
+				FVector Gradient = FVector::ZeroVector;
+				for (const FIntVector& Offset : EndFieldGridBaker::NeighborOffsets)
+				{
+					if (IsSolid(X + Offset.X, Y + Offset.Y, Z + Offset.Z))
+					{
+						Gradient -= FVector(Offset);
+					}
+				}
+				SurfaceNormal = Gradient.IsNearlyZero() ? FVector::UpVector : Gradient.GetSafeNormal();
+			}
+
+			const int32 Level = SurfaceZ != INDEX_NONE ? FMath::Min(Z - SurfaceZ, MaxLevel) : MaxLevel;
+			SurfaceLevels[Index] = Level;
+			Normals[Index] = Level < MaxLevel ? SurfaceNormal : FVector::UpVector;
+
+			// Downhill along the surface; flat ground has no flow.
+			const FVector Gravity(0.0f, 0.0f, -1.0f);
+			Flows[Index] = Level < MaxLevel ? Gravity - Normals[Index] * (Gravity | Normals[Index]) : FVector::ZeroVector;
+		}
+	});
+}
+
+void FEndFieldGridBaker::RelaxFlow()
+{
+	const int32 MaxLevel = FMath::Clamp(FMath::CeilToInt(Actor->SurfaceRange / Actor->UnitLength), 1, 127);
+	TArray<FVector> NextFlows;
+	NextFlows.SetNumUninitialized(Flows.Num());
+
+	for (uint32 Step = 0; Step < Actor->StepNum; ++Step)
+	{
+		// Jacobi passes over slices: every cell reads only the previous pass, so slicing does not change the result.
+		ParallelFor(RawSize.Z, [this, MaxLevel, &NextFlows](int32 Z)
+		{
+			for (int32 Y = 0; Y < RawSize.Y; ++Y)
+			{
+				for (int32 X = 0; X < RawSize.X; ++X)
+				{
+					const int32 Index = GetRawIndex(X, Y, Z);
+					if (SurfaceLevels[Index] == 0 || SurfaceLevels[Index] >= MaxLevel)
+					{
+						NextFlows[Index] = Flows[Index];
+						continue;
+					}
+
+					FVector Sum = Flows[Index];
+					int32 Count = 1;
+					for (const FIntVector& Offset : EndFieldGridBaker::NeighborOffsets)
+					{
+						const FIntVector Neighbor(X + Offset.X, Y + Offset.Y, Z + Offset.Z);
+						if (Neighbor.X < 0 || Neighbor.Y < 0 || Neighbor.Z < 0 || Neighbor.X >= RawSize.X || Neighbor.Y >= RawSize.Y || Neighbor.Z >= RawSize.Z)
+						{
+							continue;
+						}
+						const int32 NeighborIndex = GetRawIndex(Neighbor.X, Neighbor.Y, Neighbor.Z);
+						if (SurfaceLevels[NeighborIndex] > 0 && SurfaceLevels[NeighborIndex] < MaxLevel)
+						{
+							Sum += Flows[NeighborIndex];
+							++Count;
+						}
+					}
+					NextFlows[Index] = (Sum / (float)Count).GetClampedToMaxSize(1.0f);
+				}
+			}
+		});
+		Swap(Flows, NextFlows);
+	}
+}
+
+void FEndFieldGridBaker::WriteMergedGrid()
+{
+	const int32 MergeNum = (int32)FMath::Max(Actor->MergeNum, 1u);
+	const FIntVector GridSize(FMath::DivideAndRoundUp(RawSize.X, MergeNum), FMath::DivideAndRoundUp(RawSize.Y, MergeNum), FMath::DivideAndRoundUp(RawSize.Z, MergeNum));
+	const int32 NumCells = GridSize.X * GridSize.Y * GridSize.Z;
+	const bool bSaveNormal = Actor->SaveNormal;
+
+	// Only the packed grid is written. GridInfos_ / GridNormalInfos_ keep whatever cooked encoding they came with.
+	Actor->PackedGridNum_ = GridSize;
+	Actor->PackedGridCells_.SetNumUninitialized(NumCells);
+
+	ParallelFor(NumCells, [this, MergeNum, GridSize, bSaveNormal](int32 CellIndex)
+	{
+		const int32 CellX = CellIndex % GridSize.X;
+		const int32 CellY = (CellIndex / GridSize.X) % GridSize.Y;
+		const int32 CellZ = CellIndex / (GridSize.X * GridSize.Y);
+
+		FVector Flow = FVector::ZeroVector;
+		FVector Normal = FVector::ZeroVector;
+		int32 Level = MAX_int32;
+		int32 NumAir = 0;
+		for (int32 Z = CellZ * MergeNum; Z < FMath::Min((CellZ + 1) * MergeNum, RawSize.Z); ++Z)
+		{
+			for (int32 Y = CellY * MergeNum; Y < FMath::Min((CellY + 1) * MergeNum, RawSize.Y); ++Y)
+			{
+				for (int32 X = CellX * MergeNum; X < FMath::Min((CellX + 1) * MergeNum, RawSize.X); ++X)
+				{
+					const int32 Index = GetRawIndex(X, Y, Z);
+					Level = FMath::Min(Level, SurfaceLevels[Index]);
+					if (SurfaceLevels[Index] > 0)
+					{
+						Flow += Flows[Index];
+						Normal += Normals[Index];
+						++NumAir;
+					}
+				}
+			}
+		}
+
+		if (NumAir > 0)
+		{
+			Flow /= (float)NumAir;
+		}
+		const FVector CellNormal = !bSaveNormal ? FVector::ZeroVector : (Normal.IsNearlyZero() ? FVector::UpVector : Normal.GetSafeNormal());
+		Actor->PackedGridCells_[CellIndex] = FEndFieldPackedGrid::EncodeCell(Flow, CellNormal, Level);
+	});
+}
@@ -0,0 +1,262 @@
+#include "EndStreamableAssetRecordCommandlet.h"
+
+#include "Camera/CameraComponent.h"
+#include "Components/SplineComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "EndMassiveEnvironmentFrameData.h"
+#include "EndStreamableAssetPump.h"
+#include "LevelSequence.h"
+#include "LevelSequenceActor.h"
+#include "LevelSequencePlayer.h"
+#include "Misc/PackageName.h"
+#include "PackageHelperFunctions.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogEndStreamableAssetRecord, Log, All);
+
+UEndStreamableAssetRecordCommandlet::UEndStreamableAssetRecordCommandlet()
+	: CurrentCamera(nullptr)
+	, NextCutIndex(0)
+	, CurrentTime(0.0f)
+	, NumMassiveEnvironmentComponents(0)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UEndStreamableAssetRecordCommandlet::Main(const FString& Params)
+{
+	FString MapName;
+	FString PumpName;
+	FString SequenceName;
+	FString SplineActorName;
+	float Speed = 1000.0f;
+	float FrameRate = 30.0f;
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	FParse::Value(*Params, TEXT("Pump="), PumpName);
+	FParse::Value(*Params, TEXT("Sequence="), SequenceName);
+	FParse::Value(*Params, TEXT("Spline="), SplineActorName);
+	FParse::Value(*Params, TEXT("Speed="), Speed);
+	FParse::Value(*Params, TEXT("FrameRate="), FrameRate);
+	FParse::Value(*Params, TEXT("MassiveEnvironmentFilter="), Recorder.MassiveEnvironmentPathFilter);
+	const bool bReplace = FParse::Param(*Params, TEXT("Replace"));
+
+	if (MapName.IsEmpty() || PumpName.IsEmpty() || (SequenceName.IsEmpty() == SplineActorName.IsEmpty()) || FrameRate <= 0.0f)
+	{
+		UE_LOG(LogEndStreamableAssetRecord, Error, TEXT("Usage: -run=EndStreamableAssetRecord -Map=<map> -Pump=<pump asset> (-Sequence=<sequence> | -Spline=<actor> -Speed=<cm/s>) [-FrameRate=30] [-MassiveEnvironmentFilter=<path>] [-Replace]"));
+		return 1;
+	}
+
+	// Resolve the output first so a typo does not cost a full recording.
+	UEndStreamableAssetPump* Pump = LoadObject<UEndStreamableAssetPump>(nullptr, *PumpName);
+	if (Pump == nullptr)
+	{
+		UE_LOG(LogEndStreamableAssetRecord, Error, TEXT("Could not load pump asset %s"), *PumpName);
+		return 1;
+	}
+
+	UWorld* World = LoadWorld(MapName);
+	if (World == nullptr)
+	{
+		UE_LOG(LogEndStreamableAssetRecord, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	Recorder.Reset();
+	NumMassiveEnvironmentComponents = 0;
+	const bool bRecorded = SequenceName.IsEmpty() ? RecordSpline(World, SplineActorName, Speed, FrameRate) : RecordSequence(World, SequenceName, FrameRate);
+	UnloadWorld(World);
+	if (!bRecorded)
+	{
+		return 1;
+	}
+
+	if (bReplace)
+	{
+		Pump->PumpData = FEndPumpData();
+	}
+	Recorder.MergeInto(Pump->PumpData);
+	Pump->RebuildTimeline();
+	Pump->MarkPackageDirty();
+
+	UPackage* Package = Pump->GetOutermost();
+	const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+	if (!SavePackageHelper(Package, Filename))
+	{
+		UE_LOG(LogEndStreamableAssetRecord, Error, TEXT("Failed to save %s"), *Filename);
+		return 1;
+	}
+
+	int32 NumMEComponents = 0;
+	for (const FEndStreamableAssets& Record : Pump->PumpData.StreamableAssets)
+	{
+		NumMEComponents += Record.StreamableMEComponents.Num();
+	}
+	UE_LOG(LogEndStreamableAssetRecord, Display, TEXT("Recorded %d cut(s) into %s: %d records, %d asset paths, %d massive environment paths (%d components, %d captured this run)"),
+		Recorder.GetNumCuts(), *PumpName, Pump->PumpData.StreamableAssets.Num(), Pump->PumpData.AssetPaths.Num(), Pump->PumpData.MassiveEnvironmentAssetPaths.Num(),
+		NumMEComponents, NumMassiveEnvironmentComponents);
+	return 0;
+}
+
+UWorld* UEndStreamableAssetRecordCommandlet::LoadWorld(const FString& MapName)
+{
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package != nullptr ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	World->WorldType = EWorldType::Game;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(false)
+			.RequiresHitProxies(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.SetTransactional(false));
+	}
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->UpdateWorldComponents(true, false);
+
+	// Record against the whole map; which sublevels are resident at runtime is the streaming system's problem.
+	for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels())
+	{
+		if (StreamingLevel != nullptr)
+		{
+			StreamingLevel->SetShouldBeLoaded(true);
+			StreamingLevel->SetShouldBeVisible(true);
+		}
+	}
+	World->FlushLevelStreaming(EFlushLevelStreamingType::Full);
+
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+	return World;
+}
+
+void UEndStreamableAssetRecordCommandlet::UnloadWorld(UWorld* World)
+{
+	CurrentCamera = nullptr;
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	CollectGarbage(RF_NoFlags);
+}
+
+bool UEndStreamableAssetRecordCommandlet::RecordSequence(UWorld* World, const FString& SequenceName, float FrameRate)
+{
+	ULevelSequence* Sequence = LoadObject<ULevelSequence>(nullptr, *SequenceName);
+	if (Sequence == nullptr)
+	{
+		UE_LOG(LogEndStreamableAssetRecord, Error, TEXT("Could not load level sequence %s"), *SequenceName);
+		return false;
+	}
+
+	ALevelSequenceActor* SequenceActor = nullptr;
+	ULevelSequencePlayer* Player = ULevelSequencePlayer::CreateLevelSequencePlayer(World, Sequence, FMovieSceneSequencePlaybackSettings(), SequenceActor);
+	if (Player == nullptr)
+	{
+		return false;
+	}
+
+	NextCutIndex = 0;
+	CurrentTime = 0.0f;
+	CurrentCamera = nullptr;
+	Player->OnCameraCut.AddDynamic(this, &UEndStreamableAssetRecordCommandlet::OnCameraCut);
+	Player->Play();
+
+	const float StepTime = 1.0f / FrameRate;
+	const double Duration = Player->GetDuration().AsSeconds();
+	const FFrameRate DisplayRate = Player->GetFrameRate();
+	for (int32 Frame = 0; Frame * StepTime <= Duration; ++Frame)
+	{
+		CurrentTime = Frame * StepTime;
+		Player->SetPlaybackPosition(FMovieSceneSequencePlaybackParams(DisplayRate.AsFrameTime(CurrentTime), EUpdatePositionMethod::Play));
+		World->Tick(LEVELTICK_All, StepTime);
+		GFrameCounter++;
+
+		if (CurrentCamera != nullptr)
+		{
+			FMinimalViewInfo View;
+			CurrentCamera->GetCameraView(StepTime, View);
+			CaptureFrame(World, View, CurrentTime);
+		}
+	}
+
+	Player->Stop();
+	Player->OnCameraCut.RemoveAll(this);
+	UE_LOG(LogEndStreamableAssetRecord, Display, TEXT("Played %s: %.2fs, %d camera cut(s)"), *SequenceName, Duration, NextCutIndex);
+	return true;
+}
+
+bool UEndStreamableAssetRecordCommandlet::RecordSpline(UWorld* World, const FString& ActorName, float Speed, float FrameRate)
+{
+	const USplineComponent* Spline = nullptr;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (It->GetName() == ActorName || It->GetActorLabel() == ActorName)
+		{
+			Spline = It->FindComponentByClass<USplineComponent>();
+			break;
+		}
+	}
+	if (Spline == nullptr || Speed <= 0.0f)
+	{
+		UE_LOG(LogEndStreamableAssetRecord, Error, TEXT("No spline actor %s in map (or invalid -Speed)"), *ActorName);
+		return false;
+	}
+
+	const float StepTime = 1.0f / FrameRate;
+	const float Length = Spline->GetSplineLength();
+	Recorder.BeginCut(0, Spline->GetOwner()->GetFName(), 0.0f, GFrameCounter);
+
+	FMinimalViewInfo View;
+	View.FOV = 90.0f;
+	View.AspectRatio = 16.0f / 9.0f;
+	for (int32 Frame = 0; Frame * StepTime * Speed <= Length; ++Frame)
+	{
+		const float Distance = Frame * StepTime * Speed;
+		World->Tick(LEVELTICK_All, StepTime);
+		GFrameCounter++;
+
+		View.Location = Spline->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World);
+		View.Rotation = Spline->GetDirectionAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World).Rotation();
+		CaptureFrame(World, View, Frame * StepTime);
+	}
+
+	UE_LOG(LogEndStreamableAssetRecord, Display, TEXT("Followed %s: %.0fcm at %.0fcm/s"), *ActorName, Length, Speed);
+	return true;
+}
+
+void UEndStreamableAssetRecordCommandlet::CaptureFrame(UWorld* World, const FMinimalViewInfo& View, float Time)
+{
+	Recorder.CaptureView(World, View, Time);
+
+	if (!Recorder.MassiveEnvironmentPathFilter.IsEmpty())
+	{
+		FEndMassiveEnvironmentFrameData Frame;
+		Recorder.GatherMassiveEnvironment(World, View, Time, Frame, MassiveEnvironmentPaths);
+		Recorder.CaptureMassiveEnvironment(Frame, MassiveEnvironmentPaths);
+		NumMassiveEnvironmentComponents += Frame.Components.Num();
+	}
+}
+
+void UEndStreamableAssetRecordCommandlet::OnCameraCut(UCameraComponent* CameraComponent)
+{
+	CurrentCamera = CameraComponent;
+
+	const AActor* CameraActor = CameraComponent != nullptr ? CameraComponent->GetOwner() : nullptr;
+	Recorder.BeginCut(NextCutIndex++, CameraActor != nullptr ? CameraActor->GetFName() : NAME_None, CurrentTime, GFrameCounter);
+}
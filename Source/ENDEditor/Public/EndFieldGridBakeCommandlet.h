@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "EndFieldGridBakeCommandlet.generated.h"
+
+/*
+ * Bakes the packed grid of every AEndFieldGridActor in a map that sets bUsePackedGrid, with FEndFieldGridBaker, and
+ * saves the levels that own them.
+ *
+ * Usage: -run=EndFieldGridBake -Map=<map package> [-Actor=<name>] [-BrickSize=16] [-Incremental]
+ *   Map: World to load; every streaming level is loaded so fields see the full collision.
+ *   Actor: Only bake the field grid with this name or label.
+ *   BrickSize: Raw cells per brick edge, the unit of parallel work and of incremental invalidation.
+ *   Incremental: Only re-query collision for bricks whose overlapping collision changed since the last bake.
+ */
+UCLASS()
+class ENDEDITOR_API UEndFieldGridBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UEndFieldGridBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
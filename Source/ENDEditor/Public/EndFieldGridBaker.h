@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AEndFieldGridActor;
+
+/*
+ * Bakes the packed sampling grid (AEndFieldGridActor::PackedGridCells_) of actors with bUsePackedGrid from world
+ * collision. The cooked GridInfos_ / GridNormalInfos_ are left alone.
+ *
+ * The raw grid (RawGridNum* cells of UnitLength) is split into cubic bricks that are queried against collision in
+ * parallel. Surface levels, normals and StepNum flow relaxation passes then run over the whole raw grid with double
+ * buffering, and MergeNum^3 raw cells are averaged into each grid cell. Every cell is a pure function of the occupancy,
+ * so the result does not depend on thread count or scheduling.
+ */
+class ENDEDITOR_API FEndFieldGridBaker
+{
+public:
+	FEndFieldGridBaker(AEndFieldGridActor* InActor, int32 InBrickSize);
+
+	// Incremental reuses the stored occupancy of bricks whose collision hash is unchanged. Returns false if the actor
+	// cannot be baked or has not opted in to the packed grid.
+	bool Bake(bool bIncremental);
+
+	int32 GetNumBricks() const { return NumBricks.X * NumBricks.Y * NumBricks.Z; }
+	int32 GetNumRebakedBricks() const { return NumRebakedBricks; }
+
+private:
+	FVector GetRawCellCenter(int32 X, int32 Y, int32 Z) const;
+	int32 GetRawIndex(int32 X, int32 Y, int32 Z) const { return X + (Y + Z * RawSize.Y) * RawSize.X; }
+	FBox GetBrickBounds(int32 BrickIndex) const;
+	FIntVector GetBrickMin(int32 BrickIndex) const;
+
+	uint32 HashBrickCollision(int32 BrickIndex) const;
+	void QueryBrickOccupancy(int32 BrickIndex);
+	void ComputeSurface();
+	void RelaxFlow();
+	void WriteMergedGrid();
+
+	AEndFieldGridActor* Actor;
+	UWorld* World;
+	FIntVector RawSize;
+	FIntVector NumBricks;
+	int32 BrickSize;
+	int32 NumRebakedBricks;
+
+	TArray<uint8> Occupancy;
+	TArray<int32> SurfaceLevels;
+	TArray<FVector> Normals;
+	TArray<FVector> Flows;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "EndStreamableAssetRecorder.h"
+#include "EndStreamableAssetRecordCommandlet.generated.h"
+
+class UCameraComponent;
+struct FMinimalViewInfo;
+
+/*
+ * Regenerates UEndStreamableAssetPump prefetch lists by playing content headless and recording what the camera needs.
+ *
+ * Usage: -run=EndStreamableAssetRecord -Map=<map package> -Pump=<pump asset> (-Sequence=<level sequence> | -Spline=<actor name> -Speed=<cm/s>)
+ *   Map: World to load; every streaming level is loaded and made visible before recording.
+ *   Pump: UEndStreamableAssetPump asset that receives the merged FEndStreamableAssets records.
+ *   Sequence: Level sequence to play. Every camera cut starts a new CutIndex with the cut camera as ViewTarget.
+ *   Spline: Actor with a spline component to fly along instead of a sequence (gameplay path), at -Speed cm/s.
+ *   FrameRate: Capture rate, defaults to 30.
+ *   MassiveEnvironmentFilter: Static meshes whose path contains this are recorded as massive environment components
+ *     (StreamableMEComponents, with the mesh mips each cut needs) instead of plain static mesh entries.
+ *   Replace: Discard the pump's existing records instead of merging into them.
+ */
+UCLASS()
+class ENDEDITOR_API UEndStreamableAssetRecordCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UEndStreamableAssetRecordCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	UWorld* LoadWorld(const FString& MapName);
+	void UnloadWorld(UWorld* World);
+	bool RecordSequence(UWorld* World, const FString& SequenceName, float FrameRate);
+	bool RecordSpline(UWorld* World, const FString& ActorName, float Speed, float FrameRate);
+	void CaptureFrame(UWorld* World, const FMinimalViewInfo& View, float Time);
+
+	UFUNCTION()
+	void OnCameraCut(UCameraComponent* CameraComponent);
+
+	FEndStreamableAssetRecorder Recorder;
+
+	UPROPERTY(Transient)
+	UCameraComponent* CurrentCamera;
+
+	TArray<FString> MassiveEnvironmentPaths;
+	int32 NextCutIndex;
+	float CurrentTime;
+	int32 NumMassiveEnvironmentComponents;
+};
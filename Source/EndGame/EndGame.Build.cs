@@ -7,6 +7,7 @@ public class EndGame : ModuleRules {
         ShadowVariableWarningLevel = WarningLevel.Warning;
         
         PublicDependencyModuleNames.AddRange(new string[] {
+            "ACLPlugin",
             "AIModule",
             "AnimGraphRuntime",
             "AnimationBudgetAllocator",
@@ -1,6 +1,11 @@
 #include "EndAIController.h"
 #include "EndAIActionComponent.h"
 #include "EndAIMoveComponent.h"
+#include "EndNavGridActor.h"
+#include "EndNavGridTileStreamer.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "Navigation/PathFollowingComponent.h"
 
 AEndAIController::AEndAIController(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
     this->bSetControlRotationFromPawnOrientation = false;
@@ -11,6 +16,74 @@ AEndAIController::AEndAIController(const FObjectInitializer& ObjectInitializer)
     this->m_bUseFieldNavNotOnBattleNav = false;
     this->AIMoveComponent = CreateDefaultSubobject<UEndAIMoveComponent>(TEXT("EndAIMoveComponent"));
     this->AIActionComponent = CreateDefaultSubobject<UEndAIActionComponent>(TEXT("EndAIActionComponent"));
+    this->StreamedPathLayerID = INDEX_NONE;
 }
 
+void AEndAIController::OnPossess(APawn* InPawn) {
+    Super::OnPossess(InPawn);
+
+    // Stream in the nav grid layer this pawn paths on around it.
+    if (UEndNavGridTileStreamer* Streamer = GetWorld()->GetSubsystem<UEndNavGridTileStreamer>()) {
+        if (InPawn != NULL) {
+            Streamer->RegisterAgent(InPawn, Streamer->GetAgentLayer(InPawn));
+        }
+        if (!TileResidencyHandle.IsValid()) {
+            TileResidencyHandle = Streamer->OnTileResidencyChanged.AddUObject(this, &AEndAIController::OnNavTileResidencyChanged);
+        }
+    }
+}
+
+void AEndAIController::OnUnPossess() {
+    if (UEndNavGridTileStreamer* Streamer = GetWorld()->GetSubsystem<UEndNavGridTileStreamer>()) {
+        Streamer->UnregisterAgent(GetPawn());
+        Streamer->OnTileResidencyChanged.Remove(TileResidencyHandle);
+    }
+    TileResidencyHandle.Reset();
+    StreamedPathLayerID = INDEX_NONE;
+
+    Super::OnUnPossess();
+}
+
+FPathFollowingRequestResult AEndAIController::MoveTo(const FAIMoveRequest& MoveRequest, FNavPathSharedPtr* OutPath) {
+    const FPathFollowingRequestResult Result = Super::MoveTo(MoveRequest, OutPath);
+    StreamedMoveRequest = MoveRequest;
+    StreamedPathLayerID = GetNavQueryLayer();
+    return Result;
+}
+
+int32 AEndAIController::GetNavQueryLayer() const {
+    const UEndNavGridTileStreamer* Streamer = GetWorld()->GetSubsystem<UEndNavGridTileStreamer>();
+    const APawn* MyPawn = GetPawn();
+    if (Streamer == NULL || MyPawn == NULL) {
+        return INDEX_NONE;
+    }
+    return Streamer->GetQueryLayer(MyPawn->GetActorLocation(), Streamer->GetAgentLayer(MyPawn));
+}
+
+void AEndAIController::OnNavTileResidencyChanged(AEndNavGridActor* NavGrid, int32 TileIndex, UObject* TileAsset, bool bResident) {
+    const APawn* MyPawn = GetPawn();
+    UPathFollowingComponent* PathFollowing = GetPathFollowingComponent();
+    if (MyPawn == NULL || PathFollowing == NULL || GetMoveStatus() != EPathFollowingStatus::Moving || !StreamedMoveRequest.IsUsingPathfinding()) {
+        return;
+    }
+    if (NavGrid == NULL || !NavGrid->NavGrids.IsValidIndex(TileIndex) || !NavGrid->GetTileBounds(NavGrid->NavGrids[TileIndex]).IsInsideXY(MyPawn->GetActorLocation())) {
+        return;
+    }
+
+    // The tile under the pawn changed the layer queries run on: either the agent's own layer streamed in, or it went
+    // away and the coarse layer is the fallback. Re-run the path there without restarting the move request.
+    const int32 QueryLayerID = GetNavQueryLayer();
+    if (QueryLayerID == StreamedPathLayerID) {
+        return;
+    }
+
+    FPathFindingQuery Query;
+    FNavPathSharedPtr Path;
+    if (BuildPathfindingQuery(StreamedMoveRequest, Query)) {
+        FindPathForMoveRequest(StreamedMoveRequest, Query, Path);
+    }
+    if (Path.IsValid() && PathFollowing->UpdateMove(Path.ToSharedRef(), GetCurrentMoveRequestID())) {
+        StreamedPathLayerID = QueryLayerID;
+    }
+}
 
@@ -1,4 +1,5 @@
 #include "EndCharacterAnimInstance.h"
+#include "EndCharacterAnimInstanceProxy.h"
 
 UEndCharacterAnimInstance::UEndCharacterAnimInstance() {
     this->RootMotionMode = ERootMotionMode::RootMotionFromEverything;
@@ -66,4 +67,10 @@ EEndLocomotionAnimGroup UEndCharacterAnimInstance::GetLocomotionAnimGroupFromCac
     return EEndLocomotionAnimGroup::Idle;
 }
 
+FAnimInstanceProxy* UEndCharacterAnimInstance::CreateAnimInstanceProxy() {
+    return new FEndCharacterAnimInstanceProxy(this);
+}
 
+void UEndCharacterAnimInstance::DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) {
+    delete static_cast<FEndCharacterAnimInstanceProxy*>(InProxy);
+}
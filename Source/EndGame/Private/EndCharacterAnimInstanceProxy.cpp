@@ -1,5 +1,20 @@
 #include "EndCharacterAnimInstanceProxy.h"
+#include "Misc/Crc.h"
 
 FEndCharacterAnimInstanceProxy::FEndCharacterAnimInstanceProxy() {
 }
 
+FEndCharacterAnimInstanceProxy::FEndCharacterAnimInstanceProxy(UAnimInstance* Instance) : FAnimInstanceProxy(Instance) {
+}
+
+void FEndCharacterAnimInstanceProxy::EvaluateAnimationNode_WithRoot(FPoseContext& Output, FAnimNode_Base* InRootNode) {
+    // Cached pose track maps stay valid while the LOD's bone list and the mesh it indexes into are unchanged.
+    const FBoneContainer& RequiredBones = GetRequiredBones();
+    const TArray<FBoneIndexType>& BoneIndices = RequiredBones.GetBoneIndicesArray();
+    const uint32 RequiredBonesKey = FCrc::MemCrc32(BoneIndices.GetData(), BoneIndices.Num() * sizeof(FBoneIndexType), GetTypeHash(RequiredBones.GetAsset()));
+    DecompressionCache.SetRequiredBonesKey(RequiredBonesKey);
+
+    FACLDecompressionCacheScope DecompressionCacheScope(DecompressionCache);
+    FAnimInstanceProxy::EvaluateAnimationNode_WithRoot(Output, InRootNode);
+}
+
@@ -1,11 +1,44 @@
 #include "EndCinemaSequenceActor.h"
 #include "Components/SceneComponent.h"
 #include "EndCinemaSequencePlayer.h"
+#include "EndStreamableAssetPump.h"
 
 AEndCinemaSequenceActor::AEndCinemaSequenceActor(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer.SetDefaultSubobjectClass<UEndCinemaSequencePlayer>(TEXT("AnimationPlayer"))) {
     this->SequenceWrapper = NULL;
     this->LayoutOffsetComponent = CreateDefaultSubobject<USceneComponent>(TEXT("LayoutOffsetComponent"));
     this->LayoutOffsetComponent->SetupAttachment(RootComponent);
+    this->StreamableAssetPump = NULL;
+    this->LastPrefetchTime = 0.0f;
+    PrimaryActorTick.bCanEverTick = true;
+}
+
+void AEndCinemaSequenceActor::Tick(float DeltaSeconds) {
+    Super::Tick(DeltaSeconds);
+
+    UpdatePrefetch();
+}
+
+void AEndCinemaSequenceActor::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+    Prefetcher.End();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AEndCinemaSequenceActor::UpdatePrefetch() {
+    const ULevelSequencePlayer* Player = GetSequencePlayer();
+    if (StreamableAssetPump == NULL || Player == NULL || !Player->IsPlaying()) {
+        Prefetcher.End();
+        return;
+    }
+
+    // Restart the walk on the first playing frame and whenever playback jumps backwards (loops, scrubbing, skips to an
+    // earlier cut); forward jumps just issue everything up to the new time.
+    const float PlaybackTime = (float)Player->GetCurrentTime().AsSeconds();
+    if (!Prefetcher.IsActive() || PlaybackTime < LastPrefetchTime) {
+        Prefetcher.Begin(StreamableAssetPump, PlaybackTime);
+    }
+    LastPrefetchTime = PlaybackTime;
+    Prefetcher.Update(PlaybackTime);
 }
 
 
@@ -1,6 +1,14 @@
 #include "EndFieldGridActor.h"
 #include "Components/ArrowComponent.h"
 
+namespace EndFieldGridLegacy {
+    // One GridInfos_ / GridNormalInfos_ entry: X, Y and Z in the low three bytes, each biased by 128 over [-127, 127],
+    // the surface level in the top byte.
+    static FVector DecodeVector(uint32 Info) {
+        return FVector((int32)(Info & 0xFF) - 128, (int32)((Info >> 8) & 0xFF) - 128, (int32)((Info >> 16) & 0xFF) - 128) / 127.0f;
+    }
+}
+
 AEndFieldGridActor::AEndFieldGridActor(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
     this->SaveFlow = true;
     this->SaveNormal = false;
@@ -15,8 +23,98 @@ AEndFieldGridActor::AEndFieldGridActor(const FObjectInitializer& ObjectInitializ
     this->FlowSpeed = 500.00f;
     this->SurfaceRange = 500.00f;
     this->StepNum = 3;
+    this->bUsePackedGrid = false;
+    this->PackedGridNum_ = FIntVector::ZeroValue;
+#if WITH_EDITORONLY_DATA
+    this->BakedRawGridNum_ = FIntVector::ZeroValue;
+    this->BakedBrickSize_ = 0;
+#endif
     this->ArrowComponent = CreateDefaultSubobject<UArrowComponent>(TEXT("Arrow"));
     this->ArrowComponent->SetupAttachment(RootComponent);
 }
 
+void AEndFieldGridActor::PostInitializeComponents() {
+    Super::PostInitializeComponents();
+    RebuildPackedGrid();
+}
+
+void AEndFieldGridActor::RebuildPackedGrid() {
+    if (bUsePackedGrid) {
+        PackedGrid.Build(PackedGridCells_, PackedGridNum_, FlowSpeed);
+    } else {
+        PackedGrid.Reset();
+    }
+}
+
+float AEndFieldGridActor::GetCellSize() const {
+    return UnitLength * FMath::Max(MergeNum, 1u);
+}
+
+FIntVector AEndFieldGridActor::GetGridNum() const {
+    return bUsePackedGrid ? PackedGridNum_ : FIntVector((int32)GridNumX, (int32)GridNumY, (int32)GridNumZ);
+}
+
+FVector AEndFieldGridActor::GetGridOrigin() const {
+    // Origin is the center of cell (0, 0, 0), which is where the sampler puts integer coordinates.
+    const float CellSize = GetCellSize();
+    return GetActorLocation() - FVector(GetGridNum()) * (CellSize * 0.5f) + FVector(CellSize * 0.5f);
+}
+
+void AEndFieldGridActor::SampleFields(TArrayView<const FVector> Positions, TArrayView<FVector> OutFlows, TArrayView<FVector> OutNormals) const {
+    check(OutFlows.Num() == Positions.Num() && (OutNormals.Num() == 0 || OutNormals.Num() == Positions.Num()));
+    if (!bUsePackedGrid) {
+        SampleLegacyFields(Positions, OutFlows, OutNormals);
+        return;
+    }
+    PackedGrid.SampleBatch(Positions.GetData(), Positions.Num(), GetGridOrigin(), 1.0f / GetCellSize(), OutFlows.GetData(), OutNormals.Num() > 0 ? OutNormals.GetData() : NULL, NULL);
+}
+
+void AEndFieldGridActor::SampleLegacyFields(TArrayView<const FVector> Positions, TArrayView<FVector> OutFlows, TArrayView<FVector> OutNormals) const {
+    const FIntVector GridNum = GetGridNum();
+    const int64 NumCells = (int64)GridNum.X * GridNum.Y * GridNum.Z;
+    const bool bHasFlow = NumCells > 0 && GridInfos_.Num() == NumCells;
+    const bool bHasNormals = NumCells > 0 && OutNormals.Num() > 0 && GridNormalInfos_.Num() == NumCells;
+    const FVector Origin = GetGridOrigin();
+    const float InvCellSize = 1.0f / GetCellSize();
+
+    for (int32 Index = 0; Index < Positions.Num(); ++Index) {
+        FVector Flow = FVector::ZeroVector;
+        FVector Normal = FVector::ZeroVector;
+        if (bHasFlow || bHasNormals) {
+            // Same placement and border clamping as FEndFieldPackedGrid::SampleBatch.
+            const FVector Local = (Positions[Index] - Origin) * InvCellSize;
+            const float LocalX = FMath::Clamp(Local.X, 0.0f, (float)(GridNum.X - 1));
+            const float LocalY = FMath::Clamp(Local.Y, 0.0f, (float)(GridNum.Y - 1));
+            const float LocalZ = FMath::Clamp(Local.Z, 0.0f, (float)(GridNum.Z - 1));
+            const int32 CornerX[2] = {(int32)LocalX, FMath::Min((int32)LocalX + 1, GridNum.X - 1)};
+            const int32 CornerY[2] = {(int32)LocalY, FMath::Min((int32)LocalY + 1, GridNum.Y - 1)};
+            const int32 CornerZ[2] = {(int32)LocalZ, FMath::Min((int32)LocalZ + 1, GridNum.Z - 1)};
+            const float WeightX[2] = {1.0f - (LocalX - CornerX[0]), LocalX - CornerX[0]};
+            const float WeightY[2] = {1.0f - (LocalY - CornerY[0]), LocalY - CornerY[0]};
+            const float WeightZ[2] = {1.0f - (LocalZ - CornerZ[0]), LocalZ - CornerZ[0]};
+
+            for (int32 Corner = 0; Corner < 8; ++Corner) {
+                const int32 CellIndex = CornerX[Corner & 1] + (CornerY[(Corner >> 1) & 1] + CornerZ[Corner >> 2] * GridNum.Y) * GridNum.X;
+                const float Weight = WeightX[Corner & 1] * WeightY[(Corner >> 1) & 1] * WeightZ[Corner >> 2];
+                if (bHasFlow) {
+                    Flow += EndFieldGridLegacy::DecodeVector(GridInfos_[CellIndex]) * Weight;
+                }
+                if (bHasNormals) {
+                    Normal += EndFieldGridLegacy::DecodeVector(GridNormalInfos_[CellIndex]) * Weight;
+                }
+            }
+        }
+
+        OutFlows[Index] = Flow * FlowSpeed;
+        if (OutNormals.Num() > 0) {
+            OutNormals[Index] = Normal.GetSafeNormal();
+        }
+    }
+}
+
+FVector AEndFieldGridActor::SampleFlow(const FVector& Position) const {
+    FVector Flow;
+    SampleFields(MakeArrayView(&Position, 1), MakeArrayView(&Flow, 1), TArrayView<FVector>());
+    return Flow;
+}
 
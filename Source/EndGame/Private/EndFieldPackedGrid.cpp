@@ -0,0 +1,173 @@
+#include "EndFieldPackedGrid.h"
+
+static_assert(sizeof(FEndFieldPackedGrid::FCell) == 8, "Field cells are sampled as two signed byte quads");
+
+namespace EndFieldGrid {
+    static const uint32 MortonSpread2[4] = {0, 1, 8, 9};
+
+    static FORCEINLINE int8 Quantize(float Value) {
+        return (int8)FMath::Clamp(FMath::RoundToInt(Value * 127.0f), -127, 127);
+    }
+}
+
+FEndFieldPackedGrid::FEndFieldPackedGrid()
+    : GridSize(FIntVector::ZeroValue)
+    , BrickCount(FIntVector::ZeroValue)
+    , FlowScale(1.0f) {
+}
+
+void FEndFieldPackedGrid::Reset() {
+    Cells.Reset();
+    GridSize = FIntVector::ZeroValue;
+    BrickCount = FIntVector::ZeroValue;
+}
+
+uint64 FEndFieldPackedGrid::EncodeCell(const FVector& UnitFlow, const FVector& Normal, int32 SurfaceLevel) {
+    FCell Cell;
+    Cell.Flow[0] = EndFieldGrid::Quantize(UnitFlow.X);
+    Cell.Flow[1] = EndFieldGrid::Quantize(UnitFlow.Y);
+    Cell.Flow[2] = EndFieldGrid::Quantize(UnitFlow.Z);
+    Cell.SurfaceLevel = (int8)FMath::Clamp(SurfaceLevel, 0, 127);
+    Cell.Normal[0] = EndFieldGrid::Quantize(Normal.X);
+    Cell.Normal[1] = EndFieldGrid::Quantize(Normal.Y);
+    Cell.Normal[2] = EndFieldGrid::Quantize(Normal.Z);
+    Cell.Pad = 0;
+
+    uint64 Encoded;
+    FMemory::Memcpy(&Encoded, &Cell, sizeof(Encoded));
+    return Encoded;
+}
+
+void FEndFieldPackedGrid::Build(const TArray<uint64>& LinearCells, const FIntVector& InGridSize, float InFlowScale) {
+    Reset();
+
+    const int64 NumCells = (int64)InGridSize.X * InGridSize.Y * InGridSize.Z;
+    if (InGridSize.X <= 0 || InGridSize.Y <= 0 || InGridSize.Z <= 0 || LinearCells.Num() != NumCells) {
+        return;
+    }
+
+    GridSize = InGridSize;
+    FlowScale = InFlowScale;
+    BrickCount = FIntVector(
+        (GridSize.X + (1 << BrickShift) - 1) >> BrickShift,
+        (GridSize.Y + (1 << BrickShift) - 1) >> BrickShift,
+        (GridSize.Z + (1 << BrickShift) - 1) >> BrickShift);
+    Cells.SetNumZeroed(BrickCount.X * BrickCount.Y * BrickCount.Z * BrickCells);
+
+    // Padding cells in partial bricks stay zeroed; sampling clamps before it could reach them.
+    int32 SourceIndex = 0;
+    for (int32 Z = 0; Z < GridSize.Z; ++Z) {
+        for (int32 Y = 0; Y < GridSize.Y; ++Y) {
+            for (int32 X = 0; X < GridSize.X; ++X, ++SourceIndex) {
+                FMemory::Memcpy(&Cells[GetCellIndex(X, Y, Z)], &LinearCells[SourceIndex], sizeof(FCell));
+            }
+        }
+    }
+}
+
+int32 FEndFieldPackedGrid::GetCellIndex(int32 X, int32 Y, int32 Z) const {
+    const int32 BrickIndex = (X >> BrickShift) + ((Y >> BrickShift) + (Z >> BrickShift) * BrickCount.Y) * BrickCount.X;
+    const uint32 Morton = EndFieldGrid::MortonSpread2[X & 3] | (EndFieldGrid::MortonSpread2[Y & 3] << 1) | (EndFieldGrid::MortonSpread2[Z & 3] << 2);
+    return BrickIndex * BrickCells + (int32)Morton;
+}
+
+void FEndFieldPackedGrid::SampleBatch(const FVector* Positions, int32 Num, const FVector& Origin, float InvCellSize, FVector* OutFlows, FVector* OutNormals, float* OutSurfaceLevels) const {
+    if (Cells.Num() == 0) {
+        for (int32 Index = 0; Index < Num; ++Index) {
+            OutFlows[Index] = FVector::ZeroVector;
+            if (OutNormals != NULL) {
+                OutNormals[Index] = FVector::ZeroVector;
+            }
+            if (OutSurfaceLevels != NULL) {
+                OutSurfaceLevels[Index] = 0.0f;
+            }
+        }
+        return;
+    }
+
+    const VectorRegister FlowDequantize = MakeVectorRegister(FlowScale / 127.0f, FlowScale / 127.0f, FlowScale / 127.0f, 1.0f);
+    const VectorRegister NormalDequantize = VectorSetFloat1(1.0f / 127.0f);
+
+    auto SampleOne = [&](int32 Index, int32 X0, int32 Y0, int32 Z0, float FracX, float FracY, float FracZ) {
+        const int32 X1 = FMath::Min(X0 + 1, GridSize.X - 1);
+        const int32 Y1 = FMath::Min(Y0 + 1, GridSize.Y - 1);
+        const int32 Z1 = FMath::Min(Z0 + 1, GridSize.Z - 1);
+        const int32 CornerX[2] = {X0, X1};
+        const int32 CornerY[2] = {Y0, Y1};
+        const int32 CornerZ[2] = {Z0, Z1};
+        const float WeightX[2] = {1.0f - FracX, FracX};
+        const float WeightY[2] = {1.0f - FracY, FracY};
+        const float WeightZ[2] = {1.0f - FracZ, FracZ};
+
+        VectorRegister Flow = VectorZero();
+        VectorRegister Normal = VectorZero();
+        for (int32 Corner = 0; Corner < 8; ++Corner) {
+            const FCell& Cell = Cells[GetCellIndex(CornerX[Corner & 1], CornerY[(Corner >> 1) & 1], CornerZ[Corner >> 2])];
+            const VectorRegister Weight = VectorSetFloat1(WeightX[Corner & 1] * WeightY[(Corner >> 1) & 1] * WeightZ[Corner >> 2]);
+            Flow = VectorMultiplyAdd(VectorLoadSignedByte4(Cell.Flow), Weight, Flow);
+            Normal = VectorMultiplyAdd(VectorLoadSignedByte4(Cell.Normal), Weight, Normal);
+        }
+
+        Flow = VectorMultiply(Flow, FlowDequantize);
+        VectorStoreFloat3(Flow, &OutFlows[Index]);
+        if (OutSurfaceLevels != NULL) {
+            OutSurfaceLevels[Index] = VectorGetComponent(Flow, 3);
+        }
+        if (OutNormals != NULL) {
+            FVector SampledNormal;
+            VectorStoreFloat3(VectorMultiply(Normal, NormalDequantize), &SampledNormal);
+            OutNormals[Index] = SampledNormal.GetSafeNormal();
+        }
+    };
+
+    const VectorRegister Zero = VectorZero();
+    const VectorRegister InvCell = VectorSetFloat1(InvCellSize);
+    const VectorRegister OriginX = VectorSetFloat1(Origin.X);
+    const VectorRegister OriginY = VectorSetFloat1(Origin.Y);
+    const VectorRegister OriginZ = VectorSetFloat1(Origin.Z);
+    const VectorRegister MaxX = VectorSetFloat1((float)(GridSize.X - 1));
+    const VectorRegister MaxY = VectorSetFloat1((float)(GridSize.Y - 1));
+    const VectorRegister MaxZ = VectorSetFloat1((float)(GridSize.Z - 1));
+
+    int32 Index = 0;
+    for (; Index + 4 <= Num; Index += 4) {
+        const FVector* P = Positions + Index;
+
+        // Grid coordinates for four positions at once; clamped to >= 0 first, so truncation matches floor.
+        const VectorRegister LocalX = VectorMin(VectorMax(VectorMultiply(VectorSubtract(MakeVectorRegister(P[0].X, P[1].X, P[2].X, P[3].X), OriginX), InvCell), Zero), MaxX);
+        const VectorRegister LocalY = VectorMin(VectorMax(VectorMultiply(VectorSubtract(MakeVectorRegister(P[0].Y, P[1].Y, P[2].Y, P[3].Y), OriginY), InvCell), Zero), MaxY);
+        const VectorRegister LocalZ = VectorMin(VectorMax(VectorMultiply(VectorSubtract(MakeVectorRegister(P[0].Z, P[1].Z, P[2].Z, P[3].Z), OriginZ), InvCell), Zero), MaxZ);
+        const VectorRegisterInt CellX = VectorFloatToInt(LocalX);
+        const VectorRegisterInt CellY = VectorFloatToInt(LocalY);
+        const VectorRegisterInt CellZ = VectorFloatToInt(LocalZ);
+
+        MS_ALIGN(16) int32 X0[4] GCC_ALIGN(16);
+        MS_ALIGN(16) int32 Y0[4] GCC_ALIGN(16);
+        MS_ALIGN(16) int32 Z0[4] GCC_ALIGN(16);
+        MS_ALIGN(16) float FracX[4] GCC_ALIGN(16);
+        MS_ALIGN(16) float FracY[4] GCC_ALIGN(16);
+        MS_ALIGN(16) float FracZ[4] GCC_ALIGN(16);
+        VectorIntStoreAligned(CellX, X0);
+        VectorIntStoreAligned(CellY, Y0);
+        VectorIntStoreAligned(CellZ, Z0);
+        VectorStoreAligned(VectorSubtract(LocalX, VectorIntToFloat(CellX)), FracX);
+        VectorStoreAligned(VectorSubtract(LocalY, VectorIntToFloat(CellY)), FracY);
+        VectorStoreAligned(VectorSubtract(LocalZ, VectorIntToFloat(CellZ)), FracZ);
+
+        for (int32 Lane = 0; Lane < 4; ++Lane) {
+            SampleOne(Index + Lane, X0[Lane], Y0[Lane], Z0[Lane], FracX[Lane], FracY[Lane], FracZ[Lane]);
+        }
+    }
+
+    for (; Index < Num; ++Index) {
+        const FVector Local = (Positions[Index] - Origin) * InvCellSize;
+        const float LocalX = FMath::Clamp(Local.X, 0.0f, (float)(GridSize.X - 1));
+        const float LocalY = FMath::Clamp(Local.Y, 0.0f, (float)(GridSize.Y - 1));
+        const float LocalZ = FMath::Clamp(Local.Z, 0.0f, (float)(GridSize.Z - 1));
+        const int32 X0 = (int32)LocalX;
+        const int32 Y0 = (int32)LocalY;
+        const int32 Z0 = (int32)LocalZ;
+        SampleOne(Index, X0, Y0, Z0, LocalX - X0, LocalY - Y0, LocalZ - Z0);
+    }
+}
+
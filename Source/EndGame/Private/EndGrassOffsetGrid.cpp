@@ -1,5 +1,10 @@
 #include "EndGrassOffsetGrid.h"
 #include "Components/SceneComponent.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogEndGrassOffsetGrid, Log, All);
 
 AEndGrassOffsetGrid::AEndGrassOffsetGrid(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
     this->RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("SceneComp"));
@@ -10,4 +15,81 @@ AEndGrassOffsetGrid::AEndGrassOffsetGrid(const FObjectInitializer& ObjectInitial
     this->TreeLevel_ = 0;
 }
 
+void AEndGrassOffsetGrid::PostInitializeComponents() {
+    Super::PostInitializeComponents();
+    RebuildCompactTree();
+}
+
+void AEndGrassOffsetGrid::RebuildCompactTree() {
+    if (!CompactTree.Build(InfoTreeNodes_, TreeLevel_) && InfoTreeNodes_.Num() > 0) {
+        UE_LOG(LogEndGrassOffsetGrid, Warning, TEXT("%s: %d octree nodes do not fit the compact layout"), *GetName(), InfoTreeNodes_.Num());
+    }
+}
+
+void AEndGrassOffsetGrid::LookupOffsets(TArrayView<const FVector> Positions, TArrayView<int8> OutValues) const {
+    check(Positions.Num() == OutValues.Num());
+    const FIntVector GridSize((int32)GridNumX, (int32)GridNumY, (int32)GridNumZ);
+    CompactTree.LookupBatch(Positions.GetData(), Positions.Num(), GetActorLocation(), 1.0f / UnitLength, GridSize, OutValues.GetData());
+}
+
+int8 AEndGrassOffsetGrid::LookupOffset(const FVector& Position) const {
+    int8 Value = 0;
+    LookupOffsets(MakeArrayView(&Position, 1), MakeArrayView(&Value, 1));
+    return Value;
+}
+
+namespace EndGrassOffsetGrid {
+    static void Benchmark(const TArray<FString>& Args, UWorld* World) {
+        const int32 NumQueries = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 4) : 1 << 20;
+
+        for (TActorIterator<AEndGrassOffsetGrid> It(World); It; ++It) {
+            const AEndGrassOffsetGrid* Grid = *It;
+            const FVector Origin = Grid->GetActorLocation();
+            const FVector Extent = FVector((float)Grid->GridNumX, (float)Grid->GridNumY, (float)Grid->GridNumZ) * Grid->UnitLength;
+
+            SIZE_T LegacyBytes = Grid->InfoTreeNodes_.GetAllocatedSize();
+            for (const FGrassGridOctTreeNode& Node : Grid->InfoTreeNodes_) {
+                LegacyBytes += Node.ChildIndicies_.GetAllocatedSize();
+            }
+
+            FRandomStream Random(0x6EA55);
+            TArray<FVector> Positions;
+            Positions.SetNumUninitialized(NumQueries);
+            for (FVector& Position : Positions) {
+                Position = Origin + FVector(Random.FRand() * Extent.X, Random.FRand() * Extent.Y, Random.FRand() * Extent.Z);
+            }
+
+            TArray<int8> LegacyValues;
+            TArray<int8> CompactValues;
+            LegacyValues.SetNumUninitialized(NumQueries);
+            CompactValues.SetNumUninitialized(NumQueries);
+
+            const float InvUnitLength = 1.0f / Grid->UnitLength;
+            double StartTime = FPlatformTime::Seconds();
+            for (int32 Index = 0; Index < NumQueries; ++Index) {
+                const FVector Local = (Positions[Index] - Origin) * InvUnitLength;
+                LegacyValues[Index] = FEndGrassOffsetOctree::LookupNodes(Grid->InfoTreeNodes_, Grid->TreeLevel_, (uint32)Local.X, (uint32)Local.Y, (uint32)Local.Z);
+            }
+            const double LegacySeconds = FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            Grid->LookupOffsets(Positions, CompactValues);
+            const double CompactSeconds = FPlatformTime::Seconds() - StartTime;
+
+            int32 NumMismatches = 0;
+            for (int32 Index = 0; Index < NumQueries; ++Index) {
+                NumMismatches += LegacyValues[Index] != CompactValues[Index] ? 1 : 0;
+            }
+
+            UE_LOG(LogEndGrassOffsetGrid, Display, TEXT("%s: %d nodes, %llu -> %llu bytes, %d queries: nodes %.2f Mq/s, compact batch %.2f Mq/s, %d mismatches"),
+                *Grid->GetName(), Grid->InfoTreeNodes_.Num(), (uint64)LegacyBytes, (uint64)Grid->GetCompactTree().GetAllocatedSize(), NumQueries,
+                NumQueries / FMath::Max(LegacySeconds, 1e-9) / 1e6, NumQueries / FMath::Max(CompactSeconds, 1e-9) / 1e6, NumMismatches);
+        }
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CmdEndGrassOffsetGridBenchmark(
+    TEXT("end.GrassOffsetGrid.Benchmark"),
+    TEXT("Compares memory and lookup throughput of the authored and compact grass offset octrees. Usage: end.GrassOffsetGrid.Benchmark [NumQueries]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&EndGrassOffsetGrid::Benchmark));
 
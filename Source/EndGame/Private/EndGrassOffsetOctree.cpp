@@ -0,0 +1,209 @@
+#include "EndGrassOffsetOctree.h"
+#include "GrassGridOctTreeNode.h"
+
+FEndGrassOffsetOctree::FEndGrassOffsetOctree()
+    : Depth(0) {
+}
+
+void FEndGrassOffsetOctree::Reset() {
+    Nodes.Reset();
+    Links.Reset();
+    Values.Reset();
+    Depth = 0;
+}
+
+bool FEndGrassOffsetOctree::Build(const TArray<FGrassGridOctTreeNode>& InNodes, uint8 TreeLevel) {
+    Reset();
+    if (InNodes.Num() == 0) {
+        return false;
+    }
+
+    // Breadth first over distinct nodes. A child reached again (shared subtree, or a cycle the depth bound cuts off)
+    // gets a link to the node already emitted for it.
+    TArray<int32> SourceIndices;
+    TArray<int32> FlatIndices;
+    FlatIndices.Init(INDEX_NONE, InNodes.Num());
+    SourceIndices.Reserve(InNodes.Num());
+    Nodes.Reserve(InNodes.Num());
+    Values.Reserve(InNodes.Num());
+    Links.Reserve(InNodes.Num());
+
+    SourceIndices.Add(0);
+    Nodes.Add(0);
+    Values.Add(InNodes[0].Value_);
+    FlatIndices[0] = 0;
+
+    for (int32 NodeIndex = 0; NodeIndex < SourceIndices.Num(); ++NodeIndex) {
+        const FGrassGridOctTreeNode& Source = InNodes[SourceIndices[NodeIndex]];
+        const uint32 FirstLink = (uint32)Links.Num();
+        uint32 ChildMask = 0;
+
+        const int32 NumChildren = FMath::Min(Source.ChildIndicies_.Num(), 8);
+        for (int32 Octant = 0; Octant < NumChildren; ++Octant) {
+            const uint32 ChildIndex = Source.ChildIndicies_[Octant];
+            if (!InNodes.IsValidIndex((int32)ChildIndex)) {
+                continue;
+            }
+            if (FlatIndices[ChildIndex] == INDEX_NONE) {
+                FlatIndices[ChildIndex] = Nodes.Num();
+                SourceIndices.Add((int32)ChildIndex);
+                Nodes.Add(0);
+                Values.Add(InNodes[ChildIndex].Value_);
+            }
+            ChildMask |= 1u << Octant;
+            Links.Add((uint32)FlatIndices[ChildIndex]);
+        }
+
+        if (ChildMask != 0 && FirstLink > MaxFirstLink) {
+            Reset();
+            return false;
+        }
+        Nodes[NodeIndex] = (FirstLink << ChildMaskBits) | ChildMask;
+    }
+
+    Depth = TreeLevel;
+    return true;
+}
+
+int8 FEndGrassOffsetOctree::Lookup(uint32 CellX, uint32 CellY, uint32 CellZ) const {
+    if (Nodes.Num() == 0) {
+        return 0;
+    }
+
+    uint32 NodeIndex = 0;
+    for (int32 Level = (int32)Depth - 1; Level >= 0; --Level) {
+        const uint32 Packed = Nodes[NodeIndex];
+        const uint32 ChildMask = Packed & 0xFF;
+        const uint32 Octant = ((CellX >> Level) & 1) | (((CellY >> Level) & 1) << 1) | (((CellZ >> Level) & 1) << 2);
+        if ((ChildMask & (1u << Octant)) == 0) {
+            break;
+        }
+        NodeIndex = Links[(Packed >> ChildMaskBits) + FPlatformMath::CountBits(ChildMask & ((1u << Octant) - 1))];
+    }
+    return Values[NodeIndex];
+}
+
+int8 FEndGrassOffsetOctree::LookupNodes(const TArray<FGrassGridOctTreeNode>& InNodes, uint8 TreeLevel, uint32 CellX, uint32 CellY, uint32 CellZ) {
+    if (InNodes.Num() == 0) {
+        return 0;
+    }
+    int32 NodeIndex = 0;
+    for (int32 Level = (int32)TreeLevel - 1; Level >= 0; --Level) {
+        const TArray<uint32>& Children = InNodes[NodeIndex].ChildIndicies_;
+        const int32 Octant = ((CellX >> Level) & 1) | (((CellY >> Level) & 1) << 1) | (((CellZ >> Level) & 1) << 2);
+        if (!Children.IsValidIndex(Octant) || !InNodes.IsValidIndex((int32)Children[Octant])) {
+            break;
+        }
+        NodeIndex = (int32)Children[Octant];
+    }
+    return InNodes[NodeIndex].Value_;
+}
+
+void FEndGrassOffsetOctree::LookupBatch(const FVector* Positions, int32 Num, const FVector& Origin, float InvUnitLength, const FIntVector& GridSize, int8* OutValues) const {
+    if (Nodes.Num() == 0) {
+        FMemory::Memzero(OutValues, Num);
+        return;
+    }
+
+    const VectorRegister Zero = VectorZero();
+    const VectorRegister InvUnit = VectorSetFloat1(InvUnitLength);
+    const VectorRegister OriginX = VectorSetFloat1(Origin.X);
+    const VectorRegister OriginY = VectorSetFloat1(Origin.Y);
+    const VectorRegister OriginZ = VectorSetFloat1(Origin.Z);
+    const VectorRegister SizeX = VectorSetFloat1((float)GridSize.X);
+    const VectorRegister SizeY = VectorSetFloat1((float)GridSize.Y);
+    const VectorRegister SizeZ = VectorSetFloat1((float)GridSize.Z);
+
+    const VectorRegisterInt IntZero = MakeVectorRegisterInt(0, 0, 0, 0);
+    const VectorRegisterInt IntOne = MakeVectorRegisterInt(1, 1, 1, 1);
+    const VectorRegisterInt ChildMaskMask = MakeVectorRegisterInt(0xFF, 0xFF, 0xFF, 0xFF);
+    const VectorRegisterInt Bits55 = MakeVectorRegisterInt(0x55, 0x55, 0x55, 0x55);
+    const VectorRegisterInt Bits33 = MakeVectorRegisterInt(0x33, 0x33, 0x33, 0x33);
+    const VectorRegisterInt Bits0F = MakeVectorRegisterInt(0x0F, 0x0F, 0x0F, 0x0F);
+
+    // Build() guarantees every stored index is in range, the per lane fetches skip the range checks.
+    const uint32* NodeData = Nodes.GetData();
+    const uint32* LinkData = Links.GetData();
+    const int8* ValueData = Values.GetData();
+
+    int32 Index = 0;
+    for (; Index + 4 <= Num; Index += 4) {
+        const FVector* P = Positions + Index;
+
+        // Cell coordinates and bounds for four positions at once. Lanes are in range before the truncating convert,
+        // so truncation matches floor.
+        const VectorRegister LocalX = VectorMultiply(VectorSubtract(MakeVectorRegister(P[0].X, P[1].X, P[2].X, P[3].X), OriginX), InvUnit);
+        const VectorRegister LocalY = VectorMultiply(VectorSubtract(MakeVectorRegister(P[0].Y, P[1].Y, P[2].Y, P[3].Y), OriginY), InvUnit);
+        const VectorRegister LocalZ = VectorMultiply(VectorSubtract(MakeVectorRegister(P[0].Z, P[1].Z, P[2].Z, P[3].Z), OriginZ), InvUnit);
+
+        VectorRegister InBounds = VectorBitwiseAnd(VectorCompareGE(LocalX, Zero), VectorCompareGT(SizeX, LocalX));
+        InBounds = VectorBitwiseAnd(InBounds, VectorBitwiseAnd(VectorCompareGE(LocalY, Zero), VectorCompareGT(SizeY, LocalY)));
+        InBounds = VectorBitwiseAnd(InBounds, VectorBitwiseAnd(VectorCompareGE(LocalZ, Zero), VectorCompareGT(SizeZ, LocalZ)));
+        const uint32 LaneMask = (uint32)VectorMaskBits(InBounds);
+        if (LaneMask == 0) {
+            FMemory::Memzero(OutValues + Index, 4);
+            continue;
+        }
+
+        const VectorRegisterInt CellX = VectorFloatToInt(LocalX);
+        const VectorRegisterInt CellY = VectorFloatToInt(LocalY);
+        const VectorRegisterInt CellZ = VectorFloatToInt(LocalZ);
+
+        // All four lanes descend one level per iteration. The child test, the rank of the octant among the node's
+        // children and the link index are computed for the four lanes at once; only the node and link fetches, which
+        // SSE cannot gather, stay per lane.
+        MS_ALIGN(16) uint32 NodeIndex[4] GCC_ALIGN(16) = {0, 0, 0, 0};
+        MS_ALIGN(16) uint32 Packed[4] GCC_ALIGN(16);
+        MS_ALIGN(16) uint32 LinkIndex[4] GCC_ALIGN(16);
+        MS_ALIGN(16) int32 Descend[4] GCC_ALIGN(16);
+        VectorRegisterInt Active = MakeVectorRegisterInt(-(int32)(LaneMask & 1), -(int32)((LaneMask >> 1) & 1), -(int32)((LaneMask >> 2) & 1), -(int32)((LaneMask >> 3) & 1));
+        for (int32 Level = (int32)Depth - 1; Level >= 0; --Level) {
+            for (int32 Lane = 0; Lane < 4; ++Lane) {
+                Packed[Lane] = NodeData[NodeIndex[Lane]];
+            }
+            const VectorRegisterInt PackedNodes = VectorIntLoadAligned(Packed);
+            const VectorRegisterInt ChildMask = VectorIntAnd(PackedNodes, ChildMaskMask);
+
+            // 1 << Octant with Octant = X | Y << 1 | Z << 2, built from the cell bits of this level.
+            const int32 LevelBit = 1 << Level;
+            const VectorRegisterInt LevelBits = MakeVectorRegisterInt(LevelBit, LevelBit, LevelBit, LevelBit);
+            VectorRegisterInt OctantBit = IntOne;
+            OctantBit = VectorIntSelect(VectorIntCompareNEQ(VectorIntAnd(CellX, LevelBits), IntZero), VectorShiftLeftImm(OctantBit, 1), OctantBit);
+            OctantBit = VectorIntSelect(VectorIntCompareNEQ(VectorIntAnd(CellY, LevelBits), IntZero), VectorShiftLeftImm(OctantBit, 2), OctantBit);
+            OctantBit = VectorIntSelect(VectorIntCompareNEQ(VectorIntAnd(CellZ, LevelBits), IntZero), VectorShiftLeftImm(OctantBit, 4), OctantBit);
+
+            Active = VectorIntAnd(Active, VectorIntCompareNEQ(VectorIntAnd(ChildMask, OctantBit), IntZero));
+            VectorIntStoreAligned(Active, Descend);
+            if ((Descend[0] | Descend[1] | Descend[2] | Descend[3]) == 0) {
+                break;
+            }
+
+            // Children of the node below the octant, an 8 bit population count.
+            VectorRegisterInt Rank = VectorIntAnd(ChildMask, VectorIntSubtract(OctantBit, IntOne));
+            Rank = VectorIntSubtract(Rank, VectorIntAnd(VectorShiftRightImmLogical(Rank, 1), Bits55));
+            Rank = VectorIntAdd(VectorIntAnd(Rank, Bits33), VectorIntAnd(VectorShiftRightImmLogical(Rank, 2), Bits33));
+            Rank = VectorIntAnd(VectorIntAdd(Rank, VectorShiftRightImmLogical(Rank, 4)), Bits0F);
+            VectorIntStoreAligned(VectorIntAdd(VectorShiftRightImmLogical(PackedNodes, ChildMaskBits), Rank), LinkIndex);
+
+            for (int32 Lane = 0; Lane < 4; ++Lane) {
+                if (Descend[Lane] != 0) {
+                    NodeIndex[Lane] = LinkData[LinkIndex[Lane]];
+                }
+            }
+        }
+
+        for (int32 Lane = 0; Lane < 4; ++Lane) {
+            OutValues[Index + Lane] = (LaneMask & (1u << Lane)) != 0 ? ValueData[NodeIndex[Lane]] : 0;
+        }
+    }
+
+    for (; Index < Num; ++Index) {
+        const FVector Local = (Positions[Index] - Origin) * InvUnitLength;
+        if (Local.X >= 0.0f && Local.Y >= 0.0f && Local.Z >= 0.0f && Local.X < GridSize.X && Local.Y < GridSize.Y && Local.Z < GridSize.Z) {
+            OutValues[Index] = Lookup((uint32)Local.X, (uint32)Local.Y, (uint32)Local.Z);
+        } else {
+            OutValues[Index] = 0;
+        }
+    }
+}
+
@@ -1,18 +1,95 @@
 #include "EndLevelLoader.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EndLevelStreamingScheduler.h"
+#include "LatentActions.h"
+
+namespace EndLevelLoader {
+    // Completes once every scheduler ticket it holds is done, or (with no tickets) once the scheduler and the
+    // engine have nothing left to stream.
+    class FStreamLevelAction : public FPendingLatentAction {
+    public:
+        FStreamLevelAction(UEndLevelStreamingScheduler* InScheduler, const FLatentActionInfo& LatentInfo)
+            : Scheduler(InScheduler)
+            , ExecutionFunction(LatentInfo.ExecutionFunction)
+            , OutputLink(LatentInfo.Linkage)
+            , CallbackTarget(LatentInfo.CallbackTarget) {
+        }
+
+        virtual void UpdateOperation(FLatentResponse& Response) override {
+            const UEndLevelStreamingScheduler* CurrentScheduler = Scheduler.Get();
+            bool bDone = true;
+            if (CurrentScheduler != NULL) {
+                if (Tickets.Num() == 0) {
+                    const UWorld* World = CurrentScheduler->GetWorld();
+                    bDone = CurrentScheduler->IsIdle() && (World == NULL || !World->HasStreamingLevelsToConsider());
+                } else {
+                    for (const uint32 Ticket : Tickets) {
+                        if (!CurrentScheduler->IsRequestComplete(Ticket)) {
+                            bDone = false;
+                            break;
+                        }
+                    }
+                }
+            }
+            Response.FinishAndTriggerIf(bDone, ExecutionFunction, OutputLink, CallbackTarget);
+        }
+
+        TArray<uint32, TInlineAllocator<4>> Tickets;
+
+    private:
+        TWeakObjectPtr<UEndLevelStreamingScheduler> Scheduler;
+        FName ExecutionFunction;
+        int32 OutputLink;
+        FWeakObjectPtr CallbackTarget;
+    };
+
+    static void QueueStreamLevels(const UObject* WorldContextObject, int32 Priority, const TArray<FName>& LevelNames, bool bLoad, const FLatentActionInfo& LatentInfo) {
+        UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+        UEndLevelStreamingScheduler* Scheduler = UEndLevelStreamingScheduler::Get(WorldContextObject);
+        if (World == NULL || Scheduler == NULL) {
+            return;
+        }
+
+        FLatentActionManager& LatentManager = World->GetLatentActionManager();
+        if (LatentManager.FindExistingAction<FStreamLevelAction>(LatentInfo.CallbackTarget, LatentInfo.UUID) != NULL) {
+            return;
+        }
+
+        FStreamLevelAction* Action = new FStreamLevelAction(Scheduler, LatentInfo);
+        for (const FName& LevelName : LevelNames) {
+            Action->Tickets.Add(bLoad ? Scheduler->RequestLoad(LevelName, Priority) : Scheduler->RequestUnload(LevelName, Priority));
+        }
+        LatentManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, Action);
+    }
+}
 
 UEndLevelLoader::UEndLevelLoader() {
 }
 
 void UEndLevelLoader::WaitStreamLevelEmpty(const UObject* WorldContextObject, FLatentActionInfo LatentInfo) {
+    UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+    UEndLevelStreamingScheduler* Scheduler = UEndLevelStreamingScheduler::Get(WorldContextObject);
+    if (World == NULL || Scheduler == NULL) {
+        return;
+    }
+
+    FLatentActionManager& LatentManager = World->GetLatentActionManager();
+    if (LatentManager.FindExistingAction<EndLevelLoader::FStreamLevelAction>(LatentInfo.CallbackTarget, LatentInfo.UUID) == NULL) {
+        LatentManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, new EndLevelLoader::FStreamLevelAction(Scheduler, LatentInfo));
+    }
 }
 
 void UEndLevelLoader::UnLoadStreamLevelSpec(const UObject* WorldContextObject, int32 Priority, FName SpecName, FLatentActionInfo LatentInfo) {
+    EndLevelLoader::QueueStreamLevels(WorldContextObject, Priority, TArray<FName>({SpecName}), false, LatentInfo);
 }
 
 void UEndLevelLoader::UnloadStreamLevelSingle(const UObject* WorldContextObject, int32 Priority, FName LevelNames, FLatentActionInfo LatentInfo) {
+    EndLevelLoader::QueueStreamLevels(WorldContextObject, Priority, TArray<FName>({LevelNames}), false, LatentInfo);
 }
 
 void UEndLevelLoader::UnloadStreamLevelGroups(const UObject* WorldContextObject, int32 Priority, TArray<FName> LevelNames, FLatentActionInfo LatentInfo) {
+    EndLevelLoader::QueueStreamLevels(WorldContextObject, Priority, LevelNames, false, LatentInfo);
 }
 
 FString UEndLevelLoader::MakeLongLevelName(const FString& ShortName) {
@@ -20,12 +97,15 @@ FString UEndLevelLoader::MakeLongLevelName(const FString& ShortName) {
 }
 
 void UEndLevelLoader::LoadStreamLevelSpec(const UObject* WorldContextObject, int32 Priority, FName SpecName, FLatentActionInfo LatentInfo) {
+    EndLevelLoader::QueueStreamLevels(WorldContextObject, Priority, TArray<FName>({SpecName}), true, LatentInfo);
 }
 
 void UEndLevelLoader::LoadStreamLevelSingle(const UObject* WorldContextObject, int32 Priority, FName LevelNames, FLatentActionInfo LatentInfo) {
+    EndLevelLoader::QueueStreamLevels(WorldContextObject, Priority, TArray<FName>({LevelNames}), true, LatentInfo);
 }
 
 void UEndLevelLoader::LoadStreamLevelGroups(const UObject* WorldContextObject, int32 Priority, TArray<FName> LevelNames, FLatentActionInfo LatentInfo) {
+    EndLevelLoader::QueueStreamLevels(WorldContextObject, Priority, LevelNames, true, LatentInfo);
 }
 
 AEndCharacterBase* UEndLevelLoader::FindCharacterFromWorld(FName ActorName) {
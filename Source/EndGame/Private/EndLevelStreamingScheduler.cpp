@@ -0,0 +1,346 @@
+#include "EndLevelStreamingScheduler.h"
+#include "Engine/Engine.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogEndLevelStreaming, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("EndLevelStreaming"), STATGROUP_EndLevelStreaming, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Scheduler Tick"), STAT_EndLevelStreamingSchedulerTick, STATGROUP_EndLevelStreaming);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queue Depth"), STAT_EndLevelStreamingQueueDepth, STATGROUP_EndLevelStreaming);
+DECLARE_DWORD_COUNTER_STAT(TEXT("In Flight"), STAT_EndLevelStreamingInFlight, STATGROUP_EndLevelStreaming);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dispatched This Frame"), STAT_EndLevelStreamingDispatched, STATGROUP_EndLevelStreaming);
+
+static TAutoConsoleVariable<int32> CVarEndLevelStreamingMaxInFlight(
+    TEXT("end.LevelStreaming.MaxInFlight"),
+    2,
+    TEXT("Level loads and unloads the level streaming scheduler keeps streaming at once; the rest wait in its queue."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarEndLevelStreamingInFlightBudgetKB(
+    TEXT("end.LevelStreaming.InFlightBudgetKB"),
+    32 * 1024,
+    TEXT("Package bytes (in KB) the level streaming scheduler may have loading at once. 0 disables the limit."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEndLevelStreamingFrameBudgetMs(
+    TEXT("end.LevelStreaming.FrameBudgetMs"),
+    3.0f,
+    TEXT("Game thread time (in ms) per frame for level streaming: the scheduler stops dispatching once it has spent it, and while requests are in flight it is the engine's time slice for adding and removing level actors (s.LevelStreamingActorsUpdateTimeLimit). 0 disables the limit."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarEndLevelStreamingFrameBudgetKB(
+    TEXT("end.LevelStreaming.FrameBudgetKB"),
+    16 * 1024,
+    TEXT("Package bytes (in KB) the level streaming scheduler may dispatch per frame. 0 disables the limit."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarEndLevelStreamingPriorityAging(
+    TEXT("end.LevelStreaming.PriorityAgingPerSecond"),
+    10.0f,
+    TEXT("Priority gained per second a request waits in the queue, so low priority requests cannot starve."),
+    ECVF_Default);
+
+UEndLevelStreamingScheduler::UEndLevelStreamingScheduler() {
+    this->NextTicket = 1;
+    this->SavedActorsUpdateTimeLimit = -1.0f;
+}
+
+UEndLevelStreamingScheduler* UEndLevelStreamingScheduler::Get(const UObject* WorldContextObject) {
+    UWorld* World = GEngine != NULL ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : NULL;
+    return World != NULL ? World->GetSubsystem<UEndLevelStreamingScheduler>() : NULL;
+}
+
+void UEndLevelStreamingScheduler::Deinitialize() {
+    PendingRequests.Reset();
+    InFlightRequests.Reset();
+    OutstandingTickets.Reset();
+    ApplyFrameTimeBudget(false);
+
+    Super::Deinitialize();
+}
+
+ETickableTickType UEndLevelStreamingScheduler::GetTickableTickType() const {
+    return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UEndLevelStreamingScheduler::IsTickable() const {
+    return PendingRequests.Num() > 0 || InFlightRequests.Num() > 0;
+}
+
+UWorld* UEndLevelStreamingScheduler::GetTickableGameObjectWorld() const {
+    return GetWorld();
+}
+
+TStatId UEndLevelStreamingScheduler::GetStatId() const {
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UEndLevelStreamingScheduler, STATGROUP_Tickables);
+}
+
+uint32 UEndLevelStreamingScheduler::RequestLoad(FName LevelName, int32 Priority, bool bMakeVisible) {
+    return EnqueueRequest(LevelName, Priority, true, bMakeVisible);
+}
+
+uint32 UEndLevelStreamingScheduler::RequestUnload(FName LevelName, int32 Priority) {
+    return EnqueueRequest(LevelName, Priority, false, false);
+}
+
+bool UEndLevelStreamingScheduler::IsRequestComplete(uint32 Ticket) const {
+    return !OutstandingTickets.Contains(Ticket);
+}
+
+bool UEndLevelStreamingScheduler::IsIdle() const {
+    return PendingRequests.Num() == 0 && InFlightRequests.Num() == 0;
+}
+
+uint32 UEndLevelStreamingScheduler::EnqueueRequest(FName LevelName, int32 Priority, bool bLoad, bool bMakeVisible) {
+    const uint32 Ticket = NextTicket++;
+    if (NextTicket == 0) {
+        NextTicket = 1;
+    }
+
+    ULevelStreaming* StreamingLevel = FindStreamingLevel(LevelName);
+    if (StreamingLevel == NULL) {
+        UE_LOG(LogEndLevelStreaming, Warning, TEXT("%s request for unknown level %s ignored"), bLoad ? TEXT("Load") : TEXT("Unload"), *LevelName.ToString());
+        return Ticket;
+    }
+
+    const FName PackageName = StreamingLevel->GetWorldAssetPackageFName();
+    const double Now = FPlatformTime::Seconds();
+    OutstandingTickets.Add(Ticket);
+
+    // Same direction as the request already streaming: piggyback on it.
+    if (FRequest* InFlight = InFlightRequests.Find(PackageName)) {
+        if (InFlight->bLoad == bLoad && (!bLoad || InFlight->bMakeVisible || !bMakeVisible)) {
+            InFlight->Tickets.Add(Ticket);
+            UE_LOG(LogEndLevelStreaming, Verbose, TEXT("Coalesced %s into in-flight request (queue depth %d)"), *PackageName.ToString(), PendingRequests.Num());
+            return Ticket;
+        }
+    }
+
+    if (FRequest* Pending = PendingRequests.Find(PackageName)) {
+        if (Pending->bLoad == bLoad) {
+            Pending->Priority = FMath::Max(Pending->Priority, Priority);
+            Pending->bMakeVisible |= bMakeVisible;
+            Pending->Tickets.Add(Ticket);
+            UE_LOG(LogEndLevelStreaming, Verbose, TEXT("Coalesced %s into pending request (queue depth %d)"), *PackageName.ToString(), PendingRequests.Num());
+            return Ticket;
+        }
+
+        // A load followed by an unload (or vice versa) that never started cancels out: the pending request is dropped,
+        // and the new one is only queued if the level is not already where it asks to be.
+        CompleteRequest(*Pending, TEXT("cancelled"));
+        PendingRequests.Remove(PackageName);
+        if (!InFlightRequests.Contains(PackageName) && IsLevelAlreadyRequested(StreamingLevel, bLoad, bMakeVisible)) {
+            OutstandingTickets.Remove(Ticket);
+            UE_LOG(LogEndLevelStreaming, Verbose, TEXT("Cancelled pending request for %s (queue depth %d)"), *PackageName.ToString(), PendingRequests.Num());
+            return Ticket;
+        }
+    }
+
+    FRequest& Request = PendingRequests.Add(PackageName);
+    Request.PackageName = PackageName;
+    Request.StreamingLevel = StreamingLevel;
+    Request.Tickets.Add(Ticket);
+    Request.Priority = Priority;
+    Request.EnqueueTime = Now;
+    Request.DispatchTime = 0.0;
+    Request.EstimatedBytes = bLoad ? GetEstimatedBytes(PackageName) : 0;
+    Request.bLoad = bLoad;
+    Request.bMakeVisible = bMakeVisible;
+
+    UE_LOG(LogEndLevelStreaming, Verbose, TEXT("Queued %s %s priority %d (queue depth %d)"), bLoad ? TEXT("load") : TEXT("unload"), *PackageName.ToString(), Priority, PendingRequests.Num());
+    return Ticket;
+}
+
+ULevelStreaming* UEndLevelStreamingScheduler::FindStreamingLevel(FName LevelName) const {
+    UWorld* World = GetWorld();
+    if (World == NULL || LevelName.IsNone()) {
+        return NULL;
+    }
+
+    // Callers pass either long package names or the short level names used by specs and triggers.
+    const FString SearchName = LevelName.ToString();
+    const bool bShortName = FPackageName::IsShortPackageName(SearchName);
+    for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels()) {
+        if (StreamingLevel == NULL) {
+            continue;
+        }
+        const FName PackageName = StreamingLevel->GetWorldAssetPackageFName();
+        if (PackageName == LevelName) {
+            return StreamingLevel;
+        }
+        if (bShortName && FPackageName::GetShortName(PackageName).Equals(SearchName, ESearchCase::IgnoreCase)) {
+            return StreamingLevel;
+        }
+    }
+    return NULL;
+}
+
+int64 UEndLevelStreamingScheduler::GetEstimatedBytes(FName PackageName) {
+    if (const int64* CachedSize = PackageSizeCache.Find(PackageName)) {
+        return *CachedSize;
+    }
+
+    int64 Size = 0;
+    FString Filename;
+    if (FPackageName::DoesPackageExist(PackageName.ToString(), NULL, &Filename)) {
+        Size = FMath::Max<int64>(IFileManager::Get().FileSize(*Filename), 0);
+    }
+    PackageSizeCache.Add(PackageName, Size);
+    return Size;
+}
+
+float UEndLevelStreamingScheduler::GetEffectivePriority(const FRequest& Request, double Now) const {
+    return (float)Request.Priority + (float)(Now - Request.EnqueueTime) * CVarEndLevelStreamingPriorityAging.GetValueOnGameThread();
+}
+
+void UEndLevelStreamingScheduler::Tick(float DeltaTime) {
+    SCOPE_CYCLE_COUNTER(STAT_EndLevelStreamingSchedulerTick);
+
+    const double Now = FPlatformTime::Seconds();
+
+    for (auto It = InFlightRequests.CreateIterator(); It; ++It) {
+        if (IsRequestSettled(It.Value())) {
+            CompleteRequest(It.Value(), TEXT("done"));
+            It.RemoveCurrent();
+        }
+    }
+
+    if (PendingRequests.Num() > 0) {
+        TArray<FName, TInlineAllocator<16>> Order;
+        PendingRequests.GenerateKeyArray(Order);
+        Order.Sort([this, Now](const FName& A, const FName& B) {
+            const FRequest& RequestA = PendingRequests.FindChecked(A);
+            const FRequest& RequestB = PendingRequests.FindChecked(B);
+            const float PriorityA = GetEffectivePriority(RequestA, Now);
+            const float PriorityB = GetEffectivePriority(RequestB, Now);
+            return PriorityA != PriorityB ? PriorityA > PriorityB : RequestA.EnqueueTime < RequestB.EnqueueTime;
+        });
+
+        const int32 MaxInFlight = FMath::Max(CVarEndLevelStreamingMaxInFlight.GetValueOnGameThread(), 1);
+        const int64 BudgetBytes = (int64)CVarEndLevelStreamingInFlightBudgetKB.GetValueOnGameThread() * 1024;
+        int64 InFlightBytes = 0;
+        for (const TPair<FName, FRequest>& InFlight : InFlightRequests) {
+            InFlightBytes += InFlight.Value.EstimatedBytes;
+        }
+        const double FrameBudgetSeconds = CVarEndLevelStreamingFrameBudgetMs.GetValueOnGameThread() * 0.001;
+        const int64 FrameBudgetBytes = (int64)CVarEndLevelStreamingFrameBudgetKB.GetValueOnGameThread() * 1024;
+        int64 FrameBytes = 0;
+        int32 NumDispatched = 0;
+
+        for (const FName& PackageName : Order) {
+            if (InFlightRequests.Num() >= MaxInFlight) {
+                break;
+            }
+            if (NumDispatched > 0 && FrameBudgetSeconds > 0.0 && FPlatformTime::Seconds() - Now >= FrameBudgetSeconds) {
+                break;
+            }
+
+            // Wait for the opposite-direction request on this level to finish before flipping it again.
+            FRequest& Request = PendingRequests.FindChecked(PackageName);
+            if (InFlightRequests.Contains(PackageName)) {
+                continue;
+            }
+
+            // With nothing streaming, let one request through so an oversized level cannot block the queue forever.
+            if (InFlightRequests.Num() > 0 && BudgetBytes > 0 && InFlightBytes + Request.EstimatedBytes > BudgetBytes) {
+                continue;
+            }
+            // Likewise the first dispatch of a frame always fits the frame's byte budget.
+            if (NumDispatched > 0 && FrameBudgetBytes > 0 && FrameBytes + Request.EstimatedBytes > FrameBudgetBytes) {
+                continue;
+            }
+
+            DispatchRequest(Request, Now);
+            InFlightBytes += Request.EstimatedBytes;
+            FrameBytes += Request.EstimatedBytes;
+            NumDispatched++;
+            InFlightRequests.Add(PackageName, MoveTemp(Request));
+            PendingRequests.Remove(PackageName);
+        }
+        INC_DWORD_STAT_BY(STAT_EndLevelStreamingDispatched, NumDispatched);
+    }
+
+    ApplyFrameTimeBudget(InFlightRequests.Num() > 0);
+
+    INC_DWORD_STAT_BY(STAT_EndLevelStreamingQueueDepth, PendingRequests.Num());
+    INC_DWORD_STAT_BY(STAT_EndLevelStreamingInFlight, InFlightRequests.Num());
+}
+
+void UEndLevelStreamingScheduler::ApplyFrameTimeBudget(bool bStreaming) {
+    IConsoleVariable* TimeLimit = IConsoleManager::Get().FindConsoleVariable(TEXT("s.LevelStreamingActorsUpdateTimeLimit"));
+    const float FrameBudgetMs = CVarEndLevelStreamingFrameBudgetMs.GetValueOnGameThread();
+    if (TimeLimit == NULL) {
+        return;
+    }
+
+    // Most of the frame cost of streaming is the engine adding and removing level actors, which it time slices
+    // itself; hand it the frame budget while our requests stream and give the previous limit back afterwards.
+    if (bStreaming && FrameBudgetMs > 0.0f) {
+        if (SavedActorsUpdateTimeLimit < 0.0f) {
+            SavedActorsUpdateTimeLimit = TimeLimit->GetFloat();
+        }
+        if (TimeLimit->GetFloat() != FrameBudgetMs) {
+            TimeLimit->Set(FrameBudgetMs, ECVF_SetByCode);
+        }
+    } else if (SavedActorsUpdateTimeLimit >= 0.0f) {
+        TimeLimit->Set(SavedActorsUpdateTimeLimit, ECVF_SetByCode);
+        SavedActorsUpdateTimeLimit = -1.0f;
+    }
+}
+
+void UEndLevelStreamingScheduler::DispatchRequest(FRequest& Request, double Now) {
+    Request.DispatchTime = Now;
+
+    UE_LOG(LogEndLevelStreaming, Log, TEXT("Dispatch %s %s priority %d after %.1f ms in queue (queue depth %d, in flight %d, %lld KB)"),
+        Request.bLoad ? TEXT("load") : TEXT("unload"), *Request.PackageName.ToString(), Request.Priority,
+        (Now - Request.EnqueueTime) * 1000.0, PendingRequests.Num() - 1, InFlightRequests.Num(), Request.EstimatedBytes / 1024);
+
+    ULevelStreaming* StreamingLevel = Request.StreamingLevel.Get();
+    if (StreamingLevel == NULL) {
+        return;
+    }
+
+    StreamingLevel->SetPriority(Request.Priority);
+    if (Request.bLoad) {
+        StreamingLevel->SetShouldBeLoaded(true);
+        StreamingLevel->SetShouldBeVisible(Request.bMakeVisible);
+    } else {
+        StreamingLevel->SetShouldBeVisible(false);
+        StreamingLevel->SetShouldBeLoaded(false);
+    }
+}
+
+bool UEndLevelStreamingScheduler::IsLevelAlreadyRequested(const ULevelStreaming* StreamingLevel, bool bLoad, bool bMakeVisible) const {
+    if (bLoad) {
+        return StreamingLevel->ShouldBeLoaded() && (!bMakeVisible || StreamingLevel->ShouldBeVisible());
+    }
+    return !StreamingLevel->ShouldBeLoaded();
+}
+
+bool UEndLevelStreamingScheduler::IsRequestSettled(const FRequest& Request) const {
+    const ULevelStreaming* StreamingLevel = Request.StreamingLevel.Get();
+    if (StreamingLevel == NULL) {
+        return true;
+    }
+    if (Request.bLoad) {
+        return StreamingLevel->IsLevelLoaded() && (!Request.bMakeVisible || StreamingLevel->IsLevelVisible());
+    }
+    return !StreamingLevel->IsLevelLoaded();
+}
+
+void UEndLevelStreamingScheduler::CompleteRequest(FRequest& Request, const TCHAR* Reason) {
+    for (const uint32 Ticket : Request.Tickets) {
+        OutstandingTickets.Remove(Ticket);
+    }
+
+    const double Now = FPlatformTime::Seconds();
+    const double WaitMs = ((Request.DispatchTime > 0.0 ? Request.DispatchTime : Now) - Request.EnqueueTime) * 1000.0;
+    UE_LOG(LogEndLevelStreaming, Log, TEXT("Complete (%s) %s %s: waited %.1f ms, total %.1f ms, %d caller(s)"),
+        Reason, Request.bLoad ? TEXT("load") : TEXT("unload"), *Request.PackageName.ToString(),
+        WaitMs, (Now - Request.EnqueueTime) * 1000.0, Request.Tickets.Num());
+}
+
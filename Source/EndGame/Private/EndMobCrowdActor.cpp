@@ -1,4 +1,44 @@
 #include "EndMobCrowdActor.h"
+#include "Animation/AnimSequence.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "EndMobCrowdAnimTexture.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+namespace EndMobCrowdActor {
+    // Re-evaluated a few times a second; members only cross the switch distance slowly.
+    static const float InstancedLODInterval = 0.2f;
+    // Fraction of the switch distance members must move past before flipping back, so they do not flicker on the edge.
+    static const float InstancedLODHysteresis = 0.1f;
+
+    static const FName AnimTextureParam(TEXT("CrowdAnimTexture"));
+    static const FName AnimNumBonesParam(TEXT("CrowdAnimNumBones"));
+    static const FName AnimNumFramesParam(TEXT("CrowdAnimNumFrames"));
+    static const FName AnimFrameRateParam(TEXT("CrowdAnimFrameRate"));
+
+    // Member 0 is the master; slaves follow in order. Attachments mirror their member with the same index.
+    static USkeletalMeshComponent* GetMember(const FEndMobCrowdGroup& Group, int32 MemberIndex) {
+        return MemberIndex == 0 ? Group.MasterComponent : Group.SlaveComponents[MemberIndex - 1];
+    }
+
+    static USkeletalMeshComponent* GetAttachment(const FEndMobCrowdGroup& Group, int32 MemberIndex) {
+        return MemberIndex == 0 ? Group.MasterAttachComponent : (Group.SlaveAttachComponents.IsValidIndex(MemberIndex - 1) ? Group.SlaveAttachComponents[MemberIndex - 1] : NULL);
+    }
+
+    // Instances of members drawn through their skeletal component are collapsed to zero scale.
+    static FTransform GetInstanceTransform(const USkeletalMeshComponent* Source, bool bInstanced) {
+        FTransform Transform = Source != NULL ? Source->GetComponentTransform() : FTransform::Identity;
+        if (!bInstanced) {
+            Transform.SetScale3D(FVector::ZeroVector);
+        }
+        return Transform;
+    }
+}
 
 AEndMobCrowdActor::AEndMobCrowdActor(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
     this->bUseMinLOD = true;
@@ -8,6 +48,209 @@ AEndMobCrowdActor::AEndMobCrowdActor(const FObjectInitializer& ObjectInitializer
     this->CameraCutCullingDistance = 0.00f;
     this->UpdateLODDistanceThresholds.AddDefaulted(3);
     this->GraphicsModeUpdateLODDistanceBias = 1.30f;
+    this->bUseInstancedCrowd = false;
+    this->AnimTextureSampleRate = 30.00f;
+    this->InstancedLODTimer = 0.00f;
+    this->PrimaryActorTick.bCanEverTick = true;
+    this->PrimaryActorTick.bStartWithTickEnabled = false;
+}
+
+void AEndMobCrowdActor::BeginPlay() {
+    Super::BeginPlay();
+
+    InstancedGroups.Reset();
+    CrowdAnimTextures.Reset();
+    if (!bUseInstancedCrowd || UpdateLODDistanceThresholds.Num() == 0 || UpdateLODDistanceThresholds.Last() <= 0.0f) {
+        return;
+    }
+
+    for (int32 GroupIndex = 0; GroupIndex < MobCrowdGroups.Num(); ++GroupIndex) {
+        SetupInstancedGroup(GroupIndex);
+    }
+    SetActorTickEnabled(InstancedGroups.Num() > 0);
+}
+
+void AEndMobCrowdActor::SetupInstancedGroup(int32 GroupIndex) {
+    FEndMobCrowdGroup& Group = MobCrowdGroups[GroupIndex];
+    UAnimSequence* AnimSequence = Cast<UAnimSequence>(Group.AnimSequence);
+    if (Group.StaticMesh == NULL || Group.InstancedStaticMeshComponent == NULL || Group.MasterComponent == NULL || AnimSequence == NULL) {
+        return;
+    }
+
+    UTexture2D* AnimTexture = EndMobCrowdAnimTexture::FindOrBake(Group.SkeletalMesh, AnimSequence, AnimTextureSampleRate);
+    if (AnimTexture == NULL) {
+        return;
+    }
+
+    // The attachment is skinned to its own bones, so it gets its own texture, baked from the same animation through
+    // the shared skeleton. An attachment that cannot be baked would be left hanging off a hidden, frozen member, so
+    // such groups stay skeletal.
+    UTexture2D* AttachAnimTexture = NULL;
+    const bool bInstanceAttachments = Group.InstancedAttachStaticMeshComponent != NULL && Group.AttachStaticMesh != NULL;
+    if (bInstanceAttachments) {
+        USkeletalMesh* AttachMesh = Group.AttachMesh != NULL ? Group.AttachMesh : (Group.MasterAttachComponent != NULL ? Group.MasterAttachComponent->SkeletalMesh : NULL);
+        AttachAnimTexture = AttachMesh != NULL && AttachMesh->Skeleton == AnimSequence->GetSkeleton() ? EndMobCrowdAnimTexture::FindOrBake(AttachMesh, AnimSequence, AnimTextureSampleRate) : NULL;
+        if (AttachAnimTexture == NULL) {
+            return;
+        }
+        CrowdAnimTextures.AddUnique(AttachAnimTexture);
+    }
+    CrowdAnimTextures.AddUnique(AnimTexture);
+
+    const int32 NumMembers = 1 + Group.SlaveComponents.Num();
+    auto SetupComponent = [&](UInstancedStaticMeshComponent* Component, UStaticMesh* StaticMesh, UTexture2D* Texture, bool bAttachments, TArray<FTransform>& OutTransforms) {
+        Component->SetStaticMesh(StaticMesh);
+        Component->ClearInstances();
+        Component->NumCustomDataFloats = 1;
+        for (int32 MaterialIndex = 0; MaterialIndex < Component->GetNumMaterials(); ++MaterialIndex) {
+            if (UMaterialInstanceDynamic* Material = Component->CreateDynamicMaterialInstance(MaterialIndex)) {
+                Material->SetTextureParameterValue(EndMobCrowdActor::AnimTextureParam, Texture);
+                Material->SetScalarParameterValue(EndMobCrowdActor::AnimNumBonesParam, (float)EndMobCrowdAnimTexture::GetNumBones(Texture));
+                Material->SetScalarParameterValue(EndMobCrowdActor::AnimNumFramesParam, (float)EndMobCrowdAnimTexture::GetNumFrames(Texture));
+                Material->SetScalarParameterValue(EndMobCrowdActor::AnimFrameRateParam, AnimTextureSampleRate);
+            }
+        }
+
+        // Every member gets an instance up front, collapsed while its skeletal component is the one drawn.
+        OutTransforms.SetNum(NumMembers);
+        for (int32 MemberIndex = 0; MemberIndex < NumMembers; ++MemberIndex) {
+            const USkeletalMeshComponent* Attachment = bAttachments ? EndMobCrowdActor::GetAttachment(Group, MemberIndex) : NULL;
+            OutTransforms[MemberIndex] = EndMobCrowdActor::GetInstanceTransform(Attachment != NULL ? Attachment : EndMobCrowdActor::GetMember(Group, MemberIndex), false);
+            const int32 InstanceIndex = Component->AddInstanceWorldSpace(OutTransforms[MemberIndex]);
+            Component->SetCustomDataValue(InstanceIndex, 0, FMath::Frac(MemberIndex * Group.AnimStartTimeRate) * AnimSequence->GetPlayLength(), false);
+        }
+        Component->MarkRenderStateDirty();
+    };
+
+    FInstancedGroupState& State = InstancedGroups.AddDefaulted_GetRef();
+    State.GroupIndex = GroupIndex;
+    State.InstancedMembers.Init(false, NumMembers);
+    State.bInstanceAttachments = bInstanceAttachments;
+    State.MasterTickOption = Group.MasterComponent->VisibilityBasedAnimTickOption;
+
+    SetupComponent(Group.InstancedStaticMeshComponent, Group.StaticMesh, AnimTexture, false, State.MemberTransforms);
+    if (bInstanceAttachments) {
+        SetupComponent(Group.InstancedAttachStaticMeshComponent, Group.AttachStaticMesh, AttachAnimTexture, true, State.AttachTransforms);
+    }
+}
+
+void AEndMobCrowdActor::Tick(float DeltaSeconds) {
+    Super::Tick(DeltaSeconds);
+
+    InstancedLODTimer -= DeltaSeconds;
+    if (InstancedLODTimer <= 0.0f) {
+        InstancedLODTimer = EndMobCrowdActor::InstancedLODInterval;
+        UpdateInstancedLODs();
+    }
+    UpdateInstanceTransforms();
+}
+
+void AEndMobCrowdActor::UpdateInstanceTransforms() {
+    for (FInstancedGroupState& State : InstancedGroups) {
+        FEndMobCrowdGroup& Group = MobCrowdGroups[State.GroupIndex];
+        bool bMembersMoved = false;
+        bool bAttachmentsMoved = false;
+
+        for (TConstSetBitIterator<> It(State.InstancedMembers); It; ++It) {
+            const int32 MemberIndex = It.GetIndex();
+            if (const USkeletalMeshComponent* Member = EndMobCrowdActor::GetMember(Group, MemberIndex)) {
+                const FTransform& Transform = Member->GetComponentTransform();
+                if (!Transform.Equals(State.MemberTransforms[MemberIndex])) {
+                    State.MemberTransforms[MemberIndex] = Transform;
+                    Group.InstancedStaticMeshComponent->UpdateInstanceTransform(MemberIndex, Transform, true, false, true);
+                    bMembersMoved = true;
+                }
+            }
+
+            const USkeletalMeshComponent* Attachment = State.bInstanceAttachments ? EndMobCrowdActor::GetAttachment(Group, MemberIndex) : NULL;
+            if (Attachment != NULL) {
+                const FTransform& Transform = Attachment->GetComponentTransform();
+                if (!Transform.Equals(State.AttachTransforms[MemberIndex])) {
+                    State.AttachTransforms[MemberIndex] = Transform;
+                    Group.InstancedAttachStaticMeshComponent->UpdateInstanceTransform(MemberIndex, Transform, true, false, true);
+                    bAttachmentsMoved = true;
+                }
+            }
+        }
+
+        if (bMembersMoved) {
+            Group.InstancedStaticMeshComponent->MarkRenderStateDirty();
+        }
+        if (bAttachmentsMoved) {
+            Group.InstancedAttachStaticMeshComponent->MarkRenderStateDirty();
+        }
+    }
+}
+
+void AEndMobCrowdActor::UpdateMasterTickOption(FInstancedGroupState& State) {
+    // Skeletal slaves copy the master's pose, so a hidden master has to keep ticking while any of them is drawn.
+    // Otherwise it goes back to its own visibility based setting.
+    USkeletalMeshComponent* Master = MobCrowdGroups[State.GroupIndex].MasterComponent;
+    bool bSkeletalSlave = false;
+    for (int32 MemberIndex = 1; MemberIndex < State.InstancedMembers.Num() && !bSkeletalSlave; ++MemberIndex) {
+        bSkeletalSlave = !State.InstancedMembers[MemberIndex];
+    }
+    const bool bNeedsPose = State.InstancedMembers[0] && bSkeletalSlave;
+    Master->VisibilityBasedAnimTickOption = bNeedsPose ? FMath::Min(State.MasterTickOption, EVisibilityBasedAnimTickOption::AlwaysTickPose) : State.MasterTickOption;
+}
+
+void AEndMobCrowdActor::UpdateInstancedLODs() {
+    const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+    if (PlayerController == NULL || PlayerController->PlayerCameraManager == NULL) {
+        return;
+    }
+
+    const FVector CameraLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+    const float SwitchDistance = UpdateLODDistanceThresholds.Last();
+    const float ToInstancedDistSq = FMath::Square(SwitchDistance * (1.0f + EndMobCrowdActor::InstancedLODHysteresis));
+    const float ToSkeletalDistSq = FMath::Square(SwitchDistance * (1.0f - EndMobCrowdActor::InstancedLODHysteresis));
+
+    for (FInstancedGroupState& State : InstancedGroups) {
+        FEndMobCrowdGroup& Group = MobCrowdGroups[State.GroupIndex];
+        bool bChanged = false;
+
+        for (int32 MemberIndex = 0; MemberIndex < State.InstancedMembers.Num(); ++MemberIndex) {
+            USkeletalMeshComponent* Member = EndMobCrowdActor::GetMember(Group, MemberIndex);
+            USkeletalMeshComponent* Attachment = EndMobCrowdActor::GetAttachment(Group, MemberIndex);
+            if (Member == NULL) {
+                continue;
+            }
+
+            const bool bWasInstanced = State.InstancedMembers[MemberIndex];
+            const float DistSq = FVector::DistSquared(Member->GetComponentLocation(), CameraLocation);
+            const bool bInstanced = bWasInstanced ? DistSq > ToSkeletalDistSq : DistSq > ToInstancedDistSq;
+            if (bInstanced == bWasInstanced) {
+                continue;
+            }
+            State.InstancedMembers[MemberIndex] = bInstanced;
+            bChanged = true;
+
+            // Hidden skeletal members stop paying for skinning and their scene proxy; the master's pose ticking is
+            // handled by UpdateMasterTickOption.
+            Member->SetVisibility(!bInstanced);
+            if (MemberIndex != 0) {
+                Member->SetComponentTickEnabled(!bInstanced);
+            }
+            State.MemberTransforms[MemberIndex] = EndMobCrowdActor::GetInstanceTransform(Member, bInstanced);
+            Group.InstancedStaticMeshComponent->UpdateInstanceTransform(MemberIndex, State.MemberTransforms[MemberIndex], true, false, true);
+
+            if (Attachment != NULL) {
+                Attachment->SetVisibility(!bInstanced);
+                if (State.bInstanceAttachments) {
+                    State.AttachTransforms[MemberIndex] = EndMobCrowdActor::GetInstanceTransform(Attachment, bInstanced);
+                    Group.InstancedAttachStaticMeshComponent->UpdateInstanceTransform(MemberIndex, State.AttachTransforms[MemberIndex], true, false, true);
+                }
+            }
+        }
+
+        if (bChanged) {
+            UpdateMasterTickOption(State);
+            Group.InstancedStaticMeshComponent->MarkRenderStateDirty();
+            if (State.bInstanceAttachments) {
+                Group.InstancedAttachStaticMeshComponent->MarkRenderStateDirty();
+            }
+        }
+    }
 }
 
 void AEndMobCrowdActor::Stop(float BlendTime, bool bUseFade) {
@@ -0,0 +1,99 @@
+#include "EndMobCrowdAnimTexture.h"
+#include "Animation/AnimSequence.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/Texture2D.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bake Crowd Anim Texture"), STAT_EndMobCrowdBakeAnimTexture, STATGROUP_Anim);
+
+namespace EndMobCrowdAnimTexture {
+    static const int32 TexelsPerBone = 3;
+    static const int32 MaxTextureSize = 8192;
+
+    typedef TPair<TWeakObjectPtr<USkeletalMesh>, TWeakObjectPtr<UAnimSequence>> FBakeKey;
+    static TMap<FBakeKey, TWeakObjectPtr<UTexture2D>> BakedTextures;
+
+    UTexture2D* FindOrBake(USkeletalMesh* SkeletalMesh, UAnimSequence* AnimSequence, float SampleRate) {
+        check(IsInGameThread());
+        if (SkeletalMesh == NULL || AnimSequence == NULL || AnimSequence->GetSkeleton() == NULL || SampleRate <= 0.0f) {
+            return NULL;
+        }
+
+        for (auto It = BakedTextures.CreateIterator(); It; ++It) {
+            if (!It.Value().IsValid()) {
+                It.RemoveCurrent();
+            }
+        }
+
+        const FBakeKey Key(SkeletalMesh, AnimSequence);
+        if (UTexture2D* Existing = BakedTextures.FindRef(Key).Get()) {
+            return Existing;
+        }
+
+        SCOPE_CYCLE_COUNTER(STAT_EndMobCrowdBakeAnimTexture);
+
+        const FReferenceSkeleton& RefSkeleton = SkeletalMesh->GetRefSkeleton();
+        const int32 NumBones = RefSkeleton.GetNum();
+        const int32 NumFrames = FMath::Clamp(FMath::CeilToInt(AnimSequence->GetPlayLength() * SampleRate) + 1, 1, MaxTextureSize);
+        if (NumBones == 0 || NumBones * TexelsPerBone > MaxTextureSize || SkeletalMesh->RefBasesInvMatrix.Num() != NumBones) {
+            return NULL;
+        }
+
+        // Animation tracks are keyed by skeleton bone; resolve them to this mesh's bones once.
+        const USkeleton* Skeleton = AnimSequence->GetSkeleton();
+        const TArray<FTrackToSkeletonMap>& TrackMap = AnimSequence->GetCompressedTrackToSkeletonMapTable();
+        TArray<int32> BoneTracks;
+        BoneTracks.Init(INDEX_NONE, NumBones);
+        for (int32 TrackIndex = 0; TrackIndex < TrackMap.Num(); ++TrackIndex) {
+            const int32 MeshBoneIndex = Skeleton->GetMeshBoneIndexFromSkeletonBoneIndex(SkeletalMesh, TrackMap[TrackIndex].BoneTreeIndex);
+            if (BoneTracks.IsValidIndex(MeshBoneIndex)) {
+                BoneTracks[MeshBoneIndex] = TrackIndex;
+            }
+        }
+
+        UTexture2D* Texture = UTexture2D::CreateTransient(NumBones * TexelsPerBone, NumFrames, PF_A32B32G32R32F);
+        if (Texture == NULL) {
+            return NULL;
+        }
+        Texture->Filter = TF_Nearest;
+        Texture->SRGB = false;
+        Texture->AddressX = TA_Clamp;
+        Texture->AddressY = TA_Wrap;
+
+        TArray<FTransform> ComponentSpace;
+        ComponentSpace.SetNumUninitialized(NumBones);
+        FLinearColor* Texels = (FLinearColor*)Texture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+        for (int32 Frame = 0; Frame < NumFrames; ++Frame) {
+            const float Time = FMath::Min(Frame / SampleRate, AnimSequence->GetPlayLength());
+            for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex) {
+                FTransform Local = RefSkeleton.GetRefBonePose()[BoneIndex];
+                if (BoneTracks[BoneIndex] != INDEX_NONE) {
+                    AnimSequence->GetBoneTransform(Local, BoneTracks[BoneIndex], Time, false);
+                }
+                // The reference skeleton lists parents before children.
+                const int32 ParentIndex = RefSkeleton.GetParentIndex(BoneIndex);
+                ComponentSpace[BoneIndex] = ParentIndex != INDEX_NONE ? Local * ComponentSpace[ParentIndex] : Local;
+
+                const FMatrix Skinning = SkeletalMesh->RefBasesInvMatrix[BoneIndex] * ComponentSpace[BoneIndex].ToMatrixWithScale();
+                FLinearColor* BoneTexels = Texels + Frame * NumBones * TexelsPerBone + BoneIndex * TexelsPerBone;
+                for (int32 Column = 0; Column < TexelsPerBone; ++Column) {
+                    BoneTexels[Column] = FLinearColor(Skinning.M[0][Column], Skinning.M[1][Column], Skinning.M[2][Column], Skinning.M[3][Column]);
+                }
+            }
+        }
+        Texture->PlatformData->Mips[0].BulkData.Unlock();
+        Texture->UpdateResource();
+
+        BakedTextures.Add(Key, Texture);
+        return Texture;
+    }
+
+    int32 GetNumBones(const UTexture2D* Texture) {
+        return Texture != NULL ? Texture->GetSizeX() / TexelsPerBone : 0;
+    }
+
+    int32 GetNumFrames(const UTexture2D* Texture) {
+        return Texture != NULL ? Texture->GetSizeY() : 0;
+    }
+}
+
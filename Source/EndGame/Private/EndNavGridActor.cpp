@@ -1,7 +1,37 @@
 #include "EndNavGridActor.h"
+#include "Engine/World.h"
+#include "EndNavGridTileStreamer.h"
 
 AEndNavGridActor::AEndNavGridActor(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
     this->Priority = 0;
+    this->bStreamTiles = false;
+    this->TileSize = 20000.00f;
+    this->LoadDistance = 30000.00f;
+    this->UnloadMargin = 2500.00f;
+    this->CoarseLayerID = 0;
+    this->CoarseLoadDistanceScale = 2.00f;
 }
 
+void AEndNavGridActor::BeginPlay() {
+    Super::BeginPlay();
+
+    if (bStreamTiles) {
+        if (UEndNavGridTileStreamer* Streamer = GetWorld()->GetSubsystem<UEndNavGridTileStreamer>()) {
+            Streamer->RegisterNavGrid(this);
+        }
+    }
+}
+
+void AEndNavGridActor::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+    if (UEndNavGridTileStreamer* Streamer = GetWorld()->GetSubsystem<UEndNavGridTileStreamer>()) {
+        Streamer->UnregisterNavGrid(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+FBox AEndNavGridActor::GetTileBounds(const FEndNavGridData& Tile) const {
+    const FVector Extent(TileSize * 0.5f, TileSize * 0.5f, Tile.HalfHeight);
+    return FBox(Tile.Center - Extent, Tile.Center + Extent);
+}
 
@@ -0,0 +1,343 @@
+#include "EndNavGridTileStreamer.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "EndNavGridActor.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
+#include "NavigationSystem.h"
+
+DECLARE_STATS_GROUP(TEXT("EndNavGridStreaming"), STATGROUP_EndNavGridStreaming, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("NavGrid Tile Streaming"), STAT_EndNavGridTileStreamerTick, STATGROUP_EndNavGridStreaming);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Resident Tiles"), STAT_EndNavGridResidentTiles, STATGROUP_EndNavGridStreaming);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Loading Tiles"), STAT_EndNavGridLoadingTiles, STATGROUP_EndNavGridStreaming);
+
+static TAutoConsoleVariable<int32> CVarEndNavGridMaxLoadsInFlight(
+    TEXT("end.NavGrid.MaxTileLoadsInFlight"),
+    4,
+    TEXT("Nav grid tile loads that may be in flight at once across all nav grids."),
+    ECVF_Default);
+
+namespace EndNavGridTileStreamer {
+    static FSoftObjectPath MakeTilePath(FName AssetName) {
+        // Tiles name their package; the chunk asset inside shares the package's short name.
+        FString Path = AssetName.ToString();
+        if (!Path.Contains(TEXT("."))) {
+            Path = FString::Printf(TEXT("%s.%s"), *Path, *FPackageName::GetShortName(Path));
+        }
+        return FSoftObjectPath(Path);
+    }
+}
+
+UEndNavGridTileStreamer::UEndNavGridTileStreamer() {
+}
+
+void UEndNavGridTileStreamer::Deinitialize() {
+    for (FNavGridState& GridState : NavGrids) {
+        for (int32 TileIndex = 0; TileIndex < GridState.Tiles.Num(); ++TileIndex) {
+            ReleaseTile(GridState, TileIndex);
+        }
+    }
+    NavGrids.Reset();
+    Agents.Reset();
+    PlayerAgent.Reset();
+
+    Super::Deinitialize();
+}
+
+ETickableTickType UEndNavGridTileStreamer::GetTickableTickType() const {
+    return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UEndNavGridTileStreamer::IsTickable() const {
+    return NavGrids.Num() > 0;
+}
+
+UWorld* UEndNavGridTileStreamer::GetTickableGameObjectWorld() const {
+    return GetWorld();
+}
+
+TStatId UEndNavGridTileStreamer::GetStatId() const {
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UEndNavGridTileStreamer, STATGROUP_Tickables);
+}
+
+void UEndNavGridTileStreamer::RegisterNavGrid(AEndNavGridActor* NavGrid) {
+    if (NavGrid == NULL || NavGrid->TileSize <= 0.0f || NavGrids.ContainsByPredicate([NavGrid](const FNavGridState& GridState) { return GridState.NavGrid == NavGrid; })) {
+        return;
+    }
+
+    FNavGridState& GridState = NavGrids.AddDefaulted_GetRef();
+    GridState.NavGrid = NavGrid;
+    GridState.Tiles.SetNum(NavGrid->NavGrids.Num());
+
+    // Bucket by tile center rather than GridX/GridY so tiles of every layer land in the same bucket lattice.
+    for (int32 TileIndex = 0; TileIndex < NavGrid->NavGrids.Num(); ++TileIndex) {
+        FTileState& Tile = GridState.Tiles[TileIndex];
+        Tile.WantedDistance = MAX_flt;
+        Tile.State = ETileState::Unloaded;
+        GridState.Buckets.FindOrAdd(GetBucketCoord(GridState, NavGrid->NavGrids[TileIndex].Center)).Add(TileIndex);
+    }
+}
+
+void UEndNavGridTileStreamer::UnregisterNavGrid(AEndNavGridActor* NavGrid) {
+    const int32 GridIndex = NavGrids.IndexOfByPredicate([NavGrid](const FNavGridState& GridState) { return GridState.NavGrid == NavGrid; });
+    if (GridIndex == INDEX_NONE) {
+        return;
+    }
+
+    FNavGridState& GridState = NavGrids[GridIndex];
+    for (int32 TileIndex = 0; TileIndex < GridState.Tiles.Num(); ++TileIndex) {
+        ReleaseTile(GridState, TileIndex);
+    }
+    NavGrids.RemoveAtSwap(GridIndex);
+}
+
+void UEndNavGridTileStreamer::RegisterAgent(AActor* Agent, int32 LayerID) {
+    if (Agent != NULL) {
+        Agents.Add(Agent, LayerID);
+    }
+}
+
+void UEndNavGridTileStreamer::UnregisterAgent(AActor* Agent) {
+    Agents.Remove(Agent);
+}
+
+int32 UEndNavGridTileStreamer::GetAgentLayer(const AActor* Agent) const {
+    const INavAgentInterface* NavAgent = Cast<const INavAgentInterface>(Agent);
+    const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (NavAgent == NULL || NavSys == NULL) {
+        return INDEX_NONE;
+    }
+    return NavSys->GetSupportedAgentIndex(NavAgent->GetNavAgentPropertiesRef());
+}
+
+void UEndNavGridTileStreamer::UpdatePlayerAgent() {
+    // Follow possession changes so the player's own layer, not just the coarse one, streams in around it.
+    const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+    APawn* Pawn = PlayerController != NULL ? PlayerController->GetPawn() : NULL;
+    if (PlayerAgent.Get() == Pawn) {
+        return;
+    }
+
+    if (PlayerAgent.IsValid()) {
+        UnregisterAgent(PlayerAgent.Get());
+    }
+    PlayerAgent = Pawn;
+    if (Pawn != NULL) {
+        RegisterAgent(Pawn, GetAgentLayer(Pawn));
+    }
+}
+
+void UEndNavGridTileStreamer::GatherInterests(TArray<FInterest>& OutInterests) const {
+    OutInterests.Reset();
+    for (const TPair<TWeakObjectPtr<AActor>, int32>& Agent : Agents) {
+        if (const AActor* Actor = Agent.Key.Get()) {
+            OutInterests.Add({Actor->GetActorLocation(), Agent.Value});
+        }
+    }
+}
+
+void UEndNavGridTileStreamer::Tick(float DeltaTime) {
+    SCOPE_CYCLE_COUNTER(STAT_EndNavGridTileStreamerTick);
+
+    for (auto It = Agents.CreateIterator(); It; ++It) {
+        if (!It.Key().IsValid()) {
+            It.RemoveCurrent();
+        }
+    }
+
+    UpdatePlayerAgent();
+
+    TArray<FInterest> Interests;
+    GatherInterests(Interests);
+
+    int32 LoadsInFlight = 0;
+    for (const FNavGridState& GridState : NavGrids) {
+        for (const FTileState& Tile : GridState.Tiles) {
+            LoadsInFlight += Tile.State == ETileState::Loading ? 1 : 0;
+        }
+    }
+
+    for (FNavGridState& GridState : NavGrids) {
+        if (GridState.NavGrid.IsValid()) {
+            UpdateNavGrid(GridState, Interests, LoadsInFlight);
+        }
+    }
+}
+
+void UEndNavGridTileStreamer::UpdateNavGrid(FNavGridState& GridState, const TArray<FInterest>& Interests, int32& InOutLoadsInFlight) {
+    const AEndNavGridActor* NavGrid = GridState.NavGrid.Get();
+    // Tiles outside the search get no wanted distance and are released, so reach the farthest unload distance: the
+    // coarse layer's, which WantedDistance scales down by CoarseLoadDistanceScale.
+    const float UnloadDistance = NavGrid->LoadDistance + NavGrid->UnloadMargin;
+    const float SearchDistance = UnloadDistance * FMath::Max(NavGrid->CoarseLoadDistanceScale, 1.0f) + NavGrid->TileSize;
+
+    for (FTileState& Tile : GridState.Tiles) {
+        Tile.WantedDistance = MAX_flt;
+    }
+
+    // Nearest relevant interest per tile, only looking at buckets inside the widest (coarse) unload distance.
+    for (const FInterest& Interest : Interests) {
+        const FIntPoint BucketMin = GetBucketCoord(GridState, Interest.Location - FVector(SearchDistance, SearchDistance, 0.0f));
+        const FIntPoint BucketMax = GetBucketCoord(GridState, Interest.Location + FVector(SearchDistance, SearchDistance, 0.0f));
+        for (int32 BucketY = BucketMin.Y; BucketY <= BucketMax.Y; ++BucketY) {
+            for (int32 BucketX = BucketMin.X; BucketX <= BucketMax.X; ++BucketX) {
+                const TArray<int32>* Bucket = GridState.Buckets.Find(FIntPoint(BucketX, BucketY));
+                if (Bucket == NULL) {
+                    continue;
+                }
+                for (const int32 TileIndex : *Bucket) {
+                    const FEndNavGridData& Data = NavGrid->NavGrids[TileIndex];
+                    const bool bCoarse = Data.LayerID == NavGrid->CoarseLayerID;
+                    if (!bCoarse && Data.LayerID != Interest.LayerID) {
+                        continue;
+                    }
+
+                    // Express the coarse layer's wider radius as a shorter effective distance so one threshold applies.
+                    const float Distance = FMath::Sqrt(NavGrid->GetTileBounds(Data).ComputeSquaredDistanceToPoint(Interest.Location));
+                    const float EffectiveDistance = bCoarse ? Distance / NavGrid->CoarseLoadDistanceScale : Distance;
+                    FTileState& Tile = GridState.Tiles[TileIndex];
+                    Tile.WantedDistance = FMath::Min(Tile.WantedDistance, EffectiveDistance);
+                }
+            }
+        }
+    }
+
+    TArray<int32> LoadCandidates;
+    for (int32 TileIndex = 0; TileIndex < GridState.Tiles.Num(); ++TileIndex) {
+        FTileState& Tile = GridState.Tiles[TileIndex];
+        if (Tile.State == ETileState::Unloaded) {
+            if (Tile.WantedDistance <= NavGrid->LoadDistance) {
+                LoadCandidates.Add(TileIndex);
+            }
+        } else if (Tile.WantedDistance > UnloadDistance) {
+            if (Tile.State == ETileState::Loading) {
+                InOutLoadsInFlight--;
+            }
+            ReleaseTile(GridState, TileIndex);
+        }
+    }
+
+    LoadCandidates.Sort([&GridState](int32 A, int32 B) {
+        return GridState.Tiles[A].WantedDistance < GridState.Tiles[B].WantedDistance;
+    });
+
+    const int32 MaxLoadsInFlight = FMath::Max(CVarEndNavGridMaxLoadsInFlight.GetValueOnGameThread(), 1);
+    for (const int32 TileIndex : LoadCandidates) {
+        if (InOutLoadsInFlight >= MaxLoadsInFlight) {
+            break;
+        }
+        RequestTile(GridState, TileIndex);
+        if (GridState.Tiles[TileIndex].State == ETileState::Loading) {
+            InOutLoadsInFlight++;
+        }
+    }
+
+    int32 NumResident = 0;
+    int32 NumLoading = 0;
+    for (const FTileState& Tile : GridState.Tiles) {
+        NumResident += Tile.State == ETileState::Resident ? 1 : 0;
+        NumLoading += Tile.State == ETileState::Loading ? 1 : 0;
+    }
+    INC_DWORD_STAT_BY(STAT_EndNavGridResidentTiles, NumResident);
+    INC_DWORD_STAT_BY(STAT_EndNavGridLoadingTiles, NumLoading);
+}
+
+void UEndNavGridTileStreamer::RequestTile(FNavGridState& GridState, int32 TileIndex) {
+    AEndNavGridActor* NavGrid = GridState.NavGrid.Get();
+    const FSoftObjectPath TilePath = EndNavGridTileStreamer::MakeTilePath(NavGrid->NavGrids[TileIndex].AssetName);
+    if (TilePath.IsNull()) {
+        return;
+    }
+
+    // Closer tiles and higher priority grids go first in the async loading queue.
+    FTileState& Tile = GridState.Tiles[TileIndex];
+    const TAsyncLoadPriority LoadPriority = FStreamableManager::DefaultAsyncLoadPriority + NavGrid->Priority;
+    TWeakObjectPtr<UEndNavGridTileStreamer> WeakThis(this);
+    TWeakObjectPtr<AEndNavGridActor> WeakNavGrid(NavGrid);
+    Tile.State = ETileState::Loading;
+    Tile.Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(TilePath, FStreamableDelegate::CreateLambda([WeakThis, WeakNavGrid, TileIndex, TilePath]() {
+        UEndNavGridTileStreamer* Streamer = WeakThis.Get();
+        if (Streamer == NULL) {
+            return;
+        }
+        FNavGridState* State = Streamer->NavGrids.FindByPredicate([&WeakNavGrid](const FNavGridState& GridState) { return GridState.NavGrid == WeakNavGrid; });
+        if (State == NULL || !State->Tiles.IsValidIndex(TileIndex) || State->Tiles[TileIndex].State != ETileState::Loading) {
+            return;
+        }
+        State->Tiles[TileIndex].State = ETileState::Resident;
+        Streamer->OnTileResidencyChanged.Broadcast(WeakNavGrid.Get(), TileIndex, TilePath.ResolveObject(), true);
+    }), LoadPriority);
+
+    if (!Tile.Handle.IsValid()) {
+        Tile.State = ETileState::Unloaded;
+    }
+}
+
+void UEndNavGridTileStreamer::ReleaseTile(FNavGridState& GridState, int32 TileIndex) {
+    FTileState& Tile = GridState.Tiles[TileIndex];
+    const bool bWasResident = Tile.State == ETileState::Resident;
+    if (Tile.Handle.IsValid()) {
+        Tile.Handle->ReleaseHandle();
+        Tile.Handle.Reset();
+    }
+    Tile.State = ETileState::Unloaded;
+
+    if (bWasResident) {
+        OnTileResidencyChanged.Broadcast(GridState.NavGrid.Get(), TileIndex, NULL, false);
+    }
+}
+
+FIntPoint UEndNavGridTileStreamer::GetBucketCoord(const FNavGridState& GridState, const FVector& Location) const {
+    const float TileSize = GridState.NavGrid.IsValid() ? GridState.NavGrid->TileSize : 1.0f;
+    return FIntPoint(FMath::FloorToInt(Location.X / TileSize), FMath::FloorToInt(Location.Y / TileSize));
+}
+
+int32 UEndNavGridTileStreamer::FindTile(const FNavGridState& GridState, const FVector& Location, int32 LayerID) const {
+    const AEndNavGridActor* NavGrid = GridState.NavGrid.Get();
+    const FIntPoint Center = GetBucketCoord(GridState, Location);
+    for (int32 BucketY = Center.Y - 1; BucketY <= Center.Y + 1; ++BucketY) {
+        for (int32 BucketX = Center.X - 1; BucketX <= Center.X + 1; ++BucketX) {
+            const TArray<int32>* Bucket = GridState.Buckets.Find(FIntPoint(BucketX, BucketY));
+            if (Bucket == NULL) {
+                continue;
+            }
+            for (const int32 TileIndex : *Bucket) {
+                const FEndNavGridData& Data = NavGrid->NavGrids[TileIndex];
+                if (Data.LayerID == LayerID && NavGrid->GetTileBounds(Data).IsInsideOrOn(Location)) {
+                    return TileIndex;
+                }
+            }
+        }
+    }
+    return INDEX_NONE;
+}
+
+UObject* UEndNavGridTileStreamer::FindResidentTileAsset(const FVector& Location, int32 DesiredLayerID, int32& OutLayerID) const {
+    OutLayerID = INDEX_NONE;
+    for (const FNavGridState& GridState : NavGrids) {
+        const AEndNavGridActor* NavGrid = GridState.NavGrid.Get();
+        if (NavGrid == NULL) {
+            continue;
+        }
+
+        const int32 Layers[2] = {DesiredLayerID, NavGrid->CoarseLayerID};
+        for (const int32 LayerID : Layers) {
+            const int32 TileIndex = FindTile(GridState, Location, LayerID);
+            if (TileIndex != INDEX_NONE && GridState.Tiles[TileIndex].State == ETileState::Resident) {
+                OutLayerID = LayerID;
+                return GridState.Tiles[TileIndex].Handle->GetLoadedAsset();
+            }
+        }
+    }
+    return NULL;
+}
+
+int32 UEndNavGridTileStreamer::GetQueryLayer(const FVector& Location, int32 DesiredLayerID) const {
+    int32 LayerID = INDEX_NONE;
+    FindResidentTileAsset(Location, DesiredLayerID, LayerID);
+    return LayerID;
+}
+
@@ -1,8 +1,21 @@
 #include "EndNavigationSystem.h"
+#include "Engine/World.h"
+#include "EndNavGridTileStreamer.h"
 
 UEndNavigationSystem::UEndNavigationSystem() {
     this->DefaultAgentName = TEXT("Normal00");
     this->SupportedAgents.AddDefaulted(7);
 }
 
-
+const ANavigationData* UEndNavigationSystem::GetNavDataForProps(const FNavAgentProperties& AgentProperties, const FVector& AgentLocation, const FVector& Extent) const {
+    const UWorld* World = GetWorld();
+    const UEndNavGridTileStreamer* Streamer = World != NULL ? World->GetSubsystem<UEndNavGridTileStreamer>() : NULL;
+    const int32 DesiredLayerID = GetSupportedAgentIndex(AgentProperties);
+    if (Streamer != NULL && DesiredLayerID != INDEX_NONE) {
+        const int32 QueryLayerID = Streamer->GetQueryLayer(AgentLocation, DesiredLayerID);
+        if (QueryLayerID != DesiredLayerID && SupportedAgents.IsValidIndex(QueryLayerID)) {
+            return Super::GetNavDataForProps(SupportedAgents[QueryLayerID], AgentLocation, Extent);
+        }
+    }
+    return Super::GetNavDataForProps(AgentProperties, AgentLocation, Extent);
+}
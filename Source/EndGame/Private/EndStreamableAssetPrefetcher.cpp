@@ -0,0 +1,142 @@
+#include "EndStreamableAssetPrefetcher.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/StreamableRenderAsset.h"
+#include "EndStreamableAssetPump.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogEndStreamableAssetPrefetch, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("EndStreamableAssetPrefetch"), STATGROUP_EndStreamableAssetPrefetch, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Prefetch Update"), STAT_EndStreamableAssetPrefetchUpdate, STATGROUP_EndStreamableAssetPrefetch);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Prefetch Reads Issued"), STAT_EndStreamableAssetPrefetchIssued, STATGROUP_EndStreamableAssetPrefetch);
+
+namespace EndStreamableAssetPrefetcher {
+    // Each late cut widens the lead time by this factor, up to MaxLeadTimeScale, for the rest of the playback.
+    static const float LateLeadTimeGrowth = 1.5f;
+    static const float MaxLeadTimeScale = 4.0f;
+
+    static void ForceResident(UObject* Object, float Seconds) {
+        if (UStreamableRenderAsset* RenderAsset = Cast<UStreamableRenderAsset>(Object)) {
+            RenderAsset->SetForceMipLevelsToBeResident(Seconds);
+        }
+    }
+}
+
+FEndStreamableAssetPrefetcher::FEndStreamableAssetPrefetcher()
+    : BaseFrameCounter(0)
+    , BaseRecordedFrameCounter(0)
+    , LeadTimeScale(1.0f)
+    , NextEntry(0)
+    , NextCut(0)
+    , NumIssued(0)
+    , NumLateCuts(0) {
+}
+
+FEndStreamableAssetPrefetcher::~FEndStreamableAssetPrefetcher() {
+    End();
+}
+
+void FEndStreamableAssetPrefetcher::Begin(const UEndStreamableAssetPump* InPump, float StartTime) {
+    End();
+
+    if (InPump == NULL || !InPump->GetTimeline().IsValid()) {
+        return;
+    }
+
+    const FEndStreamableAssetTimeline Timeline = InPump->GetTimeline();
+    Pump = InPump;
+    LeadTimeScale = 1.0f;
+    NumIssued = 0;
+    NumLateCuts = 0;
+    NextEntry = Timeline.LowerBoundEntry(StartTime);
+    NextCut = Timeline.LowerBoundCut(StartTime);
+
+    // Frame lateness is measured relative to the first cut we actually play from.
+    BaseFrameCounter = GFrameCounter;
+    BaseRecordedFrameCounter = Timeline.GetCuts().IsValidIndex(NextCut) ? Timeline.GetCuts()[NextCut].FrameCounter : 0;
+}
+
+void FEndStreamableAssetPrefetcher::Update(float PlaybackTime) {
+    SCOPE_CYCLE_COUNTER(STAT_EndStreamableAssetPrefetchUpdate);
+
+    const UEndStreamableAssetPump* CurrentPump = Pump.Get();
+    if (CurrentPump == NULL) {
+        return;
+    }
+
+    const FEndStreamableAssetTimeline Timeline = CurrentPump->GetTimeline();
+    const TArrayView<const FEndStreamableAssetTimelineCut> Cuts = Timeline.GetCuts();
+    const TArrayView<const FEndStreamableAssetTimelineEntry> Entries = Timeline.GetEntries();
+
+    while (NextCut < Cuts.Num() && Cuts[NextCut].StartTime <= PlaybackTime) {
+        const FEndStreamableAssetTimelineCut& Cut = Cuts[NextCut++];
+        const int64 RecordedFrames = (int64)(Cut.FrameCounter - BaseRecordedFrameCounter);
+        const int64 PlayedFrames = (int64)(GFrameCounter - BaseFrameCounter);
+        if (Cut.FrameCounter >= BaseRecordedFrameCounter && PlayedFrames - RecordedFrames > CurrentPump->LateCutFrameTolerance) {
+            NumLateCuts++;
+            LeadTimeScale = FMath::Min(LeadTimeScale * EndStreamableAssetPrefetcher::LateLeadTimeGrowth, EndStreamableAssetPrefetcher::MaxLeadTimeScale);
+            UE_LOG(LogEndStreamableAssetPrefetch, Warning, TEXT("%s: cut %u started %lld frames late, lead time now %.2fs"),
+                *CurrentPump->GetName(), Cut.CutIndex, PlayedFrames - RecordedFrames, CurrentPump->PrefetchLeadTime * LeadTimeScale);
+        }
+    }
+
+    const float IssueUntil = PlaybackTime + CurrentPump->PrefetchLeadTime * LeadTimeScale;
+    int32 NumIssuedThisFrame = 0;
+    while (NextEntry < Entries.Num() && Entries[NextEntry].Time <= IssueUntil) {
+        IssueEntry(Entries[NextEntry++], PlaybackTime);
+        NumIssuedThisFrame++;
+    }
+    INC_DWORD_STAT_BY(STAT_EndStreamableAssetPrefetchIssued, NumIssuedThisFrame);
+
+    if (NumIssuedThisFrame > 0) {
+        ReleaseFinishedHandles();
+    }
+}
+
+void FEndStreamableAssetPrefetcher::End() {
+    for (const TSharedPtr<FStreamableHandle>& Handle : Handles) {
+        if (Handle.IsValid()) {
+            Handle->ReleaseHandle();
+        }
+    }
+    Handles.Reset();
+    Pump.Reset();
+    NextEntry = 0;
+    NextCut = 0;
+}
+
+void FEndStreamableAssetPrefetcher::IssueEntry(const FEndStreamableAssetTimelineEntry& Entry, float PlaybackTime) {
+    const FSoftObjectPath AssetPath = Pump->GetEntryAssetPath(Entry);
+    if (AssetPath.IsNull()) {
+        return;
+    }
+
+    NumIssued++;
+    const float ResidentSeconds = FMath::Max(Entry.Time - PlaybackTime, 0.0f) + Pump->PrefetchHoldTime;
+    if (UObject* LoadedObject = AssetPath.ResolveObject()) {
+        EndStreamableAssetPrefetcher::ForceResident(LoadedObject, ResidentSeconds);
+        return;
+    }
+
+    // Not loaded yet: load asynchronously and force the mips/LODs once it arrives. The hold is measured from issue
+    // time so a slow load still covers the entry's recorded time.
+    const double IssueTime = FPlatformTime::Seconds();
+    FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
+    TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(AssetPath, FStreamableDelegate::CreateLambda([AssetPath, ResidentSeconds, IssueTime]() {
+        const float Remaining = ResidentSeconds - (float)(FPlatformTime::Seconds() - IssueTime);
+        if (Remaining > 0.0f) {
+            EndStreamableAssetPrefetcher::ForceResident(AssetPath.ResolveObject(), Remaining);
+        }
+    }), FStreamableManager::AsyncLoadHighPriority);
+    if (Handle.IsValid()) {
+        Handles.Add(Handle);
+    }
+}
+
+void FEndStreamableAssetPrefetcher::ReleaseFinishedHandles() {
+    // Keep completed handles until the cutscene ends so the assets are not garbage collected before they are used.
+    Handles.RemoveAllSwap([](const TSharedPtr<FStreamableHandle>& Handle) {
+        return !Handle.IsValid() || Handle->WasCanceled();
+    });
+}
+
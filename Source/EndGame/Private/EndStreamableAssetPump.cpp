@@ -1,6 +1,34 @@
 #include "EndStreamableAssetPump.h"
 
 UEndStreamableAssetPump::UEndStreamableAssetPump(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
+    this->PrefetchLeadTime = 1.50f;
+    this->PrefetchHoldTime = 2.00f;
+    this->LateCutFrameTolerance = 3;
 }
 
+void UEndStreamableAssetPump::PostLoad() {
+    Super::PostLoad();
+
+#if WITH_EDITORONLY_DATA
+    // Assets saved before the timeline existed only carry the raw recordings.
+    if (!GetTimeline().IsValid()) {
+        RebuildTimeline();
+    }
+#endif
+}
+
+void UEndStreamableAssetPump::PreSave(const ITargetPlatform* TargetPlatform) {
+    Super::PreSave(TargetPlatform);
+
+    RebuildTimeline();
+}
+
+void UEndStreamableAssetPump::RebuildTimeline() {
+    FEndStreamableAssetTimeline::Build(PumpData, TimelineData);
+}
+
+FSoftObjectPath UEndStreamableAssetPump::GetEntryAssetPath(const FEndStreamableAssetTimelineEntry& Entry) const {
+    const TArray<FString>& Paths = EnumHasAnyFlags(Entry.Flags, EEndStreamableAssetTimelineFlags::MassiveEnvironment) ? PumpData.MassiveEnvironmentAssetPaths : PumpData.AssetPaths;
+    return Paths.IsValidIndex(Entry.AssetPathIndex) ? FSoftObjectPath(Paths[Entry.AssetPathIndex]) : FSoftObjectPath();
+}
 
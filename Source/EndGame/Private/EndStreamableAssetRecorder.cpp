@@ -0,0 +1,290 @@
+#include "EndStreamableAssetRecorder.h"
+#include "Camera/CameraTypes.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "ConvexVolume.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Texture.h"
+#include "Engine/World.h"
+#include "EndMassiveEnvironmentFrameData.h"
+#include "EndPumpData.h"
+#include "Kismet/GameplayStatics.h"
+#include "SceneManagement.h"
+#include "SceneTypes.h"
+#include "StaticMeshResources.h"
+#include "UObject/UObjectIterator.h"
+
+namespace EndStreamableAssetRecorder {
+    // First LOD whose screen size threshold the primitive still satisfies, turned into "LODs needed" (LOD0 = all).
+    template<typename GetScreenSizeType>
+    static uint8 ComputeNeededLODs(int32 NumLODs, float ScreenSize, GetScreenSizeType GetScreenSize) {
+        int32 LODIndex = NumLODs - 1;
+        for (int32 Index = 0; Index < NumLODs; ++Index) {
+            if (ScreenSize >= GetScreenSize(Index)) {
+                LODIndex = Index;
+                break;
+            }
+        }
+        return (uint8)FMath::Clamp(NumLODs - LODIndex, 1, (int32)MAX_uint8);
+    }
+
+    static int32 FindOrAddPath(TArray<FString>& Paths, TMap<FString, int32>& Lookup, const FString& Path) {
+        if (const int32* Existing = Lookup.Find(Path)) {
+            return *Existing;
+        }
+        const int32 Index = Paths.Add(Path);
+        Lookup.Add(Path, Index);
+        return Index;
+    }
+
+    static void BuildLookup(const TArray<FString>& Paths, TMap<FString, int32>& OutLookup) {
+        OutLookup.Reset();
+        for (int32 Index = 0; Index < Paths.Num(); ++Index) {
+            OutLookup.Add(Paths[Index], Index);
+        }
+    }
+
+    static void UnionMips(TArray<uint8>& Target, const TArray<uint8>& Source) {
+        for (const uint8 Mip : Source) {
+            Target.AddUnique(Mip);
+        }
+        Target.Sort();
+    }
+}
+
+FEndStreamableAssetRecorder::FEndStreamableAssetRecorder()
+    : MinScreenSize(0.01f)
+    , ViewportWidth(1920.0f) {
+}
+
+void FEndStreamableAssetRecorder::BeginCut(int32 CutIndex, FName ViewTarget, float Timestamp, uint64 FrameCounter) {
+    FRecordedCut& Cut = Cuts.AddDefaulted_GetRef();
+    Cut.ViewTarget = ViewTarget;
+    Cut.CutIndex = CutIndex;
+    Cut.Timestamp = Timestamp;
+    Cut.FrameCounter = FrameCounter;
+}
+
+bool FEndStreamableAssetRecorder::IsMassiveEnvironmentMesh(const UStaticMesh* StaticMesh) const {
+    return !MassiveEnvironmentPathFilter.IsEmpty() && StaticMesh->GetPathName().Contains(MassiveEnvironmentPathFilter);
+}
+
+template<typename VisitorType>
+void FEndStreamableAssetRecorder::ForEachVisiblePrimitive(UWorld* World, const FMinimalViewInfo& View, VisitorType Visitor) const {
+    FMatrix ViewMatrix;
+    FMatrix ProjectionMatrix;
+    FMatrix ViewProjectionMatrix;
+    UGameplayStatics::GetViewProjectionMatrix(View, ViewMatrix, ProjectionMatrix, ViewProjectionMatrix);
+
+    FConvexVolume Frustum;
+    GetViewFrustumBounds(Frustum, ViewProjectionMatrix, false);
+
+    for (TObjectIterator<UPrimitiveComponent> It; It; ++It) {
+        UPrimitiveComponent* Component = *It;
+        if (Component->GetWorld() != World || !Component->IsRegistered() || !Component->IsVisible() || Component->bHiddenInGame) {
+            continue;
+        }
+
+        const FBoxSphereBounds& Bounds = Component->Bounds;
+        if (!Frustum.IntersectSphere(Bounds.Origin, Bounds.SphereRadius)) {
+            continue;
+        }
+
+        const float ScreenSize = ComputeBoundsScreenSize(Bounds.Origin, Bounds.SphereRadius, View.Location, ProjectionMatrix);
+        if (ScreenSize >= MinScreenSize) {
+            Visitor(Component, ScreenSize);
+        }
+    }
+}
+
+void FEndStreamableAssetRecorder::CaptureView(UWorld* World, const FMinimalViewInfo& View, float Time) {
+    if (World == NULL) {
+        return;
+    }
+    if (Cuts.Num() == 0) {
+        BeginCut(0, NAME_None, Time, GFrameCounter);
+    }
+
+    TArray<UTexture*> UsedTextures;
+    ForEachVisiblePrimitive(World, View, [this, &UsedTextures, Time](UPrimitiveComponent* Component, float ScreenSize) {
+        if (const UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(Component)) {
+            const UStaticMesh* StaticMesh = StaticMeshComponent->GetStaticMesh();
+            if (StaticMesh != NULL && StaticMesh->RenderData.IsValid() && !IsMassiveEnvironmentMesh(StaticMesh)) {
+                const FStaticMeshRenderData* RenderData = StaticMesh->RenderData.Get();
+                const uint8 LODs = EndStreamableAssetRecorder::ComputeNeededLODs(RenderData->LODResources.Num(), ScreenSize, [RenderData](int32 Index) {
+                    return RenderData->ScreenSize[Index].Default;
+                });
+                RecordAsset(StaticMesh, EEndStreamableAssetRecordType::StaticMesh, LODs, Time);
+            }
+        } else if (const USkinnedMeshComponent* SkinnedMeshComponent = Cast<USkinnedMeshComponent>(Component)) {
+            USkeletalMesh* SkeletalMesh = SkinnedMeshComponent->SkeletalMesh;
+            if (SkeletalMesh != NULL) {
+                const uint8 LODs = EndStreamableAssetRecorder::ComputeNeededLODs(SkeletalMesh->GetLODNum(), ScreenSize, [SkeletalMesh](int32 Index) {
+                    return SkeletalMesh->GetLODInfo(Index)->ScreenSize.Default;
+                });
+                RecordAsset(SkeletalMesh, EEndStreamableAssetRecordType::SkeletalMesh, LODs, Time);
+            }
+        }
+
+        // A texture covering ScreenSize of the view wants roughly log2(pixels) + 1 mips resident.
+        const float Pixels = FMath::Max(ScreenSize * ViewportWidth, 1.0f);
+        const int32 WantedMips = FMath::CeilToInt(FMath::Log2(Pixels)) + 1;
+        UsedTextures.Reset();
+        Component->GetUsedTextures(UsedTextures, EMaterialQualityLevel::Num);
+        for (const UTexture* Texture : UsedTextures) {
+            if (Texture != NULL) {
+                RecordAsset(Texture, EEndStreamableAssetRecordType::Texture, (uint8)FMath::Clamp(WantedMips, 1, (int32)MAX_uint8), Time);
+            }
+        }
+    });
+}
+
+void FEndStreamableAssetRecorder::GatherMassiveEnvironment(UWorld* World, const FMinimalViewInfo& View, float Time, FEndMassiveEnvironmentFrameData& OutFrame, TArray<FString>& OutAssetPaths) const {
+    OutFrame.FrameCounter = GFrameCounter;
+    OutFrame.Timestamp = Time;
+    OutFrame.Components.Reset();
+    OutAssetPaths.Reset();
+    if (World == NULL || MassiveEnvironmentPathFilter.IsEmpty()) {
+        return;
+    }
+
+    TMap<FString, int32> PathLookup;
+    ForEachVisiblePrimitive(World, View, [this, &OutFrame, &OutAssetPaths, &PathLookup](UPrimitiveComponent* Component, float ScreenSize) {
+        const UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(Component);
+        const UStaticMesh* StaticMesh = StaticMeshComponent != NULL ? StaticMeshComponent->GetStaticMesh() : NULL;
+        if (StaticMesh == NULL || !StaticMesh->RenderData.IsValid() || !IsMassiveEnvironmentMesh(StaticMesh)) {
+            return;
+        }
+
+        // Mesh mips are LODs: the view needs the selected LOD and every coarser one.
+        const FStaticMeshRenderData* RenderData = StaticMesh->RenderData.Get();
+        const int32 NumLODs = RenderData->LODResources.Num();
+        const uint8 LODs = EndStreamableAssetRecorder::ComputeNeededLODs(NumLODs, ScreenSize, [RenderData](int32 Index) {
+            return RenderData->ScreenSize[Index].Default;
+        });
+
+        FEndMassiveEnvironmentComponent& Recorded = OutFrame.Components.AddDefaulted_GetRef();
+        Recorded.AssetPathIndex = EndStreamableAssetRecorder::FindOrAddPath(OutAssetPaths, PathLookup, FSoftObjectPath(StaticMesh).ToString());
+        FEndMassiveEnvironmentRenderData& MeshRenderData = Recorded.RenderData.AddDefaulted_GetRef();
+        for (int32 LODIndex = NumLODs - LODs; LODIndex < NumLODs; ++LODIndex) {
+            MeshRenderData.RequestedMeshMipIndices.Add((uint8)LODIndex);
+        }
+    });
+}
+
+void FEndStreamableAssetRecorder::CaptureMassiveEnvironment(const FEndMassiveEnvironmentFrameData& Frame, const TArray<FString>& AssetPaths) {
+    if (Cuts.Num() == 0) {
+        BeginCut(0, NAME_None, Frame.Timestamp, Frame.FrameCounter);
+    }
+
+    FRecordedCut& Cut = Cuts.Last();
+    for (const FEndMassiveEnvironmentComponent& Component : Frame.Components) {
+        if (!AssetPaths.IsValidIndex(Component.AssetPathIndex)) {
+            continue;
+        }
+
+        TArray<TArray<uint8>>& RenderDataMips = Cut.MassiveEnvironmentMips.FindOrAdd(AssetPaths[Component.AssetPathIndex]);
+        if (RenderDataMips.Num() < Component.RenderData.Num()) {
+            RenderDataMips.SetNum(Component.RenderData.Num());
+        }
+        for (int32 Index = 0; Index < Component.RenderData.Num(); ++Index) {
+            EndStreamableAssetRecorder::UnionMips(RenderDataMips[Index], Component.RenderData[Index].RequestedMeshMipIndices);
+        }
+    }
+}
+
+void FEndStreamableAssetRecorder::RecordAsset(const UObject* Asset, EEndStreamableAssetRecordType AssetType, uint8 LODs, float Time) {
+    // Transient/generated assets cannot be reloaded from a path, so they are not worth prefetching.
+    if (Asset->GetOutermost() == GetTransientPackage()) {
+        return;
+    }
+
+    FRecordedCut& Cut = Cuts.Last();
+    const float CutTime = FMath::Max(Time - Cut.Timestamp, 0.0f);
+    const FString Path = FSoftObjectPath(Asset).ToString();
+    if (FRecordedAsset* Existing = Cut.Assets.Find(Path)) {
+        Existing->Time = FMath::Min(Existing->Time, CutTime);
+        Existing->LODs = FMath::Max(Existing->LODs, LODs);
+        return;
+    }
+
+    FRecordedAsset& Recorded = Cut.Assets.Add(Path);
+    Recorded.Time = CutTime;
+    Recorded.LODs = LODs;
+    Recorded.AssetType = AssetType;
+}
+
+void FEndStreamableAssetRecorder::MergeInto(FEndPumpData& Target) const {
+    TMap<FString, int32> AssetLookup;
+    TMap<FString, int32> MassiveEnvironmentLookup;
+    EndStreamableAssetRecorder::BuildLookup(Target.AssetPaths, AssetLookup);
+    EndStreamableAssetRecorder::BuildLookup(Target.MassiveEnvironmentAssetPaths, MassiveEnvironmentLookup);
+
+    for (const FRecordedCut& Cut : Cuts) {
+        FEndStreamableAssets* Record = Target.StreamableAssets.FindByPredicate([&Cut](const FEndStreamableAssets& Existing) {
+            return Existing.CutIndex == Cut.CutIndex && Existing.ViewTarget == Cut.ViewTarget;
+        });
+        if (Record == NULL) {
+            Record = &Target.StreamableAssets.AddDefaulted_GetRef();
+            Record->ViewTarget = Cut.ViewTarget;
+            Record->CutIndex = Cut.CutIndex;
+            Record->Timestamp = Cut.Timestamp;
+            Record->FrameCounter = Cut.FrameCounter;
+        }
+
+        TMap<int32, int32> RecordAssetLookup;
+        for (int32 Index = 0; Index < Record->StreamableAssetData.Num(); ++Index) {
+            RecordAssetLookup.Add(Record->StreamableAssetData[Index].AssetPathIndex, Index);
+        }
+
+        // Entries are rebased onto the record's own timestamp so repeated runs with slightly different cut starts merge.
+        for (const TPair<FString, FRecordedAsset>& Pair : Cut.Assets) {
+            const int32 PathIndex = EndStreamableAssetRecorder::FindOrAddPath(Target.AssetPaths, AssetLookup, Pair.Key);
+            const float Time = FMath::Max(Cut.Timestamp + Pair.Value.Time - Record->Timestamp, 0.0f);
+            if (const int32* Existing = RecordAssetLookup.Find(PathIndex)) {
+                FEndStreamableAssetData& Data = Record->StreamableAssetData[*Existing];
+                Data.Time = FMath::Min(Data.Time, Time);
+                Data.LODs = FMath::Max(Data.LODs, Pair.Value.LODs);
+                continue;
+            }
+
+            RecordAssetLookup.Add(PathIndex, Record->StreamableAssetData.Num());
+            FEndStreamableAssetData& Data = Record->StreamableAssetData.AddDefaulted_GetRef();
+            Data.AssetPathIndex = PathIndex;
+            Data.Time = Time;
+            Data.LODs = Pair.Value.LODs;
+            Data.AssetType = (uint8)Pair.Value.AssetType;
+        }
+
+        for (const TPair<FString, TArray<TArray<uint8>>>& Pair : Cut.MassiveEnvironmentMips) {
+            const int32 PathIndex = EndStreamableAssetRecorder::FindOrAddPath(Target.MassiveEnvironmentAssetPaths, MassiveEnvironmentLookup, Pair.Key);
+            FEndMassiveEnvironmentComponent* Component = Record->StreamableMEComponents.FindByPredicate([PathIndex](const FEndMassiveEnvironmentComponent& Existing) {
+                return Existing.AssetPathIndex == PathIndex;
+            });
+            if (Component == NULL) {
+                Component = &Record->StreamableMEComponents.AddDefaulted_GetRef();
+                Component->AssetPathIndex = PathIndex;
+            }
+            if (Component->RenderData.Num() < Pair.Value.Num()) {
+                Component->RenderData.SetNum(Pair.Value.Num());
+            }
+            for (int32 Index = 0; Index < Pair.Value.Num(); ++Index) {
+                EndStreamableAssetRecorder::UnionMips(Component->RenderData[Index].RequestedMeshMipIndices, Pair.Value[Index]);
+            }
+        }
+
+        Record->StreamableAssetData.Sort([](const FEndStreamableAssetData& A, const FEndStreamableAssetData& B) {
+            return A.Time != B.Time ? A.Time < B.Time : A.AssetPathIndex < B.AssetPathIndex;
+        });
+    }
+
+    Target.StreamableAssets.StableSort([](const FEndStreamableAssets& A, const FEndStreamableAssets& B) {
+        return A.Timestamp < B.Timestamp;
+    });
+}
+
+void FEndStreamableAssetRecorder::Reset() {
+    Cuts.Reset();
+}
+
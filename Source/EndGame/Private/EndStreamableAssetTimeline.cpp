@@ -0,0 +1,115 @@
+#include "EndStreamableAssetTimeline.h"
+#include "EndPumpData.h"
+#include "Algo/BinarySearch.h"
+
+static_assert(sizeof(FEndStreamableAssetTimelineHeader) == 16, "Timeline header layout is serialized as-is");
+static_assert(sizeof(FEndStreamableAssetTimelineCut) == 16, "Timeline cut layout is serialized as-is");
+static_assert(sizeof(FEndStreamableAssetTimelineEntry) == 12, "Timeline entry layout is serialized as-is");
+
+void FEndStreamableAssetTimeline::Build(const FEndPumpData& PumpData, TArray<uint8>& OutData) {
+    TArray<FEndStreamableAssetTimelineCut> Cuts;
+    TArray<FEndStreamableAssetTimelineEntry> Entries;
+    TMap<uint64, int32> CutEntryLookup;
+
+    for (const FEndStreamableAssets& Record : PumpData.StreamableAssets) {
+        FEndStreamableAssetTimelineCut& Cut = Cuts.AddDefaulted_GetRef();
+        Cut.StartTime = Record.Timestamp;
+        Cut.CutIndex = (uint32)Record.CutIndex;
+        Cut.FrameCounter = Record.FrameCounter;
+
+        CutEntryLookup.Reset();
+        const uint16 CutIndex = (uint16)FMath::Clamp(Record.CutIndex, 0, (int32)MAX_uint16);
+        auto AddEntry = [&](int32 AssetPathIndex, float Time, uint8 LODs, EEndStreamableAssetTimelineFlags Flags) {
+            const uint64 Key = ((uint64)Flags << 32) | (uint32)AssetPathIndex;
+            if (const int32* Existing = CutEntryLookup.Find(Key)) {
+                FEndStreamableAssetTimelineEntry& Entry = Entries[*Existing];
+                Entry.Time = FMath::Min(Entry.Time, Time);
+                Entry.LODs = FMath::Max(Entry.LODs, LODs);
+                return;
+            }
+            CutEntryLookup.Add(Key, Entries.Num());
+            FEndStreamableAssetTimelineEntry& Entry = Entries.AddDefaulted_GetRef();
+            Entry.Time = Time;
+            Entry.AssetPathIndex = (uint32)AssetPathIndex;
+            Entry.CutIndex = CutIndex;
+            Entry.LODs = LODs;
+            Entry.Flags = Flags;
+        };
+
+        for (const FEndStreamableAssetData& Data : Record.StreamableAssetData) {
+            if (PumpData.AssetPaths.IsValidIndex(Data.AssetPathIndex)) {
+                AddEntry(Data.AssetPathIndex, Record.Timestamp + Data.Time, Data.LODs, EEndStreamableAssetTimelineFlags::None);
+            }
+        }
+
+        // Massive environment components carry no per-asset time, so they are wanted from the start of the cut.
+        for (const FEndMassiveEnvironmentComponent& Component : Record.StreamableMEComponents) {
+            if (PumpData.MassiveEnvironmentAssetPaths.IsValidIndex(Component.AssetPathIndex)) {
+                uint8 MipCount = 0;
+                for (const FEndMassiveEnvironmentRenderData& RenderData : Component.RenderData) {
+                    MipCount = (uint8)FMath::Max(MipCount, (uint8)FMath::Min(RenderData.RequestedMeshMipIndices.Num(), (int32)MAX_uint8));
+                }
+                AddEntry(Component.AssetPathIndex, Record.Timestamp, MipCount, EEndStreamableAssetTimelineFlags::MassiveEnvironment);
+            }
+        }
+    }
+
+    // Stable so equal times keep recording order, which keeps rebuilt assets byte-identical.
+    Cuts.StableSort([](const FEndStreamableAssetTimelineCut& A, const FEndStreamableAssetTimelineCut& B) {
+        return A.StartTime < B.StartTime;
+    });
+    Entries.StableSort([](const FEndStreamableAssetTimelineEntry& A, const FEndStreamableAssetTimelineEntry& B) {
+        return A.Time < B.Time;
+    });
+
+    FEndStreamableAssetTimelineHeader Header;
+    Header.Magic = Magic;
+    Header.Version = Version;
+    Header.NumCuts = (uint32)Cuts.Num();
+    Header.NumEntries = (uint32)Entries.Num();
+
+    const int32 CutsBytes = Cuts.Num() * sizeof(FEndStreamableAssetTimelineCut);
+    const int32 EntriesBytes = Entries.Num() * sizeof(FEndStreamableAssetTimelineEntry);
+    OutData.Reset(sizeof(Header) + CutsBytes + EntriesBytes);
+    OutData.Append((const uint8*)&Header, sizeof(Header));
+    OutData.Append((const uint8*)Cuts.GetData(), CutsBytes);
+    OutData.Append((const uint8*)Entries.GetData(), EntriesBytes);
+}
+
+FEndStreamableAssetTimeline::FEndStreamableAssetTimeline(TArrayView<const uint8> InData)
+    : Header(NULL)
+    , Cuts(NULL)
+    , Entries(NULL) {
+    if (InData.Num() < (int32)sizeof(FEndStreamableAssetTimelineHeader)) {
+        return;
+    }
+
+    const FEndStreamableAssetTimelineHeader* CandidateHeader = (const FEndStreamableAssetTimelineHeader*)InData.GetData();
+    const int64 ExpectedSize = sizeof(FEndStreamableAssetTimelineHeader)
+        + (int64)CandidateHeader->NumCuts * sizeof(FEndStreamableAssetTimelineCut)
+        + (int64)CandidateHeader->NumEntries * sizeof(FEndStreamableAssetTimelineEntry);
+    if (CandidateHeader->Magic != Magic || CandidateHeader->Version != Version || ExpectedSize != InData.Num()) {
+        return;
+    }
+
+    Header = CandidateHeader;
+    Cuts = (const FEndStreamableAssetTimelineCut*)(Header + 1);
+    Entries = (const FEndStreamableAssetTimelineEntry*)(Cuts + Header->NumCuts);
+}
+
+TArrayView<const FEndStreamableAssetTimelineCut> FEndStreamableAssetTimeline::GetCuts() const {
+    return Header != NULL ? TArrayView<const FEndStreamableAssetTimelineCut>(Cuts, Header->NumCuts) : TArrayView<const FEndStreamableAssetTimelineCut>();
+}
+
+TArrayView<const FEndStreamableAssetTimelineEntry> FEndStreamableAssetTimeline::GetEntries() const {
+    return Header != NULL ? TArrayView<const FEndStreamableAssetTimelineEntry>(Entries, Header->NumEntries) : TArrayView<const FEndStreamableAssetTimelineEntry>();
+}
+
+int32 FEndStreamableAssetTimeline::LowerBoundEntry(float Time) const {
+    return Algo::LowerBoundBy(GetEntries(), Time, [](const FEndStreamableAssetTimelineEntry& Entry) { return Entry.Time; });
+}
+
+int32 FEndStreamableAssetTimeline::LowerBoundCut(float Time) const {
+    return Algo::LowerBoundBy(GetCuts(), Time, [](const FEndStreamableAssetTimelineCut& Cut) { return Cut.StartTime; });
+}
+
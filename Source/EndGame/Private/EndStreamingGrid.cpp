@@ -1,4 +1,24 @@
 #include "EndStreamingGrid.h"
+#include "Components/SplineComponent.h"
+#include "EndLevelStreamingScheduler.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_STATS_GROUP(TEXT("EndStreamingGrid"), STATGROUP_EndStreamingGrid, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("StreamingGrid Tick"), STAT_EndStreamingGridTick, STATGROUP_EndStreamingGrid);
+DECLARE_CYCLE_STAT(TEXT("StreamingGrid Prediction"), STAT_EndStreamingGridPrediction, STATGROUP_EndStreamingGrid);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Cells Evaluated"), STAT_EndStreamingGridCellsEvaluated, STATGROUP_EndStreamingGrid);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spatial Buckets"), STAT_EndStreamingGridBuckets, STATGROUP_EndStreamingGrid);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Predictive Loads In Flight"), STAT_EndStreamingGridPredictiveInFlight, STATGROUP_EndStreamingGrid);
+
+namespace EndStreamingGrid {
+    // Cells inside their load distance always outrank predicted cells; predicted cells are ranked by ETA below this.
+    static const int32 RequiredCellPriority = 100;
+    static const int32 UnloadCellPriority = 0;
+}
 
 AEndStreamingGrid::AEndStreamingGrid(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer) {
     this->GridSize = 20000.00f;
@@ -11,12 +31,411 @@ AEndStreamingGrid::AEndStreamingGrid(const FObjectInitializer& ObjectInitializer
     this->NoWaitCollisionStreaming = false;
     this->StreamingTarget = EEndStreamingVolumeTargetType::All;
     this->bDisabled = false;
+    this->bPredictiveStreaming = false;
+    this->PredictionTime = 3.00f;
+    this->PredictionStepTime = 0.25f;
+    this->PredictionMinSpeed = 600.00f;
+    this->MaxPredictiveLoadsInFlight = 2;
+    this->MaxCellLoadDistance = 0.00f;
+    this->VisitStamp = 0;
+    this->bPaused = false;
+    this->bStatsPrimed = false;
+    PrimaryActorTick.bCanEverTick = true;
+}
+
+void AEndStreamingGrid::BeginPlay() {
+    Super::BeginPlay();
+
+    CellStates.Reset();
+    CellStates.SetNum(StreamingLevels.Num());
+    for (int32 CellIndex = 0; CellIndex < StreamingLevels.Num(); ++CellIndex) {
+        CellStates[CellIndex].StreamingLevel = FindCellStreamingLevel(StreamingLevels[CellIndex]);
+    }
+    BuildSpatialIndex();
+
+    // Only cells the grid requests itself are tracked; levels the persistent level or a volume loads stay theirs.
+    bStatsPrimed = false;
+}
+
+void AEndStreamingGrid::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+    DEC_DWORD_STAT_BY(STAT_EndStreamingGridBuckets, CellBuckets.Num());
+    CellStates.Reset();
+    CellBuckets.Reset();
+    RequiredCellIndices.Reset();
+    PredictedCellIndices.Reset();
+    EstimatedCellIndices.Reset();
+    PredictionSpline.Reset();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AEndStreamingGrid::Tick(float DeltaSeconds) {
+    Super::Tick(DeltaSeconds);
+
+    SCOPE_CYCLE_COUNTER(STAT_EndStreamingGridTick);
+
+    if (CellStates.Num() != StreamingLevels.Num()) {
+        return;
+    }
+    if (!bPredictiveStreaming) {
+        DropPredictedCells();
+    }
+    if (bDisabled || bPaused) {
+        return;
+    }
+
+    FVector Velocity = FVector::ZeroVector;
+    const AActor* ViewTarget = GetStreamingViewTarget(Velocity);
+    if (ViewTarget == NULL) {
+        return;
+    }
+
+    const FVector ViewLocation = ViewTarget->GetActorLocation();
+    UpdateRequiredCells(ViewLocation);
+
+    if (bPredictiveStreaming) {
+        UpdatePredictedCells(ViewLocation, Velocity, DeltaSeconds);
+    }
+    bStatsPrimed = true;
 }
 
 void AEndStreamingGrid::PauseStreamingGrid(bool bEnable) {
+    this->bPaused = bEnable;
 }
 
 void AEndStreamingGrid::EnableStreamingGrid(bool bEnable) {
+    this->bDisabled = !bEnable;
+}
+
+void AEndStreamingGrid::SetPredictionSpline(USplineComponent* Spline) {
+    PredictionSpline = Spline;
+}
+
+void AEndStreamingGrid::ResetPredictionStats() {
+    const int32 InFlight = PredictionStats.InFlight;
+    PredictionStats = FEndStreamingGridPredictionStats();
+    PredictionStats.InFlight = InFlight;
+}
+
+AActor* AEndStreamingGrid::GetStreamingViewTarget(FVector& OutVelocity) const {
+    APlayerController* PlayerController = UGameplayStatics::GetPlayerController(this, 0);
+    if (PlayerController == NULL) {
+        return NULL;
+    }
+
+    AActor* ViewTarget = PlayerController->GetViewTarget();
+    if (ViewTarget == NULL) {
+        return NULL;
+    }
+
+    // Cameras attached to a bike/chocobo report no velocity of their own, so fall back to the possessed pawn.
+    OutVelocity = ViewTarget->GetVelocity();
+    if (OutVelocity.IsNearlyZero() && PlayerController->GetPawn() != NULL) {
+        OutVelocity = PlayerController->GetPawn()->GetVelocity();
+    }
+    return ViewTarget;
+}
+
+float AEndStreamingGrid::GetCellDistance(const FEndStreamingGirdData& Cell, const FVector& Location) const {
+    if (ForCollisionStreaming && Cell.CollisionsAABB.IsValid) {
+        if (bCheckedHeightCollisionStream) {
+            const float HeightDistance = FMath::Max3(Cell.CollisionsAABB.Min.Z - Location.Z, 0.0f, Location.Z - Cell.CollisionsAABB.Max.Z);
+            if (HeightDistance > ThresholdCheckedHeightCollisionStream) {
+                return MAX_flt;
+            }
+        }
+        const FVector2D BoxMin(Cell.CollisionsAABB.Min);
+        const FVector2D BoxMax(Cell.CollisionsAABB.Max);
+        return FMath::Sqrt(FBox2D(BoxMin, BoxMax).ComputeSquaredDistanceToPoint(FVector2D(Location)));
+    }
+
+    const FVector2D CellMin(Cell.GridX * GridSize, Cell.GridY * GridSize);
+    return FMath::Sqrt(FBox2D(CellMin, CellMin + FVector2D(GridSize, GridSize)).ComputeSquaredDistanceToPoint(FVector2D(Location)));
 }
 
+float AEndStreamingGrid::GetCellLoadDistance(const FEndStreamingGirdData& Cell) const {
+    return Cell.LoadDistance > 0.0f ? Cell.LoadDistance : BaseLoadDistance;
+}
 
+float AEndStreamingGrid::GetCellUnloadDistance(const FEndStreamingGirdData& Cell) const {
+    return GetCellLoadDistance(Cell) + (Cell.UnloadMargin > 0.0f ? Cell.UnloadMargin : BaseUnloadMargin);
+}
+
+ULevelStreaming* AEndStreamingGrid::FindCellStreamingLevel(const FEndStreamingGirdData& Cell) const {
+    if (Cell.Level.IsNull()) {
+        return NULL;
+    }
+    return UGameplayStatics::GetStreamingLevel(this, FName(*Cell.Level.GetLongPackageName()));
+}
+
+FVector AEndStreamingGrid::PredictLocation(const FVector& Origin, const FVector& Velocity, float Time) const {
+    const USplineComponent* Spline = PredictionSpline.Get();
+    if (Spline == NULL || Spline->GetSplineLength() <= 0.0f) {
+        return Origin + Velocity * Time;
+    }
+
+    // Advance along the spline by the velocity component that follows it, keeping the current lateral offset.
+    const float InputKey = Spline->FindInputKeyClosestToWorldLocation(Origin);
+    const FVector SplineOrigin = Spline->GetLocationAtSplineInputKey(InputKey, ESplineCoordinateSpace::World);
+    const FVector Direction = Spline->GetDirectionAtSplineInputKey(InputKey, ESplineCoordinateSpace::World);
+    const float SplineLength = Spline->GetSplineLength();
+
+    float Distance = Spline->GetDistanceAlongSplineAtSplineInputKey(InputKey) + FVector::DotProduct(Velocity, Direction) * Time;
+    if (Spline->IsClosedLoop()) {
+        Distance = FMath::Fmod(Distance, SplineLength);
+        if (Distance < 0.0f) {
+            Distance += SplineLength;
+        }
+    } else {
+        Distance = FMath::Clamp(Distance, 0.0f, SplineLength);
+    }
+    return Spline->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World) + (Origin - SplineOrigin);
+}
+
+void AEndStreamingGrid::BuildSpatialIndex() {
+    DEC_DWORD_STAT_BY(STAT_EndStreamingGridBuckets, CellBuckets.Num());
+    CellBuckets.Reset();
+    RequiredCellIndices.Reset();
+    PredictedCellIndices.Reset();
+    EstimatedCellIndices.Reset();
+    CellVisitStamps.Reset();
+    CellVisitStamps.SetNumZeroed(StreamingLevels.Num());
+    VisitStamp = 0;
+    MaxCellLoadDistance = 0.0f;
+
+    if (GridSize <= 0.0f) {
+        return;
+    }
+
+    // Buckets are GridSize wide so a plain grid cell lands in exactly one bucket; collision AABBs may span several.
+    for (int32 CellIndex = 0; CellIndex < StreamingLevels.Num(); ++CellIndex) {
+        const FEndStreamingGirdData& Cell = StreamingLevels[CellIndex];
+        if (!CellStates[CellIndex].StreamingLevel.IsValid()) {
+            continue;
+        }
+
+        FIntPoint BucketMin(Cell.GridX, Cell.GridY);
+        FIntPoint BucketMax(Cell.GridX, Cell.GridY);
+        if (ForCollisionStreaming && Cell.CollisionsAABB.IsValid) {
+            BucketMin = GetBucketCoord(Cell.CollisionsAABB.Min);
+            BucketMax = GetBucketCoord(Cell.CollisionsAABB.Max);
+        }
+        for (int32 BucketY = BucketMin.Y; BucketY <= BucketMax.Y; ++BucketY) {
+            for (int32 BucketX = BucketMin.X; BucketX <= BucketMax.X; ++BucketX) {
+                CellBuckets.FindOrAdd(FIntPoint(BucketX, BucketY)).Add(CellIndex);
+            }
+        }
+        MaxCellLoadDistance = FMath::Max(MaxCellLoadDistance, GetCellLoadDistance(Cell));
+    }
+    INC_DWORD_STAT_BY(STAT_EndStreamingGridBuckets, CellBuckets.Num());
+}
+
+FIntPoint AEndStreamingGrid::GetBucketCoord(const FVector& Location) const {
+    return FIntPoint(FMath::FloorToInt(Location.X / GridSize), FMath::FloorToInt(Location.Y / GridSize));
+}
+
+void AEndStreamingGrid::GatherNearbyCells(const FVector& Location, float Radius, TArray<int32>& OutCellIndices) {
+    OutCellIndices.Reset();
+    if (CellBuckets.Num() == 0) {
+        return;
+    }
+
+    // Stamps dedupe cells registered in several buckets without clearing a visited set per query.
+    if (++VisitStamp == 0) {
+        FMemory::Memzero(CellVisitStamps.GetData(), CellVisitStamps.Num() * sizeof(uint32));
+        VisitStamp = 1;
+    }
+
+    const FIntPoint BucketMin = GetBucketCoord(Location - FVector(Radius, Radius, 0.0f));
+    const FIntPoint BucketMax = GetBucketCoord(Location + FVector(Radius, Radius, 0.0f));
+    for (int32 BucketY = BucketMin.Y; BucketY <= BucketMax.Y; ++BucketY) {
+        for (int32 BucketX = BucketMin.X; BucketX <= BucketMax.X; ++BucketX) {
+            const TArray<int32>* Bucket = CellBuckets.Find(FIntPoint(BucketX, BucketY));
+            if (Bucket == NULL) {
+                continue;
+            }
+            for (const int32 CellIndex : *Bucket) {
+                if (CellVisitStamps[CellIndex] != VisitStamp) {
+                    CellVisitStamps[CellIndex] = VisitStamp;
+                    OutCellIndices.Add(CellIndex);
+                }
+            }
+        }
+    }
+    INC_DWORD_STAT_BY(STAT_EndStreamingGridCellsEvaluated, OutCellIndices.Num());
+}
+
+void AEndStreamingGrid::UpdateRequiredCells(const FVector& ViewLocation) {
+    const bool bCountStats = bPredictiveStreaming && bStatsPrimed;
+
+    GatherNearbyCells(ViewLocation, MaxCellLoadDistance, NearbyCellIndices);
+    for (const int32 CellIndex : NearbyCellIndices) {
+        const FEndStreamingGirdData& Cell = StreamingLevels[CellIndex];
+        FCellState& State = CellStates[CellIndex];
+        ULevelStreaming* StreamingLevel = State.StreamingLevel.Get();
+        if (State.bRequired || StreamingLevel == NULL || GetCellDistance(Cell, ViewLocation) > GetCellLoadDistance(Cell)) {
+            continue;
+        }
+
+        if (bCountStats) {
+            if (!State.bPredicted) {
+                PredictionStats.Misses++;
+            } else if (StreamingLevel->IsLevelLoaded()) {
+                PredictionStats.Hits++;
+            } else {
+                PredictionStats.LateLoads++;
+            }
+        }
+        if (State.bPredicted) {
+            PredictedCellIndices.RemoveSingleSwap(CellIndex);
+        }
+        State.bRequired = true;
+        State.bPredicted = false;
+        RequiredCellIndices.Add(CellIndex);
+        RequestCellStreaming(CellIndex, true, true, EndStreamingGrid::RequiredCellPriority);
+    }
+
+    // Only cells we already hold need the unload check, so this stays proportional to the resident set.
+    for (int32 RequiredIndex = RequiredCellIndices.Num() - 1; RequiredIndex >= 0; --RequiredIndex) {
+        const int32 CellIndex = RequiredCellIndices[RequiredIndex];
+        const FEndStreamingGirdData& Cell = StreamingLevels[CellIndex];
+        if (GetCellDistance(Cell, ViewLocation) <= GetCellUnloadDistance(Cell)) {
+            continue;
+        }
+
+        CellStates[CellIndex].bRequired = false;
+        RequiredCellIndices.RemoveAtSwap(RequiredIndex);
+        RequestCellStreaming(CellIndex, false, false, EndStreamingGrid::UnloadCellPriority);
+    }
+    INC_DWORD_STAT_BY(STAT_EndStreamingGridCellsEvaluated, RequiredCellIndices.Num());
+}
+
+void AEndStreamingGrid::UpdatePredictedCells(const FVector& ViewLocation, const FVector& Velocity, float DeltaSeconds) {
+    SCOPE_CYCLE_COUNTER(STAT_EndStreamingGridPrediction);
+
+    for (const int32 CellIndex : EstimatedCellIndices) {
+        CellStates[CellIndex].PredictedETA = MAX_flt;
+    }
+    EstimatedCellIndices.Reset();
+
+    // Rank every not-yet-required cell by the first time the projected path enters its load distance.
+    if (Velocity.Size() >= PredictionMinSpeed) {
+        const float StepTime = FMath::Max(PredictionStepTime, 0.05f);
+        for (float Time = StepTime; Time <= PredictionTime + KINDA_SMALL_NUMBER; Time += StepTime) {
+            const FVector Location = PredictLocation(ViewLocation, Velocity, Time);
+            GatherNearbyCells(Location, MaxCellLoadDistance, NearbyCellIndices);
+            for (const int32 CellIndex : NearbyCellIndices) {
+                FCellState& State = CellStates[CellIndex];
+                if (State.bRequired || State.PredictedETA != MAX_flt) {
+                    continue;
+                }
+                const FEndStreamingGirdData& Cell = StreamingLevels[CellIndex];
+                if (GetCellDistance(Cell, Location) <= GetCellLoadDistance(Cell)) {
+                    State.PredictedETA = Time;
+                    EstimatedCellIndices.Add(CellIndex);
+                }
+            }
+        }
+    }
+
+    int32 InFlight = 0;
+    for (int32 PredictedIndex = PredictedCellIndices.Num() - 1; PredictedIndex >= 0; --PredictedIndex) {
+        const int32 CellIndex = PredictedCellIndices[PredictedIndex];
+        FCellState& State = CellStates[CellIndex];
+        if (State.PredictedETA != MAX_flt) {
+            State.PredictedAge = 0.0f;
+        } else if ((State.PredictedAge += DeltaSeconds) > PredictionTime) {
+            // The path moved away before we ever needed this cell.
+            PredictedCellIndices.RemoveAtSwap(PredictedIndex);
+            ReleasePredictedCell(CellIndex);
+            continue;
+        }
+        const ULevelStreaming* StreamingLevel = State.StreamingLevel.Get();
+        if (StreamingLevel != NULL && !StreamingLevel->IsLevelLoaded()) {
+            InFlight++;
+        }
+    }
+
+    TArray<int32, TInlineAllocator<32>> Candidates;
+    for (const int32 CellIndex : EstimatedCellIndices) {
+        if (!CellStates[CellIndex].bPredicted) {
+            Candidates.Add(CellIndex);
+        }
+    }
+    Candidates.Sort([this](int32 A, int32 B) {
+        return CellStates[A].PredictedETA < CellStates[B].PredictedETA;
+    });
+
+    for (const int32 CellIndex : Candidates) {
+        if (InFlight >= MaxPredictiveLoadsInFlight) {
+            break;
+        }
+
+        // Load without making visible; UpdateRequiredCells flips visibility once the cell is actually in range.
+        FCellState& State = CellStates[CellIndex];
+        const ULevelStreaming* StreamingLevel = State.StreamingLevel.Get();
+        const int32 StepIndex = FMath::FloorToInt(State.PredictedETA / FMath::Max(PredictionStepTime, 0.05f));
+        RequestCellStreaming(CellIndex, true, false, FMath::Max(1, EndStreamingGrid::RequiredCellPriority - 1 - StepIndex));
+        State.bPredicted = true;
+        State.PredictedAge = 0.0f;
+        PredictedCellIndices.Add(CellIndex);
+        PredictionStats.Requests++;
+        if (!StreamingLevel->IsLevelLoaded()) {
+            InFlight++;
+        }
+    }
+
+    PredictionStats.InFlight = InFlight;
+    SET_DWORD_STAT(STAT_EndStreamingGridPredictiveInFlight, InFlight);
+}
+
+void AEndStreamingGrid::RequestCellStreaming(int32 CellIndex, bool bLoad, bool bMakeVisible, int32 Priority) {
+    ULevelStreaming* StreamingLevel = CellStates[CellIndex].StreamingLevel.Get();
+    if (StreamingLevel == NULL) {
+        return;
+    }
+
+    // The scheduler coalesces these with UEndLevelLoader's requests and holds them all to the same frame budgets.
+    if (UEndLevelStreamingScheduler* Scheduler = UEndLevelStreamingScheduler::Get(this)) {
+        const FName PackageName = StreamingLevel->GetWorldAssetPackageFName();
+        if (bLoad) {
+            Scheduler->RequestLoad(PackageName, Priority, bMakeVisible);
+        } else {
+            Scheduler->RequestUnload(PackageName, Priority);
+        }
+        return;
+    }
+
+    StreamingLevel->SetPriority(Priority);
+    StreamingLevel->SetShouldBeLoaded(bLoad);
+    StreamingLevel->SetShouldBeVisible(bLoad && bMakeVisible);
+}
+
+void AEndStreamingGrid::ReleasePredictedCell(int32 CellIndex) {
+    FCellState& State = CellStates[CellIndex];
+    RequestCellStreaming(CellIndex, false, false, EndStreamingGrid::UnloadCellPriority);
+    State.bPredicted = false;
+    State.PredictedAge = 0.0f;
+    PredictionStats.Wasted++;
+}
+
+void AEndStreamingGrid::DropPredictedCells() {
+    if (PredictedCellIndices.Num() == 0 && EstimatedCellIndices.Num() == 0) {
+        return;
+    }
+
+    // Prediction was turned off: nothing will ever promote these, and they were not a miss of the predictor either.
+    for (const int32 CellIndex : PredictedCellIndices) {
+        FCellState& State = CellStates[CellIndex];
+        RequestCellStreaming(CellIndex, false, false, EndStreamingGrid::UnloadCellPriority);
+        State.bPredicted = false;
+        State.PredictedAge = 0.0f;
+    }
+    for (const int32 CellIndex : EstimatedCellIndices) {
+        CellStates[CellIndex].PredictedETA = MAX_flt;
+    }
+    PredictedCellIndices.Reset();
+    EstimatedCellIndices.Reset();
+    PredictionStats.InFlight = 0;
+    SET_DWORD_STAT(STAT_EndStreamingGridPredictiveInFlight, 0);
+}
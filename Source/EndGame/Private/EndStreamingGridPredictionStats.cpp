@@ -0,0 +1,11 @@
+#include "EndStreamingGridPredictionStats.h"
+
+FEndStreamingGridPredictionStats::FEndStreamingGridPredictionStats() {
+    this->Hits = 0;
+    this->Misses = 0;
+    this->LateLoads = 0;
+    this->Wasted = 0;
+    this->Requests = 0;
+    this->InFlight = 0;
+}
+
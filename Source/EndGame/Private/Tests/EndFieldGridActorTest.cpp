@@ -0,0 +1,71 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "EndFieldGridActor.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace EndFieldGridActorTest {
+    // Cooked GridInfos_ layout: X, Y, Z biased by 128 in the low three bytes.
+    static uint32 EncodeLegacy(int32 X, int32 Y, int32 Z) {
+        return (uint32)(X + 128) | ((uint32)(Y + 128) << 8) | ((uint32)(Z + 128) << 16);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEndFieldGridActorLegacySamplingTest, "End.FieldGrid.LegacySampling",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEndFieldGridActorLegacySamplingTest::RunTest(const FString& Parameters) {
+    AEndFieldGridActor* Actor = NewObject<AEndFieldGridActor>();
+    Actor->GridNumX = 4;
+    Actor->GridNumY = 2;
+    Actor->GridNumZ = 2;
+    Actor->SaveNormal = true;
+
+    // Flow points along +X in the first two columns and along +Y in the last two; every normal points up.
+    for (uint32 Z = 0; Z < Actor->GridNumZ; ++Z) {
+        for (uint32 Y = 0; Y < Actor->GridNumY; ++Y) {
+            for (uint32 X = 0; X < Actor->GridNumX; ++X) {
+                Actor->GridInfos_.Add(X < 2 ? EndFieldGridActorTest::EncodeLegacy(127, 0, 0) : EndFieldGridActorTest::EncodeLegacy(0, 127, 0));
+                Actor->GridNormalInfos_.Add(EndFieldGridActorTest::EncodeLegacy(0, 0, 127));
+            }
+        }
+    }
+
+    TestFalse(TEXT("Actor has not opted in to the packed grid"), Actor->bUsePackedGrid);
+    TestEqual(TEXT("Legacy grid size"), Actor->GetGridNum(), FIntVector(4, 2, 2));
+
+    // Cell (0, 0, 0), the boundary between columns 1 and 2, cell (3, 1, 1) and a point clamped past the border.
+    const float CellSize = Actor->GetCellSize();
+    const FVector Origin = Actor->GetGridOrigin();
+    const FVector Positions[4] = {
+        Origin,
+        Origin + FVector(1.5f, 0.0f, 0.0f) * CellSize,
+        Origin + FVector(3.0f, 1.0f, 1.0f) * CellSize,
+        Origin + FVector(10.0f, -4.0f, 0.5f) * CellSize,
+    };
+    const FVector ExpectedFlows[4] = {
+        FVector(1.0f, 0.0f, 0.0f) * Actor->FlowSpeed,
+        FVector(0.5f, 0.5f, 0.0f) * Actor->FlowSpeed,
+        FVector(0.0f, 1.0f, 0.0f) * Actor->FlowSpeed,
+        FVector(0.0f, 1.0f, 0.0f) * Actor->FlowSpeed,
+    };
+
+    FVector Flows[4];
+    FVector Normals[4];
+    Actor->SampleFields(MakeArrayView(Positions, 4), MakeArrayView(Flows, 4), MakeArrayView(Normals, 4));
+    for (int32 Index = 0; Index < 4; ++Index) {
+        TestTrue(FString::Printf(TEXT("Flow %d"), Index), Flows[Index].Equals(ExpectedFlows[Index], 0.01f));
+        TestTrue(FString::Printf(TEXT("Normal %d"), Index), Normals[Index].Equals(FVector::UpVector, 0.001f));
+    }
+    TestTrue(TEXT("SampleFlow matches SampleFields"), Actor->SampleFlow(Positions[1]).Equals(Flows[1], 0.01f));
+
+    // Opting in without a packed bake samples nothing rather than reinterpreting the legacy arrays.
+    Actor->bUsePackedGrid = true;
+    Actor->RebuildPackedGrid();
+    Actor->SampleFields(MakeArrayView(Positions, 4), MakeArrayView(Flows, 4), TArrayView<FVector>());
+    TestTrue(TEXT("Packed grid without a bake is empty"), Flows[0].IsZero());
+
+    return true;
+}
+
+#endif
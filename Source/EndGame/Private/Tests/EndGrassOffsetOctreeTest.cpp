@@ -0,0 +1,171 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "EndGrassOffsetOctree.h"
+#include "GrassGridOctTreeNode.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace EndGrassOffsetOctreeTest {
+    static int32 AddNode(TArray<FGrassGridOctTreeNode>& Nodes, int8 Value, const TArray<uint32>& Children) {
+        FGrassGridOctTreeNode& Node = Nodes.AddDefaulted_GetRef();
+        Node.Value_ = Value;
+        Node.ChildIndicies_ = Children;
+        return Nodes.Num() - 1;
+    }
+
+    // Three levels, authored the way the cooked grids share data: two distinct leaf-level subtrees referenced from
+    // several octants and parents, partial child lists, out of range indices, and a self reference.
+    static void BuildSharedGrid(TArray<FGrassGridOctTreeNode>& Nodes) {
+        const uint32 Missing = MAX_uint32;
+        Nodes.Reset();
+        AddNode(Nodes, 0, {});
+        const uint32 LeafA = (uint32)AddNode(Nodes, 11, {});
+        const uint32 LeafB = (uint32)AddNode(Nodes, -7, {});
+        const uint32 SubtreeA = (uint32)AddNode(Nodes, 3, {LeafA, LeafB, LeafA, Missing, LeafB, LeafB, LeafA, LeafA});
+        const uint32 SubtreeB = (uint32)AddNode(Nodes, -2, {LeafB, LeafA, LeafA});
+        const uint32 SelfLoop = (uint32)AddNode(Nodes, 5, {});
+        Nodes[SelfLoop].ChildIndicies_ = {SelfLoop, LeafA, SelfLoop, LeafB, SelfLoop, SelfLoop, LeafA, SelfLoop};
+        Nodes[0].ChildIndicies_ = {SubtreeA, SubtreeB, SubtreeA, SubtreeA, Missing, SubtreeB, SelfLoop, SubtreeA};
+    }
+
+    // Random DAG: every node links to nodes after it (or, rarely, to itself or out of range), so subtrees are shared
+    // across parents and levels, and child lists have random lengths.
+    static void BuildRandomGrid(TArray<FGrassGridOctTreeNode>& Nodes, int32 NumNodes, int32 Seed) {
+        FRandomStream Random(Seed);
+        Nodes.Reset();
+        for (int32 NodeIndex = 0; NodeIndex < NumNodes; ++NodeIndex) {
+            TArray<uint32> Children;
+            const int32 NumChildren = NodeIndex + 1 < NumNodes ? Random.RandRange(0, 8) : 0;
+            for (int32 Octant = 0; Octant < NumChildren; ++Octant) {
+                const int32 Kind = Random.RandRange(0, 15);
+                if (Kind == 0) {
+                    Children.Add(MAX_uint32);
+                } else if (Kind == 1) {
+                    Children.Add((uint32)NodeIndex);
+                } else {
+                    Children.Add((uint32)Random.RandRange(NodeIndex + 1, NumNodes - 1));
+                }
+            }
+            AddNode(Nodes, (int8)Random.RandRange(-128, 127), Children);
+        }
+    }
+
+    // Brute-force reference straight from the authored node array: a node paints its value over its whole cube, then
+    // each child it links to repaints its octant, down to single cells. Nothing here walks a cell's path.
+    static void PaintNode(const TArray<FGrassGridOctTreeNode>& Nodes, int32 NodeIndex, int32 Level, const FIntVector& Corner, int32 GridNum, TArray<int8>& OutCells) {
+        const int32 Size = 1 << Level;
+        for (int32 Z = Corner.Z; Z < Corner.Z + Size; ++Z) {
+            for (int32 Y = Corner.Y; Y < Corner.Y + Size; ++Y) {
+                for (int32 X = Corner.X; X < Corner.X + Size; ++X) {
+                    OutCells[(Z * GridNum + Y) * GridNum + X] = Nodes[NodeIndex].Value_;
+                }
+            }
+        }
+        if (Level == 0) {
+            return;
+        }
+
+        const TArray<uint32>& Children = Nodes[NodeIndex].ChildIndicies_;
+        const int32 Half = Size / 2;
+        for (int32 Octant = 0; Octant < FMath::Min(Children.Num(), 8); ++Octant) {
+            if (Nodes.IsValidIndex((int32)Children[Octant])) {
+                const FIntVector ChildCorner(Corner.X + (Octant & 1) * Half, Corner.Y + ((Octant >> 1) & 1) * Half, Corner.Z + ((Octant >> 2) & 1) * Half);
+                PaintNode(Nodes, (int32)Children[Octant], Level - 1, ChildCorner, GridNum, OutCells);
+            }
+        }
+    }
+
+    // Checks Lookup, LookupNodes and LookupBatch against the painted cells. The batch gets every cell at a random point
+    // inside it, in shuffled order so the four lanes of a group take unrelated paths, plus points outside the grid.
+    static void CompareWithBruteForce(FAutomationTestBase& Test, const FString& What, const TArray<FGrassGridOctTreeNode>& Nodes, uint8 TreeLevel, int32 Seed) {
+        const int32 GridNum = 1 << TreeLevel;
+        const float UnitLength = 100.0f;
+        const FVector Origin(-300.0f, 1200.0f, 50.0f);
+
+        TArray<int8> Cells;
+        Cells.SetNumZeroed(GridNum * GridNum * GridNum);
+        PaintNode(Nodes, 0, TreeLevel, FIntVector(0, 0, 0), GridNum, Cells);
+
+        FEndGrassOffsetOctree Octree;
+        if (!Test.TestTrue(What + TEXT(": build"), Octree.Build(Nodes, TreeLevel))) {
+            return;
+        }
+
+        FRandomStream Random(Seed);
+        TArray<FVector> Positions;
+        TArray<int8> Expected;
+        int32 NumLookupMismatches = 0;
+        int32 NumLegacyMismatches = 0;
+        for (int32 Z = 0; Z < GridNum; ++Z) {
+            for (int32 Y = 0; Y < GridNum; ++Y) {
+                for (int32 X = 0; X < GridNum; ++X) {
+                    const int8 Cell = Cells[(Z * GridNum + Y) * GridNum + X];
+                    NumLookupMismatches += Octree.Lookup(X, Y, Z) != Cell ? 1 : 0;
+                    NumLegacyMismatches += FEndGrassOffsetOctree::LookupNodes(Nodes, TreeLevel, X, Y, Z) != Cell ? 1 : 0;
+                    Positions.Add(Origin + FVector(X + Random.FRandRange(0.01f, 0.99f), Y + Random.FRandRange(0.01f, 0.99f), Z + Random.FRandRange(0.01f, 0.99f)) * UnitLength);
+                    Expected.Add(Cell);
+                }
+            }
+        }
+        Test.TestEqual(What + TEXT(": Lookup mismatches"), NumLookupMismatches, 0);
+        Test.TestEqual(What + TEXT(": LookupNodes mismatches"), NumLegacyMismatches, 0);
+
+        // Outside on each side; the count leaves a scalar tail after the four-wide groups.
+        const float Outside = GridNum * UnitLength + 10.0f;
+        const FVector OutsidePoints[] = {
+            FVector(-10.0f, 50.0f, 50.0f), FVector(50.0f, -10.0f, 50.0f), FVector(50.0f, 50.0f, -10.0f),
+            FVector(Outside, 50.0f, 50.0f), FVector(50.0f, Outside, 50.0f), FVector(50.0f, 50.0f, Outside), FVector(-1.0e6f, 1.0e6f, 0.0f),
+        };
+        for (const FVector& Point : OutsidePoints) {
+            Positions.Add(Origin + Point);
+            Expected.Add(0);
+        }
+
+        for (int32 Index = Positions.Num() - 1; Index > 0; --Index) {
+            const int32 Other = Random.RandRange(0, Index);
+            Swap(Positions[Index], Positions[Other]);
+            Swap(Expected[Index], Expected[Other]);
+        }
+
+        TArray<int8> Batch;
+        Batch.SetNumZeroed(Positions.Num());
+        Octree.LookupBatch(Positions.GetData(), Positions.Num(), Origin, 1.0f / UnitLength, FIntVector(GridNum, GridNum, GridNum), Batch.GetData());
+        int32 NumBatchMismatches = 0;
+        for (int32 Index = 0; Index < Positions.Num(); ++Index) {
+            NumBatchMismatches += Batch[Index] != Expected[Index] ? 1 : 0;
+        }
+        Test.TestEqual(What + TEXT(": LookupBatch mismatches"), NumBatchMismatches, 0);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEndGrassOffsetOctreeSharedSubtreeTest, "End.GrassOffsetGrid.SharedSubtrees",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEndGrassOffsetOctreeSharedSubtreeTest::RunTest(const FString& Parameters) {
+    const uint8 TreeLevel = 3;
+
+    TArray<FGrassGridOctTreeNode> Nodes;
+    EndGrassOffsetOctreeTest::BuildSharedGrid(Nodes);
+
+    FEndGrassOffsetOctree Octree;
+    TestTrue(TEXT("Build"), Octree.Build(Nodes, TreeLevel));
+    TestEqual(TEXT("Shared nodes are emitted once"), Octree.GetNumNodes(), Nodes.Num());
+
+    EndGrassOffsetOctreeTest::CompareWithBruteForce(*this, TEXT("Shared grid"), Nodes, TreeLevel, 1);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEndGrassOffsetOctreeRandomTest, "End.GrassOffsetGrid.RandomTrees",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FEndGrassOffsetOctreeRandomTest::RunTest(const FString& Parameters) {
+    TArray<FGrassGridOctTreeNode> Nodes;
+    for (int32 Seed = 1; Seed <= 8; ++Seed) {
+        const uint8 TreeLevel = (uint8)(2 + Seed % 4);
+        EndGrassOffsetOctreeTest::BuildRandomGrid(Nodes, 20 + Seed * 30, Seed);
+        EndGrassOffsetOctreeTest::CompareWithBruteForce(*this, FString::Printf(TEXT("Seed %d, %d levels"), Seed, (int32)TreeLevel), Nodes, TreeLevel, Seed);
+    }
+    return true;
+}
+
+#endif
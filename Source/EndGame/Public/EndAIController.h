@@ -7,6 +7,7 @@
 #include "EndExtensionAIStateSetting.h"
 #include "EndAIController.generated.h"
 
+class AEndNavGridActor;
 class UBehaviorTree;
 class UEndAIActionComponent;
 class UEndAIMoveComponent;
@@ -46,6 +47,20 @@ protected:
 public:
     AEndAIController(const FObjectInitializer& ObjectInitializer);
 
+    virtual FPathFollowingRequestResult MoveTo(const FAIMoveRequest& MoveRequest, FNavPathSharedPtr* OutPath = NULL) override;
+
+protected:
+    virtual void OnPossess(APawn* InPawn) override;
+    virtual void OnUnPossess() override;
+
+private:
+    int32 GetNavQueryLayer() const;
+    void OnNavTileResidencyChanged(AEndNavGridActor* NavGrid, int32 TileIndex, UObject* TileAsset, bool bResident);
+
+    // Active move and the nav grid layer its path was found on, so it can be re-run when tile streaming changes it.
+    FAIMoveRequest StreamedMoveRequest;
+    int32 StreamedPathLayerID;
+    FDelegateHandle TileResidencyHandle;
 
     // Fix for true pure virtual functions not being implemented
 };
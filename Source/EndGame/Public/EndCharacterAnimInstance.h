@@ -327,6 +327,11 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure)
     EEndLocomotionAnimGroup GetLocomotionAnimGroupFromCache(EEndLocomotionState LocomotionState) const;
     
+protected:
+    virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+    virtual void DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) override;
+
+public:
 
     // Fix for true pure virtual functions not being implemented
 };
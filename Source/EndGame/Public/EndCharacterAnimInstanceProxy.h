@@ -1,6 +1,7 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Animation/AnimInstanceProxy.h"
+#include "ACLDecompressionContextCache.h"
 #include "EndCharacterAnimInstanceProxy.generated.h"
 
 USTRUCT(BlueprintType)
@@ -8,5 +9,13 @@ struct FEndCharacterAnimInstanceProxy : public FAnimInstanceProxy {
     GENERATED_BODY()
 public:
     ENDGAME_API FEndCharacterAnimInstanceProxy();
+    ENDGAME_API FEndCharacterAnimInstanceProxy(UAnimInstance* Instance);
+
+protected:
+    virtual void EvaluateAnimationNode_WithRoot(FPoseContext& Output, FAnimNode_Base* InRootNode) override;
+
+private:
+    // ACL contexts for the clips this instance samples, kept across frames so steady playback only re-seeks them.
+    FACLInstanceDecompressionCache DecompressionCache;
 };
 
@@ -1,9 +1,11 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "LevelSequenceActor.h"
+#include "EndStreamableAssetPrefetcher.h"
 #include "EndCinemaSequenceActor.generated.h"
 
 class UEndSequencerWrapperBase;
+class UEndStreamableAssetPump;
 class USceneComponent;
 
 UCLASS(Blueprintable)
@@ -13,6 +15,10 @@ public:
     UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true))
     TArray<FName> FieldCameraCuts;
     
+    // Recorded prefetch timeline for this sequence; its assets are streamed in ahead of playback.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true))
+    UEndStreamableAssetPump* StreamableAssetPump;
+    
 protected:
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Transient, meta=(AllowPrivateAccess=true))
     UEndSequencerWrapperBase* SequenceWrapper;
@@ -23,5 +29,14 @@ protected:
 public:
     AEndCinemaSequenceActor(const FObjectInitializer& ObjectInitializer);
 
+    virtual void Tick(float DeltaSeconds) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+    void UpdatePrefetch();
+
+    FEndStreamableAssetPrefetcher Prefetcher;
+    float LastPrefetchTime;
+
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "GameFramework/Volume.h"
+#include "EndFieldPackedGrid.h"
 #include "EndFieldGridActor.generated.h"
 
 class UArrowComponent;
@@ -57,7 +58,59 @@ public:
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Instanced, meta=(AllowPrivateAccess=true))
     UArrowComponent* ArrowComponent;
     
+    // Opt in to the packed sampling grid: the field grid bake fills PackedGridCells_ and SampleFields reads it.
+    // Otherwise SampleFields reads GridInfos_ / GridNormalInfos_, which keep their cooked encoding and are not touched.
+    UPROPERTY(EditAnywhere, meta=(AllowPrivateAccess=true))
+    bool bUsePackedGrid;
+    
+    UPROPERTY(EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bUsePackedGrid"))
+    FIntVector PackedGridNum_;
+    
+    // FEndFieldPackedGrid::EncodeCell values, X-major.
+    UPROPERTY()
+    TArray<uint64> PackedGridCells_;
+    
+#if WITH_EDITORONLY_DATA
+    // Bake inputs kept so an incremental bake only re-queries collision for bricks whose hash changed.
+    UPROPERTY()
+    TArray<uint32> BakedOccupancy_;
+    
+    UPROPERTY()
+    TArray<uint32> BakedBrickHashes_;
+    
+    UPROPERTY()
+    FIntVector BakedRawGridNum_;
+    
+    UPROPERTY()
+    int32 BakedBrickSize_;
+#endif
+    
     AEndFieldGridActor(const FObjectInitializer& ObjectInitializer);
 
+    virtual void PostInitializeComponents() override;
+
+    // Rebuilds the sampling layout from PackedGridCells_; call after rebaking at runtime.
+    void RebuildPackedGrid();
+
+    // Grid cells are UnitLength * MergeNum wide and centered on the actor. The grid is PackedGridNum_ cells with
+    // bUsePackedGrid, GridNumX/Y/Z cells otherwise.
+    float GetCellSize() const;
+    FIntVector GetGridNum() const;
+    FVector GetGridOrigin() const;
+
+    // Trilinear flow (world units, scaled by FlowSpeed) and normal at each position, from the packed grid with
+    // bUsePackedGrid and from GridInfos_ / GridNormalInfos_ otherwise. Zero where the grid has no data. OutNormals may
+    // be empty.
+    void SampleFields(TArrayView<const FVector> Positions, TArrayView<FVector> OutFlows, TArrayView<FVector> OutNormals) const;
+
+    UFUNCTION(BlueprintCallable)
+    FVector SampleFlow(const FVector& Position) const;
+
+    const FEndFieldPackedGrid& GetPackedGrid() const { return PackedGrid; }
+
+private:
+    void SampleLegacyFields(TArrayView<const FVector> Positions, TArrayView<FVector> OutFlows, TArrayView<FVector> OutNormals) const;
+
+    FEndFieldPackedGrid PackedGrid;
 };
 
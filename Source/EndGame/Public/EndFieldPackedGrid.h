@@ -0,0 +1,48 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// Runtime copy of a field grid laid out for sampling. Cells are grouped into 4x4x4 bricks, Z-curve ordered inside each
+// brick, so the eight corners of a trilinear lookup almost always share one or two cache lines. Each cell is 8 bytes:
+// quantized flow + surface level, then quantized normal.
+// This is its own format, stored in AEndFieldGridActor::PackedGridCells_ by the field grid bake; it does not read
+// the cooked GridInfos_ / GridNormalInfos_.
+class ENDGAME_API FEndFieldPackedGrid {
+public:
+    struct FCell {
+        int8 Flow[3];
+        int8 SurfaceLevel;
+        int8 Normal[3];
+        int8 Pad;
+    };
+
+    FEndFieldPackedGrid();
+
+    // Quantizes one cell for storage. UnitFlow is the flow divided by the flow scale.
+    static uint64 EncodeCell(const FVector& UnitFlow, const FVector& Normal, int32 SurfaceLevel);
+
+    // LinearCells holds one EncodeCell value per cell in X-major order; flows are sampled scaled by InFlowScale.
+    void Build(const TArray<uint64>& LinearCells, const FIntVector& InGridSize, float InFlowScale);
+    void Reset();
+
+    bool IsEmpty() const { return Cells.Num() == 0; }
+    const FIntVector& GetGridSize() const { return GridSize; }
+    SIZE_T GetAllocatedSize() const { return Cells.GetAllocatedSize(); }
+
+    int32 GetCellIndex(int32 X, int32 Y, int32 Z) const;
+    const FCell& GetCell(int32 X, int32 Y, int32 Z) const { return Cells[GetCellIndex(X, Y, Z)]; }
+
+    // Trilinearly samples Num positions. A position's grid coordinate is (Position - Origin) * InvCellSize with cell
+    // centers at integer coordinates; positions outside the grid clamp to its border. OutNormals and
+    // OutSurfaceLevels may be null.
+    void SampleBatch(const FVector* Positions, int32 Num, const FVector& Origin, float InvCellSize, FVector* OutFlows, FVector* OutNormals, float* OutSurfaceLevels) const;
+
+private:
+    static constexpr int32 BrickShift = 2;
+    static constexpr int32 BrickCells = 1 << (BrickShift * 3);
+
+    TArray<FCell> Cells;
+    FIntVector GridSize;
+    FIntVector BrickCount;
+    float FlowScale;
+};
+
@@ -2,6 +2,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "GrassGridOctTreeNode.h"
+#include "EndGrassOffsetOctree.h"
 #include "EndGrassOffsetGrid.generated.h"
 
 UCLASS(Blueprintable)
@@ -28,5 +29,18 @@ public:
     
     AEndGrassOffsetGrid(const FObjectInitializer& ObjectInitializer);
 
+    virtual void PostInitializeComponents() override;
+
+    // Re-flattens InfoTreeNodes_; call after editing the node array at runtime.
+    void RebuildCompactTree();
+
+    // World space positions to offset values; the grid's min corner sits at the actor location.
+    void LookupOffsets(TArrayView<const FVector> Positions, TArrayView<int8> OutValues) const;
+    int8 LookupOffset(const FVector& Position) const;
+
+    const FEndGrassOffsetOctree& GetCompactTree() const { return CompactTree; }
+
+private:
+    FEndGrassOffsetOctree CompactTree;
 };
 
@@ -0,0 +1,42 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FGrassGridOctTreeNode;
+
+// Pointer-free form of AEndGrassOffsetGrid's octree. A node is a child mask and the index of its first child link; the
+// links of a node are stored contiguously in octant order, and the link for an octant is found by counting the mask
+// bits below it. Links hold node indices, so subtrees the authored data shares (it is a DAG, not a tree) stay shared.
+// Values live in a parallel array so the traversal only touches 8 bytes per level.
+class ENDGAME_API FEndGrassOffsetOctree {
+public:
+    FEndGrassOffsetOctree();
+
+    // Octants are numbered X | Y << 1 | Z << 2. Missing or out of range child indices are treated as empty octants,
+    // which resolve to the parent's value.
+    bool Build(const TArray<FGrassGridOctTreeNode>& Nodes, uint8 TreeLevel);
+    // Walks the authored node array directly; the reference the compact layout has to match.
+    static int8 LookupNodes(const TArray<FGrassGridOctTreeNode>& Nodes, uint8 TreeLevel, uint32 CellX, uint32 CellY, uint32 CellZ);
+    void Reset();
+
+    bool IsEmpty() const { return Nodes.Num() == 0; }
+    int32 GetNumNodes() const { return Nodes.Num(); }
+    SIZE_T GetAllocatedSize() const { return Nodes.GetAllocatedSize() + Links.GetAllocatedSize() + Values.GetAllocatedSize(); }
+
+    int8 Lookup(uint32 CellX, uint32 CellY, uint32 CellZ) const;
+
+    // Resolves Num positions at once, four per SIMD lane group; the four lanes descend together and their child tests
+    // run in SIMD at every level. A position's cell is (Position - Origin) * InvUnitLength; positions outside
+    // [0, GridSize) get 0.
+    void LookupBatch(const FVector* Positions, int32 Num, const FVector& Origin, float InvUnitLength, const FIntVector& GridSize, int8* OutValues) const;
+
+private:
+    static constexpr uint32 ChildMaskBits = 8;
+    static constexpr uint32 MaxFirstLink = (1u << (32 - ChildMaskBits)) - 1;
+
+    // FirstLink << 8 | ChildMask.
+    TArray<uint32> Nodes;
+    TArray<uint32> Links;
+    TArray<int8> Values;
+    uint8 Depth;
+};
+
@@ -0,0 +1,71 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "EndLevelStreamingScheduler.generated.h"
+
+class ULevelStreaming;
+
+// Central queue for UEndLevelLoader and AEndStreamingGrid stream requests. Requests for the same level are coalesced,
+// higher priorities dispatch first, and waiting requests age upwards so nothing starves.
+//
+// Per frame, dispatching stops after end.LevelStreaming.FrameBudgetMs or end.LevelStreaming.FrameBudgetKB of package
+// data, and while requests are in flight the engine's level actor time slice is held to the same FrameBudgetMs. Across
+// frames, only end.LevelStreaming.MaxInFlight requests (and end.LevelStreaming.InFlightBudgetKB) stream at once.
+UCLASS()
+class ENDGAME_API UEndLevelStreamingScheduler : public UWorldSubsystem, public FTickableGameObject {
+    GENERATED_BODY()
+public:
+    UEndLevelStreamingScheduler();
+
+    static UEndLevelStreamingScheduler* Get(const UObject* WorldContextObject);
+
+    virtual void Deinitialize() override;
+
+    virtual void Tick(float DeltaTime) override;
+    virtual ETickableTickType GetTickableTickType() const override;
+    virtual bool IsTickable() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override;
+    virtual TStatId GetStatId() const override;
+
+    // Returns a ticket that IsRequestComplete() reports on; unknown levels complete immediately.
+    uint32 RequestLoad(FName LevelName, int32 Priority, bool bMakeVisible = true);
+    uint32 RequestUnload(FName LevelName, int32 Priority);
+
+    bool IsRequestComplete(uint32 Ticket) const;
+    bool IsIdle() const;
+    int32 GetQueueDepth() const { return PendingRequests.Num(); }
+    int32 GetInFlightCount() const { return InFlightRequests.Num(); }
+
+private:
+    struct FRequest {
+        FName PackageName;
+        TWeakObjectPtr<ULevelStreaming> StreamingLevel;
+        TArray<uint32, TInlineAllocator<2>> Tickets;
+        int32 Priority;
+        double EnqueueTime;
+        double DispatchTime;
+        int64 EstimatedBytes;
+        bool bLoad;
+        bool bMakeVisible;
+    };
+
+    uint32 EnqueueRequest(FName LevelName, int32 Priority, bool bLoad, bool bMakeVisible);
+    ULevelStreaming* FindStreamingLevel(FName LevelName) const;
+    int64 GetEstimatedBytes(FName PackageName);
+    float GetEffectivePriority(const FRequest& Request, double Now) const;
+    void DispatchRequest(FRequest& Request, double Now);
+    bool IsLevelAlreadyRequested(const ULevelStreaming* StreamingLevel, bool bLoad, bool bMakeVisible) const;
+    bool IsRequestSettled(const FRequest& Request) const;
+    void CompleteRequest(FRequest& Request, const TCHAR* Reason);
+    void ApplyFrameTimeBudget(bool bStreaming);
+
+    TMap<FName, FRequest> PendingRequests;
+    TMap<FName, FRequest> InFlightRequests;
+    TSet<uint32> OutstandingTickets;
+    TMap<FName, int64> PackageSizeCache;
+    uint32 NextTicket;
+    // s.LevelStreamingActorsUpdateTimeLimit before the frame budget replaced it, or negative.
+    float SavedActorsUpdateTimeLimit;
+};
+
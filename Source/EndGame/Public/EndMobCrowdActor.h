@@ -10,6 +10,8 @@
 
 class AEndCharacterBase;
 class USkeletalMeshComponent;
+class UTexture2D;
+enum class EVisibilityBasedAnimTickOption : uint8;
 
 UCLASS(Blueprintable)
 class ENDGAME_API AEndMobCrowdActor : public ATriggerBox, public IEndCrowdActorInterface, public IEndActorBaseInterface, public IEndOptimizeAnimActorInterface {
@@ -48,8 +50,19 @@ public:
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Instanced, meta=(AllowPrivateAccess=true))
     TArray<USkeletalMeshComponent*> SkeletalMesheComponents;
     
+    // Members further than the last UpdateLODDistanceThresholds entry are drawn through the group's
+    // InstancedStaticMeshComponent, animated from a baked bone-matrix texture, instead of their skeletal component.
+    UPROPERTY(EditAnywhere, meta=(AllowPrivateAccess=true))
+    bool bUseInstancedCrowd;
+    
+    UPROPERTY(EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bUseInstancedCrowd"))
+    float AnimTextureSampleRate;
+    
     AEndMobCrowdActor(const FObjectInitializer& ObjectInitializer);
 
+    virtual void BeginPlay() override;
+    virtual void Tick(float DeltaSeconds) override;
+
     UFUNCTION(BlueprintCallable)
     void Stop(float BlendTime, bool bUseFade);
     
@@ -71,6 +84,29 @@ public:
     UFUNCTION(BlueprintCallable)
     void OnRefleshCustomSkeletalMesh();
     
+private:
+    struct FInstancedGroupState {
+        TBitArray<> InstancedMembers;
+        // Last transforms pushed to the instances, so only members that moved are re-sent.
+        TArray<FTransform> MemberTransforms;
+        TArray<FTransform> AttachTransforms;
+        int32 GroupIndex;
+        bool bInstanceAttachments;
+        // The master's own setting, restored once no skeletal slave depends on its pose.
+        EVisibilityBasedAnimTickOption MasterTickOption;
+    };
+
+    void SetupInstancedGroup(int32 GroupIndex);
+    void UpdateInstancedLODs();
+    void UpdateInstanceTransforms();
+    void UpdateMasterTickOption(FInstancedGroupState& State);
+
+    TArray<FInstancedGroupState> InstancedGroups;
+    float InstancedLODTimer;
+
+    UPROPERTY(Transient)
+    TArray<UTexture2D*> CrowdAnimTextures;
+
 
     // Fix for true pure virtual functions not being implemented
 };
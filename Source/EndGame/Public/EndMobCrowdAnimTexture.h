@@ -0,0 +1,17 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class UAnimSequence;
+class USkeletalMesh;
+class UTexture2D;
+
+// Bakes an animation into a bone-matrix texture for instanced crowd rendering. Each row is one frame; each bone takes
+// three RGBA32F texels holding the rows of its 3x4 skinning matrix (animated component space * inverse ref pose).
+// Textures are shared between every crowd that asks for the same mesh/animation pair while any of them holds one.
+namespace EndMobCrowdAnimTexture {
+    ENDGAME_API UTexture2D* FindOrBake(USkeletalMesh* SkeletalMesh, UAnimSequence* AnimSequence, float SampleRate);
+
+    ENDGAME_API int32 GetNumBones(const UTexture2D* Texture);
+    ENDGAME_API int32 GetNumFrames(const UTexture2D* Texture);
+}
+
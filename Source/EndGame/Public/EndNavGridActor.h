@@ -17,7 +17,32 @@ public:
     UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true))
     uint8 Priority;
     
+    // Tiles are streamed by UEndNavGridTileStreamer instead of staying resident for the whole location.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true))
+    bool bStreamTiles;
+    
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bStreamTiles"))
+    float TileSize;
+    
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bStreamTiles"))
+    float LoadDistance;
+    
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bStreamTiles"))
+    float UnloadMargin;
+    
+    // Layer kept resident around every agent (at CoarseLoadDistanceScale x LoadDistance) and used by queries whose own layer is not resident yet.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bStreamTiles"))
+    int32 CoarseLayerID;
+    
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bStreamTiles", ClampMin=1.0f))
+    float CoarseLoadDistanceScale;
+    
     AEndNavGridActor(const FObjectInitializer& ObjectInitializer);
 
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    FBox GetTileBounds(const FEndNavGridData& Tile) const;
+    
 };
 
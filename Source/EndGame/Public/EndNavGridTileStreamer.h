@@ -0,0 +1,93 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "EndNavGridTileStreamer.generated.h"
+
+class AEndNavGridActor;
+struct FEndNavGridData;
+struct FStreamableHandle;
+
+DECLARE_MULTICAST_DELEGATE_FourParams(FOnEndNavGridTileResidencyChanged, AEndNavGridActor* /*NavGrid*/, int32 /*TileIndex*/, UObject* /*TileAsset*/, bool /*bResident*/);
+
+// Streams AEndNavGridActor tiles (FEndNavGridData assets) around the local player and registered AI agents, using the
+// same load distance / unload margin rules as AEndStreamingGrid. Each agent only pulls in its own layer; the grid's
+// coarse layer is kept around every agent so path queries always have something to fall back to.
+// A tile's LayerID is the index of its agent in the navigation system's SupportedAgents (one per EEndNavLayerType), and
+// UEndNavigationSystem routes path queries to the layer GetQueryLayer picks.
+UCLASS()
+class ENDGAME_API UEndNavGridTileStreamer : public UWorldSubsystem, public FTickableGameObject {
+    GENERATED_BODY()
+public:
+    UEndNavGridTileStreamer();
+
+    virtual void Deinitialize() override;
+
+    virtual void Tick(float DeltaTime) override;
+    virtual ETickableTickType GetTickableTickType() const override;
+    virtual bool IsTickable() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override;
+    virtual TStatId GetStatId() const override;
+
+    void RegisterNavGrid(AEndNavGridActor* NavGrid);
+    void UnregisterNavGrid(AEndNavGridActor* NavGrid);
+
+    // LayerID of INDEX_NONE registers interest in the coarse layer only. The local player's pawn is registered with
+    // its agent layer automatically.
+    UFUNCTION(BlueprintCallable)
+    void RegisterAgent(AActor* Agent, int32 LayerID);
+
+    UFUNCTION(BlueprintCallable)
+    void UnregisterAgent(AActor* Agent);
+
+    // Layer a path query at Location should run on: DesiredLayerID when its tile is resident, otherwise the coarse
+    // layer when that is resident, otherwise INDEX_NONE.
+    UFUNCTION(BlueprintCallable)
+    int32 GetQueryLayer(const FVector& Location, int32 DesiredLayerID) const;
+
+    // Layer of the navigation agent Agent moves as (its supported agent index), or INDEX_NONE.
+    UFUNCTION(BlueprintCallable)
+    int32 GetAgentLayer(const AActor* Agent) const;
+
+    UObject* FindResidentTileAsset(const FVector& Location, int32 DesiredLayerID, int32& OutLayerID) const;
+
+    // AEndAIController re-runs the path of a moving agent when the tile under it changes the layer GetQueryLayer picks.
+    FOnEndNavGridTileResidencyChanged OnTileResidencyChanged;
+
+private:
+    enum class ETileState : uint8 {
+        Unloaded,
+        Loading,
+        Resident,
+    };
+
+    struct FTileState {
+        TSharedPtr<FStreamableHandle> Handle;
+        float WantedDistance;
+        ETileState State;
+    };
+
+    struct FNavGridState {
+        TWeakObjectPtr<AEndNavGridActor> NavGrid;
+        TMap<FIntPoint, TArray<int32>> Buckets;
+        TArray<FTileState> Tiles;
+    };
+
+    struct FInterest {
+        FVector Location;
+        int32 LayerID;
+    };
+
+    void UpdatePlayerAgent();
+    void GatherInterests(TArray<FInterest>& OutInterests) const;
+    void UpdateNavGrid(FNavGridState& GridState, const TArray<FInterest>& Interests, int32& InOutLoadsInFlight);
+    void RequestTile(FNavGridState& GridState, int32 TileIndex);
+    void ReleaseTile(FNavGridState& GridState, int32 TileIndex);
+    FIntPoint GetBucketCoord(const FNavGridState& GridState, const FVector& Location) const;
+    int32 FindTile(const FNavGridState& GridState, const FVector& Location, int32 LayerID) const;
+
+    TArray<FNavGridState> NavGrids;
+    TMap<TWeakObjectPtr<AActor>, int32> Agents;
+    TWeakObjectPtr<AActor> PlayerAgent;
+};
+
@@ -9,5 +9,10 @@ class ENDGAME_API UEndNavigationSystem : public UNavigationSystemV1 {
 public:
     UEndNavigationSystem();
 
+    using Super::GetNavDataForProps;
+    // Where nav grid tiles are streamed, queries run on the layer UEndNavGridTileStreamer::GetQueryLayer picks: the
+    // agent's own layer when its tile is resident, the coarse layer otherwise.
+    virtual const ANavigationData* GetNavDataForProps(const FNavAgentProperties& AgentProperties, const FVector& AgentLocation, const FVector& Extent = INVALID_NAVEXTENT) const override;
+
 };
 
@@ -0,0 +1,38 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class UEndStreamableAssetPump;
+struct FEndStreamableAssetTimelineEntry;
+struct FStreamableHandle;
+
+// Walks a pump's prefetch timeline alongside cutscene playback. Owned by whoever drives the sequence; call Update with
+// the playback time every frame. Reads are issued PrefetchLeadTime ahead of each entry, and cuts that start more than
+// LateCutFrameTolerance frames behind their recorded FrameCounter are counted as late and widen the lead time.
+class ENDGAME_API FEndStreamableAssetPrefetcher {
+public:
+    FEndStreamableAssetPrefetcher();
+    ~FEndStreamableAssetPrefetcher();
+
+    void Begin(const UEndStreamableAssetPump* InPump, float StartTime);
+    void Update(float PlaybackTime);
+    void End();
+
+    bool IsActive() const { return Pump.IsValid(); }
+    int32 GetIssuedCount() const { return NumIssued; }
+    int32 GetLateCutCount() const { return NumLateCuts; }
+
+private:
+    void IssueEntry(const FEndStreamableAssetTimelineEntry& Entry, float PlaybackTime);
+    void ReleaseFinishedHandles();
+
+    TWeakObjectPtr<const UEndStreamableAssetPump> Pump;
+    TArray<TSharedPtr<FStreamableHandle>> Handles;
+    uint64 BaseFrameCounter;
+    uint64 BaseRecordedFrameCounter;
+    float LeadTimeScale;
+    int32 NextEntry;
+    int32 NextCut;
+    int32 NumIssued;
+    int32 NumLateCuts;
+};
+
@@ -1,13 +1,42 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "MemoryMappedAsset.h"
+#include "EndPumpData.h"
+#include "EndStreamableAssetTimeline.h"
 #include "EndStreamableAssetPump.generated.h"
 
 UCLASS(Blueprintable)
 class ENDGAME_API UEndStreamableAssetPump : public UMemoryMappedAsset {
     GENERATED_BODY()
+public:
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true))
+    FEndPumpData PumpData;
+    
+    // Seconds before an entry's recorded time that its read is issued.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, ClampMin=0.0f))
+    float PrefetchLeadTime;
+    
+    // Seconds an entry's mips/LODs are kept forced resident after its recorded time.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, ClampMin=0.0f))
+    float PrefetchHoldTime;
+    
+    // Frames a cut may start behind its recorded FrameCounter before it is reported late.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, ClampMin=0))
+    int32 LateCutFrameTolerance;
+    
+private:
+    UPROPERTY()
+    TArray<uint8> TimelineData;
+    
 public:
     UEndStreamableAssetPump(const FObjectInitializer& ObjectInitializer);
 
+    virtual void PostLoad() override;
+    virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+
+    void RebuildTimeline();
+    FEndStreamableAssetTimeline GetTimeline() const { return FEndStreamableAssetTimeline(TimelineData); }
+    FSoftObjectPath GetEntryAssetPath(const FEndStreamableAssetTimelineEntry& Entry) const;
+    
 };
 
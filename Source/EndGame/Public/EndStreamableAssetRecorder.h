@@ -0,0 +1,68 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class UPrimitiveComponent;
+class UStaticMesh;
+class UWorld;
+struct FEndMassiveEnvironmentFrameData;
+struct FEndPumpData;
+struct FMinimalViewInfo;
+
+enum class EEndStreamableAssetRecordType : uint8 {
+    Texture,
+    StaticMesh,
+    SkeletalMesh,
+};
+
+// Captures which render assets a camera actually needs, frame by frame, and folds them into FEndStreamableAssets
+// records. Times are stored relative to the cut's Timestamp, matching what FEndStreamableAssetTimeline expects.
+class ENDGAME_API FEndStreamableAssetRecorder {
+public:
+    FEndStreamableAssetRecorder();
+
+    // Primitives below this screen size (fraction of the view, as used by mesh LOD selection) are ignored.
+    float MinScreenSize;
+    // Horizontal resolution used to turn screen size into a wanted texture mip count.
+    float ViewportWidth;
+    // Static meshes whose path contains this are massive environment meshes: GatherMassiveEnvironment reports them and
+    // CaptureView leaves them out. Empty records every mesh through CaptureView.
+    FString MassiveEnvironmentPathFilter;
+
+    void BeginCut(int32 CutIndex, FName ViewTarget, float Timestamp, uint64 FrameCounter);
+    void CaptureView(UWorld* World, const FMinimalViewInfo& View, float Time);
+    // Builds the frame CaptureMassiveEnvironment consumes: one component per visible massive environment mesh, with the
+    // mesh mips (LODs) the view needs. OutAssetPaths is the frame's own path table.
+    void GatherMassiveEnvironment(UWorld* World, const FMinimalViewInfo& View, float Time, FEndMassiveEnvironmentFrameData& OutFrame, TArray<FString>& OutAssetPaths) const;
+    void CaptureMassiveEnvironment(const FEndMassiveEnvironmentFrameData& Frame, const TArray<FString>& AssetPaths);
+
+    // Dedupes against and appends to Target: cuts with the same CutIndex/ViewTarget are merged, keeping the earliest
+    // time and the highest LOD count per asset, and asset paths are shared through Target's path tables.
+    void MergeInto(FEndPumpData& Target) const;
+
+    void Reset();
+    int32 GetNumCuts() const { return Cuts.Num(); }
+
+private:
+    struct FRecordedAsset {
+        float Time;
+        uint8 LODs;
+        EEndStreamableAssetRecordType AssetType;
+    };
+
+    struct FRecordedCut {
+        FName ViewTarget;
+        int32 CutIndex;
+        float Timestamp;
+        uint64 FrameCounter;
+        TMap<FString, FRecordedAsset> Assets;
+        TMap<FString, TArray<TArray<uint8>>> MassiveEnvironmentMips;
+    };
+
+    template<typename VisitorType>
+    void ForEachVisiblePrimitive(UWorld* World, const FMinimalViewInfo& View, VisitorType Visitor) const;
+    bool IsMassiveEnvironmentMesh(const UStaticMesh* StaticMesh) const;
+    void RecordAsset(const UObject* Asset, EEndStreamableAssetRecordType AssetType, uint8 LODs, float Time);
+
+    TArray<FRecordedCut> Cuts;
+};
+
@@ -0,0 +1,59 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FEndPumpData;
+
+enum class EEndStreamableAssetTimelineFlags : uint8 {
+    None = 0,
+    MassiveEnvironment = 1 << 0,
+};
+ENUM_CLASS_FLAGS(EEndStreamableAssetTimelineFlags);
+
+struct FEndStreamableAssetTimelineHeader {
+    uint32 Magic;
+    uint32 Version;
+    uint32 NumCuts;
+    uint32 NumEntries;
+};
+
+struct FEndStreamableAssetTimelineCut {
+    float StartTime;
+    uint32 CutIndex;
+    uint64 FrameCounter;
+};
+
+struct FEndStreamableAssetTimelineEntry {
+    float Time;
+    uint32 AssetPathIndex;
+    uint16 CutIndex;
+    uint8 LODs;
+    EEndStreamableAssetTimelineFlags Flags;
+};
+
+// Read-only view over the flat prefetch timeline stored in UEndStreamableAssetPump. The blob is a header followed by
+// the cut table and the entries sorted by absolute time, so it is read in place from the loaded asset without unpacking.
+class ENDGAME_API FEndStreamableAssetTimeline {
+public:
+    static const uint32 Magic = 0x54415345; // 'ESAT'
+    static const uint32 Version = 1;
+
+    // Flattens the per-cut recordings. Entry time is FEndStreamableAssets::Timestamp plus the entry's own Time, and
+    // repeated requests for one asset inside a cut collapse into the earliest one with the highest LOD count.
+    static void Build(const FEndPumpData& PumpData, TArray<uint8>& OutData);
+
+    explicit FEndStreamableAssetTimeline(TArrayView<const uint8> InData);
+
+    bool IsValid() const { return Header != NULL; }
+    TArrayView<const FEndStreamableAssetTimelineCut> GetCuts() const;
+    TArrayView<const FEndStreamableAssetTimelineEntry> GetEntries() const;
+
+    // Index of the first entry whose time is not earlier than Time.
+    int32 LowerBoundEntry(float Time) const;
+    int32 LowerBoundCut(float Time) const;
+
+private:
+    const FEndStreamableAssetTimelineHeader* Header;
+    const FEndStreamableAssetTimelineCut* Cuts;
+    const FEndStreamableAssetTimelineEntry* Entries;
+};
+
@@ -3,8 +3,13 @@
 #include "GameFramework/Actor.h"
 #include "EEndStreamingVolumeTargetType.h"
 #include "EndStreamingGirdData.h"
+#include "EndStreamingGridPredictionStats.h"
 #include "EndStreamingGrid.generated.h"
 
+class APlayerController;
+class ULevelStreaming;
+class USplineComponent;
+
 UCLASS(Blueprintable)
 class ENDGAME_API AEndStreamingGrid : public AActor {
     GENERATED_BODY()
@@ -42,13 +47,81 @@ public:
     UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true))
     uint8 bDisabled: 1;
     
+    // Projects the view target along its velocity (or PredictionSpline) and starts loading cells before they are reached.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true))
+    bool bPredictiveStreaming;
+    
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bPredictiveStreaming", ClampMin=0.0f))
+    float PredictionTime;
+    
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bPredictiveStreaming", ClampMin=0.05f))
+    float PredictionStepTime;
+    
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bPredictiveStreaming"))
+    float PredictionMinSpeed;
+    
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(AllowPrivateAccess=true, EditCondition="bPredictiveStreaming", ClampMin=1))
+    int32 MaxPredictiveLoadsInFlight;
+    
+    UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Transient, meta=(AllowPrivateAccess=true))
+    FEndStreamingGridPredictionStats PredictionStats;
+    
     AEndStreamingGrid(const FObjectInitializer& ObjectInitializer);
 
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void Tick(float DeltaSeconds) override;
+
     UFUNCTION(BlueprintCallable)
     void PauseStreamingGrid(bool bEnable);
     
     UFUNCTION(BlueprintCallable)
     void EnableStreamingGrid(bool bEnable);
     
+    // Spline the view target is expected to follow (vehicle/chocobo spline sections). Pass null to fall back to velocity.
+    UFUNCTION(BlueprintCallable)
+    void SetPredictionSpline(USplineComponent* Spline);
+    
+    UFUNCTION(BlueprintCallable)
+    void ResetPredictionStats();
+    
+private:
+    struct FCellState {
+        TWeakObjectPtr<ULevelStreaming> StreamingLevel;
+        float PredictedETA;
+        float PredictedAge;
+        uint8 bRequired: 1;
+        uint8 bPredicted: 1;
+        
+        FCellState() : PredictedETA(MAX_flt), PredictedAge(0.0f), bRequired(false), bPredicted(false) {}
+    };
+    
+    void BuildSpatialIndex();
+    FIntPoint GetBucketCoord(const FVector& Location) const;
+    void GatherNearbyCells(const FVector& Location, float Radius, TArray<int32>& OutCellIndices);
+    AActor* GetStreamingViewTarget(FVector& OutVelocity) const;
+    float GetCellDistance(const FEndStreamingGirdData& Cell, const FVector& Location) const;
+    float GetCellLoadDistance(const FEndStreamingGirdData& Cell) const;
+    float GetCellUnloadDistance(const FEndStreamingGirdData& Cell) const;
+    ULevelStreaming* FindCellStreamingLevel(const FEndStreamingGirdData& Cell) const;
+    FVector PredictLocation(const FVector& Origin, const FVector& Velocity, float Time) const;
+    void UpdateRequiredCells(const FVector& ViewLocation);
+    void UpdatePredictedCells(const FVector& ViewLocation, const FVector& Velocity, float DeltaSeconds);
+    void RequestCellStreaming(int32 CellIndex, bool bLoad, bool bMakeVisible, int32 Priority);
+    void ReleasePredictedCell(int32 CellIndex);
+    void DropPredictedCells();
+    
+    TArray<FCellState> CellStates;
+    TMap<FIntPoint, TArray<int32>> CellBuckets;
+    TArray<int32> RequiredCellIndices;
+    TArray<int32> PredictedCellIndices;
+    TArray<int32> EstimatedCellIndices;
+    TArray<int32> NearbyCellIndices;
+    TArray<uint32> CellVisitStamps;
+    uint32 VisitStamp;
+    float MaxCellLoadDistance;
+    TWeakObjectPtr<USplineComponent> PredictionSpline;
+    uint8 bPaused: 1;
+    uint8 bStatsPrimed: 1;
 };
 
@@ -0,0 +1,35 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "EndStreamingGridPredictionStats.generated.h"
+
+USTRUCT(BlueprintType)
+struct ENDGAME_API FEndStreamingGridPredictionStats {
+    GENERATED_BODY()
+public:
+    // Cells that were already loaded by prediction when the view target entered their load distance.
+    UPROPERTY(BlueprintReadOnly, VisibleAnywhere, meta=(AllowPrivateAccess=true))
+    int32 Hits;
+    
+    // Cells that entered their load distance without ever being predicted.
+    UPROPERTY(BlueprintReadOnly, VisibleAnywhere, meta=(AllowPrivateAccess=true))
+    int32 Misses;
+    
+    // Cells that were predicted but were still loading when the view target entered their load distance.
+    UPROPERTY(BlueprintReadOnly, VisibleAnywhere, meta=(AllowPrivateAccess=true))
+    int32 LateLoads;
+    
+    // Predicted cells that were released again without ever being required.
+    UPROPERTY(BlueprintReadOnly, VisibleAnywhere, meta=(AllowPrivateAccess=true))
+    int32 Wasted;
+    
+    // Predictive loads issued since the last reset.
+    UPROPERTY(BlueprintReadOnly, VisibleAnywhere, meta=(AllowPrivateAccess=true))
+    int32 Requests;
+    
+    // Predictive loads currently in flight.
+    UPROPERTY(BlueprintReadOnly, VisibleAnywhere, meta=(AllowPrivateAccess=true))
+    int32 InFlight;
+    
+    FEndStreamingGridPredictionStats();
+};
+